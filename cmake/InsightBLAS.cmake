@@ -85,4 +85,44 @@ macro(set_insight_blas_library INSIGHT_BLAS_LIBRARY_TO_SET)
       ". Available BLAS options are: ${_AVAILABLE_BLAS_OPTIONS}")
   endif()
   message(STATUS "Using BLAS option: ${INSIGHT_BLAS_LIBRARY_TO_SET}")
-endmacro()
\ No newline at end of file
+endmacro()
+
+# Sets LAPACKE_FOUND_RESULT to TRUE if the BLAS backend INSIGHT_BLAS_OPTION,
+# as set by set_insight_blas_library, provides the LAPACKE interface, i.e.
+# both lapacke.h (mkl.h for MKL) and the LAPACKE_* symbols. Some
+# distributions (e.g. Debian and Ubuntu) build OpenBLAS without LAPACKE and
+# ship it as a separate liblapacke instead, which is then appended to
+# INSIGHT_BLAS_LIBRARIES.
+function(find_insight_blas_lapacke INSIGHT_BLAS_OPTION LAPACKE_FOUND_RESULT)
+  set(HAS_LAPACKE FALSE)
+  if ("${INSIGHT_BLAS_OPTION}" STREQUAL "MKL")
+    set(HAS_LAPACKE TRUE)
+  elseif ("${INSIGHT_BLAS_OPTION}" STREQUAL "OpenBLAS" OR
+          "${INSIGHT_BLAS_OPTION}" STREQUAL "Atlas")
+    find_path(LAPACKE_INCLUDE_DIR NAMES lapacke.h
+      PATHS ${INSIGHT_BLAS_INCLUDE_DIRS})
+    if (LAPACKE_INCLUDE_DIR)
+      include(CheckFunctionExists)
+      set(CMAKE_REQUIRED_LIBRARIES ${INSIGHT_BLAS_LIBRARIES})
+      check_function_exists(LAPACKE_dgeqrf HAVE_BLAS_LAPACKE_DGEQRF)
+      unset(CMAKE_REQUIRED_LIBRARIES)
+      if (HAVE_BLAS_LAPACKE_DGEQRF)
+        set(HAS_LAPACKE TRUE)
+      else()
+        find_library(LAPACKE_LIBRARY NAMES lapacke)
+        if (LAPACKE_LIBRARY)
+          set(CMAKE_REQUIRED_LIBRARIES ${LAPACKE_LIBRARY}
+            ${INSIGHT_BLAS_LIBRARIES})
+          check_function_exists(LAPACKE_dgeqrf HAVE_LIBLAPACKE_DGEQRF)
+          unset(CMAKE_REQUIRED_LIBRARIES)
+          if (HAVE_LIBLAPACKE_DGEQRF)
+            set(HAS_LAPACKE TRUE)
+            set(INSIGHT_BLAS_LIBRARIES ${LAPACKE_LIBRARY}
+              ${INSIGHT_BLAS_LIBRARIES} PARENT_SCOPE)
+          endif()
+        endif()
+      endif()
+    endif()
+  endif()
+  set(${LAPACKE_FOUND_RESULT} ${HAS_LAPACKE} PARENT_SCOPE)
+endfunction()
@@ -5,8 +5,21 @@
 #ifndef INCLUDE_INSIGHT_LINALG_H_
 #define INCLUDE_INSIGHT_LINALG_H_
 
+#include "insight/linalg/half.h"
 #include "insight/linalg/matrix.h"
 #include "insight/linalg/vector.h"
+#include "insight/linalg/static_matrix.h"
+#include "insight/linalg/static_vector.h"
+#include "insight/linalg/matrix_map.h"
+#include "insight/linalg/vector_map.h"
+#include "insight/linalg/symmetric_matrix.h"
+#include "insight/linalg/triangular_matrix.h"
+#include "insight/linalg/sparse_matrix.h"
+#include "insight/linalg/sparse_vector.h"
+#include "insight/linalg/matmul_batch.h"
+#include "insight/linalg/quantize.h"
+#include "insight/linalg/factorization.h"
+#include "insight/linalg/decomposition.h"
 #include "insight/linalg/functions.h"
 
 #endif  // INCLUDE_INSIGHT_LINALG_H_
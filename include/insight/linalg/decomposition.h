@@ -0,0 +1,211 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DECOMPOSITION_H_
+#define INCLUDE_INSIGHT_LINALG_DECOMPOSITION_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+
+#include "insight/linalg/factorization.h"
+#include "insight/linalg/matrix.h"
+#include "insight/linalg/vector.h"
+#include "insight/linalg/detail/lapack_routines.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// Spectral decompositions of float or double matrices, e.g. for PCA:
+//
+//   matrix<double> C = ...;                       // n x n covariance.
+//   eigen_decomposition<double> pca = eigh(C, 50);
+//   // pca.values: the 50 largest eigenvalues of C, pca.vectors: n x 50.
+//
+//   matrix<double> X = ...;                       // m x n data, m >> n.
+//   singular_value_decomposition<double> top = randomized_svd(X, 100);
+//   // X ~ top.u * diag(top.s) * top.vt.
+//
+// Eigenvalues and singular values are sorted in decreasing order, and the
+// i-th eigenvector (resp. left and right singular vectors) is the i-th
+// column of vectors (resp. of u, and the i-th row of vt).
+//
+// eigh and svd go through LAPACKE (syevd, syevr and gesdd) when the BLAS
+// backend provides it, and through native implementations otherwise (see
+// linalg_detail/lapack_routines.h), which are only suited to matrices of a
+// few hundred rows and columns. randomized_svd only needs gemm and QR.
+
+template<typename T>
+struct eigen_decomposition {
+  vector<T> values;
+  matrix<T> vectors;
+};
+
+template<typename T>
+struct singular_value_decomposition {
+  matrix<T> u;
+  vector<T> s;
+  matrix<T> vt;
+};
+
+namespace linalg_detail {
+
+// The first k columns of A, in reverse order if reversed is true.
+template<typename T>
+matrix<T> leading_columns(const matrix<T>& A, std::size_t k,
+                          bool reversed = false) {
+  matrix<T> result(A.row_count(), k);
+  for (std::size_t i = 0; i < A.row_count(); ++i) {
+    const T* row = A.data() + i * A.col_count();
+    T* out = result.data() + i * k;
+    if (reversed) {
+      std::reverse_copy(row, row + k, out);
+    } else {
+      std::copy(row, row + k, out);
+    }
+  }
+  return result;
+}
+
+}  // namespace linalg_detail
+
+// The eigendecomposition A = V * diag(values) * V^T of the symmetric matrix
+// A. Only the lower triangle of A is read.
+template<typename T>
+eigen_decomposition<T> eigh(const matrix<T>& A) {
+  static_assert(linalg_detail::is_lapack_scalar<T>::value,
+                "eigh: only float and double matrices can be decomposed");
+  CHECK_EQ(A.row_count(), A.col_count()) << "eigh: the matrix is not square";
+  const int N = static_cast<int>(A.row_count());
+
+  matrix<T> V(A);
+  vector<T> W(A.row_count());
+  const int info = linalg_detail::lapack_syevd(N, V.data(), N, W.data());
+  CHECK_EQ(info, 0) << "eigh: failed to converge";
+
+  eigen_decomposition<T> result;
+  result.values = W;
+  std::reverse(result.values.begin(), result.values.end());
+  result.vectors = linalg_detail::leading_columns(V, A.row_count(), true);
+  return result;
+}
+
+// The k largest eigenvalues of the symmetric matrix A, and their
+// eigenvectors. Only the lower triangle of A is read.
+template<typename T>
+eigen_decomposition<T> eigh(const matrix<T>& A, std::size_t k) {
+  static_assert(linalg_detail::is_lapack_scalar<T>::value,
+                "eigh: only float and double matrices can be decomposed");
+  CHECK_EQ(A.row_count(), A.col_count()) << "eigh: the matrix is not square";
+  CHECK_LE(k, A.row_count()) << "eigh: more eigenvalues than rows";
+  const int N = static_cast<int>(A.row_count());
+
+  eigen_decomposition<T> result;
+  if (k == 0) {
+    result.vectors = matrix<T>(A.row_count(), 0);
+    return result;
+  }
+
+  matrix<T> V(A);
+  vector<T> W(k);
+  matrix<T> Z(A.row_count(), k);
+  const int info = linalg_detail::lapack_syevr(N, V.data(), N,
+                                               N - static_cast<int>(k) + 1, N,
+                                               W.data(), Z.data(),
+                                               static_cast<int>(k));
+  CHECK_EQ(info, 0) << "eigh: failed to converge";
+
+  result.values = W;
+  std::reverse(result.values.begin(), result.values.end());
+  result.vectors = linalg_detail::leading_columns(Z, k, true);
+  return result;
+}
+
+// The thin singular value decomposition A = u * diag(s) * vt of the M x N
+// matrix A: with K = min(M, N), u is M x K, s has K elements and vt is
+// K x N.
+template<typename T>
+singular_value_decomposition<T> svd(const matrix<T>& A) {
+  static_assert(linalg_detail::is_lapack_scalar<T>::value,
+                "svd: only float and double matrices can be decomposed");
+  const std::size_t K = std::min(A.row_count(), A.col_count());
+  const int M = static_cast<int>(A.row_count());
+  const int N = static_cast<int>(A.col_count());
+
+  singular_value_decomposition<T> result;
+  result.u = matrix<T>(A.row_count(), K);
+  result.s = vector<T>(K);
+  result.vt = matrix<T>(K, A.col_count());
+
+  matrix<T> work(A);
+  const int info = linalg_detail::lapack_gesdd(M, N, work.data(), N,
+                                               result.s.data(),
+                                               result.u.data(),
+                                               static_cast<int>(K),
+                                               result.vt.data(), N);
+  CHECK_EQ(info, 0) << "svd: failed to converge";
+  return result;
+}
+
+// The rank largest singular values of A, and their singular vectors,
+// computed by a randomized range finder (Halko, Martinsson and Tropp, 2011)
+// at the cost of a few gemm and QR factorizations of M x (rank +
+// oversampling) matrices, instead of a full SVD.
+//
+// The range of A is sampled by A * G, where G is an N x (rank +
+// oversampling) Gaussian matrix, and refined by power_iterations
+// multiplications by A * A^T, which sharpen the approximation when the
+// singular values decay slowly. Each product is re-orthonormalized (with
+// QR) to preserve the small singular values. The SVD of the small
+// projection Q^T * A then gives the result.
+//
+// The result is deterministic for a given seed.
+template<typename T>
+singular_value_decomposition<T> randomized_svd(
+    const matrix<T>& A, std::size_t rank, std::size_t oversampling = 10,
+    std::size_t power_iterations = 2, unsigned seed = 0) {
+  static_assert(linalg_detail::is_lapack_scalar<T>::value,
+                "randomized_svd: only float and double matrices can be "
+                "decomposed");
+  const std::size_t K = std::min(A.row_count(), A.col_count());
+  CHECK_LE(rank, K) << "randomized_svd: rank larger than the matrix";
+  const std::size_t l = std::min(rank + oversampling, K);
+
+  singular_value_decomposition<T> result;
+  if (rank == 0) {
+    result.u = matrix<T>(A.row_count(), 0);
+    result.vt = matrix<T>(0, A.col_count());
+    return result;
+  }
+
+  std::mt19937 gen(seed);
+  std::normal_distribution<T> normal;
+  matrix<T> G(A.col_count(), l);
+  for (auto& g : G) g = normal(gen);
+
+  matrix<T> Y = matmul(A, G);
+  matrix<T> Q = qr<T>(Y).q();
+  for (std::size_t i = 0; i < power_iterations; ++i) {
+    const matrix<T> Z = matmul(A.t(), Q);
+    const matrix<T> P = qr<T>(Z).q();
+    Y = matmul(A, P);
+    Q = qr<T>(Y).q();
+  }
+
+  // A ~ Q * Q^T * A = (Q * Ub) * diag(s) * vt.
+  const matrix<T> B = matmul(Q.t(), A);
+  const singular_value_decomposition<T> small = svd(B);
+  const matrix<T> U = matmul(Q, small.u);
+
+  result.u = linalg_detail::leading_columns(U, rank);
+  result.s = vector<T>(small.s.begin(), small.s.begin() + rank);
+  result.vt = matrix<T>(rank, A.col_count());
+  std::copy(small.vt.data(), small.vt.data() + result.vt.size(),
+            result.vt.data());
+  return result;
+}
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DECOMPOSITION_H_
@@ -0,0 +1,257 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_ALIAS_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_ALIAS_H_
+
+#include <cstddef>
+#include <type_traits>
+
+#include "insight/linalg/detail/scalar_traits.h"
+
+namespace insight {
+
+// These forward declarations should be here NOT inside the linalg_detail
+// namespace.
+template<typename T, typename A, std::size_t N> class vector;
+template<typename T, typename A, std::size_t N> class matrix;
+template<typename T> class vector_map;
+template<typename T> class matrix_map;
+template<typename T, std::size_t N> class static_vector;
+template<typename T, std::size_t R, std::size_t C> class static_matrix;
+
+namespace linalg_detail {
+
+template<typename Derived> struct vector_expression;
+template<typename E1, typename E2, typename F> struct binary_expression;
+template<typename E, typename F> struct unary_expression;
+template<typename E> struct transpose_expression;
+template<typename T> class temporary_vector;
+template<typename T> class temporary_matrix;
+
+// Alias analysis.
+//
+// Writing the result of an expression into a buffer the expression also
+// reads from is safe as long as the element i of the result only depends on
+// the element i of that buffer: this is the case of dense vectors and
+// matrices themselves, and of any arithmetic (elementwise) combination of
+// them. So for example x = 2.0 * x + y and A = sqrt(A) / B are evaluated
+// in place.
+//
+// Everything else, e.g. a matmul, a matrix transpose or a row/column view,
+// reads elements at other positions, and has to be evaluated into a
+// temporary first if (and only if) it actually reads the destination:
+// x = matmul(A, x) or A = A.t().
+//
+// The first question is answered at compile time by is_elementwise<E>. The
+// second, at runtime, by the member function
+//
+//   bool aliases(const value_type* first, const value_type* last) const;
+//
+// that every expression exposes and which returns true if any of the dense
+// storage the expression reads overlaps [first, last).
+
+// Is E an elementwise expression, i.e an expression whose element i only
+// depends on the element i of the dense vectors/matrices it reads? Scalars
+// are elementwise operands.
+template<typename E>
+struct is_elementwise : public is_scalar<E> {};
+
+template<typename T, typename A, std::size_t N>
+struct is_elementwise<insight::vector<T, A, N> > : public std::true_type {};
+
+template<typename T, typename A, std::size_t N>
+struct is_elementwise<insight::matrix<T, A, N> > : public std::true_type {};
+
+template<typename T, std::size_t N>
+struct is_elementwise<insight::static_vector<T, N> > : public std::true_type {};
+
+template<typename T, std::size_t R, std::size_t C>
+struct is_elementwise<insight::static_matrix<T, R, C> >
+    : public std::true_type {};
+
+template<typename T>
+struct is_elementwise<temporary_vector<T> > : public std::true_type {};
+
+template<typename T>
+struct is_elementwise<temporary_matrix<T> > : public std::true_type {};
+
+template<typename E1, typename E2, typename F>
+struct is_elementwise<binary_expression<E1, E2, F> >
+    : public std::integral_constant<bool,
+                                    is_elementwise<E1>::value &&
+                                    is_elementwise<E2>::value> {};
+
+template<typename E, typename F>
+struct is_elementwise<unary_expression<E, F> >
+    : public is_elementwise<E> {};
+
+// Transposing a vector does not change its memory layout.
+template<typename E>
+struct is_elementwise<transpose_expression<E> >
+    : public std::integral_constant<bool,
+                                    std::is_base_of<vector_expression<E>,
+                                                    E>::value &&
+                                    is_elementwise<E>::value> {};
+
+template<typename E> struct alias_analysis;
+
+// Returns true if the expression e reads the range [first, last) other
+// than elementwise, in which case it must be evaluated into a temporary
+// before being written to that range.
+template<typename E>
+inline bool requires_temporary(const E& e,
+                               const typename E::value_type* first,
+                               const typename E::value_type* last) {
+  return alias_analysis<E>::requires_temporary(
+      e, first, last,
+      std::integral_constant<bool, is_elementwise<E>::value>());
+}
+
+// Non elementwise expression: matmul, matrix transpose, row/column view.
+template<typename E>
+struct alias_analysis {
+  using value_type = typename E::value_type;
+
+  static inline bool requires_temporary(const E& e, const value_type* first,
+                                        const value_type* last,
+                                        std::true_type) {
+    return false;
+  }
+
+  static inline bool requires_temporary(const E& e, const value_type* first,
+                                        const value_type* last,
+                                        std::false_type) {
+    return e.aliases(first, last);
+  }
+};
+
+// A map (see vector_map.h and matrix_map.h) may view any part of a buffer,
+// e.g. the destination shifted by a few elements, so that it is not an
+// elementwise operand at compile time. At runtime, it is read elementwise
+// if it starts where the range does, or does not overlap it at all.
+template<typename M>
+struct map_alias_analysis {
+  using value_type = typename M::value_type;
+
+  static inline bool requires_temporary(const M& e, const value_type* first,
+                                        const value_type* last,
+                                        std::false_type) {
+    return e.aliases(first, last) && e.data() != first;
+  }
+};
+
+template<typename T>
+struct alias_analysis<insight::vector_map<T> >
+    : public map_alias_analysis<insight::vector_map<T> > {};
+
+template<typename T>
+struct alias_analysis<insight::matrix_map<T> >
+    : public map_alias_analysis<insight::matrix_map<T> > {};
+
+// An arithmetic combination of expressions requires a temporary if any of
+// its operands does.
+template<typename E1, typename E2, typename F>
+struct alias_analysis<binary_expression<E1, E2, F> > {
+  using expression_type = binary_expression<E1, E2, F>;
+  using value_type = typename expression_type::value_type;
+
+  static inline bool requires_temporary(const expression_type& e,
+                                        const value_type* first,
+                                        const value_type* last,
+                                        std::true_type) {
+    return false;
+  }
+
+  static inline bool requires_temporary(const expression_type& e,
+                                        const value_type* first,
+                                        const value_type* last,
+                                        std::false_type) {
+    return operands_require_temporary(
+        e, first, last,
+        std::integral_constant<int, is_scalar<E1>::value ? 1 :
+                               is_scalar<E2>::value ? 2 : 0>());
+  }
+
+ private:
+  // expression-expression.
+  static inline bool operands_require_temporary(
+      const expression_type& e, const value_type* first,
+      const value_type* last, std::integral_constant<int, 0>) {
+    return linalg_detail::requires_temporary(e.e1, first, last) ||
+        linalg_detail::requires_temporary(e.e2, first, last);
+  }
+
+  // scalar-expression or expression-scalar.
+  template<int N>
+  static inline bool operands_require_temporary(
+      const expression_type& e, const value_type* first,
+      const value_type* last, std::integral_constant<int, N>) {
+    return linalg_detail::requires_temporary(e.e, first, last);
+  }
+};
+
+template<typename E, typename F>
+struct alias_analysis<unary_expression<E, F> > {
+  using expression_type = unary_expression<E, F>;
+  using value_type = typename expression_type::value_type;
+
+  static inline bool requires_temporary(const expression_type& e,
+                                        const value_type* first,
+                                        const value_type* last,
+                                        std::true_type) {
+    return false;
+  }
+
+  static inline bool requires_temporary(const expression_type& e,
+                                        const value_type* first,
+                                        const value_type* last,
+                                        std::false_type) {
+    return linalg_detail::requires_temporary(e.e, first, last);
+  }
+};
+
+template<typename E>
+struct alias_analysis<transpose_expression<E> > {
+  using expression_type = transpose_expression<E>;
+  using value_type = typename expression_type::value_type;
+
+  static inline bool requires_temporary(const expression_type& e,
+                                        const value_type* first,
+                                        const value_type* last,
+                                        std::true_type) {
+    return false;
+  }
+
+  static inline bool requires_temporary(const expression_type& e,
+                                        const value_type* first,
+                                        const value_type* last,
+                                        std::false_type) {
+    return requires_temporary_(
+        e, first, last,
+        std::integral_constant<bool,
+        std::is_base_of<vector_expression<E>, E>::value>());
+  }
+
+ private:
+  // The transpose of a vector expression requires a temporary only if the
+  // vector expression itself does.
+  static inline bool requires_temporary_(const expression_type& e,
+                                         const value_type* first,
+                                         const value_type* last,
+                                         std::true_type) {
+    return linalg_detail::requires_temporary(e.e, first, last);
+  }
+
+  static inline bool requires_temporary_(const expression_type& e,
+                                         const value_type* first,
+                                         const value_type* last,
+                                         std::false_type) {
+    return e.aliases(first, last);
+  }
+};
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_ALIAS_H_
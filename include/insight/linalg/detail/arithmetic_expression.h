@@ -9,6 +9,7 @@
 #include <iterator>
 #include <type_traits>
 
+#include "insight/linalg/detail/scalar_traits.h"
 #include "insight/linalg/detail/unary_transform_iterator.h"
 #include "insight/linalg/detail/binary_transform_iterator.h"
 
@@ -32,6 +33,33 @@ struct matrix_expression {
 template<typename E> struct row_view;
 template<typename E> struct col_view;
 template<typename E> struct transpose_expression;
+template<typename E1, typename E2, typename F> struct binary_expression;
+template<typename E, typename F> struct unary_expression;
+
+// Is E a row vector, i.e the transpose of a vector expression, or a row of
+// a matrix expression? A matrix expression combined with a row vector is
+// broadcast (see broadcast_expression.h).
+template<typename E>
+struct is_row_vector : public std::false_type {};
+
+template<typename E>
+struct is_row_vector<transpose_expression<E> >
+    : public std::is_base_of<vector_expression<E>, E> {};
+
+template<typename E>
+struct is_row_vector<row_view<E> > : public std::true_type {};
+
+// So is an element-wise expression of row vectors and scalars, e.g the
+// scaled bias 0.5 * b.t(), or -b.t().
+template<typename E1, typename E2, typename F>
+struct is_row_vector<binary_expression<E1, E2, F> >
+    : public std::integral_constant<
+  bool,
+  (is_row_vector<E1>::value || is_scalar<E1>::value) &&
+  (is_row_vector<E2>::value || is_scalar<E2>::value)> {};
+
+template<typename E, typename F>
+struct is_row_vector<unary_expression<E, F> > : public is_row_vector<E> {};
 
 // Binary expression.
 
@@ -60,7 +88,7 @@ struct binary_expression : public std::conditional<
 
   const E1& e1;
   const E2& e2;
-  const F& f;
+  const F f;
 
   binary_expression(const E1& e1, const E2& e2, const F& f)
       : e1(e1), e2(e2), f(f) {
@@ -73,6 +101,16 @@ struct binary_expression : public std::conditional<
   inline shape_type shape() const  { return e1.shape(); }
   inline size_type size() const  { return e1.size(); }
 
+  // Evaluates the element at the given (row-major) linear index.
+  inline value_type eval(size_type i) const {
+    return f(e1.eval(i), e2.eval(i));
+  }
+
+  // Does this expression read any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return e1.aliases(first, last) || e2.aliases(first, last);
+  }
+
   // Accesses the row at the given index row_index. No bounds checking is
   // performed.
   inline row_view<self> row_at(size_type row_index) {
@@ -129,7 +167,7 @@ struct binary_expression<E, typename E::value_type, F>
 
   const E& e;
   const value_type scalar;
-  const F& f;
+  const F f;
 
   binary_expression(const E& e, value_type scalar, const F& f)
       : e(e), scalar(scalar), f(f) {
@@ -140,6 +178,14 @@ struct binary_expression<E, typename E::value_type, F>
   inline shape_type shape() const { return e.shape(); }
   inline size_type size() const { return e.size(); }
 
+  // Evaluates the element at the given (row-major) linear index.
+  inline value_type eval(size_type i) const { return f(e.eval(i), scalar); }
+
+  // Does this expression read any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return e.aliases(first, last);
+  }
+
   inline row_view<self> row_at(size_type row_index) {
     return row_view<self>(this, row_index);
   }
@@ -199,7 +245,7 @@ struct binary_expression<typename E::value_type, E, F>
 
   const value_type scalar;
   const E& e;
-  const F& f;
+  const F f;
 
   binary_expression(value_type scalar, const E& e, const F& f)
       : scalar(scalar), e(e), f(f) {
@@ -210,6 +256,14 @@ struct binary_expression<typename E::value_type, E, F>
   inline shape_type shape() const { return e.shape(); }
   inline size_type size() const { return e.size(); }
 
+  // Evaluates the element at the given (row-major) linear index.
+  inline value_type eval(size_type i) const { return f(scalar, e.eval(i)); }
+
+  // Does this expression read any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return e.aliases(first, last);
+  }
+
   inline row_view<self> row_at(size_type row_index) {
     return row_view<self>(this, row_index);
   }
@@ -271,7 +325,7 @@ struct unary_expression
   using iterator = const_iterator;
 
   const E& e;
-  const F& f;
+  const F f;
 
   unary_expression(const E& e, const F& f) : e(e), f(f) {}
 
@@ -280,6 +334,14 @@ struct unary_expression
   inline shape_type shape() const { return e.shape(); }
   inline size_type size() const { return e.size(); }
 
+  // Evaluates the element at the given (row-major) linear index.
+  inline value_type eval(size_type i) const { return f(e.eval(i)); }
+
+  // Does this expression read any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return e.aliases(first, last);
+  }
+
   inline row_view<self> row_at(size_type row_index) {
     return row_view<self>(this, row_index);
   }
@@ -501,7 +563,8 @@ inline
 // between an integer matrix and a floating-point matrix.
 typename
 std::enable_if<
-  std::is_same<typename L::value_type, typename R::value_type>::value,
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  is_row_vector<L>::value == is_row_vector<R>::value,
   binary_expression<L, R, std::plus<typename L::value_type> >
   >::type
 operator+(const matrix_expression<L>& e1, const matrix_expression<R>& e2) {
@@ -545,7 +608,8 @@ inline
 // between an integer matrix and a floating-point matrix.
 typename
 std::enable_if<
-  std::is_same<typename L::value_type, typename R::value_type>::value,
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  is_row_vector<L>::value == is_row_vector<R>::value,
   binary_expression<L, R, std::minus<typename L::value_type> >
   >::type
 operator-(const matrix_expression<L>& e1, const matrix_expression<R>& e2) {
@@ -590,7 +654,8 @@ inline
 // multiplication between an integer matrix and a floating-point matrix.
 typename
 std::enable_if<
-  std::is_same<typename L::value_type, typename R::value_type>::value,
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  is_row_vector<L>::value == is_row_vector<R>::value,
   binary_expression<L, R, std::multiplies<typename L::value_type> >
   >::type
 operator*(const matrix_expression<L>& e1, const matrix_expression<R>& e2) {
@@ -634,7 +699,8 @@ inline
 // division between an integer matrix and a floating-point matrix.
 typename
 std::enable_if<
-  std::is_same<typename L::value_type, typename R::value_type>::value,
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  is_row_vector<L>::value == is_row_vector<R>::value,
   binary_expression<L, R, std::divides<typename L::value_type> >
   >::type
 operator/(const matrix_expression<L>& e1, const matrix_expression<R>& e2) {
@@ -5,6 +5,9 @@
 #ifndef INCLUDE_INSIGHT_LINALG_DETAIL_BLAS_ROUTINES_H_
 #define INCLUDE_INSIGHT_LINALG_DETAIL_BLAS_ROUTINES_H_
 
+#include <cstdint>
+#include <type_traits>
+
 #include "insight/internal/port.h"
 
 #ifdef INSIGHT_USE_ACCELERATE
@@ -69,6 +72,249 @@ void blas_gemm(const CBLAS_TRANSPOSE TransA,
                   const T beta,
                   T* C);
 
+// Leading dimension forms of gemv and gemm: A (resp. B, C) is a block of a
+// row-major array whose consecutive rows are lda (resp. ldb, ldc) elements
+// apart, and the elements of x (resp. y) are incx (resp. incy) apart. The
+// forms above are these with the leading dimensions of contiguous
+// matrices.
+
+template<typename T>
+void blas_gemv(const CBLAS_TRANSPOSE TransA,
+               const int M,
+               const int N,
+               const T alpha,
+               const T* A,
+               const int lda,
+               const T* x,
+               const int incx,
+               const T beta,
+               T* y,
+               const int incy);
+
+template<typename T>
+void blas_gemm(const CBLAS_TRANSPOSE TransA,
+               const CBLAS_TRANSPOSE TransB,
+               const int M,
+               const int N,
+               const int K,
+               const T alpha,
+               const T* A,
+               const int lda,
+               const T* B,
+               const int ldb,
+               const T beta,
+               T* C,
+               const int ldc);
+
+// Triangular solves, and symmetric and general rank updates, on the same
+// row-major operands as the leading dimension forms above. A triangular (or
+// symmetric) matrix is given by its lower (Uplo = CblasLower) or upper
+// (CblasUpper) triangle, the other one being neither read nor written.
+
+// x <- op(A)^-1 * x, where A is N x N triangular, with a unit diagonal which
+// is not read (Diag = CblasUnit) or not (CblasNonUnit).
+template<typename T>
+void blas_trsv(const CBLAS_UPLO Uplo,
+               const CBLAS_TRANSPOSE TransA,
+               const CBLAS_DIAG Diag,
+               const int N,
+               const T* A,
+               const int lda,
+               T* x,
+               const int incx);
+
+// B <- alpha * op(A)^-1 * B (Side = CblasLeft) or B <- alpha * B * op(A)^-1
+// (CblasRight), where B is M x N and A is triangular, as in blas_trsv.
+template<typename T>
+void blas_trsm(const CBLAS_SIDE Side,
+               const CBLAS_UPLO Uplo,
+               const CBLAS_TRANSPOSE TransA,
+               const CBLAS_DIAG Diag,
+               const int M,
+               const int N,
+               const T alpha,
+               const T* A,
+               const int lda,
+               T* B,
+               const int ldb);
+
+// C <- alpha * A * A^T + beta * C (Trans = CblasNoTrans, A is N x K) or
+// C <- alpha * A^T * A + beta * C (CblasTrans, A is K x N), where C is N x N
+// symmetric. Only one triangle of C is computed, i.e. half the flops of the
+// equivalent gemm.
+template<typename T>
+void blas_syrk(const CBLAS_UPLO Uplo,
+               const CBLAS_TRANSPOSE Trans,
+               const int N,
+               const int K,
+               const T alpha,
+               const T* A,
+               const int lda,
+               const T beta,
+               T* C,
+               const int ldc);
+
+// A <- alpha * x * x^T + A, where A is N x N symmetric.
+template<typename T>
+void blas_syr(const CBLAS_UPLO Uplo,
+              const int N,
+              const T alpha,
+              const T* x,
+              const int incx,
+              T* A,
+              const int lda);
+
+// Packed form of syr: Ap <- alpha * x * x^T + Ap, where the triangle of
+// Ap is stored as in blas_spmv below.
+template<typename T>
+void blas_spr(const CBLAS_UPLO Uplo,
+              const int N,
+              const T alpha,
+              const T* x,
+              const int incx,
+              T* Ap);
+
+// y <- alpha * A * x + beta * y, where A is N x N symmetric.
+template<typename T>
+void blas_symv(const CBLAS_UPLO Uplo,
+               const int N,
+               const T alpha,
+               const T* A,
+               const int lda,
+               const T* x,
+               const int incx,
+               const T beta,
+               T* y,
+               const int incy);
+
+// x <- op(A) * x, where A is N x N triangular, as in blas_trsv.
+template<typename T>
+void blas_trmv(const CBLAS_UPLO Uplo,
+               const CBLAS_TRANSPOSE TransA,
+               const CBLAS_DIAG Diag,
+               const int N,
+               const T* A,
+               const int lda,
+               T* x,
+               const int incx);
+
+// Packed forms of symv and trmv: the triangle of A is stored row by row in
+// N * (N + 1) / 2 contiguous elements, i.e. its row i is Ap + i * (i + 1) /
+// 2 (its elements 0 to i) for a lower triangle, and Ap + i * (2 * N - i + 1)
+// / 2 (its elements i to N - 1) for an upper one.
+
+template<typename T>
+void blas_spmv(const CBLAS_UPLO Uplo,
+               const int N,
+               const T alpha,
+               const T* Ap,
+               const T* x,
+               const int incx,
+               const T beta,
+               T* y,
+               const int incy);
+
+template<typename T>
+void blas_tpmv(const CBLAS_UPLO Uplo,
+               const CBLAS_TRANSPOSE TransA,
+               const CBLAS_DIAG Diag,
+               const int N,
+               const T* Ap,
+               T* x,
+               const int incx);
+
+// A <- alpha * x * y^T + A, where A is M x N.
+template<typename T>
+void blas_ger(const int M,
+              const int N,
+              const T alpha,
+              const T* x,
+              const int incx,
+              const T* y,
+              const int incy,
+              T* A,
+              const int lda);
+
+// Batched forms of gemm and gemv: the same routine applied to batch_count
+// independent problems of identical shape, e.g. thousands of tiny per-group
+// regressions, for which calling gemm (or gemv) once per problem costs more
+// than the arithmetic itself.
+//
+// Either the i-th operands are A[i], B[i] and C[i] (resp. A[i], x[i] and
+// y[i]), or, in the strided forms, A + i * strideA, B + i * strideB, and
+// C + i * strideC (resp. x + i * stridex, y + i * stridey). The outputs of
+// two problems must not overlap.
+//
+// With MKL, the batched gemm goes through cblas_?gemm_batch. Otherwise,
+// problems no larger than 16 in every dimension are computed by a packed
+// kernel which avoids the BLAS call altogether, larger ones by one BLAS call
+// each. When Insight is built with OpenMP (INSIGHT_USE_OPENMP), the batch
+// is split among threads for problems no larger than 64 in every dimension;
+// larger problems are computed one after another, each one spread among
+// the threads of the BLAS.
+
+template<typename T>
+void blas_gemm_batch(const CBLAS_TRANSPOSE TransA,
+                     const CBLAS_TRANSPOSE TransB,
+                     const int M,
+                     const int N,
+                     const int K,
+                     const T alpha,
+                     const T* const* A,
+                     const int lda,
+                     const T* const* B,
+                     const int ldb,
+                     const T beta,
+                     T* const* C,
+                     const int ldc,
+                     const int batch_count);
+
+template<typename T>
+void blas_gemm_batch(const CBLAS_TRANSPOSE TransA,
+                     const CBLAS_TRANSPOSE TransB,
+                     const int M,
+                     const int N,
+                     const int K,
+                     const T alpha,
+                     const T* A,
+                     const int lda,
+                     const int strideA,
+                     const T* B,
+                     const int ldb,
+                     const int strideB,
+                     const T beta,
+                     T* C,
+                     const int ldc,
+                     const int strideC,
+                     const int batch_count);
+
+template<typename T>
+void blas_gemv_batch(const CBLAS_TRANSPOSE TransA,
+                     const int M,
+                     const int N,
+                     const T alpha,
+                     const T* const* A,
+                     const int lda,
+                     const T* const* x,
+                     const T beta,
+                     T* const* y,
+                     const int batch_count);
+
+template<typename T>
+void blas_gemv_batch(const CBLAS_TRANSPOSE TransA,
+                     const int M,
+                     const int N,
+                     const T alpha,
+                     const T* A,
+                     const int lda,
+                     const int strideA,
+                     const T* x,
+                     const int stridex,
+                     const T beta,
+                     T* y,
+                     const int stridey,
+                     const int batch_count);
+
 // Computes the L2 norm (Euclidian length) of a vector.
 template<typename T>
 T blas_nrm2(const int N, const T* X);
@@ -77,6 +323,31 @@ T blas_nrm2(const int N, const T* X);
 template<typename T>
 T blas_dot(const int N, const T* X, const T* Y);
 
+// Strided forms of the level 1 routines: they read (write) every incX-th
+// element of X (resp. incY-th of Y), e.g. a column of a row-major matrix.
+
+// X <- α * X.
+template<typename T>
+void blas_scal(const int N, const T alpha, T* X, const int incX);
+
+// Y <- alpha * X + Y
+template<typename T>
+void blas_axpy(const int N, const T alpha, const T* X, const int incX, T* Y,
+               const int incY);
+
+// Y <- X
+template<typename T>
+void blas_copy(const int N, const T* X, const int incX, T* Y, const int incY);
+
+// Computes the L2 norm (Euclidian length) of a vector.
+template<typename T>
+T blas_nrm2(const int N, const T* X, const int incX);
+
+// Compute the dot product of two vectors.
+template<typename T>
+T blas_dot(const int N, const T* X, const int incX, const T* Y,
+           const int incY);
+
 // Adds two vectors: Z = X + Y element-wise.
 template<typename T>
 void blas_add(const int N, const T* X, const T* Y, T* Z);
@@ -109,6 +380,93 @@ void blas_exp(const int N, const T* X, T* Y);
 // stores the result in vector Y.
 template<typename T>
 void blas_log(const int N, const T* X, T* Y);
+
+// blas_scal (above), blas_add, blas_sub and blas_mul are also defined for
+// int32_t, wrapping around on overflow.
+template<typename T>
+struct has_blas_arithmetic
+    : public std::integral_constant<bool,
+                                    std::is_floating_point<T>::value ||
+                                    std::is_same<T, int32_t>::value> {};
+
+// Reductions.
+
+// Returns the sum of the elements of X.
+template<typename T>
+T blas_sum(const int N, const T* X);
+
+// Returns the sum of the absolute values of the elements of X.
+template<typename T>
+T blas_asum(const int N, const T* X);
+
+// Returns the smallest (largest) element of X; requires N > 0.
+template<typename T>
+T blas_min(const int N, const T* X);
+
+template<typename T>
+T blas_max(const int N, const T* X);
+
+// Mixed precision routines, for vectors and matrices of the 16-bit floating
+// point types float16 and bfloat16_t (see insight/linalg/half.h).
+
+// Y <- X, converting every element from S to D, where one of S and D is
+// float and the other a 16-bit floating point type. Conversions to 16 bits
+// round to nearest even.
+template<typename S, typename D>
+void blas_convert(const int N, const S* X, D* Y);
+
+// The dot product and L2 norm of vectors of type T, multiplied and
+// accumulated in float.
+template<typename T>
+float blas_mixed_dot(const int N, const T* X, const T* Y);
+
+template<typename T>
+float blas_mixed_nrm2(const int N, const T* X);
+
+// gemv and gemm (leading dimension forms, with contiguous x and y) on
+// operands of type T: the operands are converted to float, a block of rows
+// at a time, multiplied and accumulated by the float routines, and only the
+// results are rounded back to T.
+template<typename T>
+void blas_mixed_gemv(const CBLAS_TRANSPOSE TransA,
+                     const int M,
+                     const int N,
+                     const float alpha,
+                     const T* A,
+                     const int lda,
+                     const T* x,
+                     const float beta,
+                     T* y);
+
+template<typename T>
+void blas_mixed_gemm(const CBLAS_TRANSPOSE TransA,
+                     const CBLAS_TRANSPOSE TransB,
+                     const int M,
+                     const int N,
+                     const int K,
+                     const float alpha,
+                     const T* A,
+                     const int lda,
+                     const T* B,
+                     const int ldb,
+                     const float beta,
+                     T* C,
+                     const int ldc);
+
+// Quantized gemm: C <- A * B^T, where A is an M x K matrix of uint8_t, B an
+// N x K matrix of int8_t (e.g. the weights of a linear layer, one output
+// per row), and C an M x N matrix of int32_t whose consecutive rows are lda
+// (ldb, ldc) elements apart. The products are accumulated exactly, in int32
+// (see insight/linalg/quantize.h).
+void blas_gemm_u8s8s32(const int M,
+                       const int N,
+                       const int K,
+                       const uint8_t* A,
+                       const int lda,
+                       const int8_t* B,
+                       const int ldb,
+                       int32_t* C,
+                       const int ldc);
 }  // namespace linalg_detail
 }  // namespace insight
 
@@ -0,0 +1,322 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_BLOCK_VIEW_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_BLOCK_VIEW_H_
+
+#include <type_traits>
+
+#include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/eval_iterator.h"
+#include "insight/linalg/detail/materialize.h"
+#include "insight/linalg/detail/temporary.h"
+#include "insight/linalg/detail/special_expression_traits.h"
+#include "insight/linalg/detail/special_expression_matmul.h"
+#include "insight/linalg/detail/blas_routines.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+namespace linalg_detail {
+
+// Forward declarations
+template<typename Derived> struct matrix_expression;
+template<typename E> struct transpose_expression;
+
+// Can the matrix expression E be added to a block, row by row, with axpy,
+// i.e is it one of A, a * A or A * a where A is a dense matrix, or a block
+// of one?
+template<typename E>
+struct is_block_axpy_operand
+    : public std::integral_constant<
+  bool,
+  (is_dense_matrix<E>::value ||
+   is_dense_block<E>::value ||
+   special_expression::is_dense_matrix_times_scalar<E>::value) &&
+  std::is_floating_point<typename E::value_type>::value> {};
+
+// Can the matrix expression E be evaluated into a block with a single call
+// to gemm, i.e is it of the form alpha * matmul(aA, bB) (see
+// special_expression_traits.h)?
+template<typename E>
+struct is_block_gemm_operand
+    : public std::integral_constant<
+  bool,
+  special_expression::is_matmul_aAbB<E>::value ||
+  special_expression::is_alpha_times_matmul_aAbB<E>::value> {};
+
+// The row_count by col_count block of a dense matrix whose top left element
+// is at (row_index, col_index), e.g. A.block(1, 2, 3, 4).
+//
+// Its rows are contiguous, ld() (the column count of the matrix) elements
+// apart. The block is read by gemv/gemm, and written by gemm/axpy, in
+// place, through their leading dimension arguments; other expressions are
+// evaluated into it row by row.
+template<typename M>
+struct block_view : public matrix_expression<block_view<M> > {
+ private:
+  using self = block_view;
+
+ public:
+  using value_type = typename M::value_type;
+  using reference = value_type&;
+  using size_type = typename M::size_type;
+  using shape_type = typename M::shape_type;
+  using const_iterator = eval_iterator<self>;
+  using iterator = const_iterator;
+
+  block_view(M* m, size_type row_index, size_type col_index,
+             size_type row_count, size_type col_count)
+      : m_(m),
+        row_index_(row_index),
+        col_index_(col_index),
+        row_count_(row_count),
+        col_count_(col_count) {
+    CHECK_LE(row_index + row_count, m->row_count()) << "invalid block";
+    CHECK_LE(col_index + col_count, m->col_count()) << "invalid block";
+  }
+
+  // Copies the elements of the block b into this block.
+  inline self& operator=(const self& b) {
+    return assign_(b);
+  }
+
+  inline size_type row_count() const { return row_count_; }
+  inline size_type col_count() const { return col_count_; }
+  inline size_type size() const { return row_count_ * col_count_; }
+  inline shape_type shape() const {
+    return shape_type(row_count(), col_count());
+  }
+
+  // The elements of the block are data()[r * ld() + c], for r < row_count()
+  // and c < col_count().
+  inline value_type* data() {
+    return m_->data() + row_index_ * ld() + col_index_;
+  }
+
+  inline const value_type* data() const {
+    return m_->data() + row_index_ * ld() + col_index_;
+  }
+
+  inline size_type ld() const { return m_->col_count(); }
+
+  // Returns a reference to the element at the specified row and column of
+  // the block. No bounds checking is performed.
+  inline reference operator()(size_type row, size_type col) {
+    return data()[row * ld() + col];
+  }
+
+  // Evaluates the element at the given (row-major) index i. No bounds
+  // checking is performed.
+  inline value_type eval(size_type i) const {
+    return data()[(i / col_count_) * ld() + i % col_count_];
+  }
+
+  // Does this block share an element with the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return size() > 0 && data() < last && first < end_of_storage_();
+  }
+
+  // Transpose of this block.
+  inline transpose_expression<self> t() const {
+    return transpose_expression<self>(*this);
+  }
+
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, size()); }
+  inline const_iterator cbegin() const { return begin(); }
+  inline const_iterator cend() const { return end(); }
+
+  // block-scalar arithmetic.
+
+  inline self& operator+=(value_type scalar) {
+    apply_([=](reference x) { x += scalar; });
+    return *this;
+  }
+
+  inline self& operator-=(value_type scalar) {
+    apply_([=](reference x) { x -= scalar; });
+    return *this;
+  }
+
+  inline self& operator*=(value_type scalar) {
+    apply_([=](reference x) { x *= scalar; });
+    return *this;
+  }
+
+  inline self& operator/=(value_type scalar) {
+    apply_([=](reference x) { x /= scalar; });
+    return *this;
+  }
+
+  // block-expression arithmetic.
+
+  template<typename E>
+  inline self& operator=(const matrix_expression<E>& e) {
+    return assign_(e.self());
+  }
+
+  template<typename E>
+  inline self& operator+=(const matrix_expression<E>& e) {
+    check_shape_(e.self());
+    update_(e.self(), value_type(1), [](reference x, value_type y) {
+        x += y;
+      });
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator-=(const matrix_expression<E>& e) {
+    check_shape_(e.self());
+    update_(e.self(), value_type(-1), [](reference x, value_type y) {
+        x -= y;
+      });
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator*=(const matrix_expression<E>& e) {
+    check_shape_(e.self());
+    evaluate_(e.self(), [](reference x, value_type y) { x *= y; });
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator/=(const matrix_expression<E>& e) {
+    check_shape_(e.self());
+    evaluate_(e.self(), [](reference x, value_type y) { x /= y; });
+    return *this;
+  }
+
+ private:
+  struct assign_op {
+    inline void operator()(reference x, value_type y) const { x = y; }
+  };
+
+  // One past the last element of the block, or data() for an empty block.
+  inline const value_type* end_of_storage_() const {
+    if (row_count_ == 0 || col_count_ == 0) return data();
+    return data() + (row_count_ - 1) * ld() + col_count_;
+  }
+
+  template<typename E>
+  inline void check_shape_(const E& e) const {
+    CHECK_EQ(row_count(), e.row_count()) << "block: mismatched dimensions";
+    CHECK_EQ(col_count(), e.col_count()) << "block: mismatched dimensions";
+  }
+
+  template<typename Op>
+  inline void apply_(Op op) {
+    value_type* first = data();
+    for (size_type r = 0; r < row_count_; ++r, first += ld()) {
+      for (size_type c = 0; c < col_count_; ++c) {
+        op(first[c]);
+      }
+    }
+  }
+
+  template<typename E>
+  inline self& assign_(const E& e) {
+    check_shape_(e);
+    if (assign_gemm_(e, std::integral_constant<bool,
+                     is_block_gemm_operand<E>::value>())) {
+      return *this;
+    }
+    evaluate_(e, assign_op());
+    return *this;
+  }
+
+  // Evaluates the product e directly into this block, unless it reads it.
+  template<typename E>
+  inline bool assign_gemm_(const E& e, std::true_type) {
+    if (e.aliases(data(), end_of_storage_())) return false;
+    special_expression::matmul_update(e, value_type(1), value_type(0),
+                                      data(), static_cast<int>(ld()));
+    return true;
+  }
+
+  template<typename E>
+  inline bool assign_gemm_(const E&, std::false_type) { return false; }
+
+  // this (+/-)= e, where sign is +1 for += and -1 for -=.
+  template<typename E, typename Op>
+  inline void update_(const E& e, value_type sign, Op op) {
+    if (!e.aliases(data(), end_of_storage_())) {
+      if (update_blas_(e, sign,
+                       std::integral_constant<bool,
+                       is_block_gemm_operand<E>::value>(),
+                       std::integral_constant<bool,
+                       is_block_axpy_operand<E>::value>())) {
+        return;
+      }
+    }
+    evaluate_(e, op);
+  }
+
+  // gemm, with beta = 1.
+  template<typename E, typename AxpyTag>
+  inline bool update_blas_(const E& e, value_type sign, std::true_type,
+                           AxpyTag) {
+    special_expression::matmul_update(e, sign, value_type(1), data(),
+                                      static_cast<int>(ld()));
+    return true;
+  }
+
+  // axpy, row by row.
+  template<typename E>
+  inline bool update_blas_(const E& e, value_type sign, std::false_type,
+                           std::true_type) {
+    using operand = special_expression::gemm_operand<E>;
+    const value_type alpha = sign * operand::scalar(e);
+    const value_type* x = operand::data(e);
+    const int incx = operand::ld(e);
+    value_type* y = data();
+    for (size_type r = 0; r < row_count_; ++r, x += incx, y += ld()) {
+      blas_axpy(static_cast<int>(col_count_), alpha, x, 1, y, 1);
+    }
+    return true;
+  }
+
+  template<typename E>
+  inline bool update_blas_(const E&, value_type, std::false_type,
+                           std::false_type) {
+    return false;
+  }
+
+  // Applies op(this(r, c), e(r, c)), row by row, through a temporary if e
+  // reads this block.
+  template<typename E, typename Op>
+  inline void evaluate_(const E& e, Op op) {
+    if (e.aliases(data(), end_of_storage_())) {
+      temporary_matrix<value_type> tmp(shape_type(row_count_, col_count_));
+      expression_evaluator<E>(e).assign_noalias(tmp.buffer());
+      evaluate_noalias_(tmp, op);
+    } else {
+      evaluate_noalias_(e, op);
+    }
+  }
+
+  template<typename E, typename Op>
+  inline void evaluate_noalias_(const E& e, Op op) {
+    materialized<E> m(e);
+    const typename materialized<E>::type& x = m.get();
+    value_type* first = data();
+    size_type offset = 0;
+    for (size_type r = 0; r < row_count_; ++r, first += ld()) {
+      for (size_type c = 0; c < col_count_; ++c, ++offset) {
+        op(first[c], x.eval(offset));
+      }
+    }
+  }
+
+  M* m_;
+  size_type row_index_;
+  size_type col_index_;
+  size_type row_count_;
+  size_type col_count_;
+};
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_BLOCK_VIEW_H_
@@ -0,0 +1,753 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_BROADCAST_EXPRESSION_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_BROADCAST_EXPRESSION_H_
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#include "insight/linalg/detail/alias.h"
+#include "insight/linalg/detail/arithmetic_expression.h"
+#include "insight/linalg/detail/eval_iterator.h"
+#include "insight/linalg/detail/materialize.h"
+#include "insight/linalg/detail/scalar_traits.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+namespace linalg_detail {
+
+// Broadcasting.
+//
+// A matrix expression combined (+, -, *, /) with a row vector applies the
+// operation between every row of the matrix and that row vector, e.g.
+// A + b.t() adds b to every row of A. Combined with a (column) vector, it
+// applies the operation between every column of the matrix and that
+// vector, e.g. A - mu subtracts mu[i] from every element of the i-th row
+// of A. The vector may be either operand.
+//
+// A broadcasting expression is lazy, like any other arithmetic expression,
+// so that relu(matmul(X, W) + b.t()) is a gemm followed by a single pass
+// over its result. Its element at the linear index k depends on the row
+// and the column of k, which would cost an integer division per element;
+// instead, a tree containing a broadcast is evaluated row by row, and every
+// node of that tree is evaluated through
+//
+//   eval_at(e, k, row, col);
+//
+// which is e.eval(k) for every expression but broadcasts, which use the
+// row or the column directly.
+
+template<typename E1, typename E2, typename F> class broadcast_expression;
+
+// The role of the operand E in a broadcast: the matrix (0), a column
+// vector, i.e one element per row (1), or a row vector, i.e one element per
+// column (2).
+template<typename E>
+struct broadcast_role
+    : public std::integral_constant<
+  int,
+  is_row_vector<E>::value ? 2 :
+  std::is_base_of<vector_expression<E>, E>::value ? 1 : 0> {};
+
+// Does the expression E contain a broadcast node?
+template<typename E>
+struct contains_broadcast : public std::false_type {};
+
+template<typename E1, typename E2, typename F>
+struct contains_broadcast<broadcast_expression<E1, E2, F> >
+    : public std::true_type {};
+
+template<typename E1, typename E2, typename F>
+struct contains_broadcast<binary_expression<E1, E2, F> >
+    : public std::integral_constant<bool,
+                                    contains_broadcast<E1>::value ||
+                                    contains_broadcast<E2>::value> {};
+
+template<typename E, typename F>
+struct contains_broadcast<unary_expression<E, F> >
+    : public contains_broadcast<E> {};
+
+template<typename E>
+struct contains_broadcast<transpose_expression<E> >
+    : public contains_broadcast<E> {};
+
+// Evaluates the element at the linear index k, in the given row and
+// column, of the expression e.
+template<typename E>
+inline
+typename std::enable_if<!contains_broadcast<E>::value,
+                        typename E::value_type>::type
+eval_at(const E& e, std::size_t k, std::size_t row, std::size_t col) {
+  return e.eval(k);
+}
+
+template<typename E1, typename E2, typename F>
+inline
+typename std::enable_if<
+  contains_broadcast<binary_expression<E1, E2, F> >::value &&
+  !is_scalar<E1>::value && !is_scalar<E2>::value,
+  typename E1::value_type>::type
+eval_at(const binary_expression<E1, E2, F>& e, std::size_t k,
+        std::size_t row, std::size_t col) {
+  return e.f(eval_at(e.e1, k, row, col), eval_at(e.e2, k, row, col));
+}
+
+template<typename E, typename T, typename F>
+inline
+typename std::enable_if<
+  contains_broadcast<E>::value && is_scalar<T>::value, T>::type
+eval_at(const binary_expression<E, T, F>& e, std::size_t k,
+        std::size_t row, std::size_t col) {
+  return e.f(eval_at(e.e, k, row, col), e.scalar);
+}
+
+template<typename T, typename E, typename F>
+inline
+typename std::enable_if<
+  contains_broadcast<E>::value && is_scalar<T>::value, T>::type
+eval_at(const binary_expression<T, E, F>& e, std::size_t k,
+        std::size_t row, std::size_t col) {
+  return e.f(e.scalar, eval_at(e.e, k, row, col));
+}
+
+template<typename E, typename F>
+inline
+typename std::enable_if<contains_broadcast<E>::value,
+                        typename E::value_type>::type
+eval_at(const unary_expression<E, F>& e, std::size_t k, std::size_t row,
+        std::size_t col) {
+  return e.f(eval_at(e.e, k, row, col));
+}
+
+// The transpose of a tree containing a broadcast is evaluated at k.
+template<typename E>
+inline
+typename std::enable_if<contains_broadcast<E>::value,
+                        typename E::value_type>::type
+eval_at(const transpose_expression<E>& e, std::size_t k, std::size_t row,
+        std::size_t col) {
+  return e.eval(k);
+}
+
+template<typename E1, typename E2, typename F>
+inline typename E1::value_type
+eval_at(const broadcast_expression<E1, E2, F>& e, std::size_t k,
+        std::size_t row, std::size_t col) {
+  return e.eval(k, row, col);
+}
+
+// Element-wise arithmetic between a matrix expression and a row or column
+// vector expression, in either order.
+template<typename E1, typename E2, typename F>
+class broadcast_expression
+    : public matrix_expression<broadcast_expression<E1, E2, F> > {
+ private:
+  using self = broadcast_expression<E1, E2, F>;
+
+ public:
+  using value_type = typename E1::value_type;
+  using reference = value_type;
+  using size_type = typename E1::size_type;
+  using shape_type = typename E1::shape_type;
+  using functor_type = F;
+  using const_iterator = eval_iterator<self>;
+  using iterator = const_iterator;
+
+  const E1& e1;
+  const E2& e2;
+  const F f;
+
+  broadcast_expression(const E1& e1, const E2& e2, const F& f)
+      : e1(e1), e2(e2), f(f) {
+    static_assert((broadcast_role<E1>::value == 0) !=
+                  (broadcast_role<E2>::value == 0),
+                  "broadcast: one operand must be the matrix");
+    check_(e2, broadcast_role<E2>());
+    check_(e1, broadcast_role<E1>());
+  }
+
+  inline size_type row_count() const {
+    return broadcast_role<E1>::value == 0 ? e1.row_count() : e2.row_count();
+  }
+
+  inline size_type col_count() const {
+    return broadcast_role<E1>::value == 0 ? e1.col_count() : e2.col_count();
+  }
+
+  inline size_type size() const { return row_count() * col_count(); }
+  inline shape_type shape() const {
+    return shape_type(row_count(), col_count());
+  }
+
+  // Evaluates the element at the given (row-major) linear index.
+  inline value_type eval(size_type k) const {
+    const size_type n = col_count();
+    const size_type row = k / n;
+    return eval(k, row, k - row * n);
+  }
+
+  // Same as above, given the row and the column of k.
+  inline value_type eval(size_type k, size_type row, size_type col) const {
+    return f(operand_(e1, k, row, col, broadcast_role<E1>()),
+             operand_(e2, k, row, col, broadcast_role<E2>()));
+  }
+
+  // Does this expression read any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return e1.aliases(first, last) || e2.aliases(first, last);
+  }
+
+  // Return the transpose of this expression.
+  inline transpose_expression<self> t() const {
+    return transpose_expression<self>(*this);
+  }
+
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator cbegin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, size()); }
+  inline const_iterator cend() const { return const_iterator(this, size()); }
+
+ private:
+  template<typename E>
+  static inline value_type operand_(const E& e, size_type k, size_type row,
+                                    size_type col,
+                                    std::integral_constant<int, 0>) {
+    return eval_at(e, k, row, col);
+  }
+
+  template<typename E>
+  static inline value_type operand_(const E& e, size_type k, size_type row,
+                                    size_type col,
+                                    std::integral_constant<int, 1>) {
+    return e.eval(row);
+  }
+
+  template<typename E>
+  static inline value_type operand_(const E& e, size_type k, size_type row,
+                                    size_type col,
+                                    std::integral_constant<int, 2>) {
+    return e.eval(col);
+  }
+
+  template<typename E>
+  inline void check_(const E& e, std::integral_constant<int, 0>) const {}
+
+  template<typename E>
+  inline void check_(const E& e, std::integral_constant<int, 1>) const {
+    CHECK_EQ(e.size(), row_count()) << "broadcast: mismatched dimensions";
+  }
+
+  template<typename E>
+  inline void check_(const E& e, std::integral_constant<int, 2>) const {
+    CHECK_EQ(e.size(), col_count()) << "broadcast: mismatched dimensions";
+  }
+};
+
+// Alias analysis (see alias.h): the matrix operand is read elementwise,
+// the vector operand is not.
+
+template<typename E1, typename E2, typename F>
+struct alias_analysis<broadcast_expression<E1, E2, F> > {
+  using expression_type = broadcast_expression<E1, E2, F>;
+  using value_type = typename expression_type::value_type;
+
+  static inline bool requires_temporary(const expression_type& e,
+                                        const value_type* first,
+                                        const value_type* last,
+                                        std::false_type) {
+    return operand_requires_temporary_(e.e1, first, last,
+                                       broadcast_role<E1>()) ||
+        operand_requires_temporary_(e.e2, first, last, broadcast_role<E2>());
+  }
+
+ private:
+  template<typename E>
+  static inline bool operand_requires_temporary_(
+      const E& e, const value_type* first, const value_type* last,
+      std::integral_constant<int, 0>) {
+    return linalg_detail::requires_temporary(e, first, last);
+  }
+
+  template<typename E, int N>
+  static inline bool operand_requires_temporary_(
+      const E& e, const value_type* first, const value_type* last,
+      std::integral_constant<int, N>) {
+    return e.aliases(first, last);
+  }
+};
+
+// Materialization (see materialize.h).
+
+template<typename E1, typename E2, typename F>
+struct contains_materialized<broadcast_expression<E1, E2, F> >
+    : public std::integral_constant<bool,
+                                    contains_materialized<E1>::value ||
+                                    contains_materialized<E2>::value> {};
+
+template<typename E1, typename E2, typename F>
+struct materialized<
+  broadcast_expression<E1, E2, F>,
+  typename std::enable_if<
+    contains_materialized<broadcast_expression<E1, E2, F> >::value>::type> {
+  using type = broadcast_expression<typename materialized<E1>::type,
+                                    typename materialized<E2>::type, F>;
+  materialized<E1> m1;
+  materialized<E2> m2;
+  type expr;
+
+  explicit materialized(const broadcast_expression<E1, E2, F>& e)
+      : m1(e.e1), m2(e.e2), expr(m1.get(), m2.get(), e.f) {}
+  inline const type& get() const { return expr; }
+};
+
+// Products of scaled matrices.
+//
+// The product of w * X (or X * w), whose rows are scaled by the column
+// vector w, with a vector v is w * matmul(X, v): X is handed to gemv as
+// is, and the scaling is a pass over the result. Likewise, the product of
+// X * s.t(), whose columns are scaled by s, with v is matmul(X, s * v).
+// Neither evaluates the scaled matrix.
+//
+// The weighted Gram matrix matmul(X.t(), w * X), i.e X^T * diag(w) * X as
+// in weighted least squares, or its other form matmul(X.t() * w.t(), X),
+// is evaluated with syrk over the rows of X scaled by sqrt(w) when w is
+// nonnegative, i.e. in a single pass over X and with half the flops of
+// gemm. Other scaled matrices are evaluated into a temporary before being
+// multiplied, like any other matmul operand.
+
+// The matrix operand and the vector operand of a broadcast, in either
+// order.
+template<typename E1, typename E2,
+         bool MatrixFirst = (broadcast_role<E1>::value == 0)>
+struct broadcast_operands {
+  using matrix_type = E1;
+  using vector_type = E2;
+
+  template<typename F>
+  static inline const E1&
+  matrix_operand(const broadcast_expression<E1, E2, F>& e) { return e.e1; }
+
+  template<typename F>
+  static inline const E2&
+  vector_operand(const broadcast_expression<E1, E2, F>& e) { return e.e2; }
+};
+
+template<typename E1, typename E2>
+struct broadcast_operands<E1, E2, false> {
+  using matrix_type = E2;
+  using vector_type = E1;
+
+  template<typename F>
+  static inline const E2&
+  matrix_operand(const broadcast_expression<E1, E2, F>& e) { return e.e2; }
+
+  template<typename F>
+  static inline const E1&
+  vector_operand(const broadcast_expression<E1, E2, F>& e) { return e.e1; }
+};
+
+// Is E the product of a BLAS operand (see materialize.h), or of a sparse
+// matrix, with a row or a column vector?
+template<typename E>
+struct is_scaled_blas_matrix : public std::false_type {};
+
+template<typename E1, typename E2, typename T>
+struct is_scaled_blas_matrix<broadcast_expression<E1, E2,
+                                                  std::multiplies<T> > >
+    : public std::integral_constant<
+  bool,
+  std::is_floating_point<T>::value &&
+  (is_blas_operand<
+     typename broadcast_operands<E1, E2>::matrix_type>::value ||
+   is_sparse_operand<
+     typename broadcast_operands<E1, E2>::matrix_type>::value)> {};
+
+// Is E the product of the matrix expression M with a vector of the given
+// broadcast role?
+template<typename E, typename M, int Role>
+struct is_weighted_matrix : public std::false_type {};
+
+template<typename E1, typename E2, typename T, typename M, int Role>
+struct is_weighted_matrix<
+  broadcast_expression<E1, E2, std::multiplies<T> >, M, Role>
+    : public std::integral_constant<
+  bool,
+  std::is_floating_point<T>::value &&
+  std::is_same<typename broadcast_operands<E1, E2>::matrix_type,
+               M>::value &&
+  broadcast_role<
+    typename broadcast_operands<E1, E2>::vector_type>::value == Role> {};
+
+// buffer = matmul(w * X, v) = w * matmul(X, v).
+template<typename M, typename W, typename VE>
+inline void scaled_matvec_(const M& X, const W& w, const VE& v,
+                           typename M::value_type* buffer,
+                           std::integral_constant<int, 1>) {
+  using size_type = typename M::size_type;
+  materialize_matmul(matmul_expression<M, VE>(X, v), buffer);
+  materialized<W> mw(w);
+  const size_type n = X.row_count();
+  for (size_type i = 0; i < n; ++i) {
+    buffer[i] *= mw.get().eval(i);
+  }
+}
+
+// buffer = matmul(X * s.t(), v) = matmul(X, s * v).
+template<typename M, typename W, typename VE>
+inline void scaled_matvec_(const M& X, const W& s, const VE& v,
+                           typename M::value_type* buffer,
+                           std::integral_constant<int, 2>) {
+  using value_type = typename M::value_type;
+  using size_type = typename M::size_type;
+  CHECK_EQ(X.col_count(), v.size()) << "matmul: mismatched dimensions";
+  materialized<W> ms(s);
+  materialized<VE> mv(v);
+  const size_type n = v.size();
+  temporary_vector<value_type> sv(n);
+  value_type* t = sv.buffer();
+  for (size_type j = 0; j < n; ++j) {
+    t[j] = ms.get().eval(j) * mv.get().eval(j);
+  }
+  materialize_matmul(matmul_expression<M, temporary_vector<value_type> >(X,
+                                                                         sv),
+                     buffer);
+}
+
+// matmul(w * X, v), matmul(X * s.t(), v), in either order.
+template<typename E1, typename E2, typename T, typename VE>
+inline
+typename std::enable_if<
+  is_scaled_blas_matrix<broadcast_expression<E1, E2,
+                                             std::multiplies<T> > >::value
+  >::type
+materialize_matmul_(
+    const matmul_expression<broadcast_expression<E1, E2,
+                                                 std::multiplies<T> >,
+                            VE>& e,
+    T* buffer, std::true_type) {
+  using operands = broadcast_operands<E1, E2>;
+  scaled_matvec_(operands::matrix_operand(e.m),
+                 operands::vector_operand(e.m),
+                 e.v, buffer,
+                 broadcast_role<typename operands::vector_type>());
+}
+
+// buffer = X^T * diag(w) * X, with syrk, if w is nonnegative. Returns false
+// (and leaves buffer untouched) otherwise.
+template<typename M, typename W>
+inline bool weighted_gram_(const M& X, const W& w,
+                           typename M::value_type* buffer) {
+  using value_type = typename M::value_type;
+  using size_type = typename M::size_type;
+  const size_type n = X.row_count();
+  const size_type p = X.col_count();
+  CHECK_EQ(w.size(), n) << "broadcast: mismatched dimensions";
+
+  materialized<W> mw(w);
+  for (size_type i = 0; i < n; ++i) {
+    if (!(mw.get().eval(i) >= value_type(0))) return false;
+  }
+  if (p == 0) return true;
+
+  temporary_matrix<value_type> S(
+      typename temporary_matrix<value_type>::shape_type(n, p));
+  const value_type* x = X.data();
+  value_type* s = S.buffer();
+  for (size_type i = 0; i < n; ++i, x += p, s += p) {
+    const value_type sqrt_w = std::sqrt(mw.get().eval(i));
+    for (size_type j = 0; j < p; ++j) s[j] = sqrt_w * x[j];
+  }
+  special_expression::symmetric_update(CblasTrans,
+                                       static_cast<int>(p),
+                                       static_cast<int>(n),
+                                       value_type(1),
+                                       S.buffer(),
+                                       static_cast<int>(p),
+                                       value_type(0),
+                                       buffer,
+                                       static_cast<int>(p));
+  return true;
+}
+
+// matmul(X.t(), w * X), in either order of w and X.
+template<typename M, typename E1, typename E2, typename T>
+inline
+typename std::enable_if<
+  is_dense_matrix<M>::value &&
+  is_weighted_matrix<broadcast_expression<E1, E2, std::multiplies<T> >,
+                     M, 1>::value>::type
+materialize_matmul_(
+    const matmul_expression<transpose_expression<M>,
+                            broadcast_expression<E1, E2,
+                                                 std::multiplies<T> > >& e,
+    T* buffer, std::false_type) {
+  using ME2 = broadcast_expression<E1, E2, std::multiplies<T> >;
+  using operands = broadcast_operands<E1, E2>;
+  if (&operands::matrix_operand(e.m2) == &e.m1.e &&
+      weighted_gram_(e.m1.e, operands::vector_operand(e.m2), buffer)) {
+    return;
+  }
+
+  matmul_operand<ME2> m2(e.m2);
+  using product = matmul_expression<transpose_expression<M>,
+                                    typename matmul_operand<ME2>::type>;
+  evaluate_product_(product(e.m1, m2.get()), buffer);
+}
+
+// matmul(X.t() * w.t(), X), in either order of X.t() and w.t().
+template<typename E1, typename E2, typename T, typename M>
+inline
+typename std::enable_if<
+  is_dense_matrix<M>::value &&
+  is_weighted_matrix<broadcast_expression<E1, E2, std::multiplies<T> >,
+                     transpose_expression<M>, 2>::value>::type
+materialize_matmul_(
+    const matmul_expression<broadcast_expression<E1, E2,
+                                                 std::multiplies<T> >,
+                            M>& e,
+    T* buffer, std::false_type) {
+  using ME1 = broadcast_expression<E1, E2, std::multiplies<T> >;
+  using operands = broadcast_operands<E1, E2>;
+  if (&operands::matrix_operand(e.m1).e == &e.m2 &&
+      weighted_gram_(e.m2, operands::vector_operand(e.m1), buffer)) {
+    return;
+  }
+
+  matmul_operand<ME1> m1(e.m1);
+  using product = matmul_expression<typename matmul_operand<ME1>::type, M>;
+  evaluate_product_(product(m1.get(), e.m2), buffer);
+}
+
+// Compound broadcasts, e.g. the bias add A += b.t(): the n x p dense matrix
+// A is updated in place, row by row, with the operation f between every
+// row of A and the row vector v (resp. every column of A and the column
+// vector v). v is evaluated into a temporary first, so that it may read A,
+// as in A -= A.row_at(0).
+
+// A row vector: a[j] = f(a[j], v[j]) for every row a of A.
+template<typename T, typename F>
+inline void broadcast_update_(std::size_t n, std::size_t p, T* A,
+                              const T* v, F f,
+                              std::integral_constant<int, 2>) {
+  for (std::size_t i = 0; i < n; ++i, A += p) {
+    for (std::size_t j = 0; j < p; ++j) A[j] = f(A[j], v[j]);
+  }
+}
+
+// A column vector: a[j] = f(a[j], v[i]) for every row a = A[i].
+template<typename T, typename F>
+inline void broadcast_update_(std::size_t n, std::size_t p, T* A,
+                              const T* v, F f,
+                              std::integral_constant<int, 1>) {
+  for (std::size_t i = 0; i < n; ++i, A += p) {
+    const T vi = v[i];
+    for (std::size_t j = 0; j < p; ++j) A[j] = f(A[j], vi);
+  }
+}
+
+// A op= v, where v is a row or a column vector.
+template<typename T, typename E, typename F>
+inline void broadcast_update(std::size_t n, std::size_t p, T* A,
+                             const E& v, F f) {
+  CHECK_EQ(v.size(), broadcast_role<E>::value == 2 ? p : n)
+      << "broadcast: mismatched dimensions";
+  temporary_vector<T> tmp(v.size());
+  materialized<E> mv(v);
+  T* t = tmp.buffer();
+  for (std::size_t i = 0; i < v.size(); ++i) t[i] = mv.get().eval(i);
+  broadcast_update_(n, p, A, tmp.data(), f, broadcast_role<E>());
+}
+
+// Operators.
+
+// Between a matrix expression and a row vector, in either order.
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  is_row_vector<L>::value != is_row_vector<R>::value,
+  broadcast_expression<L, R, std::plus<typename L::value_type> >
+  >::type
+operator+(const matrix_expression<L>& e1, const matrix_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::plus<typename L::value_type>
+    >(e1.self(), e2.self(), std::plus<typename L::value_type>());
+}
+
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  is_row_vector<L>::value != is_row_vector<R>::value,
+  broadcast_expression<L, R, std::minus<typename L::value_type> >
+  >::type
+operator-(const matrix_expression<L>& e1, const matrix_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::minus<typename L::value_type>
+    >(e1.self(), e2.self(), std::minus<typename L::value_type>());
+}
+
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  is_row_vector<L>::value != is_row_vector<R>::value,
+  broadcast_expression<L, R, std::multiplies<typename L::value_type> >
+  >::type
+operator*(const matrix_expression<L>& e1, const matrix_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::multiplies<typename L::value_type>
+    >(e1.self(), e2.self(), std::multiplies<typename L::value_type>());
+}
+
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  is_row_vector<L>::value != is_row_vector<R>::value,
+  broadcast_expression<L, R, std::divides<typename L::value_type> >
+  >::type
+operator/(const matrix_expression<L>& e1, const matrix_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::divides<typename L::value_type>
+    >(e1.self(), e2.self(), std::divides<typename L::value_type>());
+}
+
+// Between a matrix expression and a (column) vector.
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  !is_row_vector<L>::value,
+  broadcast_expression<L, R, std::plus<typename L::value_type> >
+  >::type
+operator+(const matrix_expression<L>& e1, const vector_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::plus<typename L::value_type>
+    >(e1.self(), e2.self(), std::plus<typename L::value_type>());
+}
+
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  !is_row_vector<L>::value,
+  broadcast_expression<L, R, std::minus<typename L::value_type> >
+  >::type
+operator-(const matrix_expression<L>& e1, const vector_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::minus<typename L::value_type>
+    >(e1.self(), e2.self(), std::minus<typename L::value_type>());
+}
+
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  !is_row_vector<L>::value,
+  broadcast_expression<L, R, std::multiplies<typename L::value_type> >
+  >::type
+operator*(const matrix_expression<L>& e1, const vector_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::multiplies<typename L::value_type>
+    >(e1.self(), e2.self(), std::multiplies<typename L::value_type>());
+}
+
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  !is_row_vector<L>::value,
+  broadcast_expression<L, R, std::divides<typename L::value_type> >
+  >::type
+operator/(const matrix_expression<L>& e1, const vector_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::divides<typename L::value_type>
+    >(e1.self(), e2.self(), std::divides<typename L::value_type>());
+}
+
+// Between a (column) vector and a matrix expression.
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  !is_row_vector<R>::value,
+  broadcast_expression<L, R, std::plus<typename L::value_type> >
+  >::type
+operator+(const vector_expression<L>& e1, const matrix_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::plus<typename L::value_type>
+    >(e1.self(), e2.self(), std::plus<typename L::value_type>());
+}
+
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  !is_row_vector<R>::value,
+  broadcast_expression<L, R, std::minus<typename L::value_type> >
+  >::type
+operator-(const vector_expression<L>& e1, const matrix_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::minus<typename L::value_type>
+    >(e1.self(), e2.self(), std::minus<typename L::value_type>());
+}
+
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  !is_row_vector<R>::value,
+  broadcast_expression<L, R, std::multiplies<typename L::value_type> >
+  >::type
+operator*(const vector_expression<L>& e1, const matrix_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::multiplies<typename L::value_type>
+    >(e1.self(), e2.self(), std::multiplies<typename L::value_type>());
+}
+
+template<typename L, typename R>
+inline
+typename
+std::enable_if<
+  std::is_same<typename L::value_type, typename R::value_type>::value &&
+  !is_row_vector<R>::value,
+  broadcast_expression<L, R, std::divides<typename L::value_type> >
+  >::type
+operator/(const vector_expression<L>& e1, const matrix_expression<R>& e2) {
+  return broadcast_expression<
+    L, R,
+    std::divides<typename L::value_type>
+    >(e1.self(), e2.self(), std::divides<typename L::value_type>());
+}
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_BROADCAST_EXPRESSION_H_
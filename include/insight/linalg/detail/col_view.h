@@ -9,6 +9,8 @@
 #include <iterator>
 
 #include "insight/linalg/detail/jump_iterator.h"
+#include "insight/linalg/detail/strided_evaluator.h"
+
 #include "glog/logging.h"
 
 namespace insight {
@@ -34,7 +36,8 @@ struct col_view : public vector_expression<col_view<M> > {
   using shape_type = typename M::shape_type;
 
   col_view(M* m, size_type col_index)
-      : begin_(std::next(m->begin(), col_index)),
+      : m_(m),
+        begin_(std::next(m->begin(), col_index)),
         end_(m->end()),
         cbegin_(std::next(m->cbegin(), col_index)),
         cend_(m->cend()),
@@ -50,11 +53,38 @@ struct col_view : public vector_expression<col_view<M> > {
     return shape_type(row_count(), col_count());
   }
 
+  // Evaluates the element at the given index i. No bounds checking is
+  // performed.
+  inline value_type eval(size_type i) const {
+    return cbegin_[i * col_count_];
+  }
+
+  // Does the underlying matrix read any element in the range
+  // [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return m_->aliases(first, last);
+  }
+
   // Transpose of this expression.
   inline transpose_expression<self> t() const {
     return transpose_expression<self>(*this);
   }
 
+  // The elements of a column of a dense matrix are stride() apart, starting
+  // at data().
+  inline value_type* data() { return &*begin_; }
+  inline const value_type* data() const { return &*cbegin_; }
+  inline size_type stride() const { return col_count_; }
+
+  // Returns the L2-norm of this column.
+  inline value_type nrm2() const { return strided_nrm2(*this); }
+
+  // Returns the dot product of this column with the vector expression e.
+  template<typename E>
+  inline value_type dot(const vector_expression<E>& e) const {
+    CHECK_EQ(size(), e.self().size());
+    return strided_dot(*this, e.self());
+  }
 
   inline iterator begin() {
     return make_jump_iterator(begin_, col_count_, 0,
@@ -108,18 +138,79 @@ struct col_view : public vector_expression<col_view<M> > {
   // Replaces each and every element in the row by the result of
   // multiplication of that element and a `scalar`.
   inline self& operator*=(value_type scalar) {
-    std::for_each(begin(), end(), [&](reference e) { e *= scalar; });
+    scale_(scalar, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
     return *this;
   }
 
   // Replaces each and every element in the row by the result of
   // dividing that element by a constant `scalar`.
   inline self& operator/=(value_type scalar) {
-    std::for_each(begin(), end(), [&](reference e) { e /= scalar; });
+    div_scalar_(scalar, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    return *this;
+  }
+
+  // col_view-expression arithmetic (see strided_evaluator.h).
+
+  // Copies the elements of the column c into this column.
+  inline self& operator=(const self& c) {
+    CHECK_EQ(size(), c.size());
+    strided_evaluator<self>(c).assign(data(), stride());
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator=(const vector_expression<E>& e) {
+    CHECK_EQ(size(), e.self().size());
+    strided_evaluator<E>(e.self()).assign(data(), stride());
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator+=(const vector_expression<E>& e) {
+    CHECK_EQ(size(), e.self().size());
+    strided_evaluator<E>(e.self()).add(data(), stride());
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator-=(const vector_expression<E>& e) {
+    CHECK_EQ(size(), e.self().size());
+    strided_evaluator<E>(e.self()).sub(data(), stride());
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator*=(const vector_expression<E>& e) {
+    CHECK_EQ(size(), e.self().size());
+    strided_evaluator<E>(e.self()).mul(data(), stride());
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator/=(const vector_expression<E>& e) {
+    CHECK_EQ(size(), e.self().size());
+    strided_evaluator<E>(e.self()).div(data(), stride());
     return *this;
   }
 
  private:
+  inline void scale_(value_type scalar, std::true_type) {
+    blas_scal(size(), scalar, data(), stride());
+  }
+
+  inline void scale_(value_type scalar, std::false_type) {
+    std::for_each(begin(), end(), [&](reference e) { e *= scalar; });
+  }
+
+  inline void div_scalar_(value_type scalar, std::true_type) {
+    blas_scal(size(), value_type(1.0) / scalar, data(), stride());
+  }
+
+  inline void div_scalar_(value_type scalar, std::false_type) {
+    std::for_each(begin(), end(), [&](reference e) { e /= scalar; });
+  }
+
+  const M* m_;
   typename M::iterator begin_;
   typename M::iterator end_;
   typename M::const_iterator cbegin_;
@@ -5,6 +5,8 @@
 #ifndef INCLUDE_INSIGHT_LINALG_DETAIL_DENSE_BASE_H_
 #define INCLUDE_INSIGHT_LINALG_DETAIL_DENSE_BASE_H_
 
+#include <algorithm>
+#include <cstddef>
 #include <utility>
 #include <memory>
 #include <type_traits>
@@ -14,8 +16,30 @@
 
 namespace insight {
 namespace linalg_detail {
-template<typename T, typename Alloc>
-class dense_base {
+
+// Inline storage for up to N elements of a dense_base. Nothing for N == 0.
+template<typename T, std::size_t N>
+class inline_buffer {
+ protected:
+  T* inline_data_() INSIGHT_NOEXCEPT { return buffer_; }
+  const T* inline_data_() const INSIGHT_NOEXCEPT { return buffer_; }
+
+ private:
+  T buffer_[N];
+};
+
+template<typename T>
+class inline_buffer<T, 0> {
+ protected:
+  T* inline_data_() INSIGHT_NOEXCEPT { return nullptr; }
+  const T* inline_data_() const INSIGHT_NOEXCEPT { return nullptr; }
+};
+
+// Storage of vector and matrix. Up to N elements (the small buffer) are
+// stored inline, in which case no memory is requested from the allocator.
+// Only larger containers are allocated on the heap.
+template<typename T, typename Alloc, std::size_t N = 0>
+class dense_base : private inline_buffer<T, N> {
  public:
   using allocator_type = typename std::allocator_traits<Alloc>::template
                      rebind_alloc<T>;
@@ -62,6 +86,52 @@ class dense_base {
     return static_cast<size_type>(end_cap_ - begin_);
   }
 
+  // Returns true if the elements are stored in the small buffer.
+  bool is_inline_() const INSIGHT_NOEXCEPT {
+    return N > 0 && begin_ == this->inline_data_();
+  }
+
+  // Gives the container (which must have no space) space for n > 0
+  // objects: the small buffer if they fit in, or memory from the
+  // allocator.
+  void allocate_(size_type n) {
+    if (n <= N) {
+      begin_ = end_ = this->inline_data_();
+      end_cap_ = begin_ + N;
+    } else {
+      begin_ = end_ = alloc_traits::allocate(alloc_, n);
+      end_cap_ = begin_ + n;
+    }
+  }
+
+  // Releases the space of the container (which must be cleared first),
+  // leaving it with no space at all.
+  void deallocate_() INSIGHT_NOEXCEPT {
+    if (begin_ != nullptr && !is_inline_()) {
+      alloc_traits::deallocate(alloc_, begin_, capacity());
+    }
+    begin_ = end_ = end_cap_ = nullptr;
+  }
+
+  // Moves the elements of b to this container, which must have no space.
+  // The heap memory of b is stolen, elements stored in its small buffer are
+  // copied. b is left with no space.
+  void steal_(dense_base& b) INSIGHT_NOEXCEPT {  // NOLINT
+    if (b.is_inline_()) {
+      begin_ = this->inline_data_();
+      end_ = std::copy(b.begin_, b.end_, begin_);
+      end_cap_ = begin_ + N;
+    } else {
+      begin_ = b.begin_;
+      end_ = b.end_;
+      end_cap_ = b.end_cap_;
+    }
+    b.begin_ = b.end_ = b.end_cap_ = nullptr;
+  }
+
+  // Swaps the elements of this container with that of b.
+  void swap_storage_(dense_base& b) INSIGHT_NOEXCEPT;  // NOLINT
+
   // Destroys all the elements pointed to by pointers in the range
   // [new_end, end_) in reverse order (meaning going from element just
   // before end_ downto the element pointed to by new_end),
@@ -110,7 +180,7 @@ class dense_base {
   void copy_assign_alloc_(const dense_base& b, std::true_type) {
     if (alloc_ != b.alloc_) {
       clear();
-      alloc_traits::deallocate(alloc_, begin_, capacity());
+      deallocate_();
     }
     alloc_ = b.alloc_;
   }
@@ -132,9 +202,9 @@ class dense_base {
   void move_assign_alloc_(dense_base&, std::false_type) INSIGHT_NOEXCEPT {}
 };
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-dense_base<T, Alloc>::dense_base()
+dense_base<T, Alloc, N>::dense_base()
     INSIGHT_NOEXCEPT_IF(std::is_nothrow_default_constructible<allocator_type>::value)  // NOLINT
     : begin_(nullptr),
       end_(nullptr),
@@ -142,9 +212,9 @@ dense_base<T, Alloc>::dense_base()
       alloc_() {
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-dense_base<T, Alloc>::dense_base(const allocator_type& a)
+dense_base<T, Alloc, N>::dense_base(const allocator_type& a)
     INSIGHT_NOEXCEPT_IF(std::is_nothrow_copy_constructible<allocator_type>::value)  // NOLINT
     : begin_(nullptr),
       end_(nullptr),
@@ -152,27 +222,54 @@ dense_base<T, Alloc>::dense_base(const allocator_type& a)
       alloc_(a) {
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-dense_base<T, Alloc>::dense_base(allocator_type&& a) INSIGHT_NOEXCEPT
+dense_base<T, Alloc, N>::dense_base(allocator_type&& a) INSIGHT_NOEXCEPT
     : begin_(nullptr),
       end_(nullptr),
       end_cap_(nullptr),
       alloc_(std::move(a)) {
 }
 
-template<typename T, typename Alloc>
-dense_base<T, Alloc>::~dense_base() {
-  if (begin_ != nullptr) {
-    clear();
-    alloc_traits::deallocate(alloc_, begin_, capacity());
+template<typename T, typename Alloc, std::size_t N>
+dense_base<T, Alloc, N>::~dense_base() {
+  clear();
+  deallocate_();
+}
+
+template<typename T, typename Alloc, std::size_t N>
+void
+dense_base<T, Alloc, N>::swap_storage_(dense_base& b) INSIGHT_NOEXCEPT {
+  using std::swap;
+  const bool a_inline = is_inline_();
+  const bool b_inline = b.is_inline_();
+  if (!a_inline && !b_inline) {
+    swap(begin_, b.begin_);
+    swap(end_, b.end_);
+    swap(end_cap_, b.end_cap_);
+  } else if (a_inline && b_inline) {
+    value_type tmp[N > 0 ? N : 1];
+    pointer tmp_end = std::copy(begin_, end_, tmp);
+    end_ = std::copy(b.begin_, b.end_, begin_);
+    b.end_ = std::copy(tmp, tmp_end, b.begin_);
+  } else if (a_inline) {
+    pointer first = b.inline_data_();
+    pointer last = std::copy(begin_, end_, first);
+    begin_ = b.begin_;
+    end_ = b.end_;
+    end_cap_ = b.end_cap_;
+    b.begin_ = first;
+    b.end_ = last;
+    b.end_cap_ = first + N;
+  } else {
+    b.swap_storage_(*this);
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-dense_base<T, Alloc>::destruct_at_end_(pointer new_end) INSIGHT_NOEXCEPT {
+dense_base<T, Alloc, N>::destruct_at_end_(pointer new_end) INSIGHT_NOEXCEPT {
   destruct_at_end_(new_end, std::integral_constant<bool, std::is_trivially_destructible<value_type>::value>());  // NOLINT
 }
 
@@ -0,0 +1,121 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_DIAGONAL_EXPRESSION_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_DIAGONAL_EXPRESSION_H_
+
+#include <cstddef>
+#include <type_traits>
+
+#include "insight/linalg/detail/arithmetic_expression.h"
+#include "insight/linalg/detail/broadcast_expression.h"
+#include "insight/linalg/detail/eval_iterator.h"
+#include "insight/linalg/detail/materialize.h"
+#include "insight/linalg/detail/transpose_expression.h"
+
+namespace insight {
+namespace linalg_detail {
+
+// The n x n diagonal matrix diag(v) of a vector expression v of size n,
+// which is never stored: its element (i, j) is v[i] if i == j, and zero
+// otherwise.
+//
+// Multiplying a matrix by a diagonal matrix scales its rows (diag(w) * X)
+// or its columns (X * diag(s)), which is exactly a broadcast (see
+// broadcast_expression.h): matmul(diag(w), X) is w * X, matmul(X, diag(s))
+// is X * s.t(), and matmul(diag(w), x) is w * x. These products are lazy,
+// fuse with the rest of the tree they belong to, and are evaluated in a
+// single pass over X; the products of such scaled matrices with a vector
+// or with X.t() are evaluated with gemv or syrk (see broadcast_expression.h).
+//
+// A diagonal matrix in an arithmetic expression, e.g. A + lambda * diag(d),
+// is evaluated row by row, like a broadcast.
+template<typename VE>
+class diagonal_expression
+    : public matrix_expression<diagonal_expression<VE> > {
+ private:
+  using self = diagonal_expression<VE>;
+
+ public:
+  using value_type = typename VE::value_type;
+  using reference = value_type;
+  using size_type = typename VE::size_type;
+  using shape_type = typename VE::shape_type;
+  using const_iterator = eval_iterator<self>;
+  using iterator = const_iterator;
+
+  const VE& v;
+
+  // v as a row vector, i.e the operand of the broadcast matmul(X, diag(v)).
+  const transpose_expression<VE> vt;
+
+  explicit diagonal_expression(const VE& v) : v(v), vt(v) {}
+
+  inline size_type row_count() const { return v.size(); }
+  inline size_type col_count() const { return v.size(); }
+  inline size_type size() const { return row_count() * col_count(); }
+  inline shape_type shape() const {
+    return shape_type(row_count(), col_count());
+  }
+
+  // Evaluates the element at the given (row-major) linear index.
+  inline value_type eval(size_type k) const {
+    const size_type n = col_count();
+    const size_type row = k / n;
+    return eval(k, row, k - row * n);
+  }
+
+  // Same as above, given the row and the column of k.
+  inline value_type eval(size_type k, size_type row, size_type col) const {
+    return (row == col) ? v.eval(row) : value_type(0);
+  }
+
+  // Does this expression read any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return v.aliases(first, last);
+  }
+
+  // A diagonal matrix is its own transpose.
+  inline const self& t() const { return *this; }
+
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator cbegin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, size()); }
+  inline const_iterator cend() const { return const_iterator(this, size()); }
+};
+
+// A diagonal matrix is evaluated row by row, like a broadcast.
+
+template<typename VE>
+struct contains_broadcast<diagonal_expression<VE> > : public std::true_type {};
+
+template<typename VE>
+inline typename VE::value_type
+eval_at(const diagonal_expression<VE>& e, std::size_t k, std::size_t row,
+        std::size_t col) {
+  return e.eval(k, row, col);
+}
+
+// Materialization (see materialize.h).
+
+template<typename VE>
+struct contains_materialized<diagonal_expression<VE> >
+    : public contains_materialized<VE> {};
+
+template<typename VE>
+struct materialized<
+  diagonal_expression<VE>,
+  typename std::enable_if<contains_materialized<VE>::value>::type> {
+  using type = diagonal_expression<typename materialized<VE>::type>;
+  materialized<VE> m;
+  type expr;
+
+  explicit materialized(const diagonal_expression<VE>& e)
+      : m(e.v), expr(m.get()) {}
+  inline const type& get() const { return expr; }
+};
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_DIAGONAL_EXPRESSION_H_
@@ -0,0 +1,128 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_EVAL_ITERATOR_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_EVAL_ITERATOR_H_
+
+#include <cstddef>
+#include <iterator>
+
+namespace insight {
+namespace linalg_detail {
+
+// Read-only random access iterator over the elements of an expression E,
+// that dereferences to e.eval(index). It is the iterator of expressions
+// whose elements are not stored anywhere, nor computed from the iterators
+// of their operands (e.g. reductions).
+template<typename E>
+class eval_iterator {
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = typename E::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = value_type;
+
+  eval_iterator() : e_(nullptr), index_(0) {}
+  eval_iterator(const E* e, difference_type index) : e_(e), index_(index) {}
+
+  const E* expression() const { return e_; }
+  difference_type index() const { return index_; }
+
+  reference operator*() const { return e_->eval(index_); }
+  reference operator[](difference_type n) const {
+    return e_->eval(index_ + n);
+  }
+
+  eval_iterator& operator++() {
+    ++index_;
+    return *this;
+  }
+
+  eval_iterator operator++(int) {
+    eval_iterator tmp(*this);
+    ++index_;
+    return tmp;
+  }
+
+  eval_iterator& operator--() {
+    --index_;
+    return *this;
+  }
+
+  eval_iterator operator--(int) {
+    eval_iterator tmp(*this);
+    --index_;
+    return tmp;
+  }
+
+  eval_iterator& operator+=(difference_type n) {
+    index_ += n;
+    return *this;
+  }
+
+  eval_iterator& operator-=(difference_type n) {
+    index_ -= n;
+    return *this;
+  }
+
+  eval_iterator operator+(difference_type n) const {
+    return eval_iterator(e_, index_ + n);
+  }
+
+  eval_iterator operator-(difference_type n) const {
+    return eval_iterator(e_, index_ - n);
+  }
+
+ private:
+  const E* e_;
+  difference_type index_;
+};
+
+template<typename E>
+inline bool operator==(const eval_iterator<E>& x, const eval_iterator<E>& y) {
+  return x.expression() == y.expression() && x.index() == y.index();
+}
+
+template<typename E>
+inline bool operator!=(const eval_iterator<E>& x, const eval_iterator<E>& y) {
+  return !(x == y);
+}
+
+template<typename E>
+inline bool operator<(const eval_iterator<E>& x, const eval_iterator<E>& y) {
+  return x.index() < y.index();
+}
+
+template<typename E>
+inline bool operator<=(const eval_iterator<E>& x, const eval_iterator<E>& y) {
+  return x.index() <= y.index();
+}
+
+template<typename E>
+inline bool operator>(const eval_iterator<E>& x, const eval_iterator<E>& y) {
+  return x.index() > y.index();
+}
+
+template<typename E>
+inline bool operator>=(const eval_iterator<E>& x, const eval_iterator<E>& y) {
+  return x.index() >= y.index();
+}
+
+template<typename E>
+inline eval_iterator<E>
+operator+(typename eval_iterator<E>::difference_type n,
+          const eval_iterator<E>& x) {
+  return x + n;
+}
+
+template<typename E>
+inline typename eval_iterator<E>::difference_type
+operator-(const eval_iterator<E>& x, const eval_iterator<E>& y) {
+  return x.index() - y.index();
+}
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_EVAL_ITERATOR_H_
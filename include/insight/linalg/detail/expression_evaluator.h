@@ -5,55 +5,205 @@
 #ifndef INCLUDE_INSIGHT_LINALG_DETAIL_EXPRESSION_EVALUATOR_H_
 #define INCLUDE_INSIGHT_LINALG_DETAIL_EXPRESSION_EVALUATOR_H_
 
-#include <algorithm>
-
+#include "insight/linalg/detail/alias.h"
+#include "insight/linalg/detail/broadcast_expression.h"
+#include "insight/linalg/detail/materialize.h"
+#include "insight/linalg/detail/scratch_buffer.h"
 #include "insight/linalg/detail/special_expression_assign.h"
 #include "insight/linalg/detail/special_expression_add.h"
 #include "insight/linalg/detail/special_expression_sub.h"
 #include "insight/linalg/detail/special_expression_mul.h"
 #include "insight/linalg/detail/special_expression_div.h"
+#include "insight/linalg/detail/transpose_kernel.h"
 
 namespace insight {
 namespace linalg_detail {
 
+template<typename E, typename R> class colwise_reduction;
+
+template<typename E, typename R>
+inline void reduce_colwise(const colwise_reduction<E, R>& e,
+                           typename E::value_type* buffer);
+
 // Evaluate a generic expression.
+//
+// Expressions that are not recognized as special expressions (see
+// special_expression_traits.h) are evaluated in a single pass over the
+// destination buffer: every expression node exposes
+//
+//   value_type eval(size_type i) const;
+//
+// which computes the element at the (row-major) linear index i from the
+// eval(i) of its operands. After inlining, an arbitrary tree such as
+// sqrt(a * x + y) / (z - b) becomes one counted loop with no temporaries
+// and no iterator adaptors, which the compiler is free to vectorize.
+//
+// The matmul nodes of such a tree, e.g. exp(matmul(A, x) + b), are first
+// evaluated with gemv/gemm into temporaries (see materialize.h), and the
+// transpose of a matrix expression is evaluated tile by tile (see
+// transpose_kernel.h). Column-wise reductions are materialized like matmul
+// nodes (see reduction.h), and trees containing a broadcast are evaluated
+// row by row (see broadcast_expression.h).
+//
+// assign, add, sub, mul and div may be given a buffer that e itself reads:
+// e is first evaluated into a scratch buffer when it reads it other than
+// elementwise (see alias.h). The *_noalias variants skip that check.
+
+template<typename E, typename Op>
+inline void evaluate_elementwise_(const E& e,
+                                  typename E::value_type* buffer, Op op,
+                                  std::false_type) {
+  using size_type = typename E::size_type;
+  const size_type n = e.size();
+  for (size_type i = 0; i < n; ++i) {
+    op(buffer[i], e.eval(i));
+  }
+}
+
+// A tree containing a broadcast is evaluated row by row, so that its
+// broadcast nodes are given the row and the column of every element (see
+// broadcast_expression.h).
+template<typename E, typename Op>
+inline void evaluate_elementwise_(const E& e,
+                                  typename E::value_type* buffer, Op op,
+                                  std::true_type) {
+  using size_type = typename E::size_type;
+  const size_type m = e.row_count();
+  const size_type n = e.col_count();
+  size_type k = 0;
+  for (size_type i = 0; i < m; ++i) {
+    for (size_type j = 0; j < n; ++j, ++k) {
+      op(buffer[k], eval_at(e, k, i, j));
+    }
+  }
+}
+
+// Applies op(buffer[i], e.eval(i)) to every element of e.
+template<typename E, typename Op>
+inline void evaluate_elementwise(const E& e,
+                                 typename E::value_type* buffer, Op op) {
+  evaluate_elementwise_(e, buffer, op,
+                        std::integral_constant<bool,
+                        contains_broadcast<E>::value>());
+}
+
+// Same as above, for the transpose of a matrix expression: the elements are
+// visited tile by tile, so that both e and buffer are read and written
+// (mostly) contiguously.
+template<typename E, typename Op>
+inline
+typename std::enable_if<std::is_base_of<matrix_expression<E>, E>::value>::type
+evaluate_elementwise(const transpose_expression<E>& e,
+                     typename E::value_type* buffer, Op op) {
+  using size_type = typename E::size_type;
+  const E& m = e.e;
+  transpose(m.row_count(), m.col_count(),
+            [&m](size_type k) { return m.eval(k); }, buffer, op);
+}
+
 template<typename E>
 struct expression_evaluator {
   using value_type = typename E::value_type;
+  using size_type = typename E::size_type;
   const E& e;
 
   explicit expression_evaluator(const E& e) : e(e) {}
 
   // Evaluates the expression e, and copies the result to buffer.
   inline void assign(value_type* buffer) const {
-    assign_(buffer, std::integral_constant<bool, is_special_assignable<E>::value>());  // NOLINT
+    if (requires_temporary(e, buffer, buffer + e.size())) {
+      through_temporary_(buffer, [](value_type& x, value_type y) { x = y; });
+    } else {
+      assign_noalias(buffer);
+    }
   }
 
   // buffer += e: evaluates the expression e, and adds the result to the
   // buffer (element-wise).
   inline void add(value_type* buffer) const {
-    add_(buffer, std::integral_constant<bool, is_special_addable<E>::value>());
+    if (requires_temporary(e, buffer, buffer + e.size())) {
+      through_temporary_(buffer, [](value_type& x, value_type y) { x += y; });
+    } else {
+      add_noalias(buffer);
+    }
   }
 
   // buffer -= e: evaluates the expression e, and subtracts the result from
   // the buffer (element-wise).
   inline void sub(value_type* buffer) const {
-    sub_(buffer, std::integral_constant<bool, is_special_subtractable<E>::value>());  // NOLINT
+    if (requires_temporary(e, buffer, buffer + e.size())) {
+      through_temporary_(buffer, [](value_type& x, value_type y) { x -= y; });
+    } else {
+      sub_noalias(buffer);
+    }
   }
 
   // buffer *= e: evaluates the expression e, and multiplies the result with
   // buffer (element-wise).
   inline void mul(value_type* buffer) const {
-    mul_(buffer, std::integral_constant<bool, is_special_multiplicable<E>::value>());  // NOLINT
+    if (requires_temporary(e, buffer, buffer + e.size())) {
+      through_temporary_(buffer, [](value_type& x, value_type y) { x *= y; });
+    } else {
+      mul_noalias(buffer);
+    }
   }
 
   // buffer /= e: evaluates the expression e, and divides the result by
   // the buffer (element-wise).
   inline void div(value_type* buffer) const {
+    if (requires_temporary(e, buffer, buffer + e.size())) {
+      through_temporary_(buffer, [](value_type& x, value_type y) { x /= y; });
+    } else {
+      div_noalias(buffer);
+    }
+  }
+
+  // Same as above, but always evaluate directly into buffer, i.e assume
+  // that the expression does not read buffer other than elementwise (see
+  // alias.h).
+
+  inline void assign_noalias(value_type* buffer) const {
+    assign_(buffer, std::integral_constant<bool, is_special_assignable<E>::value>());  // NOLINT
+  }
+
+  inline void add_noalias(value_type* buffer) const {
+    add_(buffer, std::integral_constant<bool, is_special_addable<E>::value>());
+  }
+
+  inline void sub_noalias(value_type* buffer) const {
+    sub_(buffer, std::integral_constant<bool, is_special_subtractable<E>::value>());  // NOLINT
+  }
+
+  inline void mul_noalias(value_type* buffer) const {
+    mul_(buffer, std::integral_constant<bool, is_special_multiplicable<E>::value>());  // NOLINT
+  }
+
+  inline void div_noalias(value_type* buffer) const {
     div_(buffer, std::integral_constant<bool, is_special_divisible<E>::value>());  // NOLINT
   }
 
  private:
+  // Evaluates e into a scratch buffer, then applies op(buffer[i], e[i]).
+  template<typename Op>
+  void through_temporary_(value_type* buffer, Op op) const;
+
+  // Applies op(buffer[i], e[i]), with the matmul nodes of e materialized.
+  template<typename Op>
+  void evaluate_(value_type* buffer, Op op) const;
+
+  // buffer = expr, for a generic expression expr. A matmul at the root of
+  // the tree is evaluated directly into buffer.
+  template<typename X>
+  static void assign_generic_(const X& expr, value_type* buffer);
+
+  template<typename E1, typename E2>
+  static void assign_generic_(const matmul_expression<E1, E2>& expr,
+                              value_type* buffer);
+
+  template<typename E1, typename R>
+  static void assign_generic_(const colwise_reduction<E1, R>& expr,
+                              value_type* buffer);
+
   void assign_(value_type* buffer, std::true_type) const;
   void assign_(value_type* buffer, std::false_type) const;
 
@@ -70,6 +220,58 @@ struct expression_evaluator {
   void div_(value_type* buffer, std::false_type) const;
 };
 
+template<typename E>
+template<typename Op>
+inline
+void
+expression_evaluator<E>::through_temporary_(value_type* buffer, Op op) const {
+  const size_type n = e.size();
+  scratch_buffer<value_type> tmp(n);
+  assign_noalias(tmp.data());
+  const value_type* t = tmp.data();
+  for (size_type i = 0; i < n; ++i) {
+    op(buffer[i], t[i]);
+  }
+}
+
+template<typename E>
+template<typename Op>
+inline
+void
+expression_evaluator<E>::evaluate_(value_type* buffer, Op op) const {
+  materialized<E> m(e);
+  evaluate_elementwise(m.get(), buffer, op);
+}
+
+template<typename E>
+template<typename E1, typename E2>
+inline
+void
+expression_evaluator<E>::assign_generic_(
+    const matmul_expression<E1, E2>& expr, value_type* buffer) {
+  materialize_matmul(expr, buffer);
+}
+
+template<typename E>
+template<typename E1, typename R>
+inline
+void
+expression_evaluator<E>::assign_generic_(
+    const colwise_reduction<E1, R>& expr, value_type* buffer) {
+  reduce_colwise(expr, buffer);
+}
+
+template<typename E>
+template<typename X>
+inline
+void
+expression_evaluator<E>::assign_generic_(const X& expr,
+                                         value_type* buffer) {
+  materialized<X> m(expr);
+  evaluate_elementwise(m.get(), buffer,
+                       [](value_type& x, value_type y) { x = y; });
+}
+
 template<typename E>
 inline
 void
@@ -81,7 +283,7 @@ template<typename E>
 inline
 void
 expression_evaluator<E>::assign_(value_type* buffer, std::false_type) const {
-  std::copy(e.begin(), e.end(), buffer);
+  assign_generic_(e, buffer);
 }
 
 template<typename E>
@@ -95,8 +297,7 @@ template<typename E>
 inline
 void
 expression_evaluator<E>::add_(value_type* buffer, std::false_type) const {
-  std::for_each(e.begin(), e.end(),
-                [&](const value_type& e) { *buffer++ += e; });
+  evaluate_(buffer, [](value_type& x, value_type y) { x += y; });
 }
 
 template<typename E>
@@ -110,8 +311,7 @@ template<typename E>
 inline
 void
 expression_evaluator<E>::sub_(value_type* buffer, std::false_type) const {
-  std::for_each(e.begin(), e.end(),
-                [&](const value_type& e) { *buffer++ -= e; });
+  evaluate_(buffer, [](value_type& x, value_type y) { x -= y; });
 }
 
 template<typename E>
@@ -125,8 +325,7 @@ template<typename E>
 inline
 void
 expression_evaluator<E>::mul_(value_type* buffer, std::false_type) const {
-  std::for_each(e.begin(), e.end(),
-                [&](const value_type& e) { *buffer++ *= e; });
+  evaluate_(buffer, [](value_type& x, value_type y) { x *= y; });
 }
 
 template<typename E>
@@ -140,8 +339,7 @@ template<typename E>
 inline
 void
 expression_evaluator<E>::div_(value_type* buffer, std::false_type) const {
-  std::for_each(e.begin(), e.end(),
-                [&](const value_type& e) { *buffer++ /= e; });
+  evaluate_(buffer, [](value_type& x, value_type y) { x /= y; });
 }
 }  // namespace linalg_detail
 }  // namespace insight
@@ -5,17 +5,21 @@
 #ifndef INCLUDE_INSIGHT_LINALG_DETAIL_IS_DENSE_MATRIX_H_
 #define INCLUDE_INSIGHT_LINALG_DETAIL_IS_DENSE_MATRIX_H_
 
+#include <cstddef>
 #include <type_traits>
 
 namespace insight {
 
 // Forward declaration of the matrix class.
-template<typename T, typename A> class vector;
-template<typename T, typename A> class matrix;
+template<typename T, typename A, std::size_t N> class vector;
+template<typename T, typename A, std::size_t N> class matrix;
+template<typename T> class vector_map;
+template<typename T> class matrix_map;
 
 namespace linalg_detail {
 
 template<typename E> struct row_view;
+template<typename E> struct block_view;
 template<typename E> struct transpose_expression;
 
 // Is E a dense matrix but not a matrix expression?
@@ -28,18 +32,52 @@ template<typename E> struct is_dense_matrix<volatile E>
 template<typename E> struct is_dense_matrix<volatile const E>
     : public is_dense_matrix<E>{};
 
-template<typename T, typename A>
-struct is_dense_matrix<insight::matrix<T, A> >: public std::true_type{};
+template<typename T, typename A, std::size_t N>
+struct is_dense_matrix<insight::matrix<T, A, N> >: public std::true_type{};
 
 // Since we have only one kind of vector which is column vector, so
 // a particular row of a dense matrix is also a dense matrix.
-template<typename T, typename A>
+template<typename T, typename A, std::size_t N>
 struct is_dense_matrix<
-  row_view<insight::matrix<T, A> > > : public std::true_type{};
+  row_view<insight::matrix<T, A, N> > > : public std::true_type{};
 
 // Transpose of a dense vector is also a dense matrix.
-template<typename T, typename A>
-struct is_dense_matrix<transpose_expression<insight::vector<T, A> > >
+template<typename T, typename A, std::size_t N>
+struct is_dense_matrix<transpose_expression<insight::vector<T, A, N> > >
+    : public std::true_type{};
+
+// A matrix temporary (see materialize.h) is a dense matrix.
+template<typename T> class temporary_matrix;
+
+template<typename T>
+struct is_dense_matrix<temporary_matrix<T> > : public std::true_type{};
+
+// Maps over external memory (see matrix_map.h and vector_map.h) are laid
+// out exactly like their owning counterparts.
+template<typename T>
+struct is_dense_matrix<insight::matrix_map<T> > : public std::true_type{};
+
+template<typename T>
+struct is_dense_matrix<row_view<insight::matrix_map<T> > >
+    : public std::true_type{};
+
+template<typename T>
+struct is_dense_matrix<transpose_expression<insight::vector_map<T> > >
+    : public std::true_type{};
+
+// Is E a block of a dense matrix (see block_view.h)? Its rows are
+// contiguous, but ld() elements apart rather than adjacent, so that BLAS
+// routines taking a leading dimension can still read (and write) it in
+// place.
+
+template<typename E> struct is_dense_block : public std::false_type{};
+
+template<typename T, typename A, std::size_t N>
+struct is_dense_block<block_view<insight::matrix<T, A, N> > >
+    : public std::true_type{};
+
+template<typename T>
+struct is_dense_block<block_view<insight::matrix_map<T> > >
     : public std::true_type{};
 
 }  // namespace linalg_detail
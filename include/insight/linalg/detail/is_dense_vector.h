@@ -5,14 +5,17 @@
 #ifndef INCLUDE_INSIGHT_LINALG_DETAIL_IS_DENSE_VECTOR_H_
 #define INCLUDE_INSIGHT_LINALG_DETAIL_IS_DENSE_VECTOR_H_
 
+#include <cstddef>
 #include <type_traits>
 
 namespace insight {
 
 // These forward declarations should be here NOT inside the linalg_detail
 // namespace.
-template<typename T, typename A> class vector;
-template<typename T, typename A> class matrix;
+template<typename T, typename A, std::size_t N> class vector;
+template<typename T, typename A, std::size_t N> class matrix;
+template<typename T> class vector_map;
+template<typename T> class matrix_map;
 
 // Is E a dense (column) vector but not a (column) vector expression?
 
@@ -29,8 +32,8 @@ template<typename E> struct is_dense_vector<volatile E>
 template<typename E> struct is_dense_vector<volatile const E>
     : public is_dense_vector<E>{};
 
-template<typename T, typename A>
-struct is_dense_vector<insight::vector<T, A> >
+template<typename T, typename A, std::size_t N>
+struct is_dense_vector<insight::vector<T, A, N> >
     : public std::true_type{};
 
 
@@ -39,11 +42,27 @@ struct is_dense_vector<insight::vector<T, A> >
 template<typename E> struct row_view;
 template<typename E> struct transpose_expression;
 
-template<typename T, typename A>
+template<typename T, typename A, std::size_t N>
 struct is_dense_vector<
-  transpose_expression<row_view<insight::matrix<T, A> > > >
+  transpose_expression<row_view<insight::matrix<T, A, N> > > >
     : public std::true_type{};
 
+// Maps over external memory (see vector_map.h and matrix_map.h) are laid
+// out exactly like their owning counterparts.
+template<typename T>
+struct is_dense_vector<insight::vector_map<T> > : public std::true_type{};
+
+template<typename T>
+struct is_dense_vector<
+  transpose_expression<row_view<insight::matrix_map<T> > > >
+    : public std::true_type{};
+
+// A vector temporary (see materialize.h) is a dense vector.
+template<typename T> class temporary_vector;
+
+template<typename T>
+struct is_dense_vector<temporary_vector<T> > : public std::true_type{};
+
 }  // namespace linalg_detail
 }  // namespace insight
 #endif  // INCLUDE_INSIGHT_LINALG_DETAIL_IS_DENSE_VECTOR_H_
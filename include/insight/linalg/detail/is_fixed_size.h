@@ -0,0 +1,70 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_IS_FIXED_SIZE_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_IS_FIXED_SIZE_H_
+
+#include <cstddef>
+#include <type_traits>
+
+#include "insight/linalg/detail/matmul_expression.h"
+#include "insight/linalg/detail/scalar_traits.h"
+
+namespace insight {
+
+// These forward declarations should be here NOT inside the linalg_detail
+// namespace.
+template<typename T, std::size_t N> class static_vector;
+template<typename T, std::size_t R, std::size_t C> class static_matrix;
+
+namespace linalg_detail {
+
+template<typename E1, typename E2, typename F> struct binary_expression;
+template<typename E, typename F> struct unary_expression;
+template<typename E> struct transpose_expression;
+
+// Is the shape of the expression E known at compile time, i.e is E a
+// static_vector/static_matrix, an elementwise combination of them (and of
+// scalars) or the transpose of one, or a product of two of them? Such
+// expressions are small, and their products are evaluated elementwise
+// rather than through BLAS, unless they are nested (see materialize.h). A
+// single dynamic operand anywhere in E makes it dynamic.
+
+template<typename E> struct is_fixed_size : public std::false_type {};
+
+template<typename T, std::size_t N>
+struct is_fixed_size<insight::static_vector<T, N> > : public std::true_type {};
+
+template<typename T, std::size_t R, std::size_t C>
+struct is_fixed_size<insight::static_matrix<T, R, C> >
+    : public std::true_type {};
+
+// Scalar operands do not change the shape of an elementwise combination.
+template<typename E>
+struct is_fixed_size_operand
+    : public std::integral_constant<bool,
+                                    is_scalar<E>::value ||
+                                    is_fixed_size<E>::value> {};
+
+template<typename E1, typename E2, typename F>
+struct is_fixed_size<binary_expression<E1, E2, F> >
+    : public std::integral_constant<bool,
+                                    is_fixed_size_operand<E1>::value &&
+                                    is_fixed_size_operand<E2>::value> {};
+
+template<typename E, typename F>
+struct is_fixed_size<unary_expression<E, F> > : public is_fixed_size<E> {};
+
+template<typename E>
+struct is_fixed_size<transpose_expression<E> > : public is_fixed_size<E> {};
+
+template<typename E1, typename E2>
+struct is_fixed_size<matmul_expression<E1, E2> >
+    : public std::integral_constant<bool,
+                                    is_fixed_size<E1>::value &&
+                                    is_fixed_size<E2>::value> {};
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_IS_FIXED_SIZE_H_
@@ -0,0 +1,125 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_LAPACK_ROUTINES_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_LAPACK_ROUTINES_H_
+
+#include <type_traits>
+
+#include "insight/linalg/detail/blas_routines.h"
+
+namespace insight {
+namespace linalg_detail {
+
+// Dense factorizations of row-major matrices, with the semantics of their
+// LAPACK namesakes, for float and double.
+//
+// They go through LAPACKE when the BLAS backend provides it (see
+// INSIGHT_USE_LAPACKE), and otherwise through blocked right-looking
+// implementations whose updates of the trailing matrix are BLAS-3 calls
+// (trsm, syrk, gemm), so that they run at about the speed of gemm for
+// large matrices either way.
+//
+// As with blas_gemm, consecutive rows of A (resp. B, C) are lda (resp. ldb,
+// ldc) elements apart.
+
+// Whether T has LAPACK routines.
+template<typename T>
+struct is_lapack_scalar
+    : std::integral_constant<bool,
+                             std::is_same<T, float>::value ||
+                             std::is_same<T, double>::value> {};
+
+// Cholesky factorization A = L * L^T of the N x N symmetric positive
+// definite matrix A. Only the lower triangle of A is read, and it is
+// overwritten by L.
+//
+// Returns 0, or k > 0 if the leading minor of order k of A is not positive
+// definite, in which case the factorization could not be completed.
+template<typename T>
+int lapack_potrf(const int N, T* A, const int lda);
+
+// B <- A^-1 * B, where A holds the Cholesky factorization of an N x N
+// matrix computed by lapack_potrf, and B is N x nrhs.
+template<typename T>
+void lapack_potrs(const int N, const int nrhs, const T* A, const int lda,
+                  T* B, const int ldb);
+
+// LU factorization P * A = L * U of the M x N matrix A, with partial (row)
+// pivoting. A is overwritten by the unit lower triangular (lower
+// trapezoidal if M > N) L, whose unit diagonal is not stored, and by the
+// upper triangular (upper trapezoidal if M < N) U.
+//
+// Row i of A was interchanged with row ipiv[i] - 1, for i = 0, ...,
+// min(M, N) - 1 in that order; as in LAPACK, the pivots are 1-based.
+//
+// Returns 0, or k > 0 if U(k - 1, k - 1) is exactly zero, in which case the
+// factorization was completed but U is singular.
+template<typename T>
+int lapack_getrf(const int M, const int N, T* A, const int lda, int* ipiv);
+
+// B <- A^-1 * B, where A and ipiv hold the LU factorization of an N x N
+// non-singular matrix computed by lapack_getrf, and B is N x nrhs.
+template<typename T>
+void lapack_getrs(const int N, const int nrhs, const T* A, const int lda,
+                  const int* ipiv, T* B, const int ldb);
+
+// QR factorization A = Q * R of the M x N matrix A, with Householder
+// reflections. A is overwritten by the upper triangular (upper trapezoidal
+// if M < N) R, and by the reflectors below the diagonal:
+//
+//   Q = H(0) * H(1) * ... * H(K - 1), where K = min(M, N) and
+//   H(i) = I - tau[i] * v * v^T,
+//
+// v being 0 above row i, 1 on row i, and stored in A(i + 1 : M, i) below.
+template<typename T>
+void lapack_geqrf(const int M, const int N, T* A, const int lda, T* tau);
+
+// C <- op(Q) * C, where op(Q) is either Q (CblasNoTrans) or Q^T
+// (CblasTrans), C is M x nrhs, and Q is given by the K reflectors stored in
+// the M x K matrix A and in tau by lapack_geqrf.
+template<typename T>
+void lapack_ormqr(const CBLAS_TRANSPOSE Trans, const int M, const int nrhs,
+                  const int K, const T* A, const int lda, const T* tau,
+                  T* C, const int ldc);
+
+// Eigendecomposition A = V * diag(W) * V^T of the N x N symmetric matrix
+// A. Only the lower triangle of A is read. The eigenvalues are written to W
+// in ascending order, and A is overwritten by the orthonormal eigenvectors:
+// its i-th column is that of W[i].
+//
+// Returns 0, or k > 0 if the algorithm failed to converge.
+template<typename T>
+int lapack_syevd(const int N, T* A, const int lda, T* W);
+
+// The eigenvalues il to iu (1-based, in ascending order, as in LAPACK) of
+// the N x N symmetric matrix A, written to W, and their eigenvectors,
+// written to the columns of the N x (iu - il + 1) matrix Z. The lower
+// triangle of A is read, and A is destroyed.
+//
+// Returns 0, or k > 0 if the algorithm failed to converge.
+template<typename T>
+int lapack_syevr(const int N, T* A, const int lda, const int il,
+                 const int iu, T* W, T* Z, const int ldz);
+
+// Thin singular value decomposition A = U * diag(S) * VT of the M x N
+// matrix A: with K = min(M, N), U is M x K and VT is K x N, both with
+// orthonormal columns (resp. rows), and the K singular values are written
+// to S in descending order. A is destroyed.
+//
+// Returns 0, or k > 0 if the algorithm failed to converge.
+template<typename T>
+int lapack_gesdd(const int M, const int N, T* A, const int lda, T* S, T* U,
+                 const int ldu, T* VT, const int ldvt);
+
+// B <- A^-1 * B, where A is the N x N lower (Uplo = CblasLower) or upper
+// (CblasUpper) triangle of A, e.g. the R of lapack_geqrf, and B is N x nrhs.
+// A must not be singular.
+template<typename T>
+void lapack_trtrs(const CBLAS_UPLO Uplo, const int N, const int nrhs,
+                  const T* A, const int lda, T* B, const int ldb);
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_LAPACK_ROUTINES_H_
@@ -0,0 +1,468 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_MATERIALIZE_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_MATERIALIZE_H_
+
+#include <type_traits>
+
+#include "insight/linalg/detail/is_fixed_size.h"
+#include "insight/linalg/detail/mixed_precision.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/sparse_format.h"
+#include "insight/linalg/detail/special_expression_assign.h"
+#include "insight/linalg/detail/temporary.h"
+#include "insight/linalg/detail/triangular_layout.h"
+
+namespace insight {
+namespace linalg_detail {
+
+template<typename E> struct expression_evaluator;
+
+// Materialization of matmul subexpressions.
+//
+// A generic expression is evaluated in a single pass through eval(i) (see
+// expression_evaluator.h). That is fine as long as every node is cheap to
+// evaluate at a given index, but an element of a matmul is a whole dot
+// product, so that e.g. exp(matmul(A, x) + b) would neither use gemv nor
+// be evaluated any faster than a naive triple loop.
+//
+// Instead, every matmul node in a tree is evaluated once, with gemv/gemm,
+// into a temporary_vector/temporary_matrix (whose storage comes from the
+// scratch buffer pool), and the rest of the tree is rebuilt over these
+// temporaries and evaluated elementwise as usual:
+//
+//   materialized<E> m(e);          // runs the gemv/gemm(s)
+//   m.get().eval(i);               // fused over the temporaries
+//
+// The operands of a matmul that BLAS cannot read directly (e.g. the
+// matmul(W, relu(x)) case) are evaluated into temporaries first.
+//
+// Transposes of expressions are not materialized: they remain an index
+// permutation over their (materialized) operand.
+//
+// Neither are products of fixed-size operands (see is_fixed_size.h) that
+// contain no product themselves: they are too small for BLAS to pay off,
+// and are evaluated elementwise through eval(i). A nested product, e.g
+// matmul(matmul(A, B), C), is still materialized, since evaluating it
+// through eval(i) would recompute the inner product for every element of
+// the outer one.
+
+// Does the expression E contain a matmul node?
+template<typename E>
+struct contains_matmul : public std::false_type {};
+
+template<typename E1, typename E2>
+struct contains_matmul<matmul_expression<E1, E2> > : public std::true_type {};
+
+template<typename E1, typename E2, typename F>
+struct contains_matmul<binary_expression<E1, E2, F> >
+    : public std::integral_constant<bool,
+                                    contains_matmul<E1>::value ||
+                                    contains_matmul<E2>::value> {};
+
+template<typename E, typename F>
+struct contains_matmul<unary_expression<E, F> > : public contains_matmul<E> {};
+
+template<typename E>
+struct contains_matmul<transpose_expression<E> >
+    : public contains_matmul<E> {};
+
+// Is the matmul expression P a product of fixed-size operands, none of
+// which contains a product, i.e one that is evaluated elementwise?
+template<typename P> struct is_elementwise_product;
+
+template<typename E1, typename E2>
+struct is_elementwise_product<matmul_expression<E1, E2> >
+    : public std::integral_constant<bool,
+                                    is_fixed_size<
+                                      matmul_expression<E1, E2> >::value &&
+                                    !contains_matmul<E1>::value &&
+                                    !contains_matmul<E2>::value> {};
+
+// Does the expression E contain a node that is materialized, i.e a matmul
+// (or a column-wise reduction, see reduction.h)?
+template<typename E>
+struct contains_materialized : public std::false_type {};
+
+template<typename E1, typename E2>
+struct contains_materialized<matmul_expression<E1, E2> >
+    : public std::integral_constant<bool,
+                                    !is_elementwise_product<
+                                      matmul_expression<E1, E2> >::value> {};
+
+template<typename E1, typename E2, typename F>
+struct contains_materialized<binary_expression<E1, E2, F> >
+    : public std::integral_constant<bool,
+                                    contains_materialized<E1>::value ||
+                                    contains_materialized<E2>::value> {};
+
+template<typename E, typename F>
+struct contains_materialized<unary_expression<E, F> >
+    : public contains_materialized<E> {};
+
+template<typename E>
+struct contains_materialized<transpose_expression<E> >
+    : public contains_materialized<E> {};
+
+// Can a BLAS routine read the expression E, as a matmul operand, directly?
+template<typename E>
+struct is_blas_operand
+    : public std::integral_constant<bool,
+                                    is_dense_vector<E>::value ||
+                                    special_expression::
+                                    is_dense_vector_times_scalar<E>::value ||
+                                    special_expression::
+                                    is_gemm_operand<E>::value> {};
+
+// An operand of a matmul, as seen by BLAS: either the operand itself, or
+// a temporary holding its value.
+template<typename E, typename Enable = void>
+struct matmul_operand {
+  using type = E;
+  const E& e;
+
+  explicit matmul_operand(const E& e) : e(e) {}
+  inline const type& get() const { return e; }
+};
+
+template<typename E>
+struct matmul_operand<
+  E,
+  typename std::enable_if<
+    !is_blas_operand<E>::value &&
+    std::is_base_of<vector_expression<E>, E>::value>::type> {
+  using type = temporary_vector<typename E::value_type>;
+  type tmp;
+
+  explicit matmul_operand(const E& e) : tmp(e.size()) {
+    expression_evaluator<E>(e).assign_noalias(tmp.buffer());
+  }
+  inline const type& get() const { return tmp; }
+};
+
+template<typename E>
+struct matmul_operand<
+  E,
+  typename std::enable_if<
+    !is_blas_operand<E>::value &&
+    std::is_base_of<matrix_expression<E>, E>::value>::type> {
+  using type = temporary_matrix<typename E::value_type>;
+  type tmp;
+
+  explicit matmul_operand(const E& e)
+      : tmp(typename type::shape_type(e.row_count(), e.col_count())) {
+    expression_evaluator<E>(e).assign_noalias(tmp.buffer());
+  }
+  inline const type& get() const { return tmp; }
+};
+
+// The matrix operand of a matrix-vector product: symmetric and triangular
+// matrices (and transposes of the latter) are read directly by symv/spmv
+// and trmv/tpmv, and sparse matrices (and their transposes) by the sparse
+// kernels, instead of being expanded into a dense temporary.
+template<typename E, typename Enable = void>
+struct matvec_operand : public matmul_operand<E> {
+  explicit matvec_operand(const E& e) : matmul_operand<E>(e) {}
+};
+
+template<typename E>
+struct matvec_operand<
+  E,
+  typename std::enable_if<
+    (is_structured_matrix<E>::value || is_sparse_operand<E>::value) &&
+    std::is_floating_point<typename E::value_type>::value>::type> {
+  using type = E;
+  const E& e;
+
+  explicit matvec_operand(const E& e) : e(e) {}
+  inline const type& get() const { return e; }
+};
+
+// Evaluates the product p (whose operands are BLAS operands) into buffer.
+template<typename P>
+inline void evaluate_product_(const P& p, typename P::value_type* buffer,
+                              std::true_type) {
+  special_expression::assign(p, buffer);
+}
+
+// No BLAS routine for P (e.g. integral types).
+template<typename P>
+inline void evaluate_product_(const P& p, typename P::value_type* buffer,
+                              std::false_type) {
+  using size_type = typename P::size_type;
+  const size_type n = p.size();
+  for (size_type i = 0; i < n; ++i) {
+    buffer[i] = p.eval(i);
+  }
+}
+
+// No BLAS routine for P, but its operands are 16-bit floating point BLAS
+// operands: multiplied in float (see mixed_precision.h).
+template<typename P>
+inline void evaluate_product_(const P& p, typename P::value_type* buffer,
+                              std::false_type, std::true_type) {
+  mixed_matmul(p, buffer);
+}
+
+template<typename P>
+inline void evaluate_product_(const P& p, typename P::value_type* buffer,
+                              std::false_type, std::false_type) {
+  evaluate_product_(p, buffer, std::false_type());
+}
+
+template<typename P, typename Mixed>
+inline void evaluate_product_(const P& p, typename P::value_type* buffer,
+                              std::true_type, Mixed) {
+  evaluate_product_(p, buffer, std::true_type());
+}
+
+template<typename P>
+inline void evaluate_product_(const P& p, typename P::value_type* buffer) {
+  evaluate_product_(p, buffer,
+                    std::integral_constant<bool,
+                    is_special_assignable<P>::value>(),
+                    is_mixed_precision<typename P::value_type>());
+}
+
+// matrix-vector.
+template<typename ME, typename VE>
+inline void materialize_matmul_(const matmul_expression<ME, VE>& e,
+                                typename ME::value_type* buffer,
+                                std::true_type) {
+  matvec_operand<ME> m(e.m);
+  matmul_operand<VE> v(e.v);
+  using product = matmul_expression<typename matvec_operand<ME>::type,
+                                    typename matmul_operand<VE>::type>;
+  evaluate_product_(product(m.get(), v.get()), buffer);
+}
+
+// matrix-matrix.
+template<typename ME1, typename ME2>
+inline void materialize_matmul_(const matmul_expression<ME1, ME2>& e,
+                                typename ME1::value_type* buffer,
+                                std::false_type) {
+  matmul_operand<ME1> m1(e.m1);
+  matmul_operand<ME2> m2(e.m2);
+  using product = matmul_expression<typename matmul_operand<ME1>::type,
+                                    typename matmul_operand<ME2>::type>;
+  evaluate_product_(product(m1.get(), m2.get()), buffer);
+}
+
+// outer product, with ger. A product of 16-bit floating point vectors has
+// nothing to accumulate, and is evaluated elementwise.
+template<typename VE1, typename VE2>
+inline typename std::enable_if<
+  std::is_base_of<vector_expression<VE1>, VE1>::value>::type
+materialize_matmul_(const matmul_expression<VE1,
+                    transpose_expression<VE2> >& e,
+                    typename VE1::value_type* buffer,
+                    std::false_type) {
+  matmul_operand<VE1> u(e.u);
+  matmul_operand<VE2> v(e.vt.e);
+  using vt_type = transpose_expression<typename matmul_operand<VE2>::type>;
+  using product = matmul_expression<typename matmul_operand<VE1>::type,
+                                    vt_type>;
+  const vt_type vt(v.get());
+  evaluate_product_(product(u.get(), vt), buffer,
+                    std::integral_constant<bool,
+                    is_special_assignable<product>::value>());
+}
+
+// The right operand of a matrix-matrix product whose left operand is a
+// sparse matrix: the sparse kernels read it by rows, so that it is
+// evaluated into a temporary unless it is a (scaled) dense matrix or a
+// block of one.
+template<typename E, typename Enable = void>
+struct sparse_matmul_operand {
+  using type = temporary_matrix<typename E::value_type>;
+  type tmp;
+
+  explicit sparse_matmul_operand(const E& e)
+      : tmp(typename type::shape_type(e.row_count(), e.col_count())) {
+    expression_evaluator<E>(e).assign_noalias(tmp.buffer());
+  }
+  inline const type& get() const { return tmp; }
+};
+
+template<typename E>
+struct sparse_matmul_operand<
+  E,
+  typename std::enable_if<
+    is_dense_matrix<E>::value ||
+    special_expression::is_dense_matrix_times_scalar<E>::value ||
+    is_dense_block<E>::value>::type> {
+  using type = E;
+  const E& e;
+
+  explicit sparse_matmul_operand(const E& e) : e(e) {}
+  inline const type& get() const { return e; }
+};
+
+// sparse-matrix, the sparse matrix being read as is.
+template<typename ME1, typename ME2>
+inline void materialize_sparse_matmul_(const matmul_expression<ME1, ME2>& e,
+                                       typename ME1::value_type* buffer) {
+  sparse_matmul_operand<ME2> m2(e.m2);
+  using product = matmul_expression<ME1,
+                                    typename sparse_matmul_operand<ME2>::type>;
+  evaluate_product_(product(e.m1, m2.get()), buffer);
+}
+
+template<typename T, sparse_format F, typename ME2>
+inline void materialize_matmul_(
+    const matmul_expression<insight::sparse_matrix<T, F>, ME2>& e,
+    T* buffer, std::false_type) {
+  materialize_sparse_matmul_(e, buffer);
+}
+
+template<typename T, sparse_format F, typename ME2>
+inline void materialize_matmul_(
+    const matmul_expression<transpose_expression<
+                              insight::sparse_matrix<T, F> >, ME2>& e,
+    T* buffer, std::false_type) {
+  materialize_sparse_matmul_(e, buffer);
+}
+
+// Evaluates the matmul expression e into buffer, using gemv/gemm whenever
+// the element type allows it, and e is not an elementwise product.
+template<typename E1, typename E2>
+inline void materialize_matmul(const matmul_expression<E1, E2>& e,
+                               typename E1::value_type* buffer) {
+  if (is_elementwise_product<matmul_expression<E1, E2> >::value) {
+    evaluate_product_(e, buffer, std::false_type());
+  } else {
+    materialize_matmul_(e, buffer,
+                        std::integral_constant<bool,
+                        std::is_base_of<vector_expression<E2>,
+                        E2>::value>());
+  }
+}
+
+// materialized<E> holds the expression E with all of its matmul nodes
+// replaced by temporaries; get() returns that (rebuilt) expression, of type
+// materialized<E>::type.
+template<typename E, typename Enable = void>
+struct materialized {
+  using type = E;
+  const E& e;
+
+  explicit materialized(const E& e) : e(e) {}
+  inline const type& get() const { return e; }
+};
+
+// matrix-vector product.
+template<typename ME, typename VE>
+struct materialized<
+  matmul_expression<ME, VE>,
+  typename std::enable_if<
+    contains_materialized<matmul_expression<ME, VE> >::value &&
+    std::is_base_of<vector_expression<VE>, VE>::value>::type> {
+  using type = temporary_vector<typename ME::value_type>;
+  type tmp;
+
+  explicit materialized(const matmul_expression<ME, VE>& e)
+      : tmp(e.size()) {
+    materialize_matmul(e, tmp.buffer());
+  }
+  inline const type& get() const { return tmp; }
+};
+
+// matrix-matrix product.
+template<typename ME1, typename ME2>
+struct materialized<
+  matmul_expression<ME1, ME2>,
+  typename std::enable_if<
+    contains_materialized<matmul_expression<ME1, ME2> >::value &&
+    std::is_base_of<matrix_expression<ME2>, ME2>::value>::type> {
+  using type = temporary_matrix<typename ME1::value_type>;
+  type tmp;
+
+  explicit materialized(const matmul_expression<ME1, ME2>& e)
+      : tmp(typename type::shape_type(e.row_count(), e.col_count())) {
+    materialize_matmul(e, tmp.buffer());
+  }
+  inline const type& get() const { return tmp; }
+};
+
+// expression-expression.
+template<typename E1, typename E2, typename F>
+struct materialized<
+  binary_expression<E1, E2, F>,
+  typename std::enable_if<
+    contains_materialized<binary_expression<E1, E2, F> >::value &&
+    !is_scalar<E1>::value &&
+    !is_scalar<E2>::value>::type> {
+  using type = binary_expression<typename materialized<E1>::type,
+                                 typename materialized<E2>::type, F>;
+  materialized<E1> m1;
+  materialized<E2> m2;
+  type expr;
+
+  explicit materialized(const binary_expression<E1, E2, F>& e)
+      : m1(e.e1), m2(e.e2), expr(m1.get(), m2.get(), e.f) {}
+  inline const type& get() const { return expr; }
+};
+
+// expression-scalar.
+template<typename E, typename F>
+struct materialized<
+  binary_expression<E, typename E::value_type, F>,
+  typename std::enable_if<contains_materialized<E>::value>::type> {
+  using type = binary_expression<typename materialized<E>::type,
+                                 typename E::value_type, F>;
+  materialized<E> m;
+  type expr;
+
+  explicit materialized(
+      const binary_expression<E, typename E::value_type, F>& e)
+      : m(e.e), expr(m.get(), e.scalar, e.f) {}
+  inline const type& get() const { return expr; }
+};
+
+// scalar-expression.
+template<typename E, typename F>
+struct materialized<
+  binary_expression<typename E::value_type, E, F>,
+  typename std::enable_if<contains_materialized<E>::value>::type> {
+  using type = binary_expression<typename E::value_type,
+                                 typename materialized<E>::type, F>;
+  materialized<E> m;
+  type expr;
+
+  explicit materialized(
+      const binary_expression<typename E::value_type, E, F>& e)
+      : m(e.e), expr(e.scalar, m.get(), e.f) {}
+  inline const type& get() const { return expr; }
+};
+
+template<typename E, typename F>
+struct materialized<
+  unary_expression<E, F>,
+  typename std::enable_if<contains_materialized<E>::value>::type> {
+  using type = unary_expression<typename materialized<E>::type, F>;
+  materialized<E> m;
+  type expr;
+
+  explicit materialized(const unary_expression<E, F>& e)
+      : m(e.e), expr(m.get(), e.f) {}
+  inline const type& get() const { return expr; }
+};
+
+template<typename E>
+struct materialized<
+  transpose_expression<E>,
+  typename std::enable_if<contains_materialized<E>::value>::type> {
+  using type = transpose_expression<typename materialized<E>::type>;
+  materialized<E> m;
+  type expr;
+
+  explicit materialized(const transpose_expression<E>& e)
+      : m(e.e), expr(m.get()) {}
+  inline const type& get() const { return expr; }
+};
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_MATERIALIZE_H_
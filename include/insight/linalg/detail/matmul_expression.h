@@ -9,6 +9,9 @@
 #include <iterator>
 #include <type_traits>
 
+#include "insight/linalg/detail/eval_iterator.h"
+#include "insight/linalg/detail/scalar_traits.h"
+
 #include "glog/logging.h"
 
 namespace insight {
@@ -16,10 +19,14 @@ namespace linalg_detail {
 
 template<typename Derived> struct vector_expression;
 template<typename Derived> struct matrix_expression;
+template<typename E> class transpose_expression;
 
 template<typename MatrixIter, typename VectorIter>
 class matrix_vector_multiplication_iterator;
 
+template<typename LeftIter, typename RightIter>
+class matrix_matrix_multiplication_iterator;
+
 template<typename ME, typename VE, typename Enable = void>
 class matmul_expression;
 
@@ -59,6 +66,23 @@ class matmul_expression<
     return shape_type(row_count(), col_count());
   }
 
+  // Evaluates the i-th element of the product, i.e the dot product of the
+  // i-th row of m and v.
+  inline value_type eval(size_type i) const {
+    const size_type n = m.col_count();
+    const size_type offset = i * n;
+    typename accumulator<value_type>::type result = 0;
+    for (size_type k = 0; k < n; ++k) {
+      result += m.eval(offset + k) * v.eval(k);
+    }
+    return result;
+  }
+
+  // Does this expression read any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return m.aliases(first, last) || v.aliases(first, last);
+  }
+
   inline const_iterator begin() const {
     return const_iterator(m.cbegin(), 0, v.cbegin(), v.cend());
   }
@@ -76,6 +100,150 @@ class matmul_expression<
   }
 };
 
+// multiplication between two generic matrix expressions.
+template<typename ME1, typename ME2>
+class matmul_expression<
+  ME1,
+  ME2,
+  typename std::enable_if<
+    std::is_base_of<matrix_expression<ME1>, ME1>::value &&
+    std::is_base_of<matrix_expression<ME2>, ME2>::value &&
+    std::is_same<typename ME1::value_type, typename ME2::value_type>::value,
+    void>::type>
+    : public matrix_expression<matmul_expression<ME1, ME2> > {
+ public:
+  using value_type = typename ME1::value_type;
+  using reference = value_type;
+  using size_type = typename ME1::size_type;
+  using shape_type = typename ME1::shape_type;
+  using const_iterator =
+      matrix_matrix_multiplication_iterator<typename ME1::const_iterator,
+                                            typename ME2::const_iterator>;
+  using iterator = const_iterator;
+
+  const ME1& m1;
+  const ME2& m2;
+
+  matmul_expression(const ME1& m1, const ME2& m2) : m1(m1), m2(m2) {
+    CHECK_EQ(m1.col_count(), m2.row_count()) << "matmul: mismatched "
+                                             << "dimensions";
+  }
+
+  inline size_type row_count() const { return m1.row_count(); }
+  inline size_type col_count() const { return m2.col_count(); }
+  inline size_type size() const { return row_count() * col_count(); }
+  inline shape_type shape() const {
+    return shape_type(row_count(), col_count());
+  }
+
+  // Evaluates the element at the given (row-major) linear index i, i.e the
+  // dot product of the row i / col_count() of m1 and the column
+  // i % col_count() of m2.
+  inline value_type eval(size_type i) const {
+    const size_type n = m1.col_count();
+    const size_type p = m2.col_count();
+    const size_type offset = (i / p) * n;
+    const size_type col = i % p;
+    typename accumulator<value_type>::type result = 0;
+    for (size_type k = 0; k < n; ++k) {
+      result += m1.eval(offset + k) * m2.eval(k * p + col);
+    }
+    return result;
+  }
+
+  // Does this expression read any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return m1.aliases(first, last) || m2.aliases(first, last);
+  }
+
+  // Returns the transpose of this expression.
+  inline transpose_expression<matmul_expression> t() const {
+    return transpose_expression<matmul_expression>(*this);
+  }
+
+  inline const_iterator begin() const {
+    return const_iterator(m1.cbegin(), m2.cbegin(), 0, m1.col_count(),
+                          m2.col_count());
+  }
+
+  inline const_iterator cbegin() const {
+    return const_iterator(m1.cbegin(), m2.cbegin(), 0, m1.col_count(),
+                          m2.col_count());
+  }
+
+  inline const_iterator end() const {
+    return const_iterator(m1.cbegin(), m2.cbegin(), size(), m1.col_count(),
+                          m2.col_count());
+  }
+
+  inline const_iterator cend() const {
+    return const_iterator(m1.cbegin(), m2.cbegin(), size(), m1.col_count(),
+                          m2.col_count());
+  }
+};
+
+// outer product of two generic vector expressions, i.e matmul(u, v.t()),
+// whose (i, j) element is u[i] * v[j].
+template<typename VE1, typename VE2>
+class matmul_expression<
+  VE1,
+  transpose_expression<VE2>,
+  typename std::enable_if<
+    std::is_base_of<vector_expression<VE1>, VE1>::value &&
+    std::is_base_of<vector_expression<VE2>, VE2>::value &&
+    std::is_same<typename VE1::value_type, typename VE2::value_type>::value,
+    void>::type>
+    : public matrix_expression<
+  matmul_expression<VE1, transpose_expression<VE2> > > {
+ private:
+  using self = matmul_expression<VE1, transpose_expression<VE2> >;
+
+ public:
+  using value_type = typename VE1::value_type;
+  using reference = value_type;
+  using size_type = typename VE1::size_type;
+  using shape_type = typename VE1::shape_type;
+  using const_iterator = eval_iterator<self>;
+  using iterator = const_iterator;
+
+  const VE1& u;
+  const transpose_expression<VE2>& vt;
+
+  matmul_expression(const VE1& u, const transpose_expression<VE2>& vt)
+      : u(u), vt(vt) {}
+
+  inline size_type row_count() const { return u.size(); }
+  inline size_type col_count() const { return vt.e.size(); }
+  inline size_type size() const { return row_count() * col_count(); }
+  inline shape_type shape() const {
+    return shape_type(row_count(), col_count());
+  }
+
+  // Evaluates the element at the given (row-major) linear index i, i.e
+  // u[i / col_count()] * v[i % col_count()].
+  inline value_type eval(size_type i) const {
+    const size_type n = col_count();
+    return u.eval(i / n) * vt.e.eval(i % n);
+  }
+
+  // Does this expression read any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return u.aliases(first, last) || vt.aliases(first, last);
+  }
+
+  // Returns the transpose of this expression.
+  inline transpose_expression<self> t() const {
+    return transpose_expression<self>(*this);
+  }
+
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator cbegin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, size()); }
+  inline const_iterator cend() const {
+    return const_iterator(this, size());
+  }
+};
+
 template<typename MatrixIter, typename VectorIter>
 class matrix_vector_multiplication_iterator {
  private:
@@ -143,7 +311,7 @@ class matrix_vector_multiplication_iterator {
 
   reference operator*() const {
     return std::inner_product(vec_begin_, vec_end_, row_start_,
-                              /*zero*/value_type());
+                              /*zero*/typename accumulator<value_type>::type());
   }
 
   // TODO(Linh): neccessary?
@@ -202,7 +370,7 @@ class matrix_vector_multiplication_iterator {
   reference operator[](difference_type n) const {
     return std::inner_product(vec_begin_, vec_end_,
                               std::next(row_start_, n * vec_size_),
-                              /*zero*/value_type());
+                              /*zero*/typename accumulator<value_type>::type());
   }
 
  private:
@@ -289,6 +457,207 @@ operator+(typename matrix_vector_multiplication_iterator<MatrixIter,
       x.row_index() + n,
       x.vec_begin(), x.vec_end());
 }
+
+// Iterates over the elements (in row-major order) of the product of two
+// matrix expressions. The (i, j) element is computed on the fly as the
+// inner product of the i-th row of the left operand and the j-th column of
+// the right operand.
+template<typename LeftIter, typename RightIter>
+class matrix_matrix_multiplication_iterator {
+ private:
+  using left_iter_traits = std::iterator_traits<LeftIter>;
+  using right_iter_traits = std::iterator_traits<RightIter>;
+
+ public:
+  using left_iterator_type = LeftIter;
+  using right_iterator_type = RightIter;
+
+  static_assert(std::is_same<typename left_iter_traits::difference_type,
+                typename right_iter_traits::difference_type>::value,
+                "LeftIter and RightIter must have the same "
+                "difference_type");
+
+  static_assert(std::is_same<typename left_iter_traits::value_type,
+                typename right_iter_traits::value_type>::value,
+                "LeftIter and RightIter must have the same "
+                "value_type");
+
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = typename left_iter_traits::value_type;
+  using difference_type = typename left_iter_traits::difference_type;
+  using pointer = void;
+  using reference = value_type;
+
+  matrix_matrix_multiplication_iterator()
+      : left_begin_(),
+        right_begin_(),
+        index_(),
+        inner_size_(),
+        right_col_count_() {
+  }
+
+  matrix_matrix_multiplication_iterator(left_iterator_type left_begin,
+                                        right_iterator_type right_begin,
+                                        difference_type index,
+                                        difference_type inner_size,
+                                        difference_type right_col_count)
+      : left_begin_(left_begin),
+        right_begin_(right_begin),
+        index_(index),
+        inner_size_(inner_size),
+        right_col_count_(right_col_count) {}
+
+  template<typename LI, typename RI>
+  matrix_matrix_multiplication_iterator(
+      const matrix_matrix_multiplication_iterator<LI, RI>& it)
+      : left_begin_(it.left_begin()),
+        right_begin_(it.right_begin()),
+        index_(it.index()),
+        inner_size_(it.inner_size()),
+        right_col_count_(it.right_col_count()) {}
+
+  left_iterator_type left_begin() const { return left_begin_; }
+  right_iterator_type right_begin() const { return right_begin_; }
+  difference_type index() const { return index_; }
+  difference_type inner_size() const { return inner_size_; }
+  difference_type right_col_count() const { return right_col_count_; }
+
+  reference operator*() const { return compute_(index_); }
+
+  matrix_matrix_multiplication_iterator& operator++() {
+    ++index_;
+    return *this;
+  }
+
+  matrix_matrix_multiplication_iterator  operator++(int) {
+    matrix_matrix_multiplication_iterator tmp(*this);
+    ++index_;
+    return tmp;
+  }
+
+  matrix_matrix_multiplication_iterator& operator--() {
+    --index_;
+    return *this;
+  }
+
+  matrix_matrix_multiplication_iterator  operator--(int) {
+    matrix_matrix_multiplication_iterator tmp(*this);
+    --index_;
+    return tmp;
+  }
+
+  matrix_matrix_multiplication_iterator  operator+ (difference_type n) const {
+    matrix_matrix_multiplication_iterator tmp(*this);
+    tmp.index_ += n;
+    return tmp;
+  }
+
+  matrix_matrix_multiplication_iterator& operator+=(difference_type n) {
+    index_ += n;
+    return *this;
+  }
+
+  matrix_matrix_multiplication_iterator  operator- (difference_type n) const {
+    matrix_matrix_multiplication_iterator tmp(*this);
+    tmp.index_ -= n;
+    return tmp;
+  }
+
+  matrix_matrix_multiplication_iterator& operator-=(difference_type n) {
+    index_ -= n;
+    return *this;
+  }
+
+  reference operator[](difference_type n) const {
+    return compute_(index_ + n);
+  }
+
+ private:
+  left_iterator_type left_begin_;
+  right_iterator_type right_begin_;
+  difference_type index_;
+  difference_type inner_size_;
+  difference_type right_col_count_;
+
+  value_type compute_(difference_type index) const {
+    const difference_type i = index / right_col_count_;
+    const difference_type j = index % right_col_count_;
+    typename accumulator<value_type>::type sum = 0;
+    for (difference_type k = 0; k < inner_size_; ++k) {
+      sum += left_begin_[i * inner_size_ + k] *
+             right_begin_[k * right_col_count_ + j];
+    }
+    return sum;
+  }
+};
+
+template<typename T1, typename T2, typename U1, typename U2>
+inline
+bool
+operator==(const matrix_matrix_multiplication_iterator<T1, T2>& x,
+           const matrix_matrix_multiplication_iterator<U1, U2>& y) {
+  return (x.left_begin() == y.left_begin()) &&
+      (x.right_begin() == y.right_begin()) && (x.index() == y.index());
+}
+
+template<typename T1, typename T2, typename U1, typename U2>
+inline
+bool
+operator!=(const matrix_matrix_multiplication_iterator<T1, T2>& x,
+           const matrix_matrix_multiplication_iterator<U1, U2>& y) {
+  return !(x == y);
+}
+
+template<typename T1, typename T2, typename U1, typename U2>
+inline
+bool
+operator<(const matrix_matrix_multiplication_iterator<T1, T2>& x,
+          const matrix_matrix_multiplication_iterator<U1, U2>& y) {
+  return x.index() < y.index();
+}
+
+template<typename T1, typename T2, typename U1, typename U2>
+inline
+bool
+operator<=(const matrix_matrix_multiplication_iterator<T1, T2>& x,
+           const matrix_matrix_multiplication_iterator<U1, U2>& y) {
+  return x.index() <= y.index();
+}
+
+template<typename T1, typename T2, typename U1, typename U2>
+inline
+bool
+operator>(const matrix_matrix_multiplication_iterator<T1, T2>& x,
+          const matrix_matrix_multiplication_iterator<U1, U2>& y) {
+  return x.index() > y.index();
+}
+
+template<typename T1, typename T2, typename U1, typename U2>
+inline
+bool
+operator>=(const matrix_matrix_multiplication_iterator<T1, T2>& x,
+           const matrix_matrix_multiplication_iterator<U1, U2>& y) {
+  return x.index() >= y.index();
+}
+
+template<typename T1, typename T2, typename U1, typename U2>
+inline
+auto
+operator-(const matrix_matrix_multiplication_iterator<T1, T2>& x,
+          const matrix_matrix_multiplication_iterator<U1, U2>& y)
+    -> decltype(x.index() - y.index()) {
+  return x.index() - y.index();
+}
+
+template<typename LeftIter, typename RightIter>
+inline
+matrix_matrix_multiplication_iterator<LeftIter, RightIter>
+operator+(typename matrix_matrix_multiplication_iterator<LeftIter,
+          RightIter>::difference_type n,
+          const matrix_matrix_multiplication_iterator<LeftIter,
+          RightIter>& x) {
+  return x + n;
+}
 }  // namespace linalg_detail
 }  // namespace insight
 #endif  // INCLUDE_INSIGHT_LINALG_DETAIL_MATMUL_EXPRESSION_H_
@@ -0,0 +1,137 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_MIXED_PRECISION_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_MIXED_PRECISION_H_
+
+#include <cmath>
+#include <numeric>
+#include <type_traits>
+
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/special_expression_traits.h"
+#include "insight/linalg/detail/blas_routines.h"
+
+namespace insight {
+namespace linalg_detail {
+
+// Sums over vectors and matrices of the 16-bit floating point types (see
+// insight/linalg/half.h).
+//
+// Their elements are converted to float, multiplied and accumulated in
+// float, and only the final results are rounded back to 16 bits, i.e. the
+// result of e.g. a float16 matmul is that of the float matmul over the same
+// (converted) operands, rounded once. Accumulating in 16 bits instead would
+// lose all precision after a few thousand terms.
+//
+// Dot products and L2 norms go through blas_mixed_dot/blas_mixed_nrm2, and
+// the products materialized by materialize_matmul (see materialize.h)
+// through blas_mixed_gemv/blas_mixed_gemm, which convert their operands to
+// float one cache-sized block at a time. Reductions (see reduction.h) and
+// the element-at-a-time eval() of a product accumulate in
+// accumulator<T>::type.
+
+// The dot product and L2 norm of N contiguous elements of a type without a
+// BLAS routine.
+template<typename T>
+inline typename std::enable_if<!is_mixed_precision<T>::value, T>::type
+dense_dot(const int N, const T* X, const T* Y) {
+  return std::inner_product(X, X + N, Y, T(0));
+}
+
+template<typename T>
+inline typename std::enable_if<is_mixed_precision<T>::value, T>::type
+dense_dot(const int N, const T* X, const T* Y) {
+  return T(blas_mixed_dot(N, X, Y));
+}
+
+template<typename T>
+inline typename std::enable_if<!is_mixed_precision<T>::value, T>::type
+dense_nrm2(const int N, const T* X) {
+  auto op = [](const T& partial, const T& val) {
+              return partial + val * val;
+            };
+  return std::sqrt(std::accumulate(X, X + N, T(0), op));
+}
+
+template<typename T>
+inline typename std::enable_if<is_mixed_precision<T>::value, T>::type
+dense_nrm2(const int N, const T* X) {
+  return T(blas_mixed_nrm2(N, X));
+}
+
+// A vector operand of a product: x, or a * x (resp. x * a).
+template<typename E, typename Enable = void> struct gemv_operand;
+
+template<typename E>
+struct gemv_operand<
+  E, typename std::enable_if<is_dense_vector<E>::value>::type> {
+  using value_type = typename E::value_type;
+  static inline float scalar(const E&) { return 1.0f; }
+  static inline const value_type* data(const E& e) { return e.data(); }
+};
+
+template<typename E>
+struct gemv_operand<
+  E,
+  typename std::enable_if<
+    special_expression::is_dense_vector_times_scalar<E>::value>::type> {
+  using value_type = typename E::value_type;
+  static inline float scalar(const E& e) { return e.scalar; }
+  static inline const value_type* data(const E& e) { return e.e.data(); }
+};
+
+// Evaluates the product p, whose operands are BLAS operands (see
+// is_blas_operand in materialize.h) of a 16-bit floating point type, into
+// buffer.
+
+// matrix-vector.
+template<typename ME, typename VE>
+inline void mixed_matmul(const matmul_expression<ME, VE>& p,
+                         typename ME::value_type* buffer,
+                         std::true_type) {
+  using A = special_expression::gemm_operand<ME>;
+  using x = gemv_operand<VE>;
+
+  // The matrix as stored, i.e before being transposed.
+  const bool trans = (A::trans == CblasTrans);
+  const int M = static_cast<int>(trans ? p.m.col_count() : p.m.row_count());
+  const int N = static_cast<int>(trans ? p.m.row_count() : p.m.col_count());
+
+  blas_mixed_gemv(A::trans, M, N,
+                  static_cast<float>(A::scalar(p.m)) * x::scalar(p.v),
+                  A::data(p.m), A::ld(p.m),
+                  x::data(p.v), 0.0f, buffer);
+}
+
+// matrix-matrix.
+template<typename ME1, typename ME2>
+inline void mixed_matmul(const matmul_expression<ME1, ME2>& p,
+                         typename ME1::value_type* buffer,
+                         std::false_type) {
+  using A = special_expression::gemm_operand<ME1>;
+  using B = special_expression::gemm_operand<ME2>;
+  const int N = static_cast<int>(p.col_count());
+
+  blas_mixed_gemm(A::trans, B::trans,
+                  static_cast<int>(p.row_count()), N,
+                  static_cast<int>(p.m1.col_count()),
+                  static_cast<float>(A::scalar(p.m1)) *
+                  static_cast<float>(B::scalar(p.m2)),
+                  A::data(p.m1), A::ld(p.m1),
+                  B::data(p.m2), B::ld(p.m2),
+                  0.0f, buffer, N);
+}
+
+template<typename E1, typename E2>
+inline void mixed_matmul(const matmul_expression<E1, E2>& p,
+                         typename E1::value_type* buffer) {
+  mixed_matmul(p, buffer,
+               std::integral_constant<bool,
+               std::is_base_of<vector_expression<E2>, E2>::value>());
+}
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_MIXED_PRECISION_H_
@@ -0,0 +1,72 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_NOALIAS_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_NOALIAS_H_
+
+#include "insight/linalg/detail/expression_evaluator.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+namespace linalg_detail {
+
+// Returned by vector::noalias() and matrix::noalias(). Its assignment
+// operators evaluate an expression directly into the destination D without
+// checking whether the expression reads it (see alias.h), e.g.
+//
+//   y.noalias() = matmul(A, x);
+//
+// It is up to the caller to guarantee that it does not, other than
+// elementwise.
+template<typename D>
+class noalias_proxy {
+ public:
+  using value_type = typename D::value_type;
+
+  explicit noalias_proxy(D& d) : d_(d) {}  // NOLINT
+
+  // Evaluates the expression e into the destination, which is resized
+  // (reallocated if needed) to the shape of e.
+  template<typename E>
+  inline D& operator=(const E& e) {
+    d_.assign_noalias_(e);
+    return d_;
+  }
+
+  template<typename E>
+  inline D& operator+=(const E& e) {
+    CHECK_EQ(d_.size(), e.size());
+    expression_evaluator<E>(e).add_noalias(d_.data());
+    return d_;
+  }
+
+  template<typename E>
+  inline D& operator-=(const E& e) {
+    CHECK_EQ(d_.size(), e.size());
+    expression_evaluator<E>(e).sub_noalias(d_.data());
+    return d_;
+  }
+
+  template<typename E>
+  inline D& operator*=(const E& e) {
+    CHECK_EQ(d_.size(), e.size());
+    expression_evaluator<E>(e).mul_noalias(d_.data());
+    return d_;
+  }
+
+  template<typename E>
+  inline D& operator/=(const E& e) {
+    CHECK_EQ(d_.size(), e.size());
+    expression_evaluator<E>(e).div_noalias(d_.data());
+    return d_;
+  }
+
+ private:
+  D& d_;
+};
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_NOALIAS_H_
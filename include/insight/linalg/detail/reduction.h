@@ -0,0 +1,612 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_REDUCTION_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_REDUCTION_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#include "insight/linalg/detail/blas_routines.h"
+#include "insight/linalg/detail/eval_iterator.h"
+#include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/materialize.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/scratch_buffer.h"
+#include "insight/linalg/detail/temporary.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// These forward declarations should be here NOT inside the linalg_detail
+// namespace.
+template<typename T, typename A, std::size_t N> class vector;
+template<typename T, typename A, std::size_t N> class matrix;
+template<typename T> class vector_map;
+template<typename T> class matrix_map;
+
+namespace linalg_detail {
+
+template<typename E> struct row_view;
+
+// Reductions.
+//
+// A full reduction (e.g. sum(x * y)) reads its operand once through
+// eval(i), so that it never evaluates an elementwise expression into a
+// temporary; dense floating point operands go through the SIMD (or BLAS)
+// reduction kernels instead. Generic operands are reduced with four
+// independent accumulators, which breaks the dependency chain of a single
+// running sum.
+//
+// A row-wise reduction of an m x n matrix expression is the (lazy) vector
+// expression whose i-th element is the reduction of the i-th row. A
+// column-wise reduction is the vector expression of the reductions of each
+// of the n columns; reducing a column of a row-major matrix one element at
+// a time would stride through memory, so its columns are instead reduced
+// all at once, row after row, into a vector of n accumulators. That pass
+// happens when the expression is evaluated: directly into the destination
+// when the reduction is at the root of the tree, or into a temporary (see
+// materialize.h) otherwise.
+
+// Tags selecting the axis of a reduction.
+struct rowwise_tag {};
+struct colwise_tag {};
+
+// Reducers.
+//
+// A reducer R over the element type T defines:
+//
+//   - R::needs_elements: reducing zero elements is an error.
+//   - R::acc_type: the type of its accumulators, which is float for the
+//     16-bit floating point types, T otherwise (see scalar_traits.h).
+//   - A init(T x0): the initial value of an accumulator, given the first
+//     element x0 to be reduced.
+//   - A update(A acc, A x): folds the element x into the accumulator acc.
+//   - A merge(A a, A b): combines two accumulators.
+//   - T finish(A acc, std::size_t n): the result, given the accumulator of
+//     n elements.
+//   - T dense(int n, const T* x): the reduction of n contiguous elements,
+//     only for floating point types.
+//   - is_additive: the accumulator of a row is the (elementwise) sum of
+//     the rows, see accumulate_row_.
+
+template<typename T>
+struct sum_reducer {
+  using acc_type = typename accumulator<T>::type;
+  static const bool needs_elements = false;
+  static const bool is_additive = true;
+  static inline acc_type init(T) { return acc_type(0); }
+  static inline acc_type update(acc_type acc, acc_type x) { return acc + x; }
+  static inline acc_type merge(acc_type a, acc_type b) { return a + b; }
+  static inline T finish(acc_type acc, std::size_t) { return acc; }
+  static inline T dense(int n, const T* x) { return blas_sum(n, x); }
+};
+
+template<typename T>
+struct mean_reducer : public sum_reducer<T> {
+  using acc_type = typename sum_reducer<T>::acc_type;
+  static const bool needs_elements = true;
+  static inline T finish(acc_type acc, std::size_t n) {
+    return acc / static_cast<acc_type>(n);
+  }
+  static inline T dense(int n, const T* x) {
+    return blas_sum(n, x) / static_cast<T>(n);
+  }
+};
+
+template<typename T>
+struct asum_reducer {
+  using acc_type = typename accumulator<T>::type;
+  static const bool needs_elements = false;
+  static const bool is_additive = false;
+  static inline acc_type init(T) { return acc_type(0); }
+  static inline acc_type update(acc_type acc, acc_type x) {
+    return acc + (x < acc_type(0) ? -x : x);
+  }
+  static inline acc_type merge(acc_type a, acc_type b) { return a + b; }
+  static inline T finish(acc_type acc, std::size_t) { return acc; }
+  static inline T dense(int n, const T* x) { return blas_asum(n, x); }
+};
+
+// L2-norm.
+template<typename T>
+struct norm_reducer {
+  using acc_type = typename accumulator<T>::type;
+  static const bool needs_elements = false;
+  static const bool is_additive = false;
+  static inline acc_type init(T) { return acc_type(0); }
+  static inline acc_type update(acc_type acc, acc_type x) {
+    return acc + x * x;
+  }
+  static inline acc_type merge(acc_type a, acc_type b) { return a + b; }
+  static inline T finish(acc_type acc, std::size_t) {
+    return static_cast<T>(std::sqrt(acc));
+  }
+  static inline T dense(int n, const T* x) { return blas_nrm2(n, x); }
+};
+
+template<typename T>
+struct min_reducer {
+  using acc_type = T;
+  static const bool needs_elements = true;
+  static const bool is_additive = false;
+  static inline T init(T x0) { return x0; }
+  static inline T update(T acc, T x) { return x < acc ? x : acc; }
+  static inline T merge(T a, T b) { return update(a, b); }
+  static inline T finish(T acc, std::size_t) { return acc; }
+  static inline T dense(int n, const T* x) { return blas_min(n, x); }
+};
+
+template<typename T>
+struct max_reducer {
+  using acc_type = T;
+  static const bool needs_elements = true;
+  static const bool is_additive = false;
+  static inline T init(T x0) { return x0; }
+  static inline T update(T acc, T x) { return acc < x ? x : acc; }
+  static inline T merge(T a, T b) { return update(a, b); }
+  static inline T finish(T acc, std::size_t) { return acc; }
+  static inline T dense(int n, const T* x) { return blas_max(n, x); }
+};
+
+// Arg-reducers: an element replaces the best one so far only if it compares
+// strictly better, so that the first one wins ties. extremum is the reducer
+// of the value of the best element.
+
+template<typename T>
+struct argmin_reducer {
+  using compare = std::less<T>;
+  using extremum = min_reducer<T>;
+};
+
+template<typename T>
+struct argmax_reducer {
+  using compare = std::greater<T>;
+  using extremum = max_reducer<T>;
+};
+
+// Is E stored contiguously, in its own (row-major) order, at E::data()?
+template<typename E> struct is_contiguous : public std::false_type {};
+
+template<typename T, typename A, std::size_t N>
+struct is_contiguous<insight::vector<T, A, N> > : public std::true_type {};
+
+template<typename T, typename A, std::size_t N>
+struct is_contiguous<insight::matrix<T, A, N> > : public std::true_type {};
+
+template<typename T>
+struct is_contiguous<insight::vector_map<T> > : public std::true_type {};
+
+template<typename T>
+struct is_contiguous<insight::matrix_map<T> > : public std::true_type {};
+
+template<typename T>
+struct is_contiguous<temporary_vector<T> > : public std::true_type {};
+
+template<typename T>
+struct is_contiguous<temporary_matrix<T> > : public std::true_type {};
+
+template<typename T, typename A, std::size_t N>
+struct is_contiguous<row_view<insight::matrix<T, A, N> > >
+    : public std::true_type {};
+
+template<typename T>
+struct is_contiguous<row_view<insight::matrix_map<T> > >
+    : public std::true_type {};
+
+// Can E be reduced with the dense kernels?
+template<typename E>
+struct has_dense_reduction
+    : public std::integral_constant<
+  bool,
+  is_contiguous<E>::value &&
+  std::is_floating_point<typename E::value_type>::value> {};
+
+// Reduces the n elements x.eval(first), x.eval(first + stride), ...
+template<typename R, typename X>
+typename X::value_type reduce_strided_(const X& x,
+                                       typename X::size_type first,
+                                       typename X::size_type n,
+                                       typename X::size_type stride) {
+  using value_type = typename X::value_type;
+  using acc_type = typename R::acc_type;
+  using size_type = typename X::size_type;
+  acc_type acc0 = R::init(n > 0 ? x.eval(first) : value_type());
+  acc_type acc1 = acc0;
+  acc_type acc2 = acc0;
+  acc_type acc3 = acc0;
+  const size_type n4 = n - n % 4;
+  size_type i = 0;
+  size_type k = first;
+  for (; i < n4; i += 4, k += 4 * stride) {
+    acc0 = R::update(acc0, x.eval(k));
+    acc1 = R::update(acc1, x.eval(k + stride));
+    acc2 = R::update(acc2, x.eval(k + 2 * stride));
+    acc3 = R::update(acc3, x.eval(k + 3 * stride));
+  }
+  for (; i < n; ++i, k += stride) {
+    acc0 = R::update(acc0, x.eval(k));
+  }
+  return R::finish(R::merge(R::merge(acc0, acc1), R::merge(acc2, acc3)), n);
+}
+
+// Reduces the n consecutive elements of x starting at first.
+template<typename R, typename X>
+inline typename X::value_type reduce_range_(const X& x,
+                                            typename X::size_type first,
+                                            typename X::size_type n,
+                                            std::true_type) {
+  return R::dense(static_cast<int>(n), x.data() + first);
+}
+
+template<typename R, typename X>
+inline typename X::value_type reduce_range_(const X& x,
+                                            typename X::size_type first,
+                                            typename X::size_type n,
+                                            std::false_type) {
+  return reduce_strided_<R>(x, first, n, 1);
+}
+
+template<typename R, typename X>
+inline typename X::value_type reduce_range(const X& x,
+                                           typename X::size_type first,
+                                           typename X::size_type n) {
+  return reduce_range_<R>(x, first, n, has_dense_reduction<X>());
+}
+
+// Full reduction of the expression e.
+template<typename R, typename E>
+inline typename E::value_type reduce(const E& e) {
+  CHECK(!R::needs_elements || e.size() > 0)
+      << "reduction of an empty expression";
+  materialized<E> m(e);
+  return reduce_range<R>(m.get(), 0, e.size());
+}
+
+// Transposing does not change the elements to be reduced.
+template<typename R, typename E>
+inline typename E::value_type reduce(const transpose_expression<E>& e) {
+  return reduce<R>(e.e);
+}
+
+// Returns the position, relative to first, of the best (according to
+// A::compare) of the n elements x.eval(first), x.eval(first + stride), ...
+template<typename A, typename X>
+std::size_t arg_reduce_strided_(const X& x, typename X::size_type first,
+                                typename X::size_type n,
+                                typename X::size_type stride) {
+  using value_type = typename X::value_type;
+  using size_type = typename X::size_type;
+  typename A::compare better;
+  value_type best = x.eval(first);
+  size_type result = 0;
+  for (size_type i = 1, k = first + stride; i < n; ++i, k += stride) {
+    const value_type value = x.eval(k);
+    if (better(value, best)) {
+      best = value;
+      result = i;
+    }
+  }
+  return result;
+}
+
+// The dense kernels find the value of the best element, then its (first)
+// position.
+template<typename A, typename X>
+inline std::size_t arg_reduce_range_(const X& x, typename X::size_type first,
+                                     typename X::size_type n,
+                                     std::true_type) {
+  using value_type = typename X::value_type;
+  const value_type* data = x.data() + first;
+  const value_type best = A::extremum::dense(static_cast<int>(n), data);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (data[i] == best) return i;
+  }
+  // NaNs.
+  return arg_reduce_strided_<A>(x, first, n, 1);
+}
+
+template<typename A, typename X>
+inline std::size_t arg_reduce_range_(const X& x, typename X::size_type first,
+                                     typename X::size_type n,
+                                     std::false_type) {
+  return arg_reduce_strided_<A>(x, first, n, 1);
+}
+
+template<typename A, typename X>
+inline std::size_t arg_reduce_range(const X& x, typename X::size_type first,
+                                    typename X::size_type n) {
+  return arg_reduce_range_<A>(x, first, n, has_dense_reduction<X>());
+}
+
+// Returns the (row-major) linear index of the best element of e.
+template<typename A, typename E>
+inline std::size_t arg_reduce(const E& e) {
+  CHECK_GT(e.size(), 0) << "reduction of an empty expression";
+  materialized<E> m(e);
+  return arg_reduce_range<A>(m.get(), 0, e.size());
+}
+
+// acc <- acc + row, for additive reducers over dense floating point rows.
+template<typename R, typename T>
+inline void accumulate_row_(std::size_t n, const T* row, T* acc,
+                            std::true_type) {
+  blas_add(static_cast<int>(n), acc, row, acc);
+}
+
+template<typename R, typename T>
+inline void accumulate_row_(std::size_t n, const T* row, T* acc,
+                            std::false_type) {
+  for (std::size_t j = 0; j < n; ++j) {
+    acc[j] = R::update(acc[j], row[j]);
+  }
+}
+
+// Reduces each column of the (row_count x col_count) expression x into
+// acc[j], traversing x row by row.
+template<typename R, typename X>
+void reduce_colwise_(const X& x, typename X::size_type row_count,
+                     typename X::size_type col_count,
+                     typename X::value_type* acc, std::true_type) {
+  using value_type = typename X::value_type;
+  using size_type = typename X::size_type;
+  const value_type* row = x.data();
+  for (size_type j = 0; j < col_count; ++j) {
+    acc[j] = R::init(row_count > 0 ? row[j] : value_type());
+  }
+  for (size_type i = 0; i < row_count; ++i, row += col_count) {
+    accumulate_row_<R>(col_count, row, acc,
+                       std::integral_constant<bool, R::is_additive>());
+  }
+  for (size_type j = 0; j < col_count; ++j) {
+    acc[j] = R::finish(acc[j], row_count);
+  }
+}
+
+template<typename R, typename X, typename A>
+void reduce_colwise_generic_(const X& x, typename X::size_type row_count,
+                             typename X::size_type col_count, A* acc) {
+  using value_type = typename X::value_type;
+  using size_type = typename X::size_type;
+  for (size_type j = 0; j < col_count; ++j) {
+    acc[j] = R::init(row_count > 0 ? x.eval(j) : value_type());
+  }
+  size_type k = 0;
+  for (size_type i = 0; i < row_count; ++i) {
+    for (size_type j = 0; j < col_count; ++j, ++k) {
+      acc[j] = R::update(acc[j], x.eval(k));
+    }
+  }
+  for (size_type j = 0; j < col_count; ++j) {
+    acc[j] = R::finish(acc[j], row_count);
+  }
+}
+
+// The accumulators are the destination elements themselves...
+template<typename R, typename X>
+inline void reduce_colwise_generic_(const X& x,
+                                    typename X::size_type row_count,
+                                    typename X::size_type col_count,
+                                    typename X::value_type* acc,
+                                    std::true_type) {
+  reduce_colwise_generic_<R>(x, row_count, col_count, acc);
+}
+
+// ... or wider than them (see scalar_traits.h).
+template<typename R, typename X>
+void reduce_colwise_generic_(const X& x, typename X::size_type row_count,
+                             typename X::size_type col_count,
+                             typename X::value_type* acc, std::false_type) {
+  scratch_buffer<typename R::acc_type> wide(col_count);
+  reduce_colwise_generic_<R>(x, row_count, col_count, wide.data());
+  std::copy(wide.data(), wide.data() + col_count, acc);
+}
+
+template<typename R, typename X>
+inline void reduce_colwise_(const X& x, typename X::size_type row_count,
+                            typename X::size_type col_count,
+                            typename X::value_type* acc, std::false_type) {
+  reduce_colwise_generic_<R>(x, row_count, col_count, acc,
+                             std::is_same<typename R::acc_type,
+                             typename X::value_type>());
+}
+
+// Same as above, for arg-reducers: index[j] is the row of the best element
+// of the j-th column.
+template<typename A, typename X>
+void arg_reduce_colwise_(const X& x, typename X::size_type row_count,
+                         typename X::size_type col_count,
+                         std::size_t* index) {
+  using value_type = typename X::value_type;
+  using size_type = typename X::size_type;
+  typename A::compare better;
+  scratch_buffer<value_type> best(col_count);
+  value_type* b = best.data();
+  for (size_type j = 0; j < col_count; ++j) {
+    b[j] = x.eval(j);
+    index[j] = 0;
+  }
+  size_type k = col_count;
+  for (size_type i = 1; i < row_count; ++i) {
+    for (size_type j = 0; j < col_count; ++j, ++k) {
+      const value_type value = x.eval(k);
+      if (better(value, b[j])) {
+        b[j] = value;
+        index[j] = i;
+      }
+    }
+  }
+}
+
+// Row-wise reduction of the matrix expression E, with the reducer R.
+template<typename E, typename R>
+class rowwise_reduction
+    : public vector_expression<rowwise_reduction<E, R> > {
+ private:
+  using self = rowwise_reduction<E, R>;
+
+ public:
+  using value_type = typename E::value_type;
+  using reference = value_type;
+  using size_type = typename E::size_type;
+  using shape_type = typename E::shape_type;
+  using const_iterator = eval_iterator<self>;
+  using iterator = const_iterator;
+
+  const E& e;
+
+  explicit rowwise_reduction(const E& e) : e(e) {
+    CHECK(!R::needs_elements || e.row_count() == 0 || e.col_count() > 0)
+        << "reduction of an empty row";
+  }
+
+  inline size_type row_count() const { return e.row_count(); }
+  inline size_type col_count() const { return row_count() > 0 ? 1 : 0; }
+  inline size_type size() const { return row_count(); }
+  inline shape_type shape() const {
+    return shape_type(row_count(), col_count());
+  }
+
+  // The reduction of the i-th row.
+  inline value_type eval(size_type i) const {
+    const size_type n = e.col_count();
+    return reduce_range<R>(e, i * n, n);
+  }
+
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return e.aliases(first, last);
+  }
+
+  inline transpose_expression<self> t() const {
+    return transpose_expression<self>(*this);
+  }
+
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator cbegin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, size()); }
+  inline const_iterator cend() const { return const_iterator(this, size()); }
+};
+
+// Column-wise reduction of the matrix expression E, with the reducer R.
+template<typename E, typename R>
+class colwise_reduction
+    : public vector_expression<colwise_reduction<E, R> > {
+ private:
+  using self = colwise_reduction<E, R>;
+
+ public:
+  using value_type = typename E::value_type;
+  using reference = value_type;
+  using size_type = typename E::size_type;
+  using shape_type = typename E::shape_type;
+  using const_iterator = eval_iterator<self>;
+  using iterator = const_iterator;
+
+  const E& e;
+
+  explicit colwise_reduction(const E& e) : e(e) {
+    CHECK(!R::needs_elements || e.col_count() == 0 || e.row_count() > 0)
+        << "reduction of an empty column";
+  }
+
+  inline size_type row_count() const { return e.col_count(); }
+  inline size_type col_count() const { return row_count() > 0 ? 1 : 0; }
+  inline size_type size() const { return row_count(); }
+  inline shape_type shape() const {
+    return shape_type(row_count(), col_count());
+  }
+
+  // The reduction of the j-th column. Evaluating the whole expression does
+  // not go through here, but through reduce_colwise.
+  inline value_type eval(size_type j) const {
+    return reduce_strided_<R>(e, j, e.row_count(), e.col_count());
+  }
+
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return e.aliases(first, last);
+  }
+
+  inline transpose_expression<self> t() const {
+    return transpose_expression<self>(*this);
+  }
+
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator cbegin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, size()); }
+  inline const_iterator cend() const { return const_iterator(this, size()); }
+};
+
+// Evaluates the column-wise reduction e into buffer.
+template<typename E, typename R>
+inline void reduce_colwise(const colwise_reduction<E, R>& e,
+                           typename E::value_type* buffer) {
+  using X = typename materialized<E>::type;
+  materialized<E> m(e.e);
+  reduce_colwise_<R>(m.get(), e.e.row_count(), e.e.col_count(), buffer,
+                     has_dense_reduction<X>());
+}
+
+// index[i] <- the column of the best element of the i-th row of e.
+template<typename A, typename E>
+void arg_reduce_rowwise(const E& e, std::size_t* index) {
+  using size_type = typename E::size_type;
+  const size_type m = e.row_count();
+  const size_type n = e.col_count();
+  CHECK(m == 0 || n > 0) << "reduction of an empty row";
+  materialized<E> x(e);
+  for (size_type i = 0; i < m; ++i) {
+    index[i] = arg_reduce_range<A>(x.get(), i * n, n);
+  }
+}
+
+// index[j] <- the row of the best element of the j-th column of e.
+template<typename A, typename E>
+void arg_reduce_colwise(const E& e, std::size_t* index) {
+  CHECK(e.col_count() == 0 || e.row_count() > 0)
+      << "reduction of an empty column";
+  materialized<E> x(e);
+  arg_reduce_colwise_<A>(x.get(), e.row_count(), e.col_count(), index);
+}
+
+// Materialization (see materialize.h).
+
+template<typename E, typename R>
+struct contains_materialized<rowwise_reduction<E, R> >
+    : public contains_materialized<E> {};
+
+template<typename E, typename R>
+struct contains_materialized<colwise_reduction<E, R> >
+    : public std::true_type {};
+
+template<typename E, typename R>
+struct materialized<
+  rowwise_reduction<E, R>,
+  typename std::enable_if<contains_materialized<E>::value>::type> {
+  using type = rowwise_reduction<typename materialized<E>::type, R>;
+  materialized<E> m;
+  type expr;
+
+  explicit materialized(const rowwise_reduction<E, R>& e)
+      : m(e.e), expr(m.get()) {}
+  inline const type& get() const { return expr; }
+};
+
+template<typename E, typename R>
+struct materialized<colwise_reduction<E, R> > {
+  using type = temporary_vector<typename E::value_type>;
+  type tmp;
+
+  explicit materialized(const colwise_reduction<E, R>& e) : tmp(e.size()) {
+    reduce_colwise(e, tmp.buffer());
+  }
+  inline const type& get() const { return tmp; }
+};
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_REDUCTION_H_
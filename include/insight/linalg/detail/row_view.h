@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <iterator>
 
+#include "insight/linalg/detail/strided_evaluator.h"
+
 #include "glog/logging.h"
 
 namespace insight {
@@ -35,7 +37,8 @@ struct row_view : public matrix_expression<row_view<M> > {
   using shape_type = typename M::shape_type;
 
   row_view(M* m, size_type row_index)
-      : row_index_(row_index),
+      : m_(m),
+        row_index_(row_index),
         col_count_(m->col_count()),
         begin_(std::next(m->begin(), row_index * col_count_)),
         end_(std::next(m->begin(), (row_index + 1) * col_count_)),
@@ -51,11 +54,36 @@ struct row_view : public matrix_expression<row_view<M> > {
     return shape_type(row_count(), col_count());
   }
 
+  // Evaluates the element at the given index i. No bounds checking is
+  // performed.
+  inline value_type eval(size_type i) const { return cbegin_[i]; }
+
+  // Does the underlying matrix read any element in the range
+  // [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return m_->aliases(first, last);
+  }
+
   // Transpose of this expression.
   inline transpose_expression<self> t() const {
     return transpose_expression<self>(*this);
   }
 
+  // The elements of a row of a dense matrix are contiguous, starting at
+  // data().
+  inline value_type* data() { return &*begin_; }
+  inline const value_type* data() const { return &*cbegin_; }
+
+  // Returns the L2-norm of this row.
+  inline value_type nrm2() const { return strided_nrm2(*this); }
+
+  // Returns the dot product of this row with the (row) matrix expression e.
+  template<typename E>
+  inline value_type dot(const matrix_expression<E>& e) const {
+    CHECK_EQ(size(), e.self().size());
+    return strided_dot(*this, e.self());
+  }
+
   inline iterator begin() { return begin_; }
   inline const_iterator begin() const { return cbegin_; }
   inline const_iterator cbegin() const { return cbegin_; }
@@ -83,18 +111,79 @@ struct row_view : public matrix_expression<row_view<M> > {
   // Replaces each and every element in the row by the result of
   // multiplication of that element and a `scalar`.
   inline self& operator*=(value_type scalar) {
-    std::for_each(begin(), end(), [&](reference e) { e *= scalar; });
+    scale_(scalar, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
     return *this;
   }
 
   // Replaces each and every element in the row by the result of
   // dividing that element by a constant `scalar`.
   inline self& operator/=(value_type scalar) {
-    std::for_each(begin(), end(), [&](reference e) { e /= scalar; });
+    div_scalar_(scalar, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    return *this;
+  }
+
+  // row_view-expression arithmetic (see strided_evaluator.h).
+
+  // Copies the elements of the row r into this row.
+  inline self& operator=(const self& r) {
+    CHECK_EQ(size(), r.size());
+    strided_evaluator<self>(r).assign(data(), 1);
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator=(const matrix_expression<E>& e) {
+    CHECK_EQ(size(), e.self().size());
+    strided_evaluator<E>(e.self()).assign(data(), 1);
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator+=(const matrix_expression<E>& e) {
+    CHECK_EQ(size(), e.self().size());
+    strided_evaluator<E>(e.self()).add(data(), 1);
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator-=(const matrix_expression<E>& e) {
+    CHECK_EQ(size(), e.self().size());
+    strided_evaluator<E>(e.self()).sub(data(), 1);
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator*=(const matrix_expression<E>& e) {
+    CHECK_EQ(size(), e.self().size());
+    strided_evaluator<E>(e.self()).mul(data(), 1);
+    return *this;
+  }
+
+  template<typename E>
+  inline self& operator/=(const matrix_expression<E>& e) {
+    CHECK_EQ(size(), e.self().size());
+    strided_evaluator<E>(e.self()).div(data(), 1);
     return *this;
   }
 
  private:
+  inline void scale_(value_type scalar, std::true_type) {
+    blas_scal(size(), scalar, data());
+  }
+
+  inline void scale_(value_type scalar, std::false_type) {
+    std::for_each(begin(), end(), [&](reference e) { e *= scalar; });
+  }
+
+  inline void div_scalar_(value_type scalar, std::true_type) {
+    blas_scal(size(), value_type(1.0) / scalar, data());
+  }
+
+  inline void div_scalar_(value_type scalar, std::false_type) {
+    std::for_each(begin(), end(), [&](reference e) { e /= scalar; });
+  }
+
+  const M* m_;
   size_type row_index_;
   size_type col_count_;
   iterator begin_;
@@ -0,0 +1,45 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_SCALAR_TRAITS_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_SCALAR_TRAITS_H_
+
+#include <type_traits>
+
+namespace insight {
+
+// These forward declarations should be here NOT inside the linalg_detail
+// namespace.
+class float16;
+class bfloat16_t;
+
+namespace linalg_detail {
+
+// Is T an element type of vectors and matrices, i.e an arithmetic type or
+// one of the 16-bit floating point types (see insight/linalg/half.h)? In a
+// binary expression, an operand of such a type is the scalar one.
+template<typename T> struct is_scalar : public std::is_arithmetic<T> {};
+template<> struct is_scalar<insight::float16> : public std::true_type {};
+template<> struct is_scalar<insight::bfloat16_t> : public std::true_type {};
+
+// Is T stored in 16 bits, but computed with in float?
+template<typename T> struct is_mixed_precision : public std::false_type {};
+
+template<>
+struct is_mixed_precision<insight::float16> : public std::true_type {};
+
+template<>
+struct is_mixed_precision<insight::bfloat16_t> : public std::true_type {};
+
+// The type in which sums (dot products, matmuls, reductions) of elements of
+// type T are accumulated.
+template<typename T>
+struct accumulator {
+  using type = typename std::conditional<is_mixed_precision<T>::value,
+                                         float, T>::type;
+};
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_SCALAR_TRAITS_H_
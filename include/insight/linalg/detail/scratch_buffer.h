@@ -0,0 +1,125 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_SCRATCH_BUFFER_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_SCRATCH_BUFFER_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace insight {
+namespace linalg_detail {
+
+// Uninitialized temporary storage for n elements of type T, used to
+// evaluate (sub)expressions that cannot be evaluated in place.
+//
+// The storage comes from a per-thread pool of blocks, one pool per element
+// type: a scratch_buffer takes the smallest free block large enough (or
+// grows the largest free one, or adds a new block), and gives it back when
+// destroyed. Evaluating the same expressions over and over, e.g. the layers
+// of a forward pass, therefore does not go through the allocator once the
+// pool is warm.
+//
+// Blocks larger than kMaxPooledBytes are freed as soon as they are given
+// back, so that a single large temporary does not stay allocated for the
+// lifetime of the thread; trim() frees all the free blocks of the calling
+// thread's pool.
+template<typename T>
+class scratch_buffer {
+ public:
+  static constexpr std::size_t kMaxPooledBytes = std::size_t(1) << 24;
+
+  explicit scratch_buffer(std::size_t n)
+      : index_(acquire_(n)), data_(pool_()[index_].data.get()) {}
+
+  ~scratch_buffer() {
+    block& b = pool_()[index_];
+    if (b.capacity * sizeof(T) > kMaxPooledBytes) {
+      b.data.reset();
+      b.capacity = 0;
+    }
+    b.in_use = false;
+  }
+
+  scratch_buffer(const scratch_buffer&) = delete;
+  scratch_buffer& operator=(const scratch_buffer&) = delete;
+
+  // Frees the blocks of the calling thread's pool that are not in use.
+  static void trim() {
+    for (block& b : pool_()) {
+      if (!b.in_use) {
+        b.data.reset();
+        b.capacity = 0;
+      }
+    }
+  }
+
+  // The number of elements allocated by the calling thread's pool, in use
+  // or not.
+  static std::size_t pooled_size() {
+    std::size_t n = 0;
+    for (const block& b : pool_()) n += b.capacity;
+    return n;
+  }
+
+  // The storage is read through a pointer held by this buffer, rather than
+  // looked up in the (thread_local) pool on every access, so that loops
+  // over it can be vectorized.
+  inline T* data() { return data_; }
+  inline const T* data() const { return data_; }
+
+ private:
+  struct block {
+    std::unique_ptr<T[]> data;
+    std::size_t capacity = 0;
+    bool in_use = false;
+  };
+
+  static std::vector<block>& pool_() {
+    static thread_local std::vector<block> pool;
+    return pool;
+  }
+
+  static std::size_t acquire_(std::size_t n) {
+    std::vector<block>& pool = pool_();
+    std::size_t best = pool.size();
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+      if (pool[i].in_use) continue;
+      if (best == pool.size()) {
+        best = i;
+      } else if (pool[best].capacity < n) {
+        // Prefer any block that is large enough, then the largest one.
+        if (pool[i].capacity > pool[best].capacity) best = i;
+      } else if (pool[i].capacity >= n &&
+                 pool[i].capacity < pool[best].capacity) {
+        best = i;
+      }
+    }
+    if (best == pool.size()) {
+      pool.emplace_back();
+    }
+    block& b = pool[best];
+    if (b.capacity < n) {
+      b.data.reset();
+      b.data.reset(new T[n]);
+      b.capacity = n;
+    }
+    b.in_use = true;
+    return best;
+  }
+
+  // Blocks are referred to by index, since the pool may grow (and move
+  // its blocks) while this buffer is alive. Their heap arrays do not move,
+  // so data_ remains valid.
+  std::size_t index_;
+  T* data_;
+};
+
+template<typename T>
+constexpr std::size_t scratch_buffer<T>::kMaxPooledBytes;
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_SCRATCH_BUFFER_H_
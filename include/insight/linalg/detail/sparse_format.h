@@ -0,0 +1,60 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_SPARSE_FORMAT_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_SPARSE_FORMAT_H_
+
+#include <type_traits>
+
+namespace insight {
+
+// How the nonzeros of a sparse matrix (see sparse_matrix.h) are stored:
+// compressed row by row (csr) or column by column (csc).
+enum sparse_format {
+  csr,
+  csc
+};
+
+// Forward declarations.
+template<typename T, sparse_format F> class sparse_matrix;
+template<typename T> class sparse_vector;
+
+namespace linalg_detail {
+
+template<typename E> struct transpose_expression;
+
+// Is E a sparse matrix, or the transpose of one?
+
+template<typename E> struct is_sparse_matrix : public std::false_type {};
+
+template<typename T, sparse_format F>
+struct is_sparse_matrix<insight::sparse_matrix<T, F> >
+    : public std::true_type {};
+
+template<typename E>
+struct is_transpose_of_sparse_matrix : public std::false_type {};
+
+template<typename E>
+struct is_transpose_of_sparse_matrix<transpose_expression<E> >
+    : public is_sparse_matrix<E> {};
+
+// Can the sparse kernels (see sparse_routines.h) read the matrix E directly,
+// as the left operand of a product?
+template<typename E>
+struct is_sparse_operand
+    : public std::integral_constant<bool,
+                                    is_sparse_matrix<E>::value ||
+                                    is_transpose_of_sparse_matrix<
+                                      E>::value> {};
+
+// Is E a sparse vector?
+
+template<typename E> struct is_sparse_vector : public std::false_type {};
+
+template<typename T>
+struct is_sparse_vector<insight::sparse_vector<T> > : public std::true_type {};
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_SPARSE_FORMAT_H_
@@ -0,0 +1,97 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_SPARSE_ROUTINES_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_SPARSE_ROUTINES_H_
+
+#include <cstddef>
+
+#include "insight/linalg/detail/blas_routines.h"
+
+namespace insight {
+namespace linalg_detail {
+
+// Products of a sparse matrix in compressed sparse row (CSR) format with a
+// dense vector or a dense row-major matrix, for float and double.
+//
+// The M x N matrix A is given by its nonzeros: those of its i-th row are
+// values[k], in the column indices[k], for offsets[i] <= k < offsets[i + 1].
+// A matrix compressed column by column (CSC) is the CSR form of its
+// transpose, so that both formats go through the same routines.
+//
+// A * x reads one row of A and gathers the elements of x it needs; A^T * x
+// scatters each row of A into y. The former is split among threads by
+// blocks of rows when Insight is built with OpenMP (INSIGHT_USE_OPENMP).
+// The latter is too, into one private copy of y per thread summed at the
+// end, but only when y is small compared with the number of nonzeros;
+// otherwise it runs sequentially.
+//
+// As with BLAS, y (resp. C) is not read when beta is zero.
+
+// y <- alpha * op(A) * x + beta * y, where op(A) is A (TransA =
+// CblasNoTrans) or A^T (CblasTrans).
+template<typename T>
+void sparse_csrmv(const CBLAS_TRANSPOSE TransA,
+                  const int M,
+                  const int N,
+                  const T alpha,
+                  const T* values,
+                  const int* indices,
+                  const std::size_t* offsets,
+                  const T* x,
+                  const T beta,
+                  T* y);
+
+// C <- alpha * op(A) * B + beta * C, where A is M x K, B has N columns and
+// K (TransA = CblasNoTrans) or M (CblasTrans) rows, and C has N columns and
+// M (CblasNoTrans) or K (CblasTrans) rows. Consecutive rows of B (resp. C)
+// are ldb (resp. ldc) elements apart.
+template<typename T>
+void sparse_csrmm(const CBLAS_TRANSPOSE TransA,
+                  const int M,
+                  const int N,
+                  const int K,
+                  const T alpha,
+                  const T* values,
+                  const int* indices,
+                  const std::size_t* offsets,
+                  const T* B,
+                  const int ldb,
+                  const T beta,
+                  T* C,
+                  const int ldc);
+
+// Level 1 routines on a sparse vector, given by its n nonzeros values[k] at
+// the indices[k] (as in Sparse BLAS). These only run over the nonzeros, and
+// are defined here for any arithmetic type.
+
+// Returns the sum of values[k] * y[indices[k]], for k < n. The four partial
+// sums break the dependency between consecutive multiply-adds, which would
+// otherwise bound the loop by the latency of one addition per nonzero.
+template<typename T>
+inline T sparse_doti(const std::size_t n, const T* values, const int* indices,
+                     const T* y) {
+  T s0(0), s1(0), s2(0), s3(0);
+  std::size_t k = 0;
+  for (; k + 4 <= n; k += 4) {
+    s0 += values[k] * y[indices[k]];
+    s1 += values[k + 1] * y[indices[k + 1]];
+    s2 += values[k + 2] * y[indices[k + 2]];
+    s3 += values[k + 3] * y[indices[k + 3]];
+  }
+  for (; k < n; ++k) s0 += values[k] * y[indices[k]];
+  return (s0 + s1) + (s2 + s3);
+}
+
+// y[indices[k]] += alpha * values[k], for k < n. The indices are distinct,
+// so that the iterations are independent.
+template<typename T>
+inline void sparse_axpyi(const std::size_t n, const T alpha, const T* values,
+                         const int* indices, T* y) {
+  for (std::size_t k = 0; k < n; ++k) y[indices[k]] += alpha * values[k];
+}
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_SPARSE_ROUTINES_H_
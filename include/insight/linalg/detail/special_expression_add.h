@@ -6,7 +6,9 @@
 #define INCLUDE_INSIGHT_LINALG_DETAIL_SPECIAL_EXPRESSION_ADD_H_
 
 #include "insight/linalg/detail/special_expression_traits.h"
+#include "insight/linalg/detail/special_expression_matmul.h"
 #include "insight/linalg/detail/blas_routines.h"
+#include "insight/linalg/detail/sparse_routines.h"
 
 namespace insight {
 namespace linalg_detail {
@@ -14,10 +16,11 @@ namespace linalg_detail {
 template<typename E> struct is_special_addable
     : public std::conditional<
   special_expression::is_ax<E>::value ||
-  special_expression::is_matmul_aAbx<E>::value ||
-  special_expression::is_matmul_aAtbx<E>::value ||
-  special_expression::is_alpha_times_matmul_aAbx<E>::value ||
-  special_expression::is_alpha_times_matmul_aAtbx<E>::value,
+  special_expression::is_axpby<E>::value ||
+  special_expression::is_scaled_matmul<E>::value ||
+  special_expression::is_matmul_plus_y<E>::value ||
+  special_expression::is_matmul_minus_y<E>::value ||
+  special_expression::is_scaled_sparse_vector<E>::value,
   std::true_type,
   std::false_type>::type{};
 
@@ -32,78 +35,62 @@ void add(const E& expr, typename E::value_type* buffer,
             buffer);
 }
 
-// buffer += matmul(aA, bx)
-template<typename M, typename V>
+// buffer += ax +/- by.
+template<typename E>
 inline
-void add(const matmul_expression<M, V>& expr,
-         typename matmul_expression<M, V>::value_type* buffer,
-         typename std::enable_if<
-         is_matmul_aAbx<matmul_expression<M, V> >::value>::type* = 0) {
-  using value_type = typename matmul_expression<M, V>::value_type;
-  matmul_aAbx_wrapper<M, V> wrapper(expr);
-  blas_gemv(CblasNoTrans,
-            wrapper.A_row_count(),
-            wrapper.A_col_count(),
-            wrapper.a() * wrapper.b(),
-            wrapper.A(),
-            wrapper.x(),
-            value_type(1.0),
-            buffer);
+void add(const E& expr, typename E::value_type* buffer,
+         typename std::enable_if<is_axpby<E>::value>::type* = 0) {
+  using value_type = typename E::value_type;
+  auto wrapper = make_axpby_wrapper(expr);
+  if (wrapper.y() == buffer) {
+    blas_axpby(wrapper.size(), wrapper.a(), wrapper.x(),
+               value_type(1.0) + wrapper.b(), buffer);
+  } else if (wrapper.x() == buffer) {
+    blas_axpby(wrapper.size(), wrapper.b(), wrapper.y(),
+               value_type(1.0) + wrapper.a(), buffer);
+  } else {
+    blas_axpy(wrapper.size(), wrapper.a(), wrapper.x(), buffer);
+    blas_axpy(wrapper.size(), wrapper.b(), wrapper.y(), buffer);
+  }
 }
 
-// buffer += matmul(aA.t(), bx)
-template<typename M, typename V>
+// buffer += P, where P is one of matmul(aA, bx), matmul(aA.t(), bx),
+// matmul(aA, bB) or alpha times any of those.
+template<typename E>
 inline
-void add(const matmul_expression<M, V>& expr,
-         typename matmul_expression<M, V>::value_type* buffer,
-         typename std::enable_if<
-         is_matmul_aAtbx<matmul_expression<M, V> >::value>::type* = 0) {
-  using value_type = typename matmul_expression<M, V>::value_type;
-  matmul_aAtbx_wrapper<M, V> wrapper(expr);
-  blas_gemv(CblasTrans,
-            wrapper.A_row_count(),
-            wrapper.A_col_count(),
-            wrapper.a() * wrapper.b(),
-            wrapper.A(),
-            wrapper.x(),
-            value_type(1.0),
-            buffer);
+void add(const E& expr, typename E::value_type* buffer,
+         typename std::enable_if<is_scaled_matmul<E>::value>::type* = 0) {
+  using value_type = typename E::value_type;
+  matmul_update(expr, value_type(1.0), value_type(1.0), buffer);
 }
 
-// buffer += alpha * matmul(aA, bx).
+// buffer += P +/- by or by +/- P, where P is a scaled matmul.
 template<typename E>
 inline
 void add(const E& expr, typename E::value_type* buffer,
-         typename
-         std::enable_if<is_alpha_times_matmul_aAbx<E>::value>::type* = 0) {
+         typename std::enable_if<
+         is_matmul_plus_y<E>::value ||
+         is_matmul_minus_y<E>::value>::type* = 0) {
   using value_type = typename E::value_type;
-  auto wrapper = make_matmul_aAbx_wrapper(expr.e);
-  blas_gemv(CblasNoTrans,
-            wrapper.A_row_count(),
-            wrapper.A_col_count(),
-            wrapper.a() * wrapper.b() * expr.scalar,
-            wrapper.A(),
-            wrapper.x(),
-            value_type(1.0),
-            buffer);
+  auto wrapper = make_matmul_plus_minus_y_wrapper(expr);
+  if (wrapper.y() == buffer) {
+    matmul_update(wrapper.P(), wrapper.P_sign(),
+                  value_type(1.0) + wrapper.b(), buffer);
+  } else {
+    blas_axpy(wrapper.size(), wrapper.b(), wrapper.y(), buffer);
+    matmul_update(wrapper.P(), wrapper.P_sign(), value_type(1.0), buffer);
+  }
 }
 
-// buffer += alpha * matmul(aA.t(), bx).
+// buffer += as, where s is a sparse vector: a scatter over its nonzeros.
 template<typename E>
 inline
 void add(const E& expr, typename E::value_type* buffer,
          typename std::enable_if<
-         is_alpha_times_matmul_aAtbx<E>::value>::type* = 0) {
-  using value_type = typename E::value_type;
-  auto wrapper = make_matmul_aAtbx_wrapper(expr.e);
-  blas_gemv(CblasTrans,
-            wrapper.A_row_count(),
-            wrapper.A_col_count(),
-            wrapper.a() * wrapper.b() * expr.scalar,
-            wrapper.A(),
-            wrapper.x(),
-            value_type(1.0),
-            buffer);
+         is_scaled_sparse_vector<E>::value>::type* = 0) {
+  const auto& s = scaled_sparse<E>::vector(expr);
+  sparse_axpyi(s.nonzero_count(), scaled_sparse<E>::scalar(expr), s.data(),
+               s.indices(), buffer);
 }
 }  // namespace special_expression
 }  // namespace linalg_detail
@@ -8,7 +8,9 @@
 #include <algorithm>
 
 #include "insight/linalg/detail/special_expression_traits.h"
+#include "insight/linalg/detail/special_expression_matmul.h"
 #include "insight/linalg/detail/blas_routines.h"
+#include "insight/linalg/detail/sparse_routines.h"
 
 namespace insight {
 namespace linalg_detail {
@@ -18,15 +20,16 @@ template<typename E> struct is_special_assignable
   special_expression::is_ax<E>::value ||
   special_expression::is_xpy<E>::value ||
   special_expression::is_xmy<E>::value ||
+  special_expression::is_axpby<E>::value ||
   special_expression::is_xty<E>::value ||
   special_expression::is_xdy<E>::value ||
   special_expression::is_sqrt_of_x<E>::value ||
   special_expression::is_exp_of_x<E>::value ||
   special_expression::is_log_of_x<E>::value ||
-  special_expression::is_matmul_aAbx<E>::value ||
-  special_expression::is_matmul_aAtbx<E>::value ||
-  special_expression::is_alpha_times_matmul_aAbx<E>::value ||
-  special_expression::is_alpha_times_matmul_aAtbx<E>::value,
+  special_expression::is_scaled_matmul<E>::value ||
+  special_expression::is_matmul_plus_y<E>::value ||
+  special_expression::is_matmul_minus_y<E>::value ||
+  special_expression::is_scaled_sparse_vector<E>::value,
   std::true_type,
   std::false_type>::type{};
 
@@ -59,6 +62,26 @@ void assign(const E& expr, typename E::value_type* buffer,
            buffer);
 }
 
+// buffer = ax +/- by. When the buffer is one of the operands, the update is
+// done in place; otherwise y is copied into the buffer first.
+template<typename E>
+inline
+void assign(const E& expr, typename E::value_type* buffer,
+            typename std::enable_if<is_axpby<E>::value>::type* = 0) {
+  auto wrapper = make_axpby_wrapper(expr);
+  if (wrapper.y() == buffer) {
+    blas_axpby(wrapper.size(), wrapper.a(), wrapper.x(), wrapper.b(),
+               buffer);
+  } else if (wrapper.x() == buffer) {
+    blas_axpby(wrapper.size(), wrapper.b(), wrapper.y(), wrapper.a(),
+               buffer);
+  } else {
+    std::copy(wrapper.y(), wrapper.y() + wrapper.size(), buffer);
+    blas_axpby(wrapper.size(), wrapper.a(), wrapper.x(), wrapper.b(),
+               buffer);
+  }
+}
+
 // buffer = x * y
 template<typename E>
 inline
@@ -101,80 +124,44 @@ void assign(const E& expr, typename E::value_type* buffer,
   blas_log(expr.size(), expr.e.begin(), buffer);
 }
 
-// buffer = matmul(aA,bx)
-template<typename M, typename V>
-inline
-void assign(const matmul_expression<M, V>& expr,
-            typename matmul_expression<M, V>::value_type* buffer,
-            typename std::enable_if<
-            is_matmul_aAbx<matmul_expression<M, V>>::value>::type* = 0) {
-  using value_type = typename matmul_expression<M, V>::value_type;
-  matmul_aAbx_wrapper<M, V> wrapper(expr);
-  blas_gemv(CblasNoTrans,
-            wrapper.A_row_count(),
-            wrapper.A_col_count(),
-            wrapper.a() * wrapper.b(),
-            wrapper.A(),
-            wrapper.x(),
-            value_type()/*zero*/,
-            buffer);
-}
-
-// buffer = matmul(aA.t(),bx)
-template<typename M, typename V>
+// buffer = P, where P is one of matmul(aA, bx), matmul(aA.t(), bx),
+// matmul(aA, bB) or alpha times any of those.
+template<typename E>
 inline
-void assign(const matmul_expression<M, V>& expr,
-            typename matmul_expression<M, V>::value_type* buffer,
-            typename std::enable_if<
-            is_matmul_aAtbx<matmul_expression<M, V>>::value>::type* = 0) {
-  using value_type = typename matmul_expression<M, V>::value_type;
-  matmul_aAtbx_wrapper<M, V> wrapper(expr);
-  blas_gemv(CblasTrans,
-            wrapper.A_row_count(),
-            wrapper.A_col_count(),
-            wrapper.a() * wrapper.b(),
-            wrapper.A(),
-            wrapper.x(),
-            value_type()/*zero*/,
-            buffer);
+void assign(const E& expr, typename E::value_type* buffer,
+            typename std::enable_if<is_scaled_matmul<E>::value>::type* = 0) {
+  using value_type = typename E::value_type;
+  matmul_update(expr, value_type(1.0), value_type()/*zero*/, buffer);
 }
 
-// buffer = alpha * matmul(aA, bx)
+// buffer = P +/- by or by +/- P, where P is a scaled matmul. y is copied
+// into buffer (unless y is the buffer itself) and P is then accumulated into
+// it by a single gemv/gemm with beta = +/-b.
 template<typename E>
 inline
 void assign(const E& expr, typename E::value_type* buffer,
             typename std::enable_if<
-            is_alpha_times_matmul_aAbx<E>::value>::type* = 0) {
-  using value_type = typename E::value_type;
-  auto wrapper = make_matmul_aAbx_wrapper(expr.e);
-  blas_gemv(CblasNoTrans,
-            wrapper.A_row_count(),
-            wrapper.A_col_count(),
-            wrapper.a() * wrapper.b() * expr.scalar,
-            wrapper.A(),
-            wrapper.x(),
-            value_type()/*zero*/,
-            buffer);
+            is_matmul_plus_y<E>::value ||
+            is_matmul_minus_y<E>::value>::type* = 0) {
+  auto wrapper = make_matmul_plus_minus_y_wrapper(expr);
+  if (wrapper.y() != buffer) {
+    std::copy(wrapper.y(), wrapper.y() + wrapper.size(), buffer);
+  }
+  matmul_update(wrapper.P(), wrapper.P_sign(), wrapper.b(), buffer);
 }
 
-// buffer = alpha * matmul(aA.t(), bx)
+// buffer = as, where s is a sparse vector.
 template<typename E>
 inline
 void assign(const E& expr, typename E::value_type* buffer,
             typename std::enable_if<
-            is_alpha_times_matmul_aAtbx<E>::value>::type* = 0) {
+            is_scaled_sparse_vector<E>::value>::type* = 0) {
   using value_type = typename E::value_type;
-  auto wrapper = make_matmul_aAtbx_wrapper(expr.e);
-  blas_gemv(CblasTrans,
-            wrapper.A_row_count(),
-            wrapper.A_col_count(),
-            wrapper.a() * wrapper.b() * expr.scalar,
-            wrapper.A(),
-            wrapper.x(),
-            value_type()/*zero*/,
-            buffer);
+  const auto& s = scaled_sparse<E>::vector(expr);
+  std::fill(buffer, buffer + s.size(), value_type(0));
+  sparse_axpyi(s.nonzero_count(), scaled_sparse<E>::scalar(expr), s.data(),
+               s.indices(), buffer);
 }
-
 }  // namespace special_expression
 }  // namespace linalg_detail
 }  // namespace insight
@@ -0,0 +1,462 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_SPECIAL_EXPRESSION_MATMUL_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_SPECIAL_EXPRESSION_MATMUL_H_
+
+#include <algorithm>
+
+#include "insight/linalg/detail/special_expression_traits.h"
+#include "insight/linalg/detail/blas_routines.h"
+#include "insight/linalg/detail/scratch_buffer.h"
+#include "insight/linalg/detail/sparse_routines.h"
+
+namespace insight {
+namespace linalg_detail {
+namespace special_expression {
+
+// The routines below evaluate buffer = alpha * P + beta * buffer, where P is
+// a scaled matmul (see is_scaled_matmul), with a single call to gemv/gemm.
+// This lets the assign/add/sub evaluators fold the accumulation into beta
+// instead of materializing P into a temporary.
+//
+// Two forms get a cheaper routine: the outer product matmul(x, y.t()) goes
+// through ger, and the symmetric products matmul(X.t(), X) and
+// matmul(X, X.t()) through syrk, which computes only one triangle of the
+// result, i.e. half the flops of gemm, the other one being mirrored.
+//
+// The products of symmetric and triangular matrices (see symmetric_matrix.h
+// and triangular_matrix.h) with a vector go through symv/spmv and
+// trmv/tpmv, which read only their stored triangle. Those of sparse
+// matrices (see sparse_matrix.h) with a vector or a matrix go through the
+// sparse kernels (see sparse_routines.h), which read only their nonzeros.
+
+// C = alpha * op(A) * op(A)^T + beta * C, where op(A) is A (Trans =
+// CblasNoTrans) or A^T (CblasTrans) and is N x K, and C is N x N, its rows
+// ldc elements apart.
+template<typename T>
+inline void symmetric_update(CBLAS_TRANSPOSE Trans, int N, int K, T alpha,
+                             const T* A, int lda, T beta, T* C, int ldc) {
+  if (beta == T(0)) {
+    blas_syrk(CblasLower, Trans, N, K, alpha, A, lda, T(0), C, ldc);
+    for (int i = 0; i < N; ++i) {
+      for (int j = i + 1; j < N; ++j) C[i * ldc + j] = C[j * ldc + i];
+    }
+    return;
+  }
+
+  // C itself need not be symmetric: the lower triangle of the product is
+  // computed aside, and both its halves are then added to C.
+  scratch_buffer<T> S(static_cast<std::size_t>(N) * N);
+  blas_syrk(CblasLower, Trans, N, K, alpha, A, lda, T(0), S.data(), N);
+  const T* s = S.data();
+  for (int i = 0; i < N; ++i) {
+    T* c = C + i * ldc;
+    for (int j = 0; j <= i; ++j) c[j] = beta * c[j] + s[i * N + j];
+    for (int j = i + 1; j < N; ++j) c[j] = beta * c[j] + s[j * N + i];
+  }
+}
+
+inline CBLAS_UPLO cblas_uplo(triangle Uplo) {
+  return (Uplo == lower) ? CblasLower : CblasUpper;
+}
+
+// y = alpha * A * x + beta * y, where A is a symmetric matrix.
+template<typename T, triangle Uplo, typename Alloc>
+inline void symmetric_mv(const symmetric_matrix<T, Uplo, full, Alloc>& A,
+                         T alpha, const T* x, T beta, T* y) {
+  const int n = static_cast<int>(A.row_count());
+  blas_symv(cblas_uplo(Uplo), n, alpha, A.data(), n, x, 1, beta, y, 1);
+}
+
+template<typename T, triangle Uplo, typename Alloc>
+inline void symmetric_mv(const symmetric_matrix<T, Uplo, packed, Alloc>& A,
+                         T alpha, const T* x, T beta, T* y) {
+  const int n = static_cast<int>(A.row_count());
+  blas_spmv(cblas_uplo(Uplo), n, alpha, A.data(), x, 1, beta, y, 1);
+}
+
+// The stored triangle of A = alpha * op(X) * op(X)^T, where A is a
+// symmetric matrix, and op(X) is X (Trans = CblasNoTrans) or X^T
+// (CblasTrans) and is N x K, its rows (resp. columns) ldx elements apart:
+// syrk for full storage, one spr rank-1 update per column of op(X) for
+// packed storage.
+template<typename T, triangle Uplo, typename Alloc>
+inline void symmetric_rank_k(CBLAS_TRANSPOSE Trans, int K, T alpha,
+                             const T* X, int ldx,
+                             symmetric_matrix<T, Uplo, full, Alloc>* A) {
+  const int n = static_cast<int>(A->row_count());
+  blas_syrk(cblas_uplo(Uplo), Trans, n, K, alpha, X, ldx, T(0), A->data(),
+            std::max(1, n));
+}
+
+template<typename T, triangle Uplo, typename Alloc>
+inline void symmetric_rank_k(CBLAS_TRANSPOSE Trans, int K, T alpha,
+                             const T* X, int ldx,
+                             symmetric_matrix<T, Uplo, packed, Alloc>* A) {
+  const int n = static_cast<int>(A->row_count());
+  std::fill(A->data(), A->data() + A->stored_size(), T(0));
+  const int step = (Trans == CblasTrans) ? ldx : 1;
+  const int incx = (Trans == CblasTrans) ? 1 : ldx;
+  for (int k = 0; k < K; ++k) {
+    blas_spr(cblas_uplo(Uplo), n, alpha, X + k * step, incx, A->data());
+  }
+}
+
+// A = matmul(aX.t(), bX) or A = matmul(aX, bX.t()), where A is a symmetric
+// matrix of the size of the product: only its stored triangle is computed,
+// with symmetric_rank_k. Returns false (and leaves A untouched) if the
+// product is not of that form.
+template<typename M1, typename M2, typename T, triangle Uplo, storage S,
+         typename Alloc>
+inline bool assign_symmetric_product(
+    const matmul_expression<M1, M2>& expr,
+    symmetric_matrix<T, Uplo, S, Alloc>* A,
+    typename std::enable_if<is_matmul_aAbB<
+    matmul_expression<M1, M2> >::value>::type* = 0) {
+  matmul_aAbB_wrapper<M1, M2> wrapper(expr);
+  if (wrapper.trans_A() == wrapper.trans_B() || wrapper.A() != wrapper.B() ||
+      wrapper.lda() != wrapper.ldb() || wrapper.M() != wrapper.N()) {
+    return false;
+  }
+  if (wrapper.M() == 0) return true;
+  symmetric_rank_k(wrapper.trans_A(),
+                   static_cast<int>(wrapper.K()),
+                   wrapper.a() * wrapper.b(),
+                   wrapper.A(),
+                   wrapper.lda(),
+                   A);
+  return true;
+}
+
+// x = op(A) * x, where A is a triangular matrix.
+template<typename T, triangle Uplo, typename Alloc>
+inline void triangular_mv(const triangular_matrix<T, Uplo, full, Alloc>& A,
+                          CBLAS_TRANSPOSE Trans, T* x) {
+  const int n = static_cast<int>(A.row_count());
+  blas_trmv(cblas_uplo(Uplo), Trans, CblasNonUnit, n, A.data(), n, x, 1);
+}
+
+template<typename T, triangle Uplo, typename Alloc>
+inline void triangular_mv(const triangular_matrix<T, Uplo, packed, Alloc>& A,
+                          CBLAS_TRANSPOSE Trans, T* x) {
+  const int n = static_cast<int>(A.row_count());
+  blas_tpmv(cblas_uplo(Uplo), Trans, CblasNonUnit, n, A.data(), x, 1);
+}
+
+template<typename T, triangle Uplo, storage S, typename Alloc>
+inline void triangular_mv(const triangular_matrix<T, Uplo, S, Alloc>& A,
+                          T* x) {
+  triangular_mv(A, CblasNoTrans, x);
+}
+
+template<typename T, triangle Uplo, storage S, typename Alloc>
+inline void triangular_mv(
+    const transpose_expression<triangular_matrix<T, Uplo, S, Alloc> >& At,
+    T* x) {
+  triangular_mv(At.e, CblasTrans, x);
+}
+
+// P = matmul(aA, bx)
+template<typename M, typename V>
+inline
+void matmul_update(const matmul_expression<M, V>& expr,
+                   typename matmul_expression<M, V>::value_type alpha,
+                   typename matmul_expression<M, V>::value_type beta,
+                   typename matmul_expression<M, V>::value_type* buffer,
+                   typename std::enable_if<is_matmul_aAbx<
+                   matmul_expression<M, V> >::value>::type* = 0) {
+  matmul_aAbx_wrapper<M, V> wrapper(expr);
+  blas_gemv(CblasNoTrans,
+            wrapper.A_row_count(),
+            wrapper.A_col_count(),
+            wrapper.a() * wrapper.b() * alpha,
+            wrapper.A(),
+            wrapper.lda(),
+            wrapper.x(),
+            1,
+            beta,
+            buffer,
+            1);
+}
+
+// P = matmul(aA.t(), bx)
+template<typename M, typename V>
+inline
+void matmul_update(const matmul_expression<M, V>& expr,
+                   typename matmul_expression<M, V>::value_type alpha,
+                   typename matmul_expression<M, V>::value_type beta,
+                   typename matmul_expression<M, V>::value_type* buffer,
+                   typename std::enable_if<is_matmul_aAtbx<
+                   matmul_expression<M, V> >::value>::type* = 0) {
+  matmul_aAtbx_wrapper<M, V> wrapper(expr);
+  blas_gemv(CblasTrans,
+            wrapper.A_row_count(),
+            wrapper.A_col_count(),
+            wrapper.a() * wrapper.b() * alpha,
+            wrapper.A(),
+            wrapper.lda(),
+            wrapper.x(),
+            1,
+            beta,
+            buffer,
+            1);
+}
+
+// P = matmul(aA, bB), where A and/or B might be transposed, and buffer is
+// a block (of a dense matrix) whose rows are ldc elements apart.
+template<typename M1, typename M2>
+inline
+void matmul_update(const matmul_expression<M1, M2>& expr,
+                   typename matmul_expression<M1, M2>::value_type alpha,
+                   typename matmul_expression<M1, M2>::value_type beta,
+                   typename matmul_expression<M1, M2>::value_type* buffer,
+                   int ldc,
+                   typename std::enable_if<is_matmul_aAbB<
+                   matmul_expression<M1, M2> >::value>::type* = 0) {
+  matmul_aAbB_wrapper<M1, M2> wrapper(expr);
+
+  // matmul(aX.t(), bX) or matmul(aX, bX.t()): both operands are the same
+  // matrix, one of them transposed.
+  if (wrapper.trans_A() != wrapper.trans_B() && wrapper.A() == wrapper.B() &&
+      wrapper.lda() == wrapper.ldb() && wrapper.M() == wrapper.N()) {
+    if (wrapper.M() == 0) return;
+    symmetric_update(wrapper.trans_A(),
+                     static_cast<int>(wrapper.M()),
+                     static_cast<int>(wrapper.K()),
+                     wrapper.a() * wrapper.b() * alpha,
+                     wrapper.A(),
+                     wrapper.lda(),
+                     beta,
+                     buffer,
+                     ldc);
+    return;
+  }
+
+  blas_gemm(wrapper.trans_A(),
+            wrapper.trans_B(),
+            wrapper.M(),
+            wrapper.N(),
+            wrapper.K(),
+            wrapper.a() * wrapper.b() * alpha,
+            wrapper.A(),
+            wrapper.lda(),
+            wrapper.B(),
+            wrapper.ldb(),
+            beta,
+            buffer,
+            ldc);
+}
+
+// P = matmul(aA, bB), where A and/or B might be transposed.
+template<typename M1, typename M2>
+inline
+void matmul_update(const matmul_expression<M1, M2>& expr,
+                   typename matmul_expression<M1, M2>::value_type alpha,
+                   typename matmul_expression<M1, M2>::value_type beta,
+                   typename matmul_expression<M1, M2>::value_type* buffer,
+                   typename std::enable_if<is_matmul_aAbB<
+                   matmul_expression<M1, M2> >::value>::type* = 0) {
+  matmul_update(expr, alpha, beta, buffer,
+                static_cast<int>(expr.col_count()));
+}
+
+// P = matmul(ax, (by).t())
+template<typename V1, typename V2>
+inline
+void matmul_update(
+    const matmul_expression<V1, transpose_expression<V2> >& expr,
+    typename V1::value_type alpha,
+    typename V1::value_type beta,
+    typename V1::value_type* buffer,
+    typename std::enable_if<is_matmul_xyt<
+    matmul_expression<V1, transpose_expression<V2> > >::value>::type* = 0) {
+  using value_type = typename V1::value_type;
+  const int M = static_cast<int>(expr.row_count());
+  const int N = static_cast<int>(expr.col_count());
+  if (M == 0 || N == 0) return;
+
+  // ger accumulates into buffer, which is scaled by beta first.
+  if (beta == value_type(0)) {
+    std::fill(buffer, buffer + M * N, value_type(0));
+  } else if (beta != value_type(1)) {
+    blas_scal(M * N, beta, buffer);
+  }
+  blas_ger(M,
+           N,
+           scaled_dense<V1>::scalar(expr.u) *
+           scaled_dense<V2>::scalar(expr.vt.e) * alpha,
+           scaled_dense<V1>::data(expr.u),
+           1,
+           scaled_dense<V2>::data(expr.vt.e),
+           1,
+           buffer,
+           N);
+}
+
+// P = matmul(S, bx), where S is a symmetric matrix.
+template<typename M, typename V>
+inline
+void matmul_update(const matmul_expression<M, V>& expr,
+                   typename matmul_expression<M, V>::value_type alpha,
+                   typename matmul_expression<M, V>::value_type beta,
+                   typename matmul_expression<M, V>::value_type* buffer,
+                   typename std::enable_if<is_matmul_Sbx<
+                   matmul_expression<M, V> >::value>::type* = 0) {
+  if (expr.row_count() == 0) return;
+  symmetric_mv(expr.m,
+               scaled_dense<V>::scalar(expr.v) * alpha,
+               scaled_dense<V>::data(expr.v),
+               beta,
+               buffer);
+}
+
+// P = matmul(T, bx), where T is a triangular matrix, possibly transposed.
+template<typename M, typename V>
+inline
+void matmul_update(const matmul_expression<M, V>& expr,
+                   typename matmul_expression<M, V>::value_type alpha,
+                   typename matmul_expression<M, V>::value_type beta,
+                   typename matmul_expression<M, V>::value_type* buffer,
+                   typename std::enable_if<is_matmul_Tbx<
+                   matmul_expression<M, V> >::value>::type* = 0) {
+  using value_type = typename matmul_expression<M, V>::value_type;
+  const int n = static_cast<int>(expr.row_count());
+  if (n == 0) return;
+
+  // trmv multiplies in place: x is copied into buffer, or aside when the
+  // product is accumulated into buffer.
+  const value_type a = scaled_dense<V>::scalar(expr.v) * alpha;
+  const value_type* x = scaled_dense<V>::data(expr.v);
+  if (beta == value_type(0)) {
+    std::copy(x, x + n, buffer);
+    triangular_mv(expr.m, buffer);
+    if (a != value_type(1)) blas_scal(n, a, buffer);
+    return;
+  }
+
+  scratch_buffer<value_type> tmp(n);
+  std::copy(x, x + n, tmp.data());
+  triangular_mv(expr.m, tmp.data());
+  blas_axpby(n, a, tmp.data(), beta, buffer);
+}
+
+// The CSR form of a sparse matrix operand, and whether it is multiplied as
+// is (CblasNoTrans) or transposed (CblasTrans): a CSC matrix is the CSR
+// form of its transpose.
+template<typename E> struct sparse_operand;
+
+template<typename T, sparse_format F>
+struct sparse_operand<sparse_matrix<T, F> > {
+  using matrix_type = sparse_matrix<T, F>;
+  static constexpr CBLAS_TRANSPOSE trans =
+      (F == csr) ? CblasNoTrans : CblasTrans;
+  static inline const matrix_type& matrix(const matrix_type& e) { return e; }
+};
+
+template<typename T, sparse_format F>
+struct sparse_operand<transpose_expression<sparse_matrix<T, F> > > {
+  using matrix_type = sparse_matrix<T, F>;
+  static constexpr CBLAS_TRANSPOSE trans =
+      (F == csr) ? CblasTrans : CblasNoTrans;
+  static inline const matrix_type&
+  matrix(const transpose_expression<matrix_type>& e) { return e.e; }
+};
+
+// The dimensions of the CSR form of A.
+template<typename T, sparse_format F>
+inline int csr_row_count(const sparse_matrix<T, F>& A) {
+  return static_cast<int>((F == csr) ? A.row_count() : A.col_count());
+}
+
+template<typename T, sparse_format F>
+inline int csr_col_count(const sparse_matrix<T, F>& A) {
+  return static_cast<int>((F == csr) ? A.col_count() : A.row_count());
+}
+
+// P = matmul(SP, bx), where SP is a sparse matrix, possibly transposed.
+template<typename M, typename V>
+inline
+void matmul_update(const matmul_expression<M, V>& expr,
+                   typename matmul_expression<M, V>::value_type alpha,
+                   typename matmul_expression<M, V>::value_type beta,
+                   typename matmul_expression<M, V>::value_type* buffer,
+                   typename std::enable_if<is_matmul_SPbx<
+                   matmul_expression<M, V> >::value>::type* = 0) {
+  using operand = sparse_operand<M>;
+  const typename operand::matrix_type& A = operand::matrix(expr.m);
+  sparse_csrmv(operand::trans,
+               csr_row_count(A),
+               csr_col_count(A),
+               scaled_dense<V>::scalar(expr.v) * alpha,
+               A.data(),
+               A.indices(),
+               A.offsets(),
+               scaled_dense<V>::data(expr.v),
+               beta,
+               buffer);
+}
+
+// P = matmul(SP, bB), where SP is a sparse matrix, possibly transposed.
+template<typename M1, typename M2>
+inline
+void matmul_update(const matmul_expression<M1, M2>& expr,
+                   typename matmul_expression<M1, M2>::value_type alpha,
+                   typename matmul_expression<M1, M2>::value_type beta,
+                   typename matmul_expression<M1, M2>::value_type* buffer,
+                   typename std::enable_if<is_matmul_SPbB<
+                   matmul_expression<M1, M2> >::value>::type* = 0) {
+  using operand = sparse_operand<M1>;
+  using dense = gemm_operand<M2>;
+  const typename operand::matrix_type& A = operand::matrix(expr.m1);
+  const int N = static_cast<int>(expr.col_count());
+  sparse_csrmm(operand::trans,
+               csr_row_count(A),
+               N,
+               csr_col_count(A),
+               dense::scalar(expr.m2) * alpha,
+               A.data(),
+               A.indices(),
+               A.offsets(),
+               dense::data(expr.m2),
+               dense::ld(expr.m2),
+               beta,
+               buffer,
+               N);
+}
+
+// P = s * matmul(...) or matmul(...) * s
+template<typename E>
+inline
+void matmul_update(const E& expr,
+                   typename E::value_type alpha,
+                   typename E::value_type beta,
+                   typename E::value_type* buffer,
+                   typename std::enable_if<
+                   is_alpha_times_matmul_aAbx<E>::value ||
+                   is_alpha_times_matmul_aAtbx<E>::value ||
+                   is_alpha_times_matmul_aAbB<E>::value ||
+                   is_alpha_times_matmul_xyt<E>::value ||
+                   is_alpha_times_matmul_STbx<E>::value ||
+                   is_alpha_times_matmul_SPbxB<E>::value>::type* = 0) {
+  matmul_update(expr.e, expr.scalar * alpha, beta, buffer);
+}
+
+// P = s * matmul(aA, bB) or matmul(aA, bB) * s, into a block.
+template<typename E>
+inline
+void matmul_update(const E& expr,
+                   typename E::value_type alpha,
+                   typename E::value_type beta,
+                   typename E::value_type* buffer,
+                   int ldc,
+                   typename std::enable_if<
+                   is_alpha_times_matmul_aAbB<E>::value>::type* = 0) {
+  matmul_update(expr.e, expr.scalar * alpha, beta, buffer, ldc);
+}
+
+}  // namespace special_expression
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_SPECIAL_EXPRESSION_MATMUL_H_
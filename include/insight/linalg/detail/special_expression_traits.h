@@ -10,7 +10,10 @@
 #include "insight/linalg/detail/matmul_expression.h"
 #include "insight/linalg/detail/is_dense_vector.h"
 #include "insight/linalg/detail/is_dense_matrix.h"
+#include "insight/linalg/detail/triangular_layout.h"
+#include "insight/linalg/detail/sparse_format.h"
 #include "insight/linalg/detail/functors.h"
+#include "insight/linalg/detail/blas_routines.h"
 
 namespace insight {
 namespace linalg_detail {
@@ -188,6 +191,29 @@ struct is_transpose_of_dense_matrix<transpose_expression<E> >
                               std::true_type,
                               std::false_type>::type{};
 
+// Is a generic expression E of the form B' where B is a block of a dense
+// matrix?
+
+template<typename E>
+struct is_transpose_of_dense_block : public std::false_type{};
+
+template<typename E>
+struct is_transpose_of_dense_block<transpose_expression<E> >
+    : public is_dense_block<E>{};
+
+// Distance between the starts of two consecutive rows of a dense matrix
+// (the lda of BLAS), or of a block of one.
+
+template<typename E>
+inline int leading_dimension(const E& e) {
+  return static_cast<int>(e.col_count());
+}
+
+template<typename M>
+inline int leading_dimension(const block_view<M>& e) {
+  return static_cast<int>(e.ld());
+}
+
 // Is a generic expression of the form a * A' or A' * a where
 // a is a scalar, and A is a dense matrix having the same element type
 // as a?
@@ -203,7 +229,7 @@ struct is_transpose_of_dense_matrix_times_scalar<
   is_dense_matrix<E>::value &&
   std::is_same<typename E::value_type, T>::value,
   std::true_type,
-  std::false_type>{};
+  std::false_type>::type{};
 
 template<typename E, typename T>
 struct is_transpose_of_dense_matrix_times_scalar<
@@ -212,7 +238,7 @@ struct is_transpose_of_dense_matrix_times_scalar<
   is_dense_matrix<E>::value &&
   std::is_same<typename E::value_type, T>::value,
   std::true_type,
-  std::false_type>{};
+  std::false_type>::type{};
 
 // matmul(aA, bx): is_matmul_aAbx
 
@@ -221,7 +247,8 @@ template<typename E> struct is_matmul_aAbx : public std::false_type{};
 template<typename M, typename V>
 struct is_matmul_aAbx<matmul_expression<M, V> >
     : public std::conditional<
-  (is_dense_matrix<M>::value || is_dense_matrix_times_scalar<M>::value) &&
+  (is_dense_matrix<M>::value || is_dense_block<M>::value ||
+   is_dense_matrix_times_scalar<M>::value) &&
   (is_dense_vector<V>::value || is_dense_vector_times_scalar<V>::value) &&
   std::is_same<typename M::value_type, typename V::value_type>::value &&
   std::is_floating_point<typename M::value_type>::value,
@@ -244,6 +271,10 @@ struct matmul_aAbx_wrapper {
 
   inline matrix_size_type A_row_count() const { return expr.m.row_count(); }
   inline matrix_size_type A_col_count() const { return expr.m.col_count(); }
+  inline int lda() const {
+    return lda_(std::integral_constant<bool,
+                is_dense_matrix_times_scalar<M>::value>());
+  }
 
   inline value_type a() const {
     return a_(std::integral_constant<bool,
@@ -290,6 +321,14 @@ struct matmul_aAbx_wrapper {
     return expr.m.data();
   }
 
+  inline int lda_(std::true_type) const {
+    return leading_dimension(expr.m.e);
+  }
+
+  inline int lda_(std::false_type) const {
+    return leading_dimension(expr.m);
+  }
+
   inline const value_type* x_(std::true_type) const {
     return expr.v.e.data();
   }
@@ -314,6 +353,7 @@ template<typename M, typename V>
 struct is_matmul_aAtbx<matmul_expression<M, V> >
     : public std::conditional<
   (is_transpose_of_dense_matrix<M>::value ||
+   is_transpose_of_dense_block<M>::value ||
    is_transpose_of_dense_matrix_times_scalar<M>::value) &&
   (is_dense_vector<V>::value || is_dense_vector_times_scalar<V>::value) &&
   std::is_same<typename M::value_type, typename V::value_type>::value &&
@@ -338,6 +378,10 @@ struct matmul_aAtbx_wrapper {
 
   inline matrix_size_type A_row_count() const { return expr.m.col_count(); }
   inline matrix_size_type A_col_count() const { return expr.m.row_count(); }
+  inline int lda() const {
+    return lda_(std::integral_constant<bool,
+                is_transpose_of_dense_matrix_times_scalar<M>::value>());
+  }
 
   inline value_type a() const {
     return a_(std::integral_constant<bool,
@@ -384,6 +428,14 @@ struct matmul_aAtbx_wrapper {
     return expr.m.e.data();
   }
 
+  inline int lda_(std::true_type) const {
+    return leading_dimension(expr.m.e.e);
+  }
+
+  inline int lda_(std::false_type) const {
+    return leading_dimension(expr.m.e);
+  }
+
   inline const value_type* x_(std::true_type) const {
     return expr.v.e.data();
   }
@@ -449,6 +501,620 @@ struct is_alpha_times_matmul_aAtbx<
   std::is_same<typename E::value_type, T>::value,
   std::true_type,
   std::false_type>::type{};
+
+// Is a generic matrix expression E one of A, a * A, A.t() or a * A.t()
+// where A is a dense matrix? Such an operand can be handed to gemm as is.
+
+template<typename E>
+struct is_gemm_operand
+    : public std::conditional<
+  is_dense_matrix<E>::value ||
+  is_dense_matrix_times_scalar<E>::value ||
+  is_transpose_of_dense_matrix<E>::value ||
+  is_transpose_of_dense_matrix_times_scalar<E>::value ||
+  is_dense_block<E>::value ||
+  is_transpose_of_dense_block<E>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// helper for extracting the scalar, the transpose flag, the underlying
+// buffer and its leading dimension of a gemm operand.
+template<typename E, typename Enable = void> struct gemm_operand;
+
+// A
+template<typename E>
+struct gemm_operand<
+  E, typename std::enable_if<is_dense_matrix<E>::value>::type> {
+  using value_type = typename E::value_type;
+  static constexpr CBLAS_TRANSPOSE trans = CblasNoTrans;
+  static inline value_type scalar(const E&) { return value_type(1.0); }
+  static inline const value_type* data(const E& e) { return e.cbegin(); }
+  static inline int ld(const E& e) { return leading_dimension(e); }
+};
+
+// a * A or A * a
+template<typename E>
+struct gemm_operand<
+  E, typename std::enable_if<is_dense_matrix_times_scalar<E>::value>::type> {
+  using value_type = typename E::value_type;
+  static constexpr CBLAS_TRANSPOSE trans = CblasNoTrans;
+  static inline value_type scalar(const E& e) { return e.scalar; }
+  static inline const value_type* data(const E& e) { return e.e.cbegin(); }
+  static inline int ld(const E& e) { return leading_dimension(e.e); }
+};
+
+// A.t()
+template<typename E>
+struct gemm_operand<
+  E,
+  typename std::enable_if<is_transpose_of_dense_matrix<E>::value>::type> {
+  using value_type = typename E::value_type;
+  static constexpr CBLAS_TRANSPOSE trans = CblasTrans;
+  static inline value_type scalar(const E&) { return value_type(1.0); }
+  static inline const value_type* data(const E& e) { return e.e.cbegin(); }
+  static inline int ld(const E& e) { return leading_dimension(e.e); }
+};
+
+// a * A.t() or A.t() * a
+template<typename E>
+struct gemm_operand<
+  E,
+  typename std::enable_if<
+    is_transpose_of_dense_matrix_times_scalar<E>::value>::type> {
+  using value_type = typename E::value_type;
+  static constexpr CBLAS_TRANSPOSE trans = CblasTrans;
+  static inline value_type scalar(const E& e) { return e.scalar; }
+  static inline const value_type* data(const E& e) { return e.e.e.cbegin(); }
+  static inline int ld(const E& e) { return leading_dimension(e.e.e); }
+};
+
+// B, a block of a dense matrix.
+template<typename E>
+struct gemm_operand<
+  E, typename std::enable_if<is_dense_block<E>::value>::type> {
+  using value_type = typename E::value_type;
+  static constexpr CBLAS_TRANSPOSE trans = CblasNoTrans;
+  static inline value_type scalar(const E&) { return value_type(1.0); }
+  static inline const value_type* data(const E& e) { return e.data(); }
+  static inline int ld(const E& e) { return leading_dimension(e); }
+};
+
+// B.t()
+template<typename E>
+struct gemm_operand<
+  E,
+  typename std::enable_if<is_transpose_of_dense_block<E>::value>::type> {
+  using value_type = typename E::value_type;
+  static constexpr CBLAS_TRANSPOSE trans = CblasTrans;
+  static inline value_type scalar(const E&) { return value_type(1.0); }
+  static inline const value_type* data(const E& e) { return e.e.data(); }
+  static inline int ld(const E& e) { return leading_dimension(e.e); }
+};
+
+// matmul(aA, bB) where A and/or B might be transposed: is_matmul_aAbB
+
+template<typename E> struct is_matmul_aAbB : public std::false_type{};
+
+template<typename M1, typename M2>
+struct is_matmul_aAbB<matmul_expression<M1, M2> >
+    : public std::conditional<
+  is_gemm_operand<M1>::value &&
+  is_gemm_operand<M2>::value &&
+  std::is_same<typename M1::value_type, typename M2::value_type>::value &&
+  std::is_floating_point<typename M1::value_type>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// helper for evaluating the matmul(aA, bB) expression.
+template<typename M1, typename M2>
+struct matmul_aAbB_wrapper {
+  using expression_type = matmul_expression<M1, M2>;
+  using value_type = typename expression_type::value_type;
+  using size_type = typename expression_type::size_type;
+
+  const expression_type& expr;
+
+  explicit matmul_aAbB_wrapper(
+      const expression_type& expr,
+      typename std::enable_if<
+      is_matmul_aAbB<expression_type>::value>::type* = 0)
+      : expr(expr) {}
+
+  // op(A) is an M by K matrix, op(B) is a K by N matrix.
+  inline size_type M() const { return expr.m1.row_count(); }
+  inline size_type N() const { return expr.m2.col_count(); }
+  inline size_type K() const { return expr.m1.col_count(); }
+
+  inline CBLAS_TRANSPOSE trans_A() const { return gemm_operand<M1>::trans; }
+  inline CBLAS_TRANSPOSE trans_B() const { return gemm_operand<M2>::trans; }
+
+  inline value_type a() const { return gemm_operand<M1>::scalar(expr.m1); }
+  inline value_type b() const { return gemm_operand<M2>::scalar(expr.m2); }
+
+  inline const value_type* A() const {
+    return gemm_operand<M1>::data(expr.m1);
+  }
+
+  inline const value_type* B() const {
+    return gemm_operand<M2>::data(expr.m2);
+  }
+
+  inline int lda() const { return gemm_operand<M1>::ld(expr.m1); }
+  inline int ldb() const { return gemm_operand<M2>::ld(expr.m2); }
+};
+
+template<typename M1, typename M2>
+inline
+matmul_aAbB_wrapper<M1, M2>
+make_matmul_aAbB_wrapper(const matmul_expression<M1, M2>& expr) {
+  return matmul_aAbB_wrapper<M1, M2>(expr);
+}
+
+// alpha * matmul(aA, bB)
+
+template<typename E>
+struct is_alpha_times_matmul_aAbB : public std::false_type{};
+
+template<typename E, typename T>
+struct is_alpha_times_matmul_aAbB<
+  binary_expression<E, T, std::multiplies<T> > >
+    : public std::conditional<
+  is_matmul_aAbB<E>::value &&
+  std::is_floating_point<T>::value &&
+  std::is_same<typename E::value_type, T>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+template<typename E, typename T>
+struct is_alpha_times_matmul_aAbB<
+  binary_expression<T, E, std::multiplies<T> > >
+    : public std::conditional<
+  is_matmul_aAbB<E>::value &&
+  std::is_floating_point<T>::value &&
+  std::is_same<typename E::value_type, T>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// matmul(ax, (by).t()), the outer product of two dense vectors:
+// is_matmul_xyt
+
+template<typename E> struct is_matmul_xyt : public std::false_type{};
+
+template<typename V1, typename V2>
+struct is_matmul_xyt<matmul_expression<V1, transpose_expression<V2> > >
+    : public std::conditional<
+  (is_dense_vector<V1>::value || is_dense_vector_times_scalar<V1>::value) &&
+  (is_dense_vector<V2>::value || is_dense_vector_times_scalar<V2>::value) &&
+  std::is_same<typename V1::value_type, typename V2::value_type>::value &&
+  std::is_floating_point<typename V1::value_type>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// alpha * matmul(ax, (by).t())
+
+template<typename E>
+struct is_alpha_times_matmul_xyt : public std::false_type{};
+
+template<typename E, typename T>
+struct is_alpha_times_matmul_xyt<
+  binary_expression<E, T, std::multiplies<T> > >
+    : public std::conditional<
+  is_matmul_xyt<E>::value &&
+  std::is_floating_point<T>::value &&
+  std::is_same<typename E::value_type, T>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+template<typename E, typename T>
+struct is_alpha_times_matmul_xyt<
+  binary_expression<T, E, std::multiplies<T> > >
+    : public std::conditional<
+  is_matmul_xyt<E>::value &&
+  std::is_floating_point<T>::value &&
+  std::is_same<typename E::value_type, T>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// matmul(S, bx), where S is a symmetric matrix: is_matmul_Sbx
+
+template<typename E> struct is_matmul_Sbx : public std::false_type{};
+
+template<typename M, typename V>
+struct is_matmul_Sbx<matmul_expression<M, V> >
+    : public std::conditional<
+  is_symmetric_matrix<M>::value &&
+  (is_dense_vector<V>::value || is_dense_vector_times_scalar<V>::value) &&
+  std::is_same<typename M::value_type, typename V::value_type>::value &&
+  std::is_floating_point<typename M::value_type>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// matmul(T, bx), where T is a triangular matrix, possibly transposed:
+// is_matmul_Tbx
+
+template<typename E> struct is_matmul_Tbx : public std::false_type{};
+
+template<typename M, typename V>
+struct is_matmul_Tbx<matmul_expression<M, V> >
+    : public std::conditional<
+  (is_triangular_matrix<M>::value ||
+   is_transpose_of_triangular_matrix<M>::value) &&
+  (is_dense_vector<V>::value || is_dense_vector_times_scalar<V>::value) &&
+  std::is_same<typename M::value_type, typename V::value_type>::value &&
+  std::is_floating_point<typename M::value_type>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// alpha * matmul(S, bx) or alpha * matmul(T, bx)
+
+template<typename E>
+struct is_alpha_times_matmul_STbx : public std::false_type{};
+
+template<typename E, typename T>
+struct is_alpha_times_matmul_STbx<
+  binary_expression<E, T, std::multiplies<T> > >
+    : public std::conditional<
+  (is_matmul_Sbx<E>::value || is_matmul_Tbx<E>::value) &&
+  std::is_floating_point<T>::value &&
+  std::is_same<typename E::value_type, T>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+template<typename E, typename T>
+struct is_alpha_times_matmul_STbx<
+  binary_expression<T, E, std::multiplies<T> > >
+    : public std::conditional<
+  (is_matmul_Sbx<E>::value || is_matmul_Tbx<E>::value) &&
+  std::is_floating_point<T>::value &&
+  std::is_same<typename E::value_type, T>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// matmul(SP, bx), where SP is a sparse matrix, possibly transposed:
+// is_matmul_SPbx
+
+template<typename E> struct is_matmul_SPbx : public std::false_type{};
+
+template<typename M, typename V>
+struct is_matmul_SPbx<matmul_expression<M, V> >
+    : public std::conditional<
+  is_sparse_operand<M>::value &&
+  (is_dense_vector<V>::value || is_dense_vector_times_scalar<V>::value) &&
+  std::is_same<typename M::value_type, typename V::value_type>::value &&
+  std::is_floating_point<typename M::value_type>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// matmul(SP, bB), where SP is a sparse matrix, possibly transposed, and B
+// is a dense matrix or a block of one: is_matmul_SPbB
+
+template<typename E> struct is_matmul_SPbB : public std::false_type{};
+
+template<typename M1, typename M2>
+struct is_matmul_SPbB<matmul_expression<M1, M2> >
+    : public std::conditional<
+  is_sparse_operand<M1>::value &&
+  (is_dense_matrix<M2>::value || is_dense_matrix_times_scalar<M2>::value ||
+   is_dense_block<M2>::value) &&
+  std::is_same<typename M1::value_type, typename M2::value_type>::value &&
+  std::is_floating_point<typename M1::value_type>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// alpha * matmul(SP, bx) or alpha * matmul(SP, bB)
+
+template<typename E>
+struct is_alpha_times_matmul_SPbxB : public std::false_type{};
+
+template<typename E, typename T>
+struct is_alpha_times_matmul_SPbxB<
+  binary_expression<E, T, std::multiplies<T> > >
+    : public std::conditional<
+  (is_matmul_SPbx<E>::value || is_matmul_SPbB<E>::value) &&
+  std::is_floating_point<T>::value &&
+  std::is_same<typename E::value_type, T>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+template<typename E, typename T>
+struct is_alpha_times_matmul_SPbxB<
+  binary_expression<T, E, std::multiplies<T> > >
+    : public std::conditional<
+  (is_matmul_SPbx<E>::value || is_matmul_SPbB<E>::value) &&
+  std::is_floating_point<T>::value &&
+  std::is_same<typename E::value_type, T>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// Is a generic expression E a matrix-vector or a matrix-matrix product
+// (possibly scaled by alpha) that maps onto a single call to gemv/gemm (or
+// syrk, symv/spmv, trmv/tpmv, or one of the sparse kernels), or an outer
+// product that maps onto ger?
+
+template<typename E>
+struct is_scaled_matmul
+    : public std::conditional<
+  is_matmul_aAbx<E>::value ||
+  is_matmul_aAtbx<E>::value ||
+  is_alpha_times_matmul_aAbx<E>::value ||
+  is_alpha_times_matmul_aAtbx<E>::value ||
+  is_matmul_aAbB<E>::value ||
+  is_alpha_times_matmul_aAbB<E>::value ||
+  is_matmul_xyt<E>::value ||
+  is_alpha_times_matmul_xyt<E>::value ||
+  is_matmul_Sbx<E>::value ||
+  is_matmul_Tbx<E>::value ||
+  is_alpha_times_matmul_STbx<E>::value ||
+  is_matmul_SPbx<E>::value ||
+  is_matmul_SPbB<E>::value ||
+  is_alpha_times_matmul_SPbxB<E>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// Is a generic expression E one of y, b * y or y * b where y is a dense
+// vector or a dense matrix?
+
+template<typename E>
+struct is_scaled_dense
+    : public std::conditional<
+  is_dense_vector<E>::value ||
+  is_dense_matrix<E>::value ||
+  is_dense_vector_times_scalar<E>::value ||
+  is_dense_matrix_times_scalar<E>::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// helper for extracting the scalar and the underlying buffer of a scaled
+// dense operand.
+template<typename E, typename Enable = void> struct scaled_dense;
+
+// y
+template<typename E>
+struct scaled_dense<
+  E,
+  typename std::enable_if<
+    is_dense_vector<E>::value || is_dense_matrix<E>::value>::type> {
+  using value_type = typename E::value_type;
+  static inline value_type scalar(const E&) { return value_type(1.0); }
+  static inline const value_type* data(const E& e) { return e.data(); }
+};
+
+// b * y or y * b
+template<typename E>
+struct scaled_dense<
+  E,
+  typename std::enable_if<
+    is_dense_vector_times_scalar<E>::value ||
+    is_dense_matrix_times_scalar<E>::value>::type> {
+  using value_type = typename E::value_type;
+  static inline value_type scalar(const E& e) { return e.scalar; }
+  static inline const value_type* data(const E& e) { return e.e.data(); }
+};
+
+// P + by or by + P where P is a scaled matmul: is_matmul_plus_y.
+
+template<typename E> struct is_matmul_plus_y : public std::false_type{};
+
+template<typename E1, typename E2, typename T>
+struct is_matmul_plus_y<binary_expression<E1, E2, std::plus<T> > >
+    : public std::conditional<
+  std::is_floating_point<T>::value &&
+  ((is_scaled_matmul<E1>::value && is_scaled_dense<E2>::value) ||
+   (is_scaled_dense<E1>::value && is_scaled_matmul<E2>::value)),
+  std::true_type,
+  std::false_type>::type{};
+
+// P - by or by - P where P is a scaled matmul: is_matmul_minus_y.
+
+template<typename E> struct is_matmul_minus_y : public std::false_type{};
+
+template<typename E1, typename E2, typename T>
+struct is_matmul_minus_y<binary_expression<E1, E2, std::minus<T> > >
+    : public std::conditional<
+  std::is_floating_point<T>::value &&
+  ((is_scaled_matmul<E1>::value && is_scaled_dense<E2>::value) ||
+   (is_scaled_dense<E1>::value && is_scaled_matmul<E2>::value)),
+  std::true_type,
+  std::false_type>::type{};
+
+// helper for splitting P +/- by (or by +/- P) into its matmul term P with
+// its sign, and its dense term y with its signed scalar.
+template<typename E> struct matmul_plus_minus_y_wrapper;
+
+template<typename E1, typename E2, typename F>
+struct matmul_plus_minus_y_wrapper<binary_expression<E1, E2, F> > {
+  using expression_type = binary_expression<E1, E2, F>;
+  using value_type = typename expression_type::value_type;
+  using size_type = typename expression_type::size_type;
+
+  static constexpr bool matmul_first = is_scaled_matmul<E1>::value;
+  static constexpr bool is_minus =
+      std::is_same<F, std::minus<value_type> >::value;
+
+  using matmul_type =
+      typename std::conditional<matmul_first, E1, E2>::type;
+  using dense_type =
+      typename std::conditional<matmul_first, E2, E1>::type;
+
+  const expression_type& expr;
+
+  explicit matmul_plus_minus_y_wrapper(
+      const expression_type& expr,
+      typename std::enable_if<
+      is_matmul_plus_y<expression_type>::value ||
+      is_matmul_minus_y<expression_type>::value>::type* = 0)
+      : expr(expr) {}
+
+  inline size_type size() const { return expr.size(); }
+
+  // The matmul term and its sign.
+  inline const matmul_type& P() const {
+    return P_(std::integral_constant<bool, matmul_first>());
+  }
+
+  inline value_type P_sign() const {
+    return (is_minus && !matmul_first) ? value_type(-1.0) : value_type(1.0);
+  }
+
+  // The scalar (sign included) and the underlying buffer of the dense term.
+  inline value_type b() const {
+    value_type b = scaled_dense<dense_type>::scalar(y_());
+    return (is_minus && matmul_first) ? -b : b;
+  }
+
+  inline const value_type* y() const {
+    return scaled_dense<dense_type>::data(y_());
+  }
+
+ private:
+  inline const matmul_type& P_(std::true_type) const { return expr.e1; }
+  inline const matmul_type& P_(std::false_type) const { return expr.e2; }
+
+  inline const dense_type& y_() const {
+    return y_(std::integral_constant<bool, matmul_first>());
+  }
+
+  inline const dense_type& y_(std::true_type) const { return expr.e2; }
+  inline const dense_type& y_(std::false_type) const { return expr.e1; }
+};
+
+template<typename E>
+inline
+matmul_plus_minus_y_wrapper<E>
+make_matmul_plus_minus_y_wrapper(const E& expr) {
+  return matmul_plus_minus_y_wrapper<E>(expr);
+}
+
+// ax +/- by, where x and y are dense vectors (or dense matrices) and at least
+// one of them is scaled (plain x +/- y is covered by is_xpy/is_xmy):
+// is_axpby.
+
+template<typename E> struct is_axpby : public std::false_type{};
+
+template<typename E1, typename E2, typename T>
+struct is_axpby<binary_expression<E1, E2, std::plus<T> > >
+    : public std::conditional<
+  std::is_floating_point<T>::value &&
+  is_scaled_dense<E1>::value && is_scaled_dense<E2>::value &&
+  !is_xpy<binary_expression<E1, E2, std::plus<T> > >::value,
+  std::true_type,
+  std::false_type>::type{};
+
+template<typename E1, typename E2, typename T>
+struct is_axpby<binary_expression<E1, E2, std::minus<T> > >
+    : public std::conditional<
+  std::is_floating_point<T>::value &&
+  is_scaled_dense<E1>::value && is_scaled_dense<E2>::value &&
+  !is_xmy<binary_expression<E1, E2, std::minus<T> > >::value,
+  std::true_type,
+  std::false_type>::type{};
+
+// helper for evaluating the ax +/- by expression.
+template<typename E> struct axpby_wrapper;
+
+template<typename E1, typename E2, typename F>
+struct axpby_wrapper<binary_expression<E1, E2, F> > {
+  using expression_type = binary_expression<E1, E2, F>;
+  using value_type = typename expression_type::value_type;
+  using size_type = typename expression_type::size_type;
+
+  static constexpr bool is_minus =
+      std::is_same<F, std::minus<value_type> >::value;
+
+  const expression_type& expr;
+
+  explicit axpby_wrapper(const expression_type& expr,
+                         typename std::enable_if<
+                         is_axpby<expression_type>::value>::type* = 0)
+      : expr(expr) {}
+
+  inline size_type size() const { return expr.size(); }
+
+  inline value_type a() const { return scaled_dense<E1>::scalar(expr.e1); }
+
+  // The sign of the second term is folded into b.
+  inline value_type b() const {
+    value_type b = scaled_dense<E2>::scalar(expr.e2);
+    return is_minus ? -b : b;
+  }
+
+  inline const value_type* x() const {
+    return scaled_dense<E1>::data(expr.e1);
+  }
+
+  inline const value_type* y() const {
+    return scaled_dense<E2>::data(expr.e2);
+  }
+};
+
+template<typename E>
+inline
+axpby_wrapper<E>
+make_axpby_wrapper(const E& expr) {
+  return axpby_wrapper<E>(expr);
+}
+
+// Is a generic expression E one of s, a * s or s * a where s is a sparse
+// vector (see sparse_vector.h)? Adding, subtracting or assigning such an
+// expression to a dense vector only touches the nonzeros of s.
+
+template<typename E>
+struct is_scaled_sparse_vector : public is_sparse_vector<E>{};
+
+template<typename E, typename T>
+struct is_scaled_sparse_vector<binary_expression<E, T, std::multiplies<T> > >
+    : public is_sparse_vector<E>{};
+
+template<typename E, typename T>
+struct is_scaled_sparse_vector<binary_expression<T, E, std::multiplies<T> > >
+    : public is_sparse_vector<E>{};
+
+// helper for extracting the scalar and the sparse vector of a scaled sparse
+// vector.
+template<typename E> struct scaled_sparse;
+
+// s
+template<typename T>
+struct scaled_sparse<insight::sparse_vector<T> > {
+  using value_type = T;
+  using vector_type = insight::sparse_vector<T>;
+  static inline value_type scalar(const vector_type&) {
+    return value_type(1);
+  }
+  static inline const vector_type& vector(const vector_type& s) { return s; }
+};
+
+// s * a
+template<typename T>
+struct scaled_sparse<
+  binary_expression<insight::sparse_vector<T>, T, std::multiplies<T> > > {
+  using value_type = T;
+  using vector_type = insight::sparse_vector<T>;
+  using expression_type = binary_expression<vector_type, T,
+                                            std::multiplies<T> >;
+  static inline value_type scalar(const expression_type& e) {
+    return e.scalar;
+  }
+  static inline const vector_type& vector(const expression_type& e) {
+    return e.e;
+  }
+};
+
+// a * s
+template<typename T>
+struct scaled_sparse<
+  binary_expression<T, insight::sparse_vector<T>, std::multiplies<T> > > {
+  using value_type = T;
+  using vector_type = insight::sparse_vector<T>;
+  using expression_type = binary_expression<T, vector_type,
+                                            std::multiplies<T> >;
+  static inline value_type scalar(const expression_type& e) {
+    return e.scalar;
+  }
+  static inline const vector_type& vector(const expression_type& e) {
+    return e.e;
+  }
+};
 }  // namespace special_expression
 }  // namespace linalg_detail
 }  // namespace insight
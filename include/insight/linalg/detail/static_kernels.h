@@ -0,0 +1,118 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_STATIC_KERNELS_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_STATIC_KERNELS_H_
+
+#include <cstddef>
+
+#include "insight/linalg/detail/alias.h"
+#include "insight/linalg/detail/materialize.h"
+
+namespace insight {
+namespace linalg_detail {
+
+// Kernels of the fixed-size vectors and matrices (see static_vector.h and
+// static_matrix.h).
+//
+// Their loops are unrolled at compile time: static_for<First, Last> calls
+// f(First), ..., f(Last - 1) with every index a constant, splitting the
+// range in halves so that the template recursion is only log(N) deep.
+
+template<std::size_t First, std::size_t Last, typename Enable = void>
+struct static_for {
+  template<typename F>
+  static inline void apply(F& f) {
+    static_for<First, First + (Last - First) / 2>::apply(f);
+    static_for<First + (Last - First) / 2, Last>::apply(f);
+  }
+};
+
+template<std::size_t First, std::size_t Last>
+struct static_for<First, Last,
+                  typename std::enable_if<Last - First == 1>::type> {
+  template<typename F>
+  static inline void apply(F& f) { f(First); }
+};
+
+template<std::size_t First, std::size_t Last>
+struct static_for<First, Last,
+                  typename std::enable_if<Last == First>::type> {
+  template<typename F>
+  static inline void apply(F&) {}
+};
+
+// Applies op(buffer[i], x.eval(i)) for i < N.
+template<std::size_t N, typename X, typename T, typename Op>
+struct static_elementwise_ {
+  const X& x;
+  T* buffer;
+  Op op;
+
+  inline void operator()(std::size_t i) { op(buffer[i], x.eval(i)); }
+};
+
+// Applies op(buffer[i], e.eval(i)) to the N elements of e, assuming that e
+// does not read buffer other than elementwise.
+template<std::size_t N, typename E, typename Op>
+inline void static_evaluate_noalias(const E& e,
+                                    typename E::value_type* buffer, Op op) {
+  using X = typename materialized<E>::type;
+  using T = typename E::value_type;
+  materialized<E> m(e);
+  static_elementwise_<N, X, T, Op> f{m.get(), buffer, op};
+  static_for<0, N>::apply(f);
+}
+
+// Same as above, through a temporary (on the stack) if e reads buffer
+// other than elementwise (see alias.h).
+template<std::size_t N, typename E, typename Op>
+inline void static_evaluate(const E& e, typename E::value_type* buffer,
+                            Op op) {
+  using T = typename E::value_type;
+  if (requires_temporary(e, buffer, buffer + N)) {
+    T tmp[N];
+    static_evaluate_noalias<N>(e, tmp, [](T& x, T y) { x = y; });
+    for (std::size_t i = 0; i < N; ++i) {
+      op(buffer[i], tmp[i]);
+    }
+  } else {
+    static_evaluate_noalias<N>(e, buffer, op);
+  }
+}
+
+// Applies op(x[i]) for i < N.
+template<typename T, typename Op>
+struct static_inplace_ {
+  T* x;
+  Op op;
+
+  inline void operator()(std::size_t i) { op(x[i]); }
+};
+
+template<std::size_t N, typename T, typename Op>
+inline void static_apply(T* x, Op op) {
+  static_inplace_<T, Op> f{x, op};
+  static_for<0, N>::apply(f);
+}
+
+// Returns the sum of f(i) for i < N.
+template<typename T, typename F>
+struct static_sum_ {
+  F f;
+  T sum;
+
+  inline void operator()(std::size_t i) { sum += f(i); }
+};
+
+template<std::size_t N, typename T, typename F>
+inline T static_sum(F f) {
+  static_sum_<T, F> s{f, T()};
+  static_for<0, N>::apply(s);
+  return s.sum;
+}
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_STATIC_KERNELS_H_
@@ -0,0 +1,394 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_STRIDED_EVALUATOR_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_STRIDED_EVALUATOR_H_
+
+#include <cmath>
+#include <functional>
+#include <cstddef>
+#include <type_traits>
+
+#include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/materialize.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/temporary.h"
+#include "insight/linalg/detail/blas_routines.h"
+
+namespace insight {
+
+// These forward declarations should be here NOT inside the linalg_detail
+// namespace.
+template<typename T, typename A, std::size_t N> class vector;
+template<typename T, typename A, std::size_t N> class matrix;
+template<typename T> class vector_map;
+template<typename T> class matrix_map;
+
+namespace linalg_detail {
+
+template<typename E> struct row_view;
+template<typename E> struct col_view;
+
+// Strided vectors.
+//
+// A row or a column of a (row-major) dense matrix is not contiguous in
+// memory, but its elements are evenly spaced: a column of an m x n matrix
+// is every n-th element starting at its first one. Every level 1 BLAS
+// routine takes such an increment, so that copying, scaling, axpy, dot and
+// nrm2 on rows and columns go through BLAS just like dense vectors do.
+
+// Is E a vector whose elements are evenly spaced in memory, i.e a dense
+// vector, or a row or a column of a dense matrix?
+template<typename E> struct is_strided_vector : public std::false_type {};
+
+template<typename T, typename A, std::size_t N>
+struct is_strided_vector<insight::vector<T, A, N> > : public std::true_type {};
+
+template<typename T>
+struct is_strided_vector<temporary_vector<T> > : public std::true_type {};
+
+template<typename T, typename A, std::size_t N>
+struct is_strided_vector<row_view<insight::matrix<T, A, N> > >
+    : public std::true_type {};
+
+template<typename T, typename A, std::size_t N>
+struct is_strided_vector<col_view<insight::matrix<T, A, N> > >
+    : public std::true_type {};
+
+template<typename T>
+struct is_strided_vector<insight::vector_map<T> > : public std::true_type {};
+
+template<typename T>
+struct is_strided_vector<row_view<insight::matrix_map<T> > >
+    : public std::true_type {};
+
+template<typename T>
+struct is_strided_vector<col_view<insight::matrix_map<T> > >
+    : public std::true_type {};
+
+// Distance between two consecutive elements of the strided vector e.
+template<typename E>
+inline int stride_of(const E&) { return 1; }
+
+template<typename M>
+inline int stride_of(const col_view<M>& e) {
+  return static_cast<int>(e.stride());
+}
+
+// Is E of the form a * x or x * a where a is a scalar, and x is a strided
+// vector having the same element type as a?
+
+template<typename E>
+struct is_scaled_strided_vector : public std::false_type {};
+
+template<typename E, typename T>
+struct is_scaled_strided_vector<binary_expression<E, T, std::multiplies<T> > >
+    : public std::integral_constant<
+  bool,
+  is_strided_vector<E>::value &&
+  std::is_same<typename E::value_type, T>::value> {};
+
+template<typename T, typename E>
+struct is_scaled_strided_vector<binary_expression<T, E, std::multiplies<T> > >
+    : public std::integral_constant<
+  bool,
+  is_strided_vector<E>::value &&
+  std::is_same<typename E::value_type, T>::value> {};
+
+// Alias analysis for a strided destination (see alias.h).
+//
+// The destination of a strided evaluation, e.g. a column, spans (almost)
+// all of the underlying matrix, so that the other columns of that matrix
+// fall inside its range. They still never share an element with it: two
+// strided vectors with the same increment either coincide or are disjoint
+// unless their first elements are a multiple of that increment apart.
+template<typename E> struct strided_alias_analysis;
+
+template<typename E>
+inline bool strided_requires_temporary(const E& e,
+                                       const typename E::value_type* first,
+                                       int inc, std::size_t n) {
+  return strided_alias_analysis<E>::requires_temporary(e, first, inc, n);
+}
+
+// Reads the n elements first[0], first[inc], ..., and the m elements
+// x[0], x[incx], ...: do they share an element other than elementwise?
+template<typename T>
+inline bool strided_overlap(const T* first, int inc, std::size_t n,
+                            const T* x, int incx, std::size_t m) {
+  if (n == 0 || m == 0) return false;
+  const T* last = first + (n - 1) * inc + 1;
+  const T* x_last = x + (m - 1) * incx + 1;
+  if (x_last <= first || last <= x) return false;
+  if (inc == incx) {
+    return x != first && (x - first) % inc == 0;
+  }
+  return true;
+}
+
+template<typename E>
+struct strided_alias_analysis {
+  using value_type = typename E::value_type;
+
+  static inline bool requires_temporary(const E& e, const value_type* first,
+                                        int inc, std::size_t n) {
+    return requires_temporary_(
+        e, first, inc, n,
+        std::integral_constant<bool, is_strided_vector<E>::value>());
+  }
+
+ private:
+  static inline bool requires_temporary_(const E& e, const value_type* first,
+                                         int inc, std::size_t n,
+                                         std::true_type) {
+    return strided_overlap(first, inc, n, e.data(), stride_of(e), e.size());
+  }
+
+  // Any other (non elementwise) expression.
+  static inline bool requires_temporary_(const E& e, const value_type* first,
+                                         int inc, std::size_t n,
+                                         std::false_type) {
+    return n > 0 && e.aliases(first, first + (n - 1) * inc + 1);
+  }
+};
+
+template<typename E1, typename E2, typename F>
+struct strided_alias_analysis<binary_expression<E1, E2, F> > {
+  using expression_type = binary_expression<E1, E2, F>;
+  using value_type = typename expression_type::value_type;
+
+  static inline bool requires_temporary(const expression_type& e,
+                                        const value_type* first, int inc,
+                                        std::size_t n) {
+    return requires_temporary_(
+        e, first, inc, n,
+        std::integral_constant<int, is_scalar<E1>::value ? 1 :
+                               is_scalar<E2>::value ? 2 : 0>());
+  }
+
+ private:
+  // expression-expression.
+  static inline bool requires_temporary_(const expression_type& e,
+                                         const value_type* first, int inc,
+                                         std::size_t n,
+                                         std::integral_constant<int, 0>) {
+    return strided_requires_temporary(e.e1, first, inc, n) ||
+        strided_requires_temporary(e.e2, first, inc, n);
+  }
+
+  // scalar-expression or expression-scalar.
+  template<int N>
+  static inline bool requires_temporary_(const expression_type& e,
+                                         const value_type* first, int inc,
+                                         std::size_t n,
+                                         std::integral_constant<int, N>) {
+    return strided_requires_temporary(e.e, first, inc, n);
+  }
+};
+
+template<typename E, typename F>
+struct strided_alias_analysis<unary_expression<E, F> > {
+  using expression_type = unary_expression<E, F>;
+  using value_type = typename expression_type::value_type;
+
+  static inline bool requires_temporary(const expression_type& e,
+                                        const value_type* first, int inc,
+                                        std::size_t n) {
+    return strided_requires_temporary(e.e, first, inc, n);
+  }
+};
+
+// Evaluates a generic vector expression into a strided destination:
+// buffer[i * inc] (op)= e[i]. Strided vectors, and scalar multiples of them,
+// are evaluated with a single copy, scal or axpy; everything else in a
+// single pass through eval(i).
+template<typename E>
+struct strided_evaluator {
+  using value_type = typename E::value_type;
+  using size_type = typename E::size_type;
+  const E& e;
+
+  explicit strided_evaluator(const E& e) : e(e) {}
+
+  inline void assign(value_type* buffer, int inc) const {
+    if (strided_requires_temporary(e, buffer, inc, e.size())) {
+      through_temporary_(buffer, inc, &temporary_evaluator::assign_noalias);
+    } else {
+      assign_noalias(buffer, inc);
+    }
+  }
+
+  inline void add(value_type* buffer, int inc) const {
+    if (strided_requires_temporary(e, buffer, inc, e.size())) {
+      through_temporary_(buffer, inc, &temporary_evaluator::add_noalias);
+    } else {
+      add_noalias(buffer, inc);
+    }
+  }
+
+  inline void sub(value_type* buffer, int inc) const {
+    if (strided_requires_temporary(e, buffer, inc, e.size())) {
+      through_temporary_(buffer, inc, &temporary_evaluator::sub_noalias);
+    } else {
+      sub_noalias(buffer, inc);
+    }
+  }
+
+  inline void mul(value_type* buffer, int inc) const {
+    if (strided_requires_temporary(e, buffer, inc, e.size())) {
+      through_temporary_(buffer, inc, &temporary_evaluator::mul_noalias);
+    } else {
+      mul_noalias(buffer, inc);
+    }
+  }
+
+  inline void div(value_type* buffer, int inc) const {
+    if (strided_requires_temporary(e, buffer, inc, e.size())) {
+      through_temporary_(buffer, inc, &temporary_evaluator::div_noalias);
+    } else {
+      div_noalias(buffer, inc);
+    }
+  }
+
+  inline void assign_noalias(value_type* buffer, int inc) const {
+    assign_(buffer, inc, kind_());
+  }
+
+  inline void add_noalias(value_type* buffer, int inc) const {
+    update_(buffer, inc, value_type(1), kind_());
+  }
+
+  inline void sub_noalias(value_type* buffer, int inc) const {
+    update_(buffer, inc, value_type(-1), kind_());
+  }
+
+  inline void mul_noalias(value_type* buffer, int inc) const {
+    evaluate_(buffer, inc, [](value_type& x, value_type y) { x *= y; });
+  }
+
+  inline void div_noalias(value_type* buffer, int inc) const {
+    evaluate_(buffer, inc, [](value_type& x, value_type y) { x /= y; });
+  }
+
+ private:
+  using temporary_evaluator = strided_evaluator<temporary_vector<value_type> >;
+
+  // 1: a strided vector, 2: a scalar multiple of a strided vector, 0:
+  // anything else (or no BLAS routine for value_type).
+  using kind_ = std::integral_constant<
+    int,
+    !std::is_floating_point<value_type>::value ? 0 :
+    is_strided_vector<E>::value ? 1 :
+    is_scaled_strided_vector<E>::value ? 2 : 0>;
+
+  template<typename Op>
+  inline void through_temporary_(value_type* buffer, int inc, Op op) const {
+    temporary_vector<value_type> tmp(e.size());
+    expression_evaluator<E>(e).assign_noalias(tmp.buffer());
+    (temporary_evaluator(tmp).*op)(buffer, inc);
+  }
+
+  template<typename Op>
+  inline void evaluate_(value_type* buffer, int inc, Op op) const {
+    materialized<E> m(e);
+    const auto& me = m.get();
+    const size_type n = me.size();
+    for (size_type i = 0; i < n; ++i) {
+      op(buffer[i * inc], me.eval(i));
+    }
+  }
+
+  inline void assign_(value_type* buffer, int inc,
+                      std::integral_constant<int, 0>) const {
+    evaluate_(buffer, inc, [](value_type& x, value_type y) { x = y; });
+  }
+
+  inline void assign_(value_type* buffer, int inc,
+                      std::integral_constant<int, 1>) const {
+    blas_copy(e.size(), e.data(), stride_of(e), buffer, inc);
+  }
+
+  inline void assign_(value_type* buffer, int inc,
+                      std::integral_constant<int, 2>) const {
+    blas_copy(e.size(), e.e.data(), stride_of(e.e), buffer, inc);
+    blas_scal(e.size(), e.scalar, buffer, inc);
+  }
+
+  // buffer += sign * e.
+  inline void update_(value_type* buffer, int inc, value_type sign,
+                      std::integral_constant<int, 0>) const {
+    evaluate_(buffer, inc, [sign](value_type& x, value_type y) {
+        x += sign * y;
+      });
+  }
+
+  inline void update_(value_type* buffer, int inc, value_type sign,
+                      std::integral_constant<int, 1>) const {
+    blas_axpy(e.size(), sign, e.data(), stride_of(e), buffer, inc);
+  }
+
+  inline void update_(value_type* buffer, int inc, value_type sign,
+                      std::integral_constant<int, 2>) const {
+    blas_axpy(e.size(), sign * e.scalar, e.e.data(), stride_of(e.e), buffer,
+              inc);
+  }
+};
+
+// Returns the dot product of the vectors x and y, with a single (strided)
+// BLAS dot whenever both of them are strided vectors.
+template<typename E1, typename E2>
+inline
+typename std::enable_if<
+  std::is_floating_point<typename E1::value_type>::value &&
+  is_strided_vector<E1>::value && is_strided_vector<E2>::value,
+  typename E1::value_type>::type
+strided_dot(const E1& x, const E2& y) {
+  return blas_dot(x.size(), x.data(), stride_of(x), y.data(), stride_of(y));
+}
+
+template<typename E1, typename E2>
+inline
+typename std::enable_if<
+  !(std::is_floating_point<typename E1::value_type>::value &&
+    is_strided_vector<E1>::value && is_strided_vector<E2>::value),
+  typename E1::value_type>::type
+strided_dot(const E1& x, const E2& y) {
+  using value_type = typename E1::value_type;
+  using size_type = typename E1::size_type;
+  materialized<E1> mx(x);
+  materialized<E2> my(y);
+  const auto& ex = mx.get();
+  const auto& ey = my.get();
+  const size_type n = ex.size();
+  value_type result = value_type();
+  for (size_type i = 0; i < n; ++i) {
+    result += ex.eval(i) * ey.eval(i);
+  }
+  return result;
+}
+
+// Returns the L2-norm of the vector x.
+template<typename E>
+inline
+typename std::enable_if<
+  std::is_floating_point<typename E::value_type>::value &&
+  is_strided_vector<E>::value,
+  typename E::value_type>::type
+strided_nrm2(const E& x) {
+  return blas_nrm2(x.size(), x.data(), stride_of(x));
+}
+
+template<typename E>
+inline
+typename std::enable_if<
+  !(std::is_floating_point<typename E::value_type>::value &&
+    is_strided_vector<E>::value),
+  typename E::value_type>::type
+strided_nrm2(const E& x) {
+  return std::sqrt(strided_dot(x, x));
+}
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_STRIDED_EVALUATOR_H_
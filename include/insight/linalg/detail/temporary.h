@@ -0,0 +1,116 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_TEMPORARY_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_TEMPORARY_H_
+
+#include <cstddef>
+#include <utility>
+
+#include "insight/linalg/detail/scratch_buffer.h"
+
+namespace insight {
+namespace linalg_detail {
+
+template<typename Derived> struct vector_expression;
+template<typename Derived> struct matrix_expression;
+template<typename E> struct transpose_expression;
+
+// Dense vector/matrix temporaries, holding the value of a subexpression
+// in a scratch buffer (see materialize.h). They behave as read-only dense
+// vectors/matrices, so that the special (BLAS backed) expressions apply to
+// them as well.
+
+template<typename T>
+class temporary_vector : public vector_expression<temporary_vector<T> > {
+ private:
+  using self = temporary_vector<T>;
+
+ public:
+  using value_type = T;
+  using reference = const T&;
+  using size_type = std::size_t;
+  using shape_type = std::pair<size_type, size_type>;  // NOLINT
+  using iterator = const T*;
+  using const_iterator = const T*;
+
+  explicit temporary_vector(size_type n) : buffer_(n), size_(n) {}
+
+  inline size_type row_count() const { return size_; }
+  inline size_type col_count() const { return size_ > 0 ? 1 : 0; }
+  inline size_type size() const { return size_; }
+  inline shape_type shape() const {
+    return shape_type(row_count(), col_count());
+  }
+
+  // The buffer to evaluate the subexpression into.
+  inline T* buffer() { return buffer_.data(); }
+
+  inline const T* data() const { return buffer_.data(); }
+  inline value_type eval(size_type i) const { return buffer_.data()[i]; }
+  inline bool aliases(const T* first, const T* last) const {
+    return data() < last && first < data() + size_;
+  }
+
+  inline transpose_expression<self> t() const {
+    return transpose_expression<self>(*this);
+  }
+
+  inline const_iterator begin() const { return data(); }
+  inline const_iterator cbegin() const { return data(); }
+  inline const_iterator end() const { return data() + size_; }
+  inline const_iterator cend() const { return data() + size_; }
+
+ private:
+  scratch_buffer<T> buffer_;
+  size_type size_;
+};
+
+template<typename T>
+class temporary_matrix : public matrix_expression<temporary_matrix<T> > {
+ private:
+  using self = temporary_matrix<T>;
+
+ public:
+  using value_type = T;
+  using reference = const T&;
+  using size_type = std::size_t;
+  using shape_type = std::pair<size_type, size_type>;  // NOLINT
+  using iterator = const T*;
+  using const_iterator = const T*;
+
+  explicit temporary_matrix(shape_type shape)
+      : buffer_(shape.first * shape.second), shape_(shape) {}
+
+  inline size_type row_count() const { return shape_.first; }
+  inline size_type col_count() const { return shape_.second; }
+  inline size_type size() const { return shape_.first * shape_.second; }
+  inline shape_type shape() const { return shape_; }
+
+  // The buffer to evaluate the subexpression into.
+  inline T* buffer() { return buffer_.data(); }
+
+  inline const T* data() const { return buffer_.data(); }
+  inline value_type eval(size_type i) const { return buffer_.data()[i]; }
+  inline bool aliases(const T* first, const T* last) const {
+    return data() < last && first < data() + size();
+  }
+
+  inline transpose_expression<self> t() const {
+    return transpose_expression<self>(*this);
+  }
+
+  inline const_iterator begin() const { return data(); }
+  inline const_iterator cbegin() const { return data(); }
+  inline const_iterator end() const { return data() + size(); }
+  inline const_iterator cend() const { return data() + size(); }
+
+ private:
+  scratch_buffer<T> buffer_;
+  shape_type shape_;
+};
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_TEMPORARY_H_
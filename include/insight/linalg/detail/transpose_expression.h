@@ -307,6 +307,19 @@ class transpose_expression
     return shape_type(row_count(), col_count());
   }
 
+  // Evaluates the element at the given (row-major) linear index i, that is
+  // the element (i / e.row_count(), i % e.row_count()) of this transpose, or
+  // equivalently the element (i % e.row_count(), i / e.row_count()) of e.
+  inline value_type eval(size_type i) const {
+    return eval_(i, std::integral_constant<bool,
+                 std::is_base_of<vector_expression<E>, E>::value>());
+  }
+
+  // Does this expression read any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return e.aliases(first, last);
+  }
+
   inline row_view<self> row_at(size_type row_index) {
     return row_view<self>(this, row_index);
   }
@@ -351,6 +364,16 @@ class transpose_expression
   }
 
  private:
+  // Transposing a vector does not change its memory layout.
+  inline value_type eval_(size_type i, std::true_type) const {
+    return e.eval(i);
+  }
+
+  inline value_type eval_(size_type i, std::false_type) const {
+    const size_type n = e.row_count();
+    return e.eval((i % n) * e.col_count() + i / n);
+  }
+
   inline iterator begin_(std::true_type) {
     return e.begin();
   }
@@ -424,6 +447,12 @@ class transpose_expression<row_view<E> >
     return shape_type(row_count(), col_count());
   }
 
+  inline value_type eval(size_type i) const { return e.eval(i); }
+
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return e.aliases(first, last);
+  }
+
   inline row_view<self> row_at(size_type row_index) {
     return row_view<self>(this, row_index);
   }
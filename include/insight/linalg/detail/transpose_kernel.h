@@ -0,0 +1,128 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_TRANSPOSE_KERNEL_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_TRANSPOSE_KERNEL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace insight {
+namespace linalg_detail {
+
+// Transposition kernels.
+//
+// A naive transpose reads (or writes) a whole row apart for every element,
+// so that on large matrices each access is a cache (and, past a few
+// thousand columns, a TLB) miss. These kernels instead recursively split
+// the matrix along its longest dimension until the pieces are small tiles,
+// which are then transposed with both the source and the destination tile
+// resident in L1. The recursion makes them cache oblivious: every level of
+// the memory hierarchy sees blocks that fit it.
+
+// Side of the leaf tiles: a 32 x 32 tile of doubles is 8KB.
+constexpr std::size_t transpose_tile_size = 32;
+
+template<typename Source, typename T, typename Op>
+void transpose_tiles_(std::size_t row_first, std::size_t row_last,
+                      std::size_t col_first, std::size_t col_last,
+                      std::size_t row_count, std::size_t col_count,
+                      const Source& a, T* b, Op op) {
+  const std::size_t rows = row_last - row_first;
+  const std::size_t cols = col_last - col_first;
+  if (rows <= transpose_tile_size && cols <= transpose_tile_size) {
+    for (std::size_t i = row_first; i < row_last; ++i) {
+      for (std::size_t j = col_first; j < col_last; ++j) {
+        op(b[j * row_count + i], a(i * col_count + j));
+      }
+    }
+  } else if (rows >= cols) {
+    const std::size_t mid = row_first + rows / 2;
+    transpose_tiles_(row_first, mid, col_first, col_last, row_count,
+                     col_count, a, b, op);
+    transpose_tiles_(mid, row_last, col_first, col_last, row_count,
+                     col_count, a, b, op);
+  } else {
+    const std::size_t mid = col_first + cols / 2;
+    transpose_tiles_(row_first, row_last, col_first, mid, row_count,
+                     col_count, a, b, op);
+    transpose_tiles_(row_first, row_last, mid, col_last, row_count,
+                     col_count, a, b, op);
+  }
+}
+
+// For every element (i, j) of a row_count x col_count (row-major) source,
+// applies op(b[j * row_count + i], a(i * col_count + j)), where a(k)
+// returns the source element at the linear index k. With op an assignment,
+// b is the transpose of the source.
+template<typename Source, typename T, typename Op>
+inline void transpose(std::size_t row_count, std::size_t col_count,
+                      const Source& a, T* b, Op op) {
+  transpose_tiles_(0, row_count, 0, col_count, row_count, col_count, a, b,
+                   op);
+}
+
+// Transposes the n x n matrix a in place, swapping the tiles above the
+// diagonal with the ones below it.
+template<typename T>
+void transpose_inplace_square(std::size_t n, T* a) {
+  using std::swap;
+  const std::size_t tile = transpose_tile_size;
+  for (std::size_t i0 = 0; i0 < n; i0 += tile) {
+    const std::size_t i1 = std::min(i0 + tile, n);
+    // Diagonal tile.
+    for (std::size_t i = i0; i < i1; ++i) {
+      for (std::size_t j = i + 1; j < i1; ++j) {
+        swap(a[i * n + j], a[j * n + i]);
+      }
+    }
+    // Off diagonal tiles.
+    for (std::size_t j0 = i1; j0 < n; j0 += tile) {
+      const std::size_t j1 = std::min(j0 + tile, n);
+      for (std::size_t i = i0; i < i1; ++i) {
+        for (std::size_t j = j0; j < j1; ++j) {
+          swap(a[i * n + j], a[j * n + i]);
+        }
+      }
+    }
+  }
+}
+
+// Transposes the row_count x col_count (row-major) matrix a in place.
+//
+// Square matrices are transposed tile by tile. Otherwise, the element at
+// the linear index k = i * col_count + j moves to j * row_count + i, and the
+// permutation is applied by following its cycles, which only needs one bit
+// of extra storage per element.
+template<typename T>
+void transpose_inplace(std::size_t row_count, std::size_t col_count, T* a) {
+  if (row_count == col_count) {
+    transpose_inplace_square(row_count, a);
+    return;
+  }
+
+  const std::size_t n = row_count * col_count;
+  if (row_count <= 1 || col_count <= 1) return;
+
+  using std::swap;
+  std::vector<bool> visited(n, false);
+  // The first and the last elements never move.
+  for (std::size_t start = 1; start < n - 1; ++start) {
+    if (visited[start]) continue;
+    T value = a[start];
+    std::size_t k = start;
+    do {
+      const std::size_t next = (k % col_count) * row_count + k / col_count;
+      swap(value, a[next]);
+      visited[next] = true;
+      k = next;
+    } while (k != start);
+  }
+}
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_TRANSPOSE_KERNEL_H_
@@ -0,0 +1,118 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_DETAIL_TRIANGULAR_LAYOUT_H_
+#define INCLUDE_INSIGHT_LINALG_DETAIL_TRIANGULAR_LAYOUT_H_
+
+#include <cstddef>
+#include <type_traits>
+
+namespace insight {
+
+// Which triangle of a symmetric or a triangular matrix is stored (see
+// symmetric_matrix.h and triangular_matrix.h).
+enum triangle {
+  lower,
+  upper
+};
+
+// How that triangle is stored: either in a full, row-major n x n array whose
+// other triangle is never read, or packed row by row into n * (n + 1) / 2
+// contiguous elements.
+enum storage {
+  full,
+  packed
+};
+
+// Forward declarations.
+template<typename T, triangle Uplo, storage S, typename Alloc>
+class symmetric_matrix;
+template<typename T, triangle Uplo, storage S, typename Alloc>
+class triangular_matrix;
+
+namespace linalg_detail {
+
+template<typename E> struct transpose_expression;
+
+// Position of the element (i, j) of the triangle Uplo of an n x n matrix in
+// its storage S. Packed triangles are laid out as the packed operands of
+// BLAS (see blas_spmv in blas_routines.h), so that they can be handed to
+// spmv/tpmv as is.
+template<triangle Uplo, storage S>
+struct triangular_layout;
+
+template<triangle Uplo>
+struct triangular_layout<Uplo, full> {
+  static inline std::size_t stored_size(std::size_t n) { return n * n; }
+  static inline std::size_t index(std::size_t n, std::size_t i,
+                                  std::size_t j) {
+    return i * n + j;
+  }
+};
+
+template<>
+struct triangular_layout<lower, packed> {
+  static inline std::size_t stored_size(std::size_t n) {
+    return n * (n + 1) / 2;
+  }
+  static inline std::size_t index(std::size_t, std::size_t i,
+                                  std::size_t j) {
+    return i * (i + 1) / 2 + j;
+  }
+};
+
+template<>
+struct triangular_layout<upper, packed> {
+  static inline std::size_t stored_size(std::size_t n) {
+    return n * (n + 1) / 2;
+  }
+  static inline std::size_t index(std::size_t n, std::size_t i,
+                                  std::size_t j) {
+    return i * (2 * n - i + 1) / 2 + (j - i);
+  }
+};
+
+// Does the triangle Uplo contain the element (i, j)?
+template<triangle Uplo>
+inline bool in_triangle(std::size_t i, std::size_t j) {
+  return (Uplo == lower) ? j <= i : i <= j;
+}
+
+// Is E a symmetric matrix? Since a symmetric matrix is its own transpose,
+// S.t() is S itself.
+
+template<typename E> struct is_symmetric_matrix : public std::false_type {};
+
+template<typename T, triangle Uplo, storage S, typename Alloc>
+struct is_symmetric_matrix<insight::symmetric_matrix<T, Uplo, S, Alloc> >
+    : public std::true_type {};
+
+// Is E a triangular matrix, or the transpose of one?
+
+template<typename E> struct is_triangular_matrix : public std::false_type {};
+
+template<typename T, triangle Uplo, storage S, typename Alloc>
+struct is_triangular_matrix<insight::triangular_matrix<T, Uplo, S, Alloc> >
+    : public std::true_type {};
+
+template<typename E>
+struct is_transpose_of_triangular_matrix : public std::false_type {};
+
+template<typename E>
+struct is_transpose_of_triangular_matrix<transpose_expression<E> >
+    : public is_triangular_matrix<E> {};
+
+// Can symv/spmv or trmv/tpmv read the matrix E directly, as the matrix
+// operand of a matrix-vector product?
+template<typename E>
+struct is_structured_matrix
+    : public std::integral_constant<bool,
+                                    is_symmetric_matrix<E>::value ||
+                                    is_triangular_matrix<E>::value ||
+                                    is_transpose_of_triangular_matrix<
+                                      E>::value> {};
+
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_DETAIL_TRIANGULAR_LAYOUT_H_
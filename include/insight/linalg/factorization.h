@@ -0,0 +1,256 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_FACTORIZATION_H_
+#define INCLUDE_INSIGHT_LINALG_FACTORIZATION_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "insight/linalg/matrix.h"
+#include "insight/linalg/vector.h"
+#include "insight/linalg/detail/lapack_routines.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// Dense factorizations of float or double matrices:
+//
+//   cholesky<double> llt(H);      // H = L * L^T, H symmetric positive
+//                                 // definite (e.g. a Hessian).
+//   vector<double> step = llt.solve(g);
+//
+//   lu<double> plu(A);            // P * A = L * U, A square.
+//   matrix<double> X = plu.solve(B);
+//
+//   qr<double> f(A);              // A = Q * R, A M x N with M >= N.
+//   vector<double> x = f.solve(b);  // min ||A * x - b||.
+//
+// A factorization is computed once, by the constructor, and can then solve
+// for any number of right hand sides, given as a vector or as the columns
+// of a matrix. It goes through LAPACKE when the BLAS backend provides it,
+// and through blocked BLAS-3 implementations otherwise (see
+// linalg_detail/lapack_routines.h).
+//
+// Whether a factorization can be used is told by info(), which follows the
+// LAPACK convention: 0 on success, k > 0 if the matrix is not positive
+// definite (cholesky) or singular (lu). Solving with a failed factorization
+// is an error.
+
+// Cholesky factorization A = L * L^T of a symmetric positive definite
+// matrix. Only the lower triangle of A is read.
+template<typename T>
+class cholesky {
+  static_assert(linalg_detail::is_lapack_scalar<T>::value,
+                "cholesky: only float and double matrices can be factored");
+
+ public:
+  using value_type = T;
+  using size_type = typename matrix<T>::size_type;
+
+  explicit cholesky(const matrix<T>& A) : factors_(A) {
+    CHECK_EQ(A.row_count(), A.col_count())
+        << "cholesky: the matrix is not square";
+    info_ = linalg_detail::lapack_potrf(order(), factors_.data(), order());
+  }
+
+  inline int info() const { return info_; }
+  inline int order() const { return static_cast<int>(factors_.row_count()); }
+
+  // The lower triangular factor L.
+  matrix<T> l() const {
+    matrix<T> result(factors_);
+    for (size_type i = 0; i < result.row_count(); ++i) {
+      std::fill(result.data() + i * result.col_count() + i + 1,
+                result.data() + (i + 1) * result.col_count(), T(0));
+    }
+    return result;
+  }
+
+  // A^-1 * b.
+  vector<T> solve(const vector<T>& b) const {
+    CHECK_EQ(b.size(), factors_.row_count())
+        << "cholesky: mismatched dimensions";
+    vector<T> x(b);
+    solve_(1, x.data());
+    return x;
+  }
+
+  // A^-1 * B.
+  matrix<T> solve(const matrix<T>& B) const {
+    CHECK_EQ(B.row_count(), factors_.row_count())
+        << "cholesky: mismatched dimensions";
+    matrix<T> X(B);
+    solve_(static_cast<int>(X.col_count()), X.data());
+    return X;
+  }
+
+ private:
+  void solve_(const int nrhs, T* B) const {
+    CHECK_EQ(info_, 0) << "cholesky: the matrix is not positive definite";
+    linalg_detail::lapack_potrs(order(), nrhs, factors_.data(), order(), B,
+                                nrhs);
+  }
+
+  matrix<T> factors_;
+  int info_;
+};
+
+// LU factorization P * A = L * U of a square matrix, with partial pivoting.
+template<typename T>
+class lu {
+  static_assert(linalg_detail::is_lapack_scalar<T>::value,
+                "lu: only float and double matrices can be factored");
+
+ public:
+  using value_type = T;
+  using size_type = typename matrix<T>::size_type;
+
+  explicit lu(const matrix<T>& A) : factors_(A), pivots_(A.row_count()) {
+    CHECK_EQ(A.row_count(), A.col_count()) << "lu: the matrix is not square";
+    info_ = linalg_detail::lapack_getrf(order(), order(), factors_.data(),
+                                        order(), pivots_.data());
+  }
+
+  inline int info() const { return info_; }
+  inline int order() const { return static_cast<int>(factors_.row_count()); }
+
+  // The determinant of A.
+  T determinant() const {
+    T result(1);
+    for (int i = 0; i < order(); ++i) {
+      result *= factors_(i, i);
+      if (pivots_[i] != i + 1) result = -result;
+    }
+    return result;
+  }
+
+  // A^-1 * b.
+  vector<T> solve(const vector<T>& b) const {
+    CHECK_EQ(b.size(), factors_.row_count()) << "lu: mismatched dimensions";
+    vector<T> x(b);
+    solve_(1, x.data());
+    return x;
+  }
+
+  // A^-1 * B.
+  matrix<T> solve(const matrix<T>& B) const {
+    CHECK_EQ(B.row_count(), factors_.row_count())
+        << "lu: mismatched dimensions";
+    matrix<T> X(B);
+    solve_(static_cast<int>(X.col_count()), X.data());
+    return X;
+  }
+
+ private:
+  void solve_(const int nrhs, T* B) const {
+    CHECK_EQ(info_, 0) << "lu: the matrix is singular";
+    linalg_detail::lapack_getrs(order(), nrhs, factors_.data(), order(),
+                                pivots_.data(), B, nrhs);
+  }
+
+  matrix<T> factors_;
+  std::vector<int> pivots_;
+  int info_;
+};
+
+// QR factorization A = Q * R of an M x N matrix, with Householder
+// reflections. With M >= N, solve returns the least squares solution of
+// A * x = b, which is exact when A is square.
+template<typename T>
+class qr {
+  static_assert(linalg_detail::is_lapack_scalar<T>::value,
+                "qr: only float and double matrices can be factored");
+
+ public:
+  using value_type = T;
+  using size_type = typename matrix<T>::size_type;
+
+  explicit qr(const matrix<T>& A)
+      : factors_(A), tau_(std::min(A.row_count(), A.col_count())) {
+    linalg_detail::lapack_geqrf(rows_(), cols_(), factors_.data(), cols_(),
+                                tau_.data());
+  }
+
+  inline size_type row_count() const { return factors_.row_count(); }
+  inline size_type col_count() const { return factors_.col_count(); }
+
+  // The min(M, N) x N upper triangular (trapezoidal if M < N) factor R.
+  matrix<T> r() const {
+    const size_type k = tau_.size();
+    matrix<T> result(k, col_count(), T(0));
+    for (size_type i = 0; i < k; ++i) {
+      std::copy(factors_.data() + i * col_count() + i,
+                factors_.data() + (i + 1) * col_count(),
+                result.data() + i * col_count() + i);
+    }
+    return result;
+  }
+
+  // The M x min(M, N) factor Q, with orthonormal columns.
+  matrix<T> q() const {
+    const size_type k = tau_.size();
+    matrix<T> result(row_count(), k, T(0));
+    for (size_type i = 0; i < k; ++i) result(i, i) = T(1);
+    apply_q_(CblasNoTrans, static_cast<int>(k), result.data());
+    return result;
+  }
+
+  // Q^T * b, where b has M elements.
+  vector<T> apply_qt(const vector<T>& b) const {
+    CHECK_EQ(b.size(), row_count()) << "qr: mismatched dimensions";
+    vector<T> result(b);
+    apply_q_(CblasTrans, 1, result.data());
+    return result;
+  }
+
+  // The x minimizing ||A * x - b||.
+  vector<T> solve(const vector<T>& b) const {
+    CHECK_EQ(b.size(), row_count()) << "qr: mismatched dimensions";
+    vector<T> y(b);
+    solve_(1, y.data());
+    return vector<T>(y.begin(), y.begin() + col_count());
+  }
+
+  // The X minimizing the Frobenius norm of A * X - B.
+  matrix<T> solve(const matrix<T>& B) const {
+    CHECK_EQ(B.row_count(), row_count()) << "qr: mismatched dimensions";
+    matrix<T> Y(B);
+    solve_(static_cast<int>(Y.col_count()), Y.data());
+    matrix<T> X(col_count(), B.col_count());
+    std::copy(Y.data(), Y.data() + X.size(), X.data());
+    return X;
+  }
+
+ private:
+  inline int rows_() const { return static_cast<int>(row_count()); }
+  inline int cols_() const { return static_cast<int>(col_count()); }
+
+  void apply_q_(const CBLAS_TRANSPOSE trans, const int nrhs, T* B) const {
+    linalg_detail::lapack_ormqr(trans, rows_(), nrhs,
+                                static_cast<int>(tau_.size()),
+                                factors_.data(), cols_(), tau_.data(), B,
+                                nrhs);
+  }
+
+  // B <- Q^T * B, then its first N rows <- R^-1 * its first N rows.
+  void solve_(const int nrhs, T* B) const {
+    CHECK_GE(row_count(), col_count())
+        << "qr: solve needs at least as many rows as columns";
+    for (size_type i = 0; i < col_count(); ++i) {
+      CHECK_NE(factors_(i, i), T(0)) << "qr: the matrix is rank deficient";
+    }
+    apply_q_(CblasTrans, nrhs, B);
+    linalg_detail::lapack_trtrs(CblasUpper, cols_(), nrhs, factors_.data(),
+                                cols_(), B, nrhs);
+  }
+
+  matrix<T> factors_;
+  std::vector<T> tau_;
+};
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_FACTORIZATION_H_
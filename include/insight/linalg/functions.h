@@ -6,8 +6,14 @@
 #define INCLUDE_INSIGHT_LINALG_FUNCTIONS_H_
 
 #include <cmath>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
 
+#include "insight/linalg/vector.h"
+#include "insight/linalg/detail/diagonal_expression.h"
 #include "insight/linalg/detail/functors.h"
+#include "insight/linalg/detail/reduction.h"
 #include "glog/logging.h"
 
 namespace insight {
@@ -96,15 +102,397 @@ matmul(const linalg_detail::matrix_expression<M>& me,
   return linalg_detail::matmul_expression<M, V, void>(me.self(), ve.self());
 }
 
-// // generic matrix-matrix multiplication.
-// template<typename M1, typename M2>
-// inline
-// matmul_expression<M1, M2, void>
-// matmul(const linalg_detail::matrix_expression<M1>& m1, const linalg_detail::matrix_expression<M2>& m2) {
-//   CHECK_EQ(m1.self().num_cols(), m2.self().num_rows())
-//       << "mismatched dimensions for matrix-matrix multiplication";
-//   return matmul_expression<M1, M2, void>(m1.self(), m2.self());
-// }
+// generic matrix-matrix multiplication.
+template<typename M1, typename M2>
+inline
+linalg_detail::matmul_expression<M1, M2, void>
+matmul(const linalg_detail::matrix_expression<M1>& m1,
+       const linalg_detail::matrix_expression<M2>& m2) {
+  return linalg_detail::matmul_expression<M1, M2, void>(m1.self(), m2.self());
+}
+
+// outer product of two vectors, e.g. A += matmul(x, y.t()), which is
+// evaluated with ger. Likewise, matmul(X.t(), X) and matmul(X, X.t()) are
+// evaluated with syrk, at half the cost of gemm.
+template<typename V1, typename V2>
+inline
+linalg_detail::matmul_expression<V1, linalg_detail::transpose_expression<V2>,
+                                 void>
+matmul(const linalg_detail::vector_expression<V1>& u,
+       const linalg_detail::transpose_expression<V2>& vt) {
+  return linalg_detail::matmul_expression<
+    V1,
+    linalg_detail::transpose_expression<V2>,
+    void>(u.self(), vt);
+}
+
+// Diagonal matrices.
+//
+// diag(v) is the diagonal matrix whose diagonal is the vector expression v,
+// which is never stored. Multiplying by it scales rows or columns:
+// matmul(diag(w), X) scales the i-th row of X by w[i], and
+// matmul(X, diag(s)) its j-th column by s[j], lazily and with no n x n
+// matrix ever allocated (see linalg_detail/diagonal_expression.h). E.g. the
+// weighted Gram matrix of weighted least squares
+//
+//   matrix<double> H = matmul(X.t(), matmul(diag(w), X));
+//
+// is a single pass over X followed by syrk.
+
+template<typename V>
+inline linalg_detail::diagonal_expression<V>
+diag(const linalg_detail::vector_expression<V>& v) {
+  return linalg_detail::diagonal_expression<V>(v.self());
+}
+
+// diag(w) * X, i.e. w * X.
+template<typename V, typename M>
+inline
+typename std::enable_if<
+  std::is_same<typename V::value_type, typename M::value_type>::value &&
+  !linalg_detail::is_row_vector<M>::value,
+  linalg_detail::broadcast_expression<
+    V, M, std::multiplies<typename V::value_type> > >::type
+matmul(const linalg_detail::diagonal_expression<V>& d,
+       const linalg_detail::matrix_expression<M>& m) {
+  CHECK_EQ(d.col_count(), m.self().row_count())
+      << "matmul: mismatched dimensions";
+  return linalg_detail::broadcast_expression<
+    V, M, std::multiplies<typename V::value_type> >(
+        d.v, m.self(), std::multiplies<typename V::value_type>());
+}
+
+// X * diag(s), i.e. X * s.t().
+template<typename M, typename V>
+inline
+typename std::enable_if<
+  std::is_same<typename M::value_type, typename V::value_type>::value &&
+  !linalg_detail::is_row_vector<M>::value,
+  linalg_detail::broadcast_expression<
+    M, linalg_detail::transpose_expression<V>,
+    std::multiplies<typename V::value_type> > >::type
+matmul(const linalg_detail::matrix_expression<M>& m,
+       const linalg_detail::diagonal_expression<V>& d) {
+  CHECK_EQ(m.self().col_count(), d.row_count())
+      << "matmul: mismatched dimensions";
+  return linalg_detail::broadcast_expression<
+    M, linalg_detail::transpose_expression<V>,
+    std::multiplies<typename V::value_type> >(
+        m.self(), d.vt, std::multiplies<typename V::value_type>());
+}
+
+// diag(a) * diag(b), i.e. a * diag(b).
+template<typename V1, typename V2>
+inline
+typename std::enable_if<
+  std::is_same<typename V1::value_type, typename V2::value_type>::value,
+  linalg_detail::broadcast_expression<
+    V1, linalg_detail::diagonal_expression<V2>,
+    std::multiplies<typename V1::value_type> > >::type
+matmul(const linalg_detail::diagonal_expression<V1>& a,
+       const linalg_detail::diagonal_expression<V2>& b) {
+  CHECK_EQ(a.col_count(), b.row_count()) << "matmul: mismatched dimensions";
+  return linalg_detail::broadcast_expression<
+    V1, linalg_detail::diagonal_expression<V2>,
+    std::multiplies<typename V1::value_type> >(
+        a.v, b, std::multiplies<typename V1::value_type>());
+}
+
+// diag(w) * x, i.e. w * x.
+template<typename V1, typename V2>
+inline
+typename std::enable_if<
+  std::is_same<typename V1::value_type, typename V2::value_type>::value,
+  linalg_detail::binary_expression<
+    V1, V2, std::multiplies<typename V1::value_type> > >::type
+matmul(const linalg_detail::diagonal_expression<V1>& d,
+       const linalg_detail::vector_expression<V2>& x) {
+  CHECK_EQ(d.col_count(), x.self().size()) << "matmul: mismatched dimensions";
+  return linalg_detail::binary_expression<
+    V1, V2, std::multiplies<typename V1::value_type> >(
+        d.v, x.self(), std::multiplies<typename V1::value_type>());
+}
+
+// Reductions.
+//
+// sum, mean, min, max, asum (the sum of the absolute values) and norm (the
+// L2-norm) of all the elements of a vector or matrix expression, e.g.
+// sum(x * y), which evaluates no temporary. argmin and argmax return the
+// (row-major) linear index of the first smallest/largest element. The
+// mean, min, max, argmin and argmax of an empty expression are errors.
+//
+// Given the rowwise (colwise) tag, a matrix expression is reduced along
+// each of its rows (columns) instead, e.g. sum(A, rowwise) is the vector of
+// the sums of the rows of A, and sum(A, colwise) the vector of the sums of
+// its columns. These are vector expressions themselves:
+//
+//   x = max(A, rowwise) - min(A, rowwise);
+//
+// except for argmin and argmax, which return a vector<std::size_t> of
+// column (row) indices.
+
+constexpr linalg_detail::rowwise_tag rowwise = linalg_detail::rowwise_tag();
+constexpr linalg_detail::colwise_tag colwise = linalg_detail::colwise_tag();
+
+template<typename E>
+inline typename E::value_type
+sum(const linalg_detail::vector_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::sum_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline typename E::value_type
+sum(const linalg_detail::matrix_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::sum_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline typename E::value_type
+mean(const linalg_detail::vector_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::mean_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline typename E::value_type
+mean(const linalg_detail::matrix_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::mean_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline typename E::value_type
+min(const linalg_detail::vector_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::min_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline typename E::value_type
+min(const linalg_detail::matrix_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::min_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline typename E::value_type
+max(const linalg_detail::vector_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::max_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline typename E::value_type
+max(const linalg_detail::matrix_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::max_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline typename E::value_type
+asum(const linalg_detail::vector_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::asum_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline typename E::value_type
+asum(const linalg_detail::matrix_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::asum_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline typename E::value_type
+norm(const linalg_detail::vector_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::norm_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline typename E::value_type
+norm(const linalg_detail::matrix_expression<E>& e) {
+  return linalg_detail::reduce<
+    linalg_detail::norm_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::rowwise_reduction<
+  E, linalg_detail::sum_reducer<typename E::value_type> >
+sum(const linalg_detail::matrix_expression<E>& e, linalg_detail::rowwise_tag) {
+  return linalg_detail::rowwise_reduction<
+    E, linalg_detail::sum_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::colwise_reduction<
+  E, linalg_detail::sum_reducer<typename E::value_type> >
+sum(const linalg_detail::matrix_expression<E>& e, linalg_detail::colwise_tag) {
+  return linalg_detail::colwise_reduction<
+    E, linalg_detail::sum_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::rowwise_reduction<
+  E, linalg_detail::mean_reducer<typename E::value_type> >
+mean(const linalg_detail::matrix_expression<E>& e, linalg_detail::rowwise_tag) {
+  return linalg_detail::rowwise_reduction<
+    E, linalg_detail::mean_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::colwise_reduction<
+  E, linalg_detail::mean_reducer<typename E::value_type> >
+mean(const linalg_detail::matrix_expression<E>& e, linalg_detail::colwise_tag) {
+  return linalg_detail::colwise_reduction<
+    E, linalg_detail::mean_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::rowwise_reduction<
+  E, linalg_detail::min_reducer<typename E::value_type> >
+min(const linalg_detail::matrix_expression<E>& e, linalg_detail::rowwise_tag) {
+  return linalg_detail::rowwise_reduction<
+    E, linalg_detail::min_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::colwise_reduction<
+  E, linalg_detail::min_reducer<typename E::value_type> >
+min(const linalg_detail::matrix_expression<E>& e, linalg_detail::colwise_tag) {
+  return linalg_detail::colwise_reduction<
+    E, linalg_detail::min_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::rowwise_reduction<
+  E, linalg_detail::max_reducer<typename E::value_type> >
+max(const linalg_detail::matrix_expression<E>& e, linalg_detail::rowwise_tag) {
+  return linalg_detail::rowwise_reduction<
+    E, linalg_detail::max_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::colwise_reduction<
+  E, linalg_detail::max_reducer<typename E::value_type> >
+max(const linalg_detail::matrix_expression<E>& e, linalg_detail::colwise_tag) {
+  return linalg_detail::colwise_reduction<
+    E, linalg_detail::max_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::rowwise_reduction<
+  E, linalg_detail::asum_reducer<typename E::value_type> >
+asum(const linalg_detail::matrix_expression<E>& e, linalg_detail::rowwise_tag) {
+  return linalg_detail::rowwise_reduction<
+    E, linalg_detail::asum_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::colwise_reduction<
+  E, linalg_detail::asum_reducer<typename E::value_type> >
+asum(const linalg_detail::matrix_expression<E>& e, linalg_detail::colwise_tag) {
+  return linalg_detail::colwise_reduction<
+    E, linalg_detail::asum_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::rowwise_reduction<
+  E, linalg_detail::norm_reducer<typename E::value_type> >
+norm(const linalg_detail::matrix_expression<E>& e, linalg_detail::rowwise_tag) {
+  return linalg_detail::rowwise_reduction<
+    E, linalg_detail::norm_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline
+linalg_detail::colwise_reduction<
+  E, linalg_detail::norm_reducer<typename E::value_type> >
+norm(const linalg_detail::matrix_expression<E>& e, linalg_detail::colwise_tag) {
+  return linalg_detail::colwise_reduction<
+    E, linalg_detail::norm_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline std::size_t
+argmin(const linalg_detail::vector_expression<E>& e) {
+  return linalg_detail::arg_reduce<
+    linalg_detail::argmin_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline std::size_t
+argmin(const linalg_detail::matrix_expression<E>& e) {
+  return linalg_detail::arg_reduce<
+    linalg_detail::argmin_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline vector<std::size_t>
+argmin(const linalg_detail::matrix_expression<E>& e,
+       linalg_detail::rowwise_tag) {
+  using reducer = linalg_detail::argmin_reducer<typename E::value_type>;
+  vector<std::size_t> result(e.self().row_count());
+  linalg_detail::arg_reduce_rowwise<reducer>(e.self(), result.data());
+  return result;
+}
+
+template<typename E>
+inline vector<std::size_t>
+argmin(const linalg_detail::matrix_expression<E>& e,
+       linalg_detail::colwise_tag) {
+  using reducer = linalg_detail::argmin_reducer<typename E::value_type>;
+  vector<std::size_t> result(e.self().col_count());
+  linalg_detail::arg_reduce_colwise<reducer>(e.self(), result.data());
+  return result;
+}
+
+template<typename E>
+inline std::size_t
+argmax(const linalg_detail::vector_expression<E>& e) {
+  return linalg_detail::arg_reduce<
+    linalg_detail::argmax_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline std::size_t
+argmax(const linalg_detail::matrix_expression<E>& e) {
+  return linalg_detail::arg_reduce<
+    linalg_detail::argmax_reducer<typename E::value_type> >(e.self());
+}
+
+template<typename E>
+inline vector<std::size_t>
+argmax(const linalg_detail::matrix_expression<E>& e,
+       linalg_detail::rowwise_tag) {
+  using reducer = linalg_detail::argmax_reducer<typename E::value_type>;
+  vector<std::size_t> result(e.self().row_count());
+  linalg_detail::arg_reduce_rowwise<reducer>(e.self(), result.data());
+  return result;
+}
+
+template<typename E>
+inline vector<std::size_t>
+argmax(const linalg_detail::matrix_expression<E>& e,
+       linalg_detail::colwise_tag) {
+  using reducer = linalg_detail::argmax_reducer<typename E::value_type>;
+  vector<std::size_t> result(e.self().col_count());
+  linalg_detail::arg_reduce_colwise<reducer>(e.self(), result.data());
+  return result;
+}
 
 }  // namespace insight
 #endif  // INCLUDE_INSIGHT_LINALG_FUNCTIONS_H_
@@ -0,0 +1,169 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_HALF_H_
+#define INCLUDE_INSIGHT_LINALG_HALF_H_
+
+#include <cstdint>
+#include <cstring>
+
+namespace insight {
+namespace linalg_detail {
+
+// Scalar conversions between float and the bits of the 16-bit floating
+// point types below, rounding to nearest even. See blas_convert (in
+// linalg_detail/blas_routines.h) for their vectorized forms.
+
+inline uint32_t float_bits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline float bits_float(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// IEEE 754 binary16: 1 sign, 5 exponent and 10 mantissa bits.
+inline uint16_t float_to_half(float value) {
+  const uint32_t f32_infinity = 255u << 23;
+  const uint32_t f16_overflow = (127u + 16u) << 23;
+  const uint32_t denormal_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+  uint32_t bits = float_bits(value);
+  const uint32_t sign = (bits >> 16) & 0x8000u;
+  bits &= 0x7fffffffu;
+
+  uint32_t result;
+  if (bits >= f16_overflow) {
+    // Infinity, too large, or NaN (made quiet, keeping the upper bits of
+    // its payload).
+    result = (bits > f32_infinity) ? 0x7e00u | ((bits >> 13) & 0x3ffu) :
+             0x7c00u;
+  } else if (bits < (113u << 23)) {
+    // Subnormal or zero: let the FPU round the mantissa into place.
+    result = float_bits(bits_float(bits) + bits_float(denormal_magic)) -
+             denormal_magic;
+  } else {
+    const uint32_t mantissa_odd = (bits >> 13) & 1u;
+    bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xfffu + mantissa_odd;
+    result = bits >> 13;
+  }
+  return static_cast<uint16_t>(result | sign);
+}
+
+inline float half_to_float(uint16_t bits) {
+  const uint32_t shifted_exponent = 0x7c00u << 13;
+  const float magic = bits_float(113u << 23);
+
+  uint32_t result = (bits & 0x7fffu) << 13;
+  const uint32_t exponent = shifted_exponent & result;
+  result += (127u - 15u) << 23;
+  if (exponent == shifted_exponent) {
+    // Infinity or NaN (made quiet).
+    result += (128u - 16u) << 23;
+    if (result & 0x7fffffu) result |= 0x400000u;
+  } else if (exponent == 0) {
+    // Subnormal or zero.
+    result = float_bits(bits_float(result + (1u << 23)) - magic);
+  }
+  return bits_float(result | ((bits & 0x8000u) << 16));
+}
+
+// bfloat16: the upper half of a float, i.e 1 sign, 8 exponent and 7
+// mantissa bits.
+inline uint16_t float_to_bfloat16(float value) {
+  const uint32_t bits = float_bits(value);
+  if ((bits & 0x7fffffffu) > 0x7f800000u) {
+    // NaN, kept quiet.
+    return static_cast<uint16_t>((bits >> 16) | 0x40u);
+  }
+  return static_cast<uint16_t>(
+      (bits + 0x7fffu + ((bits >> 16) & 1u)) >> 16);
+}
+
+inline float bfloat16_to_float(uint16_t bits) {
+  return bits_float(static_cast<uint32_t>(bits) << 16);
+}
+
+}  // namespace linalg_detail
+
+// 16-bit floating point storage types.
+//
+// Both convert implicitly to and from float, and all of their arithmetic
+// is carried out in float: a + b, with a and b of type float16, is the
+// float sum of the two, rounded back only when stored into a float16. They
+// are meant to halve the memory footprint (and bandwidth) of vectors and
+// matrices, e.g. embedding tables,
+//
+//   matrix<float16> W = ...;
+//   vector<float16> x = ...;
+//   vector<float16> y = matmul(W, x);
+//
+// whose products, dot products and reductions accumulate in float as well
+// (see linalg_detail/mixed_precision.h).
+//
+// float16 is IEEE 754 binary16: about 3 decimal digits over [6e-5, 65504].
+// bfloat16_t is bfloat16, which keeps the range of float, but only about 2
+// decimal digits. It is not named bfloat16 as OpenBLAS's cblas.h declares
+// a global ::bfloat16, which would be ambiguous after using namespace
+// insight.
+
+class float16 {
+ public:
+  float16() = default;
+  float16(float value)  // NOLINT(runtime/explicit)
+      : bits_(linalg_detail::float_to_half(value)) {}
+
+  operator float() const { return linalg_detail::half_to_float(bits_); }
+
+  // The raw IEEE 754 binary16 representation.
+  static float16 from_bits(uint16_t bits) {
+    float16 result;
+    result.bits_ = bits;
+    return result;
+  }
+  uint16_t bits() const { return bits_; }
+
+  float16& operator+=(float value) { return *this = float(*this) + value; }
+  float16& operator-=(float value) { return *this = float(*this) - value; }
+  float16& operator*=(float value) { return *this = float(*this) * value; }
+  float16& operator/=(float value) { return *this = float(*this) / value; }
+
+ private:
+  uint16_t bits_;
+};
+
+class bfloat16_t {
+ public:
+  bfloat16_t() = default;
+  bfloat16_t(float value)  // NOLINT(runtime/explicit)
+      : bits_(linalg_detail::float_to_bfloat16(value)) {}
+
+  operator float() const { return linalg_detail::bfloat16_to_float(bits_); }
+
+  // The upper 16 bits of the float representation.
+  static bfloat16_t from_bits(uint16_t bits) {
+    bfloat16_t result;
+    result.bits_ = bits;
+    return result;
+  }
+  uint16_t bits() const { return bits_; }
+
+  bfloat16_t& operator+=(float value) { return *this = float(*this) + value; }
+  bfloat16_t& operator-=(float value) { return *this = float(*this) - value; }
+  bfloat16_t& operator*=(float value) { return *this = float(*this) * value; }
+  bfloat16_t& operator/=(float value) { return *this = float(*this) / value; }
+
+ private:
+  uint16_t bits_;
+};
+
+static_assert(sizeof(float16) == 2 && sizeof(bfloat16_t) == 2,
+              "16-bit floating point types must be 16 bits wide");
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_HALF_H_
@@ -0,0 +1,107 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_MATMUL_BATCH_H_
+#define INCLUDE_INSIGHT_LINALG_MATMUL_BATCH_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "insight/linalg/matrix_map.h"
+#include "insight/linalg/vector_map.h"
+#include "insight/linalg/detail/blas_routines.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// Batched matrix products: many independent, identically shaped products
+// computed in a single call, e.g. one small regression per group
+//
+//   std::vector<matrix_map<const double> > X, Y;
+//   std::vector<matrix_map<double> > XtY;
+//   ...
+//   matmul_batch(X, Y, &XtY);
+//
+// which, unlike a loop over matmul, pays the dispatch overhead once for the
+// whole batch. When Insight is built with OpenMP, a batch of small products
+// (no larger than 64 in every dimension) is spread among threads, larger
+// products are computed one after another, each by the threads of the BLAS
+// (see blas_gemm_batch in linalg_detail/blas_routines.h).
+//
+// All the operands of a batch must have the same shape, and the outputs
+// must not overlap one another nor the inputs.
+
+// C[i] = alpha * A[i] * B[i] + beta * C[i], for every i.
+template<typename T>
+void matmul_batch(const std::vector<matrix_map<const T> >& A,
+                  const std::vector<matrix_map<const T> >& B,
+                  std::vector<matrix_map<T> >* C,
+                  const T alpha = T(1),
+                  const T beta = T(0)) {
+  CHECK_EQ(A.size(), B.size()) << "matmul_batch: mismatched batch sizes";
+  CHECK_EQ(A.size(), C->size()) << "matmul_batch: mismatched batch sizes";
+  if (A.empty()) return;
+
+  const std::size_t M = A[0].row_count();
+  const std::size_t K = A[0].col_count();
+  const std::size_t N = B[0].col_count();
+
+  std::vector<const T*> a(A.size()), b(A.size());
+  std::vector<T*> c(A.size());
+  for (std::size_t i = 0; i < A.size(); ++i) {
+    CHECK(A[i].row_count() == M && A[i].col_count() == K &&
+          B[i].row_count() == K && B[i].col_count() == N &&
+          (*C)[i].row_count() == M && (*C)[i].col_count() == N)
+        << "matmul_batch: mismatched dimensions";
+    a[i] = A[i].data();
+    b[i] = B[i].data();
+    c[i] = (*C)[i].data();
+  }
+
+  linalg_detail::blas_gemm_batch(CblasNoTrans, CblasNoTrans,
+                                 static_cast<int>(M),
+                                 static_cast<int>(N),
+                                 static_cast<int>(K),
+                                 alpha, a.data(), static_cast<int>(K),
+                                 b.data(), static_cast<int>(N),
+                                 beta, c.data(), static_cast<int>(N),
+                                 static_cast<int>(A.size()));
+}
+
+// y[i] = alpha * A[i] * x[i] + beta * y[i], for every i.
+template<typename T>
+void matmul_batch(const std::vector<matrix_map<const T> >& A,
+                  const std::vector<vector_map<const T> >& x,
+                  std::vector<vector_map<T> >* y,
+                  const T alpha = T(1),
+                  const T beta = T(0)) {
+  CHECK_EQ(A.size(), x.size()) << "matmul_batch: mismatched batch sizes";
+  CHECK_EQ(A.size(), y->size()) << "matmul_batch: mismatched batch sizes";
+  if (A.empty()) return;
+
+  const std::size_t M = A[0].row_count();
+  const std::size_t N = A[0].col_count();
+
+  std::vector<const T*> a(A.size()), u(A.size());
+  std::vector<T*> v(A.size());
+  for (std::size_t i = 0; i < A.size(); ++i) {
+    CHECK(A[i].row_count() == M && A[i].col_count() == N &&
+          x[i].size() == N && (*y)[i].size() == M)
+        << "matmul_batch: mismatched dimensions";
+    a[i] = A[i].data();
+    u[i] = x[i].data();
+    v[i] = (*y)[i].data();
+  }
+
+  linalg_detail::blas_gemv_batch(CblasNoTrans,
+                                 static_cast<int>(M),
+                                 static_cast<int>(N),
+                                 alpha, a.data(), static_cast<int>(N),
+                                 u.data(), beta, v.data(),
+                                 static_cast<int>(A.size()));
+}
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_MATMUL_BATCH_H_
@@ -6,6 +6,8 @@
 #define INCLUDE_INSIGHT_LINALG_MATRIX_H_
 
 #include <algorithm>
+#include <cstddef>
+#include <functional>
 #include <limits>
 #include <utility>
 #include <initializer_list>
@@ -14,7 +16,11 @@
 
 #include "insight/linalg/detail/row_view.h"
 #include "insight/linalg/detail/col_view.h"
+#include "insight/linalg/detail/block_view.h"
 #include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/noalias.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/transpose_kernel.h"
 #include "insight/linalg/detail//dense_base.h"
 #include "insight/linalg/detail/blas_routines.h"
 
@@ -23,12 +29,15 @@
 namespace insight {
 
 // Dense, row-major order matrix.
-template<typename T, typename Alloc = allocator<T> >  // NOLINT
+//
+// Up to N elements are stored inline (see linalg_detail/dense_base.h): a
+// matrix that never holds more than N elements never touches its allocator.
+template<typename T, typename Alloc = allocator<T>, std::size_t N = 0>
 class matrix
-    : private linalg_detail::dense_base<T, Alloc>,
-  public linalg_detail::matrix_expression<matrix<T, Alloc> > {
+    : private linalg_detail::dense_base<T, Alloc, N>,
+  public linalg_detail::matrix_expression<matrix<T, Alloc, N> > {
  private:
-  using base = linalg_detail::dense_base<T, Alloc>;
+  using base = linalg_detail::dense_base<T, Alloc, N>;
   using self = matrix;
   using alloc_traits = typename base::alloc_traits;
 
@@ -50,8 +59,9 @@ class matrix
                 "Alloc::value_type must be the same as value_type");
 
   // TODO(Linh): What about complex data type?
-  static_assert(std::is_arithmetic<value_type>::value,
-                "matrix<T> only accepts arithmetic types.");
+  static_assert(linalg_detail::is_scalar<value_type>::value,
+                "matrix<T> only accepts arithmetic and 16-bit floating point "
+                "types.");
 
   // Constructs an empty matrix. An empty matrix is a matrix with zero number
   // of rows, zero number of columns, and zero number of elements.
@@ -200,6 +210,20 @@ class matrix
     return this->begin_;
   }
 
+  // Returns the element at the specified (row-major) linear index. This is
+  // the random access protocol shared by all expressions (see
+  // expression_evaluator). No bounds checking is performed.
+  inline value_type eval(size_type index) const INSIGHT_NOEXCEPT {
+    return this->begin_[index];
+  }
+
+  // Returns true if the elements of this matrix overlap the range
+  // [first, last) (see linalg_detail/alias.h).
+  inline bool aliases(const value_type* first, const value_type* last) const
+      INSIGHT_NOEXCEPT {
+    return this->begin_ < last && first < this->end_;
+  }
+
   // Clear all the contents in the matrix and set its size to zero.
   // Matrix will become an emtpy matrix after clear call.
   void clear() INSIGHT_NOEXCEPT;
@@ -212,6 +236,13 @@ class matrix
       !alloc_traits::propagate_on_container_swap::value ||
       internal::is_nothrow_swappable<allocator_type>::value);
 
+  // Returns a proxy through which an expression is assigned to (or added
+  // to, ...) this matrix without checking whether the expression reads it,
+  // e.g. C.noalias() = matmul(A, B). See linalg_detail/alias.h.
+  inline linalg_detail::noalias_proxy<matrix> noalias() {
+    return linalg_detail::noalias_proxy<matrix>(*this);
+  }
+
   // Accesses the row at index `row_index`.
   inline linalg_detail::row_view<self> row_at(size_type row_index) {
     return linalg_detail::row_view<self>(this, row_index);
@@ -222,11 +253,25 @@ class matrix
     return linalg_detail::col_view<self>(this, col_index);
   }
 
+  // Accesses the `row_count` by `col_count` block whose top left element is
+  // at (`row_index`, `col_index`).
+  inline linalg_detail::block_view<self> block(size_type row_index,
+                                               size_type col_index,
+                                               size_type row_count,
+                                               size_type col_count) {
+    return linalg_detail::block_view<self>(this, row_index, col_index,
+                                           row_count, col_count);
+  }
+
   // return the transpose of this matrix.
   inline linalg_detail::transpose_expression<self> t() const {
     return linalg_detail::transpose_expression<self>(*this);
   }
 
+  // Transposes this matrix in place, i.e without allocating a new buffer
+  // (see linalg_detail/transpose_kernel.h).
+  void transpose_inplace();
+
   // Matrix-scalar arithmetic.
 
   // Increments each and every element in the matrix by the constant scalar.
@@ -244,7 +289,7 @@ class matrix
   // Replaces each and every element in the matrix by the result of
   // multiplication of that element and a scalar.
   inline matrix& operator*=(const_reference scalar) {
-    mul_scalar_(scalar, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    mul_scalar_(scalar, linalg_detail::has_blas_arithmetic<value_type>());
     return *this;
   }
 
@@ -262,7 +307,7 @@ class matrix
   inline matrix& operator+=(const matrix& m) {
     CHECK_EQ(row_count(), m.row_count());
     CHECK_EQ(col_count(), m.col_count());
-    add_matrix_(m, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    add_matrix_(m, linalg_detail::has_blas_arithmetic<value_type>());
     return *this;
   }
 
@@ -272,7 +317,7 @@ class matrix
   inline matrix& operator-=(const matrix& m) {
     CHECK_EQ(row_count(), m.row_count());
     CHECK_EQ(col_count(), m.col_count());
-    sub_matrix_(m, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    sub_matrix_(m, linalg_detail::has_blas_arithmetic<value_type>());
     return *this;
   }
 
@@ -281,7 +326,7 @@ class matrix
   inline matrix& operator*=(const matrix& m) {
     CHECK_EQ(row_count(), m.row_count());
     CHECK_EQ(col_count(), m.col_count());
-    mul_matrix_(m, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    mul_matrix_(m, linalg_detail::has_blas_arithmetic<value_type>());
     return *this;
   }
 
@@ -297,7 +342,10 @@ class matrix
   // matrix expression arithmetic.
 
   template<typename E>
-  inline matrix& operator+=(const linalg_detail::matrix_expression<E>& expr) {
+  inline
+  typename std::enable_if<!linalg_detail::is_row_vector<E>::value,
+                          matrix&>::type
+  operator+=(const linalg_detail::matrix_expression<E>& expr) {
     CHECK_EQ(row_count(), expr.self().row_count());
     CHECK_EQ(col_count(), expr.self().col_count());
     linalg_detail::expression_evaluator<E> evaluator(expr.self());
@@ -306,7 +354,10 @@ class matrix
   }
 
   template<typename E>
-  inline matrix& operator-=(const linalg_detail::matrix_expression<E>& expr) {
+  inline
+  typename std::enable_if<!linalg_detail::is_row_vector<E>::value,
+                          matrix&>::type
+  operator-=(const linalg_detail::matrix_expression<E>& expr) {
     CHECK_EQ(row_count(), expr.self().row_count());
     CHECK_EQ(col_count(), expr.self().col_count());
     linalg_detail::expression_evaluator<E> evaluator(expr.self());
@@ -315,7 +366,10 @@ class matrix
   }
 
   template<typename E>
-  inline matrix& operator*=(const linalg_detail::matrix_expression<E>& expr) {
+  inline
+  typename std::enable_if<!linalg_detail::is_row_vector<E>::value,
+                          matrix&>::type
+  operator*=(const linalg_detail::matrix_expression<E>& expr) {
     CHECK_EQ(row_count(), expr.self().row_count());
     CHECK_EQ(col_count(), expr.self().col_count());
     linalg_detail::expression_evaluator<E> evaluator(expr.self());
@@ -324,7 +378,10 @@ class matrix
   }
 
   template<typename E>
-  inline matrix& operator/=(const linalg_detail::matrix_expression<E>& expr) {
+  inline
+  typename std::enable_if<!linalg_detail::is_row_vector<E>::value,
+                          matrix&>::type
+  operator/=(const linalg_detail::matrix_expression<E>& expr) {
     CHECK_EQ(row_count(), expr.self().row_count());
     CHECK_EQ(col_count(), expr.self().col_count());
     linalg_detail::expression_evaluator<E> evaluator(expr.self());
@@ -332,9 +389,81 @@ class matrix
     return *this;
   }
 
+  // Broadcasting (see linalg_detail/broadcast_expression.h): applies the
+  // operation between every row of this matrix and the row vector
+  // expression e, e.g. the bias add A += b.t(), or between every column of
+  // this matrix and the (column) vector expression e, e.g. A -= mu. The
+  // matrix is updated in place, row by row.
+
+  template<typename E>
+  inline
+  typename std::enable_if<linalg_detail::is_row_vector<E>::value,
+                          matrix&>::type
+  operator+=(const linalg_detail::matrix_expression<E>& e) {
+    return broadcast_(e.self(), std::plus<value_type>());
+  }
+
+  template<typename E>
+  inline
+  typename std::enable_if<linalg_detail::is_row_vector<E>::value,
+                          matrix&>::type
+  operator-=(const linalg_detail::matrix_expression<E>& e) {
+    return broadcast_(e.self(), std::minus<value_type>());
+  }
+
+  template<typename E>
+  inline
+  typename std::enable_if<linalg_detail::is_row_vector<E>::value,
+                          matrix&>::type
+  operator*=(const linalg_detail::matrix_expression<E>& e) {
+    return broadcast_(e.self(), std::multiplies<value_type>());
+  }
+
+  template<typename E>
+  inline
+  typename std::enable_if<linalg_detail::is_row_vector<E>::value,
+                          matrix&>::type
+  operator/=(const linalg_detail::matrix_expression<E>& e) {
+    return broadcast_(e.self(), std::divides<value_type>());
+  }
+
+  template<typename E>
+  inline matrix& operator+=(const linalg_detail::vector_expression<E>& e) {
+    return broadcast_(e.self(), std::plus<value_type>());
+  }
+
+  template<typename E>
+  inline matrix& operator-=(const linalg_detail::vector_expression<E>& e) {
+    return broadcast_(e.self(), std::minus<value_type>());
+  }
+
+  template<typename E>
+  inline matrix& operator*=(const linalg_detail::vector_expression<E>& e) {
+    return broadcast_(e.self(), std::multiplies<value_type>());
+  }
+
+  template<typename E>
+  inline matrix& operator/=(const linalg_detail::vector_expression<E>& e) {
+    return broadcast_(e.self(), std::divides<value_type>());
+  }
+
  private:
+  friend class linalg_detail::noalias_proxy<matrix>;
+
   shape_type dim_;
 
+  // Same as operator=(expr), but assumes that e does not read this matrix.
+  template<typename E>
+  matrix& assign_noalias_(const E& e);
+
+  // this op= e, where e is a row or a column vector expression.
+  template<typename E, typename F>
+  inline matrix& broadcast_(const E& e, F f) {
+    linalg_detail::broadcast_update(row_count(), col_count(), this->begin_,
+                                    e, f);
+    return *this;
+  }
+
   // Allocate space for n objects.
   void allocate_memory_(size_type n);
 
@@ -399,15 +528,15 @@ class matrix
   void div_matrix_(const matrix& m, std::false_type);
 };
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-matrix<T, Alloc>::matrix() INSIGHT_NOEXCEPT_IF(
+matrix<T, Alloc, N>::matrix() INSIGHT_NOEXCEPT_IF(
     std::is_nothrow_default_constructible<allocator_type>::value)
     : base(), dim_() {
 }
 
-template<typename T, typename Alloc>
-matrix<T, Alloc>::matrix(size_type row_count, size_type col_count)
+template<typename T, typename Alloc, std::size_t N>
+matrix<T, Alloc, N>::matrix(size_type row_count, size_type col_count)
     : base(),
       dim_() {
   size_type sz = row_count * col_count;
@@ -418,8 +547,8 @@ matrix<T, Alloc>::matrix(size_type row_count, size_type col_count)
   }
 }
 
-template<typename T, typename Alloc>
-matrix<T, Alloc>::matrix(const shape_type& dim)
+template<typename T, typename Alloc, std::size_t N>
+matrix<T, Alloc, N>::matrix(const shape_type& dim)
     : base(),
       dim_() {
   size_type sz = dim.first * dim.second;
@@ -430,8 +559,8 @@ matrix<T, Alloc>::matrix(const shape_type& dim)
   }
 }
 
-template<typename T, typename Alloc>
-matrix<T, Alloc>::matrix(size_type row_count,
+template<typename T, typename Alloc, std::size_t N>
+matrix<T, Alloc, N>::matrix(size_type row_count,
                          size_type col_count,
                          const_reference value)
     : base(),
@@ -444,8 +573,8 @@ matrix<T, Alloc>::matrix(size_type row_count,
   }
 }
 
-template<typename T, typename Alloc>
-matrix<T, Alloc>::matrix(const shape_type& dim,
+template<typename T, typename Alloc, std::size_t N>
+matrix<T, Alloc, N>::matrix(const shape_type& dim,
                          const_reference value)
     : base(),
       dim_() {
@@ -457,9 +586,9 @@ matrix<T, Alloc>::matrix(const shape_type& dim,
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 template<typename ForwardIter>
-matrix<T, Alloc>::matrix(ForwardIter first, ForwardIter last,
+matrix<T, Alloc, N>::matrix(ForwardIter first, ForwardIter last,
                          typename std::enable_if<
                          internal::is_forward_iterator<ForwardIter>::value &&
                          std::is_constructible<value_type,
@@ -474,8 +603,8 @@ matrix<T, Alloc>::matrix(ForwardIter first, ForwardIter last,
   }
 }
 
-template<typename T, typename Alloc>
-matrix<T, Alloc>::matrix(const matrix& m)
+template<typename T, typename Alloc, std::size_t N>
+matrix<T, Alloc, N>::matrix(const matrix& m)
     : base(alloc_traits::select_on_container_copy_construction(m.alloc_)),
       dim_(m.shape()) {
   size_type sz = m.size();
@@ -485,10 +614,10 @@ matrix<T, Alloc>::matrix(const matrix& m)
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-matrix<T, Alloc>&
-matrix<T, Alloc>::operator=(const matrix& m) {
+matrix<T, Alloc, N>&
+matrix<T, Alloc, N>::operator=(const matrix& m) {
   if (this != &m) {
     base::copy_assign_alloc_(m);
     assign_(m.begin_, m.end_);
@@ -497,35 +626,32 @@ matrix<T, Alloc>::operator=(const matrix& m) {
   return *this;
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-matrix<T, Alloc>::matrix(matrix&& m) INSIGHT_NOEXCEPT_IF(
+matrix<T, Alloc, N>::matrix(matrix&& m) INSIGHT_NOEXCEPT_IF(
     std::is_nothrow_move_constructible<allocator_type>::value)
     :   base(std::move(m.alloc_)),
         dim_(std::move(m.dim_/*this cannot throw?*/)) {
-  this->begin_ = m.begin_;
-  this->end_ = m.end_;
-  this->end_cap_ = m.end_cap_;
-  m.begin_ = m.end_ = m.end_cap_ = nullptr;
+  base::steal_(m);
 }
 
 // TODO(Linh): If propagate_on_container_move_assignment is false,
 // then the `false` version of move_assign_ will be called, but
 // for this version to be nothrow we need alloc_traits::is_always_equal is
 // true, unforturenately this feature is only available since C++17?
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-matrix<T, Alloc>&
-matrix<T, Alloc>::operator=(matrix&& m) INSIGHT_NOEXCEPT_IF(
+matrix<T, Alloc, N>&
+matrix<T, Alloc, N>::operator=(matrix&& m) INSIGHT_NOEXCEPT_IF(
     alloc_traits::propagate_on_container_move_assignment::value &&
     std::is_nothrow_move_assignable<allocator_type>::value) {
   move_assign_(m, std::integral_constant<bool, alloc_traits::propagate_on_container_move_assignment::value>());  // NOLINT
   return *this;
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-matrix<T, Alloc>::matrix(std::initializer_list<value_type> il)
+matrix<T, Alloc, N>::matrix(std::initializer_list<value_type> il)
     : base(),
       dim_() {
   size_type sz = il.size();
@@ -536,17 +662,17 @@ matrix<T, Alloc>::matrix(std::initializer_list<value_type> il)
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-matrix<T, Alloc>&
-matrix<T, Alloc>::operator=(std::initializer_list<value_type> il) {
+matrix<T, Alloc, N>&
+matrix<T, Alloc, N>::operator=(std::initializer_list<value_type> il) {
   assign_(il.begin(), il.end());
   dim_ = std::make_pair(il.size() > 0 ? 1 : 0, il.size());
   return *this;
 }
 
-template<typename T, typename Alloc>
-matrix<T, Alloc>::matrix(std::initializer_list<std::initializer_list<value_type> > il)  // NOLINT
+template<typename T, typename Alloc, std::size_t N>
+matrix<T, Alloc, N>::matrix(std::initializer_list<std::initializer_list<value_type> > il)  // NOLINT
     : base(),
       dim_() {
   // Make sure all sub-lists are of the same size.
@@ -567,9 +693,9 @@ matrix<T, Alloc>::matrix(std::initializer_list<std::initializer_list<value_type>
   dim_ = std::make_pair(il.size(), sublist_size);
 }
 
-template<typename T, typename Alloc>
-matrix<T, Alloc>&
-matrix<T, Alloc>::operator=(std::initializer_list<std::initializer_list<value_type> > il) {  // NOLINT
+template<typename T, typename Alloc, std::size_t N>
+matrix<T, Alloc, N>&
+matrix<T, Alloc, N>::operator=(std::initializer_list<std::initializer_list<value_type> > il) {  // NOLINT
   // Make sure all sub-lists are of the same size.
   size_type sublist_size = static_cast<size_type>(il.begin()->size());
   CHECK_GT(sublist_size, static_cast<size_type>(0));
@@ -602,9 +728,9 @@ matrix<T, Alloc>::operator=(std::initializer_list<std::initializer_list<value_ty
   return *this;
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 template<typename E>
-matrix<T, Alloc>::matrix(const linalg_detail::matrix_expression<E>& expr)
+matrix<T, Alloc, N>::matrix(const linalg_detail::matrix_expression<E>& expr)
     : base(),
       dim_(expr.self().shape()) {
   size_type sz = expr.self().size();
@@ -612,56 +738,86 @@ matrix<T, Alloc>::matrix(const linalg_detail::matrix_expression<E>& expr)
     allocate_memory_(sz);
     // construct_at_end_(expr.self().begin(), expr.self().end());
     linalg_detail::expression_evaluator<E> evaluator(expr.self());
-    evaluator.assign(this->begin_);
+    evaluator.assign_noalias(this->begin_);
     this->end_ = this->begin_ + sz;
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 template<typename E>
-matrix<T, Alloc>&
-matrix<T, Alloc>::operator=(const linalg_detail::matrix_expression<E>& expr) {
-  size_type new_size = expr.self().size();
+matrix<T, Alloc, N>&
+matrix<T, Alloc, N>::operator=(const linalg_detail::matrix_expression<E>& expr) {
+  const E& e = expr.self();
+  size_type new_size = e.size();
   if (new_size > capacity()) {
+    if (e.aliases(this->begin_, this->end_)) {
+      // e reads the memory that is about to be released.
+      matrix m(e);
+      swap(m);
+      return *this;
+    }
     deallocate_memory_();
     allocate_memory_(new_size);
   }
-  linalg_detail::expression_evaluator<E> evaluator(expr.self());
+  linalg_detail::expression_evaluator<E> evaluator(e);
   evaluator.assign(this->begin_);
   this->end_ = this->begin_ + new_size;
-  dim_ = expr.self().shape();
+  dim_ = e.shape();
+  return *this;
+}
+
+template<typename T, typename Alloc, std::size_t N>
+template<typename E>
+matrix<T, Alloc, N>&
+matrix<T, Alloc, N>::assign_noalias_(const E& e) {
+  size_type new_size = e.size();
+  if (new_size > capacity()) {
+    deallocate_memory_();
+    allocate_memory_(new_size);
+  }
+  linalg_detail::expression_evaluator<E> evaluator(e);
+  evaluator.assign_noalias(this->begin_);
+  this->end_ = this->begin_ + new_size;
+  dim_ = e.shape();
   return *this;
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-typename matrix<T, Alloc>::size_type
-matrix<T, Alloc>::max_size() const INSIGHT_NOEXCEPT {
+typename matrix<T, Alloc, N>::size_type
+matrix<T, Alloc, N>::max_size() const INSIGHT_NOEXCEPT {
   return std::min<size_type>(alloc_traits::max_size(this->alloc_),
                              std::numeric_limits<difference_type>::max());
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::clear() INSIGHT_NOEXCEPT {
+matrix<T, Alloc, N>::clear() INSIGHT_NOEXCEPT {
   base::clear();
   dim_ = std::make_pair(0, 0);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::reshape(size_type new_row_count,
+matrix<T, Alloc, N>::reshape(size_type new_row_count,
                           size_type new_col_count) INSIGHT_NOEXCEPT {
   if (!empty() && (new_row_count * new_col_count == size())) {
     dim_ = std::make_pair(new_row_count, new_col_count);
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
+void
+matrix<T, Alloc, N>::transpose_inplace() {
+  linalg_detail::transpose_inplace(dim_.first, dim_.second, this->begin_);
+  std::swap(dim_.first, dim_.second);
+}
+
+template<typename T, typename Alloc, std::size_t N>
 void
-matrix<T, Alloc>::swap(matrix& m) INSIGHT_NOEXCEPT_IF(
+matrix<T, Alloc, N>::swap(matrix& m) INSIGHT_NOEXCEPT_IF(
     !alloc_traits::propagate_on_container_swap::value ||
     internal::is_nothrow_swappable<allocator_type>::value) {
   DCHECK(alloc_traits::propagate_on_container_swap::value ||
@@ -669,9 +825,7 @@ matrix<T, Alloc>::swap(matrix& m) INSIGHT_NOEXCEPT_IF(
       << "matrix::swap Either propagate_on_container_swap must be true "
       << "or the allocators must compare equal";
   using std::swap;
-  swap(this->begin_, m.begin_);
-  swap(this->end_, m.end_);
-  swap(this->end_cap_, m.end_cap_);
+  base::swap_storage_(m);
   swap(dim_, m.dim_);  // TODO(Linh): nothrow?
   // The two allocators will be swapped iff propagate_on_container_swap is
   // true, otherwise nothing happens (that's why we need them compare
@@ -684,28 +838,26 @@ matrix<T, Alloc>::swap(matrix& m) INSIGHT_NOEXCEPT_IF(
 // throws (probablY bad_alloc) if memory run out
 // Precondition: begin_ == end_ == end_cap_ == 0
 // Precondition: n > 0
-// Postcondition: capacity() == n
+// Postcondition: capacity() >= n
 // Postcondition: size() == 0
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-matrix<T, Alloc>::allocate_memory_(size_type n) {
+matrix<T, Alloc, N>::allocate_memory_(size_type n) {
   if (n > max_size())
     this->throw_length_error("matrix::allocate_memory_(n): "
                              "the requested size n is too large");
-  this->begin_ = this->end_ = alloc_traits::allocate(this->alloc_, n);
-  this->end_cap_ = this->begin_ + n;
+  base::allocate_(n);
 }
 
 // Deallocate memory.
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-matrix<T, Alloc>::deallocate_memory_() INSIGHT_NOEXCEPT {
+matrix<T, Alloc, N>::deallocate_memory_() INSIGHT_NOEXCEPT {
   if (this->begin_ != nullptr) {
     // TODO(Linh): Can we just skip the clear step since we're only dealing
     // with arithmetic types?
     clear();
-    alloc_traits::deallocate(this->alloc_, this->begin_, capacity());
-    this->begin_ = this->end_ = this->end_cap_ = nullptr;
+    base::deallocate_();
     dim_ = std::make_pair(0, 0);  // TODO(Linh): neccessary?
   }
 }
@@ -715,9 +867,9 @@ matrix<T, Alloc>::deallocate_memory_() INSIGHT_NOEXCEPT {
 // Precondition: n > 0
 // Precondition: size() + n <= capacity()
 // Postcondition: size() == size() + n
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-matrix<T, Alloc>::construct_at_end_(size_type n) {
+matrix<T, Alloc, N>::construct_at_end_(size_type n) {
   // TODO(Linh): Can we replace the do-while loop with std::fill since we're
   // only dealing with arithmetic types? How about std::uninitialized_fill?
   // do {
@@ -735,9 +887,9 @@ matrix<T, Alloc>::construct_at_end_(size_type n) {
 // Precondition: size() + n <= capacity().
 // Postcondition: size() = old size() + n
 // Postcondition: [i] == value for all i in [size() - n, size()]
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-matrix<T, Alloc>::construct_at_end_(size_type n, const_reference value) {
+matrix<T, Alloc, N>::construct_at_end_(size_type n, const_reference value) {
   // TODO(Linh): Can we replace the do-while loop with std::fill since we're
   // only dealing with arithmetic types? How about std::uninitialized_fill?
   // do {
@@ -749,11 +901,11 @@ matrix<T, Alloc>::construct_at_end_(size_type n, const_reference value) {
   std::fill(this->begin_, this->end_, value);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 template<typename ForwardIter>
 typename
 std::enable_if<internal::is_forward_iterator<ForwardIter>::value, void>::type
-matrix<T, Alloc>::construct_at_end_(ForwardIter first, ForwardIter last) {
+matrix<T, Alloc, N>::construct_at_end_(ForwardIter first, ForwardIter last) {
   // TODO(Linh): Can we replace the do-while loop with std::copy since we're
   // only dealing with arithmetic types? How about std::uninitialized_copy?
   // for (; first != last; ++first, ++this->end_) {
@@ -765,7 +917,7 @@ matrix<T, Alloc>::construct_at_end_(ForwardIter first, ForwardIter last) {
 
 // Replaces the contents of the buffer with that in the range [first, last).
 // Memory allocated if neccessary.
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 template<typename ForwardIter>
 typename
 std::enable_if<
@@ -774,7 +926,7 @@ std::enable_if<
     T,
     typename std::iterator_traits<ForwardIter>::reference>::value,
   void>::type
-matrix<T, Alloc>::assign_(ForwardIter first, ForwardIter last) {
+matrix<T, Alloc, N>::assign_(ForwardIter first, ForwardIter last) {
   size_type new_size = static_cast<size_type>(std::distance(first, last));
   if (new_size <= capacity()) {
     // ForwardIter mid = last;
@@ -798,26 +950,23 @@ matrix<T, Alloc>::assign_(ForwardIter first, ForwardIter last) {
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-matrix<T, Alloc>::move_assign_(matrix& m, std::true_type)  // NOLINT
+matrix<T, Alloc, N>::move_assign_(matrix& m, std::true_type)  // NOLINT
     INSIGHT_NOEXCEPT_IF(
         std::is_nothrow_move_assignable<allocator_type>::value) {
   deallocate_memory_();
   base::move_assign_alloc_(m);
-  this->begin_ = m.begin_;
-  this->end_ = m.end_;
-  this->end_cap_ = m.end_cap_;
+  base::steal_(m);
   this->dim_ = m.dim_;  // TODO(Linh): or std::move(m.dim_)
-  m.begin_ = m.end_ = m.end_cap_ = nullptr;
   m.dim_ = std::make_pair(0, 0);  // TODO(Linh): is it neccessary?
 }
 
 // TODO(Linh): This will be nothrow if alloc_traits::is_always_equal is true
 // but this feature is only available since C++17.
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-matrix<T, Alloc>::move_assign_(matrix& m, std::false_type) {  // NOLINT
+matrix<T, Alloc, N>::move_assign_(matrix& m, std::false_type) {  // NOLINT
   // when propagate_on_container_move_assignment is false allocator will be
   // kept (no replacement happens) therefore we need to check to see wehther
   // this's allocator and m's allocator are in deed the same.
@@ -832,9 +981,9 @@ matrix<T, Alloc>::move_assign_(matrix& m, std::false_type) {  // NOLINT
 }
 
 // In addition to the public member swap, we also need a free swap function.
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-void swap(matrix<T, Alloc>& m1, matrix<T, Alloc>& m2) INSIGHT_NOEXCEPT_IF(
+void swap(matrix<T, Alloc, N>& m1, matrix<T, Alloc, N>& m2) INSIGHT_NOEXCEPT_IF(
     noexcept(m1.swap(m2))) {
   m1.swap(m2);
 }
@@ -842,92 +991,92 @@ void swap(matrix<T, Alloc>& m1, matrix<T, Alloc>& m2) INSIGHT_NOEXCEPT_IF(
 
 // matrix-scalar arithmetic.
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::mul_scalar_(const_reference scalar, std::true_type) {
+matrix<T, Alloc, N>::mul_scalar_(const_reference scalar, std::true_type) {
   linalg_detail::blas_scal(size(), scalar, this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::mul_scalar_(const_reference scalar, std::false_type) {
+matrix<T, Alloc, N>::mul_scalar_(const_reference scalar, std::false_type) {
   std::for_each(this->begin_, this->end_, [&](reference e) { e *= scalar; });
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::div_scalar_(const_reference scalar, std::true_type) {
+matrix<T, Alloc, N>::div_scalar_(const_reference scalar, std::true_type) {
   linalg_detail::blas_scal(size(), value_type(1.0) / scalar, this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::div_scalar_(const_reference scalar, std::false_type) {
+matrix<T, Alloc, N>::div_scalar_(const_reference scalar, std::false_type) {
   std::for_each(this->begin_, this->end_, [&](reference e) { e /= scalar; });
 }
 
 // matrix-matrix arithmetic.
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::add_matrix_(const matrix& m, std::true_type) {
+matrix<T, Alloc, N>::add_matrix_(const matrix& m, std::true_type) {
   linalg_detail::blas_add(size(), m.data(), this->begin_, this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::add_matrix_(const matrix& m, std::false_type) {
+matrix<T, Alloc, N>::add_matrix_(const matrix& m, std::false_type) {
   auto it = m.begin();
   std::for_each(this->begin_, this->end_, [&](reference e) { e += *it++; });
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::sub_matrix_(const matrix& m, std::true_type) {
+matrix<T, Alloc, N>::sub_matrix_(const matrix& m, std::true_type) {
   linalg_detail::blas_sub(size(), this->begin_, m.data(), this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::sub_matrix_(const matrix& m, std::false_type) {
+matrix<T, Alloc, N>::sub_matrix_(const matrix& m, std::false_type) {
   auto it = m.begin();
   std::for_each(this->begin_, this->end_, [&](reference e) { e -= *it++; });
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::mul_matrix_(const matrix& m, std::true_type) {
+matrix<T, Alloc, N>::mul_matrix_(const matrix& m, std::true_type) {
   linalg_detail::blas_mul(size(), m.data(), this->begin_, this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::mul_matrix_(const matrix& m, std::false_type) {
+matrix<T, Alloc, N>::mul_matrix_(const matrix& m, std::false_type) {
   auto it = m.begin();
   std::for_each(this->begin_, this->end_, [&](reference e) { e *= *it++; });
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::div_matrix_(const matrix& m, std::true_type) {
+matrix<T, Alloc, N>::div_matrix_(const matrix& m, std::true_type) {
   linalg_detail::blas_div(size(), this->begin_, m.data(), this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-matrix<T, Alloc>::div_matrix_(const matrix& m, std::false_type) {
+matrix<T, Alloc, N>::div_matrix_(const matrix& m, std::false_type) {
   auto it = m.begin();
   std::for_each(this->begin_, this->end_, [&](reference e) { e /= *it++; });
 }
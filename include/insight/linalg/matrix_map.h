@@ -0,0 +1,266 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_MATRIX_MAP_H_
+#define INCLUDE_INSIGHT_LINALG_MATRIX_MAP_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "insight/internal/port.h"
+
+#include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/noalias.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/row_view.h"
+#include "insight/linalg/detail/col_view.h"
+#include "insight/linalg/detail/block_view.h"
+#include "insight/linalg/detail/blas_routines.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// Dense, row-major order matrix over row_count * col_count contiguous
+// elements that it does not own (see vector_map.h), e.g.
+//
+//   matrix_map<const double> J(jacobian, m, n);
+//   vector_map<double> g(gradient, n);
+//   g = matmul(J.t(), r);
+template<typename T>
+class matrix_map
+    : public linalg_detail::matrix_expression<matrix_map<T> > {
+ private:
+  using self = matrix_map;
+
+ public:
+  using value_type = typename std::remove_const<T>::type;
+  using reference = T&;
+  using const_reference = const value_type&;
+  using size_type = std::size_t;
+  using shape_type = std::pair<size_type, size_type>;  // NOLINT
+  using difference_type = std::ptrdiff_t;
+  using pointer = T*;
+  using const_pointer = const value_type*;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+
+  static_assert(linalg_detail::is_scalar<value_type>::value,
+                "matrix_map<T> only accepts arithmetic and 16-bit floating "
+                "point types.");
+
+  // Maps the row_count by col_count matrix starting at data.
+  matrix_map(pointer data, size_type row_count, size_type col_count)
+      INSIGHT_NOEXCEPT
+      : data_(data), size_(row_count * col_count),
+        dim_(row_count, col_count) {}
+
+  // Copies the elements of m into the elements of this map (does not
+  // rebind it).
+  matrix_map& operator=(const matrix_map& m) {
+    return *this = static_cast<
+        const linalg_detail::matrix_expression<matrix_map>&>(m);
+  }
+
+  // Evaluates the expression expr, of the same size, into the elements of
+  // this map.
+  template<typename E>
+  matrix_map& operator=(const linalg_detail::matrix_expression<E>& expr) {
+    check_shape_(expr.self());
+    linalg_detail::expression_evaluator<E> evaluator(expr.self());
+    evaluator.assign(data_);
+    return *this;
+  }
+
+  // Iterators.
+
+  inline iterator begin() INSIGHT_NOEXCEPT { return data_; }
+  inline const_iterator begin() const INSIGHT_NOEXCEPT { return data_; }
+  inline iterator end() INSIGHT_NOEXCEPT { return data_ + size_; }
+  inline const_iterator end() const INSIGHT_NOEXCEPT {
+    return data_ + size_;
+  }
+
+  inline const_iterator cbegin() const INSIGHT_NOEXCEPT { return begin(); }
+  inline const_iterator cend() const INSIGHT_NOEXCEPT { return end(); }
+
+  inline size_type row_count() const INSIGHT_NOEXCEPT { return dim_.first; }
+  inline size_type col_count() const INSIGHT_NOEXCEPT { return dim_.second; }
+  inline const shape_type& shape() const INSIGHT_NOEXCEPT { return dim_; }
+
+  // Returns the number of elements in the map.
+  inline size_type size() const INSIGHT_NOEXCEPT { return size_; }
+
+  inline bool empty() const INSIGHT_NOEXCEPT { return size_ == 0; }
+
+  // Returns a reference to the element at the specified index.
+  // No bounds checking is performed.
+  inline reference operator[](size_type index) INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  inline const_reference operator[](size_type index) const INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  // Returns a reference to the element at the specified row and column.
+  // No bounds checking is performed.
+  inline reference operator()(size_type row_index, size_type col_index)
+      INSIGHT_NOEXCEPT {
+    return data_[row_index * dim_.second + col_index];
+  }
+
+  inline const_reference operator()(size_type row_index, size_type col_index)
+      const INSIGHT_NOEXCEPT {
+    return data_[row_index * dim_.second + col_index];
+  }
+
+  // Returns the pointer to the mapped array.
+  inline pointer data() INSIGHT_NOEXCEPT { return data_; }
+  inline const value_type* data() const INSIGHT_NOEXCEPT { return data_; }
+
+  // Returns the element at the specified index (see expression_evaluator).
+  // No bounds checking is performed.
+  inline value_type eval(size_type index) const INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  // Returns true if the mapped elements overlap the range [first, last)
+  // (see linalg_detail/alias.h).
+  inline bool aliases(const value_type* first, const value_type* last) const
+      INSIGHT_NOEXCEPT {
+    return data_ < last && first < data_ + size_;
+  }
+
+  // Returns the transpose of this map.
+  inline linalg_detail::transpose_expression<self> t() const {
+    return linalg_detail::transpose_expression<self>(*this);
+  }
+
+  // Accesses the row at index `row_index`.
+  inline linalg_detail::row_view<self> row_at(size_type row_index) {
+    return linalg_detail::row_view<self>(this, row_index);
+  }
+
+  // Accesses the column at index `col_index`.
+  inline linalg_detail::col_view<self> col_at(size_type col_index) {
+    return linalg_detail::col_view<self>(this, col_index);
+  }
+
+  // Accesses the `row_count` by `col_count` block whose top left element is
+  // at (`row_index`, `col_index`).
+  inline linalg_detail::block_view<self> block(size_type row_index,
+                                               size_type col_index,
+                                               size_type row_count,
+                                               size_type col_count) {
+    return linalg_detail::block_view<self>(this, row_index, col_index,
+                                           row_count, col_count);
+  }
+
+  // Returns a proxy through which an expression is assigned to (or added
+  // to, ...) this map without checking whether the expression reads it.
+  // See linalg_detail/alias.h.
+  inline linalg_detail::noalias_proxy<matrix_map> noalias() {
+    return linalg_detail::noalias_proxy<matrix_map>(*this);
+  }
+
+  // Map-scalar arithmetic.
+
+  inline matrix_map& operator+=(const value_type& scalar) {
+    std::for_each(begin(), end(), [&](reference e) { e += scalar; });
+    return *this;
+  }
+
+  inline matrix_map& operator-=(const value_type& scalar) {
+    std::for_each(begin(), end(), [&](reference e) { e -= scalar; });
+    return *this;
+  }
+
+  inline matrix_map& operator*=(const value_type& scalar) {
+    mul_scalar_(scalar, linalg_detail::has_blas_arithmetic<value_type>());
+    return *this;
+  }
+
+  inline matrix_map& operator/=(const value_type& scalar) {
+    div_scalar_(scalar, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    return *this;
+  }
+
+  // Map-expression arithmetic.
+
+  template<typename E>
+  inline matrix_map&
+  operator+=(const linalg_detail::matrix_expression<E>& expr) {
+    check_shape_(expr.self());
+    linalg_detail::expression_evaluator<E>(expr.self()).add(data_);
+    return *this;
+  }
+
+  template<typename E>
+  inline matrix_map&
+  operator-=(const linalg_detail::matrix_expression<E>& expr) {
+    check_shape_(expr.self());
+    linalg_detail::expression_evaluator<E>(expr.self()).sub(data_);
+    return *this;
+  }
+
+  template<typename E>
+  inline matrix_map&
+  operator*=(const linalg_detail::matrix_expression<E>& expr) {
+    check_shape_(expr.self());
+    linalg_detail::expression_evaluator<E>(expr.self()).mul(data_);
+    return *this;
+  }
+
+  template<typename E>
+  inline matrix_map&
+  operator/=(const linalg_detail::matrix_expression<E>& expr) {
+    check_shape_(expr.self());
+    linalg_detail::expression_evaluator<E>(expr.self()).div(data_);
+    return *this;
+  }
+
+ private:
+  friend class linalg_detail::noalias_proxy<matrix_map>;
+
+  // Same as operator=(expr), but assumes that e does not read this map.
+  template<typename E>
+  matrix_map& assign_noalias_(const E& e) {
+    check_shape_(e);
+    linalg_detail::expression_evaluator<E>(e).assign_noalias(data_);
+    return *this;
+  }
+
+  template<typename E>
+  inline void check_shape_(const E& e) const {
+    CHECK_EQ(row_count(), e.row_count()) << "matrix_map: mismatched dimensions";
+    CHECK_EQ(col_count(), e.col_count()) << "matrix_map: mismatched dimensions";
+  }
+
+  inline void mul_scalar_(const value_type& scalar, std::true_type) {
+    linalg_detail::blas_scal(static_cast<int>(size_), scalar, data_);
+  }
+
+  inline void mul_scalar_(const value_type& scalar, std::false_type) {
+    std::for_each(begin(), end(), [&](reference e) { e *= scalar; });
+  }
+
+  inline void div_scalar_(const value_type& scalar, std::true_type) {
+    linalg_detail::blas_scal(static_cast<int>(size_), value_type(1) / scalar,
+                             data_);
+  }
+
+  inline void div_scalar_(const value_type& scalar, std::false_type) {
+    std::for_each(begin(), end(), [&](reference e) { e /= scalar; });
+  }
+
+  pointer data_;
+  size_type size_;
+  shape_type dim_;
+};
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_MATRIX_MAP_H_
@@ -0,0 +1,264 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_QUANTIZE_H_
+#define INCLUDE_INSIGHT_LINALG_QUANTIZE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "insight/linalg/matrix.h"
+#include "insight/linalg/vector.h"
+#include "insight/linalg/detail/blas_routines.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// 8-bit quantization, to serve linear layers and MLPs with 4x smaller
+// weights.
+//
+// A real value r is represented by an integer q through the affine map
+//
+//   r = scale * (q - zero_point).
+//
+// Activations are quantized to uint8_t, with a single scale and zero point
+// for a whole vector or matrix (per tensor), usually chosen from its range.
+// Weights are quantized to int8_t symmetrically, i.e. with a zero point of
+// 0 and q in [-127, 127], with a scale per row (i.e. per output) or per
+// tensor (see quantized_matrix).
+//
+// qmatmul multiplies the two, accumulating exactly in int32 (see
+// blas_gemm_u8s8s32 in linalg_detail/blas_routines.h), and scales the sums
+// back to float:
+//
+//   quantized_matrix W(weights);                    // out x in
+//   quantization_params p = choose_quantization_params(min(x), max(x));
+//   vector<float> y = qmatmul(W, quantize(x, p), p);
+//   y += bias;
+//
+// As the weights have no zero point, that of the activations costs a single
+// multiply-add per output: sum_k w_k * (x_k - z) = sum_k w_k * x_k -
+// z * sum_k w_k, where the row sums of W are computed once.
+
+struct quantization_params {
+  float scale;
+  int32_t zero_point;
+};
+
+// uint8_t parameters covering [min_value, max_value], extended to contain 0
+// so that 0 is represented exactly (e.g. the padding, or a ReLU's output).
+inline quantization_params choose_quantization_params(float min_value,
+                                                      float max_value) {
+  min_value = std::min(min_value, 0.0f);
+  max_value = std::max(max_value, 0.0f);
+
+  quantization_params params;
+  params.scale = (max_value - min_value) / 255.0f;
+  if (!(params.scale > 0.0f)) {
+    params.scale = 1.0f;
+  }
+  const float zero_point = std::nearbyint(-min_value / params.scale);
+  params.zero_point =
+      static_cast<int32_t>(std::min(std::max(zero_point, 0.0f), 255.0f));
+  return params;
+}
+
+namespace linalg_detail {
+
+// round(value) clamped to [lowest, highest]; NaNs map to lowest.
+inline int32_t saturate_round(float value, float lowest, float highest) {
+  const float rounded = std::nearbyint(value);
+  if (!(rounded > lowest)) return static_cast<int32_t>(lowest);
+  if (rounded > highest) return static_cast<int32_t>(highest);
+  return static_cast<int32_t>(rounded);
+}
+
+inline void quantize_(const float* first, const float* last,
+                      const quantization_params& params, uint8_t* result) {
+  const float inverse_scale = 1.0f / params.scale;
+  const float zero_point = static_cast<float>(params.zero_point);
+  for (; first != last; ++first, ++result) {
+    *result = static_cast<uint8_t>(
+        saturate_round(*first * inverse_scale + zero_point, 0.0f, 255.0f));
+  }
+}
+
+inline void dequantize_(const uint8_t* first, const uint8_t* last,
+                        const quantization_params& params, float* result) {
+  for (; first != last; ++first, ++result) {
+    *result = params.scale *
+              static_cast<float>(static_cast<int32_t>(*first) -
+                                 params.zero_point);
+  }
+}
+
+}  // namespace linalg_detail
+
+// Quantizes each element of x, rounding to nearest and saturating to
+// [0, 255].
+inline vector<uint8_t> quantize(const vector<float>& x,
+                                const quantization_params& params) {
+  vector<uint8_t> result(x.size());
+  linalg_detail::quantize_(x.begin(), x.end(), params, result.data());
+  return result;
+}
+
+inline matrix<uint8_t> quantize(const matrix<float>& x,
+                                const quantization_params& params) {
+  matrix<uint8_t> result(x.row_count(), x.col_count());
+  linalg_detail::quantize_(x.begin(), x.end(), params, result.data());
+  return result;
+}
+
+inline vector<float> dequantize(const vector<uint8_t>& q,
+                                const quantization_params& params) {
+  vector<float> result(q.size());
+  linalg_detail::dequantize_(q.begin(), q.end(), params, result.data());
+  return result;
+}
+
+inline matrix<float> dequantize(const matrix<uint8_t>& q,
+                                const quantization_params& params) {
+  matrix<float> result(q.row_count(), q.col_count());
+  linalg_detail::dequantize_(q.begin(), q.end(), params, result.data());
+  return result;
+}
+
+enum quantization_granularity {
+  per_tensor,
+  per_row
+};
+
+// A matrix of weights quantized to int8_t, with a scale per row or a single
+// one for the whole matrix.
+class quantized_matrix {
+ public:
+  using size_type = matrix<int8_t>::size_type;
+
+  explicit quantized_matrix(const matrix<float>& m,
+                            quantization_granularity granularity = per_row)
+      : values_(m.row_count(), m.col_count()),
+        scales_(m.row_count()),
+        row_sums_(m.row_count()) {
+    const size_type row_count = m.row_count();
+    const size_type col_count = m.col_count();
+
+    float tensor_max = 0.0f;
+    for (size_type i = 0; i < row_count; ++i) {
+      scales_[i] = abs_max_(m.data() + i * col_count, col_count);
+      tensor_max = std::max(tensor_max, scales_[i]);
+    }
+
+    for (size_type i = 0; i < row_count; ++i) {
+      const float max = (granularity == per_tensor) ? tensor_max : scales_[i];
+      scales_[i] = (max > 0.0f) ? max / 127.0f : 1.0f;
+
+      const float inverse_scale = 1.0f / scales_[i];
+      const float* row = m.data() + i * col_count;
+      int8_t* q = values_.data() + i * col_count;
+      int32_t sum = 0;
+      for (size_type j = 0; j < col_count; ++j) {
+        q[j] = static_cast<int8_t>(linalg_detail::saturate_round(
+            row[j] * inverse_scale, -127.0f, 127.0f));
+        sum += q[j];
+      }
+      row_sums_[i] = sum;
+    }
+  }
+
+  inline size_type row_count() const { return values_.row_count(); }
+  inline size_type col_count() const { return values_.col_count(); }
+
+  // The quantized weights, the scale of each row, and the sum of each row
+  // of values().
+  inline const matrix<int8_t>& values() const { return values_; }
+  inline const vector<float>& scales() const { return scales_; }
+  inline const vector<int32_t>& row_sums() const { return row_sums_; }
+
+  matrix<float> dequantize() const {
+    matrix<float> result(row_count(), col_count());
+    const int8_t* q = values_.data();
+    float* r = result.data();
+    for (size_type i = 0; i < row_count(); ++i) {
+      for (size_type j = 0; j < col_count(); ++j, ++q, ++r) {
+        *r = scales_[i] * static_cast<float>(*q);
+      }
+    }
+    return result;
+  }
+
+ private:
+  static float abs_max_(const float* row, size_type n) {
+    float result = 0.0f;
+    for (size_type j = 0; j < n; ++j) {
+      result = std::max(result, std::fabs(row[j]));
+    }
+    return result;
+  }
+
+  matrix<int8_t> values_;
+  vector<float> scales_;
+  vector<int32_t> row_sums_;
+};
+
+namespace linalg_detail {
+
+// Scales the row_count x W.row_count() int32 sums acc of quantized inputs
+// times W back to float, correcting for the inputs' zero point.
+inline void rescale_(const int32_t* acc, std::size_t row_count,
+                     const quantized_matrix& W,
+                     const quantization_params& params, float* result) {
+  const std::size_t n = W.row_count();
+  for (std::size_t i = 0; i < row_count; ++i) {
+    for (std::size_t j = 0; j < n; ++j, ++acc, ++result) {
+      const int32_t sum = *acc - params.zero_point * W.row_sums()[j];
+      *result = params.scale * W.scales()[j] * static_cast<float>(sum);
+    }
+  }
+}
+
+}  // namespace linalg_detail
+
+// matmul(W, x), where x is quantized with params.
+inline vector<float> qmatmul(const quantized_matrix& W,
+                             const vector<uint8_t>& x,
+                             const quantization_params& params) {
+  CHECK_EQ(W.col_count(), x.size()) << "qmatmul: mismatched dimensions";
+  const int N = static_cast<int>(W.row_count());
+  const int K = static_cast<int>(W.col_count());
+
+  vector<int32_t> acc(W.row_count());
+  linalg_detail::blas_gemm_u8s8s32(1, N, K, x.data(), K,
+                                   W.values().data(), K, acc.data(), N);
+
+  vector<float> result(W.row_count());
+  linalg_detail::rescale_(acc.data(), 1, W, params, result.data());
+  return result;
+}
+
+// matmul(X, W.t()), i.e. W applied to a batch X of inputs (one per row),
+// quantized with params.
+inline matrix<float> qmatmul(const quantized_matrix& W,
+                             const matrix<uint8_t>& X,
+                             const quantization_params& params) {
+  CHECK_EQ(W.col_count(), X.col_count()) << "qmatmul: mismatched dimensions";
+  const int M = static_cast<int>(X.row_count());
+  const int N = static_cast<int>(W.row_count());
+  const int K = static_cast<int>(W.col_count());
+
+  matrix<int32_t> acc(X.row_count(), W.row_count());
+  linalg_detail::blas_gemm_u8s8s32(M, N, K, X.data(), K,
+                                   W.values().data(), K, acc.data(), N);
+
+  matrix<float> result(X.row_count(), W.row_count());
+  linalg_detail::rescale_(acc.data(), X.row_count(), W, params,
+                          result.data());
+  return result;
+}
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_QUANTIZE_H_
@@ -0,0 +1,272 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_SPARSE_MATRIX_H_
+#define INCLUDE_INSIGHT_LINALG_SPARSE_MATRIX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "insight/linalg/detail/eval_iterator.h"
+#include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/sparse_format.h"
+#include "insight/linalg/detail/transpose_expression.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// A nonzero element of a sparse matrix: its row, its column and its value.
+template<typename T>
+struct triplet {
+  std::size_t row;
+  std::size_t col;
+  T value;
+};
+
+// Sparse row_count x col_count matrix (e.g. a design matrix of one-hot or
+// hashed features), of which only the nonzero elements are stored, either
+// row by row in compressed sparse row format (F = csr) or column by column
+// in compressed sparse column format (F = csc):
+//
+//   std::vector<triplet<double> > nonzeros = {{0, 3, 1.0}, {2, 1, 0.5}};
+//   sparse_matrix<double> X(3, 1000000, nonzeros);
+//   vector<double> r = matmul(X, w) - y;     // no dense copy of X.
+//   vector<double> g = matmul(X.t(), r);
+//
+// The nonzeros of the i-th row (csr) or column (csc) are data()[k], in the
+// column (csr) or row (csc) indices()[k], for offsets()[i] <= k <
+// offsets()[i + 1], sorted by increasing indices.
+//
+// A sparse matrix is a matrix expression whose elements are read by binary
+// search in their row (or column). Its products (and those of its
+// transpose) with a dense vector or a dense matrix go through the sparse
+// kernels of sparse_routines.h, and take part in the expressions they
+// belong to like any other matmul; the other expressions it takes part in
+// read it elementwise. A * x is fastest in CSR format, and A^T * x in CSC.
+template<typename T, sparse_format F = csr>
+class sparse_matrix
+    : public linalg_detail::matrix_expression<sparse_matrix<T, F> > {
+ private:
+  using self = sparse_matrix;
+
+ public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = std::size_t;
+  using index_type = int;
+  using shape_type = std::pair<size_type, size_type>;  // NOLINT
+  using const_iterator = linalg_detail::eval_iterator<self>;
+  using iterator = const_iterator;
+
+  static_assert(linalg_detail::is_scalar<value_type>::value,
+                "sparse_matrix<T> only accepts arithmetic and 16-bit floating "
+                "point types.");
+
+  // Constructs an empty matrix.
+  sparse_matrix() : row_count_(0), col_count_(0), offsets_(1, 0) {}
+
+  // Constructs a row_count x col_count matrix with no nonzeros.
+  sparse_matrix(size_type row_count, size_type col_count)
+      : row_count_(row_count),
+        col_count_(col_count),
+        offsets_(outer_count_() + 1, 0) {
+    check_index_range_();
+  }
+
+  // Constructs a row_count x col_count matrix from its nonzeros, given in
+  // any order. The values of the triplets for the same element are summed.
+  sparse_matrix(size_type row_count, size_type col_count,
+                const std::vector<triplet<value_type> >& triplets)
+      : row_count_(row_count),
+        col_count_(col_count),
+        offsets_(outer_count_() + 1, 0) {
+    check_index_range_();
+    for (const auto& t : triplets) {
+      CHECK(t.row < row_count_ && t.col < col_count_)
+          << "sparse_matrix: triplet out of range";
+      ++offsets_[outer_(t.row, t.col) + 1];
+    }
+    for (size_type o = 0; o < outer_count_(); ++o) {
+      offsets_[o + 1] += offsets_[o];
+    }
+
+    // The triplets, bucketed by row (csr) or column (csc), then sorted by
+    // column (csr) or row (csc) within each bucket.
+    std::vector<size_type> order(triplets.size());
+    std::vector<size_type> next(offsets_.begin(), offsets_.end() - 1);
+    for (size_type k = 0; k < triplets.size(); ++k) {
+      order[next[outer_(triplets[k].row, triplets[k].col)]++] = k;
+    }
+
+    indices_.reserve(triplets.size());
+    values_.reserve(triplets.size());
+    size_type first = 0;
+    for (size_type o = 0; o < outer_count_(); ++o) {
+      const size_type last = offsets_[o + 1];
+      std::stable_sort(order.begin() + first, order.begin() + last,
+                       [&triplets, this](size_type a, size_type b) {
+                         return inner_(triplets[a].row, triplets[a].col) <
+                                inner_(triplets[b].row, triplets[b].col);
+                       });
+      const size_type start = values_.size();
+      for (size_type k = first; k < last; ++k) {
+        const triplet<value_type>& t = triplets[order[k]];
+        const index_type inner = inner_(t.row, t.col);
+        if (values_.size() > start && indices_.back() == inner) {
+          values_.back() += t.value;
+        } else {
+          indices_.push_back(inner);
+          values_.push_back(t.value);
+        }
+      }
+      first = last;
+      offsets_[o + 1] = values_.size();
+    }
+  }
+
+  // Constructs a sparse matrix from the nonzero elements of the matrix
+  // expression e.
+  template<typename E>
+  explicit sparse_matrix(const linalg_detail::matrix_expression<E>& e)
+      : row_count_(e.self().row_count()),
+        col_count_(e.self().col_count()),
+        offsets_(outer_count_() + 1, 0) {
+    check_index_range_();
+    linalg_detail::materialized<E> m(e.self());
+    for (size_type o = 0; o < outer_count_(); ++o) {
+      for (size_type inner = 0; inner < inner_count_(); ++inner) {
+        const size_type i = (F == csr) ? o : inner;
+        const size_type j = (F == csr) ? inner : o;
+        const value_type value = m.get().eval(i * col_count_ + j);
+        if (value != value_type(0)) {
+          indices_.push_back(static_cast<index_type>(inner));
+          values_.push_back(value);
+        }
+      }
+      offsets_[o + 1] = values_.size();
+    }
+  }
+
+  // Converts a sparse matrix in the other format G, without going through
+  // its dense form.
+  template<sparse_format G>
+  explicit sparse_matrix(const sparse_matrix<value_type, G>& other)
+      : row_count_(other.row_count()),
+        col_count_(other.col_count()),
+        offsets_(outer_count_() + 1, 0),
+        indices_(other.nonzero_count()),
+        values_(other.nonzero_count()) {
+    static_assert(G != F, "sparse_matrix: same format");
+    const size_type nonzeros = other.nonzero_count();
+    for (size_type k = 0; k < nonzeros; ++k) {
+      ++offsets_[other.indices()[k] + 1];
+    }
+    for (size_type o = 0; o < outer_count_(); ++o) {
+      offsets_[o + 1] += offsets_[o];
+    }
+
+    // The rows (resp. columns) of other are read in order, so that every
+    // column (resp. row) of this matrix is filled in increasing order.
+    std::vector<size_type> next(offsets_.begin(), offsets_.end() - 1);
+    for (size_type o = 0; o < inner_count_(); ++o) {
+      for (size_type k = other.offsets()[o]; k < other.offsets()[o + 1];
+           ++k) {
+        const size_type p = next[other.indices()[k]]++;
+        indices_[p] = static_cast<index_type>(o);
+        values_[p] = other.data()[k];
+      }
+    }
+  }
+
+  inline size_type row_count() const { return row_count_; }
+  inline size_type col_count() const { return col_count_; }
+  inline size_type size() const { return row_count_ * col_count_; }
+  inline shape_type shape() const {
+    return shape_type(row_count_, col_count_);
+  }
+
+  // The number of elements actually stored.
+  inline size_type nonzero_count() const { return values_.size(); }
+
+  // The element (i, j), i.e zero if it is not stored.
+  inline value_type operator()(size_type i, size_type j) const {
+    const size_type o = outer_(i, j);
+    const index_type inner = inner_(i, j);
+    const index_type* first = indices_.data() + offsets_[o];
+    const index_type* last = indices_.data() + offsets_[o + 1];
+    const index_type* it = std::lower_bound(first, last, inner);
+    return (it != last && *it == inner) ?
+        values_[it - indices_.data()] : value_type(0);
+  }
+
+  // The values of the nonzeros, their column (csr) or row (csc) indices,
+  // and where each row (csr) or column (csc) starts in both, as described
+  // above. Only the values may be modified.
+  inline value_type* data() { return values_.data(); }
+  inline const value_type* data() const { return values_.data(); }
+  inline const index_type* indices() const { return indices_.data(); }
+  inline const size_type* offsets() const { return offsets_.data(); }
+
+  // Returns the element at the (row-major) linear index i.
+  inline value_type eval(size_type i) const {
+    return (*this)(i / col_count_, i % col_count_);
+  }
+
+  // Does this matrix store any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return values_.data() < last && first < values_.data() + values_.size();
+  }
+
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, size()); }
+  inline const_iterator cbegin() const { return begin(); }
+  inline const_iterator cend() const { return end(); }
+
+  // Returns the transpose of this matrix.
+  inline linalg_detail::transpose_expression<self> t() const {
+    return linalg_detail::transpose_expression<self>(*this);
+  }
+
+ private:
+  size_type row_count_;
+  size_type col_count_;
+  std::vector<size_type> offsets_;
+  std::vector<index_type> indices_;
+  std::vector<value_type> values_;
+
+  // The number of compressed rows (csr) or columns (csc), and the length of
+  // each of them.
+  inline size_type outer_count_() const {
+    return (F == csr) ? row_count_ : col_count_;
+  }
+  inline size_type inner_count_() const {
+    return (F == csr) ? col_count_ : row_count_;
+  }
+
+  // Where the element (i, j) goes: its compressed row (csr) or column (csc),
+  // and its index in there.
+  inline size_type outer_(size_type i, size_type j) const {
+    return (F == csr) ? i : j;
+  }
+  inline index_type inner_(size_type i, size_type j) const {
+    return static_cast<index_type>((F == csr) ? j : i);
+  }
+
+  // The kernels of sparse_routines.h take int dimensions and indices.
+  inline void check_index_range_() const {
+    const size_type max = std::numeric_limits<index_type>::max();
+    CHECK(row_count_ <= max && col_count_ <= max)
+        << "sparse_matrix: too many rows or columns";
+  }
+};
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_SPARSE_MATRIX_H_
@@ -0,0 +1,338 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_SPARSE_VECTOR_H_
+#define INCLUDE_INSIGHT_LINALG_SPARSE_VECTOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "insight/linalg/detail/eval_iterator.h"
+#include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/sparse_format.h"
+#include "insight/linalg/detail/sparse_routines.h"
+#include "insight/linalg/detail/special_expression_traits.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// Sparse (column) vector of the given size (e.g. the gradient of a linear
+// model over hashed features), of which only the nonzero elements are
+// stored: data()[k] at the index indices()[k], for k < nonzero_count(),
+// sorted by increasing indices.
+//
+//   sparse_vector<double> g(100000000, {{17, 0.5}, {4096, -1.0}});
+//   double p = g.dot(w);     // O(nonzero_count()), w being dense.
+//   w -= 0.01 * g;           // only touches the nonzeros of g.
+//
+// A sparse vector is a vector expression whose elements are read by binary
+// search. Assigning, adding or subtracting s, a * s or s * a to a dense
+// vector scatters the nonzeros of s (see special_expression_add.h); the
+// other expressions it takes part in read it elementwise. The sum,
+// difference and elementwise product of two (scaled) sparse vectors are
+// sparse vectors, computed by merging their nonzeros (see below).
+template<typename T>
+class sparse_vector
+    : public linalg_detail::vector_expression<sparse_vector<T> > {
+ private:
+  using self = sparse_vector;
+
+ public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = std::size_t;
+  using index_type = int;
+  using shape_type = std::pair<size_type, size_type>;  // NOLINT
+  using const_iterator = linalg_detail::eval_iterator<self>;
+  using iterator = const_iterator;
+
+  static_assert(linalg_detail::is_scalar<value_type>::value,
+                "sparse_vector<T> only accepts arithmetic and 16-bit floating "
+                "point types.");
+
+  // Constructs an empty vector.
+  sparse_vector() : size_(0) {}
+
+  // Constructs a vector of the given size with no nonzeros.
+  explicit sparse_vector(size_type size) : size_(size) {
+    check_index_range_();
+  }
+
+  // Constructs a vector of the given size from its (index, value) nonzeros,
+  // given in any order. The values given for the same index are summed.
+  sparse_vector(size_type size,
+                const std::vector<std::pair<size_type, value_type> >& nonzeros)
+      : size_(size) {
+    check_index_range_();
+    std::vector<size_type> order(nonzeros.size());
+    for (size_type k = 0; k < nonzeros.size(); ++k) {
+      CHECK(nonzeros[k].first < size_) << "sparse_vector: index out of range";
+      order[k] = k;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&nonzeros](size_type a, size_type b) {
+                       return nonzeros[a].first < nonzeros[b].first;
+                     });
+
+    indices_.reserve(nonzeros.size());
+    values_.reserve(nonzeros.size());
+    for (size_type k : order) {
+      const index_type index = static_cast<index_type>(nonzeros[k].first);
+      if (!indices_.empty() && indices_.back() == index) {
+        values_.back() += nonzeros[k].second;
+      } else {
+        indices_.push_back(index);
+        values_.push_back(nonzeros[k].second);
+      }
+    }
+  }
+
+  // Constructs a sparse vector from the nonzero elements of the vector
+  // expression e.
+  template<typename E>
+  explicit sparse_vector(const linalg_detail::vector_expression<E>& e)
+      : size_(e.self().size()) {
+    check_index_range_();
+    linalg_detail::materialized<E> m(e.self());
+    for (size_type i = 0; i < size_; ++i) {
+      const value_type value = m.get().eval(i);
+      if (value != value_type(0)) {
+        indices_.push_back(static_cast<index_type>(i));
+        values_.push_back(value);
+      }
+    }
+  }
+
+  inline size_type size() const { return size_; }
+  inline size_type row_count() const { return size_; }
+  inline size_type col_count() const { return size_ > 0 ? 1 : 0; }
+  inline shape_type shape() const {
+    return shape_type(row_count(), col_count());
+  }
+
+  // The number of elements actually stored.
+  inline size_type nonzero_count() const { return values_.size(); }
+
+  // The element at the given index, i.e zero if it is not stored.
+  inline value_type operator[](size_type index) const {
+    const index_type i = static_cast<index_type>(index);
+    auto it = std::lower_bound(indices_.begin(), indices_.end(), i);
+    return (it != indices_.end() && *it == i) ?
+        values_[it - indices_.begin()] : value_type(0);
+  }
+
+  // The values of the nonzeros and their indices, as described above. Only
+  // the values may be modified.
+  inline value_type* data() { return values_.data(); }
+  inline const value_type* data() const { return values_.data(); }
+  inline const index_type* indices() const { return indices_.data(); }
+
+  // Returns the element at the given index.
+  inline value_type eval(size_type index) const { return (*this)[index]; }
+
+  // Does this vector store any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return values_.data() < last && first < values_.data() + values_.size();
+  }
+
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, size()); }
+  inline const_iterator cbegin() const { return begin(); }
+  inline const_iterator cend() const { return end(); }
+
+  // Appends the nonzero value at the given index, which must be greater
+  // than those of all the nonzeros already stored (e.g. when accumulating a
+  // gradient feature by feature).
+  inline void push_back(size_type index, const value_type& value) {
+    CHECK(index < size_ && (indices_.empty() ||
+                            index > static_cast<size_type>(indices_.back())))
+        << "sparse_vector: index out of order";
+    indices_.push_back(static_cast<index_type>(index));
+    values_.push_back(value);
+  }
+
+  // Reserves space for the given number of nonzeros.
+  inline void reserve(size_type nonzero_count) {
+    indices_.reserve(nonzero_count);
+    values_.reserve(nonzero_count);
+  }
+
+  // Removes all the nonzeros, keeping the size of the vector.
+  inline void clear() {
+    indices_.clear();
+    values_.clear();
+  }
+
+  // Returns the dot product of this vector with the vector expression e, of
+  // the same size, in O(nonzero_count()): only the elements of e at the
+  // indices of the nonzeros are read.
+  template<typename E>
+  inline value_type dot(const linalg_detail::vector_expression<E>& e) const {
+    CHECK_EQ(size(), e.self().size());
+    return dot_(e.self(), std::integral_constant<
+                bool, linalg_detail::is_dense_vector<E>::value>());
+  }
+
+  // Returns the dot product of two sparse vectors, by merging their indices.
+  inline value_type dot(const sparse_vector& v) const {
+    CHECK_EQ(size(), v.size());
+    value_type result(0);
+    size_type p = 0, q = 0;
+    while (p < nonzero_count() && q < v.nonzero_count()) {
+      if (indices_[p] < v.indices_[q]) {
+        ++p;
+      } else if (v.indices_[q] < indices_[p]) {
+        ++q;
+      } else {
+        result += values_[p++] * v.values_[q++];
+      }
+    }
+    return result;
+  }
+
+ private:
+  size_type size_;
+  std::vector<index_type> indices_;
+  std::vector<value_type> values_;
+
+  // Dense vector: the elements of e are gathered from its buffer.
+  template<typename E>
+  inline value_type dot_(const E& e, std::true_type) const {
+    return linalg_detail::sparse_doti(nonzero_count(), values_.data(),
+                                      indices_.data(), e.begin());
+  }
+
+  // Any other expression: read elementwise.
+  template<typename E>
+  inline value_type dot_(const E& e, std::false_type) const {
+    linalg_detail::materialized<E> m(e);
+    value_type result(0);
+    for (size_type k = 0; k < nonzero_count(); ++k) {
+      result += values_[k] * m.get().eval(indices_[k]);
+    }
+    return result;
+  }
+
+  inline void check_index_range_() const {
+    CHECK(size_ <= static_cast<size_type>(
+        std::numeric_limits<index_type>::max()))
+        << "sparse_vector: too many elements";
+  }
+};
+
+namespace linalg_detail {
+
+// Is each of L and R one of s, a * s or s * a, where s is a sparse vector of
+// the same value type as the other?
+template<typename L, typename R>
+struct are_scaled_sparse_vectors
+    : public std::integral_constant<
+  bool,
+  special_expression::is_scaled_sparse_vector<L>::value &&
+  special_expression::is_scaled_sparse_vector<R>::value> {};
+
+// Returns the sparse vector z with z[i] = f(x[i], y[i]), computed by merging
+// the nonzeros of the sparse vectors x and y: f only runs on the indices of
+// the nonzeros of either (either = true) or both (either = false) of them, a
+// missing nonzero being read as zero. These are all stored in z, even those
+// for which f is zero.
+template<typename T, typename F>
+sparse_vector<T> sparse_merge(const sparse_vector<T>& x,
+                              const sparse_vector<T>& y, const bool either,
+                              F f) {
+  CHECK_EQ(x.size(), y.size()) << "sparse_vector: mismatched sizes";
+  const std::size_t m = x.nonzero_count();
+  const std::size_t n = y.nonzero_count();
+  sparse_vector<T> z(x.size());
+  z.reserve(either ? m + n : std::min(m, n));
+
+  std::size_t p = 0, q = 0;
+  while (p < m && q < n) {
+    const int i = x.indices()[p];
+    const int j = y.indices()[q];
+    if (i < j) {
+      if (either) z.push_back(i, f(x.data()[p], T(0)));
+      ++p;
+    } else if (j < i) {
+      if (either) z.push_back(j, f(T(0), y.data()[q]));
+      ++q;
+    } else {
+      z.push_back(i, f(x.data()[p++], y.data()[q++]));
+    }
+  }
+  if (either) {
+    for (; p < m; ++p) z.push_back(x.indices()[p], f(x.data()[p], T(0)));
+    for (; q < n; ++q) z.push_back(y.indices()[q], f(T(0), y.data()[q]));
+  }
+  return z;
+}
+
+}  // namespace linalg_detail
+
+// ax + by, where x and y are sparse vectors (a and b being optional): a
+// sparse vector whose nonzeros are the union of those of x and y.
+template<typename L, typename R>
+inline
+typename std::enable_if<
+  linalg_detail::are_scaled_sparse_vectors<L, R>::value &&
+  std::is_same<typename L::value_type, typename R::value_type>::value,
+  sparse_vector<typename L::value_type> >::type
+operator+(const L& x, const R& y) {
+  using T = typename L::value_type;
+  using X = linalg_detail::special_expression::scaled_sparse<L>;
+  using Y = linalg_detail::special_expression::scaled_sparse<R>;
+  const T a = X::scalar(x);
+  const T b = Y::scalar(y);
+  return linalg_detail::sparse_merge(
+      X::vector(x), Y::vector(y), true,
+      [a, b](T u, T v) { return a * u + b * v; });
+}
+
+// ax - by, where x and y are sparse vectors (a and b being optional): a
+// sparse vector whose nonzeros are the union of those of x and y.
+template<typename L, typename R>
+inline
+typename std::enable_if<
+  linalg_detail::are_scaled_sparse_vectors<L, R>::value &&
+  std::is_same<typename L::value_type, typename R::value_type>::value,
+  sparse_vector<typename L::value_type> >::type
+operator-(const L& x, const R& y) {
+  using T = typename L::value_type;
+  using X = linalg_detail::special_expression::scaled_sparse<L>;
+  using Y = linalg_detail::special_expression::scaled_sparse<R>;
+  const T a = X::scalar(x);
+  const T b = Y::scalar(y);
+  return linalg_detail::sparse_merge(
+      X::vector(x), Y::vector(y), true,
+      [a, b](T u, T v) { return a * u - b * v; });
+}
+
+// ax * by (elementwise), where x and y are sparse vectors (a and b being
+// optional): a sparse vector whose nonzeros are the intersection of those
+// of x and y.
+template<typename L, typename R>
+inline
+typename std::enable_if<
+  linalg_detail::are_scaled_sparse_vectors<L, R>::value &&
+  std::is_same<typename L::value_type, typename R::value_type>::value,
+  sparse_vector<typename L::value_type> >::type
+operator*(const L& x, const R& y) {
+  using T = typename L::value_type;
+  using X = linalg_detail::special_expression::scaled_sparse<L>;
+  using Y = linalg_detail::special_expression::scaled_sparse<R>;
+  const T ab = X::scalar(x) * Y::scalar(y);
+  return linalg_detail::sparse_merge(
+      X::vector(x), Y::vector(y), false,
+      [ab](T u, T v) { return ab * u * v; });
+}
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_SPARSE_VECTOR_H_
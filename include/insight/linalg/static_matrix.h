@@ -0,0 +1,260 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_STATIC_MATRIX_H_
+#define INCLUDE_INSIGHT_LINALG_STATIC_MATRIX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+#include "insight/internal/port.h"
+
+#include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/noalias.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/row_view.h"
+#include "insight/linalg/detail/col_view.h"
+#include "insight/linalg/detail/static_kernels.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// Dense R by C matrix, stored in row-major order inline (no heap
+// allocation), e.g. the rotations, homographies, Jacobian blocks, ... of
+// geometry code. See static_vector.h.
+template<typename T, std::size_t R, std::size_t C>
+class static_matrix
+    : public linalg_detail::matrix_expression<static_matrix<T, R, C> > {
+ private:
+  using self = static_matrix;
+  static constexpr std::size_t N = R * C;
+
+ public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = std::size_t;
+  using shape_type = std::pair<size_type, size_type>;  // NOLINT
+  using difference_type = std::ptrdiff_t;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+
+  static_assert(linalg_detail::is_scalar<value_type>::value,
+                "static_matrix<T, R, C> only accepts arithmetic and 16-bit "
+                "floating point types.");
+  static_assert(R > 0 && C > 0, "static_matrix<T, R, C> requires R, C > 0");
+
+  // Constructs a matrix whose elements are all value-initialized (zero).
+  static_matrix() : data_() {}
+
+  // Constructs a matrix whose elements are all copies of value.
+  explicit static_matrix(const value_type& value) {
+    std::fill(data_, data_ + N, value);
+  }
+
+  // Constructs a matrix with the contents of the initializer list il, which
+  // must have R sub-lists of size C each.
+  static_matrix(std::initializer_list<std::initializer_list<value_type> > il) {
+    CHECK_EQ(il.size(), R) << "static_matrix: mismatched dimensions";
+    value_type* it = data_;
+    for (const auto& row : il) {
+      CHECK_EQ(row.size(), C) << "static_matrix: mismatched dimensions";
+      it = std::copy(row.begin(), row.end(), it);
+    }
+  }
+
+  // Constructs a matrix from a generic R by C matrix expression.
+  template<typename E>
+  static_matrix(const linalg_detail::matrix_expression<E>& expr) {  // NOLINT
+    check_shape_(expr.self());
+    linalg_detail::static_evaluate_noalias<N>(expr.self(), data_,
+                                              assign_op());
+  }
+
+  template<typename E>
+  static_matrix& operator=(const linalg_detail::matrix_expression<E>& expr) {
+    check_shape_(expr.self());
+    linalg_detail::static_evaluate<N>(expr.self(), data_, assign_op());
+    return *this;
+  }
+
+  // Iterators.
+
+  inline iterator begin() INSIGHT_NOEXCEPT { return data_; }
+  inline const_iterator begin() const INSIGHT_NOEXCEPT { return data_; }
+  inline iterator end() INSIGHT_NOEXCEPT { return data_ + N; }
+  inline const_iterator end() const INSIGHT_NOEXCEPT { return data_ + N; }
+
+  inline const_iterator cbegin() const INSIGHT_NOEXCEPT { return begin(); }
+  inline const_iterator cend() const INSIGHT_NOEXCEPT { return end(); }
+
+  inline constexpr size_type row_count() const { return R; }
+  inline constexpr size_type col_count() const { return C; }
+  inline const shape_type shape() const INSIGHT_NOEXCEPT {
+    return std::make_pair(row_count(), col_count());
+  }
+
+  // Returns the number of elements in the matrix.
+  inline constexpr size_type size() const { return N; }
+
+  // Returns a reference to the element at the specified (row-major) linear
+  // index. No bounds checking is performed.
+  inline reference operator[](size_type index) INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  inline const_reference operator[](size_type index) const INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  // Returns a reference to the element at the specified row and column.
+  // No bounds checking is performed.
+  inline reference operator()(size_type row_index, size_type col_index)
+      INSIGHT_NOEXCEPT {
+    return data_[row_index * C + col_index];
+  }
+
+  inline const_reference operator()(size_type row_index, size_type col_index)
+      const INSIGHT_NOEXCEPT {
+    return data_[row_index * C + col_index];
+  }
+
+  // Returns the pointer to the underlying array.
+  inline value_type* data() INSIGHT_NOEXCEPT { return data_; }
+  inline const value_type* data() const INSIGHT_NOEXCEPT { return data_; }
+
+  // Returns the element at the specified (row-major) linear index (see
+  // expression_evaluator). No bounds checking is performed.
+  inline value_type eval(size_type index) const INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  // Returns true if the elements of this matrix overlap the range
+  // [first, last) (see linalg_detail/alias.h).
+  inline bool aliases(const value_type* first, const value_type* last) const
+      INSIGHT_NOEXCEPT {
+    return data_ < last && first < data_ + N;
+  }
+
+  // Returns the transpose of this matrix.
+  inline linalg_detail::transpose_expression<self> t() const {
+    return linalg_detail::transpose_expression<self>(*this);
+  }
+
+  // Returns the row view of this matrix at the specified row index.
+  inline linalg_detail::row_view<self> row_at(size_type row_index) {
+    return linalg_detail::row_view<self>(this, row_index);
+  }
+
+  // Returns the column view of this matrix at the specified column index.
+  inline linalg_detail::col_view<self> col_at(size_type col_index) {
+    return linalg_detail::col_view<self>(this, col_index);
+  }
+
+  // Returns a proxy through which an expression is assigned to (or added
+  // to, ...) this matrix without checking whether the expression reads it.
+  // See linalg_detail/alias.h.
+  inline linalg_detail::noalias_proxy<static_matrix> noalias() {
+    return linalg_detail::noalias_proxy<static_matrix>(*this);
+  }
+
+  // Matrix-scalar arithmetic.
+
+  inline static_matrix& operator+=(const value_type& scalar) {
+    linalg_detail::static_apply<N>(data_, [&](reference e) { e += scalar; });
+    return *this;
+  }
+
+  inline static_matrix& operator-=(const value_type& scalar) {
+    linalg_detail::static_apply<N>(data_, [&](reference e) { e -= scalar; });
+    return *this;
+  }
+
+  inline static_matrix& operator*=(const value_type& scalar) {
+    linalg_detail::static_apply<N>(data_, [&](reference e) { e *= scalar; });
+    return *this;
+  }
+
+  inline static_matrix& operator/=(const value_type& scalar) {
+    linalg_detail::static_apply<N>(data_, [&](reference e) { e /= scalar; });
+    return *this;
+  }
+
+  // Matrix expression arithmetic.
+
+  template<typename E>
+  inline static_matrix&
+  operator+=(const linalg_detail::matrix_expression<E>& expr) {
+    check_shape_(expr.self());
+    linalg_detail::static_evaluate<N>(expr.self(), data_,
+                                      [](reference x, value_type y) {
+                                        x += y;
+                                      });
+    return *this;
+  }
+
+  template<typename E>
+  inline static_matrix&
+  operator-=(const linalg_detail::matrix_expression<E>& expr) {
+    check_shape_(expr.self());
+    linalg_detail::static_evaluate<N>(expr.self(), data_,
+                                      [](reference x, value_type y) {
+                                        x -= y;
+                                      });
+    return *this;
+  }
+
+  template<typename E>
+  inline static_matrix&
+  operator*=(const linalg_detail::matrix_expression<E>& expr) {
+    check_shape_(expr.self());
+    linalg_detail::static_evaluate<N>(expr.self(), data_,
+                                      [](reference x, value_type y) {
+                                        x *= y;
+                                      });
+    return *this;
+  }
+
+  template<typename E>
+  inline static_matrix&
+  operator/=(const linalg_detail::matrix_expression<E>& expr) {
+    check_shape_(expr.self());
+    linalg_detail::static_evaluate<N>(expr.self(), data_,
+                                      [](reference x, value_type y) {
+                                        x /= y;
+                                      });
+    return *this;
+  }
+
+ private:
+  friend class linalg_detail::noalias_proxy<static_matrix>;
+
+  struct assign_op {
+    inline void operator()(reference x, value_type y) const { x = y; }
+  };
+
+  template<typename E>
+  inline void check_shape_(const E& e) const {
+    CHECK_EQ(e.row_count(), R) << "static_matrix: mismatched dimensions";
+    CHECK_EQ(e.col_count(), C) << "static_matrix: mismatched dimensions";
+  }
+
+  // Same as operator=(expr), but assumes that e does not read this matrix.
+  template<typename E>
+  static_matrix& assign_noalias_(const E& e) {
+    check_shape_(e);
+    linalg_detail::static_evaluate_noalias<N>(e, data_, assign_op());
+    return *this;
+  }
+
+  value_type data_[N];
+};
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_STATIC_MATRIX_H_
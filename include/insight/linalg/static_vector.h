@@ -0,0 +1,243 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_STATIC_VECTOR_H_
+#define INCLUDE_INSIGHT_LINALG_STATIC_VECTOR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+#include "insight/internal/port.h"
+
+#include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/noalias.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/static_kernels.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// Dense column vector of N elements, whose storage is inline (no heap
+// allocation), e.g. the 3D points, quaternions, ... of geometry code.
+//
+// It takes part in expressions like any other vector, and since its size
+// is a compile-time constant, the loops over its elements are fully
+// unrolled (see linalg_detail/static_kernels.h). Products of fixed-size
+// operands are evaluated elementwise rather than through BLAS (see
+// linalg_detail/materialize.h).
+template<typename T, std::size_t N>
+class static_vector
+    : public linalg_detail::vector_expression<static_vector<T, N> > {
+ private:
+  using self = static_vector;
+
+ public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = std::size_t;
+  using shape_type = std::pair<size_type, size_type>;  // NOLINT
+  using difference_type = std::ptrdiff_t;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+
+  static_assert(linalg_detail::is_scalar<value_type>::value,
+                "static_vector<T, N> only accepts arithmetic and 16-bit "
+                "floating point types.");
+  static_assert(N > 0, "static_vector<T, N> requires N > 0");
+
+  // Constructs a vector whose elements are all value-initialized (zero).
+  static_vector() : data_() {}
+
+  // Constructs a vector whose elements are all copies of value.
+  explicit static_vector(const value_type& value) {
+    std::fill(data_, data_ + N, value);
+  }
+
+  // Constructs a vector with the contents of the initializer_list il, whose
+  // size must be N.
+  static_vector(std::initializer_list<value_type> il) {
+    CHECK_EQ(il.size(), N) << "static_vector: mismatched dimensions";
+    std::copy(il.begin(), il.end(), data_);
+  }
+
+  // Constructs a vector from a generic vector expression of size N.
+  template<typename E>
+  static_vector(const linalg_detail::vector_expression<E>& expr) {  // NOLINT
+    CHECK_EQ(expr.self().size(), N) << "static_vector: mismatched dimensions";
+    linalg_detail::static_evaluate_noalias<N>(expr.self(), data_,
+                                              assign_op());
+  }
+
+  template<typename E>
+  static_vector& operator=(const linalg_detail::vector_expression<E>& expr) {
+    CHECK_EQ(expr.self().size(), N) << "static_vector: mismatched dimensions";
+    linalg_detail::static_evaluate<N>(expr.self(), data_, assign_op());
+    return *this;
+  }
+
+  // Iterators.
+
+  inline iterator begin() INSIGHT_NOEXCEPT { return data_; }
+  inline const_iterator begin() const INSIGHT_NOEXCEPT { return data_; }
+  inline iterator end() INSIGHT_NOEXCEPT { return data_ + N; }
+  inline const_iterator end() const INSIGHT_NOEXCEPT { return data_ + N; }
+
+  inline const_iterator cbegin() const INSIGHT_NOEXCEPT { return begin(); }
+  inline const_iterator cend() const INSIGHT_NOEXCEPT { return end(); }
+
+  inline constexpr size_type row_count() const { return N; }
+  inline constexpr size_type col_count() const { return 1; }
+  inline const shape_type shape() const INSIGHT_NOEXCEPT {
+    return std::make_pair(row_count(), col_count());
+  }
+
+  // Returns the number of elements in the vector.
+  inline constexpr size_type size() const { return N; }
+
+  // Returns a reference to the element at the specified index.
+  // No bounds checking is performed.
+  inline reference operator[](size_type index) INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  inline const_reference operator[](size_type index) const INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  // Returns the pointer to the underlying array.
+  inline value_type* data() INSIGHT_NOEXCEPT { return data_; }
+  inline const value_type* data() const INSIGHT_NOEXCEPT { return data_; }
+
+  // Returns the element at the specified index (see expression_evaluator).
+  // No bounds checking is performed.
+  inline value_type eval(size_type index) const INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  // Returns true if the elements of this vector overlap the range
+  // [first, last) (see linalg_detail/alias.h).
+  inline bool aliases(const value_type* first, const value_type* last) const
+      INSIGHT_NOEXCEPT {
+    return data_ < last && first < data_ + N;
+  }
+
+  // Returns the transpose of this vector.
+  inline linalg_detail::transpose_expression<self> t() const {
+    return linalg_detail::transpose_expression<self>(*this);
+  }
+
+  // Returns a proxy through which an expression is assigned to (or added
+  // to, ...) this vector without checking whether the expression reads it.
+  // See linalg_detail/alias.h.
+  inline linalg_detail::noalias_proxy<static_vector> noalias() {
+    return linalg_detail::noalias_proxy<static_vector>(*this);
+  }
+
+  // Vector-scalar arithmetic.
+
+  inline static_vector& operator+=(const value_type& scalar) {
+    linalg_detail::static_apply<N>(data_, [&](reference e) { e += scalar; });
+    return *this;
+  }
+
+  inline static_vector& operator-=(const value_type& scalar) {
+    linalg_detail::static_apply<N>(data_, [&](reference e) { e -= scalar; });
+    return *this;
+  }
+
+  inline static_vector& operator*=(const value_type& scalar) {
+    linalg_detail::static_apply<N>(data_, [&](reference e) { e *= scalar; });
+    return *this;
+  }
+
+  inline static_vector& operator/=(const value_type& scalar) {
+    linalg_detail::static_apply<N>(data_, [&](reference e) { e /= scalar; });
+    return *this;
+  }
+
+  // vector expression arithmetic.
+
+  template<typename E>
+  inline static_vector&
+  operator+=(const linalg_detail::vector_expression<E>& expr) {
+    CHECK_EQ(expr.self().size(), N);
+    linalg_detail::static_evaluate<N>(expr.self(), data_,
+                                      [](reference x, value_type y) {
+                                        x += y;
+                                      });
+    return *this;
+  }
+
+  template<typename E>
+  inline static_vector&
+  operator-=(const linalg_detail::vector_expression<E>& expr) {
+    CHECK_EQ(expr.self().size(), N);
+    linalg_detail::static_evaluate<N>(expr.self(), data_,
+                                      [](reference x, value_type y) {
+                                        x -= y;
+                                      });
+    return *this;
+  }
+
+  template<typename E>
+  inline static_vector&
+  operator*=(const linalg_detail::vector_expression<E>& expr) {
+    CHECK_EQ(expr.self().size(), N);
+    linalg_detail::static_evaluate<N>(expr.self(), data_,
+                                      [](reference x, value_type y) {
+                                        x *= y;
+                                      });
+    return *this;
+  }
+
+  template<typename E>
+  inline static_vector&
+  operator/=(const linalg_detail::vector_expression<E>& expr) {
+    CHECK_EQ(expr.self().size(), N);
+    linalg_detail::static_evaluate<N>(expr.self(), data_,
+                                      [](reference x, value_type y) {
+                                        x /= y;
+                                      });
+    return *this;
+  }
+
+  // Returns the L2-norm of this vector.
+  inline value_type nrm2() const {
+    return std::sqrt(linalg_detail::static_sum<N, value_type>(
+        [this](size_type i) { return data_[i] * data_[i]; }));
+  }
+
+  // Returns the dot product of this vector with the vector v.
+  inline value_type dot(const static_vector& v) const {
+    return linalg_detail::static_sum<N, value_type>(
+        [&](size_type i) { return data_[i] * v.data_[i]; });
+  }
+
+ private:
+  friend class linalg_detail::noalias_proxy<static_vector>;
+
+  struct assign_op {
+    inline void operator()(reference x, value_type y) const { x = y; }
+  };
+
+  // Same as operator=(expr), but assumes that e does not read this vector.
+  template<typename E>
+  static_vector& assign_noalias_(const E& e) {
+    CHECK_EQ(e.size(), N) << "static_vector: mismatched dimensions";
+    linalg_detail::static_evaluate_noalias<N>(e, data_, assign_op());
+    return *this;
+  }
+
+  value_type data_[N];
+};
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_STATIC_VECTOR_H_
@@ -0,0 +1,272 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_SYMMETRIC_MATRIX_H_
+#define INCLUDE_INSIGHT_LINALG_SYMMETRIC_MATRIX_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "insight/memory.h"
+#include "insight/linalg/vector.h"
+#include "insight/linalg/detail/eval_iterator.h"
+#include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/triangular_layout.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// Symmetric n x n matrix (e.g. a covariance matrix or a Hessian), of which
+// only the triangle Uplo is stored, either in a full n x n array (S = full)
+// or packed into n * (n + 1) / 2 elements (S = packed), i.e. about half the
+// memory of the equivalent dense matrix:
+//
+//   symmetric_matrix<double, lower, packed> H(matmul(X.t(), X));
+//   vector<double> g = matmul(H, x) - b;    // spmv, no dense copy of H.
+//
+// A symmetric matrix is a matrix expression, whose element (i, j) is read
+// from the stored triangle whichever side of the diagonal it is on. Its
+// products with a vector go through symv (full storage) or spmv (packed
+// storage) instead of gemv; the other expressions it takes part in,
+// including its products with matrices, read it elementwise. Assigning an
+// expression to it only evaluates and writes its stored triangle, the Gram
+// matrices matmul(X.t(), X) and matmul(X, X.t()) with syrk (full storage)
+// or spr (packed storage):
+//
+//   H = 0.5 * (H + H.t());
+//   H += C;                                  // C: same Uplo and S as H.
+//
+// The stored triangle is allocated by Alloc, as the elements of a matrix.
+template<typename T, triangle Uplo = lower, storage S = full,
+         typename Alloc = allocator<T> >
+class symmetric_matrix
+    : public linalg_detail::matrix_expression<
+  symmetric_matrix<T, Uplo, S, Alloc> > {
+ private:
+  using self = symmetric_matrix;
+  using layout = linalg_detail::triangular_layout<Uplo, S>;
+
+ public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = std::size_t;
+  using shape_type = std::pair<size_type, size_type>;  // NOLINT
+  using const_iterator = linalg_detail::eval_iterator<self>;
+  using iterator = const_iterator;
+
+  static_assert(linalg_detail::is_scalar<value_type>::value,
+                "symmetric_matrix<T> only accepts arithmetic and 16-bit "
+                "floating point types.");
+
+  // Constructs an empty matrix.
+  symmetric_matrix() : n_(0) {}
+
+  // Constructs an n x n symmetric matrix, all of whose elements are zero
+  // (resp. value).
+  explicit symmetric_matrix(size_type n)
+      : n_(n), data_(layout::stored_size(n), value_type(0)) {}
+
+  symmetric_matrix(size_type n, const value_type& value)
+      : n_(n), data_(layout::stored_size(n), value) {}
+
+  // Constructs a symmetric matrix from the triangle Uplo of the square
+  // matrix expression e. The other triangle of e is not read.
+  template<typename E>
+  explicit symmetric_matrix(const linalg_detail::matrix_expression<E>& e)
+      : n_(e.self().row_count()), data_(layout::stored_size(n_)) {
+    CHECK_EQ(e.self().row_count(), e.self().col_count())
+        << "symmetric_matrix: the matrix is not square";
+    assign_triangle_(e.self());
+  }
+
+  // Replaces this matrix by the triangle Uplo of the square matrix
+  // expression e. An expression that reads this matrix is evaluated into a
+  // temporary first.
+  template<typename E>
+  symmetric_matrix& operator=(const linalg_detail::matrix_expression<E>& e) {
+    CHECK_EQ(e.self().row_count(), e.self().col_count())
+        << "symmetric_matrix: the matrix is not square";
+    if (e.self().aliases(data_.data(), data_.data() + data_.size())) {
+      symmetric_matrix tmp(e.self());
+      swap(tmp);
+      return *this;
+    }
+    if (e.self().row_count() != n_) {
+      n_ = e.self().row_count();
+      data_ = vector<T, Alloc>(layout::stored_size(n_));
+    }
+    assign_triangle_(e.self());
+    return *this;
+  }
+
+  // Swaps the contents of this matrix with that of m.
+  void swap(symmetric_matrix& m) {
+    std::swap(n_, m.n_);
+    data_.swap(m.data_);
+  }
+
+  // Matrix-scalar arithmetic, applied to every element.
+
+  inline symmetric_matrix& operator+=(const_reference scalar) {
+    data_ += scalar;
+    return *this;
+  }
+
+  inline symmetric_matrix& operator-=(const_reference scalar) {
+    data_ -= scalar;
+    return *this;
+  }
+
+  inline symmetric_matrix& operator*=(const_reference scalar) {
+    data_ *= scalar;
+    return *this;
+  }
+
+  // Elementwise arithmetic with a symmetric matrix of the same size, stored
+  // the same way, i.e one stored triangle onto the other.
+
+  inline symmetric_matrix& operator+=(const symmetric_matrix& m) {
+    CHECK_EQ(n_, m.n_);
+    data_ += m.data_;
+    return *this;
+  }
+
+  inline symmetric_matrix& operator-=(const symmetric_matrix& m) {
+    CHECK_EQ(n_, m.n_);
+    data_ -= m.data_;
+    return *this;
+  }
+
+  inline symmetric_matrix& operator*=(const symmetric_matrix& m) {
+    CHECK_EQ(n_, m.n_);
+    data_ *= m.data_;
+    return *this;
+  }
+
+  inline size_type row_count() const { return n_; }
+  inline size_type col_count() const { return n_; }
+  inline size_type size() const { return n_ * n_; }
+  inline shape_type shape() const { return shape_type(n_, n_); }
+
+  // The number of elements actually stored, i.e n * n (full storage) or
+  // n * (n + 1) / 2 (packed storage).
+  inline size_type stored_size() const { return data_.size(); }
+
+  // The elements (i, j) and (j, i), which are the same stored element.
+  inline reference operator()(size_type i, size_type j) {
+    return data_[index_(i, j)];
+  }
+
+  inline const_reference operator()(size_type i, size_type j) const {
+    return data_[index_(i, j)];
+  }
+
+  // The stored triangle, laid out as described in triangular_layout.h.
+  inline value_type* data() { return data_.data(); }
+  inline const value_type* data() const { return data_.data(); }
+
+  // Returns the element at the (row-major) linear index i.
+  inline value_type eval(size_type i) const {
+    return data_[index_(i / n_, i % n_)];
+  }
+
+  // Does this matrix store any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return data_.data() < last && first < data_.data() + data_.size();
+  }
+
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, size()); }
+  inline const_iterator cbegin() const { return begin(); }
+  inline const_iterator cend() const { return end(); }
+
+  // A symmetric matrix is its own transpose.
+  inline const self& t() const { return *this; }
+
+ private:
+  size_type n_;
+  vector<T, Alloc> data_;
+
+  // Writes the triangle Uplo of the n_ x n_ expression e, which must not
+  // read this matrix, into the stored triangle. Only the elements of that
+  // triangle are evaluated: e is never expanded into a dense n_ x n_
+  // temporary.
+  template<typename E>
+  void assign_triangle_(const E& e) {
+    linalg_detail::materialized<E> m(e);
+    assign_elements_(m.get());
+  }
+
+  // matmul(X.t(), X) and matmul(X, X.t()) go through syrk (full storage) or
+  // spr (packed storage); the other products are evaluated elementwise, over
+  // their materialized operands.
+  template<typename E1, typename E2>
+  void assign_triangle_(const linalg_detail::matmul_expression<E1, E2>& e) {
+    assign_product_(e, std::integral_constant<bool,
+                    linalg_detail::special_expression::
+                    is_matmul_aAbB<
+                      linalg_detail::matmul_expression<E1, E2> >::value>());
+  }
+
+  template<typename E1, typename E2>
+  void assign_product_(const linalg_detail::matmul_expression<E1, E2>& e,
+                       std::true_type) {
+    if (!linalg_detail::special_expression::assign_symmetric_product(e,
+                                                                     this)) {
+      assign_product_(e, std::false_type());
+    }
+  }
+
+  template<typename E1, typename E2>
+  void assign_product_(const linalg_detail::matmul_expression<E1, E2>& e,
+                       std::false_type) {
+    linalg_detail::materialized<E1> m1(e.m1);
+    linalg_detail::materialized<E2> m2(e.m2);
+    using product = linalg_detail::matmul_expression<
+      typename linalg_detail::materialized<E1>::type,
+      typename linalg_detail::materialized<E2>::type>;
+    assign_elements_(product(m1.get(), m2.get()));
+  }
+
+  // The outer product matmul(u, v.t()).
+  template<typename E1, typename E2>
+  typename std::enable_if<
+    std::is_base_of<linalg_detail::vector_expression<E1>, E1>::value>::type
+  assign_product_(const linalg_detail::matmul_expression<
+                    E1, linalg_detail::transpose_expression<E2> >& e,
+                  std::false_type) {
+    linalg_detail::materialized<E1> u(e.u);
+    linalg_detail::materialized<E2> v(e.vt.e);
+    using vt_type = linalg_detail::transpose_expression<
+      typename linalg_detail::materialized<E2>::type>;
+    using product = linalg_detail::matmul_expression<
+      typename linalg_detail::materialized<E1>::type, vt_type>;
+    const vt_type vt(v.get());
+    assign_elements_(product(u.get(), vt));
+  }
+
+  template<typename E>
+  void assign_elements_(const E& e) {
+    for (size_type i = 0; i < n_; ++i) {
+      for (size_type j = 0; j < n_; ++j) {
+        if (linalg_detail::in_triangle<Uplo>(i, j)) {
+          data_[layout::index(n_, i, j)] = e.eval(i * n_ + j);
+        }
+      }
+    }
+  }
+
+  inline size_type index_(size_type i, size_type j) const {
+    return linalg_detail::in_triangle<Uplo>(i, j) ?
+        layout::index(n_, i, j) : layout::index(n_, j, i);
+  }
+};
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_SYMMETRIC_MATRIX_H_
@@ -0,0 +1,230 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_TRIANGULAR_MATRIX_H_
+#define INCLUDE_INSIGHT_LINALG_TRIANGULAR_MATRIX_H_
+
+#include <cstddef>
+#include <utility>
+
+#include "insight/memory.h"
+#include "insight/linalg/vector.h"
+#include "insight/linalg/detail/eval_iterator.h"
+#include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/transpose_expression.h"
+#include "insight/linalg/detail/triangular_layout.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// Lower (Uplo = lower) or upper (Uplo = upper) triangular n x n matrix,
+// e.g. a Cholesky factor, of which only the triangle Uplo is stored, either
+// in a full n x n array (S = full) or packed into n * (n + 1) / 2 elements
+// (S = packed):
+//
+//   triangular_matrix<double, lower, packed> L(llt.l());
+//   vector<double> y = matmul(L.t(), x);     // tpmv, no dense copy of L.
+//
+// A triangular matrix is a matrix expression whose elements outside of the
+// triangle Uplo are zero. Its products (and those of its transpose) with a
+// vector go through trmv (full storage) or tpmv (packed storage) instead of
+// gemv; the other expressions it takes part in, including its products with
+// matrices, read it elementwise. Assigning an expression to it only writes
+// its triangle Uplo, the other triangle of the expression is not read.
+//
+// The stored triangle is allocated by Alloc, as the elements of a matrix.
+template<typename T, triangle Uplo = lower, storage S = full,
+         typename Alloc = allocator<T> >
+class triangular_matrix
+    : public linalg_detail::matrix_expression<
+  triangular_matrix<T, Uplo, S, Alloc> > {
+ private:
+  using self = triangular_matrix;
+  using layout = linalg_detail::triangular_layout<Uplo, S>;
+
+ public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = std::size_t;
+  using shape_type = std::pair<size_type, size_type>;  // NOLINT
+  using const_iterator = linalg_detail::eval_iterator<self>;
+  using iterator = const_iterator;
+
+  static_assert(linalg_detail::is_scalar<value_type>::value,
+                "triangular_matrix<T> only accepts arithmetic and 16-bit "
+                "floating point types.");
+
+  // Constructs an empty matrix.
+  triangular_matrix() : n_(0) {}
+
+  // Constructs an n x n triangular matrix, all of whose elements in the
+  // triangle Uplo are zero (resp. value).
+  explicit triangular_matrix(size_type n)
+      : n_(n), data_(layout::stored_size(n), value_type(0)) {}
+
+  triangular_matrix(size_type n, const value_type& value)
+      : n_(n), data_(layout::stored_size(n), value_type(0)) {
+    for_each_in_triangle_([&](reference e) { e = value; });
+  }
+
+  // Constructs a triangular matrix from the triangle Uplo of the square
+  // matrix expression e. The other triangle of e is not read.
+  template<typename E>
+  explicit triangular_matrix(const linalg_detail::matrix_expression<E>& e)
+      : n_(e.self().row_count()),
+        data_(layout::stored_size(n_), value_type(0)) {
+    CHECK_EQ(e.self().row_count(), e.self().col_count())
+        << "triangular_matrix: the matrix is not square";
+    assign_triangle_(e.self());
+  }
+
+  // Replaces this matrix by the triangle Uplo of the square matrix
+  // expression e. An expression that reads this matrix is evaluated into a
+  // temporary first.
+  template<typename E>
+  triangular_matrix& operator=(const linalg_detail::matrix_expression<E>& e) {
+    CHECK_EQ(e.self().row_count(), e.self().col_count())
+        << "triangular_matrix: the matrix is not square";
+    if (e.self().aliases(data_.data(), data_.data() + data_.size())) {
+      triangular_matrix tmp(e.self());
+      swap(tmp);
+      return *this;
+    }
+    if (e.self().row_count() != n_) {
+      n_ = e.self().row_count();
+      data_ = vector<T, Alloc>(layout::stored_size(n_), value_type(0));
+    }
+    assign_triangle_(e.self());
+    return *this;
+  }
+
+  // Swaps the contents of this matrix with that of m.
+  void swap(triangular_matrix& m) {
+    std::swap(n_, m.n_);
+    data_.swap(m.data_);
+  }
+
+  // Matrix-scalar arithmetic, applied to every element of the triangle
+  // Uplo. The elements outside of it remain zero.
+
+  inline triangular_matrix& operator+=(const_reference scalar) {
+    for_each_in_triangle_([&](reference e) { e += scalar; });
+    return *this;
+  }
+
+  inline triangular_matrix& operator-=(const_reference scalar) {
+    for_each_in_triangle_([&](reference e) { e -= scalar; });
+    return *this;
+  }
+
+  inline triangular_matrix& operator*=(const_reference scalar) {
+    data_ *= scalar;
+    return *this;
+  }
+
+  // Elementwise arithmetic with a triangular matrix of the same size,
+  // stored the same way, i.e one stored triangle onto the other.
+
+  inline triangular_matrix& operator+=(const triangular_matrix& m) {
+    CHECK_EQ(n_, m.n_);
+    data_ += m.data_;
+    return *this;
+  }
+
+  inline triangular_matrix& operator-=(const triangular_matrix& m) {
+    CHECK_EQ(n_, m.n_);
+    data_ -= m.data_;
+    return *this;
+  }
+
+  inline triangular_matrix& operator*=(const triangular_matrix& m) {
+    CHECK_EQ(n_, m.n_);
+    data_ *= m.data_;
+    return *this;
+  }
+
+  inline size_type row_count() const { return n_; }
+  inline size_type col_count() const { return n_; }
+  inline size_type size() const { return n_ * n_; }
+  inline shape_type shape() const { return shape_type(n_, n_); }
+
+  // The number of elements actually stored, i.e n * n (full storage) or
+  // n * (n + 1) / 2 (packed storage).
+  inline size_type stored_size() const { return data_.size(); }
+
+  // The element (i, j), which must lie in the triangle Uplo.
+  inline reference operator()(size_type i, size_type j) {
+    CHECK(linalg_detail::in_triangle<Uplo>(i, j))
+        << "triangular_matrix: the element is outside of the triangle";
+    return data_[layout::index(n_, i, j)];
+  }
+
+  // The element (i, j), i.e zero outside of the triangle Uplo.
+  inline value_type operator()(size_type i, size_type j) const {
+    return linalg_detail::in_triangle<Uplo>(i, j) ?
+        data_[layout::index(n_, i, j)] : value_type(0);
+  }
+
+  // The stored triangle, laid out as described in triangular_layout.h. The
+  // other triangle of a fully stored matrix holds zeros.
+  inline value_type* data() { return data_.data(); }
+  inline const value_type* data() const { return data_.data(); }
+
+  // Returns the element at the (row-major) linear index i.
+  inline value_type eval(size_type i) const {
+    return (*this)(i / n_, i % n_);
+  }
+
+  // Does this matrix store any element in the range [first, last)?
+  inline bool aliases(const value_type* first, const value_type* last) const {
+    return data_.data() < last && first < data_.data() + data_.size();
+  }
+
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, size()); }
+  inline const_iterator cbegin() const { return begin(); }
+  inline const_iterator cend() const { return end(); }
+
+  // Returns the transpose of this matrix.
+  inline linalg_detail::transpose_expression<self> t() const {
+    return linalg_detail::transpose_expression<self>(*this);
+  }
+
+ private:
+  size_type n_;
+  vector<T, Alloc> data_;
+
+  // Applies f to every stored element of the triangle Uplo.
+  template<typename F>
+  void for_each_in_triangle_(F f) {
+    for (size_type i = 0; i < n_; ++i) {
+      for (size_type j = 0; j < n_; ++j) {
+        if (linalg_detail::in_triangle<Uplo>(i, j)) {
+          f(data_[layout::index(n_, i, j)]);
+        }
+      }
+    }
+  }
+
+  // Writes the triangle Uplo of the n_ x n_ expression e, which must not
+  // read this matrix, into the stored triangle.
+  template<typename E>
+  void assign_triangle_(const E& e) {
+    linalg_detail::materialized<E> m(e);
+    for (size_type i = 0; i < n_; ++i) {
+      for (size_type j = 0; j < n_; ++j) {
+        if (linalg_detail::in_triangle<Uplo>(i, j)) {
+          data_[layout::index(n_, i, j)] = m.get().eval(i * n_ + j);
+        }
+      }
+    }
+  }
+};
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_TRIANGULAR_MATRIX_H_
@@ -6,6 +6,7 @@
 #define INCLUDE_INSIGHT_LINALG_VECTOR_H_
 
 #include <algorithm>
+#include <cstddef>
 #include <limits>
 #include <utility>
 #include <initializer_list>
@@ -15,20 +16,26 @@
 #include "insight/memory.h"
 
 #include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/noalias.h"
+#include "insight/linalg/detail/scalar_traits.h"
 #include "insight/linalg/detail//dense_base.h"
 #include "insight/linalg/detail/blas_routines.h"
+#include "insight/linalg/detail/mixed_precision.h"
 
 #include "glog/logging.h"
 
 namespace insight {
 
 // Dense column vector.
-template<typename T, typename Alloc = allocator<T> >  // NOLINT
+//
+// Up to N elements are stored inline (see linalg_detail/dense_base.h): a
+// vector that never holds more than N elements never touches its allocator.
+template<typename T, typename Alloc = allocator<T>, std::size_t N = 0>
 class vector
-    : private linalg_detail::dense_base<T, Alloc>,
-      public linalg_detail::vector_expression<vector<T, Alloc> > {
+    : private linalg_detail::dense_base<T, Alloc, N>,
+      public linalg_detail::vector_expression<vector<T, Alloc, N> > {
  private:
-  using base = linalg_detail::dense_base<T, Alloc>;
+  using base = linalg_detail::dense_base<T, Alloc, N>;
   using self = vector;
   using alloc_traits = typename base::alloc_traits;
 
@@ -50,8 +57,9 @@ class vector
                 "Alloc::value_type must be the same as value_type");
 
   // TODO(Linh): What about complex data type?
-  static_assert(std::is_arithmetic<value_type>::value,
-                "vector<T> only accepts arithmetic types.");
+  static_assert(linalg_detail::is_scalar<value_type>::value,
+                "vector<T> only accepts arithmetic and 16-bit floating point "
+                "types.");
 
   // Constructs an empty vector. An empty vector is a vector with zero
   // number of elements.
@@ -167,6 +175,20 @@ class vector
     return this->begin_;
   }
 
+  // Returns the element at the specified (row-major) linear index. This is
+  // the random access protocol shared by all expressions (see
+  // expression_evaluator). No bounds checking is performed.
+  inline value_type eval(size_type index) const INSIGHT_NOEXCEPT {
+    return this->begin_[index];
+  }
+
+  // Returns true if the elements of this vector overlap the range
+  // [first, last) (see linalg_detail/alias.h).
+  inline bool aliases(const value_type* first, const value_type* last) const
+      INSIGHT_NOEXCEPT {
+    return this->begin_ < last && first < this->end_;
+  }
+
   // Returns the transpose of this vector.
   inline linalg_detail::transpose_expression<self> t() const {
     return linalg_detail::transpose_expression<self>(*this);
@@ -183,6 +205,13 @@ class vector
       !alloc_traits::propagate_on_container_swap::value ||
       internal::is_nothrow_swappable<allocator_type>::value);
 
+  // Returns a proxy through which an expression is assigned to (or added
+  // to, ...) this vector without checking whether the expression reads it,
+  // e.g. y.noalias() = matmul(A, x). See linalg_detail/alias.h.
+  inline linalg_detail::noalias_proxy<vector> noalias() {
+    return linalg_detail::noalias_proxy<vector>(*this);
+  }
+
   // Vector-scalar arithmetic.
 
   // Increments each and every element in the vector by the constant scalar.
@@ -200,7 +229,7 @@ class vector
   // Replaces each and every element in the vector by the result of
   // multiplication of that element and a scalar.
   inline vector& operator*=(const value_type& scalar) {
-    mul_scalar_(scalar, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    mul_scalar_(scalar, linalg_detail::has_blas_arithmetic<value_type>());
     return *this;
   }
 
@@ -217,7 +246,7 @@ class vector
   // adding that element with the corresponfing element in the vector m.
   inline vector& operator+=(const vector& m) {
     CHECK_EQ(size(), m.size());
-    add_vector_(m, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    add_vector_(m, linalg_detail::has_blas_arithmetic<value_type>());
     return *this;
   }
 
@@ -226,7 +255,7 @@ class vector
   // element.
   inline vector& operator-=(const vector& m) {
     CHECK_EQ(size(), m.size());
-    sub_vector_(m, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    sub_vector_(m, linalg_detail::has_blas_arithmetic<value_type>());
     return *this;
   }
 
@@ -234,7 +263,7 @@ class vector
   // multiplying that element and the corresponding element in the vector m.
   inline vector& operator*=(const vector& m) {
     CHECK_EQ(size(), m.size());
-    mul_vector_(m, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    mul_vector_(m, linalg_detail::has_blas_arithmetic<value_type>());
     return *this;
   }
 
@@ -292,6 +321,12 @@ class vector
   }
 
  private:
+  friend class linalg_detail::noalias_proxy<vector>;
+
+  // Same as operator=(expr), but assumes that e does not read this vector.
+  template<typename E>
+  vector& assign_noalias_(const E& e);
+
   // Allocate space for n objects.
   void allocate_memory_(size_type n);
 
@@ -364,25 +399,25 @@ class vector
   value_type dot_(const vector& v, std::false_type) const;
 };
 
-template<typename T, typename Alloc>
-vector<T, Alloc>::vector(size_type n) {
+template<typename T, typename Alloc, std::size_t N>
+vector<T, Alloc, N>::vector(size_type n) {
   if (n > 0) {
     allocate_memory_(n);
     construct_at_end_(n);
   }
 }
 
-template<typename T, typename Alloc>
-vector<T, Alloc>::vector(size_type n, const value_type& value) {
+template<typename T, typename Alloc, std::size_t N>
+vector<T, Alloc, N>::vector(size_type n, const value_type& value) {
   if (n > 0) {
     allocate_memory_(n);
     construct_at_end_(n, value);
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 template<typename ForwardIter>
-vector<T, Alloc>::vector(ForwardIter first, ForwardIter last,
+vector<T, Alloc, N>::vector(ForwardIter first, ForwardIter last,
                          typename
                          std::enable_if<
                          internal::is_forward_iterator<ForwardIter>::value &&
@@ -395,8 +430,8 @@ vector<T, Alloc>::vector(ForwardIter first, ForwardIter last,
   }
 }
 
-template<typename T, typename Alloc>
-vector<T, Alloc>::vector(const vector& m)
+template<typename T, typename Alloc, std::size_t N>
+vector<T, Alloc, N>::vector(const vector& m)
     : base(alloc_traits::select_on_container_copy_construction(m.alloc_)) {
   size_type n = m.size();
   if (n > 0) {
@@ -405,10 +440,10 @@ vector<T, Alloc>::vector(const vector& m)
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-vector<T, Alloc>&
-vector<T, Alloc>::operator=(const vector& m) {
+vector<T, Alloc, N>&
+vector<T, Alloc, N>::operator=(const vector& m) {
   if (this != &m) {
     base::copy_assign_alloc_(m);
     assign_(m.begin_, m.end_);
@@ -416,34 +451,31 @@ vector<T, Alloc>::operator=(const vector& m) {
   return *this;
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-vector<T, Alloc>::vector(vector&& m) INSIGHT_NOEXCEPT_IF(
+vector<T, Alloc, N>::vector(vector&& m) INSIGHT_NOEXCEPT_IF(
     std::is_nothrow_move_constructible<allocator_type>::value)
     :   base(std::move(m.alloc_)) {
-  this->begin_ = m.begin_;
-  this->end_ = m.end_;
-  this->end_cap_ = m.end_cap_;
-  m.begin_ = m.end_ = m.end_cap_ = nullptr;
+  base::steal_(m);
 }
 
 // TODO(Linh): If propagate_on_container_move_assignment is false,
 // then the `false` version of move_assign_ will be called, but
 // for this version to be nothrow we need alloc_traits::is_always_equal is
 // true, unforturenately this feature is only available since C++17?
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-vector<T, Alloc>&
-vector<T, Alloc>::operator=(vector&& m) INSIGHT_NOEXCEPT_IF(
+vector<T, Alloc, N>&
+vector<T, Alloc, N>::operator=(vector&& m) INSIGHT_NOEXCEPT_IF(
     alloc_traits::propagate_on_container_move_assignment::value &&
     std::is_nothrow_move_assignable<allocator_type>::value) {
   move_assign_(m, std::integral_constant<bool, alloc_traits::propagate_on_container_move_assignment::value>());  // NOLINT
   return *this;
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-vector<T, Alloc>::vector(std::initializer_list<value_type> il) {
+vector<T, Alloc, N>::vector(std::initializer_list<value_type> il) {
   size_type n = il.size();
   if (n > 0) {
     allocate_memory_(n);
@@ -451,51 +483,73 @@ vector<T, Alloc>::vector(std::initializer_list<value_type> il) {
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-vector<T, Alloc>&
-vector<T, Alloc>::operator=(std::initializer_list<value_type> il) {
+vector<T, Alloc, N>&
+vector<T, Alloc, N>::operator=(std::initializer_list<value_type> il) {
   assign_(il.begin(), il.end());
   return *this;
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 template<typename E>
-vector<T, Alloc>::vector(const linalg_detail::vector_expression<E>& expr) {
+vector<T, Alloc, N>::vector(const linalg_detail::vector_expression<E>& expr) {
   size_type n = expr.self().size();
   if (n > 0) {
     allocate_memory_(n);
     linalg_detail::expression_evaluator<E> evaluator(expr.self());
-    evaluator.assign(this->begin_);
+    evaluator.assign_noalias(this->begin_);
     this->end_ = this->begin_ + n;
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 template<typename E>
-vector<T, Alloc>&
-vector<T, Alloc>::operator=(const linalg_detail::vector_expression<E>& expr) {
-  size_type new_size = expr.self().size();
+vector<T, Alloc, N>&
+vector<T, Alloc, N>::operator=(const linalg_detail::vector_expression<E>& expr) {
+  const E& e = expr.self();
+  size_type new_size = e.size();
   if (new_size > capacity()) {
+    if (e.aliases(this->begin_, this->end_)) {
+      // e reads the memory that is about to be released.
+      vector v(e);
+      swap(v);
+      return *this;
+    }
     deallocate_memory_();
     allocate_memory_(new_size);
   }
-  linalg_detail::expression_evaluator<E> evaluator(expr.self());
+  linalg_detail::expression_evaluator<E> evaluator(e);
   evaluator.assign(this->begin_);
   this->end_ = this->begin_ + new_size;
   return *this;
 }
 
-template<typename T, typename Alloc>
-typename vector<T, Alloc>::size_type
-vector<T, Alloc>::max_size() const INSIGHT_NOEXCEPT {
+template<typename T, typename Alloc, std::size_t N>
+template<typename E>
+vector<T, Alloc, N>&
+vector<T, Alloc, N>::assign_noalias_(const E& e) {
+  size_type new_size = e.size();
+  if (new_size > capacity()) {
+    deallocate_memory_();
+    allocate_memory_(new_size);
+  }
+  linalg_detail::expression_evaluator<E> evaluator(e);
+  evaluator.assign_noalias(this->begin_);
+  this->end_ = this->begin_ + new_size;
+  return *this;
+}
+
+template<typename T, typename Alloc, std::size_t N>
+typename vector<T, Alloc, N>::size_type
+vector<T, Alloc, N>::max_size() const INSIGHT_NOEXCEPT {
   return std::min<size_type>(alloc_traits::max_size(this->alloc_),
                              std::numeric_limits<difference_type>::max());
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-vector<T, Alloc>::swap(vector& m) INSIGHT_NOEXCEPT_IF(
+vector<T, Alloc, N>::swap(vector& m) INSIGHT_NOEXCEPT_IF(
     !alloc_traits::propagate_on_container_swap::value ||
     internal::is_nothrow_swappable<allocator_type>::value) {
   DCHECK(alloc_traits::propagate_on_container_swap::value ||
@@ -503,9 +557,7 @@ vector<T, Alloc>::swap(vector& m) INSIGHT_NOEXCEPT_IF(
       << "vector::swap Either propagate_on_container_swap must be true "
       << "or the allocators must compare equal";
   using std::swap;
-  swap(this->begin_, m.begin_);
-  swap(this->end_, m.end_);
-  swap(this->end_cap_, m.end_cap_);
+  base::swap_storage_(m);
   // The two allocators will be swapped iff propagate_on_container_swap is
   // true, otherwise nothing happens (that's why we need them compare
   // equal).
@@ -517,29 +569,27 @@ vector<T, Alloc>::swap(vector& m) INSIGHT_NOEXCEPT_IF(
 // throws (probablY bad_alloc) if memory run out
 // Precondition: begin_ == end_ == end_cap_ == 0
 // Precondition: n > 0
-// Postcondition: capacity() == n
+// Postcondition: capacity() >= n
 // Postcondition: size() == 0
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-vector<T, Alloc>::allocate_memory_(size_type n) {
+vector<T, Alloc, N>::allocate_memory_(size_type n) {
   // TODO(Linh): throw or CHECK?
   if (n > max_size())
     this->throw_length_error("vector::allocate_memory_(n): "
                              "the requested size n is too large");
-  this->begin_ = this->end_ = alloc_traits::allocate(this->alloc_, n);
-  this->end_cap_ = this->begin_ + n;
+  base::allocate_(n);
 }
 
 // Deallocate memory.
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-vector<T, Alloc>::deallocate_memory_() INSIGHT_NOEXCEPT {
+vector<T, Alloc, N>::deallocate_memory_() INSIGHT_NOEXCEPT {
   if (this->begin_ != nullptr) {
     // TODO(Linh): Can we just skip the clear step since we're only dealing
     // with arithmetic types?
     clear();
-    alloc_traits::deallocate(this->alloc_, this->begin_, capacity());
-    this->begin_ = this->end_ = this->end_cap_ = nullptr;
+    base::deallocate_();
   }
 }
 
@@ -548,9 +598,9 @@ vector<T, Alloc>::deallocate_memory_() INSIGHT_NOEXCEPT {
 // Precondition: n > 0
 // Precondition: size() + n <= capacity()
 // Postcondition: size() == size() + n
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-vector<T, Alloc>::construct_at_end_(size_type n) {
+vector<T, Alloc, N>::construct_at_end_(size_type n) {
   // TODO(Linh): Can we replace the do-while loop with std::fill since we're
   // only dealing with arithmetic types? How about std::uninitialized_fill?
   // do {
@@ -568,9 +618,9 @@ vector<T, Alloc>::construct_at_end_(size_type n) {
 // Precondition: size() + n <= capacity().
 // Postcondition: size() = old size() + n
 // Postcondition: [i] == value for all i in [size() - n, size()]
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-vector<T, Alloc>::construct_at_end_(size_type n, const_reference value) {
+vector<T, Alloc, N>::construct_at_end_(size_type n, const_reference value) {
   // TODO(Linh): Can we replace the do-while loop with std::fill since we're
   // only dealing with arithmetic types? How about std::uninitialized_fill?
   // do {
@@ -582,11 +632,11 @@ vector<T, Alloc>::construct_at_end_(size_type n, const_reference value) {
   std::fill(this->begin_, this->end_, value);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 template<typename ForwardIter>
 typename
 std::enable_if<internal::is_forward_iterator<ForwardIter>::value, void>::type
-vector<T, Alloc>::construct_at_end_(ForwardIter first, ForwardIter last) {
+vector<T, Alloc, N>::construct_at_end_(ForwardIter first, ForwardIter last) {
   // TODO(Linh): Can we replace the do-while loop with std::copy since we're
   // only dealing with arithmetic types? How about std::uninitialized_copy?
   // for (; first != last; ++first, ++this->end_) {
@@ -597,7 +647,7 @@ vector<T, Alloc>::construct_at_end_(ForwardIter first, ForwardIter last) {
 
 // Replaces the contents of the buffer with that in the range [first, last).
 // Memory allocated if neccessary.
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 template<typename ForwardIter>
 typename
 std::enable_if<
@@ -606,7 +656,7 @@ std::enable_if<
     T,
     typename std::iterator_traits<ForwardIter>::reference>::value,
   void>::type
-vector<T, Alloc>::assign_(ForwardIter first, ForwardIter last) {
+vector<T, Alloc, N>::assign_(ForwardIter first, ForwardIter last) {
   size_type new_size = static_cast<size_type>(std::distance(first, last));
   if (new_size <= capacity()) {
     // ForwardIter mid = last;
@@ -630,24 +680,21 @@ vector<T, Alloc>::assign_(ForwardIter first, ForwardIter last) {
   }
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-vector<T, Alloc>::move_assign_(vector& m, std::true_type)  // NOLINT
+vector<T, Alloc, N>::move_assign_(vector& m, std::true_type)  // NOLINT
     INSIGHT_NOEXCEPT_IF(
         std::is_nothrow_move_assignable<allocator_type>::value) {
   deallocate_memory_();
   base::move_assign_alloc_(m);
-  this->begin_ = m.begin_;
-  this->end_ = m.end_;
-  this->end_cap_ = m.end_cap_;
-  m.begin_ = m.end_ = m.end_cap_ = nullptr;
+  base::steal_(m);
 }
 
 // TODO(Linh): This will be nothrow if alloc_traits::is_always_equal is true
 // but this feature is only available since C++17.
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 void
-vector<T, Alloc>::move_assign_(vector& m, std::false_type) {  // NOLINT
+vector<T, Alloc, N>::move_assign_(vector& m, std::false_type) {  // NOLINT
   // when propagate_on_container_move_assignment is false allocator will be
   // kept (no replacement happens) therefore we need to check to see wehther
   // this's allocator and m's allocator are in deed the same.
@@ -661,9 +708,9 @@ vector<T, Alloc>::move_assign_(vector& m, std::false_type) {  // NOLINT
 }
 
 // In addition to the public member swap, we also need a free swap function.
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-void swap(vector<T, Alloc>& m1, vector<T, Alloc>& m2) INSIGHT_NOEXCEPT_IF(
+void swap(vector<T, Alloc, N>& m1, vector<T, Alloc, N>& m2) INSIGHT_NOEXCEPT_IF(
     noexcept(m1.swap(m2))) {
   m1.swap(m2);
 }
@@ -671,124 +718,120 @@ void swap(vector<T, Alloc>& m1, vector<T, Alloc>& m2) INSIGHT_NOEXCEPT_IF(
 
 // vector-scalar arithmetic.
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::mul_scalar_(const value_type& scalar, std::true_type) {
+vector<T, Alloc, N>::mul_scalar_(const value_type& scalar, std::true_type) {
   linalg_detail::blas_scal(size(), scalar, this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::mul_scalar_(const value_type& scalar, std::false_type) {
+vector<T, Alloc, N>::mul_scalar_(const value_type& scalar, std::false_type) {
   std::for_each(this->begin_, this->end_, [&](reference e) { e *= scalar; });
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::div_scalar_(const value_type& scalar, std::true_type) {
+vector<T, Alloc, N>::div_scalar_(const value_type& scalar, std::true_type) {
   linalg_detail::blas_scal(size(), value_type(1.0) / scalar, this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::div_scalar_(const value_type& scalar, std::false_type) {
+vector<T, Alloc, N>::div_scalar_(const value_type& scalar, std::false_type) {
   std::for_each(this->begin_, this->end_, [&](reference e) { e /= scalar; });
 }
 
 // vector-vector arithmetic.
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::add_vector_(const vector& m, std::true_type) {
+vector<T, Alloc, N>::add_vector_(const vector& m, std::true_type) {
   linalg_detail::blas_add(size(), m.data(), this->begin_, this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::add_vector_(const vector& m, std::false_type) {
+vector<T, Alloc, N>::add_vector_(const vector& m, std::false_type) {
   auto it = m.begin();
   std::for_each(this->begin_, this->end_, [&](reference e) { e += *it++; });
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::sub_vector_(const vector& m, std::true_type) {
+vector<T, Alloc, N>::sub_vector_(const vector& m, std::true_type) {
   linalg_detail::blas_sub(size(), this->begin_, m.data(), this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::sub_vector_(const vector& m, std::false_type) {
+vector<T, Alloc, N>::sub_vector_(const vector& m, std::false_type) {
   auto it = m.begin();
   std::for_each(this->begin_, this->end_, [&](reference e) { e -= *it++; });
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::mul_vector_(const vector& m, std::true_type) {
+vector<T, Alloc, N>::mul_vector_(const vector& m, std::true_type) {
   linalg_detail::blas_mul(size(), m.data(), this->begin_, this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::mul_vector_(const vector& m, std::false_type) {
+vector<T, Alloc, N>::mul_vector_(const vector& m, std::false_type) {
   auto it = m.begin();
   std::for_each(this->begin_, this->end_, [&](reference e) { e *= *it++; });
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::div_vector_(const vector& m, std::true_type) {
+vector<T, Alloc, N>::div_vector_(const vector& m, std::true_type) {
   linalg_detail::blas_div(size(), this->begin_, m.data(), this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 void
-vector<T, Alloc>::div_vector_(const vector& m, std::false_type) {  // NOLINT
+vector<T, Alloc, N>::div_vector_(const vector& m, std::false_type) {  // NOLINT
   auto it = m.begin();
   std::for_each(this->begin_, this->end_, [&](reference e) { e /= *it++; });
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
-T vector<T, Alloc>::nrm2_(std::true_type) const {
+T vector<T, Alloc, N>::nrm2_(std::true_type) const {
   return  linalg_detail::blas_nrm2(size(), this->begin_);
 }
 
-template<typename T, typename Alloc>
-T vector<T, Alloc>::nrm2_(std::false_type) const {
-  auto op = [](const_reference partial, const_reference val) {
-              return partial + val * val;
-            };
-  value_type sum_of_squares =
-      std::accumulate(this->begin_, this->end_, value_type(0.0), op);
-  return std::sqrt(sum_of_squares);
+template<typename T, typename Alloc, std::size_t N>
+T vector<T, Alloc, N>::nrm2_(std::false_type) const {
+  return linalg_detail::dense_nrm2(static_cast<int>(size()), this->begin_);
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 T
-vector<T, Alloc>::dot_(const vector& v, std::true_type) const {
+vector<T, Alloc, N>::dot_(const vector& v, std::true_type) const {
   return  linalg_detail::blas_dot(size(), this->begin_, v.data());
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, std::size_t N>
 inline
 T
-vector<T, Alloc>::dot_(const vector& v, std::false_type) const {
-  return std::inner_product(begin(), end(), v.begin(), value_type(0.0));
+vector<T, Alloc, N>::dot_(const vector& v, std::false_type) const {
+  return linalg_detail::dense_dot(static_cast<int>(size()), this->begin_,
+                                  v.data());
 }
 
 }  // namespace insight
@@ -0,0 +1,299 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INCLUDE_INSIGHT_LINALG_VECTOR_MAP_H_
+#define INCLUDE_INSIGHT_LINALG_VECTOR_MAP_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+#include "insight/internal/port.h"
+
+#include "insight/linalg/detail/expression_evaluator.h"
+#include "insight/linalg/detail/noalias.h"
+#include "insight/linalg/detail/scalar_traits.h"
+#include "insight/linalg/detail/blas_routines.h"
+#include "insight/linalg/detail/mixed_precision.h"
+#include "insight/linalg/detail/strided_evaluator.h"
+
+#include "glog/logging.h"
+
+namespace insight {
+
+// Dense column vector over n contiguous elements that it does not own,
+// e.g. the raw `const double* x` and `double* gradient` buffers of an
+// objective function:
+//
+//   vector_map<const double> x_map(x, n);
+//   vector_map<double> g_map(gradient, n);
+//   g_map = matmul(A, x_map) - b;
+//
+// A map takes part in expressions like a vector does, including the BLAS
+// fast paths, but never (re)allocates: assigning to it writes its
+// elements, and requires the shapes to match. A vector_map<const T> is
+// read-only: the members that write its elements are not available.
+template<typename T>
+class vector_map
+    : public linalg_detail::vector_expression<vector_map<T> > {
+ private:
+  using self = vector_map;
+
+  // R, if the mapped elements can be written, i.e T is not const. U stands
+  // for T, so that the members using it are SFINAE'd out rather than
+  // ill-formed for a vector_map<const T>.
+  template<typename U, typename R>
+  using if_mutable_ = typename std::enable_if<!std::is_const<U>::value,
+                                              R>::type;
+
+ public:
+  using value_type = typename std::remove_const<T>::type;
+  using reference = T&;
+  using const_reference = const value_type&;
+  using size_type = std::size_t;
+  using shape_type = std::pair<size_type, size_type>;  // NOLINT
+  using difference_type = std::ptrdiff_t;
+  using pointer = T*;
+  using const_pointer = const value_type*;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+
+  static_assert(linalg_detail::is_scalar<value_type>::value,
+                "vector_map<T> only accepts arithmetic and 16-bit floating "
+                "point types.");
+
+  // Maps the n elements starting at data.
+  vector_map(pointer data, size_type n) INSIGHT_NOEXCEPT
+      : data_(data), size_(n) {}
+
+  // Copies the elements of m into the elements of this map (does not
+  // rebind it).
+  vector_map& operator=(const vector_map& m) {
+    static_assert(!std::is_const<T>::value,
+                  "vector_map<const T> is read-only.");
+    return *this = static_cast<
+        const linalg_detail::vector_expression<vector_map>&>(m);
+  }
+
+  // Evaluates the expression expr, of the same size, into the elements of
+  // this map.
+  template<typename E, typename U = T>
+  if_mutable_<U, vector_map&>
+  operator=(const linalg_detail::vector_expression<E>& expr) {
+    CHECK_EQ(size(), expr.self().size())
+        << "vector_map: mismatched dimensions";
+    linalg_detail::expression_evaluator<E> evaluator(expr.self());
+    evaluator.assign(data_);
+    return *this;
+  }
+
+  // Iterators.
+
+  inline iterator begin() INSIGHT_NOEXCEPT { return data_; }
+  inline const_iterator begin() const INSIGHT_NOEXCEPT { return data_; }
+  inline iterator end() INSIGHT_NOEXCEPT { return data_ + size_; }
+  inline const_iterator end() const INSIGHT_NOEXCEPT {
+    return data_ + size_;
+  }
+
+  inline const_iterator cbegin() const INSIGHT_NOEXCEPT { return begin(); }
+  inline const_iterator cend() const INSIGHT_NOEXCEPT { return end(); }
+
+  inline size_type row_count() const INSIGHT_NOEXCEPT { return size_; }
+  inline size_type col_count() const INSIGHT_NOEXCEPT {
+    return size_ > 0 ? 1 : 0;
+  }
+  inline const shape_type shape() const INSIGHT_NOEXCEPT {
+    return std::make_pair(row_count(), col_count());
+  }
+
+  // Returns the number of elements in the map.
+  inline size_type size() const INSIGHT_NOEXCEPT { return size_; }
+
+  inline bool empty() const INSIGHT_NOEXCEPT { return size_ == 0; }
+
+  // Returns a reference to the element at the specified index.
+  // No bounds checking is performed.
+  inline reference operator[](size_type index) INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  inline const_reference operator[](size_type index) const INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  // Returns the pointer to the mapped array.
+  inline pointer data() INSIGHT_NOEXCEPT { return data_; }
+  inline const value_type* data() const INSIGHT_NOEXCEPT { return data_; }
+
+  // Returns the element at the specified index (see expression_evaluator).
+  // No bounds checking is performed.
+  inline value_type eval(size_type index) const INSIGHT_NOEXCEPT {
+    return data_[index];
+  }
+
+  // Returns true if the mapped elements overlap the range [first, last)
+  // (see linalg_detail/alias.h).
+  inline bool aliases(const value_type* first, const value_type* last) const
+      INSIGHT_NOEXCEPT {
+    return data_ < last && first < data_ + size_;
+  }
+
+  // Returns the transpose of this map.
+  inline linalg_detail::transpose_expression<self> t() const {
+    return linalg_detail::transpose_expression<self>(*this);
+  }
+
+  // Returns a proxy through which an expression is assigned to (or added
+  // to, ...) this map without checking whether the expression reads it.
+  // See linalg_detail/alias.h.
+  template<typename U = T>
+  inline if_mutable_<U, linalg_detail::noalias_proxy<vector_map> > noalias() {
+    return linalg_detail::noalias_proxy<vector_map>(*this);
+  }
+
+  // Map-scalar arithmetic.
+
+  template<typename U = T>
+  inline if_mutable_<U, vector_map&> operator+=(const value_type& scalar) {
+    std::for_each(begin(), end(), [&](reference e) { e += scalar; });
+    return *this;
+  }
+
+  template<typename U = T>
+  inline if_mutable_<U, vector_map&> operator-=(const value_type& scalar) {
+    std::for_each(begin(), end(), [&](reference e) { e -= scalar; });
+    return *this;
+  }
+
+  template<typename U = T>
+  inline if_mutable_<U, vector_map&> operator*=(const value_type& scalar) {
+    mul_scalar_(scalar, linalg_detail::has_blas_arithmetic<value_type>());
+    return *this;
+  }
+
+  template<typename U = T>
+  inline if_mutable_<U, vector_map&> operator/=(const value_type& scalar) {
+    div_scalar_(scalar, std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+    return *this;
+  }
+
+  // Map-expression arithmetic.
+
+  template<typename E, typename U = T>
+  inline if_mutable_<U, vector_map&>
+  operator+=(const linalg_detail::vector_expression<E>& expr) {
+    CHECK_EQ(size(), expr.self().size())
+        << "vector_map: mismatched dimensions";
+    linalg_detail::expression_evaluator<E>(expr.self()).add(data_);
+    return *this;
+  }
+
+  template<typename E, typename U = T>
+  inline if_mutable_<U, vector_map&>
+  operator-=(const linalg_detail::vector_expression<E>& expr) {
+    CHECK_EQ(size(), expr.self().size())
+        << "vector_map: mismatched dimensions";
+    linalg_detail::expression_evaluator<E>(expr.self()).sub(data_);
+    return *this;
+  }
+
+  template<typename E, typename U = T>
+  inline if_mutable_<U, vector_map&>
+  operator*=(const linalg_detail::vector_expression<E>& expr) {
+    CHECK_EQ(size(), expr.self().size())
+        << "vector_map: mismatched dimensions";
+    linalg_detail::expression_evaluator<E>(expr.self()).mul(data_);
+    return *this;
+  }
+
+  template<typename E, typename U = T>
+  inline if_mutable_<U, vector_map&>
+  operator/=(const linalg_detail::vector_expression<E>& expr) {
+    CHECK_EQ(size(), expr.self().size())
+        << "vector_map: mismatched dimensions";
+    linalg_detail::expression_evaluator<E>(expr.self()).div(data_);
+    return *this;
+  }
+
+  // Returns the L2-norm of the mapped vector.
+  inline value_type nrm2() const {
+    return nrm2_(std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+  }
+
+  // Returns the dot product of the mapped vector with the vector expression
+  // e, of the same size: with dot for a dense vector, through strided_dot
+  // (see strided_evaluator.h) otherwise.
+  template<typename E>
+  inline value_type dot(const linalg_detail::vector_expression<E>& e) const {
+    CHECK_EQ(size(), e.self().size());
+    return dot_(e.self(), std::integral_constant<
+                bool, linalg_detail::is_dense_vector<E>::value>());
+  }
+
+ private:
+  friend class linalg_detail::noalias_proxy<vector_map>;
+
+  // Same as operator=(expr), but assumes that e does not read this map.
+  template<typename E>
+  vector_map& assign_noalias_(const E& e) {
+    CHECK_EQ(size(), e.size()) << "vector_map: mismatched dimensions";
+    linalg_detail::expression_evaluator<E>(e).assign_noalias(data_);
+    return *this;
+  }
+
+  inline void mul_scalar_(const value_type& scalar, std::true_type) {
+    linalg_detail::blas_scal(static_cast<int>(size_), scalar, data_);
+  }
+
+  inline void mul_scalar_(const value_type& scalar, std::false_type) {
+    std::for_each(begin(), end(), [&](reference e) { e *= scalar; });
+  }
+
+  inline void div_scalar_(const value_type& scalar, std::true_type) {
+    linalg_detail::blas_scal(static_cast<int>(size_), value_type(1) / scalar,
+                             data_);
+  }
+
+  inline void div_scalar_(const value_type& scalar, std::false_type) {
+    std::for_each(begin(), end(), [&](reference e) { e /= scalar; });
+  }
+
+  inline value_type nrm2_(std::true_type) const {
+    return linalg_detail::blas_nrm2(size_, data_);
+  }
+
+  inline value_type nrm2_(std::false_type) const {
+    return linalg_detail::dense_nrm2(static_cast<int>(size_),
+                                     static_cast<const value_type*>(data_));
+  }
+
+  template<typename E>
+  inline value_type dot_(const E& v, std::true_type) const {
+    return dense_dot_(v.data(), std::integral_constant<bool, std::is_floating_point<value_type>::value>());  // NOLINT
+  }
+
+  template<typename E>
+  inline value_type dot_(const E& e, std::false_type) const {
+    return linalg_detail::strided_dot(*this, e);
+  }
+
+  inline value_type dense_dot_(const value_type* y, std::true_type) const {
+    return linalg_detail::blas_dot(size_, data_, y);
+  }
+
+  inline value_type dense_dot_(const value_type* y, std::false_type) const {
+    return linalg_detail::dense_dot(static_cast<int>(size_),
+                                    static_cast<const value_type*>(data_), y);
+  }
+
+  pointer data_;
+  size_type size_;
+};
+
+}  // namespace insight
+#endif  // INCLUDE_INSIGHT_LINALG_VECTOR_MAP_H_
@@ -0,0 +1,242 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <memory>
+#include <vector>
+
+#include "insight/linalg/matrix.h"
+#include "insight/linalg/vector.h"
+#include "insight/linalg/static_matrix.h"
+#include "insight/linalg/static_vector.h"
+#include "insight/linalg/functions.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+
+namespace {
+using linalg_detail::is_elementwise;
+using fmat = matrix<float>;
+using fvec = vector<float>;
+using plus = std::plus<float>;
+}  // namespace
+
+TEST(alias, is_elementwise) {
+  EXPECT_TRUE(is_elementwise<fvec>::value);
+  EXPECT_TRUE(is_elementwise<fmat>::value);
+  EXPECT_TRUE((is_elementwise<static_vector<float, 3> >::value));
+  EXPECT_TRUE((is_elementwise<static_matrix<float, 2, 3> >::value));
+  EXPECT_TRUE((is_elementwise<
+               linalg_detail::binary_expression<fvec, fvec, plus> >::value));
+  EXPECT_TRUE((is_elementwise<
+               linalg_detail::binary_expression<fmat, float, plus> >::value));
+  EXPECT_TRUE((is_elementwise<
+               linalg_detail::binary_expression<float, fmat, plus> >::value));
+  EXPECT_TRUE((is_elementwise<
+               linalg_detail::unary_expression<
+               fvec, linalg_detail::sqrt<float> > >::value));
+  EXPECT_TRUE((is_elementwise<
+               linalg_detail::transpose_expression<fvec> >::value));
+
+  EXPECT_FALSE((is_elementwise<
+                linalg_detail::transpose_expression<fmat> >::value));
+  EXPECT_FALSE(is_elementwise<linalg_detail::row_view<fmat> >::value);
+  EXPECT_FALSE(is_elementwise<linalg_detail::col_view<fmat> >::value);
+  EXPECT_FALSE((is_elementwise<
+                linalg_detail::matmul_expression<fmat, fvec> >::value));
+  EXPECT_FALSE((is_elementwise<
+                linalg_detail::binary_expression<
+                linalg_detail::matmul_expression<fmat, fvec>,
+                fvec, plus> >::value));
+}
+
+TEST(alias, requires_temporary) {
+  fmat A = {{1, 2}, {3, 4}};
+  fvec x = {1, 1};
+  fvec y = {1, 1};
+
+  const float* x0 = x.data();
+  const float* x1 = x.data() + x.size();
+
+  EXPECT_FALSE(linalg_detail::requires_temporary(2.0f * x + y, x0, x1));
+  EXPECT_FALSE(linalg_detail::requires_temporary(matmul(A, y), x0, x1));
+  EXPECT_TRUE(linalg_detail::requires_temporary(matmul(A, x), x0, x1));
+  EXPECT_TRUE(linalg_detail::requires_temporary(matmul(A, x) + y, x0, x1));
+  EXPECT_FALSE(linalg_detail::requires_temporary(matmul(A, y) + x, x0, x1));
+  EXPECT_TRUE(linalg_detail::requires_temporary(A.col_at(0),
+                                                A.data(), A.data() + 1));
+}
+
+TEST(alias, vector_equals_matmul_of_itself) {
+  fmat A = {{1, 2}, {3, 4}};
+  fvec x = {1, 2};
+
+  x = matmul(A, x);
+  EXPECT_THAT(x, ElementsAre(5, 11));
+
+  x += matmul(A, x);
+  EXPECT_THAT(x, ElementsAre(5 + 27, 11 + 59));
+
+  fvec y = {1, 1};
+  x = {1, 2};
+  x = matmul(A, x) + y;
+  EXPECT_THAT(x, ElementsAre(6, 12));
+
+  // Not aliased: evaluated in place with beta = 1.
+  x = {1, 2};
+  y = matmul(A, x) + y;
+  EXPECT_THAT(y, ElementsAre(6, 12));
+}
+
+TEST(alias, vector_grows_from_matmul_of_itself) {
+  fmat A = {{1, 0}, {0, 1}, {1, 1}};
+  fvec x = {2, 3};
+
+  x = matmul(A, x);
+  EXPECT_EQ(x.size(), 3);
+  EXPECT_THAT(x, ElementsAre(2, 3, 5));
+}
+
+TEST(alias, matrix_equals_its_transpose) {
+  fmat A = {{1, 2}, {3, 4}};
+  A = A.t();
+  EXPECT_THAT(A, ElementsAre(1, 3, 2, 4));
+
+  A += A.t();
+  EXPECT_THAT(A, ElementsAre(2, 5, 5, 8));
+
+  fmat B = {{1, 2, 3}, {4, 5, 6}};
+  B = B.t();
+  EXPECT_EQ(B.row_count(), 3);
+  EXPECT_EQ(B.col_count(), 2);
+  EXPECT_THAT(B, ElementsAre(1, 4, 2, 5, 3, 6));
+
+  fmat C = {{1, 2, 3}, {4, 5, 6}};
+  C = 2.0f * C.t() + 1.0f;
+  EXPECT_THAT(C, ElementsAre(3, 9, 5, 11, 7, 13));
+}
+
+TEST(alias, matrix_equals_matmul_of_itself) {
+  fmat A = {{1, 2}, {3, 4}};
+  fmat B = {{1, 1}, {0, 1}};
+
+  A = matmul(A, B);
+  EXPECT_THAT(A, ElementsAre(1, 3, 3, 7));
+
+  A = matmul(B, A);
+  EXPECT_THAT(A, ElementsAre(4, 10, 3, 7));
+}
+
+TEST(alias, views_of_the_destination) {
+  fmat A = {{1, 2, 3}, {4, 5, 6}};
+  A = A.row_at(1) * 2.0f;
+  EXPECT_EQ(A.row_count(), 1);
+  EXPECT_EQ(A.col_count(), 3);
+  EXPECT_THAT(A, ElementsAre(8, 10, 12));
+
+  fmat B = {{1, 2, 3}, {4, 5, 6}};
+  B = B.col_at(1).t() + 1.0f;
+  EXPECT_EQ(B.row_count(), 1);
+  EXPECT_EQ(B.col_count(), 2);
+  EXPECT_THAT(B, ElementsAre(3, 6));
+
+  fmat C = {{1, 2}, {3, 4}};
+  C -= C.t();
+  EXPECT_THAT(C, ElementsAre(0, -1, 1, 0));
+}
+
+TEST(alias, elementwise_stays_in_place) {
+  fvec x = {1, 4, 9};
+  fvec y = {1, 1, 1};
+  const float* data = x.data();
+
+  x = sqrt(x) + 2.0f * y;
+  EXPECT_EQ(x.data(), data);
+  EXPECT_THAT(x, ElementsAre(3, 4, 5));
+
+  x *= x - y;
+  EXPECT_EQ(x.data(), data);
+  EXPECT_THAT(x, ElementsAre(6, 12, 20));
+}
+
+TEST(alias, noalias) {
+  fmat A = {{1, 2}, {3, 4}};
+  fvec x = {1, 2};
+  fvec y(2, 0.0f);
+
+  y.noalias() = matmul(A, x);
+  EXPECT_THAT(y, ElementsAre(5, 11));
+
+  y.noalias() += matmul(A, x);
+  EXPECT_THAT(y, ElementsAre(10, 22));
+
+  y.noalias() -= 2.0f * x;
+  EXPECT_THAT(y, ElementsAre(8, 18));
+
+  y.noalias() *= x;
+  EXPECT_THAT(y, ElementsAre(8, 36));
+
+  y.noalias() /= x;
+  EXPECT_THAT(y, ElementsAre(8, 18));
+
+  fvec z;
+  z.noalias() = matmul(A, x) + y;
+  EXPECT_THAT(z, ElementsAre(13, 29));
+
+  fmat C;
+  C.noalias() = matmul(A, A.t());
+  EXPECT_EQ(C.row_count(), 2);
+  EXPECT_EQ(C.col_count(), 2);
+  EXPECT_THAT(C, ElementsAre(5, 11, 11, 25));
+}
+
+TEST(alias, scratch_buffer_is_reused) {
+  const float* first;
+  {
+    linalg_detail::scratch_buffer<float> a(16);
+    first = a.data();
+    // Nested buffers get their own storage.
+    linalg_detail::scratch_buffer<float> b(16);
+    EXPECT_NE(b.data(), a.data());
+  }
+  {
+    linalg_detail::scratch_buffer<float> a(8);
+    EXPECT_EQ(a.data(), first);
+  }
+}
+
+TEST(alias, scratch_buffer_survives_pool_growth) {
+  linalg_detail::scratch_buffer<double> a(4);
+  double* data = a.data();
+  data[3] = 42.0;
+  {
+    // Enough nested buffers for the pool to reallocate its blocks.
+    std::vector<std::unique_ptr<linalg_detail::scratch_buffer<double> > > b;
+    for (int i = 0; i < 64; ++i) {
+      b.emplace_back(new linalg_detail::scratch_buffer<double>(4));
+    }
+    EXPECT_EQ(a.data(), data);
+  }
+  EXPECT_EQ(a.data()[3], 42.0);
+}
+
+TEST(alias, scratch_buffer_pool_is_bounded) {
+  using buffer = linalg_detail::scratch_buffer<char>;
+  buffer::trim();
+  EXPECT_EQ(buffer::pooled_size(), 0);
+  {
+    buffer small(64);
+    // Larger than any block the pool keeps.
+    buffer large(buffer::kMaxPooledBytes + 1);
+    EXPECT_EQ(buffer::pooled_size(), buffer::kMaxPooledBytes + 65);
+  }
+  EXPECT_EQ(buffer::pooled_size(), 64);
+  buffer::trim();
+  EXPECT_EQ(buffer::pooled_size(), 0);
+}
+
+}  // namespace insight
@@ -2,9 +2,15 @@
 //
 // Author: mail2ngoclinh@gmail.com (Ngoc Linh)
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 #include "insight/linalg/detail/blas_routines.h"
+#include "insight/linalg/half.h"
+#include "insight/linalg/simd_kernels.h"
 
 namespace insight {
 namespace linalg_detail {
@@ -57,6 +63,76 @@ void blas_axpby<double>(const int N, const double alpha, const double* X,
 #endif
 }
 
+// Leading dimension forms.
+
+template<>
+void blas_gemv<float>(const CBLAS_TRANSPOSE TransA,
+                      const int M,
+                      const int N,
+                      const float alpha,
+                      const float* A,
+                      const int lda,
+                      const float* x,
+                      const int incx,
+                      const float beta,
+                      float* y,
+                      const int incy) {
+  cblas_sgemv(CblasRowMajor, TransA, M, N, alpha, A, lda, x, incx, beta, y,
+              incy);
+}
+
+template<>
+void blas_gemv<double>(const CBLAS_TRANSPOSE TransA,
+                       const int M,
+                       const int N,
+                       const double alpha,
+                       const double* A,
+                       const int lda,
+                       const double* x,
+                       const int incx,
+                       const double beta,
+                       double* y,
+                       const int incy) {
+  cblas_dgemv(CblasRowMajor, TransA, M, N, alpha, A, lda, x, incx, beta, y,
+              incy);
+}
+
+template<>
+void blas_gemm<float>(const CBLAS_TRANSPOSE TransA,
+                      const CBLAS_TRANSPOSE TransB,
+                      const int M,
+                      const int N,
+                      const int K,
+                      const float alpha,
+                      const float* A,
+                      const int lda,
+                      const float* B,
+                      const int ldb,
+                      const float beta,
+                      float* C,
+                      const int ldc) {
+  cblas_sgemm(CblasRowMajor, TransA, TransB, M, N, K, alpha, A, lda, B, ldb,
+              beta, C, ldc);
+}
+
+template<>
+void blas_gemm<double>(const CBLAS_TRANSPOSE TransA,
+                       const CBLAS_TRANSPOSE TransB,
+                       const int M,
+                       const int N,
+                       const int K,
+                       const double alpha,
+                       const double* A,
+                       const int lda,
+                       const double* B,
+                       const int ldb,
+                       const double beta,
+                       double* C,
+                       const int ldc) {
+  cblas_dgemm(CblasRowMajor, TransA, TransB, M, N, K, alpha, A, lda, B, ldb,
+              beta, C, ldc);
+}
+
 // y <- αAx + βy.
 
 template<>
@@ -68,7 +144,7 @@ void blas_gemv<float>(const CBLAS_TRANSPOSE TransA,
                          const float* x,
                          const float beta,
                          float* y) {
-  cblas_sgemv(CblasRowMajor, TransA, M, N, alpha, A, N, x, 1, beta, y, 1);
+  blas_gemv(TransA, M, N, alpha, A, N, x, 1, beta, y, 1);
 }
 
 template<>
@@ -80,7 +156,7 @@ void blas_gemv<double>(const CBLAS_TRANSPOSE TransA,
                           const double* x,
                           const double beta,
                           double* y) {
-  cblas_dgemv(CblasRowMajor, TransA, M, N, alpha, A, N, x, 1, beta, y, 1);
+  blas_gemv(TransA, M, N, alpha, A, N, x, 1, beta, y, 1);
 }
 
 // Gemm.
@@ -98,8 +174,7 @@ void blas_gemm<float>(const CBLAS_TRANSPOSE TransA,
                          float* C) {
   const int lda = (TransA == CblasNoTrans) ? K : M;
   const int ldb = (TransB == CblasNoTrans) ? N : K;
-  cblas_sgemm(CblasRowMajor, TransA, TransB, M, N, K, alpha, A, lda, B, ldb,
-              beta, C, N);
+  blas_gemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, N);
 }
 
 template<>
@@ -115,8 +190,669 @@ void blas_gemm<double>(const CBLAS_TRANSPOSE TransA,
                           double* C) {
   const int lda = (TransA == CblasNoTrans) ? K : M;
   const int ldb = (TransB == CblasNoTrans) ? N : K;
-  cblas_dgemm(CblasRowMajor, TransA, TransB, M, N, K, alpha, A, lda, B, ldb,
-              beta, C, N);
+  blas_gemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, N);
+}
+
+// Triangular solves.
+
+template<>
+void blas_trsv<float>(const CBLAS_UPLO Uplo,
+                      const CBLAS_TRANSPOSE TransA,
+                      const CBLAS_DIAG Diag,
+                      const int N,
+                      const float* A,
+                      const int lda,
+                      float* x,
+                      const int incx) {
+  cblas_strsv(CblasRowMajor, Uplo, TransA, Diag, N, A, lda, x, incx);
+}
+
+template<>
+void blas_trsv<double>(const CBLAS_UPLO Uplo,
+                       const CBLAS_TRANSPOSE TransA,
+                       const CBLAS_DIAG Diag,
+                       const int N,
+                       const double* A,
+                       const int lda,
+                       double* x,
+                       const int incx) {
+  cblas_dtrsv(CblasRowMajor, Uplo, TransA, Diag, N, A, lda, x, incx);
+}
+
+template<>
+void blas_trsm<float>(const CBLAS_SIDE Side,
+                      const CBLAS_UPLO Uplo,
+                      const CBLAS_TRANSPOSE TransA,
+                      const CBLAS_DIAG Diag,
+                      const int M,
+                      const int N,
+                      const float alpha,
+                      const float* A,
+                      const int lda,
+                      float* B,
+                      const int ldb) {
+  cblas_strsm(CblasRowMajor, Side, Uplo, TransA, Diag, M, N, alpha, A, lda,
+              B, ldb);
+}
+
+template<>
+void blas_trsm<double>(const CBLAS_SIDE Side,
+                       const CBLAS_UPLO Uplo,
+                       const CBLAS_TRANSPOSE TransA,
+                       const CBLAS_DIAG Diag,
+                       const int M,
+                       const int N,
+                       const double alpha,
+                       const double* A,
+                       const int lda,
+                       double* B,
+                       const int ldb) {
+  cblas_dtrsm(CblasRowMajor, Side, Uplo, TransA, Diag, M, N, alpha, A, lda,
+              B, ldb);
+}
+
+// Symmetric and triangular matrix-vector products.
+
+template<>
+void blas_symv<float>(const CBLAS_UPLO Uplo,
+                      const int N,
+                      const float alpha,
+                      const float* A,
+                      const int lda,
+                      const float* x,
+                      const int incx,
+                      const float beta,
+                      float* y,
+                      const int incy) {
+  cblas_ssymv(CblasRowMajor, Uplo, N, alpha, A, lda, x, incx, beta, y, incy);
+}
+
+template<>
+void blas_symv<double>(const CBLAS_UPLO Uplo,
+                       const int N,
+                       const double alpha,
+                       const double* A,
+                       const int lda,
+                       const double* x,
+                       const int incx,
+                       const double beta,
+                       double* y,
+                       const int incy) {
+  cblas_dsymv(CblasRowMajor, Uplo, N, alpha, A, lda, x, incx, beta, y, incy);
+}
+
+template<>
+void blas_trmv<float>(const CBLAS_UPLO Uplo,
+                      const CBLAS_TRANSPOSE TransA,
+                      const CBLAS_DIAG Diag,
+                      const int N,
+                      const float* A,
+                      const int lda,
+                      float* x,
+                      const int incx) {
+  cblas_strmv(CblasRowMajor, Uplo, TransA, Diag, N, A, lda, x, incx);
+}
+
+template<>
+void blas_trmv<double>(const CBLAS_UPLO Uplo,
+                       const CBLAS_TRANSPOSE TransA,
+                       const CBLAS_DIAG Diag,
+                       const int N,
+                       const double* A,
+                       const int lda,
+                       double* x,
+                       const int incx) {
+  cblas_dtrmv(CblasRowMajor, Uplo, TransA, Diag, N, A, lda, x, incx);
+}
+
+template<>
+void blas_spmv<float>(const CBLAS_UPLO Uplo,
+                      const int N,
+                      const float alpha,
+                      const float* Ap,
+                      const float* x,
+                      const int incx,
+                      const float beta,
+                      float* y,
+                      const int incy) {
+  cblas_sspmv(CblasRowMajor, Uplo, N, alpha, Ap, x, incx, beta, y, incy);
+}
+
+template<>
+void blas_spmv<double>(const CBLAS_UPLO Uplo,
+                       const int N,
+                       const double alpha,
+                       const double* Ap,
+                       const double* x,
+                       const int incx,
+                       const double beta,
+                       double* y,
+                       const int incy) {
+  cblas_dspmv(CblasRowMajor, Uplo, N, alpha, Ap, x, incx, beta, y, incy);
+}
+
+template<>
+void blas_tpmv<float>(const CBLAS_UPLO Uplo,
+                      const CBLAS_TRANSPOSE TransA,
+                      const CBLAS_DIAG Diag,
+                      const int N,
+                      const float* Ap,
+                      float* x,
+                      const int incx) {
+  cblas_stpmv(CblasRowMajor, Uplo, TransA, Diag, N, Ap, x, incx);
+}
+
+template<>
+void blas_tpmv<double>(const CBLAS_UPLO Uplo,
+                       const CBLAS_TRANSPOSE TransA,
+                       const CBLAS_DIAG Diag,
+                       const int N,
+                       const double* Ap,
+                       double* x,
+                       const int incx) {
+  cblas_dtpmv(CblasRowMajor, Uplo, TransA, Diag, N, Ap, x, incx);
+}
+
+// Rank updates.
+
+template<>
+void blas_syrk<float>(const CBLAS_UPLO Uplo,
+                      const CBLAS_TRANSPOSE Trans,
+                      const int N,
+                      const int K,
+                      const float alpha,
+                      const float* A,
+                      const int lda,
+                      const float beta,
+                      float* C,
+                      const int ldc) {
+  cblas_ssyrk(CblasRowMajor, Uplo, Trans, N, K, alpha, A, lda, beta, C, ldc);
+}
+
+template<>
+void blas_syrk<double>(const CBLAS_UPLO Uplo,
+                       const CBLAS_TRANSPOSE Trans,
+                       const int N,
+                       const int K,
+                       const double alpha,
+                       const double* A,
+                       const int lda,
+                       const double beta,
+                       double* C,
+                       const int ldc) {
+  cblas_dsyrk(CblasRowMajor, Uplo, Trans, N, K, alpha, A, lda, beta, C, ldc);
+}
+
+template<>
+void blas_syr<float>(const CBLAS_UPLO Uplo,
+                     const int N,
+                     const float alpha,
+                     const float* x,
+                     const int incx,
+                     float* A,
+                     const int lda) {
+  cblas_ssyr(CblasRowMajor, Uplo, N, alpha, x, incx, A, lda);
+}
+
+template<>
+void blas_syr<double>(const CBLAS_UPLO Uplo,
+                      const int N,
+                      const double alpha,
+                      const double* x,
+                      const int incx,
+                      double* A,
+                      const int lda) {
+  cblas_dsyr(CblasRowMajor, Uplo, N, alpha, x, incx, A, lda);
+}
+
+template<>
+void blas_spr<float>(const CBLAS_UPLO Uplo,
+                     const int N,
+                     const float alpha,
+                     const float* x,
+                     const int incx,
+                     float* Ap) {
+  cblas_sspr(CblasRowMajor, Uplo, N, alpha, x, incx, Ap);
+}
+
+template<>
+void blas_spr<double>(const CBLAS_UPLO Uplo,
+                      const int N,
+                      const double alpha,
+                      const double* x,
+                      const int incx,
+                      double* Ap) {
+  cblas_dspr(CblasRowMajor, Uplo, N, alpha, x, incx, Ap);
+}
+
+template<>
+void blas_ger<float>(const int M,
+                     const int N,
+                     const float alpha,
+                     const float* x,
+                     const int incx,
+                     const float* y,
+                     const int incy,
+                     float* A,
+                     const int lda) {
+  cblas_sger(CblasRowMajor, M, N, alpha, x, incx, y, incy, A, lda);
+}
+
+template<>
+void blas_ger<double>(const int M,
+                      const int N,
+                      const double alpha,
+                      const double* x,
+                      const int incx,
+                      const double* y,
+                      const int incy,
+                      double* A,
+                      const int lda) {
+  cblas_dger(CblasRowMajor, M, N, alpha, x, incx, y, incy, A, lda);
+}
+
+// Batched gemm and gemv.
+
+namespace {
+
+// Problems no larger than this in every dimension are computed by the
+// packed kernels below rather than by a BLAS call.
+const int kSmallBatchDim = 16;
+
+inline bool is_small_problem(const int M, const int N, const int K) {
+  return M <= kSmallBatchDim && N <= kSmallBatchDim && K <= kSmallBatchDim;
+}
+
+// Larger problems no larger than this in every dimension are computed by a
+// BLAS call each, which the BLAS does not spread among its threads.
+const int kMediumBatchDim = 64;
+
+inline bool is_medium_problem(const int M, const int N, const int K) {
+  return M <= kMediumBatchDim && N <= kMediumBatchDim &&
+      K <= kMediumBatchDim;
+}
+
+// C <- alpha * op(A) * op(B) + beta * C, where M, N, K <= kSmallBatchDim.
+//
+// op(A) and op(B) are first packed, row-major, into contiguous buffers on
+// the stack, so that the innermost loop runs over contiguous rows of op(B)
+// which the compiler vectorizes regardless of the transposes and leading
+// dimensions. As with BLAS, C is not read when beta is zero.
+template<typename T>
+void small_gemm(const CBLAS_TRANSPOSE TransA, const CBLAS_TRANSPOSE TransB,
+                const int M, const int N, const int K, const T alpha,
+                const T* A, const int lda, const T* B, const int ldb,
+                const T beta, T* C, const int ldc) {
+  T a[kSmallBatchDim * kSmallBatchDim];
+  T b[kSmallBatchDim * kSmallBatchDim];
+  T c[kSmallBatchDim];
+
+  for (int i = 0; i < M; ++i) {
+    for (int k = 0; k < K; ++k) {
+      a[i * K + k] = (TransA == CblasNoTrans) ? A[i * lda + k] :
+                     A[k * lda + i];
+    }
+  }
+
+  for (int k = 0; k < K; ++k) {
+    for (int j = 0; j < N; ++j) {
+      b[k * N + j] = (TransB == CblasNoTrans) ? B[k * ldb + j] :
+                     B[j * ldb + k];
+    }
+  }
+
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < N; ++j) c[j] = T(0);
+
+    for (int k = 0; k < K; ++k) {
+      const T aik = a[i * K + k];
+      const T* bk = b + k * N;
+      for (int j = 0; j < N; ++j) c[j] += aik * bk[j];
+    }
+
+    T* ci = C + i * ldc;
+    if (beta == T(0)) {
+      for (int j = 0; j < N; ++j) ci[j] = alpha * c[j];
+    } else {
+      for (int j = 0; j < N; ++j) ci[j] = alpha * c[j] + beta * ci[j];
+    }
+  }
+}
+
+// y <- alpha * op(A) * x + beta * y, where M, N <= kSmallBatchDim.
+template<typename T>
+void small_gemv(const CBLAS_TRANSPOSE TransA, const int M, const int N,
+                const T alpha, const T* A, const int lda, const T* x,
+                const T beta, T* y) {
+  T z[kSmallBatchDim];
+  const int m = (TransA == CblasNoTrans) ? M : N;
+
+  if (TransA == CblasNoTrans) {
+    for (int i = 0; i < M; ++i) {
+      const T* ai = A + i * lda;
+      T dot = T(0);
+      for (int j = 0; j < N; ++j) dot += ai[j] * x[j];
+      z[i] = dot;
+    }
+  } else {
+    for (int j = 0; j < N; ++j) z[j] = T(0);
+    for (int i = 0; i < M; ++i) {
+      const T* ai = A + i * lda;
+      const T xi = x[i];
+      for (int j = 0; j < N; ++j) z[j] += ai[j] * xi;
+    }
+  }
+
+  if (beta == T(0)) {
+    for (int i = 0; i < m; ++i) y[i] = alpha * z[i];
+  } else {
+    for (int i = 0; i < m; ++i) y[i] = alpha * z[i] + beta * y[i];
+  }
+}
+
+// The i-th operand of a batch given as an array of pointers...
+template<typename P>
+struct array_batch {
+  P const* p;
+  inline P operator()(const int i) const { return p[i]; }
+};
+
+// ... or as a single pointer and the distance between two operands.
+template<typename P>
+struct strided_batch {
+  P p;
+  int stride;
+  inline P operator()(const int i) const {
+    return p + static_cast<std::ptrdiff_t>(i) * stride;
+  }
+};
+
+template<typename P>
+inline array_batch<P> make_batch(P const* p) {
+  return array_batch<P>{p};
+}
+
+template<typename P>
+inline strided_batch<P> make_batch(P p, const int stride) {
+  return strided_batch<P>{p, stride};
+}
+
+// Makes the BLAS calls of the calling thread single threaded, for as long
+// as it lives. Only MKL needs to be told: the other backends do not thread
+// the medium problems below.
+class single_threaded_blas {
+ public:
+#ifdef INSIGHT_USE_MKL
+  single_threaded_blas() : threads_(mkl_set_num_threads_local(1)) {}
+  ~single_threaded_blas() { mkl_set_num_threads_local(threads_); }
+
+ private:
+  int threads_;
+#else
+  single_threaded_blas() {}
+#endif
+};
+
+// The batch is computed by problem size:
+//
+//   - small problems by the packed kernels, the batch being split among
+//     OpenMP threads;
+//   - medium problems by one BLAS call each, too small for the BLAS to
+//     thread one product, so that the batch is split among OpenMP threads
+//     as well, each running its BLAS calls on a single thread;
+//   - larger problems by one BLAS call after another: the BLAS already
+//     spreads each product among its own threads, nesting them in OpenMP
+//     threads would oversubscribe the cores.
+
+template<typename T, typename BatchA, typename BatchB, typename BatchC>
+void gemm_batch(const CBLAS_TRANSPOSE TransA, const CBLAS_TRANSPOSE TransB,
+                const int M, const int N, const int K, const T alpha,
+                BatchA A, const int lda, BatchB B, const int ldb,
+                const T beta, BatchC C, const int ldc,
+                const int batch_count) {
+  if (is_small_problem(M, N, K)) {
+#ifdef INSIGHT_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < batch_count; ++i) {
+      small_gemm(TransA, TransB, M, N, K, alpha, A(i), lda, B(i), ldb, beta,
+                 C(i), ldc);
+    }
+  } else if (is_medium_problem(M, N, K)) {
+#ifdef INSIGHT_USE_OPENMP
+#pragma omp parallel
+#endif
+    {
+      single_threaded_blas guard;
+#ifdef INSIGHT_USE_OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (int i = 0; i < batch_count; ++i) {
+        blas_gemm(TransA, TransB, M, N, K, alpha, A(i), lda, B(i), ldb,
+                  beta, C(i), ldc);
+      }
+    }
+  } else {
+    for (int i = 0; i < batch_count; ++i) {
+      blas_gemm(TransA, TransB, M, N, K, alpha, A(i), lda, B(i), ldb, beta,
+                C(i), ldc);
+    }
+  }
+}
+
+template<typename T, typename BatchA, typename BatchX, typename BatchY>
+void gemv_batch(const CBLAS_TRANSPOSE TransA, const int M, const int N,
+                const T alpha, BatchA A, const int lda, BatchX x,
+                const T beta, BatchY y, const int batch_count) {
+  if (is_small_problem(M, N, 1)) {
+#ifdef INSIGHT_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < batch_count; ++i) {
+      small_gemv(TransA, M, N, alpha, A(i), lda, x(i), beta, y(i));
+    }
+  } else if (is_medium_problem(M, N, 1)) {
+#ifdef INSIGHT_USE_OPENMP
+#pragma omp parallel
+#endif
+    {
+      single_threaded_blas guard;
+#ifdef INSIGHT_USE_OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (int i = 0; i < batch_count; ++i) {
+        blas_gemv(TransA, M, N, alpha, A(i), lda, x(i), 1, beta, y(i), 1);
+      }
+    }
+  } else {
+    for (int i = 0; i < batch_count; ++i) {
+      blas_gemv(TransA, M, N, alpha, A(i), lda, x(i), 1, beta, y(i), 1);
+    }
+  }
+}
+
+}  // namespace
+
+template<>
+void blas_gemm_batch<float>(const CBLAS_TRANSPOSE TransA,
+                            const CBLAS_TRANSPOSE TransB,
+                            const int M,
+                            const int N,
+                            const int K,
+                            const float alpha,
+                            const float* const* A,
+                            const int lda,
+                            const float* const* B,
+                            const int ldb,
+                            const float beta,
+                            float* const* C,
+                            const int ldc,
+                            const int batch_count) {
+#ifdef INSIGHT_USE_MKL
+  const MKL_INT m = M, n = N, k = K, ld[3] = {lda, ldb, ldc};
+  const MKL_INT group_size = batch_count;
+  cblas_sgemm_batch(CblasRowMajor, &TransA, &TransB, &m, &n, &k, &alpha,
+                    const_cast<const float**>(A), &ld[0],
+                    const_cast<const float**>(B), &ld[1], &beta,
+                    const_cast<float**>(C), &ld[2], 1, &group_size);
+#else
+  gemm_batch(TransA, TransB, M, N, K, alpha, make_batch(A), lda,
+             make_batch(B), ldb, beta, make_batch(C), ldc, batch_count);
+#endif
+}
+
+template<>
+void blas_gemm_batch<double>(const CBLAS_TRANSPOSE TransA,
+                             const CBLAS_TRANSPOSE TransB,
+                             const int M,
+                             const int N,
+                             const int K,
+                             const double alpha,
+                             const double* const* A,
+                             const int lda,
+                             const double* const* B,
+                             const int ldb,
+                             const double beta,
+                             double* const* C,
+                             const int ldc,
+                             const int batch_count) {
+#ifdef INSIGHT_USE_MKL
+  const MKL_INT m = M, n = N, k = K, ld[3] = {lda, ldb, ldc};
+  const MKL_INT group_size = batch_count;
+  cblas_dgemm_batch(CblasRowMajor, &TransA, &TransB, &m, &n, &k, &alpha,
+                    const_cast<const double**>(A), &ld[0],
+                    const_cast<const double**>(B), &ld[1], &beta,
+                    const_cast<double**>(C), &ld[2], 1, &group_size);
+#else
+  gemm_batch(TransA, TransB, M, N, K, alpha, make_batch(A), lda,
+             make_batch(B), ldb, beta, make_batch(C), ldc, batch_count);
+#endif
+}
+
+template<>
+void blas_gemm_batch<float>(const CBLAS_TRANSPOSE TransA,
+                            const CBLAS_TRANSPOSE TransB,
+                            const int M,
+                            const int N,
+                            const int K,
+                            const float alpha,
+                            const float* A,
+                            const int lda,
+                            const int strideA,
+                            const float* B,
+                            const int ldb,
+                            const int strideB,
+                            const float beta,
+                            float* C,
+                            const int ldc,
+                            const int strideC,
+                            const int batch_count) {
+#if defined(INSIGHT_USE_MKL) && INTEL_MKL_VERSION >= 20200000
+  cblas_sgemm_batch_strided(CblasRowMajor, TransA, TransB, M, N, K, alpha,
+                            A, lda, strideA, B, ldb, strideB, beta, C, ldc,
+                            strideC, batch_count);
+#else
+  gemm_batch(TransA, TransB, M, N, K, alpha, make_batch(A, strideA), lda,
+             make_batch(B, strideB), ldb, beta, make_batch(C, strideC), ldc,
+             batch_count);
+#endif
+}
+
+template<>
+void blas_gemm_batch<double>(const CBLAS_TRANSPOSE TransA,
+                             const CBLAS_TRANSPOSE TransB,
+                             const int M,
+                             const int N,
+                             const int K,
+                             const double alpha,
+                             const double* A,
+                             const int lda,
+                             const int strideA,
+                             const double* B,
+                             const int ldb,
+                             const int strideB,
+                             const double beta,
+                             double* C,
+                             const int ldc,
+                             const int strideC,
+                             const int batch_count) {
+#if defined(INSIGHT_USE_MKL) && INTEL_MKL_VERSION >= 20200000
+  cblas_dgemm_batch_strided(CblasRowMajor, TransA, TransB, M, N, K, alpha,
+                            A, lda, strideA, B, ldb, strideB, beta, C, ldc,
+                            strideC, batch_count);
+#else
+  gemm_batch(TransA, TransB, M, N, K, alpha, make_batch(A, strideA), lda,
+             make_batch(B, strideB), ldb, beta, make_batch(C, strideC), ldc,
+             batch_count);
+#endif
+}
+
+template<>
+void blas_gemv_batch<float>(const CBLAS_TRANSPOSE TransA,
+                            const int M,
+                            const int N,
+                            const float alpha,
+                            const float* const* A,
+                            const int lda,
+                            const float* const* x,
+                            const float beta,
+                            float* const* y,
+                            const int batch_count) {
+  gemv_batch(TransA, M, N, alpha, make_batch(A), lda, make_batch(x), beta,
+             make_batch(y), batch_count);
+}
+
+template<>
+void blas_gemv_batch<double>(const CBLAS_TRANSPOSE TransA,
+                             const int M,
+                             const int N,
+                             const double alpha,
+                             const double* const* A,
+                             const int lda,
+                             const double* const* x,
+                             const double beta,
+                             double* const* y,
+                             const int batch_count) {
+  gemv_batch(TransA, M, N, alpha, make_batch(A), lda, make_batch(x), beta,
+             make_batch(y), batch_count);
+}
+
+template<>
+void blas_gemv_batch<float>(const CBLAS_TRANSPOSE TransA,
+                            const int M,
+                            const int N,
+                            const float alpha,
+                            const float* A,
+                            const int lda,
+                            const int strideA,
+                            const float* x,
+                            const int stridex,
+                            const float beta,
+                            float* y,
+                            const int stridey,
+                            const int batch_count) {
+  gemv_batch(TransA, M, N, alpha, make_batch(A, strideA), lda,
+             make_batch(x, stridex), beta, make_batch(y, stridey),
+             batch_count);
+}
+
+template<>
+void blas_gemv_batch<double>(const CBLAS_TRANSPOSE TransA,
+                             const int M,
+                             const int N,
+                             const double alpha,
+                             const double* A,
+                             const int lda,
+                             const int strideA,
+                             const double* x,
+                             const int stridex,
+                             const double beta,
+                             double* y,
+                             const int stridey,
+                             const int batch_count) {
+  gemv_batch(TransA, M, N, alpha, make_batch(A, strideA), lda,
+             make_batch(x, stridex), beta, make_batch(y, stridey),
+             batch_count);
 }
 
 // Computes the L2 norm (Euclidian length) of a vector.
@@ -143,6 +879,66 @@ double blas_dot<double>(const int N, const double* X, const double* Y) {
   return cblas_ddot(N, X, 1, Y, 1);
 }
 
+// Strided level 1 routines.
+
+template<>
+void blas_scal<float>(const int N, const float alpha, float* X,
+                      const int incX) {
+  cblas_sscal(N, alpha, X, incX);
+}
+
+template<>
+void blas_scal<double>(const int N, const double alpha, double* X,
+                       const int incX) {
+  cblas_dscal(N, alpha, X, incX);
+}
+
+template<>
+void blas_axpy<float>(const int N, const float alpha, const float* X,
+                      const int incX, float* Y, const int incY) {
+  cblas_saxpy(N, alpha, X, incX, Y, incY);
+}
+
+template<>
+void blas_axpy<double>(const int N, const double alpha, const double* X,
+                       const int incX, double* Y, const int incY) {
+  cblas_daxpy(N, alpha, X, incX, Y, incY);
+}
+
+template<>
+void blas_copy<float>(const int N, const float* X, const int incX, float* Y,
+                      const int incY) {
+  cblas_scopy(N, X, incX, Y, incY);
+}
+
+template<>
+void blas_copy<double>(const int N, const double* X, const int incX,
+                       double* Y, const int incY) {
+  cblas_dcopy(N, X, incX, Y, incY);
+}
+
+template<>
+float blas_nrm2<float>(const int N, const float* X, const int incX) {
+  return cblas_snrm2(N, X, incX);
+}
+
+template<>
+double blas_nrm2<double>(const int N, const double* X, const int incX) {
+  return cblas_dnrm2(N, X, incX);
+}
+
+template<>
+float blas_dot<float>(const int N, const float* X, const int incX,
+                      const float* Y, const int incY) {
+  return cblas_sdot(N, X, incX, Y, incY);
+}
+
+template<>
+double blas_dot<double>(const int N, const double* X, const int incX,
+                        const double* Y, const int incY) {
+  return cblas_ddot(N, X, incX, Y, incY);
+}
+
 // Adds two vectors: Z = X + Y element-wise.
 
 template<>
@@ -153,11 +949,7 @@ void blas_add<float>(const int N, const float* X, const float* Y,
 #elif defined(INSIGHT_USE_MKL)
   vsAdd(N, X, Y, Z);
 #else
-  // TODO(Linh): Should we use a simple for-loop or a combination of memcpy
-  // and axpy?
-  for (int i = 0; i < N; ++i) {
-    Z[i] = X[i] + Y[i];
-  }
+  simd::kernels<float>().add(N, X, Y, Z);
 #endif
 }
 
@@ -169,11 +961,7 @@ void blas_add<double>(const int N, const double* X, const double* Y,
 #elif defined(INSIGHT_USE_MKL)
   vdAdd(N, X, Y, Z);
 #else
-  // TODO(Linh): Should we use a simple for-loop or a combination of memcpy
-  // and axpy?
-  for (int i = 0; i < N; ++i) {
-    Z[i] = X[i] + Y[i];
-  }
+  simd::kernels<double>().add(N, X, Y, Z);
 #endif
 }
 
@@ -188,11 +976,7 @@ void blas_sub<float>(const int N, const float* X, const float* Y,
 #elif defined(INSIGHT_USE_MKL)
   vsSub(N, X, Y, Z);
 #else
-  // TODO(Linh): Should we use a simple for-loop or a combination of memcpy
-  // and axpy?
-  for (int i = 0; i < N; ++i) {
-    Z[i] = X[i] - Y[i];
-  }
+  simd::kernels<float>().sub(N, X, Y, Z);
 #endif
 }
 
@@ -204,11 +988,7 @@ void blas_sub<double>(const int N, const double* X, const double* Y,
 #elif defined(INSIGHT_USE_MKL)
   vdSub(N, X, Y, Z);
 #else
-  // TODO(Linh): Should we use a simple for-loop or a combination of memcpy
-  // and axpy?
-  for (int i = 0; i < N; ++i) {
-    Z[i] = X[i] - Y[i];
-  }
+  simd::kernels<double>().sub(N, X, Y, Z);
 #endif
 }
 
@@ -223,9 +1003,7 @@ void blas_mul<float>(const int N, const float* X, const float* Y,
 #elif defined(INSIGHT_USE_MKL)
   vsMul(N, X, Y, Z);
 #else
-  for (int i = 0; i < N; ++i) {
-    Z[i] = X[i] * Y[i];
-  }
+  simd::kernels<float>().mul(N, X, Y, Z);
 #endif
 }
 
@@ -237,9 +1015,7 @@ void blas_mul<double>(const int N, const double* X, const double* Y,
 #elif defined(INSIGHT_USE_MKL)
   vdMul(N, X, Y, Z);
 #else
-  for (int i = 0; i < N; ++i) {
-    Z[i] = X[i] * Y[i];
-  }
+  simd::kernels<double>().mul(N, X, Y, Z);
 #endif
 }
 
@@ -254,9 +1030,7 @@ void blas_div<float>(const int N, const float* X, const float* Y,
 #elif defined(INSIGHT_USE_MKL)
   vsDiv(N, X, Y, Z);
 #else
-  for (int i = 0; i < N; ++i) {
-    Z[i] = X[i] / Y[i];
-  }
+  simd::kernels<float>().div(N, X, Y, Z);
 #endif
 }
 
@@ -268,9 +1042,7 @@ void blas_div<double>(const int N, const double* X, const double* Y,
 #elif defined(INSIGHT_USE_MKL)
   vdDiv(N, X, Y, Z);
 #else
-  for (int i = 0; i < N; ++i) {
-    Z[i] = X[i] / Y[i];
-  }
+  simd::kernels<double>().div(N, X, Y, Z);
 #endif
 }
 
@@ -285,9 +1057,7 @@ void blas_sqrt<float>(const int N, const float* X, float* Y) {
 #elif defined(INSIGHT_USE_MKL)
   vsSqrt(N, X, Y);
 #else
-  for (int i = 0; i < N; ++i) {
-    Y[i] = std::sqrt(X[i]);
-  }
+  simd::kernels<float>().sqrt(N, X, Y);
 #endif
 }
 
@@ -299,9 +1069,7 @@ void blas_sqrt<double>(const int N, const double* X, double* Y) {
 #elif defined(INSIGHT_USE_MKL)
   vdSqrt(N, X, Y);
 #else
-  for (int i = 0; i < N; ++i) {
-    Y[i] = std::sqrt(X[i]);
-  }
+  simd::kernels<double>().sqrt(N, X, Y);
 #endif
 }
 
@@ -316,9 +1084,7 @@ void blas_exp<float>(const int N, const float* X, float* Y) {
 #elif defined(INSIGHT_USE_MKL)
   vsExp(N, X, Y);
 #else
-  for (int i = 0; i < N; ++i) {
-    Y[i] = std::exp(X[i]);
-  }
+  simd::kernels<float>().exp(N, X, Y);
 #endif
 }
 
@@ -330,9 +1096,7 @@ void blas_exp<double>(const int N, const double* X, double* Y) {
 #elif defined(INSIGHT_USE_MKL)
   vdExp(N, X, Y);
 #else
-  for (int i = 0; i < N; ++i) {
-    Y[i] = std::exp(X[i]);
-  }
+  simd::kernels<double>().exp(N, X, Y);
 #endif
 }
 
@@ -347,9 +1111,7 @@ void blas_log<float>(const int N, const float* X, float* Y) {
 #elif defined(INSIGHT_USE_MKL)
   vsLn(N, X, Y);
 #else
-  for (int i = 0; i < N; ++i) {
-    Y[i] = std::log(X[i]);
-  }
+  simd::kernels<float>().log(N, X, Y);
 #endif
 }
 
@@ -361,11 +1123,369 @@ void blas_log<double>(const int N, const double* X, double* Y) {
 #elif defined(INSIGHT_USE_MKL)
   vdLn(N, X, Y);
 #else
-  for (int i = 0; i < N; ++i) {
-    Y[i] = std::log(X[i]);
-  }
+  simd::kernels<double>().log(N, X, Y);
+#endif
+}
+
+// Returns the sum of the elements of X.
+
+template<>
+float blas_sum<float>(const int N, const float* X) {
+#ifdef INSIGHT_USE_ACCELERATE
+  float result = 0;
+  vDSP_sve(X, 1, &result, N);
+  return result;
+#else
+  return simd::kernels<float>().sum(N, X);
+#endif
+}
+
+template<>
+double blas_sum<double>(const int N, const double* X) {
+#ifdef INSIGHT_USE_ACCELERATE
+  double result = 0;
+  vDSP_sveD(X, 1, &result, N);
+  return result;
+#else
+  return simd::kernels<double>().sum(N, X);
+#endif
+}
+
+// Returns the sum of the absolute values of the elements of X.
+
+template<>
+float blas_asum<float>(const int N, const float* X) {
+  return cblas_sasum(N, X, 1);
+}
+
+template<>
+double blas_asum<double>(const int N, const double* X) {
+  return cblas_dasum(N, X, 1);
+}
+
+// Returns the smallest element of X.
+
+template<>
+float blas_min<float>(const int N, const float* X) {
+#ifdef INSIGHT_USE_ACCELERATE
+  float result;
+  vDSP_minv(X, 1, &result, N);
+  return result;
+#else
+  return simd::kernels<float>().min(N, X);
+#endif
+}
+
+template<>
+double blas_min<double>(const int N, const double* X) {
+#ifdef INSIGHT_USE_ACCELERATE
+  double result;
+  vDSP_minvD(X, 1, &result, N);
+  return result;
+#else
+  return simd::kernels<double>().min(N, X);
 #endif
 }
 
+// Returns the largest element of X.
+
+template<>
+float blas_max<float>(const int N, const float* X) {
+#ifdef INSIGHT_USE_ACCELERATE
+  float result;
+  vDSP_maxv(X, 1, &result, N);
+  return result;
+#else
+  return simd::kernels<float>().max(N, X);
+#endif
+}
+
+template<>
+double blas_max<double>(const int N, const double* X) {
+#ifdef INSIGHT_USE_ACCELERATE
+  double result;
+  vDSP_maxvD(X, 1, &result, N);
+  return result;
+#else
+  return simd::kernels<double>().max(N, X);
+#endif
+}
+
+// 32-bit integer arithmetic.
+
+template<>
+void blas_scal<int32_t>(const int N, const int32_t alpha, int32_t* X) {
+  simd::integer_kernels().scal(N, alpha, X);
+}
+
+template<>
+void blas_add<int32_t>(const int N, const int32_t* X, const int32_t* Y,
+                       int32_t* Z) {
+  simd::integer_kernels().add(N, X, Y, Z);
+}
+
+template<>
+void blas_sub<int32_t>(const int N, const int32_t* X, const int32_t* Y,
+                       int32_t* Z) {
+  simd::integer_kernels().sub(N, X, Y, Z);
+}
+
+template<>
+void blas_mul<int32_t>(const int N, const int32_t* X, const int32_t* Y,
+                       int32_t* Z) {
+  simd::integer_kernels().mul(N, X, Y, Z);
+}
+
+void blas_gemm_u8s8s32(const int M,
+                       const int N,
+                       const int K,
+                       const uint8_t* A,
+                       const int lda,
+                       const int8_t* B,
+                       const int ldb,
+                       int32_t* C,
+                       const int ldc) {
+  simd::integer_kernels().gemm_u8s8s32(M, N, K, A, lda, B, ldb, C, ldc);
+}
+
+// Mixed precision routines.
+
+template<>
+void blas_convert<float16, float>(const int N, const float16* X, float* Y) {
+  simd::conversions().half_to_float(
+      N, reinterpret_cast<const uint16_t*>(X), Y);
+}
+
+template<>
+void blas_convert<float, float16>(const int N, const float* X, float16* Y) {
+  simd::conversions().float_to_half(N, X, reinterpret_cast<uint16_t*>(Y));
+}
+
+template<>
+void blas_convert<bfloat16_t, float>(const int N, const bfloat16_t* X,
+                                   float* Y) {
+  simd::conversions().bfloat16_to_float(
+      N, reinterpret_cast<const uint16_t*>(X), Y);
+}
+
+template<>
+void blas_convert<float, bfloat16_t>(const int N, const float* X,
+                                   bfloat16_t* Y) {
+  simd::conversions().float_to_bfloat16(
+      N, X, reinterpret_cast<uint16_t*>(Y));
+}
+
+namespace {
+
+// Number of floats converted at a time by the mixed precision routines:
+// 64K floats, i.e. 256KB, about the size of an L2 cache.
+const int kMixedBlockSize = 1 << 16;
+
+// Number of elements of the level 1 blocks, converted on the stack.
+const int kMixedVectorBlockSize = 1024;
+
+// Y <- X, where X (resp. Y) is a rows x cols block of a row-major array
+// whose consecutive rows are ldx (resp. cols) elements apart, converted to
+// float. The second form converts back.
+template<typename T>
+void convert_rows(const int rows, const int cols, const T* X, const int ldx,
+                  float* Y) {
+  if (ldx == cols) {
+    blas_convert(rows * cols, X, Y);
+    return;
+  }
+  for (int r = 0; r < rows; ++r) {
+    blas_convert(cols, X + r * ldx, Y + r * cols);
+  }
+}
+
+template<typename T>
+void convert_rows(const int rows, const int cols, const float* X, T* Y,
+                  const int ldy) {
+  if (ldy == cols) {
+    blas_convert(rows * cols, X, Y);
+    return;
+  }
+  for (int r = 0; r < rows; ++r) {
+    blas_convert(cols, X + r * cols, Y + r * ldy);
+  }
+}
+
+// Number of rows of a block of (at most) kMixedBlockSize elements.
+inline int block_rows(const int row_count, const int col_count) {
+  const int rows = kMixedBlockSize / std::max(col_count, 1);
+  return std::max(1, std::min(rows, row_count));
+}
+
+}  // namespace
+
+template<typename T>
+float blas_mixed_dot(const int N, const T* X, const T* Y) {
+  float x[kMixedVectorBlockSize];
+  float y[kMixedVectorBlockSize];
+  float result = 0;
+  for (int i = 0; i < N; i += kMixedVectorBlockSize) {
+    const int n = std::min(kMixedVectorBlockSize, N - i);
+    blas_convert(n, X + i, x);
+    blas_convert(n, Y + i, y);
+    result += blas_dot<float>(n, x, y);
+  }
+  return result;
+}
+
+template<typename T>
+float blas_mixed_nrm2(const int N, const T* X) {
+  float x[kMixedVectorBlockSize];
+  float result = 0;
+  for (int i = 0; i < N; i += kMixedVectorBlockSize) {
+    const int n = std::min(kMixedVectorBlockSize, N - i);
+    blas_convert(n, X + i, x);
+    result = std::hypot(result, blas_nrm2<float>(n, x));
+  }
+  return result;
+}
+
+template<typename T>
+void blas_mixed_gemv(const CBLAS_TRANSPOSE TransA,
+                     const int M,
+                     const int N,
+                     const float alpha,
+                     const T* A,
+                     const int lda,
+                     const T* x,
+                     const float beta,
+                     T* y) {
+  const bool no_trans = (TransA == CblasNoTrans);
+  const int x_size = no_trans ? N : M;
+  const int y_size = no_trans ? M : N;
+
+  std::vector<float> xf(x_size);
+  std::vector<float> yf(y_size);
+  blas_convert(x_size, x, xf.data());
+  if (beta != 0) {
+    blas_convert(y_size, y, yf.data());
+  }
+
+  // y <- beta * y once, then y <- alpha * op(A_i) * x_i + y, one block
+  // A_i of rows of A at a time.
+  if (!no_trans && beta != 1) {
+    blas_scal<float>(y_size, beta, yf.data());
+  }
+
+  const int rows = block_rows(M, N);
+  std::vector<float> af(rows * N);
+  for (int r = 0; r < M; r += rows) {
+    const int m = std::min(rows, M - r);
+    convert_rows(m, N, A + r * lda, lda, af.data());
+    if (no_trans) {
+      blas_gemv<float>(CblasNoTrans, m, N, alpha, af.data(), N, xf.data(), 1,
+                       beta, yf.data() + r, 1);
+    } else {
+      blas_gemv<float>(CblasTrans, m, N, alpha, af.data(), N, xf.data() + r,
+                       1, 1.0f, yf.data(), 1);
+    }
+  }
+
+  blas_convert(y_size, yf.data(), y);
+}
+
+template<typename T>
+void blas_mixed_gemm(const CBLAS_TRANSPOSE TransA,
+                     const CBLAS_TRANSPOSE TransB,
+                     const int M,
+                     const int N,
+                     const int K,
+                     const float alpha,
+                     const T* A,
+                     const int lda,
+                     const T* B,
+                     const int ldb,
+                     const float beta,
+                     T* C,
+                     const int ldc) {
+  // op(B) is converted as a whole, op(A) and C one block of rows at a time.
+  const int b_rows = (TransB == CblasNoTrans) ? K : N;
+  const int b_cols = (TransB == CblasNoTrans) ? N : K;
+  std::vector<float> bf(b_rows * b_cols);
+  convert_rows(b_rows, b_cols, B, ldb, bf.data());
+
+  const int rows = block_rows(M, std::max(K, N));
+  std::vector<float> af(rows * K);
+  std::vector<float> cf(rows * N);
+  for (int r = 0; r < M; r += rows) {
+    const int m = std::min(rows, M - r);
+
+    // Rows r, ..., r + m - 1 of op(A) are the same rows of A, or the same
+    // columns of A when A is transposed.
+    int a_ld;
+    if (TransA == CblasNoTrans) {
+      convert_rows(m, K, A + r * lda, lda, af.data());
+      a_ld = K;
+    } else {
+      convert_rows(K, m, A + r, lda, af.data());
+      a_ld = m;
+    }
+
+    if (beta != 0) {
+      convert_rows(m, N, C + r * ldc, ldc, cf.data());
+    }
+    blas_gemm<float>(TransA, TransB, m, N, K, alpha, af.data(), a_ld,
+                     bf.data(), b_cols, beta, cf.data(), N);
+    convert_rows(m, N, cf.data(), C + r * ldc, ldc);
+  }
+}
+
+template float blas_mixed_dot<float16>(const int N, const float16* X,
+                                       const float16* Y);
+template float blas_mixed_nrm2<float16>(const int N, const float16* X);
+template void blas_mixed_gemv<float16>(const CBLAS_TRANSPOSE TransA,
+                                       const int M,
+                                       const int N,
+                                       const float alpha,
+                                       const float16* A,
+                                       const int lda,
+                                       const float16* x,
+                                       const float beta,
+                                       float16* y);
+template void blas_mixed_gemm<float16>(const CBLAS_TRANSPOSE TransA,
+                                       const CBLAS_TRANSPOSE TransB,
+                                       const int M,
+                                       const int N,
+                                       const int K,
+                                       const float alpha,
+                                       const float16* A,
+                                       const int lda,
+                                       const float16* B,
+                                       const int ldb,
+                                       const float beta,
+                                       float16* C,
+                                       const int ldc);
+
+template float blas_mixed_dot<bfloat16_t>(const int N, const bfloat16_t* X,
+                                        const bfloat16_t* Y);
+template float blas_mixed_nrm2<bfloat16_t>(const int N, const bfloat16_t* X);
+template void blas_mixed_gemv<bfloat16_t>(const CBLAS_TRANSPOSE TransA,
+                                        const int M,
+                                        const int N,
+                                        const float alpha,
+                                        const bfloat16_t* A,
+                                        const int lda,
+                                        const bfloat16_t* x,
+                                        const float beta,
+                                        bfloat16_t* y);
+template void blas_mixed_gemm<bfloat16_t>(const CBLAS_TRANSPOSE TransA,
+                                        const CBLAS_TRANSPOSE TransB,
+                                        const int M,
+                                        const int N,
+                                        const int K,
+                                        const float alpha,
+                                        const bfloat16_t* A,
+                                        const int lda,
+                                        const bfloat16_t* B,
+                                        const int ldb,
+                                        const float beta,
+                                        bfloat16_t* C,
+                                        const int ldc);
+
 }  // namespace linalg_detail
 }  // namespace insight
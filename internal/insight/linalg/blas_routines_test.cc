@@ -2,6 +2,9 @@
 //
 // Author: mail2ngoclinh@gmail.com (Ngoc Linh)
 
+#include <cmath>
+#include <vector>
+
 #include "insight/linalg/detail/blas_routines.h"
 
 #include "gtest/gtest.h"
@@ -180,5 +183,293 @@ TEST(math_functions, blas_sqrt) {
   EXPECT_THAT(y, ElementsAre(10, 100, 8, 12));
 }
 
+// Strided vectors: a column of the (row-major) 3 x 2 matrix A, or every
+// other element of a buffer.
+
+TEST(blas_dot, WithIncrements) {
+  double A[] = {1, 2, 3, 4, 5, 6};
+  double x[] = {1, 1, 2};
+  EXPECT_THAT(blas_dot(3, A + 1, 2, x, 1), DoubleEq(2 + 4 + 12));
+}
+
+TEST(blas_nrm2, WithIncrement) {
+  double A[] = {1, 2, 3, 4, 5, 6};
+  EXPECT_THAT(blas_nrm2(2, A, 4), DoubleEq(std::sqrt(1.0 + 25.0)));
+}
+
+TEST(blas_scal, WithIncrement) {
+  double A[] = {1, 2, 3, 4, 5, 6};
+  blas_scal(3, 2.0, A + 1, 2);
+  EXPECT_THAT(A, ElementsAre(1, 4, 3, 8, 5, 12));
+}
+
+TEST(blas_axpy, WithIncrements) {
+  double A[] = {1, 4, 3, 8, 5, 12};
+  blas_axpy(3, -1.0, A, 2, A + 1, 2);
+  EXPECT_THAT(A, ElementsAre(1, 3, 3, 5, 5, 7));
+}
+
+TEST(blas_copy, WithIncrements) {
+  float B[] = {1, 2, 3, 4};
+  float y[] = {0, 0};
+  blas_copy(2, B, 2, y, 1);
+  EXPECT_THAT(y, ElementsAre(1, 3));
+}
+
+// Blocks of larger (row-major) matrices, given by their leading dimension.
+
+TEST(blas_gemv, WithLeadingDimension) {
+  // The top right 2 x 2 block of a 3 x 4 matrix.
+  double A[] = {1, 2, 3, 4,
+                5, 6, 7, 8,
+                9, 10, 11, 12};
+  double x[] = {1, -1};
+  double y[] = {0, 0, 0, 0};
+
+  blas_gemv(CblasNoTrans, 2, 2, 1.0, A + 2, 4, x, 1, 0.0, y, 2);
+  EXPECT_THAT(y, ElementsAre(-1, 0, -1, 0));
+
+  blas_gemv(CblasTrans, 2, 2, 1.0, A + 2, 4, x, 1, 0.0, y, 1);
+  EXPECT_THAT(y, ElementsAre(-4, -4, -1, 0));
+}
+
+TEST(blas_gemm, WithLeadingDimensions) {
+  // C(bottom left 2 x 2 block) <- A(top right) * A(top right)
+  float B[] = {1, 2, 3, 4,
+               5, 6, 7, 8,
+               9, 10, 11, 12};
+  float C[] = {0, 0, 0,
+               0, 0, 0,
+               0, 0, 0};
+  blas_gemm(CblasNoTrans, CblasNoTrans, 2, 2, 2, 1.0f, B + 2, 4, B + 2, 4,
+            0.0f, C + 3, 3);
+  EXPECT_THAT(C, ElementsAre(0, 0, 0,
+                             37, 44, 0,
+                             77, 92, 0));
+}
+
+TEST(blas_trsv, ForDoubleDataType) {
+  // Lower triangle L = {{2, 0}, {1, 4}}; the upper triangle is not read.
+  double L[] = {2, 99,
+                1, 4};
+  double x[] = {4, 6};
+  blas_trsv(CblasLower, CblasNoTrans, CblasNonUnit, 2, L, 2, x, 1);
+  EXPECT_THAT(x, ElementsAre(2, 1));
+}
+
+TEST(blas_trsm, ForFloatDataType) {
+  // L^-1 * B, and B * L^-T, with B the top left 2 x 2 block of a 2 x 3
+  // matrix.
+  float B[] = {4, 2, 7,
+               6, 9, 7};
+  float L[] = {2, 99,
+               1, 4};
+  blas_trsm(CblasLeft, CblasLower, CblasNoTrans, CblasNonUnit, 2, 2, 1.0f, L,
+            2, B, 3);
+  EXPECT_THAT(B, ElementsAre(2, 1, 7,
+                             1, 2, 7));
+  blas_trsm(CblasRight, CblasLower, CblasTrans, CblasNonUnit, 2, 2, 2.0f, L,
+            2, B, 3);
+  EXPECT_THAT(B, ElementsAre(2, 0, 7,
+                             1, 0.75, 7));
+}
+
+TEST(blas_syrk, ForDoubleDataType) {
+  // Lower triangle of 2 * A^T * A + C, with A 3 x 2.
+  double A[] = {1, 2,
+                3, 4,
+                5, 6};
+  double C[] = {1, -1,
+                1, 1};
+  blas_syrk(CblasLower, CblasTrans, 2, 3, 2.0, A, 2, 1.0, C, 2);
+  EXPECT_THAT(C, ElementsAre(71, -1,
+                             89, 113));
+
+  // Upper triangle of A * A^T, with A the left 2 x 1 column of a 2 x 2.
+  blas_syrk(CblasUpper, CblasNoTrans, 2, 1, 1.0, A, 2, 0.0, C, 2);
+  EXPECT_THAT(C, ElementsAre(1, 3,
+                             89, 9));
+}
+
+TEST(blas_syr, ForDoubleDataType) {
+  double S[] = {0, 0,
+                0, 0};
+  double u[] = {1, 0, 2};
+  blas_syr(CblasLower, 2, 3.0, u, 2, S, 2);
+  EXPECT_THAT(S, ElementsAre(3, 0,
+                             6, 12));
+}
+
+TEST(blas_spr, ForDoubleDataType) {
+  // Lower triangle, packed: {S00, S10, S11}.
+  double S[] = {1, 0, 0};
+  double u[] = {1, 0, 2};
+  blas_spr(CblasLower, 2, 3.0, u, 2, S);
+  EXPECT_THAT(S, ElementsAre(4, 6, 12));
+
+  // Upper triangle, packed: {S00, S01, S11}.
+  double T[] = {0, 0, 0};
+  blas_spr(CblasUpper, 2, 1.0, u, 2, T);
+  EXPECT_THAT(T, ElementsAre(1, 2, 4));
+}
+
+TEST(blas_ger, ForFloatDataType) {
+  float G[] = {1, 1, 1,
+               1, 1, 1};
+  float v[] = {1, 2};
+  float w[] = {1, -1, 3};
+  blas_ger(2, 3, 0.5f, v, 1, w, 1, G, 3);
+  EXPECT_THAT(G, ElementsAre(1.5, 0.5, 2.5,
+                             2, 0, 4));
+}
+
+// Operands of the batched gemm and gemv tests: size small integers, repeating
+// with the given period.
+template<typename T>
+std::vector<T> batch_operand(const std::size_t size, const int period) {
+  std::vector<T> A(size);
+  for (std::size_t i = 0; i < size; ++i) A[i] = T(i % period) - T(period / 2);
+  return A;
+}
+
+// Checks the batched gemm against one gemm per problem, for both the packed
+// kernels (M, N, K <= 16) and the BLAS calls.
+template<typename T>
+void check_gemm_batch(const int M, const int N, const int K) {
+  const int batch_count = 7;
+  const int sa = M * K, sb = K * N, sc = M * N;
+  const std::vector<T> A = batch_operand<T>(batch_count * sa, 7);
+  const std::vector<T> B = batch_operand<T>(batch_count * sb, 5);
+
+  const CBLAS_TRANSPOSE trans[] = {CblasNoTrans, CblasTrans};
+  for (CBLAS_TRANSPOSE ta : trans) {
+    for (CBLAS_TRANSPOSE tb : trans) {
+      const int lda = (ta == CblasNoTrans) ? K : M;
+      const int ldb = (tb == CblasNoTrans) ? N : K;
+      std::vector<T> expected(batch_count * sc, T(1));
+      std::vector<T> strided(expected), array(expected);
+
+      std::vector<const T*> a, b;
+      std::vector<T*> c;
+      for (int i = 0; i < batch_count; ++i) {
+        blas_gemm(ta, tb, M, N, K, T(2), &A[i * sa], lda, &B[i * sb], ldb,
+                  T(0.5), &expected[i * sc], N);
+        a.push_back(&A[i * sa]);
+        b.push_back(&B[i * sb]);
+        c.push_back(&array[i * sc]);
+      }
+
+      blas_gemm_batch(ta, tb, M, N, K, T(2), A.data(), lda, sa, B.data(),
+                      ldb, sb, T(0.5), strided.data(), N, sc, batch_count);
+      EXPECT_THAT(strided, ElementsAreArray(expected));
+
+      blas_gemm_batch(ta, tb, M, N, K, T(2), a.data(), lda, b.data(), ldb,
+                      T(0.5), c.data(), N, batch_count);
+      EXPECT_THAT(array, ElementsAreArray(expected));
+    }
+  }
+}
+
+// Checks the batched gemv, y[i] <- op(A[i]) * x[i], against one gemv per
+// problem.
+template<typename T>
+void check_gemv_batch(const int M, const int K) {
+  const int batch_count = 7;
+  const int sa = M * K;
+  const std::vector<T> A = batch_operand<T>(batch_count * sa, 7);
+
+  const CBLAS_TRANSPOSE trans[] = {CblasNoTrans, CblasTrans};
+  for (CBLAS_TRANSPOSE ta : trans) {
+    const int m = (ta == CblasNoTrans) ? M : K;
+    const int n = (ta == CblasNoTrans) ? K : M;
+    const std::vector<T> X = batch_operand<T>(batch_count * n, 3);
+
+    std::vector<T> expected(batch_count * m, T(1));
+    std::vector<T> strided(expected), array(expected);
+    std::vector<const T*> a, x;
+    std::vector<T*> y;
+    for (int i = 0; i < batch_count; ++i) {
+      blas_gemv(ta, M, K, T(1), &A[i * sa], K, &X[i * n], 1, T(0),
+                &expected[i * m], 1);
+      a.push_back(&A[i * sa]);
+      x.push_back(&X[i * n]);
+      y.push_back(&array[i * m]);
+    }
+
+    blas_gemv_batch(ta, M, K, T(1), A.data(), K, sa, X.data(), n, T(0),
+                    strided.data(), m, batch_count);
+    EXPECT_THAT(strided, ElementsAreArray(expected));
+
+    blas_gemv_batch(ta, M, K, T(1), a.data(), K, x.data(), T(0), y.data(),
+                    batch_count);
+    EXPECT_THAT(array, ElementsAreArray(expected));
+  }
+}
+
+TEST(blas_gemm_batch, ForFloatDataType) {
+  check_gemm_batch<float>(3, 4, 5);
+  check_gemm_batch<float>(20, 3, 17);
+}
+
+TEST(blas_gemm_batch, ForDoubleDataType) {
+  check_gemm_batch<double>(3, 4, 5);
+  check_gemm_batch<double>(16, 16, 16);
+  check_gemm_batch<double>(17, 18, 19);
+  check_gemm_batch<double>(64, 65, 3);
+}
+
+TEST(blas_gemv_batch, ForFloatDataType) {
+  check_gemv_batch<float>(3, 5);
+  check_gemv_batch<float>(20, 17);
+}
+
+TEST(blas_gemv_batch, ForDoubleDataType) {
+  check_gemv_batch<double>(3, 5);
+  check_gemv_batch<double>(16, 16);
+  check_gemv_batch<double>(17, 19);
+  check_gemv_batch<double>(70, 64);
+}
+
+TEST(blas_sum, ForFloatDataType) {
+  float x[] = {3, -4, 1, 7, -2};
+  EXPECT_THAT(blas_sum(5, x), FloatEq(5));
+}
+
+TEST(blas_sum, ForDoubleDataType) {
+  double y[] = {-1.5, 2.5, 0.5};
+  EXPECT_THAT(blas_sum(3, y), DoubleEq(1.5));
+  EXPECT_THAT(blas_sum(0, y), DoubleEq(0));
+}
+
+TEST(blas_asum, ForFloatDataType) {
+  float x[] = {3, -4, 1, 7, -2};
+  EXPECT_THAT(blas_asum(5, x), FloatEq(17));
+}
+
+TEST(blas_asum, ForDoubleDataType) {
+  double y[] = {-1.5, 2.5, 0.5};
+  EXPECT_THAT(blas_asum(3, y), DoubleEq(4.5));
+}
+
+TEST(blas_min, ForFloatDataType) {
+  float x[] = {3, -4, 1, 7, -2};
+  EXPECT_THAT(blas_min(5, x), FloatEq(-4));
+}
+
+TEST(blas_min, ForDoubleDataType) {
+  double y[] = {-1.5, 2.5, 0.5};
+  EXPECT_THAT(blas_min(3, y), DoubleEq(-1.5));
+}
+
+TEST(blas_max, ForFloatDataType) {
+  float x[] = {3, -4, 1, 7, -2};
+  EXPECT_THAT(blas_max(5, x), FloatEq(7));
+}
+
+TEST(blas_max, ForDoubleDataType) {
+  double y[] = {-1.5, 2.5, 0.5};
+  EXPECT_THAT(blas_max(3, y), DoubleEq(2.5));
+}
+
 }  // namespace linalg_detail
 }  // namespace insight
@@ -0,0 +1,149 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include "insight/linalg.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::DoubleEq;
+
+TEST(block_view, of_a_dense_matrix) {
+  matrix<double> A = {{1, 2, 3, 4},
+                      {5, 6, 7, 8},
+                      {9, 10, 11, 12}};
+
+  auto b = A.block(1, 1, 2, 3);
+  EXPECT_EQ(b.row_count(), 2);
+  EXPECT_EQ(b.col_count(), 3);
+  EXPECT_EQ(b.size(), 6);
+  EXPECT_EQ(b.ld(), 4);
+  EXPECT_EQ(b.data(), A.data() + 5);
+  EXPECT_THAT(b, ElementsAre(6, 7, 8, 10, 11, 12));
+
+  b *= 2.0;
+  b -= 1.0;
+  EXPECT_THAT(A, ElementsAreArray({1, 2, 3, 4,
+                                   5, 11, 13, 15,
+                                   9, 19, 21, 23}));
+
+  matrix<double> B = A.block(0, 2, 3, 2);
+  EXPECT_THAT(B, ElementsAre(3, 4, 13, 15, 21, 23));
+
+  EXPECT_DEATH(A.block(2, 0, 2, 1), "invalid block");
+  EXPECT_DEATH(A.block(0, 1, 1, 4), "invalid block");
+}
+
+TEST(block_view, empty_block) {
+  matrix<double> A = {{1, 2, 3},
+                      {4, 5, 6}};
+  matrix<double> B = {{1, 2}, {3, 4}};
+
+  auto b = A.block(1, 1, 0, 2);
+  EXPECT_EQ(b.row_count(), 0);
+  EXPECT_EQ(b.size(), 0);
+  EXPECT_FALSE(b.aliases(A.data(), A.data() + A.size()));
+
+  // Nothing is written, neither by the elementwise nor by the gemm paths.
+  b = matmul(A.block(0, 0, 0, 2), B);
+  b += 2.0 * matmul(A.block(0, 1, 0, 2), B);
+  A.block(0, 2, 2, 0) -= A.block(0, 0, 2, 0);
+  EXPECT_THAT(A, ElementsAreArray({1, 2, 3,
+                                   4, 5, 6}));
+}
+
+TEST(block_view, expression_assignment) {
+  matrix<double> A(3, 4, 0.0);
+  matrix<double> B = {{1, 2}, {3, 4}};
+
+  A.block(1, 2, 2, 2) = B * 2.0 + 1.0;
+  EXPECT_THAT(A, ElementsAreArray({0, 0, 0, 0,
+                                   0, 0, 3, 5,
+                                   0, 0, 7, 9}));
+
+  // Reads the block itself.
+  A.block(1, 2, 2, 2) = A.block(1, 2, 2, 2).t();
+  EXPECT_THAT(A, ElementsAreArray({0, 0, 0, 0,
+                                   0, 0, 3, 7,
+                                   0, 0, 5, 9}));
+
+  // Overlapping blocks.
+  A.block(0, 1, 2, 2) = A.block(1, 2, 2, 2);
+  EXPECT_THAT(A, ElementsAreArray({0, 3, 7, 0,
+                                   0, 5, 9, 7,
+                                   0, 0, 5, 9}));
+
+  A.block(2, 0, 1, 2) *= B.row_at(1);
+  A.block(2, 0, 1, 2) += exp(B.row_at(0) * 0.0);
+  EXPECT_THAT(A.row_at(2), ElementsAre(1, 1, 5, 9));
+
+  EXPECT_DEATH(A.block(0, 0, 2, 2) = A, "mismatched");
+}
+
+TEST(block_view, axpy) {
+  matrix<double> A(3, 3, 1.0);
+  matrix<double> B = {{1, 2}, {3, 4}};
+
+  A.block(0, 1, 2, 2) += 2.0 * B;
+  EXPECT_THAT(A, ElementsAre(1, 3, 5,
+                             1, 7, 9,
+                             1, 1, 1));
+
+  A.block(1, 0, 2, 2) -= A.block(0, 1, 2, 2);
+  EXPECT_THAT(A, ElementsAre(1, 3, 5,
+                             -2, 2, 9,
+                             -6, -8, 1));
+}
+
+TEST(block_view, matmul_operand) {
+  matrix<double> A = {{1, 2, 3, 4},
+                      {5, 6, 7, 8},
+                      {9, 10, 11, 12}};
+  vector<double> x = {1, -1};
+  matrix<double> C = A.block(1, 1, 2, 2);
+
+  vector<double> y = matmul(A.block(1, 1, 2, 2), x);
+  EXPECT_THAT(y, ElementsAre(-1, -1));
+
+  y = matmul(A.block(1, 1, 2, 2).t(), x);
+  EXPECT_THAT(y, ElementsAre(-4, -4));
+
+  matrix<double> D = matmul(A.block(0, 0, 2, 3), A.block(0, 1, 3, 2));
+  matrix<double> E = matmul(matrix<double>(A.block(0, 0, 2, 3)),
+                            matrix<double>(A.block(0, 1, 3, 2)));
+  EXPECT_THAT(D, ElementsAre(44, 50, 116, 134));
+  EXPECT_THAT(D, ElementsAre(E[0], E[1], E[2], E[3]));
+
+  D = matmul(C.t(), A.block(1, 2, 2, 2));
+  EXPECT_THAT(D, ElementsAre(152, 168, 170, 188));
+}
+
+TEST(block_view, gemm_into_block) {
+  matrix<double> A = {{1, 2}, {3, 4}};
+  matrix<double> B = {{0, 1}, {1, 0}};
+  matrix<double> C(3, 4, 0.0);
+
+  C.block(1, 1, 2, 2) = matmul(A, B);
+  EXPECT_THAT(C, ElementsAreArray({0, 0, 0, 0,
+                                   0, 2, 1, 0,
+                                   0, 4, 3, 0}));
+
+  C.block(1, 1, 2, 2) += 2.0 * matmul(A, B.t());
+  C.block(0, 2, 2, 2) -= matmul(A.t(), B);
+  EXPECT_THAT(C, ElementsAreArray({0, 0, -3, -1,
+                                   0, 6, -1, -2,
+                                   0, 12, 9, 0}));
+
+  // The product reads the block it is written to.
+  C.block(1, 1, 2, 2) = matmul(C.block(1, 1, 2, 2), B);
+  EXPECT_THAT(C, ElementsAreArray({0, 0, -3, -1,
+                                   0, -1, 6, -2,
+                                   0, 9, 12, 0}));
+}
+
+}  // namespace insight
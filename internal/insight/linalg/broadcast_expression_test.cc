@@ -0,0 +1,205 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include "insight/linalg/matrix.h"
+#include "insight/linalg/vector.h"
+#include "insight/linalg/functions.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using ::testing::DoubleEq;
+
+TEST(broadcast_expression, matrix_with_row_vector) {
+  matrix<double> A = {{1, 2, 3}, {4, 5, 6}};
+  vector<double> b = {10, 20, 30};
+
+  const auto bt = b.t();
+  auto e = A + bt;
+  EXPECT_EQ(e.row_count(), 2);
+  EXPECT_EQ(e.col_count(), 3);
+  EXPECT_EQ(e.eval(4), 25);
+  EXPECT_THAT(e, ElementsAre(11, 22, 33, 14, 25, 36));
+
+  matrix<double> C = A + b.t();
+  EXPECT_THAT(C, ElementsAre(11, 22, 33, 14, 25, 36));
+
+  C = A - b.t();
+  EXPECT_THAT(C, ElementsAre(-9, -18, -27, -6, -15, -24));
+
+  C = b.t() - A;
+  EXPECT_THAT(C, ElementsAre(9, 18, 27, 6, 15, 24));
+
+  C = A * b.t();
+  EXPECT_THAT(C, ElementsAre(10, 40, 90, 40, 100, 180));
+
+  C = b.t() / A;
+  EXPECT_THAT(C, ElementsAre(10, 10, 10, 2.5, 4, 5));
+}
+
+TEST(broadcast_expression, matrix_with_column_vector) {
+  matrix<double> A = {{1, 2, 3}, {4, 5, 6}};
+  vector<double> b = {10, 20};
+
+  matrix<double> C = A + b;
+  EXPECT_THAT(C, ElementsAre(11, 12, 13, 24, 25, 26));
+
+  C = b - A;
+  EXPECT_THAT(C, ElementsAre(9, 8, 7, 16, 15, 14));
+
+  C = A * b;
+  EXPECT_THAT(C, ElementsAre(10, 20, 30, 80, 100, 120));
+
+  C = A / b;
+  EXPECT_THAT(C, ElementsAre(0.1, 0.2, 0.3, 0.2, 0.25, 0.3));
+
+  matrix<int> B = {{1, 2}, {3, 4}};
+  vector<int> x = {1, -1};
+  matrix<int> D = B + x;
+  EXPECT_THAT(D, ElementsAre(2, 3, 2, 3));
+  D = B + x.t();
+  EXPECT_THAT(D, ElementsAre(2, 1, 4, 3));
+}
+
+TEST(broadcast_expression, with_a_row_of_a_matrix) {
+  matrix<double> A = {{1, 2}, {3, 4}, {5, 6}};
+
+  matrix<double> C = A - A.row_at(0);
+  EXPECT_THAT(C, ElementsAre(0, 0, 2, 2, 4, 4));
+
+  // The row is read from the destination.
+  A = A - A.row_at(0);
+  EXPECT_THAT(A, ElementsAre(0, 0, 2, 2, 4, 4));
+
+  // Rows of a matrix are still combined elementwise.
+  matrix<double> B = {{1, 2}, {3, 4}};
+  matrix<double> D = B.row_at(0) + B.row_at(1);
+  EXPECT_EQ(D.row_count(), 1);
+  EXPECT_THAT(D, ElementsAre(4, 6));
+}
+
+TEST(broadcast_expression, fused_with_the_rest_of_the_tree) {
+  matrix<double> X = {{1, 0}, {0, 1}, {1, 1}};
+  matrix<double> W = {{1, -2, 3}, {-4, 5, -6}};
+  vector<double> b = {1, 1, 1};
+
+  // Bias add and activation over a minibatch.
+  matrix<double> H = sqrt(exp(matmul(X, W) + b.t()) * 2.0);
+  matrix<double> expected = {{2, -1, 4}, {-3, 6, -5}, {-2, 4, -2}};
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_THAT(H.data()[i],
+                DoubleEq(std::sqrt(std::exp(expected.data()[i]) * 2.0)));
+  }
+
+  // Normalizes the rows.
+  matrix<double> A = {{1, 3}, {2, 6}};
+  matrix<double> N = (A - mean(A, rowwise)) / (max(A, rowwise) -
+                                               min(A, rowwise));
+  EXPECT_THAT(N, ElementsAre(-0.5, 0.5, -0.5, 0.5));
+
+  // Standardizes the columns.
+  N = A - mean(A, colwise).t();
+  EXPECT_THAT(N, ElementsAre(-0.5, -1.5, 0.5, 1.5));
+
+  // In place.
+  vector<double> c = {1, 1};
+  A = A + 2.0 * (A + c.t());
+  EXPECT_THAT(A, ElementsAre(5, 11, 8, 20));
+}
+
+TEST(broadcast_expression, with_a_row_vector_expression) {
+  matrix<double> X = {{1, 2, 3}, {4, 5, 6}};
+  vector<double> b = {10, 20, 30};
+  vector<double> c = {2, 4, 6};
+
+  // Scaled bias, with the scalar on either side.
+  matrix<double> Y = X + b.t() * 0.0;
+  EXPECT_THAT(Y, ElementsAre(1, 2, 3, 4, 5, 6));
+  Y = X + 0.5 * b.t();
+  EXPECT_THAT(Y, ElementsAre(6, 12, 18, 9, 15, 21));
+  Y = X - b.t() * -1.0;
+  EXPECT_THAT(Y, ElementsAre(11, 22, 33, 14, 25, 36));
+
+  // Row vectors combined with each other, or transformed elementwise.
+  Y = X * (b.t() - c.t());
+  EXPECT_THAT(Y, ElementsAre(8, 32, 72, 32, 80, 144));
+  Y = (0.5 * c.t() - 1.0) + X;
+  EXPECT_THAT(Y, ElementsAre(1, 3, 5, 4, 6, 8));
+  Y = X / sqrt(c.t() * c.t() * 0.25);
+  EXPECT_THAT(Y, ElementsAre(1, 1, 1, 4, 2.5, 2));
+}
+
+TEST(broadcast_expression, compound_assignment_with_row_vector) {
+  matrix<double> A = {{1, 2, 3}, {4, 5, 6}};
+  vector<double> b = {10, 20, 30};
+
+  // The bias add.
+  A += b.t();
+  EXPECT_THAT(A, ElementsAre(11, 22, 33, 14, 25, 36));
+
+  A -= b.t();
+  EXPECT_THAT(A, ElementsAre(1, 2, 3, 4, 5, 6));
+
+  A *= 0.5 * b.t();
+  EXPECT_THAT(A, ElementsAre(5, 20, 45, 20, 50, 90));
+
+  A /= b.t();
+  EXPECT_THAT(A, ElementsAre(0.5, 1, 1.5, 2, 2.5, 3));
+
+  // The row is read from the destination.
+  A -= A.row_at(0);
+  EXPECT_THAT(A, ElementsAre(0, 0, 0, 1.5, 1.5, 1.5));
+
+  // A matrix with a single row is still updated elementwise.
+  matrix<double> r = {{1, 2, 3}};
+  r += b.t();
+  EXPECT_THAT(r, ElementsAre(11, 22, 33));
+}
+
+TEST(broadcast_expression, compound_assignment_with_column_vector) {
+  matrix<double> A = {{1, 2, 3}, {4, 5, 6}};
+  vector<double> b = {10, 20};
+
+  A += b;
+  EXPECT_THAT(A, ElementsAre(11, 12, 13, 24, 25, 26));
+
+  A -= b;
+  EXPECT_THAT(A, ElementsAre(1, 2, 3, 4, 5, 6));
+
+  A *= 2.0 * b;
+  EXPECT_THAT(A, ElementsAre(20, 40, 60, 160, 200, 240));
+
+  A /= b;
+  EXPECT_THAT(A, ElementsAre(2, 4, 6, 8, 10, 12));
+
+  // Centers the rows.
+  A -= mean(A, rowwise);
+  EXPECT_THAT(A, ElementsAre(-2, 0, 2, -2, 0, 2));
+
+  // The column is read from the destination.
+  A -= A.col_at(2);
+  EXPECT_THAT(A, ElementsAre(-4, -2, 0, -4, -2, 0));
+}
+
+TEST(broadcast_expression, transpose) {
+  matrix<double> A = {{1, 2, 3}, {4, 5, 6}};
+  vector<double> b = {10, 20, 30};
+
+  matrix<double> C = (A + b.t()).t();
+  EXPECT_THAT(C, ElementsAre(11, 14, 22, 25, 33, 36));
+}
+
+TEST(broadcast_expression, mismatched_dimensions) {
+  matrix<double> A = {{1, 2, 3}, {4, 5, 6}};
+  vector<double> b = {1, 2};
+  EXPECT_DEATH(A + b.t(), "broadcast");
+  EXPECT_DEATH(A + vector<double>({1, 2, 3}), "broadcast");
+  EXPECT_DEATH(A += b.t(), "broadcast");
+  EXPECT_DEATH(A -= vector<double>({1, 2, 3}), "broadcast");
+}
+
+}  // namespace insight
@@ -0,0 +1,116 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include "insight/linalg/matrix.h"
+#include "insight/linalg/vector.h"
+#include "insight/linalg/functions.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using ::testing::DoubleEq;
+
+TEST(col_view, of_a_dense_matrix) {
+  matrix<double> A = {{1, 2, 3}, {4, 5, 6}};
+
+  auto second_col = A.col_at(1);
+
+  EXPECT_EQ(second_col.size(), 2);
+  EXPECT_EQ(second_col.row_count(), 2);
+  EXPECT_EQ(second_col.col_count(), 1);
+  EXPECT_EQ(second_col.stride(), 3);
+  EXPECT_EQ(second_col.data(), A.data() + 1);
+  EXPECT_THAT(second_col, ElementsAre(2, 5));
+
+  second_col *= 2.0;
+  EXPECT_THAT(A, ElementsAre(1, 4, 3, 4, 10, 6));
+
+  second_col /= 4.0;
+  EXPECT_THAT(A, ElementsAre(1, 1, 3, 4, 2.5, 6));
+}
+
+TEST(col_view, dot_and_nrm2) {
+  matrix<double> A = {{3, 1, 2}, {4, 2, 1}};
+  vector<double> x = {1, 2};
+
+  EXPECT_THAT(A.col_at(0).nrm2(), DoubleEq(5));
+  EXPECT_THAT(A.col_at(0).dot(A.col_at(1)), DoubleEq(11));
+  EXPECT_THAT(A.col_at(2).dot(x), DoubleEq(4));
+  EXPECT_THAT(A.col_at(2).dot(2.0 * x), DoubleEq(8));
+
+  matrix<int> B = {{3, 1}, {4, 2}};
+  EXPECT_EQ(B.col_at(0).nrm2(), 5);
+  EXPECT_EQ(B.col_at(0).dot(B.col_at(1)), 11);
+}
+
+TEST(col_view, assign_expressions) {
+  matrix<double> A = {{1, 2, 3}, {4, 5, 6}};
+  matrix<double> B = {{10, 20}, {30, 40}};
+  vector<double> x = {1, 2};
+
+  A.col_at(0) = B.col_at(1);
+  EXPECT_THAT(A, ElementsAre(20, 2, 3, 40, 5, 6));
+
+  A.col_at(0) = 0.5 * x;
+  EXPECT_THAT(A, ElementsAre(0.5, 2, 3, 1, 5, 6));
+
+  A.col_at(2) = sqrt(x * x) + A.col_at(1);
+  EXPECT_THAT(A, ElementsAre(0.5, 2, 3, 1, 5, 7));
+
+  // Columns of the destination matrix itself.
+  A.col_at(1) = A.col_at(2) - A.col_at(1);
+  EXPECT_THAT(A, ElementsAre(0.5, 1, 3, 1, 2, 7));
+
+  A.col_at(0) = A.col_at(0) * 2.0;
+  EXPECT_THAT(A, ElementsAre(1, 1, 3, 2, 2, 7));
+
+  matrix<double> C = {{1, 2}, {3, 4}};
+  C.col_at(1) = matmul(C, C.col_at(1));
+  EXPECT_THAT(C, ElementsAre(1, 10, 3, 22));
+}
+
+TEST(col_view, compound_assign_expressions) {
+  matrix<double> A = {{1, 2, 3}, {4, 5, 6}};
+  vector<double> x = {1, 2};
+
+  A.col_at(0) += x;
+  EXPECT_THAT(A, ElementsAre(2, 2, 3, 6, 5, 6));
+
+  A.col_at(1) -= 2.0 * A.col_at(0);
+  EXPECT_THAT(A, ElementsAre(2, -2, 3, 6, -7, 6));
+
+  A.col_at(2) *= A.col_at(0) + 1.0;
+  EXPECT_THAT(A, ElementsAre(2, -2, 9, 6, -7, 42));
+
+  A.col_at(2) /= x;
+  EXPECT_THAT(A, ElementsAre(2, -2, 9, 6, -7, 21));
+
+  matrix<int> B = {{1, 2}, {3, 4}};
+  vector<int> y = {1, 1};
+  B.col_at(1) += 2 * B.col_at(0) - y;
+  EXPECT_THAT(B, ElementsAre(1, 3, 3, 9));
+}
+
+TEST(col_view, standardize_columns) {
+  matrix<double> A = {{1, 10}, {3, 20}, {5, 60}};
+  const double n = static_cast<double>(A.row_count());
+  vector<double> ones(A.row_count(), 1.0);
+
+  for (size_t j = 0; j < A.col_count(); ++j) {
+    auto c = A.col_at(j);
+    const double mean = c.dot(ones) / n;
+    c -= mean * ones;
+    c /= c.nrm2() / std::sqrt(n);
+  }
+
+  for (size_t j = 0; j < A.col_count(); ++j) {
+    EXPECT_NEAR(A.col_at(j).dot(ones), 0.0, 1e-12);
+    EXPECT_NEAR(A.col_at(j).nrm2(), std::sqrt(3.0), 1e-12);
+  }
+}
+
+}  // namespace insight
@@ -0,0 +1,212 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+#include "insight/linalg.h"
+#include "insight/linalg/test_util.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::DoubleNear;
+using ::testing::ElementsAre;
+using test::max_abs_diff;
+using test::random_matrix;
+using test::random_symmetric_matrix;
+
+namespace {
+
+template<typename T>
+matrix<T> identity(std::size_t n) {
+  matrix<T> I(n, n, T(0));
+  for (std::size_t i = 0; i < n; ++i) I(i, i) = T(1);
+  return I;
+}
+
+// A * diag(d).
+template<typename T>
+matrix<T> scale_columns(const matrix<T>& A, const vector<T>& d) {
+  matrix<T> result(A);
+  for (std::size_t i = 0; i < A.row_count(); ++i) {
+    for (std::size_t j = 0; j < A.col_count(); ++j) result(i, j) *= d[j];
+  }
+  return result;
+}
+
+// An m x n matrix of rank at most n, with singular values s and random
+// singular vectors.
+matrix<double> matrix_with_singular_values(std::size_t m, std::size_t n,
+                                           const vector<double>& s,
+                                           std::mt19937* gen) {
+  const matrix<double> U = qr<double>(random_matrix<double>(m, s.size(),
+                                                            gen)).q();
+  const matrix<double> V = qr<double>(random_matrix<double>(n, s.size(),
+                                                            gen)).q();
+  const matrix<double> US = scale_columns(U, s);
+  matrix<double> A = matmul(US, V.t());
+  return A;
+}
+
+}  // namespace
+
+TEST(decomposition, eigh) {
+  std::mt19937 gen(1);
+  for (std::size_t n : {1, 2, 5, 40, 100}) {
+    SCOPED_TRACE(n);
+    const matrix<double> A = random_symmetric_matrix<double>(n, &gen);
+    const eigen_decomposition<double> e = eigh(A);
+    ASSERT_EQ(e.values.size(), n);
+    ASSERT_EQ(e.vectors.row_count(), n);
+    ASSERT_EQ(e.vectors.col_count(), n);
+
+    EXPECT_TRUE(std::is_sorted(e.values.begin(), e.values.end(),
+                               [](double a, double b) { return a > b; }));
+
+    // A * V = V * diag(values), and V is orthogonal.
+    const matrix<double> AV = matmul(A, e.vectors);
+    EXPECT_LT(max_abs_diff(AV, scale_columns(e.vectors, e.values)), 1e-11);
+    const matrix<double> VtV = matmul(e.vectors.t(), e.vectors);
+    EXPECT_LT(max_abs_diff(VtV, identity<double>(n)), 1e-12);
+  }
+}
+
+TEST(decomposition, eigh_known_values) {
+  const matrix<double> A = {{2.0, 1.0, 0.0},
+                            {1.0, 2.0, 0.0},
+                            {0.0, 0.0, 5.0}};
+  const eigen_decomposition<double> e = eigh(A);
+  EXPECT_THAT(e.values, ElementsAre(DoubleNear(5.0, 1e-14),
+                                    DoubleNear(3.0, 1e-14),
+                                    DoubleNear(1.0, 1e-14)));
+  EXPECT_NEAR(std::fabs(e.vectors(2, 0)), 1.0, 1e-14);
+
+  // Only the lower triangle is read.
+  const matrix<double> L = {{2.0, -7.0, 3.0},
+                            {1.0, 2.0, -9.0},
+                            {0.0, 0.0, 5.0}};
+  EXPECT_THAT(eigh(L).values, ElementsAre(DoubleNear(5.0, 1e-14),
+                                          DoubleNear(3.0, 1e-14),
+                                          DoubleNear(1.0, 1e-14)));
+}
+
+TEST(decomposition, eigh_partial) {
+  std::mt19937 gen(2);
+  const matrix<double> A = random_symmetric_matrix<double>(60, &gen);
+  const eigen_decomposition<double> all = eigh(A);
+  const eigen_decomposition<double> top = eigh(A, 7);
+  ASSERT_EQ(top.values.size(), 7);
+  ASSERT_EQ(top.vectors.row_count(), 60);
+  ASSERT_EQ(top.vectors.col_count(), 7);
+
+  for (std::size_t i = 0; i < 7; ++i) {
+    EXPECT_NEAR(top.values[i], all.values[i], 1e-12);
+  }
+  const matrix<double> AV = matmul(A, top.vectors);
+  EXPECT_LT(max_abs_diff(AV, scale_columns(top.vectors, top.values)), 1e-11);
+
+  EXPECT_EQ(eigh(A, 0).values.size(), 0);
+}
+
+TEST(decomposition, eigh_float) {
+  std::mt19937 gen(3);
+  const matrix<float> A = random_symmetric_matrix<float>(30, &gen);
+  const eigen_decomposition<float> e = eigh(A);
+  const matrix<float> AV = matmul(A, e.vectors);
+  EXPECT_LT(max_abs_diff(AV, scale_columns(e.vectors, e.values)), 1e-4);
+}
+
+TEST(decomposition, svd) {
+  std::mt19937 gen(4);
+  const std::size_t shapes[][2] = {{1, 1}, {6, 4}, {4, 6}, {50, 20},
+                                   {20, 50}, {33, 33}};
+  for (const auto& shape : shapes) {
+    const std::size_t m = shape[0], n = shape[1], k = std::min(m, n);
+    SCOPED_TRACE(testing::Message() << m << "x" << n);
+    const matrix<double> A = random_matrix<double>(m, n, &gen);
+    const singular_value_decomposition<double> d = svd(A);
+    ASSERT_EQ(d.u.row_count(), m);
+    ASSERT_EQ(d.u.col_count(), k);
+    ASSERT_EQ(d.s.size(), k);
+    ASSERT_EQ(d.vt.row_count(), k);
+    ASSERT_EQ(d.vt.col_count(), n);
+
+    EXPECT_TRUE(std::is_sorted(d.s.begin(), d.s.end(),
+                               [](double a, double b) { return a > b; }));
+    EXPECT_GE(d.s[k - 1], 0.0);
+
+    const matrix<double> US = scale_columns(d.u, d.s);
+    const matrix<double> USVt = matmul(US, d.vt);
+    EXPECT_LT(max_abs_diff(USVt, A), 1e-12);
+
+    const matrix<double> UtU = matmul(d.u.t(), d.u);
+    const matrix<double> VtV = matmul(d.vt, d.vt.t());
+    EXPECT_LT(max_abs_diff(UtU, identity<double>(k)), 1e-12);
+    EXPECT_LT(max_abs_diff(VtV, identity<double>(k)), 1e-12);
+  }
+}
+
+TEST(decomposition, svd_known_values) {
+  const vector<double> s = {4.0, 2.0, 0.5};
+  std::mt19937 gen(5);
+  const matrix<double> A = matrix_with_singular_values(8, 5, s, &gen);
+  EXPECT_THAT(svd(A).s, ElementsAre(DoubleNear(4.0, 1e-12),
+                                    DoubleNear(2.0, 1e-12),
+                                    DoubleNear(0.5, 1e-12),
+                                    DoubleNear(0.0, 1e-12),
+                                    DoubleNear(0.0, 1e-12)));
+}
+
+TEST(decomposition, randomized_svd) {
+  std::mt19937 gen(6);
+
+  // Fast decaying singular values: the leading ones are recovered to
+  // nearly machine precision.
+  vector<double> s(40);
+  for (std::size_t i = 0; i < s.size(); ++i) s[i] = std::pow(0.7, i);
+  const matrix<double> A = matrix_with_singular_values(500, 120, s, &gen);
+
+  const singular_value_decomposition<double> d = randomized_svd(A, 10);
+  ASSERT_EQ(d.u.row_count(), 500);
+  ASSERT_EQ(d.u.col_count(), 10);
+  ASSERT_EQ(d.s.size(), 10);
+  ASSERT_EQ(d.vt.row_count(), 10);
+  ASSERT_EQ(d.vt.col_count(), 120);
+  for (std::size_t i = 0; i < 10; ++i) EXPECT_NEAR(d.s[i], s[i], 1e-8);
+
+  const matrix<double> UtU = matmul(d.u.t(), d.u);
+  const matrix<double> VtV = matmul(d.vt, d.vt.t());
+  EXPECT_LT(max_abs_diff(UtU, identity<double>(10)), 1e-12);
+  EXPECT_LT(max_abs_diff(VtV, identity<double>(10)), 1e-12);
+
+  // The rank-10 approximation is as good as the truncated SVD: its error
+  // is about s[10].
+  const matrix<double> US = scale_columns(d.u, d.s);
+  const matrix<double> approximation = matmul(US, d.vt);
+  EXPECT_LT(max_abs_diff(approximation, A), 2.0 * s[10]);
+
+  // The same seed, the same result.
+  const singular_value_decomposition<double> again = randomized_svd(A, 10);
+  EXPECT_EQ(max_abs_diff(again.u, d.u), 0.0);
+}
+
+TEST(decomposition, randomized_svd_exact_rank) {
+  std::mt19937 gen(7);
+  const vector<double> s = {10.0, 5.0, 1.0};
+  const matrix<double> A = matrix_with_singular_values(300, 80, s, &gen);
+  const singular_value_decomposition<double> d = randomized_svd(A, 3, 5, 0);
+  EXPECT_THAT(d.s, ElementsAre(DoubleNear(10.0, 1e-10),
+                               DoubleNear(5.0, 1e-10),
+                               DoubleNear(1.0, 1e-10)));
+  const matrix<double> US = scale_columns(d.u, d.s);
+  const matrix<double> USVt = matmul(US, d.vt);
+  EXPECT_LT(max_abs_diff(USVt, A), 1e-10);
+}
+
+}  // namespace insight
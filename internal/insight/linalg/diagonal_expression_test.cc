@@ -0,0 +1,154 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+#include "insight/linalg.h"
+#include "insight/linalg/test_util.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using test::max_abs_diff;
+using test::random_matrix;
+using test::random_vector;
+
+namespace {
+
+// The dense matrix diag(v).
+template<typename T>
+matrix<T> dense_diag(const vector<T>& v) {
+  matrix<T> D(v.size(), v.size(), T(0));
+  for (std::size_t i = 0; i < v.size(); ++i) D(i, i) = v[i];
+  return D;
+}
+
+}  // namespace
+
+TEST(diagonal_expression, elements) {
+  const vector<double> v = {1.0, 2.0, 3.0};
+
+  matrix<double> D = diag(v);
+  EXPECT_THAT(D, ElementsAre(1.0, 0.0, 0.0,
+                             0.0, 2.0, 0.0,
+                             0.0, 0.0, 3.0));
+
+  const matrix<double> A = {{1.0, 1.0, 1.0},
+                            {1.0, 1.0, 1.0},
+                            {1.0, 1.0, 1.0}};
+  D = A + 2.0 * diag(v).t();
+  EXPECT_THAT(D, ElementsAre(3.0, 1.0, 1.0,
+                             1.0, 5.0, 1.0,
+                             1.0, 1.0, 7.0));
+
+  EXPECT_EQ(sum(diag(v)), 6.0);
+  EXPECT_EQ(diag(v).row_count(), 3);
+  EXPECT_EQ(diag(v).col_count(), 3);
+}
+
+TEST(diagonal_expression, scaling) {
+  const matrix<double> X = {{1.0, 2.0, 3.0},
+                            {4.0, 5.0, 6.0}};
+  const vector<double> w = {2.0, -1.0};
+  const vector<double> s = {1.0, 0.0, 10.0};
+
+  matrix<double> Y = matmul(diag(w), X);
+  EXPECT_THAT(Y, ElementsAre(2.0, 4.0, 6.0,
+                             -4.0, -5.0, -6.0));
+
+  Y = matmul(X, diag(s));
+  EXPECT_THAT(Y, ElementsAre(1.0, 0.0, 30.0,
+                             4.0, 0.0, 60.0));
+
+  Y = matmul(matmul(diag(w), X), diag(s)) + 1.0;
+  EXPECT_THAT(Y, ElementsAre(3.0, 1.0, 61.0,
+                             -3.0, 1.0, -59.0));
+
+  vector<double> y = matmul(diag(w), w);
+  EXPECT_THAT(y, ElementsAre(4.0, 1.0));
+
+  Y = matmul(diag(w), diag(w));
+  EXPECT_THAT(Y, ElementsAre(4.0, 0.0, 0.0, 1.0));
+
+  // In place.
+  matrix<double> Z = X;
+  Z = matmul(diag(w), Z);
+  EXPECT_THAT(Z, ElementsAre(2.0, 4.0, 6.0,
+                             -4.0, -5.0, -6.0));
+}
+
+TEST(diagonal_expression, scaled_matvec) {
+  std::mt19937 gen(1);
+  const std::size_t sizes[] = {1, 7, 65};
+  for (std::size_t m : sizes) {
+    for (std::size_t n : sizes) {
+      const matrix<double> X = random_matrix<double>(m, n, &gen);
+      const vector<double> w = random_vector<double>(m, &gen);
+      const vector<double> s = random_vector<double>(n, &gen);
+      const vector<double> v = random_vector<double>(n, &gen);
+      const vector<double> b = random_vector<double>(m, &gen);
+
+      vector<double> y = matmul(matmul(diag(w), X), v);
+      vector<double> expected = matmul(matrix<double>(matmul(dense_diag(w),
+                                                             X)), v);
+      EXPECT_LE(max_abs_diff(y, expected), 1e-12);
+
+      y = matmul(matmul(X, diag(s)), v) + b;
+      expected = matmul(matrix<double>(matmul(X, dense_diag(s))), v) + b;
+      EXPECT_LE(max_abs_diff(y, expected), 1e-12);
+
+      const vector<float> xf = random_vector<float>(n, &gen);
+      const matrix<float> Xf = random_matrix<float>(m, n, &gen);
+      const vector<float> wf = random_vector<float>(m, &gen);
+      vector<float> yf = matmul(wf * Xf, xf);
+      vector<float> expected_f = wf * vector<float>(matmul(Xf, xf));
+      EXPECT_LE(max_abs_diff(yf, expected_f), 1e-4);
+    }
+  }
+}
+
+TEST(diagonal_expression, weighted_gram_matrix) {
+  std::mt19937 gen(1);
+  const std::size_t sizes[] = {1, 7, 65};
+  for (std::size_t n : sizes) {
+    for (std::size_t p : sizes) {
+      SCOPED_TRACE(n);
+      SCOPED_TRACE(p);
+      const matrix<double> X = random_matrix<double>(n, p, &gen);
+      vector<double> w = random_vector<double>(n, &gen);
+      for (auto& a : w) a = std::fabs(a);
+
+      const matrix<double> expected =
+          matmul(X.t(), matrix<double>(matmul(dense_diag(w), X)));
+
+      // syrk, in both forms.
+      matrix<double> H = matmul(X.t(), matmul(diag(w), X));
+      EXPECT_LE(max_abs_diff(H, expected), 1e-12);
+
+      H = matmul(matmul(X.t(), diag(w)), X);
+      EXPECT_LE(max_abs_diff(H, expected), 1e-12);
+
+      // Fused with the rest of the tree.
+      H = matmul(X.t(), matmul(diag(w), X)) + 1.0;
+      EXPECT_LE(max_abs_diff(H, matrix<double>(expected + 1.0)), 1e-12);
+
+      // A negative weight: gemm.
+      w[0] = -1.0;
+      const matrix<double> expected_gemm =
+          matmul(X.t(), matrix<double>(matmul(dense_diag(w), X)));
+      H = matmul(X.t(), matmul(diag(w), X));
+      EXPECT_LE(max_abs_diff(H, expected_gemm), 1e-12);
+      H = matmul(matmul(X.t(), diag(w)), X);
+      EXPECT_LE(max_abs_diff(H, expected_gemm), 1e-12);
+    }
+  }
+}
+
+}  // namespace insight
@@ -0,0 +1,154 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+//
+// Throughput of generic (non special) elementwise expressions, which are
+// evaluated in a single fused pass through eval(i) (see
+// expression_evaluator.h).
+//
+// Each tree is compared against a hand written loop that streams the same
+// number of arrays; being memory bound, both should run at close to the
+// memory bandwidth once the vectors no longer fit in the last level cache.
+//
+// Usage: expression_benchmark [size] [repetitions]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "insight/linalg/vector.h"
+#include "insight/linalg/functions.h"
+
+namespace insight {
+namespace {
+
+// Returns the best wall time of `repetitions` calls to f, in seconds.
+template<typename F>
+double best_time(int repetitions, F f) {
+  double best = std::numeric_limits<double>::max();
+  for (int r = 0; r < repetitions; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(stop - start).count());
+  }
+  return best;
+}
+
+void report(const std::string& name, int arrays, size_t n, size_t elem_size,
+            double seconds, double reference_seconds) {
+  const double bytes = static_cast<double>(arrays) * n * elem_size;
+  std::printf("  %-32s %9.3f ms %8.2f GB/s %7.2fx\n", name.c_str(),
+              seconds * 1e3, bytes / seconds * 1e-9,
+              reference_seconds / seconds);
+}
+
+template<typename T>
+void run(const char* type_name, size_t n, int repetitions) {
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<T> dist(T(1), T(2));
+  vector<T> x(n), y(n), z(n), u(n), v(n), w(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = dist(gen);
+    y[i] = dist(gen);
+    z[i] = dist(gen) + T(2);
+    u[i] = dist(gen);
+    v[i] = dist(gen);
+  }
+  const T a = T(1.5), b = T(0.5);
+
+  std::printf("%s, n = %zu (time, effective bandwidth, speed relative "
+              "to the hand written loop)\n", type_name, n);
+
+  // sqrt(a * x + y) / (z - b): 3 loads + 1 store.
+  {
+    const T* px = x.data();
+    const T* py = y.data();
+    const T* pz = z.data();
+    T* pw = w.data();
+    double ref = best_time(repetitions, [&]() {
+        for (size_t i = 0; i < n; ++i) {
+          pw[i] = std::sqrt(a * px[i] + py[i]) / (pz[i] - b);
+        }
+      });
+    double t = best_time(repetitions, [&]() {
+        w = sqrt(a * x + y) / (z - b);
+      });
+    report("hand written", 4, n, sizeof(T), ref, ref);
+    report("sqrt(a * x + y) / (z - b)", 4, n, sizeof(T), t, ref);
+  }
+
+  // (x + y) * (z - u): 4 loads + 1 store.
+  {
+    const T* px = x.data();
+    const T* py = y.data();
+    const T* pz = z.data();
+    const T* pu = u.data();
+    T* pw = w.data();
+    double ref = best_time(repetitions, [&]() {
+        for (size_t i = 0; i < n; ++i) {
+          pw[i] = (px[i] + py[i]) * (pz[i] - pu[i]);
+        }
+      });
+    double t = best_time(repetitions, [&]() {
+        w = (x + y) * (z - u);
+      });
+    report("hand written", 5, n, sizeof(T), ref, ref);
+    report("(x + y) * (z - u)", 5, n, sizeof(T), t, ref);
+  }
+
+  // x * y + z * u - v: 5 loads + 1 store.
+  {
+    const T* px = x.data();
+    const T* py = y.data();
+    const T* pz = z.data();
+    const T* pu = u.data();
+    const T* pv = v.data();
+    T* pw = w.data();
+    double ref = best_time(repetitions, [&]() {
+        for (size_t i = 0; i < n; ++i) {
+          pw[i] = px[i] * py[i] + pz[i] * pu[i] - pv[i];
+        }
+      });
+    double t = best_time(repetitions, [&]() {
+        w = x * y + z * u - v;
+      });
+    report("hand written", 6, n, sizeof(T), ref, ref);
+    report("x * y + z * u - v", 6, n, sizeof(T), t, ref);
+  }
+
+  // w += (x - y) / (z + u): 5 loads + 1 store.
+  {
+    const T* px = x.data();
+    const T* py = y.data();
+    const T* pz = z.data();
+    const T* pu = u.data();
+    T* pw = w.data();
+    double ref = best_time(repetitions, [&]() {
+        for (size_t i = 0; i < n; ++i) {
+          pw[i] += (px[i] - py[i]) / (pz[i] + pu[i]);
+        }
+      });
+    double t = best_time(repetitions, [&]() {
+        w += (x - y) / (z + u);
+      });
+    report("hand written", 6, n, sizeof(T), ref, ref);
+    report("w += (x - y) / (z + u)", 6, n, sizeof(T), t, ref);
+  }
+}
+
+}  // namespace
+}  // namespace insight
+
+int main(int argc, char** argv) {
+  const size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 24;
+  const int repetitions = argc > 2 ? std::atoi(argv[2]) : 10;
+  insight::run<float>("float", n, repetitions);
+  insight::run<double>("double", n, repetitions);
+  return 0;
+}
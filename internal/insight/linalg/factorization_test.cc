@@ -0,0 +1,208 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+#include "insight/linalg.h"
+#include "insight/linalg/test_util.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::DoubleNear;
+using ::testing::ElementsAre;
+using test::max_abs_diff;
+using test::random_matrix;
+using test::random_vector;
+
+namespace {
+
+// B * B^T + n * I.
+template<typename T>
+matrix<T> random_spd_matrix(std::size_t n, std::mt19937* gen) {
+  const matrix<T> B = random_matrix<T>(n, n, gen);
+  matrix<T> A = matmul(B, B.t());
+  for (std::size_t i = 0; i < n; ++i) A(i, i) += static_cast<T>(n);
+  return A;
+}
+
+// Sizes on both sides of the block size of the native implementations.
+const std::size_t sizes[] = {1, 2, 7, 64, 65, 150};
+
+}  // namespace
+
+TEST(factorization, cholesky) {
+  std::mt19937 gen(1);
+  for (std::size_t n : sizes) {
+    SCOPED_TRACE(n);
+    const matrix<double> A = random_spd_matrix<double>(n, &gen);
+    const cholesky<double> llt(A);
+    ASSERT_EQ(llt.info(), 0);
+
+    const matrix<double> L = llt.l();
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t j = i + 1; j < n; ++j) EXPECT_EQ(L(i, j), 0.0);
+    }
+    const matrix<double> LLt = matmul(L, L.t());
+    EXPECT_LT(max_abs_diff(LLt, A), 1e-10 * n);
+
+    const vector<double> x = random_vector<double>(n, &gen);
+    const vector<double> b = matmul(A, x);
+    EXPECT_LT(max_abs_diff(llt.solve(b), x), 1e-10);
+
+    // Several right hand sides, solved at once.
+    const matrix<double> X = random_matrix<double>(n, 3, &gen);
+    const matrix<double> B = matmul(A, X);
+    EXPECT_LT(max_abs_diff(llt.solve(B), X), 1e-10);
+  }
+}
+
+TEST(factorization, cholesky_float) {
+  std::mt19937 gen(2);
+  const matrix<float> A = random_spd_matrix<float>(100, &gen);
+  const cholesky<float> llt(A);
+  ASSERT_EQ(llt.info(), 0);
+  const matrix<float> X = random_matrix<float>(100, 2, &gen);
+  const matrix<float> B = matmul(A, X);
+  EXPECT_LT(max_abs_diff(llt.solve(B), X), 1e-4);
+}
+
+TEST(factorization, cholesky_not_positive_definite) {
+  const matrix<double> A = {{4.0, 2.0, 0.0},
+                            {2.0, 1.0, 0.0},
+                            {0.0, 0.0, 1.0}};
+  EXPECT_EQ(cholesky<double>(A).info(), 2);
+
+  const matrix<double> B(1, 1, -1.0);
+  EXPECT_EQ(cholesky<double>(B).info(), 1);
+
+  // Only the lower triangle is read.
+  const matrix<double> C = {{4.0, 100.0},
+                            {2.0, 2.0}};
+  const cholesky<double> llt(C);
+  ASSERT_EQ(llt.info(), 0);
+  const matrix<double> L = llt.l();
+  EXPECT_THAT(L, ElementsAre(2.0, 0.0, 1.0, 1.0));
+}
+
+TEST(factorization, lu) {
+  std::mt19937 gen(3);
+  for (std::size_t n : sizes) {
+    SCOPED_TRACE(n);
+    const matrix<double> A = random_matrix<double>(n, n, &gen);
+    const lu<double> plu(A);
+    ASSERT_EQ(plu.info(), 0);
+
+    const vector<double> x = random_vector<double>(n, &gen);
+    const vector<double> b = matmul(A, x);
+    EXPECT_LT(max_abs_diff(plu.solve(b), x), 1e-8);
+
+    const matrix<double> X = random_matrix<double>(n, 4, &gen);
+    const matrix<double> B = matmul(A, X);
+    EXPECT_LT(max_abs_diff(plu.solve(B), X), 1e-8);
+  }
+}
+
+TEST(factorization, lu_pivoting_and_determinant) {
+  // Factoring without row interchanges would divide by A(0, 0) = 0.
+  const matrix<double> A = {{0.0, 2.0, 1.0},
+                            {1.0, 1.0, 0.0},
+                            {3.0, 0.0, 1.0}};
+  const lu<double> plu(A);
+  ASSERT_EQ(plu.info(), 0);
+  EXPECT_NEAR(plu.determinant(), -5.0, 1e-14);
+
+  const vector<double> b = {5.0, 3.0, 4.0};
+  EXPECT_THAT(plu.solve(b), ElementsAre(DoubleNear(1.0, 1e-14),
+                                        DoubleNear(2.0, 1e-14),
+                                        DoubleNear(1.0, 1e-14)));
+
+  const matrix<float> F = {{2.0f, 1.0f}, {4.0f, 3.0f}};
+  EXPECT_FLOAT_EQ(lu<float>(F).determinant(), 2.0f);
+}
+
+TEST(factorization, lu_singular) {
+  const matrix<double> A = {{1.0, 2.0, 3.0},
+                            {2.0, 4.0, 6.0},
+                            {1.0, 0.0, 1.0}};
+  const lu<double> plu(A);
+  EXPECT_GT(plu.info(), 0);
+  EXPECT_EQ(plu.determinant(), 0.0);
+}
+
+TEST(factorization, qr) {
+  std::mt19937 gen(4);
+  const std::size_t shapes[][2] = {{1, 1}, {5, 3}, {7, 7}, {100, 65},
+                                   {200, 150}, {3, 5}, {70, 130}};
+  for (const auto& shape : shapes) {
+    const std::size_t m = shape[0], n = shape[1], k = std::min(m, n);
+    SCOPED_TRACE(testing::Message() << m << "x" << n);
+    const matrix<double> A = random_matrix<double>(m, n, &gen);
+    const qr<double> f(A);
+
+    const matrix<double> Q = f.q();
+    const matrix<double> R = f.r();
+    ASSERT_EQ(Q.row_count(), m);
+    ASSERT_EQ(Q.col_count(), k);
+    ASSERT_EQ(R.row_count(), k);
+    ASSERT_EQ(R.col_count(), n);
+    for (std::size_t i = 0; i < k; ++i) {
+      for (std::size_t j = 0; j < i; ++j) EXPECT_EQ(R(i, j), 0.0);
+    }
+
+    const matrix<double> QR = matmul(Q, R);
+    EXPECT_LT(max_abs_diff(QR, A), 1e-12 * m);
+
+    const matrix<double> QtQ = matmul(Q.t(), Q);
+    matrix<double> I(k, k, 0.0);
+    for (std::size_t i = 0; i < k; ++i) I(i, i) = 1.0;
+    EXPECT_LT(max_abs_diff(QtQ, I), 1e-12 * m);
+
+    // Q^T * b agrees with the explicit Q on its first k elements.
+    const vector<double> b = random_vector<double>(m, &gen);
+    const vector<double> Qtb = f.apply_qt(b);
+    const vector<double> expected = matmul(Q.t(), b);
+    EXPECT_LT(max_abs_diff(vector<double>(Qtb.begin(), Qtb.begin() + k),
+                           expected), 1e-12 * m);
+  }
+}
+
+TEST(factorization, qr_solve) {
+  std::mt19937 gen(5);
+
+  // Square: the exact solution.
+  const matrix<double> S = random_matrix<double>(80, 80, &gen);
+  const vector<double> x = random_vector<double>(80, &gen);
+  const vector<double> b = matmul(S, x);
+  EXPECT_LT(max_abs_diff(qr<double>(S).solve(b), x), 1e-9);
+
+  // Overdetermined: the residual of the least squares solution is
+  // orthogonal to the columns of A, i.e. A^T * (A * x - b) = 0.
+  const matrix<double> A = random_matrix<double>(300, 90, &gen);
+  const matrix<double> B = random_matrix<double>(300, 2, &gen);
+  const qr<double> f(A);
+  const matrix<double> X = f.solve(B);
+  ASSERT_EQ(X.row_count(), 90);
+  ASSERT_EQ(X.col_count(), 2);
+
+  const matrix<double> AX = matmul(A, X);
+  const matrix<double> residual = AX - B;
+  const matrix<double> normal = matmul(A.t(), residual);
+  EXPECT_LT(max_abs_diff(normal, matrix<double>(90, 2, 0.0)), 1e-10);
+
+  // Each column of X is the solution for the corresponding column of B.
+  for (std::size_t j = 0; j < 2; ++j) {
+    vector<double> bj(300), expected(90);
+    for (std::size_t i = 0; i < 300; ++i) bj[i] = B(i, j);
+    for (std::size_t i = 0; i < 90; ++i) expected[i] = X(i, j);
+    EXPECT_LT(max_abs_diff(f.solve(bj), expected), 1e-12);
+  }
+}
+
+}  // namespace insight
@@ -0,0 +1,300 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "insight/linalg.h"
+#include "insight/linalg/test_util.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using ::testing::FloatEq;
+using test::random_matrix;
+using test::random_vector;
+
+namespace {
+
+// The same matrix, converted to float.
+template<typename T>
+matrix<float> widen(const matrix<T>& A) {
+  matrix<float> result(A.row_count(), A.col_count());
+  std::copy(A.begin(), A.end(), result.begin());
+  return result;
+}
+
+template<typename T>
+vector<float> widen(const vector<T>& x) {
+  vector<float> result(x.size());
+  std::copy(x.begin(), x.end(), result.begin());
+  return result;
+}
+
+// Is actual the value of expected (computed in float) rounded to T, up to
+// one unit in the last place of T?
+template<typename T, typename C, typename E>
+void expect_rounded(const C& actual, const E& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  const float eps = std::is_same<T, float16>::value ? 1.0f / 1024.0f :
+      1.0f / 128.0f;
+  auto a = actual.begin();
+  for (float e : expected) {
+    EXPECT_NEAR(static_cast<float>(*a++), e, std::fabs(e) * eps + 1e-6f);
+  }
+}
+
+}  // namespace
+
+TEST(half, float16_conversions) {
+  EXPECT_EQ(float16(1.0f).bits(), 0x3c00);
+  EXPECT_EQ(float16(-2.0f).bits(), 0xc000);
+  EXPECT_EQ(float16(65504.0f).bits(), 0x7bff);
+  EXPECT_EQ(float16(0.0f).bits(), 0x0000);
+  EXPECT_EQ(float16(-0.0f).bits(), 0x8000);
+
+  // Round to nearest, ties to even.
+  EXPECT_EQ(float16(1.0f + 1.0f / 2048).bits(), 0x3c00);
+  EXPECT_EQ(float16(1.0f + 3.0f / 2048).bits(), 0x3c02);
+  EXPECT_EQ(float16(65520.0f).bits(), 0x7c00);
+  EXPECT_EQ(float16(65519.0f).bits(), 0x7bff);
+
+  // Subnormals.
+  EXPECT_EQ(float16(std::ldexp(1.0f, -24)).bits(), 0x0001);
+  EXPECT_EQ(float16(std::ldexp(1.0f, -25)).bits(), 0x0000);
+  EXPECT_EQ(float16(std::ldexp(3.0f, -25)).bits(), 0x0002);
+  EXPECT_EQ(float(float16::from_bits(0x0001)), std::ldexp(1.0f, -24));
+  EXPECT_EQ(float(float16::from_bits(0x03ff)), std::ldexp(1023.0f, -24));
+
+  // Special values.
+  const float inf = std::numeric_limits<float>::infinity();
+  EXPECT_EQ(float16(inf).bits(), 0x7c00);
+  EXPECT_EQ(float16(-inf).bits(), 0xfc00);
+  EXPECT_EQ(float(float16::from_bits(0xfc00)), -inf);
+  EXPECT_TRUE(std::isnan(float(float16(std::nanf("")))));
+  EXPECT_TRUE(std::isnan(float(float16::from_bits(0x7c01))));
+
+  // Every finite float16 survives a round trip through float.
+  for (int i = 0; i < (1 << 16); ++i) {
+    const float16 h = float16::from_bits(static_cast<uint16_t>(i));
+    if (std::isnan(float(h))) continue;
+    EXPECT_EQ(float16(float(h)).bits(), h.bits());
+  }
+}
+
+TEST(half, bfloat16_conversions) {
+  EXPECT_EQ(bfloat16_t(1.0f).bits(), 0x3f80);
+  EXPECT_EQ(bfloat16_t(-2.0f).bits(), 0xc000);
+
+  // Round to nearest, ties to even.
+  EXPECT_EQ(bfloat16_t(1.0f + 1.0f / 256).bits(), 0x3f80);
+  EXPECT_EQ(bfloat16_t(1.0f + 3.0f / 256).bits(), 0x3f82);
+  EXPECT_EQ(bfloat16_t(linalg_detail::bits_float(0x7f7e8000u)).bits(), 0x7f7e);
+  EXPECT_EQ(bfloat16_t(linalg_detail::bits_float(0x7f7f8000u)).bits(), 0x7f80);
+
+  const float inf = std::numeric_limits<float>::infinity();
+  EXPECT_EQ(float(bfloat16_t(inf)), inf);
+  EXPECT_EQ(float(bfloat16_t(std::numeric_limits<float>::max())), inf);
+  EXPECT_TRUE(std::isnan(float(bfloat16_t(std::nanf("")))));
+
+  // A NaN whose payload only lives in the low bits stays a NaN.
+  EXPECT_TRUE(std::isnan(float(bfloat16_t(
+      linalg_detail::bits_float(0x7f800001u)))));
+
+  const float denorm_min = std::numeric_limits<float>::denorm_min();
+  EXPECT_EQ(float(bfloat16_t(std::ldexp(1.0f, -133))), std::ldexp(1.0f, -133));
+  EXPECT_EQ(float(bfloat16_t(denorm_min)), 0.0f);
+}
+
+TEST(half, bulk_conversions) {
+  std::mt19937 gen(3);
+  vector<float> x = random_vector<float>(1000, &gen) * 1000.0f;
+  std::vector<float16> h(x.size());
+  std::vector<bfloat16_t> b(x.size());
+  std::vector<float> y(x.size());
+
+  const int n = static_cast<int>(x.size());
+  linalg_detail::blas_convert(n, x.data(), h.data());
+  linalg_detail::blas_convert(n, x.data(), b.data());
+  for (int i = 0; i < n; ++i) {
+    EXPECT_EQ(h[i].bits(), float16(x[i]).bits());
+    EXPECT_EQ(b[i].bits(), bfloat16_t(x[i]).bits());
+  }
+
+  linalg_detail::blas_convert(n, h.data(), y.data());
+  for (int i = 0; i < n; ++i) EXPECT_EQ(y[i], float(h[i]));
+  linalg_detail::blas_convert(n, b.data(), y.data());
+  for (int i = 0; i < n; ++i) EXPECT_EQ(y[i], float(b[i]));
+}
+
+TEST(half, elementwise_expressions) {
+  vector<float16> a = {1.0f, 2.0f, 3.0f};
+  vector<float16> b(3, 0.5f);
+
+  vector<float16> c = a * b + float16(1.0f);
+  EXPECT_THAT(c, ElementsAre(1.5f, 2.0f, 2.5f));
+
+  c += a;
+  c *= float16(2.0f);
+  EXPECT_THAT(c, ElementsAre(5.0f, 8.0f, 11.0f));
+
+  // Every node is computed in float, and rounded to float16.
+  c = exp(a) / b;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(float(c[i]),
+              float(float16(float(float16(std::exp(float(a[i])))) / 0.5f)));
+  }
+
+  matrix<bfloat16_t> A = {{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}};
+  matrix<bfloat16_t> B = A + A * bfloat16_t(2.0f);
+  EXPECT_THAT(B, ElementsAre(3.0f, 6.0f, 9.0f, 12.0f, 15.0f, 18.0f));
+
+  matrix<bfloat16_t> C = A.t();
+  EXPECT_THAT(C, ElementsAre(1.0f, 4.0f, 2.0f, 5.0f, 3.0f, 6.0f));
+}
+
+TEST(half, accumulates_in_float) {
+  // 2048 + 1 is not a float16: a float16 accumulator would stall there.
+  vector<float16> x(10000, 1.0f);
+  EXPECT_EQ(float(sum(x)), 10000.0f);
+  EXPECT_EQ(float(mean(x)), 1.0f);
+  EXPECT_EQ(float(x.dot(x)), 10000.0f);
+  EXPECT_EQ(float(x.nrm2()), 100.0f);
+  EXPECT_EQ(float(norm(x)), 100.0f);
+  EXPECT_EQ(float(asum(x)), 10000.0f);
+
+  matrix<float16> A(2, 5000, 1.0f);
+  vector<float16> y(5000, 1.0f);
+  vector<float16> z = matmul(A, y);
+  EXPECT_THAT(z, ElementsAre(5000.0f, 5000.0f));
+
+  vector<float16> r = sum(A, rowwise);
+  EXPECT_THAT(r, ElementsAre(5000.0f, 5000.0f));
+
+  matrix<float16> At = A.t();
+  vector<float16> s = sum(At, colwise);
+  EXPECT_THAT(s, ElementsAre(5000.0f, 5000.0f));
+  s = mean(At + float16(1.0f), colwise);
+  EXPECT_THAT(s, ElementsAre(2.0f, 2.0f));
+}
+
+TEST(half, matrix_vector_products) {
+  std::mt19937 gen(5);
+  matrix<float16> A = random_matrix<float16>(37, 300, &gen);
+  vector<float16> x = random_vector<float16>(300, &gen);
+  vector<float16> u = random_vector<float16>(37, &gen);
+  const matrix<float> Af = widen(A);
+  const vector<float> xf = widen(x);
+  const vector<float> uf = widen(u);
+
+  vector<float16> y = matmul(A, x);
+  vector<float> expected = matmul(Af, xf);
+  expect_rounded<float16>(y, expected);
+
+  y = matmul(A.t(), u);
+  expected = matmul(Af.t(), uf);
+  expect_rounded<float16>(y, expected);
+
+  y = matmul(A, x * float16(2.0f));
+  expected = matmul(Af, xf * 2.0f);
+  expect_rounded<float16>(y, expected);
+
+  // Non-BLAS operands are evaluated first.
+  y = matmul(A, exp(x));
+  expected = matmul(Af, widen(vector<float16>(exp(x))));
+  expect_rounded<float16>(y, expected);
+
+  // Large enough to be converted in several blocks of rows.
+  matrix<float16> L = random_matrix<float16>(400, 300, &gen);
+  vector<float16> v = random_vector<float16>(400, &gen);
+  y = matmul(L.t(), v);
+  expected = matmul(widen(L).t(), widen(v));
+  expect_rounded<float16>(y, expected);
+  vector<float16> w = matmul(L, x);
+  expected = matmul(widen(L), xf);
+  expect_rounded<float16>(w, expected);
+
+  vector<bfloat16_t> bx = random_vector<bfloat16_t>(300, &gen);
+  matrix<bfloat16_t> B = random_matrix<bfloat16_t>(37, 300, &gen);
+  vector<bfloat16_t> by = matmul(B, bx);
+  expected = matmul(widen(B), widen(bx));
+  expect_rounded<bfloat16_t>(by, expected);
+}
+
+TEST(half, matrix_matrix_products) {
+  std::mt19937 gen(7);
+  matrix<float16> A = random_matrix<float16>(40, 260, &gen);
+  matrix<float16> B = random_matrix<float16>(260, 30, &gen);
+  matrix<float16> D = random_matrix<float16>(30, 260, &gen);
+  matrix<float> Af = widen(A);
+  matrix<float> Bf = widen(B);
+  matrix<float> Df = widen(D);
+
+  matrix<float16> C = matmul(A, B);
+  matrix<float> expected = matmul(Af, Bf);
+  expect_rounded<float16>(C, expected);
+
+  C = matmul(A, D.t());
+  expected = matmul(Af, Df.t());
+  expect_rounded<float16>(C, expected);
+
+  matrix<float16> E = matmul(B.t(), A.t());
+  expected = matmul(Bf.t(), Af.t());
+  expect_rounded<float16>(E, expected);
+
+  // Blocks are read in place, with their leading dimension.
+  C = matmul(A.block(1, 2, 10, 100), B.block(3, 1, 100, 20));
+  expected = matmul(matrix<float>(Af.block(1, 2, 10, 100)),
+                    matrix<float>(Bf.block(3, 1, 100, 20)));
+  expect_rounded<float16>(C, expected);
+
+  matrix<float16> L = random_matrix<float16>(400, 260, &gen);
+  C = matmul(L, B);
+  expected = matmul(widen(L), Bf);
+  expect_rounded<float16>(C, expected);
+  C = matmul(L, A.t());
+  expected = matmul(widen(L), Af.t());
+  expect_rounded<float16>(C, expected);
+  C = matmul(L.t(), L);
+  expected = matmul(widen(L).t(), widen(L));
+  expect_rounded<float16>(C, expected);
+
+  matrix<bfloat16_t> P = random_matrix<bfloat16_t>(20, 200, &gen);
+  matrix<bfloat16_t> Q = random_matrix<bfloat16_t>(200, 10, &gen);
+  matrix<bfloat16_t> R = matmul(P, Q) * bfloat16_t(0.5f);
+  expected = matmul(widen(P), widen(Q)) * 0.5f;
+  expect_rounded<bfloat16_t>(R, expected);
+}
+
+TEST(half, maps) {
+  float16 data[] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  matrix_map<const float16> A(data, 2, 3);
+  vector_map<float16> x(data, 3);
+
+  vector<float16> y = matmul(A, x);
+  EXPECT_THAT(y, ElementsAre(14.0f, 32.0f));
+  EXPECT_EQ(float(x.dot(x)), 14.0f);
+}
+
+}  // namespace insight
+
+// Code that brings the whole of insight into the global namespace can
+// still name the 16-bit types unqualified, next to the BLAS headers that
+// insight/linalg.h includes: OpenBLAS's cblas.h declares a global
+// ::bfloat16.
+using namespace insight;  // NOLINT(build/namespaces)
+
+TEST(half, unqualified_after_using_namespace_insight) {
+  vector<bfloat16_t> x = {1.0f, 2.0f, 3.0f};
+  vector<float16> y = {1.0f, 2.0f, 3.0f};
+  EXPECT_EQ(float(x.dot(x)), 14.0f);
+  EXPECT_EQ(float(y.dot(y)), 14.0f);
+}
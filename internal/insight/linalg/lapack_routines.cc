@@ -0,0 +1,923 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "insight/linalg/detail/lapack_routines.h"
+
+#include "glog/logging.h"
+
+#if defined(INSIGHT_USE_LAPACKE) && !defined(INSIGHT_USE_MKL)
+extern "C" {
+#include <lapacke.h>
+}
+#endif
+
+namespace insight {
+namespace linalg_detail {
+
+#ifdef INSIGHT_USE_LAPACKE
+
+namespace {
+
+// LAPACKE rejects (with info = -lda) a leading dimension of 0, which that
+// of an empty operand may be, even though nothing is read through it.
+inline int ld(const int n) { return std::max(1, n); }
+
+// The routines that do not report info to their caller only fail on an
+// illegal argument, i.e. on a bug.
+inline void check_info(const int info, const char* routine) {
+  CHECK_EQ(info, 0) << routine << ": illegal value of argument " << -info;
+}
+
+}  // namespace
+
+#else
+
+namespace {
+
+// Columns processed by each step of the blocked factorizations: the panel
+// is factored by unblocked (BLAS-2) code, and the trailing matrix is
+// updated by BLAS-3 calls.
+const int kBlockSize = 64;
+
+// The BLAS routines used by the factorizations that blas_routines.h does
+// not wrap, on row-major operands.
+
+inline void trmm(const CBLAS_SIDE Side, const CBLAS_UPLO Uplo,
+                 const CBLAS_TRANSPOSE TransA, const CBLAS_DIAG Diag,
+                 const int M, const int N, const float alpha, const float* A,
+                 const int lda, float* B, const int ldb) {
+  cblas_strmm(CblasRowMajor, Side, Uplo, TransA, Diag, M, N, alpha, A, lda,
+              B, ldb);
+}
+
+inline void trmm(const CBLAS_SIDE Side, const CBLAS_UPLO Uplo,
+                 const CBLAS_TRANSPOSE TransA, const CBLAS_DIAG Diag,
+                 const int M, const int N, const double alpha,
+                 const double* A, const int lda, double* B, const int ldb) {
+  cblas_dtrmm(CblasRowMajor, Side, Uplo, TransA, Diag, M, N, alpha, A, lda,
+              B, ldb);
+}
+
+inline float nrm2(const int N, const float* X, const int incX) {
+  return cblas_snrm2(N, X, incX);
+}
+
+inline double nrm2(const int N, const double* X, const int incX) {
+  return cblas_dnrm2(N, X, incX);
+}
+
+inline void scal(const int N, const float alpha, float* X, const int incX) {
+  cblas_sscal(N, alpha, X, incX);
+}
+
+inline void scal(const int N, const double alpha, double* X,
+                 const int incX) {
+  cblas_dscal(N, alpha, X, incX);
+}
+
+inline float dot(const int N, const float* X, const float* Y) {
+  return cblas_sdot(N, X, 1, Y, 1);
+}
+
+inline double dot(const int N, const double* X, const double* Y) {
+  return cblas_ddot(N, X, 1, Y, 1);
+}
+
+inline void rot(const int N, float* X, float* Y, const float c,
+                const float s) {
+  cblas_srot(N, X, 1, Y, 1, c, s);
+}
+
+inline void rot(const int N, double* X, double* Y, const double c,
+                const double s) {
+  cblas_drot(N, X, 1, Y, 1, c, s);
+}
+
+// Cholesky.
+
+// Unblocked potrf: column j of L is computed from the rows of L above it,
+// which are contiguous in a row-major matrix.
+template<typename T>
+int potf2(const int N, T* A, const int lda) {
+  for (int j = 0; j < N; ++j) {
+    T* Lj = A + j * lda;
+    T d = Lj[j];
+    for (int p = 0; p < j; ++p) d -= Lj[p] * Lj[p];
+    if (!(d > T(0))) return j + 1;
+    d = std::sqrt(d);
+    Lj[j] = d;
+
+    for (int i = j + 1; i < N; ++i) {
+      T* Li = A + i * lda;
+      T s = Li[j];
+      for (int p = 0; p < j; ++p) s -= Li[p] * Lj[p];
+      Li[j] = s / d;
+    }
+  }
+  return 0;
+}
+
+template<typename T>
+int potrf(const int N, T* A, const int lda) {
+  for (int k = 0; k < N; k += kBlockSize) {
+    const int kb = std::min(kBlockSize, N - k);
+    T* A11 = A + k * lda + k;
+
+    const int info = potf2(kb, A11, lda);
+    if (info != 0) return k + info;
+
+    const int n = N - k - kb;
+    if (n > 0) {
+      T* A21 = A11 + kb * lda;
+      T* A22 = A21 + kb;
+      // A21 <- A21 * L11^-T, A22 <- A22 - A21 * A21^T.
+      blas_trsm(CblasRight, CblasLower, CblasTrans, CblasNonUnit, n, kb,
+                T(1), A11, lda, A21, lda);
+      blas_syrk(CblasLower, CblasNoTrans, n, kb, T(-1), A21, lda, T(1), A22,
+                lda);
+    }
+  }
+  return 0;
+}
+
+template<typename T>
+void potrs(const int N, const int nrhs, const T* A, const int lda, T* B,
+           const int ldb) {
+  blas_trsm(CblasLeft, CblasLower, CblasNoTrans, CblasNonUnit, N, nrhs, T(1),
+            A, lda, B, ldb);
+  blas_trsm(CblasLeft, CblasLower, CblasTrans, CblasNonUnit, N, nrhs, T(1),
+            A, lda, B, ldb);
+}
+
+// LU.
+
+// Unblocked getrf of the panel made of columns j to j + jb of rows j to M.
+// Pivoting interchanges whole rows, i.e. also the columns on the left of
+// the panel (which belong to L) and those on its right (yet to be
+// updated).
+template<typename T>
+void getf2(const int M, const int N, const int j, const int jb, T* A,
+           const int lda, int* ipiv, int* info) {
+  for (int c = j; c < j + jb; ++c) {
+    int p = c;
+    T max = std::fabs(A[c * lda + c]);
+    for (int i = c + 1; i < M; ++i) {
+      const T a = std::fabs(A[i * lda + c]);
+      if (a > max) {
+        max = a;
+        p = i;
+      }
+    }
+    ipiv[c] = p + 1;
+
+    if (A[p * lda + c] != T(0)) {
+      if (p != c) {
+        std::swap_ranges(A + p * lda, A + p * lda + N, A + c * lda);
+      }
+      scal(M - c - 1, T(1) / A[c * lda + c], A + (c + 1) * lda + c, lda);
+    } else if (*info == 0) {
+      *info = c + 1;
+    }
+
+    // Rank-1 update of the rest of the panel.
+    blas_ger(M - c - 1, j + jb - c - 1, T(-1), A + (c + 1) * lda + c, lda,
+             A + c * lda + c + 1, 1, A + (c + 1) * lda + c + 1, lda);
+  }
+}
+
+template<typename T>
+int getrf(const int M, const int N, T* A, const int lda, int* ipiv) {
+  const int K = std::min(M, N);
+  int info = 0;
+  for (int j = 0; j < K; j += kBlockSize) {
+    const int jb = std::min(kBlockSize, K - j);
+    getf2(M, N, j, jb, A, lda, ipiv, &info);
+
+    const int n = N - j - jb;
+    if (n > 0) {
+      T* A11 = A + j * lda + j;
+      T* A12 = A11 + jb;
+      // A12 <- L11^-1 * A12, A22 <- A22 - A21 * A12.
+      blas_trsm(CblasLeft, CblasLower, CblasNoTrans, CblasUnit, jb, n, T(1),
+                A11, lda, A12, lda);
+      const int m = M - j - jb;
+      if (m > 0) {
+        blas_gemm(CblasNoTrans, CblasNoTrans, m, n, jb, T(-1),
+                  A11 + jb * lda, lda, A12, lda, T(1), A12 + jb * lda, lda);
+      }
+    }
+  }
+  return info;
+}
+
+template<typename T>
+void getrs(const int N, const int nrhs, const T* A, const int lda,
+           const int* ipiv, T* B, const int ldb) {
+  for (int i = 0; i < N; ++i) {
+    const int p = ipiv[i] - 1;
+    if (p != i) {
+      std::swap_ranges(B + p * ldb, B + p * ldb + nrhs, B + i * ldb);
+    }
+  }
+  blas_trsm(CblasLeft, CblasLower, CblasNoTrans, CblasUnit, N, nrhs, T(1),
+            A, lda, B, ldb);
+  blas_trsm(CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, nrhs, T(1),
+            A, lda, B, ldb);
+}
+
+// QR.
+
+// Generates the reflector H = I - tau * v * v^T such that H * x = beta * e0,
+// where x is made of alpha followed by the n elements of X, incX apart.
+// alpha is overwritten by beta, and X by v (but its leading 1).
+template<typename T>
+T larfg(const int n, T* alpha, T* X, const int incX) {
+  const T xnorm = nrm2(n, X, incX);
+  if (xnorm == T(0)) return T(0);
+
+  const T beta = -std::copysign(std::hypot(*alpha, xnorm), *alpha);
+  const T tau = (beta - *alpha) / beta;
+  scal(n, T(1) / (*alpha - beta), X, incX);
+  *alpha = beta;
+  return tau;
+}
+
+// Unblocked geqrf of the panel made of columns j to j + jb of rows j to M,
+// the reflectors being applied to the panel only.
+template<typename T>
+void geqr2(const int M, const int j, const int jb, T* A, const int lda,
+           T* tau, T* work) {
+  for (int c = j; c < j + jb; ++c) {
+    T* Acc = A + c * lda + c;
+    tau[c] = larfg(M - c - 1, Acc, Acc + lda, lda);
+
+    const int n = j + jb - c - 1;
+    if (n > 0 && tau[c] != T(0)) {
+      // C <- (I - tau * v * v^T) * C, with v = A(c : M, c).
+      const T beta = *Acc;
+      *Acc = T(1);
+      blas_gemv(CblasTrans, M - c, n, T(1), Acc + 1, lda, Acc, lda, T(0),
+                work, 1);
+      blas_ger(M - c, n, -tau[c], Acc, lda, work, 1, Acc + 1, lda);
+      *Acc = beta;
+    }
+  }
+}
+
+// The block reflector H(j) * ... * H(j + jb - 1) = I - V * T * V^T, where V
+// is the m x jb unit lower trapezoidal matrix of the reflectors, copied
+// (with its zeros and ones) from A(j : M, j : j + jb), and T is jb x jb
+// upper triangular.
+template<typename T>
+void larft(const int m, const int jb, const T* A, const int lda,
+           const T* tau, T* V, T* Tm) {
+  for (int i = 0; i < m; ++i) {
+    for (int c = 0; c < jb; ++c) {
+      V[i * jb + c] = (i > c) ? A[i * lda + c] : T(i == c);
+    }
+  }
+
+  std::fill(Tm, Tm + jb * jb, T(0));
+  for (int i = 0; i < jb; ++i) {
+    if (tau[i] != T(0)) {
+      // T(0 : i, i) <- -tau[i] * T(0 : i, 0 : i) * V(i : m, 0 : i)^T *
+      //                V(i : m, i), v(i) being 0 above row i.
+      blas_gemv(CblasTrans, m - i, i, -tau[i], V + i * jb, jb,
+                V + i * jb + i, jb, T(0), Tm + i, jb);
+      blas_trmv(CblasUpper, CblasNoTrans, CblasNonUnit, i, Tm, jb, Tm + i,
+                jb);
+    }
+    Tm[i * jb + i] = tau[i];
+  }
+}
+
+// C <- (I - V * op(T) * V^T) * C, where C is m x n, i.e. C <- op(H) * C for
+// the block reflector H given by larft. work holds jb * n elements.
+template<typename T>
+void larfb(const CBLAS_TRANSPOSE Trans, const int m, const int n,
+           const int jb, const T* V, const T* Tm, T* C, const int ldc,
+           T* work) {
+  blas_gemm(CblasTrans, CblasNoTrans, jb, n, m, T(1), V, jb, C, ldc, T(0),
+            work, n);
+  trmm(CblasLeft, CblasUpper, Trans, CblasNonUnit, jb, n, T(1), Tm, jb,
+       work, n);
+  blas_gemm(CblasNoTrans, CblasNoTrans, m, n, jb, T(-1), V, jb, work, n,
+            T(1), C, ldc);
+}
+
+template<typename T>
+void geqrf(const int M, const int N, T* A, const int lda, T* tau) {
+  const int K = std::min(M, N);
+  if (K == 0) return;
+
+  const int nb = std::min(kBlockSize, K);
+  std::vector<T> V(static_cast<std::size_t>(M) * nb), Tm(nb * nb);
+  std::vector<T> work(static_cast<std::size_t>(std::max(N, 1)) * nb);
+
+  for (int j = 0; j < K; j += nb) {
+    const int jb = std::min(nb, K - j);
+    geqr2(M, j, jb, A, lda, tau, work.data());
+
+    // Applies H^T to the trailing columns.
+    const int n = N - j - jb;
+    if (n > 0) {
+      T* Ajj = A + j * lda + j;
+      larft(M - j, jb, Ajj, lda, tau + j, V.data(), Tm.data());
+      larfb(CblasTrans, M - j, n, jb, V.data(), Tm.data(), Ajj + jb, lda,
+            work.data());
+    }
+  }
+}
+
+template<typename T>
+void ormqr(const CBLAS_TRANSPOSE Trans, const int M, const int nrhs,
+           const int K, const T* A, const int lda, const T* tau, T* C,
+           const int ldc) {
+  if (K == 0 || nrhs == 0) return;
+
+  const int nb = std::min(kBlockSize, K);
+  std::vector<T> V(static_cast<std::size_t>(M) * nb), Tm(nb * nb);
+  std::vector<T> work(static_cast<std::size_t>(nrhs) * nb);
+
+  // Q^T = H(K - 1) * ... * H(0) applies the blocks in order, and
+  // Q = H(0) * ... * H(K - 1) in reverse order.
+  const int blocks = (K + nb - 1) / nb;
+  for (int b = 0; b < blocks; ++b) {
+    const int j = (Trans == CblasTrans ? b : blocks - 1 - b) * nb;
+    const int jb = std::min(nb, K - j);
+    larft(M - j, jb, A + j * lda + j, lda, tau + j, V.data(), Tm.data());
+    larfb(Trans, M - j, nrhs, jb, V.data(), Tm.data(), C + j * ldc, ldc,
+          work.data());
+  }
+}
+
+
+// Symmetric eigendecomposition.
+
+// Householder reduction of the symmetric matrix V to tridiagonal form, the
+// orthogonal transformation being accumulated in V: on return, d holds the
+// diagonal and e(1 : N) the subdiagonal of the tridiagonal matrix (EISPACK
+// tred2, as in JAMA).
+template<typename T>
+void tred2(const int N, T* V, const int ldv, T* d, T* e) {
+  auto v = [V, ldv](int i, int j) -> T& { return V[i * ldv + j]; };
+
+  for (int j = 0; j < N; ++j) d[j] = v(N - 1, j);
+
+  for (int i = N - 1; i > 0; --i) {
+    T scale(0), h(0);
+    for (int k = 0; k < i; ++k) scale += std::fabs(d[k]);
+
+    if (scale == T(0)) {
+      e[i] = d[i - 1];
+      for (int j = 0; j < i; ++j) {
+        d[j] = v(i - 1, j);
+        v(i, j) = T(0);
+        v(j, i) = T(0);
+      }
+    } else {
+      // The Householder vector.
+      for (int k = 0; k < i; ++k) {
+        d[k] /= scale;
+        h += d[k] * d[k];
+      }
+      T f = d[i - 1];
+      T g = std::sqrt(h);
+      if (f > T(0)) g = -g;
+      e[i] = scale * g;
+      h -= f * g;
+      d[i - 1] = f - g;
+      for (int j = 0; j < i; ++j) e[j] = T(0);
+
+      // Applies the similarity transformation to the remaining columns.
+      for (int j = 0; j < i; ++j) {
+        f = d[j];
+        v(j, i) = f;
+        g = e[j] + v(j, j) * f;
+        for (int k = j + 1; k <= i - 1; ++k) {
+          g += v(k, j) * d[k];
+          e[k] += v(k, j) * f;
+        }
+        e[j] = g;
+      }
+      f = T(0);
+      for (int j = 0; j < i; ++j) {
+        e[j] /= h;
+        f += e[j] * d[j];
+      }
+      const T hh = f / (h + h);
+      for (int j = 0; j < i; ++j) e[j] -= hh * d[j];
+      for (int j = 0; j < i; ++j) {
+        f = d[j];
+        g = e[j];
+        for (int k = j; k <= i - 1; ++k) v(k, j) -= (f * e[k] + g * d[k]);
+        d[j] = v(i - 1, j);
+        v(i, j) = T(0);
+      }
+    }
+    d[i] = h;
+  }
+
+  // Accumulates the transformations.
+  for (int i = 0; i < N - 1; ++i) {
+    v(N - 1, i) = v(i, i);
+    v(i, i) = T(1);
+    const T h = d[i + 1];
+    if (h != T(0)) {
+      for (int k = 0; k <= i; ++k) d[k] = v(k, i + 1) / h;
+      for (int j = 0; j <= i; ++j) {
+        T g(0);
+        for (int k = 0; k <= i; ++k) g += v(k, i + 1) * v(k, j);
+        for (int k = 0; k <= i; ++k) v(k, j) -= g * d[k];
+      }
+    }
+    for (int k = 0; k <= i; ++k) v(k, i + 1) = T(0);
+  }
+  for (int j = 0; j < N; ++j) {
+    d[j] = v(N - 1, j);
+    v(N - 1, j) = T(0);
+  }
+  v(N - 1, N - 1) = T(1);
+  e[0] = T(0);
+}
+
+// Implicit QL iterations on the tridiagonal matrix given by tred2, the
+// rotations being accumulated in V. On return, d holds the eigenvalues in
+// ascending order, and the columns of V the eigenvectors (EISPACK tql2, as
+// in JAMA). Returns 0, or l + 1 if the l-th eigenvalue did not converge in
+// 30 iterations.
+template<typename T>
+int tql2(const int N, T* V, const int ldv, T* d, T* e) {
+  auto v = [V, ldv](int i, int j) -> T& { return V[i * ldv + j]; };
+  const T eps = std::numeric_limits<T>::epsilon();
+  const int kMaxIterations = 30;
+
+  for (int i = 1; i < N; ++i) e[i - 1] = e[i];
+  e[N - 1] = T(0);
+
+  T f(0), tst1(0);
+  for (int l = 0; l < N; ++l) {
+    // Finds a small subdiagonal element.
+    tst1 = std::max(tst1, std::fabs(d[l]) + std::fabs(e[l]));
+    int m = l;
+    while (m < N - 1 && std::fabs(e[m]) > eps * tst1) ++m;
+
+    if (m > l) {
+      int iterations = 0;
+      do {
+        if (++iterations > kMaxIterations) return l + 1;
+
+        // The implicit shift.
+        T g = d[l];
+        T p = (d[l + 1] - g) / (T(2) * e[l]);
+        T r = std::hypot(p, T(1));
+        if (p < T(0)) r = -r;
+        d[l] = e[l] / (p + r);
+        d[l + 1] = e[l] * (p + r);
+        const T dl1 = d[l + 1];
+        T h = g - d[l];
+        for (int i = l + 2; i < N; ++i) d[i] -= h;
+        f += h;
+
+        // The implicit QL transformation.
+        p = d[m];
+        T c(1), c2(1), c3(1), s(0), s2(0);
+        const T el1 = e[l + 1];
+        for (int i = m - 1; i >= l; --i) {
+          c3 = c2;
+          c2 = c;
+          s2 = s;
+          g = c * e[i];
+          h = c * p;
+          r = std::hypot(p, e[i]);
+          e[i + 1] = s * r;
+          s = e[i] / r;
+          c = p / r;
+          p = c * d[i] - s * g;
+          d[i + 1] = h + s * (c * g + s * d[i]);
+
+          for (int k = 0; k < N; ++k) {
+            h = v(k, i + 1);
+            v(k, i + 1) = s * v(k, i) + c * h;
+            v(k, i) = c * v(k, i) - s * h;
+          }
+        }
+        p = -s * s2 * c3 * el1 * e[l] / dl1;
+        e[l] = s * p;
+        d[l] = c * p;
+      } while (std::fabs(e[l]) > eps * tst1);
+    }
+    d[l] += f;
+    e[l] = T(0);
+  }
+
+  // Sorts the eigenvalues and vectors in ascending order.
+  for (int i = 0; i < N - 1; ++i) {
+    int k = i;
+    T p = d[i];
+    for (int j = i + 1; j < N; ++j) {
+      if (d[j] < p) {
+        k = j;
+        p = d[j];
+      }
+    }
+    if (k != i) {
+      d[k] = d[i];
+      d[i] = p;
+      for (int j = 0; j < N; ++j) std::swap(v(j, i), v(j, k));
+    }
+  }
+  return 0;
+}
+
+template<typename T>
+int syevd(const int N, T* A, const int lda, T* W) {
+  if (N == 0) return 0;
+  // tred2 reads the lower triangle only, but its updates use the whole
+  // matrix.
+  for (int i = 0; i < N; ++i) {
+    for (int j = i + 1; j < N; ++j) A[i * lda + j] = A[j * lda + i];
+  }
+  std::vector<T> e(N);
+  tred2(N, A, lda, W, e.data());
+  return tql2(N, A, lda, W, e.data());
+}
+
+// syevr through the full eigendecomposition: unlike LAPACK's, which only
+// computes the requested eigenpairs, it costs as much as syevd.
+template<typename T>
+int syevr(const int N, T* A, const int lda, const int il, const int iu,
+          T* W, T* Z, const int ldz) {
+  std::vector<T> all(N);
+  const int info = syevd(N, A, lda, all.data());
+  const int m = iu - il + 1;
+  std::copy(all.begin() + il - 1, all.begin() + iu, W);
+  for (int i = 0; i < N; ++i) {
+    std::copy(A + i * lda + il - 1, A + i * lda + il - 1 + m, Z + i * ldz);
+  }
+  return info;
+}
+
+// Singular value decomposition.
+
+// One-sided Jacobi: rotates pairs of the p rows of X (p x q, p <= q) until
+// they are mutually orthogonal, the same rotations being applied to the
+// rows of the p x p matrix J (initially the identity), so that
+// X = J^T * X', where X' is the result. Returns 0, or 1 if the rows are
+// still not orthogonal after 60 sweeps.
+template<typename T>
+int jacobi_orthogonalize_rows(const int p, const int q, T* X, const int ldx,
+                              T* J, const int ldj) {
+  const T tolerance = std::numeric_limits<T>::epsilon() * std::sqrt(T(q));
+  const int kMaxSweeps = 60;
+
+  for (int sweep = 0; sweep < kMaxSweeps; ++sweep) {
+    bool rotated = false;
+    for (int i = 0; i < p - 1; ++i) {
+      for (int j = i + 1; j < p; ++j) {
+        T* xi = X + i * ldx;
+        T* xj = X + j * ldx;
+        const T alpha = dot(q, xi, xi);
+        const T beta = dot(q, xj, xj);
+        const T gamma = dot(q, xi, xj);
+        if (gamma == T(0) ||
+            std::fabs(gamma) <= tolerance * std::sqrt(alpha * beta)) {
+          continue;
+        }
+        rotated = true;
+
+        // The rotation zeroing the (i, j) entry of X * X^T.
+        const T zeta = (beta - alpha) / (T(2) * gamma);
+        const T t = std::copysign(T(1), zeta) /
+                    (std::fabs(zeta) + std::hypot(T(1), zeta));
+        const T c = T(1) / std::hypot(T(1), t);
+        const T s = c * t;
+        // x_i <- c * x_i - s * x_j, x_j <- s * x_i + c * x_j.
+        rot(q, xi, xj, c, -s);
+        rot(p, J + i * ldj, J + j * ldj, c, -s);
+      }
+    }
+    if (!rotated) return 0;
+  }
+  return 1;
+}
+
+// Thin SVD through one-sided Jacobi, which is accurate but, without any
+// blocking, only suited to small and medium matrices. With K = min(M, N),
+// the K rows of X = A^T (if M >= N) or of X = A (otherwise) are
+// orthogonalized, X = J^T * X', and the norms of the rows of X' are the
+// singular values:
+//
+//   M >= N: A = X^T = U * diag(S) * J, U = X'^T * diag(S)^-1, VT = J;
+//   M < N:  A = X = J^T * diag(S) * VT, U = J^T, VT = diag(S)^-1 * X'.
+//
+// The singular vectors of the zero singular values are left zero.
+template<typename T>
+int gesdd(const int M, const int N, T* A, const int lda, T* S, T* U,
+          const int ldu, T* VT, const int ldvt) {
+  const int K = std::min(M, N);
+  if (K == 0) return 0;
+  const int L = std::max(M, N);
+  const bool tall = (M >= N);
+
+  std::vector<T> X(static_cast<std::size_t>(K) * L);
+  std::vector<T> J(static_cast<std::size_t>(K) * K, T(0));
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < N; ++j) {
+      X[tall ? j * L + i : i * L + j] = A[i * lda + j];
+    }
+  }
+  for (int i = 0; i < K; ++i) J[i * K + i] = T(1);
+
+  const int info = jacobi_orthogonalize_rows(K, L, X.data(), L, J.data(), K);
+
+  std::vector<T> norms(K);
+  for (int i = 0; i < K; ++i) norms[i] = nrm2(L, X.data() + i * L, 1);
+  std::vector<int> order(K);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&norms](int a, int b) { return norms[a] > norms[b]; });
+
+  for (int r = 0; r < K; ++r) {
+    const int i = order[r];
+    S[r] = norms[i];
+    const T scale = (norms[i] > T(0)) ? T(1) / norms[i] : T(0);
+    const T* xi = X.data() + i * L;
+    const T* ji = J.data() + i * K;
+    if (tall) {
+      for (int k = 0; k < M; ++k) U[k * ldu + r] = xi[k] * scale;
+      std::copy(ji, ji + N, VT + r * ldvt);
+    } else {
+      for (int k = 0; k < M; ++k) U[k * ldu + r] = ji[k];
+      for (int k = 0; k < N; ++k) VT[r * ldvt + k] = xi[k] * scale;
+    }
+  }
+  return info;
+}
+
+}  // namespace
+
+#endif  // INSIGHT_USE_LAPACKE
+
+// Cholesky.
+
+template<>
+int lapack_potrf<float>(const int N, float* A, const int lda) {
+#ifdef INSIGHT_USE_LAPACKE
+  return LAPACKE_spotrf(LAPACK_ROW_MAJOR, 'L', N, A, ld(lda));
+#else
+  return potrf(N, A, lda);
+#endif
+}
+
+template<>
+int lapack_potrf<double>(const int N, double* A, const int lda) {
+#ifdef INSIGHT_USE_LAPACKE
+  return LAPACKE_dpotrf(LAPACK_ROW_MAJOR, 'L', N, A, ld(lda));
+#else
+  return potrf(N, A, lda);
+#endif
+}
+
+template<>
+void lapack_potrs<float>(const int N, const int nrhs, const float* A,
+                         const int lda, float* B, const int ldb) {
+#ifdef INSIGHT_USE_LAPACKE
+  const int info = LAPACKE_spotrs(LAPACK_ROW_MAJOR, 'L', N, nrhs, A, ld(lda),
+                                  B, ld(ldb));
+  check_info(info, "LAPACKE_spotrs");
+#else
+  potrs(N, nrhs, A, lda, B, ldb);
+#endif
+}
+
+template<>
+void lapack_potrs<double>(const int N, const int nrhs, const double* A,
+                          const int lda, double* B, const int ldb) {
+#ifdef INSIGHT_USE_LAPACKE
+  const int info = LAPACKE_dpotrs(LAPACK_ROW_MAJOR, 'L', N, nrhs, A, ld(lda),
+                                  B, ld(ldb));
+  check_info(info, "LAPACKE_dpotrs");
+#else
+  potrs(N, nrhs, A, lda, B, ldb);
+#endif
+}
+
+// LU.
+
+template<>
+int lapack_getrf<float>(const int M, const int N, float* A, const int lda,
+                        int* ipiv) {
+#ifdef INSIGHT_USE_LAPACKE
+  return LAPACKE_sgetrf(LAPACK_ROW_MAJOR, M, N, A, ld(lda), ipiv);
+#else
+  return getrf(M, N, A, lda, ipiv);
+#endif
+}
+
+template<>
+int lapack_getrf<double>(const int M, const int N, double* A, const int lda,
+                         int* ipiv) {
+#ifdef INSIGHT_USE_LAPACKE
+  return LAPACKE_dgetrf(LAPACK_ROW_MAJOR, M, N, A, ld(lda), ipiv);
+#else
+  return getrf(M, N, A, lda, ipiv);
+#endif
+}
+
+template<>
+void lapack_getrs<float>(const int N, const int nrhs, const float* A,
+                         const int lda, const int* ipiv, float* B,
+                         const int ldb) {
+#ifdef INSIGHT_USE_LAPACKE
+  const int info = LAPACKE_sgetrs(LAPACK_ROW_MAJOR, 'N', N, nrhs, A, ld(lda),
+                                  ipiv, B, ld(ldb));
+  check_info(info, "LAPACKE_sgetrs");
+#else
+  getrs(N, nrhs, A, lda, ipiv, B, ldb);
+#endif
+}
+
+template<>
+void lapack_getrs<double>(const int N, const int nrhs, const double* A,
+                          const int lda, const int* ipiv, double* B,
+                          const int ldb) {
+#ifdef INSIGHT_USE_LAPACKE
+  const int info = LAPACKE_dgetrs(LAPACK_ROW_MAJOR, 'N', N, nrhs, A, ld(lda),
+                                  ipiv, B, ld(ldb));
+  check_info(info, "LAPACKE_dgetrs");
+#else
+  getrs(N, nrhs, A, lda, ipiv, B, ldb);
+#endif
+}
+
+// QR.
+
+template<>
+void lapack_geqrf<float>(const int M, const int N, float* A, const int lda,
+                         float* tau) {
+#ifdef INSIGHT_USE_LAPACKE
+  const int info = LAPACKE_sgeqrf(LAPACK_ROW_MAJOR, M, N, A, ld(lda), tau);
+  check_info(info, "LAPACKE_sgeqrf");
+#else
+  geqrf(M, N, A, lda, tau);
+#endif
+}
+
+template<>
+void lapack_geqrf<double>(const int M, const int N, double* A, const int lda,
+                          double* tau) {
+#ifdef INSIGHT_USE_LAPACKE
+  const int info = LAPACKE_dgeqrf(LAPACK_ROW_MAJOR, M, N, A, ld(lda), tau);
+  check_info(info, "LAPACKE_dgeqrf");
+#else
+  geqrf(M, N, A, lda, tau);
+#endif
+}
+
+template<>
+void lapack_ormqr<float>(const CBLAS_TRANSPOSE Trans, const int M,
+                         const int nrhs, const int K, const float* A,
+                         const int lda, const float* tau, float* C,
+                         const int ldc) {
+#ifdef INSIGHT_USE_LAPACKE
+  const int info = LAPACKE_sormqr(LAPACK_ROW_MAJOR, 'L',
+                                  Trans == CblasTrans ? 'T' : 'N', M, nrhs, K,
+                                  A, ld(lda), tau, C, ld(ldc));
+  check_info(info, "LAPACKE_sormqr");
+#else
+  ormqr(Trans, M, nrhs, K, A, lda, tau, C, ldc);
+#endif
+}
+
+template<>
+void lapack_ormqr<double>(const CBLAS_TRANSPOSE Trans, const int M,
+                          const int nrhs, const int K, const double* A,
+                          const int lda, const double* tau, double* C,
+                          const int ldc) {
+#ifdef INSIGHT_USE_LAPACKE
+  const int info = LAPACKE_dormqr(LAPACK_ROW_MAJOR, 'L',
+                                  Trans == CblasTrans ? 'T' : 'N', M, nrhs, K,
+                                  A, ld(lda), tau, C, ld(ldc));
+  check_info(info, "LAPACKE_dormqr");
+#else
+  ormqr(Trans, M, nrhs, K, A, lda, tau, C, ldc);
+#endif
+}
+
+// Symmetric eigendecomposition.
+
+template<>
+int lapack_syevd<float>(const int N, float* A, const int lda, float* W) {
+#ifdef INSIGHT_USE_LAPACKE
+  return LAPACKE_ssyevd(LAPACK_ROW_MAJOR, 'V', 'L', N, A, ld(lda), W);
+#else
+  return syevd(N, A, lda, W);
+#endif
+}
+
+template<>
+int lapack_syevd<double>(const int N, double* A, const int lda, double* W) {
+#ifdef INSIGHT_USE_LAPACKE
+  return LAPACKE_dsyevd(LAPACK_ROW_MAJOR, 'V', 'L', N, A, ld(lda), W);
+#else
+  return syevd(N, A, lda, W);
+#endif
+}
+
+template<>
+int lapack_syevr<float>(const int N, float* A, const int lda, const int il,
+                        const int iu, float* W, float* Z, const int ldz) {
+#ifdef INSIGHT_USE_LAPACKE
+  int m = 0;
+  std::vector<float> w(N);
+  std::vector<int> isuppz(2 * std::max(1, N));
+  const int info = LAPACKE_ssyevr(LAPACK_ROW_MAJOR, 'V', 'I', 'L', N, A,
+                                  ld(lda), 0.0f, 0.0f, il, iu, 0.0f, &m,
+                                  w.data(), Z, ld(ldz), isuppz.data());
+  std::copy(w.begin(), w.begin() + (iu - il + 1), W);
+  return info;
+#else
+  return syevr(N, A, lda, il, iu, W, Z, ldz);
+#endif
+}
+
+template<>
+int lapack_syevr<double>(const int N, double* A, const int lda, const int il,
+                         const int iu, double* W, double* Z, const int ldz) {
+#ifdef INSIGHT_USE_LAPACKE
+  int m = 0;
+  std::vector<double> w(N);
+  std::vector<int> isuppz(2 * std::max(1, N));
+  const int info = LAPACKE_dsyevr(LAPACK_ROW_MAJOR, 'V', 'I', 'L', N, A,
+                                  ld(lda), 0.0, 0.0, il, iu, 0.0, &m,
+                                  w.data(), Z, ld(ldz), isuppz.data());
+  std::copy(w.begin(), w.begin() + (iu - il + 1), W);
+  return info;
+#else
+  return syevr(N, A, lda, il, iu, W, Z, ldz);
+#endif
+}
+
+// Singular value decomposition.
+
+template<>
+int lapack_gesdd<float>(const int M, const int N, float* A, const int lda,
+                        float* S, float* U, const int ldu, float* VT,
+                        const int ldvt) {
+#ifdef INSIGHT_USE_LAPACKE
+  return LAPACKE_sgesdd(LAPACK_ROW_MAJOR, 'S', M, N, A, ld(lda), S, U,
+                        ld(ldu), VT, ld(ldvt));
+#else
+  return gesdd(M, N, A, lda, S, U, ldu, VT, ldvt);
+#endif
+}
+
+template<>
+int lapack_gesdd<double>(const int M, const int N, double* A, const int lda,
+                         double* S, double* U, const int ldu, double* VT,
+                         const int ldvt) {
+#ifdef INSIGHT_USE_LAPACKE
+  return LAPACKE_dgesdd(LAPACK_ROW_MAJOR, 'S', M, N, A, ld(lda), S, U,
+                        ld(ldu), VT, ld(ldvt));
+#else
+  return gesdd(M, N, A, lda, S, U, ldu, VT, ldvt);
+#endif
+}
+
+// Triangular solves, which need no LAPACK routine. A single right hand side
+// (e.g. that of a vector solve) goes through trsv.
+
+template<>
+void lapack_trtrs<float>(const CBLAS_UPLO Uplo, const int N, const int nrhs,
+                         const float* A, const int lda, float* B,
+                         const int ldb) {
+  if (nrhs == 1) {
+    blas_trsv(Uplo, CblasNoTrans, CblasNonUnit, N, A, lda, B, ldb);
+  } else {
+    blas_trsm(CblasLeft, Uplo, CblasNoTrans, CblasNonUnit, N, nrhs, 1.0f, A,
+              lda, B, ldb);
+  }
+}
+
+template<>
+void lapack_trtrs<double>(const CBLAS_UPLO Uplo, const int N, const int nrhs,
+                          const double* A, const int lda, double* B,
+                          const int ldb) {
+  if (nrhs == 1) {
+    blas_trsv(Uplo, CblasNoTrans, CblasNonUnit, N, A, lda, B, ldb);
+  } else {
+    blas_trsm(CblasLeft, Uplo, CblasNoTrans, CblasNonUnit, N, nrhs, 1.0, A,
+              lda, B, ldb);
+  }
+}
+
+}  // namespace linalg_detail
+}  // namespace insight
@@ -0,0 +1,90 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <vector>
+
+#include "insight/linalg.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+TEST(matmul_batch, matrix_matrix) {
+  const double a[] = {1.0, 2.0,
+                      3.0, 4.0,
+                      // Second problem.
+                      0.0, 1.0,
+                      1.0, 0.0};
+  const double b[] = {1.0, 0.0, 1.0,
+                      0.0, 1.0, 1.0,
+                      // Second problem.
+                      1.0, 2.0, 3.0,
+                      4.0, 5.0, 6.0};
+  double c[12] = {0.0};
+
+  std::vector<matrix_map<const double> > A, B;
+  std::vector<matrix_map<double> > C;
+  for (int i = 0; i < 2; ++i) {
+    A.push_back(matrix_map<const double>(a + 4 * i, 2, 2));
+    B.push_back(matrix_map<const double>(b + 6 * i, 2, 3));
+    C.push_back(matrix_map<double>(c + 6 * i, 2, 3));
+  }
+
+  matmul_batch(A, B, &C);
+  EXPECT_THAT(c, ElementsAreArray({1.0, 2.0, 3.0,
+                                  3.0, 4.0, 7.0,
+                                  4.0, 5.0, 6.0,
+                                  1.0, 2.0, 3.0}));
+
+  // The same as matmul, one problem at a time.
+  matrix<double> expected = matmul(A[1], B[1]);
+  EXPECT_THAT(C[1], ElementsAreArray(expected));
+
+  // C[i] = 2 * A[i] * B[i] - C[i]
+  matmul_batch(A, B, &C, 2.0, -1.0);
+  EXPECT_THAT(c, ElementsAreArray({1.0, 2.0, 3.0,
+                                  3.0, 4.0, 7.0,
+                                  4.0, 5.0, 6.0,
+                                  1.0, 2.0, 3.0}));
+}
+
+TEST(matmul_batch, matrix_vector) {
+  const float a[] = {1.0f, 2.0f,
+                     3.0f, 4.0f,
+                     5.0f, 6.0f};
+  const float x[] = {1.0f, 1.0f,
+                     1.0f, -1.0f};
+  float y[] = {1.0f, 1.0f, 1.0f,
+               1.0f, 1.0f, 1.0f};
+
+  // The same matrix for both problems.
+  std::vector<matrix_map<const float> > A(2, matrix_map<const float>(a, 3, 2));
+  std::vector<vector_map<const float> > X;
+  std::vector<vector_map<float> > Y;
+  for (int i = 0; i < 2; ++i) {
+    X.push_back(vector_map<const float>(x + 2 * i, 2));
+    Y.push_back(vector_map<float>(y + 3 * i, 3));
+  }
+
+  matmul_batch(A, X, &Y, 1.0f, 1.0f);
+  EXPECT_THAT(y, ElementsAre(4.0f, 8.0f, 12.0f,
+                             0.0f, 0.0f, 0.0f));
+}
+
+TEST(matmul_batch, death) {
+  double a[6] = {0.0};
+  matrix_map<const double> m(a, 2, 3);
+  std::vector<matrix_map<const double> > A(2, m), B(2, m);
+  std::vector<matrix_map<double> > C(2, matrix_map<double>(a, 2, 3));
+  EXPECT_DEATH(matmul_batch(A, B, &C), "mismatched dimensions");
+
+  C.pop_back();
+  EXPECT_DEATH(matmul_batch(A, B, &C), "mismatched batch sizes");
+}
+
+}  // namespace insight
@@ -2,6 +2,8 @@
 //
 // Author: mail2ngoclinh@gmail.com (Ngoc Linh)
 
+#include <cstddef>
+
 #include "insight/linalg/matrix.h"
 #include "insight/linalg/vector.h"
 #include "insight/linalg/functions.h"
@@ -12,6 +14,7 @@
 namespace insight {
 
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 
 TEST(matmul_expression, int_matrix_mul_vector) {
   matrix<int> A = {{1, 2, 3}, {4, 5, 6}};
@@ -366,4 +369,412 @@ TEST(matmul_expression, alpha_times_matmul_aAtbx) {
   EXPECT_THAT(y, ElementsAre(10, 12.5, 15));
 }
 
+TEST(matmul_expression, int_matrix_mul_matrix) {
+  matrix<int> A = {{1, 2, 3}, {4, 5, 6}};
+  matrix<int> B = {{-1, 0}, {2, 1}, {0, 3}};
+
+  matrix<int> C = matmul(A, B);
+
+  EXPECT_FALSE(C.empty());
+  EXPECT_EQ(C.size(), 4);
+  EXPECT_EQ(C.row_count(), 2);
+  EXPECT_EQ(C.col_count(), 2);
+  EXPECT_THAT(C, ElementsAre(3, 11, 6, 23));
+
+  C += matmul(A, B);
+  EXPECT_THAT(C, ElementsAre(6, 22, 12, 46));
+
+  C -= matmul(A, B);
+  EXPECT_THAT(C, ElementsAre(3, 11, 6, 23));
+
+  C = matmul(B.t(), A.t());
+  EXPECT_EQ(C.row_count(), 2);
+  EXPECT_EQ(C.col_count(), 2);
+  EXPECT_THAT(C, ElementsAre(3, 6, 11, 23));
+}
+
+TEST(matmul_expression, float_AB) {
+  matrix<double> A = {{0.5, 1.0, 1.5}, {2.0, 2.5, 3.0}};
+  matrix<double> B = {{1.0, -1.0}, {0.0, 2.0}, {2.0, 0.5}};
+
+  matrix<double> C = matmul(A, B);
+
+  EXPECT_FALSE(C.empty());
+  EXPECT_EQ(C.size(), 4);
+  EXPECT_EQ(C.row_count(), 2);
+  EXPECT_EQ(C.col_count(), 2);
+  EXPECT_THAT(C, ElementsAre(3.5, 2.25, 8.0, 4.5));
+
+  C += matmul(A, B);
+  EXPECT_THAT(C, ElementsAre(7.0, 4.5, 16.0, 9.0));
+
+  C -= matmul(A, B);
+  EXPECT_THAT(C, ElementsAre(3.5, 2.25, 8.0, 4.5));
+
+  C *= matmul(A, B);
+  EXPECT_THAT(C, ElementsAre(12.25, 5.0625, 64.0, 20.25));
+
+  C /= matmul(A, B);
+  EXPECT_THAT(C, ElementsAre(3.5, 2.25, 8.0, 4.5));
+}
+
+TEST(matmul_expression, float_aAbB) {
+  matrix<double> A = {{0.5, 1.0, 1.5}, {2.0, 2.5, 3.0}};
+  matrix<double> B = {{1.0, -1.0}, {0.0, 2.0}, {2.0, 0.5}};
+
+  matrix<double> C = matmul(2.0 * A, B * 0.5);
+  EXPECT_EQ(C.row_count(), 2);
+  EXPECT_EQ(C.col_count(), 2);
+  EXPECT_THAT(C, ElementsAre(3.5, 2.25, 8.0, 4.5));
+
+  C += matmul(A * 2.0, B);
+  EXPECT_THAT(C, ElementsAre(10.5, 6.75, 24.0, 13.5));
+
+  C -= matmul(A, 4.0 * B);
+  EXPECT_THAT(C, ElementsAre(-3.5, -2.25, -8.0, -4.5));
+}
+
+TEST(matmul_expression, float_transposed_operands) {
+  matrix<double> A = {{0.5, 1.0, 1.5}, {2.0, 2.5, 3.0}};
+  matrix<double> B = {{1.0, -1.0}, {0.0, 2.0}, {2.0, 0.5}};
+  matrix<double> C = {{1.0, 0.0, -1.0}, {2.0, 1.0, 0.0}};
+
+  // A' * A
+  matrix<double> D = matmul(A.t(), A);
+  EXPECT_EQ(D.row_count(), 3);
+  EXPECT_EQ(D.col_count(), 3);
+  EXPECT_THAT(D, ElementsAre(4.25, 5.5, 6.75,
+                             5.5, 7.25, 9.0,
+                             6.75, 9.0, 11.25));
+
+  // A * C'
+  D = matmul(A, C.t());
+  EXPECT_EQ(D.row_count(), 2);
+  EXPECT_EQ(D.col_count(), 2);
+  EXPECT_THAT(D, ElementsAre(-1.0, 2.0, -1.0, 6.5));
+
+  // a * A' * b * B'
+  D = matmul(2.0 * A.t(), B.t() * 0.5);
+  EXPECT_EQ(D.row_count(), 3);
+  EXPECT_EQ(D.col_count(), 3);
+  EXPECT_THAT(D, ElementsAre(-1.5, 4.0, 2.0,
+                             -1.5, 5.0, 3.25,
+                             -1.5, 6.0, 4.5));
+
+  D -= matmul(A.t(), B.t());
+  EXPECT_THAT(D, ElementsAre(0.0, 0.0, 0.0,
+                             0.0, 0.0, 0.0,
+                             0.0, 0.0, 0.0));
+}
+
+TEST(matmul_expression, transpose_of_matmul) {
+  matrix<double> A = {{0.5, 1.0, 1.5}, {2.0, 2.5, 3.0}};
+  matrix<double> B = {{1.0, -1.0}, {0.0, 2.0}, {2.0, 0.5}};
+
+  // (A * B)'
+  matrix<double> D = matmul(A, B).t();
+  EXPECT_EQ(D.row_count(), 2);
+  EXPECT_EQ(D.col_count(), 2);
+  EXPECT_THAT(D, ElementsAre(3.5, 8.0, 2.25, 4.5));
+
+  // Inside expression trees, and as an operand of another matmul.
+  D = matmul(A, B).t() * 2.0 - 1.0;
+  EXPECT_THAT(D, ElementsAre(6.0, 15.0, 3.5, 8.0));
+
+  vector<double> x = {1.0, 1.0};
+  vector<double> y = matmul(matmul(A, B).t(), x);
+  EXPECT_THAT(y, ElementsAre(11.5, 6.75));
+
+  // Reads the destination.
+  D = matmul(A, B).t();
+  D = matmul(D, D).t();
+  EXPECT_THAT(D, ElementsAre(30.25, 18.0, 64.0, 38.25));
+
+  // Outer product.
+  vector<double> u = {1.0, 2.0};
+  vector<double> v = {1.0, -1.0, 3.0};
+  D = matmul(u, v.t()).t();
+  EXPECT_EQ(D.row_count(), 3);
+  EXPECT_EQ(D.col_count(), 2);
+  EXPECT_THAT(D, ElementsAre(1.0, 2.0, -1.0, -2.0, 3.0, 6.0));
+
+  matrix<int> I = {{1, 2}, {3, 4}};
+  matrix<int> J = matmul(I, I).t();
+  EXPECT_THAT(J, ElementsAre(7, 15, 10, 22));
+}
+
+TEST(matmul_expression, alpha_times_matmul_aAbB) {
+  matrix<double> A = {{0.5, 1.0, 1.5}, {2.0, 2.5, 3.0}};
+  matrix<double> B = {{1.0, -1.0}, {0.0, 2.0}, {2.0, 0.5}};
+
+  matrix<double> C = 2.0 * matmul(A, B);
+  EXPECT_EQ(C.row_count(), 2);
+  EXPECT_EQ(C.col_count(), 2);
+  EXPECT_THAT(C, ElementsAre(7.0, 4.5, 16.0, 9.0));
+
+  C += matmul(A, 0.5 * B) * 2.0;
+  EXPECT_THAT(C, ElementsAre(10.5, 6.75, 24.0, 13.5));
+
+  C -= 3.0 * matmul(A, B);
+  EXPECT_THAT(C, ElementsAre(0.0, 0.0, 0.0, 0.0));
+}
+
+TEST(matmul_expression, float_matmul_plus_minus_y) {
+  matrix<double> A = {{0.5, 1.0, 1.5, 2.0},
+                      {2.5, 3.0, 3.5, 4.0},
+                      {4.5, 5.0, 5.5, 6.0}};
+  vector<double> x = {-0.5, 1.0, 0.0, 2.0};
+  vector<double> y = {1.0, 2.0, 3.0};
+  vector<double> z = {0.5, 0.5, 0.5};
+
+  y = 2.0 * matmul(A, x) + 0.5 * y;
+  EXPECT_EQ(y.size(), 3);
+  EXPECT_THAT(y, ElementsAre(10.0, 20.5, 31.0));
+
+  y = matmul(A, x) + z;
+  EXPECT_THAT(y, ElementsAre(5.25, 10.25, 15.25));
+
+  y = z - matmul(A, x);
+  EXPECT_THAT(y, ElementsAre(-4.25, -9.25, -14.25));
+
+  y = y - matmul(A, x) * 2.0;
+  EXPECT_THAT(y, ElementsAre(-13.75, -28.75, -43.75));
+
+  y += matmul(A, x) + z;
+  EXPECT_THAT(y, ElementsAre(-8.5, -18.5, -28.5));
+
+  y -= matmul(A, x) - 2.0 * y;
+  EXPECT_THAT(y, ElementsAre(-30.25, -65.25, -100.25));
+
+  y += 0.5 * y + matmul(A, x);
+  EXPECT_THAT(y, ElementsAre(-40.625, -88.125, -135.625));
+
+  // A' * w
+  vector<double> w = {1.0, 0.0, -1.0};
+  vector<double> u = {1.0, 2.0, 3.0, 4.0};
+
+  u = matmul(A.t(), w) - u;
+  EXPECT_EQ(u.size(), 4);
+  EXPECT_THAT(u, ElementsAre(-5.0, -6.0, -7.0, -8.0));
+
+  u = u + matmul(A.t(), w);
+  EXPECT_THAT(u, ElementsAre(-9.0, -10.0, -11.0, -12.0));
+
+  u -= u + matmul(A.t(), 2.0 * w);
+  EXPECT_THAT(u, ElementsAre(8.0, 8.0, 8.0, 8.0));
+}
+
+TEST(matmul_expression, float_matmul_aAbB_plus_minus_C) {
+  matrix<double> A = {{0.5, 1.0, 1.5}, {2.0, 2.5, 3.0}};
+  matrix<double> B = {{1.0, -1.0}, {0.0, 2.0}, {2.0, 0.5}};
+  matrix<double> C = {{1.0, 2.0}, {3.0, 4.0}};
+
+  C = matmul(A, B) - 2.0 * C;
+  EXPECT_EQ(C.row_count(), 2);
+  EXPECT_EQ(C.col_count(), 2);
+  EXPECT_THAT(C, ElementsAre(1.5, -1.75, 2.0, -3.5));
+
+  C = C * 0.5 + 2.0 * matmul(A, B);
+  EXPECT_THAT(C, ElementsAre(7.75, 3.625, 17.0, 7.25));
+
+  C -= matmul(A, B) + C;
+  EXPECT_THAT(C, ElementsAre(-3.5, -2.25, -8.0, -4.5));
+
+  C += C + matmul(A, B);
+  EXPECT_THAT(C, ElementsAre(-3.5, -2.25, -8.0, -4.5));
+}
+
+// The same fused products in single precision, i.e through sgemv and sgemm.
+TEST(matmul_expression, single_precision_matmul_plus_minus_y) {
+  matrix<float> A = {{0.5f, 1.0f, 1.5f, 2.0f},
+                     {2.5f, 3.0f, 3.5f, 4.0f},
+                     {4.5f, 5.0f, 5.5f, 6.0f}};
+  vector<float> x = {-0.5f, 1.0f, 0.0f, 2.0f};
+  vector<float> y = {1.0f, 2.0f, 3.0f};
+  vector<float> z = {0.5f, 0.5f, 0.5f};
+
+  y = 2.0f * matmul(A, x) + 0.5f * y;
+  EXPECT_EQ(y.size(), 3);
+  EXPECT_THAT(y, ElementsAre(10.0f, 20.5f, 31.0f));
+
+  y = z - matmul(A, x);
+  EXPECT_THAT(y, ElementsAre(-4.25f, -9.25f, -14.25f));
+
+  y -= matmul(A, x) - 2.0f * y;
+  EXPECT_THAT(y, ElementsAre(-17.5f, -37.5f, -57.5f));
+
+  // A' * w
+  vector<float> w = {1.0f, 0.0f, -1.0f};
+  vector<float> u = {1.0f, 2.0f, 3.0f, 4.0f};
+
+  u = matmul(A.t(), w) - u;
+  EXPECT_EQ(u.size(), 4);
+  EXPECT_THAT(u, ElementsAre(-5.0f, -6.0f, -7.0f, -8.0f));
+}
+
+TEST(matmul_expression, single_precision_matmul_aAbB_plus_minus_C) {
+  matrix<float> A = {{0.5f, 1.0f, 1.5f}, {2.0f, 2.5f, 3.0f}};
+  matrix<float> B = {{1.0f, -1.0f}, {0.0f, 2.0f}, {2.0f, 0.5f}};
+  matrix<float> C = {{1.0f, 2.0f}, {3.0f, 4.0f}};
+
+  C = matmul(A, B) - 2.0f * C;
+  EXPECT_EQ(C.row_count(), 2);
+  EXPECT_EQ(C.col_count(), 2);
+  EXPECT_THAT(C, ElementsAre(1.5f, -1.75f, 2.0f, -3.5f));
+
+  C = C * 0.5f + 2.0f * matmul(A, B);
+  EXPECT_THAT(C, ElementsAre(7.75f, 3.625f, 17.0f, 7.25f));
+
+  C -= matmul(A, B) + C;
+  EXPECT_THAT(C, ElementsAre(-3.5f, -2.25f, -8.0f, -4.5f));
+}
+
+TEST(matmul_expression, outer_product) {
+  vector<double> x = {1.0, 2.0};
+  vector<double> y = {1.0, -1.0, 3.0};
+
+  matrix<double> A = matmul(x, y.t());
+  EXPECT_EQ(A.row_count(), 2);
+  EXPECT_EQ(A.col_count(), 3);
+  EXPECT_THAT(A, ElementsAre(1.0, -1.0, 3.0,
+                             2.0, -2.0, 6.0));
+
+  A += matmul(2.0 * x, y.t());
+  EXPECT_THAT(A, ElementsAre(3.0, -3.0, 9.0,
+                             6.0, -6.0, 18.0));
+
+  A -= 3.0 * matmul(x, y.t());
+  EXPECT_THAT(A, ElementsAre(0.0, 0.0, 0.0,
+                             0.0, 0.0, 0.0));
+
+  A = matmul(x, (y * 0.5).t()) + 2.0 * A;
+  EXPECT_THAT(A, ElementsAre(0.5, -0.5, 1.5,
+                             1.0, -1.0, 3.0));
+
+  A = A - matmul(x, y.t()) * 0.5;
+  EXPECT_THAT(A, ElementsAre(0.0, 0.0, 0.0,
+                             0.0, 0.0, 0.0));
+
+  // Outer products of vector expressions, inside expression trees.
+  matrix<double> M = {{1.0, 0.0}, {1.0, 1.0}};
+  A = matmul(x - 1.0, y.t()) * 2.0;
+  EXPECT_THAT(A, ElementsAre(0.0, 0.0, 0.0,
+                             2.0, -2.0, 6.0));
+
+  A = matmul(matmul(M, x), y.t()) - A;
+  EXPECT_THAT(A, ElementsAre(1.0, -1.0, 3.0,
+                             1.0, -1.0, 3.0));
+
+  matrix<int> B = matmul(vector<int>{1, 2}, vector<int>{3, 4}.t());
+  EXPECT_THAT(B, ElementsAre(3, 4, 6, 8));
+}
+
+TEST(matmul_expression, symmetric_product) {
+  matrix<double> X = {{1.0, 2.0, 0.0},
+                      {-1.0, 0.5, 3.0},
+                      {2.0, 1.0, -1.0},
+                      {0.0, 1.5, 2.0}};
+  matrix<double> XtX(3, 3, 0.0), XXt(4, 4, 0.0);
+  for (std::size_t i = 0; i < 3; ++i) {
+    for (std::size_t j = 0; j < 3; ++j) {
+      for (std::size_t k = 0; k < 4; ++k) XtX(i, j) += X(k, i) * X(k, j);
+    }
+  }
+  for (std::size_t i = 0; i < 4; ++i) {
+    for (std::size_t j = 0; j < 4; ++j) {
+      for (std::size_t k = 0; k < 3; ++k) XXt(i, j) += X(i, k) * X(j, k);
+    }
+  }
+
+  matrix<double> G = matmul(X.t(), X);
+  EXPECT_EQ(G.row_count(), 3);
+  EXPECT_EQ(G.col_count(), 3);
+  EXPECT_THAT(G, ElementsAreArray(XtX.begin(), XtX.end()));
+
+  matrix<double> H = matmul(X, X.t());
+  EXPECT_EQ(H.row_count(), 4);
+  EXPECT_EQ(H.col_count(), 4);
+  EXPECT_THAT(H, ElementsAreArray(XXt.begin(), XXt.end()));
+
+  // Accumulation into a matrix which is not symmetric itself.
+  matrix<double> C = {{1.0, 2.0, 3.0},
+                      {4.0, 5.0, 6.0},
+                      {7.0, 8.0, 9.0}};
+  matrix<double> expected = C * 2.0 + XtX;
+  C = 2.0 * C + matmul(X.t(), X);
+  EXPECT_THAT(C, ElementsAreArray(expected.begin(), expected.end()));
+
+  C -= matmul(0.5 * X.t(), X * 2.0);
+  expected -= XtX;
+  EXPECT_THAT(C, ElementsAreArray(expected.begin(), expected.end()));
+
+  // Into a block.
+  matrix<double> D(4, 5, 1.0);
+  D.block(1, 2, 3, 3) = matmul(X.t(), X);
+  for (std::size_t i = 0; i < 4; ++i) {
+    for (std::size_t j = 0; j < 5; ++j) {
+      const bool inside = (i >= 1 && j >= 2);
+      EXPECT_EQ(D(i, j), inside ? XtX(i - 1, j - 2) : 1.0);
+    }
+  }
+}
+
+TEST(matmul_expression, float_matmul_inside_expression_tree) {
+  matrix<float> A = {{1, 2}, {3, 4}};
+  vector<float> x = {1, 1};
+  vector<float> b = {-3, -7};
+
+  vector<float> y = exp(matmul(A, x) + b);
+  EXPECT_THAT(y, ElementsAre(1, 1));
+
+  y += exp(b + matmul(A, x));
+  EXPECT_THAT(y, ElementsAre(2, 2));
+
+  b = {1, 9};
+  y = sqrt(matmul(A, x) + b) * 2.0f;
+  EXPECT_THAT(y, ElementsAre(4, 8));
+
+  y -= 2.0f * matmul(A, x) - b;
+  EXPECT_THAT(y, ElementsAre(-1, 3));
+
+  // Aliased: y is read by the matmul.
+  y = {1, 1};
+  y = matmul(A, y) + 1.0f;
+  EXPECT_THAT(y, ElementsAre(4, 8));
+}
+
+TEST(matmul_expression, float_matmul_of_expressions) {
+  matrix<double> A = {{1, 2}, {0, 1}};
+  matrix<double> B = {{1, 1}, {0, 1}};
+  vector<double> x = {1, 4};
+
+  vector<double> y = matmul(A, sqrt(x));
+  EXPECT_THAT(y, ElementsAre(5, 2));
+
+  y = matmul(A + B, x - 1.0);
+  EXPECT_THAT(y, ElementsAre(9, 6));
+
+  y = matmul(matmul(A, B), x);
+  EXPECT_THAT(y, ElementsAre(13, 4));
+
+  matrix<double> C = matmul(A, B) * matmul(B, A);
+  EXPECT_THAT(C, ElementsAre(1, 9, 0, 1));
+
+  C = matmul((A + B).t(), B);
+  EXPECT_THAT(C, ElementsAre(2, 2, 3, 5));
+}
+
+TEST(matmul_expression, int_matmul_inside_expression_tree) {
+  matrix<int> A = {{1, 2, 3}, {4, 5, 6}};
+  matrix<int> B = {{1, 0}, {0, 1}, {1, 1}};
+  vector<int> x = {-1, 0, 2};
+  vector<int> v = {1, 1};
+
+  vector<int> y = 2 * matmul(A, x) - v;
+  EXPECT_THAT(y, ElementsAre(9, 15));
+
+  y = matmul(matmul(A, B), v) + v;
+  EXPECT_THAT(y, ElementsAre(10, 22));
+}
+
 }  // namespace insight
@@ -3,6 +3,8 @@
 // Author: mail2ngoclinh@gmail.com (Ngoc Linh)
 
 #include "insight/linalg/matrix.h"
+#include "insight/linalg/vector.h"
+#include "insight/linalg/functions.h"
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
@@ -755,6 +757,25 @@ TEST(matrix_expression, float_matrix_plus_matrix) {
   EXPECT_THAT(C, ElementsAre(1.5, 0.5, 1.5, 4.0, 5.5, 4.5));
 }
 
+TEST(matrix_expression, float_aA_plus_minus_bB) {
+  matrix<double> A = {{0.5, 1.0, 1.5}, {2.0, 2.5, 3.0}};
+  matrix<double> B = {{1.0, -0.5, 0}, {2.0, 3.0, 1.5}};
+
+  matrix<double> C = 2.0 * A - B * 0.5;
+
+  EXPECT_EQ(C.row_count(), 2);
+  EXPECT_EQ(C.col_count(), 3);
+  EXPECT_EQ(C.size(), 6);
+  EXPECT_FALSE(C.empty());
+  EXPECT_THAT(C, ElementsAre(0.5, 2.25, 3.0, 3.0, 3.5, 5.25));
+
+  C += A + 2.0 * B;
+  EXPECT_THAT(C, ElementsAre(3.0, 2.25, 4.5, 9.0, 12.0, 11.25));
+
+  C -= 0.5 * C - A;
+  EXPECT_THAT(C, ElementsAre(2.0, 2.125, 3.75, 6.5, 8.5, 8.625));
+}
+
 // test substraction between two matrices.
 
 TEST(matrix_expression, int_matrix_minus_matrix) {
@@ -971,4 +992,39 @@ TEST(matrix_expression, double_matrix_times_matrix) {
 
 // TODO(Linh): test element-wise division between two matrices.
 
+// Expressions that are not special expressions are evaluated element by
+// element through eval(i); make sure every kind of node indexes correctly.
+TEST(matrix_expression, double_mixed_expression_tree) {
+  matrix<double> A = {{1, 2, 3}, {4, 5, 6}};
+  matrix<double> B = {{6, 5, 4}, {3, 2, 1}};
+  matrix<double> D = {{1, 1}, {2, 2}, {3, 3}};
+  vector<double> x = {1, 1, 1};
+
+  // transpose of an expression.
+  matrix<double> C = (A - B).t() * 2.0 - D;
+  EXPECT_EQ(C.row_count(), 3);
+  EXPECT_EQ(C.col_count(), 2);
+  EXPECT_THAT(C, ElementsAre(-11, 1, -8, 4, -5, 7));
+
+  C += (A - B).t() * 2.0 - D;
+  EXPECT_THAT(C, ElementsAre(-22, 2, -16, 8, -10, 14));
+
+  // matrix-matrix products, one of them of a transpose.
+  matrix<double> S = matmul(A, D) - matmul(D.t(), D);
+  EXPECT_EQ(S.row_count(), 2);
+  EXPECT_EQ(S.col_count(), 2);
+  EXPECT_THAT(S, ElementsAre(0, 0, 18, 18));
+
+  // matrix-vector product and column view.
+  vector<double> y = matmul(A, x) / A.col_at(2);
+  EXPECT_EQ(y.size(), 2);
+  EXPECT_THAT(y, ElementsAre(2, 2.5));
+
+  // row views.
+  matrix<double> r = (A.row_at(1) - B.row_at(1)) * 2.0;
+  EXPECT_EQ(r.row_count(), 1);
+  EXPECT_EQ(r.col_count(), 3);
+  EXPECT_THAT(r, ElementsAre(2, 6, 10));
+}
+
 }  // namespace insight
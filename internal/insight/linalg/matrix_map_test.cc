@@ -0,0 +1,122 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include "insight/linalg.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+
+TEST(matrix_map, constructors) {
+  double x[] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+  matrix_map<double> a(x, 2, 3);
+  EXPECT_EQ(a.size(), 6);
+  EXPECT_EQ(a.row_count(), 2);
+  EXPECT_EQ(a.col_count(), 3);
+  EXPECT_EQ(a.data(), x);
+  EXPECT_EQ(a(1, 0), 4.0);
+
+  a(0, 2) = 7.0;
+  EXPECT_EQ(x[2], 7.0);
+
+  const double y[] = {1.0, 2.0, 3.0, 4.0};
+  matrix_map<const double> b(y, 2, 2);
+  matrix<double> c = b.t();
+  EXPECT_THAT(c, ElementsAre(1.0, 3.0, 2.0, 4.0));
+}
+
+TEST(matrix_map, arithmetic) {
+  double x[] = {1.0, 2.0, 3.0, 4.0};
+  const double y[] = {1.0, 1.0, 2.0, 2.0};
+  matrix_map<double> a(x, 2, 2);
+  matrix_map<const double> b(y, 2, 2);
+
+  a += b;
+  EXPECT_THAT(x, ElementsAre(2.0, 3.0, 5.0, 6.0));
+  a *= 2.0;
+  EXPECT_THAT(x, ElementsAre(4.0, 6.0, 10.0, 12.0));
+  a /= b;
+  EXPECT_THAT(x, ElementsAre(4.0, 6.0, 5.0, 6.0));
+
+  // In place transpose goes through a temporary.
+  a = a.t();
+  EXPECT_THAT(x, ElementsAre(4.0, 5.0, 6.0, 6.0));
+
+  EXPECT_DOUBLE_EQ(sum(a), 21.0);
+}
+
+TEST(matrix_map, matmul) {
+  const double j[] = {1.0, 2.0, 3.0,
+                      4.0, 5.0, 6.0};
+  const double r[] = {1.0, -1.0};
+  double g[] = {0.0, 0.0, 0.0};
+  matrix_map<const double> J(j, 2, 3);
+  vector_map<const double> r_map(r, 2);
+  vector_map<double> g_map(g, 3);
+
+  g_map = matmul(J.t(), r_map);
+  EXPECT_THAT(g, ElementsAre(-3.0, -3.0, -3.0));
+
+  double h[] = {0.0, 0.0, 0.0, 0.0};
+  matrix_map<double> H(h, 2, 2);
+  H = matmul(J, J.t());
+  EXPECT_EQ(H.data(), h);
+  EXPECT_THAT(h, ElementsAre(14.0, 32.0, 32.0, 77.0));
+
+  // Reads H while writing it.
+  H = matmul(H, H);
+  EXPECT_THAT(h, ElementsAre(1220.0, 2912.0, 2912.0, 6953.0));
+}
+
+TEST(matrix_map, views) {
+  double x[] = {1.0, 2.0, 3.0,
+                4.0, 5.0, 6.0,
+                7.0, 8.0, 9.0};
+  matrix_map<double> a(x, 3, 3);
+
+  a.row_at(0) = a.row_at(2);
+  EXPECT_THAT(x, ElementsAre(7.0, 8.0, 9.0,
+                             4.0, 5.0, 6.0,
+                             7.0, 8.0, 9.0));
+
+  a.col_at(1) *= 2.0;
+  EXPECT_THAT(x, ElementsAre(7.0, 16.0, 9.0,
+                             4.0, 10.0, 6.0,
+                             7.0, 16.0, 9.0));
+
+  matrix<double> B = {{1.0, 0.0},
+                      {0.0, 1.0}};
+  a.block(1, 1, 2, 2) = matmul(B, a.block(0, 0, 2, 2));
+  EXPECT_THAT(x, ElementsAre(7.0, 16.0, 9.0,
+                             4.0, 7.0, 16.0,
+                             7.0, 4.0, 10.0));
+}
+
+TEST(matrix_map, overlapping_shifted_maps) {
+  // B is A shifted by one element.
+  double x[] = {1.0, 2.0, 3.0, 4.0, 5.0};
+  matrix_map<double> A(x, 2, 2);
+  matrix_map<double> B(x + 1, 2, 2);
+  B = exp(A) * 0.0 + A;
+  EXPECT_THAT(x, ElementsAre(1.0, 1.0, 2.0, 3.0, 4.0));
+
+  double y[] = {1.0, 2.0, 3.0, 4.0, 5.0};
+  matrix_map<double> C(y, 2, 2);
+  matrix_map<double> D(y + 1, 2, 2);
+  D -= C;
+  EXPECT_THAT(y, ElementsAre(1.0, 1.0, 1.0, 1.0, 1.0));
+}
+
+TEST(matrix_map, death) {
+  double x[] = {1.0, 2.0, 3.0, 4.0};
+  matrix_map<double> a(x, 2, 2);
+  matrix<double> b(1, 4);
+  EXPECT_DEATH(a = b, "mismatched");
+  EXPECT_DEATH(a -= b, "mismatched");
+}
+
+}  // namespace insight
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "insight/linalg/matrix.h"
+#include "insight/linalg/test_util.h"
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
@@ -14,6 +15,7 @@ namespace insight {
 
 using ::testing::ElementsAre;
 using ::testing::DoubleEq;
+using test::is_stored_inline;
 
 TEST(matrix, default_constructor) {
   matrix<double> m;
@@ -493,4 +495,55 @@ TEST(matrix, div_matrix) {
   EXPECT_THAT(A, ElementsAre(1, 2, 3, 5, 3, 2, 7, 6, 4));
 }
 
+TEST(matrix, transpose_inplace) {
+  for (size_t m : {1, 2, 33, 70}) {
+    for (size_t n : {1, 3, 33, 70}) {
+      matrix<double> A(std::make_pair(m, n));
+      for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<double>(i);
+      const double* data = A.data();
+
+      A.transpose_inplace();
+
+      EXPECT_EQ(A.data(), data);
+      EXPECT_EQ(A.row_count(), n);
+      EXPECT_EQ(A.col_count(), m);
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+          EXPECT_EQ(A(i, j), static_cast<double>(j * n + i));
+        }
+      }
+    }
+  }
+}
+
+TEST(matrix, small_buffer) {
+  using small_matrix = matrix<double, allocator<double>, 4>;
+
+  small_matrix a = {{1, 2}, {3, 4}};
+  EXPECT_TRUE(is_stored_inline(a));
+
+  small_matrix b = a.t();
+  EXPECT_TRUE(is_stored_inline(b));
+  EXPECT_THAT(b, ElementsAre(1, 3, 2, 4));
+
+  small_matrix c(3, 2, 1.0);
+  EXPECT_FALSE(is_stored_inline(c));
+
+  small_matrix d(std::move(a));
+  EXPECT_TRUE(is_stored_inline(d));
+  EXPECT_EQ(d.shape(), std::make_pair(2ul, 2ul));
+  EXPECT_THAT(d, ElementsAre(1, 2, 3, 4));
+
+  d.swap(c);
+  EXPECT_FALSE(is_stored_inline(d));
+  EXPECT_TRUE(is_stored_inline(c));
+  EXPECT_EQ(d.shape(), std::make_pair(3ul, 2ul));
+  EXPECT_THAT(c, ElementsAre(1, 2, 3, 4));
+
+  // Outgrows the small buffer.
+  c = d + 1.0;
+  EXPECT_FALSE(is_stored_inline(c));
+  EXPECT_THAT(c, ElementsAre(2, 2, 2, 2, 2, 2));
+}
+
 }  // namespace insight
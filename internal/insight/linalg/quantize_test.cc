@@ -0,0 +1,180 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include "insight/linalg.h"
+#include "insight/linalg/test_util.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using test::random_matrix;
+using test::random_vector;
+
+namespace {
+
+// The float product of the dequantized operands, that qmatmul must match up
+// to the rounding of its float epilogue.
+vector<float> reference_qmatmul(const quantized_matrix& W,
+                                const vector<uint8_t>& x,
+                                const quantization_params& p) {
+  const matrix<float> w = W.dequantize();
+  const vector<float> v = dequantize(x, p);
+  vector<float> y(W.row_count());
+  for (std::size_t i = 0; i < W.row_count(); ++i) {
+    double sum = 0.0;
+    for (std::size_t j = 0; j < W.col_count(); ++j) {
+      sum += static_cast<double>(w(i, j)) * v[j];
+    }
+    y[i] = static_cast<float>(sum);
+  }
+  return y;
+}
+
+}  // namespace
+
+TEST(quantize, choose_quantization_params) {
+  quantization_params p = choose_quantization_params(-1.0f, 3.0f);
+  EXPECT_FLOAT_EQ(p.scale, 4.0f / 255.0f);
+  EXPECT_EQ(p.zero_point, 64);
+
+  // The range is extended to contain 0.
+  p = choose_quantization_params(2.0f, 4.0f);
+  EXPECT_FLOAT_EQ(p.scale, 4.0f / 255.0f);
+  EXPECT_EQ(p.zero_point, 0);
+
+  p = choose_quantization_params(-4.0f, -2.0f);
+  EXPECT_FLOAT_EQ(p.scale, 4.0f / 255.0f);
+  EXPECT_EQ(p.zero_point, 255);
+
+  p = choose_quantization_params(0.0f, 0.0f);
+  EXPECT_FLOAT_EQ(p.scale, 1.0f);
+  EXPECT_EQ(p.zero_point, 0);
+}
+
+TEST(quantize, round_trip) {
+  std::mt19937 gen(3);
+  const vector<float> x = random_vector<float>(1000, &gen, -2.0f, 5.0f);
+  const quantization_params p = choose_quantization_params(-2.0f, 5.0f);
+
+  const vector<float> y = dequantize(quantize(x, p), p);
+  ASSERT_EQ(y.size(), x.size());
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    EXPECT_LE(std::fabs(y[i] - x[i]), 0.5f * p.scale * 1.0001f) << i;
+  }
+
+  // 0 is exact.
+  const vector<float> zero = {0.0f};
+  EXPECT_THAT(dequantize(quantize(zero, p), p), ElementsAre(0.0f));
+
+  const matrix<float> X = random_matrix<float>(7, 9, &gen, -2.0f, 5.0f);
+  const matrix<float> Y = dequantize(quantize(X, p), p);
+  for (std::size_t i = 0; i < X.size(); ++i) {
+    EXPECT_LE(std::fabs(Y.data()[i] - X.data()[i]), 0.5f * p.scale * 1.0001f);
+  }
+}
+
+TEST(quantize, saturates) {
+  const quantization_params p = choose_quantization_params(-1.0f, 1.0f);
+  const vector<float> x = {-100.0f, 100.0f,
+                           std::numeric_limits<float>::infinity(),
+                           -std::numeric_limits<float>::infinity(),
+                           std::numeric_limits<float>::quiet_NaN()};
+  EXPECT_THAT(quantize(x, p), ElementsAre(0, 255, 255, 0, 0));
+}
+
+TEST(quantize, quantized_matrix) {
+  const matrix<float> A = {{1.0f, -0.5f, 0.25f},
+                           {0.0f, 0.0f, 0.0f},
+                           {-4.0f, 2.0f, 1.0f}};
+
+  const quantized_matrix per_row_q(A);
+  EXPECT_EQ(per_row_q.row_count(), 3);
+  EXPECT_EQ(per_row_q.col_count(), 3);
+  EXPECT_THAT(per_row_q.scales(),
+              ElementsAre(1.0f / 127.0f, 1.0f, 4.0f / 127.0f));
+  EXPECT_THAT(per_row_q.values(),
+              ElementsAre(127, -64, 32, 0, 0, 0, -127, 64, 32));
+  EXPECT_THAT(per_row_q.row_sums(), ElementsAre(95, 0, -31));
+
+  const quantized_matrix per_tensor_q(A, per_tensor);
+  EXPECT_THAT(per_tensor_q.scales(),
+              ElementsAre(4.0f / 127.0f, 4.0f / 127.0f, 4.0f / 127.0f));
+  EXPECT_THAT(per_tensor_q.values(),
+              ElementsAre(32, -16, 8, 0, 0, 0, -127, 64, 32));
+  EXPECT_THAT(per_tensor_q.row_sums(), ElementsAre(24, 0, -31));
+
+  // Each weight is within half a step of its original value.
+  std::mt19937 gen(5);
+  const matrix<float> W = random_matrix<float>(20, 30, &gen, -3.0f, 3.0f);
+  const quantized_matrix Wq(W);
+  const matrix<float> w = Wq.dequantize();
+  for (std::size_t i = 0; i < W.row_count(); ++i) {
+    for (std::size_t j = 0; j < W.col_count(); ++j) {
+      EXPECT_LE(std::fabs(w(i, j) - W(i, j)), 0.5f * Wq.scales()[i] * 1.0001f);
+    }
+  }
+}
+
+TEST(quantize, qmatmul_vector) {
+  std::mt19937 gen(7);
+  const std::size_t sizes[][2] = {{1, 1}, {3, 5}, {16, 64}, {33, 100},
+                                  {10, 513}};
+  for (const auto& size : sizes) {
+    const matrix<float> W = random_matrix<float>(size[0], size[1], &gen);
+    const vector<float> x = random_vector<float>(size[1], &gen, -0.5f, 2.0f);
+
+    for (auto granularity : {per_row, per_tensor}) {
+      const quantized_matrix Wq(W, granularity);
+      const quantization_params p = choose_quantization_params(-0.5f, 2.0f);
+      const vector<uint8_t> xq = quantize(x, p);
+
+      const vector<float> y = qmatmul(Wq, xq, p);
+      const vector<float> expected = reference_qmatmul(Wq, xq, p);
+      ASSERT_EQ(y.size(), expected.size());
+      for (std::size_t i = 0; i < y.size(); ++i) {
+        EXPECT_NEAR(y[i], expected[i], 1e-5f * (1.0f + std::fabs(expected[i])))
+            << size[0] << "x" << size[1] << ", i = " << i;
+      }
+
+      // And, within the quantization error, the float product.
+      const vector<float> exact = matmul(W, x);
+      for (std::size_t i = 0; i < y.size(); ++i) {
+        EXPECT_NEAR(y[i], exact[i], 0.02f * std::sqrt(size[1]) + 1e-3f);
+      }
+    }
+  }
+}
+
+TEST(quantize, qmatmul_matrix) {
+  std::mt19937 gen(9);
+  const matrix<float> W = random_matrix<float>(12, 70, &gen);
+  const matrix<float> X = random_matrix<float>(5, 70, &gen);
+  const quantized_matrix Wq(W);
+  const quantization_params p = choose_quantization_params(-1.0f, 1.0f);
+  const matrix<uint8_t> Xq = quantize(X, p);
+
+  const matrix<float> Y = qmatmul(Wq, Xq, p);
+  ASSERT_EQ(Y.row_count(), 5);
+  ASSERT_EQ(Y.col_count(), 12);
+
+  // Each row is the product of W with the corresponding row of X.
+  for (std::size_t i = 0; i < X.row_count(); ++i) {
+    vector<uint8_t> xq(Xq.data() + i * 70, Xq.data() + (i + 1) * 70);
+    const vector<float> y = qmatmul(Wq, xq, p);
+    for (std::size_t j = 0; j < Y.col_count(); ++j) {
+      EXPECT_FLOAT_EQ(Y(i, j), y[j]);
+    }
+  }
+}
+
+}  // namespace insight
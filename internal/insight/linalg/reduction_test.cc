@@ -0,0 +1,225 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <cmath>
+
+#include "insight/linalg/matrix.h"
+#include "insight/linalg/vector.h"
+#include "insight/linalg/functions.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using ::testing::DoubleEq;
+using ::testing::FloatEq;
+
+TEST(reduction, of_a_dense_vector) {
+  vector<double> x = {3, -4, 1, 7, -2};
+
+  EXPECT_THAT(sum(x), DoubleEq(5));
+  EXPECT_THAT(mean(x), DoubleEq(1));
+  EXPECT_THAT(min(x), DoubleEq(-4));
+  EXPECT_THAT(max(x), DoubleEq(7));
+  EXPECT_THAT(asum(x), DoubleEq(17));
+  EXPECT_THAT(norm(x), DoubleEq(std::sqrt(79.0)));
+  EXPECT_EQ(argmin(x), 1);
+  EXPECT_EQ(argmax(x), 3);
+}
+
+TEST(reduction, of_an_int_vector) {
+  vector<int> x = {3, -4, 1, 7, -2, 7};
+
+  EXPECT_EQ(sum(x), 12);
+  EXPECT_EQ(mean(x), 2);
+  EXPECT_EQ(min(x), -4);
+  EXPECT_EQ(max(x), 7);
+  EXPECT_EQ(asum(x), 24);
+  EXPECT_EQ(argmin(x), 1);
+  // The first one wins ties.
+  EXPECT_EQ(argmax(x), 3);
+
+  vector<int> y = {3, 4};
+  EXPECT_EQ(norm(y), 5);
+}
+
+TEST(reduction, of_a_large_vector) {
+  const std::size_t n = 1001;
+  vector<float> x(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    x[i] = static_cast<float>(i % 17) - 8.0f;
+  }
+  x[613] = 100.0f;
+  x[27] = -50.0f;
+
+  float expected = 0;
+  for (std::size_t i = 0; i < n; ++i) expected += x[i];
+
+  EXPECT_THAT(sum(x), FloatEq(expected));
+  EXPECT_THAT(max(x), FloatEq(100));
+  EXPECT_THAT(min(x), FloatEq(-50));
+  EXPECT_EQ(argmax(x), 613);
+  EXPECT_EQ(argmin(x), 27);
+}
+
+TEST(reduction, of_expressions) {
+  vector<double> x = {1, 2, 3};
+  vector<double> y = {4, -5, 6};
+
+  EXPECT_THAT(sum(x * y), DoubleEq(12));
+  EXPECT_THAT(max(x - y), DoubleEq(7));
+  EXPECT_EQ(argmin(2.0 * y), 1);
+  EXPECT_THAT(sum(sqrt(x * x)), DoubleEq(6));
+  EXPECT_THAT(norm(x.t()), DoubleEq(std::sqrt(14.0)));
+
+  matrix<double> A = {{1, 2}, {3, 4}};
+  vector<double> z = {1, 2};
+  EXPECT_THAT(sum(matmul(A, z - 1.0)), DoubleEq(6));
+  EXPECT_THAT(mean(A.t()), DoubleEq(2.5));
+  EXPECT_EQ(argmax(A.t()), 3);
+}
+
+TEST(reduction, of_a_matrix) {
+  matrix<double> A = {{1, -2, 3}, {-4, 5, 6}};
+
+  EXPECT_THAT(sum(A), DoubleEq(9));
+  EXPECT_THAT(mean(A), DoubleEq(1.5));
+  EXPECT_THAT(min(A), DoubleEq(-4));
+  EXPECT_THAT(max(A), DoubleEq(6));
+  EXPECT_THAT(asum(A), DoubleEq(21));
+  EXPECT_EQ(argmin(A), 3);
+  EXPECT_EQ(argmax(A), 5);
+}
+
+TEST(reduction, rowwise) {
+  matrix<double> A = {{1, -2, 3}, {-4, 5, 6}};
+
+  vector<double> x = sum(A, rowwise);
+  EXPECT_THAT(x, ElementsAre(2, 7));
+
+  x = mean(A, rowwise);
+  EXPECT_THAT(x, ElementsAre(DoubleEq(2.0 / 3), DoubleEq(7.0 / 3)));
+
+  x = max(A, rowwise) - min(A, rowwise);
+  EXPECT_THAT(x, ElementsAre(5, 10));
+
+  x = asum(A, rowwise);
+  EXPECT_THAT(x, ElementsAre(6, 15));
+
+  x = norm(A, rowwise);
+  EXPECT_THAT(x, ElementsAre(DoubleEq(std::sqrt(14.0)),
+                             DoubleEq(std::sqrt(77.0))));
+
+  EXPECT_THAT(argmin(A, rowwise), ElementsAre(1, 0));
+  EXPECT_THAT(argmax(A, rowwise), ElementsAre(2, 2));
+
+  // Of an expression.
+  x = sum(2.0 * A, rowwise);
+  EXPECT_THAT(x, ElementsAre(4, 14));
+
+  // Reading the rows of a transpose.
+  x = sum(A.t(), rowwise);
+  EXPECT_THAT(x, ElementsAre(-3, 3, 9));
+
+  matrix<int> B = {{1, 7, 3}, {4, 2, 6}};
+  vector<int> y = max(B, rowwise);
+  EXPECT_THAT(y, ElementsAre(7, 6));
+}
+
+TEST(reduction, colwise) {
+  matrix<double> A = {{1, -2, 3}, {-4, 5, 6}};
+
+  vector<double> x = sum(A, colwise);
+  EXPECT_THAT(x, ElementsAre(-3, 3, 9));
+
+  x = mean(A, colwise);
+  EXPECT_THAT(x, ElementsAre(-1.5, 1.5, 4.5));
+
+  x = max(A, colwise);
+  EXPECT_THAT(x, ElementsAre(1, 5, 6));
+
+  x = min(A, colwise);
+  EXPECT_THAT(x, ElementsAre(-4, -2, 3));
+
+  x = asum(A, colwise);
+  EXPECT_THAT(x, ElementsAre(5, 7, 9));
+
+  x = norm(A, colwise);
+  EXPECT_THAT(x, ElementsAre(DoubleEq(std::sqrt(17.0)),
+                             DoubleEq(std::sqrt(29.0)),
+                             DoubleEq(std::sqrt(45.0))));
+
+  EXPECT_THAT(argmin(A, colwise), ElementsAre(1, 0, 0));
+  EXPECT_THAT(argmax(A, colwise), ElementsAre(0, 1, 1));
+
+  // Inside an expression tree.
+  x = max(A, colwise) - min(A, colwise);
+  EXPECT_THAT(x, ElementsAre(5, 7, 3));
+
+  // Of an expression.
+  x = sum(A * A, colwise);
+  EXPECT_THAT(x, ElementsAre(17, 29, 45));
+
+  // Element by element.
+  auto s = sum(A, colwise);
+  EXPECT_THAT(s, ElementsAre(-3, 3, 9));
+
+  matrix<int> B = {{1, 7, 3}, {4, 2, 6}};
+  vector<int> y = min(B, colwise);
+  EXPECT_THAT(y, ElementsAre(1, 2, 3));
+  y = sum(B, colwise);
+  EXPECT_THAT(y, ElementsAre(5, 9, 9));
+}
+
+TEST(reduction, axis_of_a_large_matrix) {
+  const std::size_t m = 37;
+  const std::size_t n = 53;
+  matrix<float> A(m, n);
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      A(i, j) = static_cast<float>((i * 7 + j * 3) % 11) - 5.0f;
+    }
+  }
+
+  vector<float> row_sums = sum(A, rowwise);
+  vector<float> col_sums = sum(A, colwise);
+  vector<float> col_max = max(A, colwise);
+  vector<std::size_t> col_argmin = argmin(A, colwise);
+  for (std::size_t i = 0; i < m; ++i) {
+    float expected = 0;
+    for (std::size_t j = 0; j < n; ++j) expected += A(i, j);
+    EXPECT_THAT(row_sums[i], FloatEq(expected));
+  }
+  for (std::size_t j = 0; j < n; ++j) {
+    float expected_sum = 0;
+    float expected_max = A(0, j);
+    std::size_t expected_argmin = 0;
+    for (std::size_t i = 0; i < m; ++i) {
+      expected_sum += A(i, j);
+      expected_max = std::max(expected_max, A(i, j));
+      if (A(i, j) < A(expected_argmin, j)) expected_argmin = i;
+    }
+    EXPECT_THAT(col_sums[j], FloatEq(expected_sum));
+    EXPECT_THAT(col_max[j], FloatEq(expected_max));
+    EXPECT_EQ(col_argmin[j], expected_argmin);
+  }
+}
+
+TEST(reduction, aliasing) {
+  matrix<double> A = {{1, 2}, {3, 4}};
+  vector<double> x = {1, 2};
+
+  // The first row of A is both read and written.
+  A.row_at(0) = sum(A, colwise).t();
+  EXPECT_THAT(A, ElementsAre(4, 6, 3, 4));
+
+  // A column-wise reduction of a product.
+  x = sum(matmul(A, A), colwise);
+  EXPECT_THAT(x, ElementsAre(4 * 4 + 6 * 3 + 3 * 4 + 4 * 3,
+                             4 * 6 + 6 * 4 + 3 * 6 + 4 * 4));
+}
+
+}  // namespace insight
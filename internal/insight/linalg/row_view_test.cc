@@ -86,4 +86,32 @@ TEST(row_view, of_matrix_plus_matrix) {
   EXPECT_THAT(second_row, ElementsAre(42, 52.5, 63));
 }
 
+TEST(row_view, arithmetic_with_expressions) {
+  matrix<double> A = {{3, 4, 0}, {1, 2, 3}};
+  matrix<double> B = {{1, 1, 1}};
+
+  EXPECT_DOUBLE_EQ(A.row_at(0).nrm2(), 5);
+  EXPECT_DOUBLE_EQ(A.row_at(0).dot(A.row_at(1)), 11);
+  EXPECT_DOUBLE_EQ(A.row_at(1).dot(B), 6);
+
+  A.row_at(0) = A.row_at(1);
+  EXPECT_THAT(A, ElementsAre(1, 2, 3, 1, 2, 3));
+
+  A.row_at(0) += 2.0 * B;
+  EXPECT_THAT(A, ElementsAre(3, 4, 5, 1, 2, 3));
+
+  A.row_at(1) -= A.row_at(0) - B;
+  EXPECT_THAT(A, ElementsAre(3, 4, 5, -1, -1, -1));
+
+  A.row_at(0) *= A.row_at(1);
+  EXPECT_THAT(A, ElementsAre(-3, -4, -5, -1, -1, -1));
+
+  A.row_at(1) /= B * 2.0;
+  EXPECT_THAT(A, ElementsAre(-3, -4, -5, -0.5, -0.5, -0.5));
+
+  matrix<double> C = {{1, 2}, {3, 4}, {5, 6}};
+  A.row_at(1) = C.col_at(1).t();
+  EXPECT_THAT(A, ElementsAre(-3, -4, -5, 2, 4, 6));
+}
+
 }  // namespace insight
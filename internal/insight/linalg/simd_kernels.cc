@@ -0,0 +1,432 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include "insight/linalg/simd_kernels.h"
+
+#include <cmath>
+
+#include "insight/linalg/half.h"
+
+// The per instruction set kernels are only built on x86 with GCC or Clang
+// (see internal/insight/CMakeLists.txt), which is also where
+// __builtin_cpu_supports is available.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define INSIGHT_SIMD_CPU_DETECTION
+#endif
+
+namespace insight {
+namespace linalg_detail {
+namespace simd {
+namespace {
+
+template<typename T>
+void scalar_add(const int N, const T* X, const T* Y, T* Z) {
+  for (int i = 0; i < N; ++i) {
+    Z[i] = X[i] + Y[i];
+  }
+}
+
+template<typename T>
+void scalar_sub(const int N, const T* X, const T* Y, T* Z) {
+  for (int i = 0; i < N; ++i) {
+    Z[i] = X[i] - Y[i];
+  }
+}
+
+template<typename T>
+void scalar_mul(const int N, const T* X, const T* Y, T* Z) {
+  for (int i = 0; i < N; ++i) {
+    Z[i] = X[i] * Y[i];
+  }
+}
+
+template<typename T>
+void scalar_div(const int N, const T* X, const T* Y, T* Z) {
+  for (int i = 0; i < N; ++i) {
+    Z[i] = X[i] / Y[i];
+  }
+}
+
+template<typename T>
+void scalar_sqrt(const int N, const T* X, T* Y) {
+  for (int i = 0; i < N; ++i) {
+    Y[i] = std::sqrt(X[i]);
+  }
+}
+
+template<typename T>
+void scalar_exp(const int N, const T* X, T* Y) {
+  for (int i = 0; i < N; ++i) {
+    Y[i] = std::exp(X[i]);
+  }
+}
+
+template<typename T>
+void scalar_log(const int N, const T* X, T* Y) {
+  for (int i = 0; i < N; ++i) {
+    Y[i] = std::log(X[i]);
+  }
+}
+
+bool is_built_in(isa target) {
+  switch (target) {
+    case SCALAR:
+      return true;
+    case SSE2:
+#ifdef INSIGHT_HAVE_SSE2_KERNELS
+      return true;
+#else
+      return false;
+#endif
+    case AVX2:
+#ifdef INSIGHT_HAVE_AVX2_KERNELS
+      return true;
+#else
+      return false;
+#endif
+    case AVX512:
+#ifdef INSIGHT_HAVE_AVX512_KERNELS
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+bool cpu_supports(isa target) {
+  if (target == SCALAR) {
+    return true;
+  }
+#ifdef INSIGHT_SIMD_CPU_DETECTION
+  __builtin_cpu_init();
+  switch (target) {
+    case SSE2:
+      return __builtin_cpu_supports("sse2");
+    case AVX2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+             __builtin_cpu_supports("f16c");
+    case AVX512:
+      return __builtin_cpu_supports("avx512f");
+    default:
+      return false;
+  }
+#else
+  return false;
+#endif
+}
+
+inline bool is_available(isa target) {
+  return is_built_in(target) && cpu_supports(target);
+}
+
+template<typename T>
+T scalar_sum(const int N, const T* X) {
+  // Independent partial sums, like the vector kernels.
+  T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  int i = 0;
+  for (; i + 4 <= N; i += 4) {
+    s0 += X[i];
+    s1 += X[i + 1];
+    s2 += X[i + 2];
+    s3 += X[i + 3];
+  }
+  for (; i < N; ++i) s0 += X[i];
+  return (s0 + s1) + (s2 + s3);
+}
+
+template<typename T>
+T scalar_min(const int N, const T* X) {
+  T result = X[0];
+  for (int i = 1; i < N; ++i) {
+    if (X[i] < result) result = X[i];
+  }
+  return result;
+}
+
+template<typename T>
+T scalar_max(const int N, const T* X) {
+  T result = X[0];
+  for (int i = 1; i < N; ++i) {
+    if (result < X[i]) result = X[i];
+  }
+  return result;
+}
+
+void scalar_half_to_float(const int N, const uint16_t* X, float* Y) {
+  for (int i = 0; i < N; ++i) {
+    Y[i] = half_to_float(X[i]);
+  }
+}
+
+void scalar_float_to_half(const int N, const float* X, uint16_t* Y) {
+  for (int i = 0; i < N; ++i) {
+    Y[i] = float_to_half(X[i]);
+  }
+}
+
+void scalar_bfloat16_to_float(const int N, const uint16_t* X, float* Y) {
+  for (int i = 0; i < N; ++i) {
+    Y[i] = bfloat16_to_float(X[i]);
+  }
+}
+
+void scalar_float_to_bfloat16(const int N, const float* X, uint16_t* Y) {
+  for (int i = 0; i < N; ++i) {
+    Y[i] = float_to_bfloat16(X[i]);
+  }
+}
+
+// 32-bit integer arithmetic wraps around, as in the vector kernels, rather
+// than overflowing (which is undefined for signed integers).
+
+inline int32_t wrap(uint32_t value) {
+  return static_cast<int32_t>(value);
+}
+
+void scalar_int32_add(const int N, const int32_t* X, const int32_t* Y,
+                      int32_t* Z) {
+  for (int i = 0; i < N; ++i) {
+    Z[i] = wrap(static_cast<uint32_t>(X[i]) + static_cast<uint32_t>(Y[i]));
+  }
+}
+
+void scalar_int32_sub(const int N, const int32_t* X, const int32_t* Y,
+                      int32_t* Z) {
+  for (int i = 0; i < N; ++i) {
+    Z[i] = wrap(static_cast<uint32_t>(X[i]) - static_cast<uint32_t>(Y[i]));
+  }
+}
+
+void scalar_int32_mul(const int N, const int32_t* X, const int32_t* Y,
+                      int32_t* Z) {
+  for (int i = 0; i < N; ++i) {
+    Z[i] = wrap(static_cast<uint32_t>(X[i]) * static_cast<uint32_t>(Y[i]));
+  }
+}
+
+void scalar_int32_scal(const int N, const int32_t alpha, int32_t* X) {
+  for (int i = 0; i < N; ++i) {
+    X[i] = wrap(static_cast<uint32_t>(alpha) * static_cast<uint32_t>(X[i]));
+  }
+}
+
+void scalar_gemm_u8s8s32(const int M, const int N, const int K,
+                         const uint8_t* A, const int lda,
+                         const int8_t* B, const int ldb,
+                         int32_t* C, const int ldc) {
+  for (int i = 0; i < M; ++i) {
+    const uint8_t* a = A + i * lda;
+    for (int j = 0; j < N; ++j) {
+      const int8_t* b = B + j * ldb;
+      int32_t sum = 0;
+      for (int k = 0; k < K; ++k) {
+        sum += static_cast<int32_t>(a[k]) * static_cast<int32_t>(b[k]);
+      }
+      C[i * ldc + j] = sum;
+    }
+  }
+}
+
+}  // namespace
+
+const kernel_table<float> scalar_float_kernels = {
+  &scalar_add<float>,
+  &scalar_sub<float>,
+  &scalar_mul<float>,
+  &scalar_div<float>,
+  &scalar_sqrt<float>,
+  &scalar_exp<float>,
+  &scalar_log<float>,
+  &scalar_sum<float>,
+  &scalar_min<float>,
+  &scalar_max<float>
+};
+
+const kernel_table<double> scalar_double_kernels = {
+  &scalar_add<double>,
+  &scalar_sub<double>,
+  &scalar_mul<double>,
+  &scalar_div<double>,
+  &scalar_sqrt<double>,
+  &scalar_exp<double>,
+  &scalar_log<double>,
+  &scalar_sum<double>,
+  &scalar_min<double>,
+  &scalar_max<double>
+};
+
+const conversion_table scalar_conversions = {
+  &scalar_half_to_float,
+  &scalar_float_to_half,
+  &scalar_bfloat16_to_float,
+  &scalar_float_to_bfloat16
+};
+
+const integer_kernel_table scalar_integer_kernels = {
+  &scalar_int32_add,
+  &scalar_int32_sub,
+  &scalar_int32_mul,
+  &scalar_int32_scal,
+  &scalar_gemm_u8s8s32
+};
+
+const char* isa_name(isa target) {
+  switch (target) {
+    case SCALAR:
+      return "scalar";
+    case SSE2:
+      return "sse2";
+    case AVX2:
+      return "avx2";
+    case AVX512:
+      return "avx512";
+  }
+  return "unknown";
+}
+
+isa best_isa() {
+  static const isa best =
+      is_available(AVX512) ? AVX512 :
+      is_available(AVX2) ? AVX2 :
+      is_available(SSE2) ? SSE2 : SCALAR;
+  return best;
+}
+
+template<>
+const kernel_table<float>* kernels_for<float>(isa target) {
+  if (!is_available(target)) {
+    return nullptr;
+  }
+  switch (target) {
+#ifdef INSIGHT_HAVE_SSE2_KERNELS
+    case SSE2:
+      return &sse2_float_kernels;
+#endif
+#ifdef INSIGHT_HAVE_AVX2_KERNELS
+    case AVX2:
+      return &avx2_float_kernels;
+#endif
+#ifdef INSIGHT_HAVE_AVX512_KERNELS
+    case AVX512:
+      return &avx512_float_kernels;
+#endif
+    default:
+      return &scalar_float_kernels;
+  }
+}
+
+template<>
+const kernel_table<double>* kernels_for<double>(isa target) {
+  if (!is_available(target)) {
+    return nullptr;
+  }
+  switch (target) {
+#ifdef INSIGHT_HAVE_SSE2_KERNELS
+    case SSE2:
+      return &sse2_double_kernels;
+#endif
+#ifdef INSIGHT_HAVE_AVX2_KERNELS
+    case AVX2:
+      return &avx2_double_kernels;
+#endif
+#ifdef INSIGHT_HAVE_AVX512_KERNELS
+    case AVX512:
+      return &avx512_double_kernels;
+#endif
+    default:
+      return &scalar_double_kernels;
+  }
+}
+
+template<>
+const kernel_table<float>& kernels<float>() {
+  static const kernel_table<float>* table = kernels_for<float>(best_isa());
+  return *table;
+}
+
+template<>
+const kernel_table<double>& kernels<double>() {
+  static const kernel_table<double>* table = kernels_for<double>(best_isa());
+  return *table;
+}
+
+const conversion_table* conversions_for(isa target) {
+  if (!is_available(target)) {
+    return nullptr;
+  }
+  switch (target) {
+#ifdef INSIGHT_HAVE_AVX2_KERNELS
+    case AVX2:
+      return &avx2_conversions;
+#endif
+#ifdef INSIGHT_HAVE_AVX512_KERNELS
+    case AVX512:
+      return &avx512_conversions;
+#endif
+    default:
+      return &scalar_conversions;
+  }
+}
+
+const conversion_table& conversions() {
+  static const conversion_table* table = conversions_for(best_isa());
+  return *table;
+}
+
+const integer_kernel_table* integer_kernels_for(isa target) {
+  if (!is_available(target)) {
+    return nullptr;
+  }
+  switch (target) {
+#ifdef INSIGHT_HAVE_SSE2_KERNELS
+    case SSE2:
+      return &sse2_integer_kernels;
+#endif
+#ifdef INSIGHT_HAVE_AVX2_KERNELS
+    case AVX2:
+      return &avx2_integer_kernels;
+#endif
+#ifdef INSIGHT_HAVE_AVX512_KERNELS
+    case AVX512:
+      return &avx512_integer_kernels;
+#endif
+    default:
+      return &scalar_integer_kernels;
+  }
+}
+
+gemm_u8s8s32_kernel vnni_gemm_u8s8s32() {
+#if defined(INSIGHT_HAVE_AVX512_VNNI_KERNELS) && \
+    defined(INSIGHT_SIMD_CPU_DETECTION)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") &&
+      __builtin_cpu_supports("avx512bw") &&
+      __builtin_cpu_supports("avx512vnni")) {
+    return &avx512_vnni_gemm_u8s8s32;
+  }
+#endif
+  return nullptr;
+}
+
+namespace {
+
+integer_kernel_table best_integer_kernels() {
+  integer_kernel_table table = *integer_kernels_for(best_isa());
+  if (gemm_u8s8s32_kernel vnni = vnni_gemm_u8s8s32()) {
+    table.gemm_u8s8s32 = vnni;
+  }
+  return table;
+}
+
+}  // namespace
+
+const integer_kernel_table& integer_kernels() {
+  static const integer_kernel_table table = best_integer_kernels();
+  return table;
+}
+
+}  // namespace simd
+}  // namespace linalg_detail
+}  // namespace insight
@@ -0,0 +1,155 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INTERNAL_INSIGHT_LINALG_SIMD_KERNELS_H_
+#define INTERNAL_INSIGHT_LINALG_SIMD_KERNELS_H_
+
+#include <cstdint>
+
+namespace insight {
+namespace linalg_detail {
+namespace simd {
+
+// Elementwise kernels backing blas_add, blas_sub, blas_mul, blas_div,
+// blas_sqrt, blas_exp and blas_log when Insight is built against a BLAS
+// library without vector math functions (OpenBLAS, ATLAS).
+//
+// On x86, one kernel set per instruction set (SSE2, AVX2 + FMA, AVX-512F)
+// is compiled in its own translation unit with the matching -m flags. The
+// widest set supported by both the build and the running CPU is selected
+// once, on first use; everything else falls back to plain scalar loops.
+//
+// add, sub, mul, div and sqrt are correctly rounded. exp and log use the
+// usual range reduction followed by a polynomial (float, from Cephes) or a
+// rational approximation (double, from fdlibm). Their maximum error,
+// measured against a long double reference on 4M random arguments spanning
+// the whole finite domain, is:
+//
+//            exp        log
+//   float    1.5 ULP    1 ULP
+//   double   1 ULP      1 ULP
+//
+// exp results in the subnormal range are obtained by gradual underflow and
+// are within 1 ULP as well. Special values follow C99: exp(+inf) = +inf,
+// exp(-inf) = 0, log(0) = -inf, log(x < 0) = NaN, log(+inf) = +inf, and
+// NaN propagates.
+//
+// sum, min and max reduce a whole array to a single value, with several
+// independent accumulators; sum therefore does not add the elements in
+// order, and may differ from a sequential sum by a rounding error. min and
+// max require N > 0, and their result is unspecified when X contains NaNs.
+//
+// The conversions between float and the bits of float16 and bfloat16 (see
+// insight/linalg/half.h) back blas_convert. They round to nearest even, and
+// give the same results as the scalar conversions of half.h, NaN payloads
+// included. The AVX2 set uses F16C for float16 (every AVX2 CPU has it);
+// there is no SSE2 set.
+//
+// The integer kernels add, subtract and multiply 32-bit integers, wrapping
+// around on overflow, and back the int32_t forms of blas_add, blas_sub,
+// blas_mul and blas_scal. gemm_u8s8s32 is the core of the quantized matmul
+// (see insight/linalg/quantize.h): it multiplies uint8 by int8 matrices and
+// accumulates, exactly, in int32. Its SSE2, AVX2 and AVX-512F forms widen
+// both operands to 16 (resp. 32) bits and use pmaddwd (resp. pmulld), as
+// pmaddubsw would saturate the sum of two uint8 x int8 products into 16
+// bits; its AVX-512 VNNI form, used whenever the CPU has VNNI, is built on
+// vpdpbusd, which does not.
+
+enum isa {
+  SCALAR = 0,
+  SSE2 = 1,
+  AVX2 = 2,
+  AVX512 = 3
+};
+
+// Human readable name of an instruction set, e.g. "avx2".
+const char* isa_name(isa target);
+
+// The widest instruction set that has kernels built in and is supported by
+// the running CPU.
+isa best_isa();
+
+template<typename T>
+struct kernel_table {
+  void (*add)(const int N, const T* X, const T* Y, T* Z);
+  void (*sub)(const int N, const T* X, const T* Y, T* Z);
+  void (*mul)(const int N, const T* X, const T* Y, T* Z);
+  void (*div)(const int N, const T* X, const T* Y, T* Z);
+  void (*sqrt)(const int N, const T* X, T* Y);
+  void (*exp)(const int N, const T* X, T* Y);
+  void (*log)(const int N, const T* X, T* Y);
+  T (*sum)(const int N, const T* X);
+  T (*min)(const int N, const T* X);
+  T (*max)(const int N, const T* X);
+};
+
+struct conversion_table {
+  void (*half_to_float)(const int N, const uint16_t* X, float* Y);
+  void (*float_to_half)(const int N, const float* X, uint16_t* Y);
+  void (*bfloat16_to_float)(const int N, const uint16_t* X, float* Y);
+  void (*float_to_bfloat16)(const int N, const float* X, uint16_t* Y);
+};
+
+// C <- A * B^T, where A is an M x K matrix of uint8_t, B an N x K matrix of
+// int8_t, C an M x N matrix of int32_t, whose consecutive rows are lda (ldb,
+// ldc) elements apart.
+using gemm_u8s8s32_kernel = void (*)(const int M, const int N, const int K,
+                                     const uint8_t* A, const int lda,
+                                     const int8_t* B, const int ldb,
+                                     int32_t* C, const int ldc);
+
+struct integer_kernel_table {
+  void (*add)(const int N, const int32_t* X, const int32_t* Y, int32_t* Z);
+  void (*sub)(const int N, const int32_t* X, const int32_t* Y, int32_t* Z);
+  void (*mul)(const int N, const int32_t* X, const int32_t* Y, int32_t* Z);
+  void (*scal)(const int N, const int32_t alpha, int32_t* X);
+  gemm_u8s8s32_kernel gemm_u8s8s32;
+};
+
+// Returns the kernels built for the given instruction set, or nullptr if
+// they were not built in or are not supported by the running CPU.
+template<typename T>
+const kernel_table<T>* kernels_for(isa target);
+
+// Returns the kernels for best_isa().
+template<typename T>
+const kernel_table<T>& kernels();
+
+// Same as kernels_for and kernels, for the conversions and the integer
+// kernels.
+const conversion_table* conversions_for(isa target);
+const conversion_table& conversions();
+const integer_kernel_table* integer_kernels_for(isa target);
+const integer_kernel_table& integer_kernels();
+
+// The AVX-512 VNNI gemm_u8s8s32, or nullptr if it was not built in or is
+// not supported by the running CPU. integer_kernels() uses it when it is
+// available.
+gemm_u8s8s32_kernel vnni_gemm_u8s8s32();
+
+// Kernel sets defined by the per instruction set translation units.
+extern const kernel_table<float> scalar_float_kernels;
+extern const kernel_table<double> scalar_double_kernels;
+extern const kernel_table<float> sse2_float_kernels;
+extern const kernel_table<double> sse2_double_kernels;
+extern const kernel_table<float> avx2_float_kernels;
+extern const kernel_table<double> avx2_double_kernels;
+extern const kernel_table<float> avx512_float_kernels;
+extern const kernel_table<double> avx512_double_kernels;
+extern const conversion_table scalar_conversions;
+extern const conversion_table avx2_conversions;
+extern const conversion_table avx512_conversions;
+extern const integer_kernel_table scalar_integer_kernels;
+extern const integer_kernel_table sse2_integer_kernels;
+extern const integer_kernel_table avx2_integer_kernels;
+extern const integer_kernel_table avx512_integer_kernels;
+void avx512_vnni_gemm_u8s8s32(const int M, const int N, const int K,
+                              const uint8_t* A, const int lda,
+                              const int8_t* B, const int ldb,
+                              int32_t* C, const int ldc);
+
+}  // namespace simd
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INTERNAL_INSIGHT_LINALG_SIMD_KERNELS_H_
@@ -0,0 +1,247 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+//
+// AVX2 + FMA kernels, and F16C conversions. Compiled with -mavx2 -mfma
+// -mf16c.
+
+#include <immintrin.h>
+
+#include "insight/linalg/half.h"
+#include "insight/linalg/simd_kernels_impl.h"
+
+namespace insight {
+namespace linalg_detail {
+namespace simd {
+namespace {
+
+struct avx2_float {
+  using value_type = float;
+  using bits_type = uint32_t;
+  using reg = __m256;
+  using mask = __m256;
+  static constexpr int width = 8;
+
+  static inline reg load(const float* p) { return _mm256_loadu_ps(p); }
+  static inline void store(float* p, reg a) { _mm256_storeu_ps(p, a); }
+  static inline reg set1(float a) { return _mm256_set1_ps(a); }
+  static inline reg set1_bits(uint32_t a) {
+    return _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(a)));
+  }
+
+  static inline reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+  static inline reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+  static inline reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+  static inline reg div(reg a, reg b) { return _mm256_div_ps(a, b); }
+  static inline reg sqrt(reg a) { return _mm256_sqrt_ps(a); }
+  static inline reg fmadd(reg a, reg b, reg c) {
+    return _mm256_fmadd_ps(a, b, c);
+  }
+  static inline reg min(reg a, reg b) { return _mm256_min_ps(a, b); }
+  static inline reg max(reg a, reg b) { return _mm256_max_ps(a, b); }
+
+  static inline reg bit_and(reg a, reg b) { return _mm256_and_ps(a, b); }
+  static inline reg bit_or(reg a, reg b) { return _mm256_or_ps(a, b); }
+
+  static inline mask lt(reg a, reg b) {
+    return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+  }
+  static inline mask gt(reg a, reg b) {
+    return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+  }
+  static inline mask eq(reg a, reg b) {
+    return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+  }
+  static inline mask unord(reg a, reg b) {
+    return _mm256_cmp_ps(a, b, _CMP_UNORD_Q);
+  }
+  static inline reg select(mask m, reg a, reg b) {
+    return _mm256_blendv_ps(b, a, m);
+  }
+
+  template<int n> static inline reg shl(reg a) {
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_castps_si256(a), n));
+  }
+  template<int n> static inline reg shr(reg a) {
+    return _mm256_castsi256_ps(_mm256_srli_epi32(_mm256_castps_si256(a), n));
+  }
+};
+
+struct avx2_double {
+  using value_type = double;
+  using bits_type = uint64_t;
+  using reg = __m256d;
+  using mask = __m256d;
+  static constexpr int width = 4;
+
+  static inline reg load(const double* p) { return _mm256_loadu_pd(p); }
+  static inline void store(double* p, reg a) { _mm256_storeu_pd(p, a); }
+  static inline reg set1(double a) { return _mm256_set1_pd(a); }
+  static inline reg set1_bits(uint64_t a) {
+    return _mm256_castsi256_pd(
+        _mm256_set1_epi64x(static_cast<int64_t>(a)));
+  }
+
+  static inline reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+  static inline reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+  static inline reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+  static inline reg div(reg a, reg b) { return _mm256_div_pd(a, b); }
+  static inline reg sqrt(reg a) { return _mm256_sqrt_pd(a); }
+  static inline reg fmadd(reg a, reg b, reg c) {
+    return _mm256_fmadd_pd(a, b, c);
+  }
+  static inline reg min(reg a, reg b) { return _mm256_min_pd(a, b); }
+  static inline reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+
+  static inline reg bit_and(reg a, reg b) { return _mm256_and_pd(a, b); }
+  static inline reg bit_or(reg a, reg b) { return _mm256_or_pd(a, b); }
+
+  static inline mask lt(reg a, reg b) {
+    return _mm256_cmp_pd(a, b, _CMP_LT_OQ);
+  }
+  static inline mask gt(reg a, reg b) {
+    return _mm256_cmp_pd(a, b, _CMP_GT_OQ);
+  }
+  static inline mask eq(reg a, reg b) {
+    return _mm256_cmp_pd(a, b, _CMP_EQ_OQ);
+  }
+  static inline mask unord(reg a, reg b) {
+    return _mm256_cmp_pd(a, b, _CMP_UNORD_Q);
+  }
+  static inline reg select(mask m, reg a, reg b) {
+    return _mm256_blendv_pd(b, a, m);
+  }
+
+  template<int n> static inline reg shl(reg a) {
+    return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(a), n));
+  }
+  template<int n> static inline reg shr(reg a) {
+    return _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_castpd_si256(a), n));
+  }
+};
+
+void avx2_half_to_float(const int N, const uint16_t* X, float* Y) {
+  int i = 0;
+  for (; i + 8 <= N; i += 8) {
+    const __m128i h =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(X + i));
+    _mm256_storeu_ps(Y + i, _mm256_cvtph_ps(h));
+  }
+  for (; i < N; ++i) Y[i] = half_to_float(X[i]);
+}
+
+void avx2_float_to_half(const int N, const float* X, uint16_t* Y) {
+  int i = 0;
+  for (; i + 8 <= N; i += 8) {
+    const __m128i h =
+        _mm256_cvtps_ph(_mm256_loadu_ps(X + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(Y + i), h);
+  }
+  for (; i < N; ++i) Y[i] = float_to_half(X[i]);
+}
+
+void avx2_bfloat16_to_float(const int N, const uint16_t* X, float* Y) {
+  int i = 0;
+  for (; i + 8 <= N; i += 8) {
+    const __m128i h =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(X + i));
+    const __m256i f = _mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16);
+    _mm256_storeu_ps(Y + i, _mm256_castsi256_ps(f));
+  }
+  for (; i < N; ++i) Y[i] = bfloat16_to_float(X[i]);
+}
+
+void avx2_float_to_bfloat16(const int N, const float* X, uint16_t* Y) {
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i bias = _mm256_set1_epi32(0x7fff);
+  const __m256i abs_mask = _mm256_set1_epi32(0x7fffffff);
+  const __m256i infinity = _mm256_set1_epi32(0x7f800000);
+  const __m256i quiet = _mm256_set1_epi32(0x400000);
+
+  int i = 0;
+  for (; i + 8 <= N; i += 8) {
+    const __m256i b = _mm256_castps_si256(_mm256_loadu_ps(X + i));
+
+    // Round to nearest even, as in float_to_bfloat16, except for NaNs
+    // which are made quiet.
+    const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(b, 16), one);
+    const __m256i rounded =
+        _mm256_add_epi32(b, _mm256_add_epi32(bias, lsb));
+    const __m256i is_nan =
+        _mm256_cmpgt_epi32(_mm256_and_si256(b, abs_mask), infinity);
+    __m256i r = _mm256_blendv_epi8(rounded, _mm256_or_si256(b, quiet),
+                                   is_nan);
+    r = _mm256_srli_epi32(r, 16);
+
+    // Narrow the 8 32-bit lanes (all below 2^16) to 16 bits.
+    r = _mm256_permute4x64_epi64(_mm256_packus_epi32(r, r), 0xd8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(Y + i),
+                     _mm256_castsi256_si128(r));
+  }
+  for (; i < N; ++i) Y[i] = float_to_bfloat16(X[i]);
+}
+
+struct avx2_int32 {
+  using value_type = int32_t;
+  using reg = __m256i;
+  static constexpr int width = 8;
+
+  static inline reg load(const int32_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  static inline void store(int32_t* p, reg a) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a);
+  }
+  static inline reg set1(int32_t a) { return _mm256_set1_epi32(a); }
+
+  static inline reg add(reg a, reg b) { return _mm256_add_epi32(a, b); }
+  static inline reg sub(reg a, reg b) { return _mm256_sub_epi32(a, b); }
+  static inline reg mul(reg a, reg b) { return _mm256_mullo_epi32(a, b); }
+};
+
+// uint8 x int8 products of 16 pairs, widened to 16 bits for pmaddwd.
+struct avx2_u8s8_dot {
+  using acc = __m256i;
+  using a_reg = __m256i;
+  static constexpr int step = 16;
+
+  static inline acc zero() { return _mm256_setzero_si256(); }
+  static inline a_reg load_a(const uint8_t* a) {
+    return _mm256_cvtepu8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(a)));
+  }
+  static inline acc madd(acc s, a_reg a, const int8_t* b) {
+    const __m256i y = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+    return _mm256_add_epi32(s, _mm256_madd_epi16(a, y));
+  }
+  static inline int32_t sum(acc s) {
+    __m128i x = _mm_add_epi32(_mm256_castsi256_si128(s),
+                              _mm256_extracti128_si256(s, 1));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(x);
+  }
+};
+
+}  // namespace
+
+const integer_kernel_table avx2_integer_kernels =
+    make_integer_kernel_table<avx2_int32>(
+        &gemm_u8s8s32_kernel_<avx2_u8s8_dot>);
+
+const conversion_table avx2_conversions = {
+  &avx2_half_to_float,
+  &avx2_float_to_half,
+  &avx2_bfloat16_to_float,
+  &avx2_float_to_bfloat16
+};
+
+const kernel_table<float> avx2_float_kernels =
+    make_kernel_table<avx2_float>();
+const kernel_table<double> avx2_double_kernels =
+    make_kernel_table<avx2_double>();
+
+}  // namespace simd
+}  // namespace linalg_detail
+}  // namespace insight
@@ -0,0 +1,259 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+//
+// AVX-512 kernels. Compiled with -mavx512f and only use AVX-512F
+// instructions, so that they run on every AVX-512 capable CPU.
+
+// GCC 12 reports its own _mm512_undefined_*() placeholders, inlined into
+// the conversion intrinsics, as used uninitialized.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#include "insight/linalg/half.h"
+#include "insight/linalg/simd_kernels_impl.h"
+
+namespace insight {
+namespace linalg_detail {
+namespace simd {
+namespace {
+
+struct avx512_float {
+  using value_type = float;
+  using bits_type = uint32_t;
+  using reg = __m512;
+  using mask = __mmask16;
+  static constexpr int width = 16;
+
+  static inline reg load(const float* p) { return _mm512_loadu_ps(p); }
+  static inline void store(float* p, reg a) { _mm512_storeu_ps(p, a); }
+  static inline reg set1(float a) { return _mm512_set1_ps(a); }
+  static inline reg set1_bits(uint32_t a) {
+    return _mm512_castsi512_ps(_mm512_set1_epi32(static_cast<int>(a)));
+  }
+
+  static inline reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+  static inline reg sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+  static inline reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+  static inline reg div(reg a, reg b) { return _mm512_div_ps(a, b); }
+  static inline reg sqrt(reg a) { return _mm512_sqrt_ps(a); }
+  static inline reg fmadd(reg a, reg b, reg c) {
+    return _mm512_fmadd_ps(a, b, c);
+  }
+  static inline reg min(reg a, reg b) { return _mm512_min_ps(a, b); }
+  static inline reg max(reg a, reg b) { return _mm512_max_ps(a, b); }
+
+  // _mm512_and_ps and friends need AVX-512DQ; go through the integer
+  // domain instead.
+  static inline reg bit_and(reg a, reg b) {
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a),
+                                                _mm512_castps_si512(b)));
+  }
+  static inline reg bit_or(reg a, reg b) {
+    return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(a),
+                                               _mm512_castps_si512(b)));
+  }
+
+  static inline mask lt(reg a, reg b) {
+    return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);
+  }
+  static inline mask gt(reg a, reg b) {
+    return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ);
+  }
+  static inline mask eq(reg a, reg b) {
+    return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);
+  }
+  static inline mask unord(reg a, reg b) {
+    return _mm512_cmp_ps_mask(a, b, _CMP_UNORD_Q);
+  }
+  static inline reg select(mask m, reg a, reg b) {
+    return _mm512_mask_blend_ps(m, b, a);
+  }
+
+  template<int n> static inline reg shl(reg a) {
+    return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_castps_si512(a), n));
+  }
+  template<int n> static inline reg shr(reg a) {
+    return _mm512_castsi512_ps(_mm512_srli_epi32(_mm512_castps_si512(a), n));
+  }
+};
+
+struct avx512_double {
+  using value_type = double;
+  using bits_type = uint64_t;
+  using reg = __m512d;
+  using mask = __mmask8;
+  static constexpr int width = 8;
+
+  static inline reg load(const double* p) { return _mm512_loadu_pd(p); }
+  static inline void store(double* p, reg a) { _mm512_storeu_pd(p, a); }
+  static inline reg set1(double a) { return _mm512_set1_pd(a); }
+  static inline reg set1_bits(uint64_t a) {
+    return _mm512_castsi512_pd(
+        _mm512_set1_epi64(static_cast<int64_t>(a)));
+  }
+
+  static inline reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+  static inline reg sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+  static inline reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+  static inline reg div(reg a, reg b) { return _mm512_div_pd(a, b); }
+  static inline reg sqrt(reg a) { return _mm512_sqrt_pd(a); }
+  static inline reg fmadd(reg a, reg b, reg c) {
+    return _mm512_fmadd_pd(a, b, c);
+  }
+  static inline reg min(reg a, reg b) { return _mm512_min_pd(a, b); }
+  static inline reg max(reg a, reg b) { return _mm512_max_pd(a, b); }
+
+  static inline reg bit_and(reg a, reg b) {
+    return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(a),
+                                                _mm512_castpd_si512(b)));
+  }
+  static inline reg bit_or(reg a, reg b) {
+    return _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(a),
+                                               _mm512_castpd_si512(b)));
+  }
+
+  static inline mask lt(reg a, reg b) {
+    return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ);
+  }
+  static inline mask gt(reg a, reg b) {
+    return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ);
+  }
+  static inline mask eq(reg a, reg b) {
+    return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ);
+  }
+  static inline mask unord(reg a, reg b) {
+    return _mm512_cmp_pd_mask(a, b, _CMP_UNORD_Q);
+  }
+  static inline reg select(mask m, reg a, reg b) {
+    return _mm512_mask_blend_pd(m, b, a);
+  }
+
+  template<int n> static inline reg shl(reg a) {
+    return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_castpd_si512(a), n));
+  }
+  template<int n> static inline reg shr(reg a) {
+    return _mm512_castsi512_pd(_mm512_srli_epi64(_mm512_castpd_si512(a), n));
+  }
+};
+
+// The bfloat16 conversions use integer arithmetic rather than the
+// AVX512_BF16 instructions, which only some AVX-512 CPUs have and which
+// flush subnormals to zero.
+
+void avx512_half_to_float(const int N, const uint16_t* X, float* Y) {
+  int i = 0;
+  for (; i + 16 <= N; i += 16) {
+    const __m256i h =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(X + i));
+    _mm512_storeu_ps(Y + i, _mm512_cvtph_ps(h));
+  }
+  for (; i < N; ++i) Y[i] = half_to_float(X[i]);
+}
+
+void avx512_float_to_half(const int N, const float* X, uint16_t* Y) {
+  int i = 0;
+  for (; i + 16 <= N; i += 16) {
+    const __m256i h =
+        _mm512_cvtps_ph(_mm512_loadu_ps(X + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(Y + i), h);
+  }
+  for (; i < N; ++i) Y[i] = float_to_half(X[i]);
+}
+
+void avx512_bfloat16_to_float(const int N, const uint16_t* X, float* Y) {
+  int i = 0;
+  for (; i + 16 <= N; i += 16) {
+    const __m256i h =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(X + i));
+    const __m512i f = _mm512_slli_epi32(_mm512_cvtepu16_epi32(h), 16);
+    _mm512_storeu_ps(Y + i, _mm512_castsi512_ps(f));
+  }
+  for (; i < N; ++i) Y[i] = bfloat16_to_float(X[i]);
+}
+
+void avx512_float_to_bfloat16(const int N, const float* X, uint16_t* Y) {
+  const __m512i one = _mm512_set1_epi32(1);
+  const __m512i bias = _mm512_set1_epi32(0x7fff);
+  const __m512i abs_mask = _mm512_set1_epi32(0x7fffffff);
+  const __m512i infinity = _mm512_set1_epi32(0x7f800000);
+  const __m512i quiet = _mm512_set1_epi32(0x400000);
+
+  int i = 0;
+  for (; i + 16 <= N; i += 16) {
+    const __m512i b = _mm512_castps_si512(_mm512_loadu_ps(X + i));
+    const __m512i lsb = _mm512_and_si512(_mm512_srli_epi32(b, 16), one);
+    const __m512i rounded =
+        _mm512_add_epi32(b, _mm512_add_epi32(bias, lsb));
+    const __mmask16 is_nan =
+        _mm512_cmpgt_epi32_mask(_mm512_and_si512(b, abs_mask), infinity);
+    __m512i r = _mm512_mask_or_epi32(rounded, is_nan, b, quiet);
+    r = _mm512_srli_epi32(r, 16);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(Y + i),
+                        _mm512_cvtepi32_epi16(r));
+  }
+  for (; i < N; ++i) Y[i] = float_to_bfloat16(X[i]);
+}
+
+struct avx512_int32 {
+  using value_type = int32_t;
+  using reg = __m512i;
+  static constexpr int width = 16;
+
+  static inline reg load(const int32_t* p) { return _mm512_loadu_si512(p); }
+  static inline void store(int32_t* p, reg a) { _mm512_storeu_si512(p, a); }
+  static inline reg set1(int32_t a) { return _mm512_set1_epi32(a); }
+
+  static inline reg add(reg a, reg b) { return _mm512_add_epi32(a, b); }
+  static inline reg sub(reg a, reg b) { return _mm512_sub_epi32(a, b); }
+  static inline reg mul(reg a, reg b) { return _mm512_mullo_epi32(a, b); }
+};
+
+// uint8 x int8 products of 16 pairs, widened to 32 bits (AVX-512F has no
+// 16-bit arithmetic).
+struct avx512_u8s8_dot {
+  using acc = __m512i;
+  using a_reg = __m512i;
+  static constexpr int step = 16;
+
+  static inline acc zero() { return _mm512_setzero_si512(); }
+  static inline a_reg load_a(const uint8_t* a) {
+    return _mm512_cvtepu8_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(a)));
+  }
+  static inline acc madd(acc s, a_reg a, const int8_t* b) {
+    const __m512i y = _mm512_cvtepi8_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+    return _mm512_add_epi32(s, _mm512_mullo_epi32(a, y));
+  }
+  static inline int32_t sum(acc s) { return _mm512_reduce_add_epi32(s); }
+};
+
+}  // namespace
+
+const integer_kernel_table avx512_integer_kernels =
+    make_integer_kernel_table<avx512_int32>(
+        &gemm_u8s8s32_kernel_<avx512_u8s8_dot>);
+
+const conversion_table avx512_conversions = {
+  &avx512_half_to_float,
+  &avx512_float_to_half,
+  &avx512_bfloat16_to_float,
+  &avx512_float_to_bfloat16
+};
+
+const kernel_table<float> avx512_float_kernels =
+    make_kernel_table<avx512_float>();
+const kernel_table<double> avx512_double_kernels =
+    make_kernel_table<avx512_double>();
+
+}  // namespace simd
+}  // namespace linalg_detail
+}  // namespace insight
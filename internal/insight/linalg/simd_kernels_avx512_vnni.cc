@@ -0,0 +1,54 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+//
+// AVX-512 VNNI form of gemm_u8s8s32. Compiled with -mavx512f -mavx512bw
+// -mavx512vnni.
+
+// See simd_kernels_avx512.cc.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#include "insight/linalg/simd_kernels_impl.h"
+
+namespace insight {
+namespace linalg_detail {
+namespace simd {
+namespace {
+
+// vpdpbusd adds the four uint8 x int8 products of each 32-bit lane to that
+// lane, without any intermediate saturation.
+struct avx512_vnni_u8s8_dot {
+  using acc = __m512i;
+  using a_reg = __m512i;
+  static constexpr int step = 64;
+
+  static inline acc zero() { return _mm512_setzero_si512(); }
+  static inline a_reg load_a(const uint8_t* a) {
+    return _mm512_loadu_si512(a);
+  }
+  static inline acc madd(acc s, a_reg a, const int8_t* b) {
+    return _mm512_dpbusd_epi32(s, a, _mm512_loadu_si512(b));
+  }
+  static inline int32_t sum(acc s) { return _mm512_reduce_add_epi32(s); }
+};
+
+}  // namespace
+
+void avx512_vnni_gemm_u8s8s32(const int M, const int N, const int K,
+                              const uint8_t* A, const int lda,
+                              const int8_t* B, const int ldb,
+                              int32_t* C, const int ldc) {
+  gemm_u8s8s32_kernel_<avx512_vnni_u8s8_dot>(M, N, K, A, lda, B, ldb, C, ldc);
+}
+
+}  // namespace simd
+}  // namespace linalg_detail
+}  // namespace insight
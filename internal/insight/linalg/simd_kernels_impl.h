@@ -0,0 +1,557 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INTERNAL_INSIGHT_LINALG_SIMD_KERNELS_IMPL_H_
+#define INTERNAL_INSIGHT_LINALG_SIMD_KERNELS_IMPL_H_
+
+#include <cstdint>
+
+#include "insight/linalg/simd_kernels.h"
+
+namespace insight {
+namespace linalg_detail {
+namespace simd {
+
+// Generic elementwise kernels, written once against a "pack" P that wraps
+// one SIMD register type. This header must only be included by the per
+// instruction set translation units, each of which defines its packs in an
+// anonymous namespace: every instantiation below then has internal linkage,
+// so code compiled with e.g. -mavx2 can never be picked by the linker in
+// place of its SSE2 twin.
+//
+// A pack P provides:
+//
+//   value_type, bits_type       float/uint32_t or double/uint64_t.
+//   reg, mask                   register and comparison mask types.
+//   width                       number of lanes.
+//   load, store                 unaligned load/store.
+//   set1, set1_bits             broadcast a value / a bit pattern.
+//   add, sub, mul, div, sqrt    lane-wise arithmetic.
+//   fmadd(a, b, c)              a * b + c (fused when available).
+//   min, max                    lane-wise min/max.
+//   bit_and, bit_or             bitwise and/or.
+//   lt, gt, eq, unord           comparisons, unord(a, b) is true for NaNs.
+//   select(m, a, b)             m ? a : b.
+//   shl<n>, shr<n>              logical shifts of each lane's bits.
+
+// Applies Op to the full packs of X (and Y), then to the tail padded into a
+// temporary pack so that every element goes through the same code path.
+
+template<typename P, typename Op>
+void unary_kernel(const int N, const typename P::value_type* X,
+                  typename P::value_type* Y) {
+  using value_type = typename P::value_type;
+  int i = 0;
+  for (; i + P::width <= N; i += P::width) {
+    P::store(Y + i, Op::apply(P::load(X + i)));
+  }
+  if (i < N) {
+    value_type x[P::width] = {};
+    value_type y[P::width];
+    for (int j = 0; i + j < N; ++j) x[j] = X[i + j];
+    P::store(y, Op::apply(P::load(x)));
+    for (int j = 0; i + j < N; ++j) Y[i + j] = y[j];
+  }
+}
+
+template<typename P, typename Op>
+void binary_kernel(const int N, const typename P::value_type* X,
+                   const typename P::value_type* Y,
+                   typename P::value_type* Z) {
+  using value_type = typename P::value_type;
+  int i = 0;
+  for (; i + P::width <= N; i += P::width) {
+    P::store(Z + i, Op::apply(P::load(X + i), P::load(Y + i)));
+  }
+  if (i < N) {
+    value_type x[P::width] = {};
+    value_type y[P::width] = {};
+    value_type z[P::width];
+    for (int j = 0; i + j < N; ++j) {
+      x[j] = X[i + j];
+      y[j] = Y[i + j];
+    }
+    P::store(z, Op::apply(P::load(x), P::load(y)));
+    for (int j = 0; i + j < N; ++j) Z[i + j] = z[j];
+  }
+}
+
+template<typename P> struct add_op {
+  using reg = typename P::reg;
+  static inline reg apply(reg a, reg b) { return P::add(a, b); }
+};
+
+template<typename P> struct sub_op {
+  using reg = typename P::reg;
+  static inline reg apply(reg a, reg b) { return P::sub(a, b); }
+};
+
+template<typename P> struct mul_op {
+  using reg = typename P::reg;
+  static inline reg apply(reg a, reg b) { return P::mul(a, b); }
+};
+
+template<typename P> struct div_op {
+  using reg = typename P::reg;
+  static inline reg apply(reg a, reg b) { return P::div(a, b); }
+};
+
+template<typename P> struct sqrt_op {
+  using reg = typename P::reg;
+  static inline reg apply(reg a) { return P::sqrt(a); }
+};
+
+// Constants that depend on the floating point format only.
+
+template<typename T> struct ieee_traits;
+
+template<>
+struct ieee_traits<float> {
+  static constexpr int mantissa_bits = 23;
+  static constexpr int exponent_bias = 127;
+  static constexpr uint32_t mantissa_mask = 0x007fffffU;
+  static constexpr uint32_t one_bits = 0x3f800000U;         // 1.0f
+  static constexpr uint32_t two_pow_mantissa = 0x4b000000U; // 2^23
+  static constexpr uint32_t infinity_bits = 0x7f800000U;
+  static constexpr uint32_t nan_bits = 0x7fc00000U;
+  static constexpr float round_magic = 12582912.0f;         // 1.5 * 2^23
+  static constexpr float min_normal = 1.17549435e-38f;
+};
+
+template<>
+struct ieee_traits<double> {
+  static constexpr int mantissa_bits = 52;
+  static constexpr int exponent_bias = 1023;
+  static constexpr uint64_t mantissa_mask = 0x000fffffffffffffULL;
+  static constexpr uint64_t one_bits = 0x3ff0000000000000ULL;
+  static constexpr uint64_t two_pow_mantissa = 0x4330000000000000ULL;
+  static constexpr uint64_t infinity_bits = 0x7ff0000000000000ULL;
+  static constexpr uint64_t nan_bits = 0x7ff8000000000000ULL;
+  static constexpr double round_magic = 6755399441055744.0;  // 1.5 * 2^52
+  static constexpr double min_normal = 2.2250738585072014e-308;
+};
+
+// Rounds x to the nearest integer (ties to even); |x| must be below
+// 2^(mantissa_bits - 1).
+template<typename P>
+inline typename P::reg round_to_int(typename P::reg x) {
+  using traits = ieee_traits<typename P::value_type>;
+  const typename P::reg magic = P::set1(traits::round_magic);
+  return P::sub(P::add(x, magic), magic);
+}
+
+// 2^n for an integral valued n such that n + exponent_bias is in
+// [1, 2 * exponent_bias].
+template<typename P>
+inline typename P::reg pow2n(typename P::reg n) {
+  using value_type = typename P::value_type;
+  using traits = ieee_traits<value_type>;
+  // The low mantissa bits of n + bias + 1.5 * 2^mantissa_bits hold n + bias;
+  // shifting them into the exponent field drops the magic bits.
+  const typename P::reg biased =
+      P::add(n, P::set1(value_type(traits::exponent_bias) +
+                        traits::round_magic));
+  return P::template shl<traits::mantissa_bits>(biased);
+}
+
+// Multiplies x by 2^n in two steps so that n may span the whole exponent
+// range, subnormal results included.
+template<typename P>
+inline typename P::reg scale_by_pow2(typename P::reg x, typename P::reg n) {
+  using value_type = typename P::value_type;
+  const typename P::reg n1 =
+      round_to_int<P>(P::mul(n, P::set1(value_type(0.5))));
+  const typename P::reg n2 = P::sub(n, n1);
+  return P::mul(P::mul(x, pow2n<P>(n1)), pow2n<P>(n2));
+}
+
+// Splits a positive, normal x into x = m * 2^e where m is in [1, 2). e is
+// returned as a floating point value.
+template<typename P>
+inline void split_exponent(typename P::reg x, typename P::reg* m,
+                           typename P::reg* e) {
+  using value_type = typename P::value_type;
+  using traits = ieee_traits<value_type>;
+  const typename P::reg two_pow_mantissa =
+      P::set1_bits(traits::two_pow_mantissa);
+  // The biased exponent, as an integer in the low bits of a lane, is turned
+  // into a floating point value by OR-ing it into the mantissa of
+  // 2^mantissa_bits and subtracting 2^mantissa_bits back.
+  const typename P::reg biased_exponent =
+      P::template shr<traits::mantissa_bits>(x);
+  *e = P::sub(P::sub(P::bit_or(biased_exponent, two_pow_mantissa),
+                     two_pow_mantissa),
+              P::set1(value_type(traits::exponent_bias)));
+  *m = P::bit_or(P::bit_and(x, P::set1_bits(traits::mantissa_mask)),
+                 P::set1_bits(traits::one_bits));
+}
+
+template<typename P, typename T = typename P::value_type> struct exp_op;
+template<typename P, typename T = typename P::value_type> struct log_op;
+
+// expf: Cephes. x = n * ln2 + r with |r| <= ln2 / 2 and
+// exp(r) ~ 1 + r + r^2 * p(r), p being a degree 5 minimax polynomial.
+template<typename P>
+struct exp_op<P, float> {
+  using reg = typename P::reg;
+
+  static inline reg apply(reg x) {
+    const reg max_x = P::set1(88.72283905206835f);   // log(FLT_MAX)
+    const reg min_x = P::set1(-103.97207708f);       // log(denorm_min)
+    const reg xc = P::min(P::max(x, min_x), max_x);
+
+    const reg log2e = P::set1(1.44269504088896341f);
+    const reg n = round_to_int<P>(P::mul(xc, log2e));
+    reg r = P::fmadd(n, P::set1(-0.693359375f), xc);
+    r = P::fmadd(n, P::set1(2.12194440e-4f), r);
+
+    reg y = P::set1(1.9875691500e-4f);
+    y = P::fmadd(y, r, P::set1(1.3981999507e-3f));
+    y = P::fmadd(y, r, P::set1(8.3334519073e-3f));
+    y = P::fmadd(y, r, P::set1(4.1665795894e-2f));
+    y = P::fmadd(y, r, P::set1(1.6666665459e-1f));
+    y = P::fmadd(y, r, P::set1(5.0000001201e-1f));
+    y = P::fmadd(y, P::mul(r, r), r);
+    y = P::add(y, P::set1(1.0f));
+    y = scale_by_pow2<P>(y, n);
+
+    y = P::select(P::gt(x, max_x),
+                  P::set1_bits(ieee_traits<float>::infinity_bits), y);
+    y = P::select(P::lt(x, min_x), P::set1(0.0f), y);
+    return P::select(P::unord(x, x), x, y);
+  }
+};
+
+// exp: fdlibm. x = n * ln2 + r with |r| <= ln2 / 2, ln2 being split in two
+// so that r = hi - lo is exact, and with c = r - r^2 * p(r^2),
+// exp(r) = 1 - ((lo - r * c / (2 - c)) - hi).
+template<typename P>
+struct exp_op<P, double> {
+  using reg = typename P::reg;
+
+  static inline reg apply(reg x) {
+    const reg max_x = P::set1(709.782712893383973096);    // log(DBL_MAX)
+    const reg min_x = P::set1(-745.1332191019412076235);  // log(denorm_min)
+    const reg xc = P::min(P::max(x, min_x), max_x);
+
+    const reg log2e = P::set1(1.4426950408889634073599);
+    const reg n = round_to_int<P>(P::mul(xc, log2e));
+    const reg hi = P::fmadd(n, P::set1(-6.93147180369123816490e-01), xc);
+    const reg lo = P::mul(n, P::set1(1.90821492927058770002e-10));
+    const reg r = P::sub(hi, lo);
+
+    const reg t = P::mul(r, r);
+    reg c = P::set1(4.13813679705723846039e-08);
+    c = P::fmadd(c, t, P::set1(-1.65339022054652515390e-06));
+    c = P::fmadd(c, t, P::set1(6.61375632143793436117e-05));
+    c = P::fmadd(c, t, P::set1(-2.77777777770155933842e-03));
+    c = P::fmadd(c, t, P::set1(1.66666666666666019037e-01));
+    c = P::sub(r, P::mul(t, c));
+
+    const reg rc = P::div(P::mul(r, c), P::sub(P::set1(2.0), c));
+    reg y = P::sub(P::set1(1.0), P::sub(P::sub(lo, rc), hi));
+    y = scale_by_pow2<P>(y, n);
+
+    y = P::select(P::gt(x, max_x),
+                  P::set1_bits(ieee_traits<double>::infinity_bits), y);
+    y = P::select(P::lt(x, min_x), P::set1(0.0), y);
+    return P::select(P::unord(x, x), x, y);
+  }
+};
+
+// Shared by logf and log: scales subnormals up, splits x = m * 2^e with m in
+// [sqrt(1/2), sqrt(2)) and hands f = m - 1 and e to Kernel, then patches
+// the special values.
+template<typename P, typename Kernel>
+inline typename P::reg log_apply(typename P::reg x) {
+  using reg = typename P::reg;
+  using value_type = typename P::value_type;
+  using traits = ieee_traits<value_type>;
+
+  // Scale subnormals by 2^mantissa_bits.
+  const value_type scale = value_type(uint64_t(1) << traits::mantissa_bits);
+  const typename P::mask is_subnormal =
+      P::lt(x, P::set1(traits::min_normal));
+  const reg xs = P::select(is_subnormal, P::mul(x, P::set1(scale)), x);
+
+  reg m, e;
+  split_exponent<P>(xs, &m, &e);
+  e = P::select(is_subnormal,
+                P::sub(e, P::set1(value_type(traits::mantissa_bits))), e);
+
+  const typename P::mask is_large =
+      P::gt(m, P::set1(value_type(1.41421356237309504880)));
+  m = P::select(is_large, P::mul(m, P::set1(value_type(0.5))), m);
+  e = P::select(is_large, P::add(e, P::set1(value_type(1.0))), e);
+
+  reg y = Kernel::apply(P::sub(m, P::set1(value_type(1.0))), e);
+
+  const reg zero = P::set1(value_type(0.0));
+  const reg inf = P::set1_bits(traits::infinity_bits);
+  y = P::select(P::eq(x, inf), inf, y);
+  y = P::select(P::eq(x, zero), P::sub(zero, inf), y);
+  y = P::select(P::lt(x, zero), P::set1_bits(traits::nan_bits), y);
+  return P::select(P::unord(x, x), x, y);
+}
+
+// logf: Cephes. log(1 + f) ~ f - f^2 / 2 + f^3 * p(f), p being a degree 8
+// polynomial, with ln2 split in two for the e * ln2 term.
+template<typename P>
+struct logf_kernel {
+  using reg = typename P::reg;
+
+  static inline reg apply(reg f, reg e) {
+    const reg ff = P::mul(f, f);
+    reg y = P::set1(7.0376836292e-2f);
+    y = P::fmadd(y, f, P::set1(-1.1514610310e-1f));
+    y = P::fmadd(y, f, P::set1(1.1676998740e-1f));
+    y = P::fmadd(y, f, P::set1(-1.2420140846e-1f));
+    y = P::fmadd(y, f, P::set1(1.4249322787e-1f));
+    y = P::fmadd(y, f, P::set1(-1.6668057665e-1f));
+    y = P::fmadd(y, f, P::set1(2.0000714765e-1f));
+    y = P::fmadd(y, f, P::set1(-2.4999993993e-1f));
+    y = P::fmadd(y, f, P::set1(3.3333331174e-1f));
+    y = P::mul(P::mul(y, f), ff);
+    y = P::fmadd(e, P::set1(-2.12194440e-4f), y);
+    y = P::fmadd(ff, P::set1(-0.5f), y);
+    y = P::add(f, y);
+    return P::fmadd(e, P::set1(0.693359375f), y);
+  }
+};
+
+// log: fdlibm. With s = f / (2 + f), log(1 + f) = 2s + s * R(s^2) where R
+// is a degree 7 minimax polynomial, again with ln2 split in two.
+template<typename P>
+struct log_kernel {
+  using reg = typename P::reg;
+
+  static inline reg apply(reg f, reg e) {
+    const reg ln2_hi = P::set1(6.93147180369123816490e-01);
+    const reg ln2_lo = P::set1(1.90821492927058770002e-10);
+
+    const reg s = P::div(f, P::add(P::set1(2.0), f));
+    const reg z = P::mul(s, s);
+    const reg w = P::mul(z, z);
+
+    reg t1 = P::set1(1.531383769920937332e-01);
+    t1 = P::fmadd(t1, w, P::set1(2.222219843214978396e-01));
+    t1 = P::fmadd(t1, w, P::set1(3.999999999940941908e-01));
+    t1 = P::mul(t1, w);
+
+    reg t2 = P::set1(1.479819860511658591e-01);
+    t2 = P::fmadd(t2, w, P::set1(1.818357216161805012e-01));
+    t2 = P::fmadd(t2, w, P::set1(2.857142874366239149e-01));
+    t2 = P::fmadd(t2, w, P::set1(6.666666666666735130e-01));
+    t2 = P::mul(t2, z);
+
+    const reg R = P::add(t1, t2);
+    const reg hfsq = P::mul(P::mul(P::set1(0.5), f), f);
+
+    // e * ln2_hi - ((hfsq - (s * (hfsq + R) + e * ln2_lo)) - f)
+    const reg u = P::fmadd(e, ln2_lo, P::mul(s, P::add(hfsq, R)));
+    return P::sub(P::mul(e, ln2_hi), P::sub(P::sub(hfsq, u), f));
+  }
+};
+
+template<typename P>
+struct log_op<P, float> {
+  static inline typename P::reg apply(typename P::reg x) {
+    return log_apply<P, logf_kernel<P> >(x);
+  }
+};
+
+template<typename P>
+struct log_op<P, double> {
+  static inline typename P::reg apply(typename P::reg x) {
+    return log_apply<P, log_kernel<P> >(x);
+  }
+};
+
+// Reductions. Four independent accumulators hide the latency of the lane
+// wise operation; they are combined, then reduced across lanes at the end,
+// and the tail is folded in one element at a time.
+
+template<typename P> struct sum_reduce_op {
+  using value_type = typename P::value_type;
+  using reg = typename P::reg;
+  static inline value_type identity(const value_type*) { return 0; }
+  static inline reg apply(reg a, reg b) { return P::add(a, b); }
+  static inline value_type apply(value_type a, value_type b) { return a + b; }
+};
+
+template<typename P> struct min_reduce_op {
+  using value_type = typename P::value_type;
+  using reg = typename P::reg;
+  static inline value_type identity(const value_type* X) { return X[0]; }
+  static inline reg apply(reg a, reg b) { return P::min(a, b); }
+  static inline value_type apply(value_type a, value_type b) {
+    return b < a ? b : a;
+  }
+};
+
+template<typename P> struct max_reduce_op {
+  using value_type = typename P::value_type;
+  using reg = typename P::reg;
+  static inline value_type identity(const value_type* X) { return X[0]; }
+  static inline reg apply(reg a, reg b) { return P::max(a, b); }
+  static inline value_type apply(value_type a, value_type b) {
+    return a < b ? b : a;
+  }
+};
+
+template<typename P, typename Op>
+typename P::value_type reduce_kernel(const int N,
+                                     const typename P::value_type* X) {
+  using value_type = typename P::value_type;
+  using reg = typename P::reg;
+  reg acc0 = P::set1(Op::identity(X));
+  reg acc1 = acc0;
+  reg acc2 = acc0;
+  reg acc3 = acc0;
+  int i = 0;
+  for (; i + 4 * P::width <= N; i += 4 * P::width) {
+    acc0 = Op::apply(acc0, P::load(X + i));
+    acc1 = Op::apply(acc1, P::load(X + i + P::width));
+    acc2 = Op::apply(acc2, P::load(X + i + 2 * P::width));
+    acc3 = Op::apply(acc3, P::load(X + i + 3 * P::width));
+  }
+  for (; i + P::width <= N; i += P::width) {
+    acc0 = Op::apply(acc0, P::load(X + i));
+  }
+  acc0 = Op::apply(Op::apply(acc0, acc1), Op::apply(acc2, acc3));
+
+  value_type lanes[P::width];
+  P::store(lanes, acc0);
+  value_type result = lanes[0];
+  for (int j = 1; j < P::width; ++j) result = Op::apply(result, lanes[j]);
+  for (; i < N; ++i) result = Op::apply(result, X[i]);
+  return result;
+}
+
+template<typename P>
+constexpr kernel_table<typename P::value_type> make_kernel_table() {
+  return {
+    &binary_kernel<P, add_op<P> >,
+    &binary_kernel<P, sub_op<P> >,
+    &binary_kernel<P, mul_op<P> >,
+    &binary_kernel<P, div_op<P> >,
+    &unary_kernel<P, sqrt_op<P> >,
+    &unary_kernel<P, exp_op<P> >,
+    &unary_kernel<P, log_op<P> >,
+    &reduce_kernel<P, sum_reduce_op<P> >,
+    &reduce_kernel<P, min_reduce_op<P> >,
+    &reduce_kernel<P, max_reduce_op<P> >
+  };
+}
+
+// Integer kernels.
+//
+// add, sub and mul reuse binary_kernel with a pack I of 32-bit integer
+// lanes, which only provides value_type (int32_t), reg, width, load, store,
+// set1, and the wrapping add, sub and mul.
+
+template<typename I>
+void scal_kernel(const int N, const typename I::value_type alpha,
+                 typename I::value_type* X) {
+  using value_type = typename I::value_type;
+  const typename I::reg a = I::set1(alpha);
+  int i = 0;
+  for (; i + I::width <= N; i += I::width) {
+    I::store(X + i, I::mul(a, I::load(X + i)));
+  }
+  if (i < N) {
+    value_type x[I::width] = {};
+    for (int j = 0; i + j < N; ++j) x[j] = X[i + j];
+    I::store(x, I::mul(a, I::load(x)));
+    for (int j = 0; i + j < N; ++j) X[i + j] = x[j];
+  }
+}
+
+template<typename I>
+constexpr integer_kernel_table make_integer_kernel_table(
+    gemm_u8s8s32_kernel gemm_u8s8s32) {
+  return {
+    &binary_kernel<I, add_op<I> >,
+    &binary_kernel<I, sub_op<I> >,
+    &binary_kernel<I, mul_op<I> >,
+    &scal_kernel<I>,
+    gemm_u8s8s32
+  };
+}
+
+// gemm_u8s8s32 (see simd_kernels.h), written against a "dot" pack D, which
+// accumulates the products of step consecutive uint8 x int8 pairs into the
+// int32 lanes of an accumulator:
+//
+//   acc, a_reg                  accumulator and (widened) A operand types.
+//   step                        number of pairs consumed by madd.
+//   zero()                      a zero accumulator.
+//   load_a(a)                   loads step elements of A.
+//   madd(acc, a, b)             acc + the products of a and step elements
+//                               of B.
+//   sum(acc)                    the sum of the lanes of acc.
+//
+// Every row of A is multiplied by four rows of B at a time, so that each
+// load of A is used four times.
+
+template<typename D>
+void gemm_u8s8s32_kernel_(const int M, const int N, const int K,
+                          const uint8_t* A, const int lda,
+                          const int8_t* B, const int ldb,
+                          int32_t* C, const int ldc) {
+  using acc = typename D::acc;
+  using a_reg = typename D::a_reg;
+  const int K_main = K - K % D::step;
+
+  for (int i = 0; i < M; ++i) {
+    const uint8_t* a = A + i * lda;
+    int32_t* c = C + i * ldc;
+
+    // The last K % step products.
+    auto tail = [=](const int8_t* b) {
+      int32_t sum = 0;
+      for (int k = K_main; k < K; ++k) {
+        sum += static_cast<int32_t>(a[k]) * static_cast<int32_t>(b[k]);
+      }
+      return sum;
+    };
+
+    int j = 0;
+    for (; j + 4 <= N; j += 4) {
+      const int8_t* b0 = B + j * ldb;
+      const int8_t* b1 = b0 + ldb;
+      const int8_t* b2 = b1 + ldb;
+      const int8_t* b3 = b2 + ldb;
+      acc s0 = D::zero();
+      acc s1 = s0;
+      acc s2 = s0;
+      acc s3 = s0;
+      for (int k = 0; k < K_main; k += D::step) {
+        const a_reg ak = D::load_a(a + k);
+        s0 = D::madd(s0, ak, b0 + k);
+        s1 = D::madd(s1, ak, b1 + k);
+        s2 = D::madd(s2, ak, b2 + k);
+        s3 = D::madd(s3, ak, b3 + k);
+      }
+      c[j] = D::sum(s0) + tail(b0);
+      c[j + 1] = D::sum(s1) + tail(b1);
+      c[j + 2] = D::sum(s2) + tail(b2);
+      c[j + 3] = D::sum(s3) + tail(b3);
+    }
+
+    for (; j < N; ++j) {
+      const int8_t* b = B + j * ldb;
+      acc s = D::zero();
+      for (int k = 0; k < K_main; k += D::step) {
+        s = D::madd(s, D::load_a(a + k), b + k);
+      }
+      c[j] = D::sum(s) + tail(b);
+    }
+  }
+}
+
+}  // namespace simd
+}  // namespace linalg_detail
+}  // namespace insight
+#endif  // INTERNAL_INSIGHT_LINALG_SIMD_KERNELS_IMPL_H_
@@ -0,0 +1,167 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+//
+// SSE2 kernels. Compiled with -msse2.
+
+#include <emmintrin.h>
+
+#include "insight/linalg/simd_kernels_impl.h"
+
+namespace insight {
+namespace linalg_detail {
+namespace simd {
+namespace {
+
+struct sse2_float {
+  using value_type = float;
+  using bits_type = uint32_t;
+  using reg = __m128;
+  using mask = __m128;
+  static constexpr int width = 4;
+
+  static inline reg load(const float* p) { return _mm_loadu_ps(p); }
+  static inline void store(float* p, reg a) { _mm_storeu_ps(p, a); }
+  static inline reg set1(float a) { return _mm_set1_ps(a); }
+  static inline reg set1_bits(uint32_t a) {
+    return _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(a)));
+  }
+
+  static inline reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+  static inline reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+  static inline reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+  static inline reg div(reg a, reg b) { return _mm_div_ps(a, b); }
+  static inline reg sqrt(reg a) { return _mm_sqrt_ps(a); }
+  static inline reg fmadd(reg a, reg b, reg c) {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+  }
+  static inline reg min(reg a, reg b) { return _mm_min_ps(a, b); }
+  static inline reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+
+  static inline reg bit_and(reg a, reg b) { return _mm_and_ps(a, b); }
+  static inline reg bit_or(reg a, reg b) { return _mm_or_ps(a, b); }
+
+  static inline mask lt(reg a, reg b) { return _mm_cmplt_ps(a, b); }
+  static inline mask gt(reg a, reg b) { return _mm_cmpgt_ps(a, b); }
+  static inline mask eq(reg a, reg b) { return _mm_cmpeq_ps(a, b); }
+  static inline mask unord(reg a, reg b) { return _mm_cmpunord_ps(a, b); }
+  static inline reg select(mask m, reg a, reg b) {
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+  }
+
+  template<int n> static inline reg shl(reg a) {
+    return _mm_castsi128_ps(_mm_slli_epi32(_mm_castps_si128(a), n));
+  }
+  template<int n> static inline reg shr(reg a) {
+    return _mm_castsi128_ps(_mm_srli_epi32(_mm_castps_si128(a), n));
+  }
+};
+
+struct sse2_double {
+  using value_type = double;
+  using bits_type = uint64_t;
+  using reg = __m128d;
+  using mask = __m128d;
+  static constexpr int width = 2;
+
+  static inline reg load(const double* p) { return _mm_loadu_pd(p); }
+  static inline void store(double* p, reg a) { _mm_storeu_pd(p, a); }
+  static inline reg set1(double a) { return _mm_set1_pd(a); }
+  static inline reg set1_bits(uint64_t a) {
+    return _mm_castsi128_pd(_mm_set1_epi64x(static_cast<int64_t>(a)));
+  }
+
+  static inline reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+  static inline reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+  static inline reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+  static inline reg div(reg a, reg b) { return _mm_div_pd(a, b); }
+  static inline reg sqrt(reg a) { return _mm_sqrt_pd(a); }
+  static inline reg fmadd(reg a, reg b, reg c) {
+    return _mm_add_pd(_mm_mul_pd(a, b), c);
+  }
+  static inline reg min(reg a, reg b) { return _mm_min_pd(a, b); }
+  static inline reg max(reg a, reg b) { return _mm_max_pd(a, b); }
+
+  static inline reg bit_and(reg a, reg b) { return _mm_and_pd(a, b); }
+  static inline reg bit_or(reg a, reg b) { return _mm_or_pd(a, b); }
+
+  static inline mask lt(reg a, reg b) { return _mm_cmplt_pd(a, b); }
+  static inline mask gt(reg a, reg b) { return _mm_cmpgt_pd(a, b); }
+  static inline mask eq(reg a, reg b) { return _mm_cmpeq_pd(a, b); }
+  static inline mask unord(reg a, reg b) { return _mm_cmpunord_pd(a, b); }
+  static inline reg select(mask m, reg a, reg b) {
+    return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+  }
+
+  template<int n> static inline reg shl(reg a) {
+    return _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(a), n));
+  }
+  template<int n> static inline reg shr(reg a) {
+    return _mm_castsi128_pd(_mm_srli_epi64(_mm_castpd_si128(a), n));
+  }
+};
+
+struct sse2_int32 {
+  using value_type = int32_t;
+  using reg = __m128i;
+  static constexpr int width = 4;
+
+  static inline reg load(const int32_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+  static inline void store(int32_t* p, reg a) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a);
+  }
+  static inline reg set1(int32_t a) { return _mm_set1_epi32(a); }
+
+  static inline reg add(reg a, reg b) { return _mm_add_epi32(a, b); }
+  static inline reg sub(reg a, reg b) { return _mm_sub_epi32(a, b); }
+
+  // SSE2 has no pmulld: multiply the even and the odd lanes separately
+  // (the low 32 bits of the products do not depend on the signs).
+  static inline reg mul(reg a, reg b) {
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4),
+                                      _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+  }
+};
+
+// uint8 x int8 products of 8 pairs, widened to 16 bits for pmaddwd.
+struct sse2_u8s8_dot {
+  using acc = __m128i;
+  using a_reg = __m128i;
+  static constexpr int step = 8;
+
+  static inline acc zero() { return _mm_setzero_si128(); }
+  static inline a_reg load_a(const uint8_t* a) {
+    const __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(a));
+    return _mm_unpacklo_epi8(x, _mm_setzero_si128());
+  }
+  static inline acc madd(acc s, a_reg a, const int8_t* b) {
+    __m128i y = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(b));
+    y = _mm_srai_epi16(_mm_unpacklo_epi8(y, y), 8);
+    return _mm_add_epi32(s, _mm_madd_epi16(a, y));
+  }
+  static inline int32_t sum(acc s) {
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+  }
+};
+
+}  // namespace
+
+const integer_kernel_table sse2_integer_kernels =
+    make_integer_kernel_table<sse2_int32>(
+        &gemm_u8s8s32_kernel_<sse2_u8s8_dot>);
+
+const kernel_table<float> sse2_float_kernels =
+    make_kernel_table<sse2_float>();
+const kernel_table<double> sse2_double_kernels =
+    make_kernel_table<sse2_double>();
+
+}  // namespace simd
+}  // namespace linalg_detail
+}  // namespace insight
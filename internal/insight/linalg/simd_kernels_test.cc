@@ -0,0 +1,451 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include "insight/linalg/simd_kernels.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+namespace linalg_detail {
+namespace simd {
+
+using ::testing::ElementsAreArray;
+
+namespace {
+
+const isa all_isas[] = {SCALAR, SSE2, AVX2, AVX512};
+
+// Error of y, in units in the last place of the correctly rounded result.
+template<typename T>
+double ulp_error(T y, long double reference) {
+  const T rounded = static_cast<T>(reference);
+  if (std::isinf(rounded) || std::isinf(y)) {
+    return y == rounded ? 0.0 : std::numeric_limits<double>::infinity();
+  }
+  const T a = std::fabs(rounded);
+  const T ulp = (a == T(0)) ? std::numeric_limits<T>::denorm_min() :
+      std::nextafter(a, std::numeric_limits<T>::infinity()) - a;
+  return static_cast<double>(std::fabs(static_cast<long double>(y) -
+                                       reference) / ulp);
+}
+
+// Lengths that exercise both the full packs and every possible tail.
+const int lengths[] = {0, 1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 33, 64, 101};
+
+template<typename T>
+void check_arithmetic(const kernel_table<T>& k) {
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<T> dist(T(-100), T(100));
+
+  for (int N : lengths) {
+    std::vector<T> X(N), Y(N), Z(N), expected(N);
+    for (int i = 0; i < N; ++i) {
+      X[i] = dist(gen);
+      Y[i] = dist(gen);
+    }
+
+    k.add(N, X.data(), Y.data(), Z.data());
+    for (int i = 0; i < N; ++i) expected[i] = X[i] + Y[i];
+    EXPECT_THAT(Z, ElementsAreArray(expected)) << "add, N = " << N;
+
+    k.sub(N, X.data(), Y.data(), Z.data());
+    for (int i = 0; i < N; ++i) expected[i] = X[i] - Y[i];
+    EXPECT_THAT(Z, ElementsAreArray(expected)) << "sub, N = " << N;
+
+    k.mul(N, X.data(), Y.data(), Z.data());
+    for (int i = 0; i < N; ++i) expected[i] = X[i] * Y[i];
+    EXPECT_THAT(Z, ElementsAreArray(expected)) << "mul, N = " << N;
+
+    k.div(N, X.data(), Y.data(), Z.data());
+    for (int i = 0; i < N; ++i) expected[i] = X[i] / Y[i];
+    EXPECT_THAT(Z, ElementsAreArray(expected)) << "div, N = " << N;
+
+    for (int i = 0; i < N; ++i) X[i] = std::fabs(X[i]);
+    k.sqrt(N, X.data(), Z.data());
+    for (int i = 0; i < N; ++i) expected[i] = std::sqrt(X[i]);
+    EXPECT_THAT(Z, ElementsAreArray(expected)) << "sqrt, N = " << N;
+  }
+}
+
+template<typename T>
+void check_reductions(const kernel_table<T>& k) {
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<T> dist(T(-100), T(100));
+
+  for (int N : lengths) {
+    std::vector<T> X(N);
+    long double sum = 0;
+    for (int i = 0; i < N; ++i) {
+      X[i] = dist(gen);
+      sum += X[i];
+    }
+    EXPECT_NEAR(k.sum(N, X.data()), static_cast<T>(sum), T(1e-3))
+        << "sum, N = " << N;
+    if (N == 0) continue;
+    EXPECT_EQ(k.min(N, X.data()), *std::min_element(X.begin(), X.end()))
+        << "min, N = " << N;
+    EXPECT_EQ(k.max(N, X.data()), *std::max_element(X.begin(), X.end()))
+        << "max, N = " << N;
+  }
+}
+
+template<typename T>
+void check_exp(const kernel_table<T>& k, T min_x, T max_x,
+               double max_ulp) {
+  const int N = 100003;
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<double> dist(min_x, max_x);
+  std::vector<T> X(N), Y(N);
+  for (int i = 0; i < N; ++i) X[i] = static_cast<T>(dist(gen));
+
+  k.exp(N, X.data(), Y.data());
+
+  double worst = 0.0;
+  for (int i = 0; i < N; ++i) {
+    const long double reference = std::exp(static_cast<long double>(X[i]));
+    worst = std::max(worst, ulp_error(Y[i], reference));
+  }
+  EXPECT_LE(worst, max_ulp);
+
+  const T inf = std::numeric_limits<T>::infinity();
+  const T specials[] = {T(0), -T(0), T(1), inf, -inf, max_x * 2, min_x * 2};
+  const int n = sizeof(specials) / sizeof(specials[0]);
+  T results[n];
+  k.exp(n, specials, results);
+  EXPECT_EQ(results[0], T(1));
+  EXPECT_EQ(results[1], T(1));
+  EXPECT_LE(ulp_error(results[2], std::exp(1.0L)), max_ulp);
+  EXPECT_EQ(results[3], inf);
+  EXPECT_EQ(results[4], T(0));
+  EXPECT_EQ(results[5], inf);
+  EXPECT_EQ(results[6], T(0));
+
+  const T nan = std::numeric_limits<T>::quiet_NaN();
+  T nan_result;
+  k.exp(1, &nan, &nan_result);
+  EXPECT_TRUE(std::isnan(nan_result));
+}
+
+template<typename T, typename Bits>
+void check_log(const kernel_table<T>& k, double max_ulp) {
+  // Random bit patterns of positive finite numbers, subnormals included.
+  const int N = 100003;
+  std::mt19937_64 gen(13);
+  std::vector<T> X(N), Y(N);
+  for (int i = 0; i < N; ++i) {
+    do {
+      Bits bits = static_cast<Bits>(gen() >> (65 - 8 * sizeof(Bits)));
+      std::memcpy(&X[i], &bits, sizeof(T));
+    } while (!std::isfinite(X[i]) || X[i] <= T(0));
+  }
+
+  k.log(N, X.data(), Y.data());
+
+  double worst = 0.0;
+  for (int i = 0; i < N; ++i) {
+    const long double reference = std::log(static_cast<long double>(X[i]));
+    worst = std::max(worst, ulp_error(Y[i], reference));
+  }
+  EXPECT_LE(worst, max_ulp);
+
+  const T inf = std::numeric_limits<T>::infinity();
+  const T specials[] = {T(1), T(0), -T(1), inf,
+                        std::numeric_limits<T>::denorm_min()};
+  const int n = sizeof(specials) / sizeof(specials[0]);
+  T results[n];
+  k.log(n, specials, results);
+  EXPECT_EQ(results[0], T(0));
+  EXPECT_EQ(results[1], -inf);
+  EXPECT_TRUE(std::isnan(results[2]));
+  EXPECT_EQ(results[3], inf);
+  EXPECT_LE(ulp_error(results[4],
+                      std::log(static_cast<long double>(specials[4]))),
+            max_ulp);
+}
+
+std::vector<uint32_t> float_bits_of(const std::vector<float>& X) {
+  std::vector<uint32_t> bits(X.size());
+  if (!X.empty()) {
+    std::memcpy(bits.data(), X.data(), X.size() * sizeof(float));
+  }
+  return bits;
+}
+
+// The conversions must agree, bit for bit, with the scalar ones: on every
+// 16-bit pattern, and on floats covering every rounding case, both
+// infinities, NaNs, and the subnormals of both formats.
+void check_conversions(const conversion_table& k) {
+  const conversion_table& scalar = scalar_conversions;
+
+  const int n16 = 1 << 16;
+  std::vector<uint16_t> H(n16);
+  for (int i = 0; i < n16; ++i) H[i] = static_cast<uint16_t>(i);
+  std::vector<float> F(n16), expected_f(n16);
+
+  k.half_to_float(n16, H.data(), F.data());
+  scalar.half_to_float(n16, H.data(), expected_f.data());
+  EXPECT_THAT(float_bits_of(F), ElementsAreArray(float_bits_of(expected_f)));
+
+  k.bfloat16_to_float(n16, H.data(), F.data());
+  scalar.bfloat16_to_float(n16, H.data(), expected_f.data());
+  EXPECT_THAT(float_bits_of(F), ElementsAreArray(float_bits_of(expected_f)));
+
+  std::mt19937 gen(11);
+  std::vector<uint32_t> bits;
+  for (int i = 0; i < n16; ++i) {
+    // Halfway cases and their neighbours, for both formats.
+    const uint32_t base = gen() & 0xffffe000u;
+    bits.push_back(base | 0x1000u);
+    bits.push_back(base | 0x0fffu);
+    bits.push_back((base & 0xffff0000u) | 0x8000u);
+    bits.push_back(gen());
+  }
+  const uint32_t specials[] = {0x00000000u, 0x80000000u, 0x7f800000u,
+                               0xff800000u, 0x7fc00000u, 0x7f800001u,
+                               0xffbfffffu, 0x477ff000u, 0x477fefffu,
+                               0x33000000u, 0x33000001u, 0x00000001u,
+                               0x387fe000u, 0x7f7fffffu};
+  bits.insert(bits.end(), std::begin(specials), std::end(specials));
+
+  const int n = static_cast<int>(bits.size());
+  std::vector<float> X(n);
+  std::memcpy(X.data(), bits.data(), n * sizeof(float));
+  std::vector<uint16_t> Y(n), expected(n);
+  for (int N : lengths) {
+    k.float_to_half(N, X.data(), Y.data());
+    scalar.float_to_half(N, X.data(), expected.data());
+    EXPECT_TRUE(std::equal(Y.begin(), Y.begin() + N, expected.begin()))
+        << "float_to_half, N = " << N;
+  }
+
+  k.float_to_half(n, X.data(), Y.data());
+  scalar.float_to_half(n, X.data(), expected.data());
+  EXPECT_THAT(Y, ElementsAreArray(expected));
+
+  k.float_to_bfloat16(n, X.data(), Y.data());
+  scalar.float_to_bfloat16(n, X.data(), expected.data());
+  EXPECT_THAT(Y, ElementsAreArray(expected));
+}
+
+void check_integer_arithmetic(const integer_kernel_table& k) {
+  std::mt19937 gen(13);
+  std::uniform_int_distribution<int32_t> dist(
+      std::numeric_limits<int32_t>::min(),
+      std::numeric_limits<int32_t>::max());
+
+  // Wraps around on overflow, as the corresponding unsigned arithmetic.
+  auto wrap = [](uint32_t value) { return static_cast<int32_t>(value); };
+
+  for (int N : lengths) {
+    std::vector<int32_t> X(N), Y(N), Z(N), expected(N);
+    for (int i = 0; i < N; ++i) {
+      X[i] = dist(gen);
+      Y[i] = dist(gen);
+    }
+
+    k.add(N, X.data(), Y.data(), Z.data());
+    for (int i = 0; i < N; ++i) {
+      expected[i] = wrap(static_cast<uint32_t>(X[i]) +
+                         static_cast<uint32_t>(Y[i]));
+    }
+    EXPECT_THAT(Z, ElementsAreArray(expected)) << "add, N = " << N;
+
+    k.sub(N, X.data(), Y.data(), Z.data());
+    for (int i = 0; i < N; ++i) {
+      expected[i] = wrap(static_cast<uint32_t>(X[i]) -
+                         static_cast<uint32_t>(Y[i]));
+    }
+    EXPECT_THAT(Z, ElementsAreArray(expected)) << "sub, N = " << N;
+
+    k.mul(N, X.data(), Y.data(), Z.data());
+    for (int i = 0; i < N; ++i) {
+      expected[i] = wrap(static_cast<uint32_t>(X[i]) *
+                         static_cast<uint32_t>(Y[i]));
+    }
+    EXPECT_THAT(Z, ElementsAreArray(expected)) << "mul, N = " << N;
+
+    const int32_t alpha = -7;
+    for (int i = 0; i < N; ++i) {
+      expected[i] = wrap(static_cast<uint32_t>(X[i]) *
+                         static_cast<uint32_t>(alpha));
+    }
+    k.scal(N, alpha, X.data());
+    EXPECT_THAT(X, ElementsAreArray(expected)) << "scal, N = " << N;
+  }
+}
+
+// Checks C = A * B^T, with lda > K, against a plain triple loop.
+void check_gemm_u8s8s32(gemm_u8s8s32_kernel gemm) {
+  std::mt19937 gen(17);
+  std::uniform_int_distribution<int> a_dist(0, 255);
+  std::uniform_int_distribution<int> b_dist(-128, 127);
+
+  const int shapes[][3] = {{1, 1, 1}, {1, 5, 3}, {3, 4, 16}, {2, 7, 17},
+                           {5, 9, 63}, {4, 8, 64}, {7, 3, 65}, {1, 33, 200},
+                           {6, 11, 301}, {2, 2, 0}};
+  for (const auto& shape : shapes) {
+    const int M = shape[0], N = shape[1], K = shape[2];
+    const int lda = K + 3, ldb = K + 1, ldc = N + 2;
+    std::vector<uint8_t> A(M * lda);
+    std::vector<int8_t> B(N * ldb);
+    for (auto& a : A) a = static_cast<uint8_t>(a_dist(gen));
+    for (auto& b : B) b = static_cast<int8_t>(b_dist(gen));
+    // The extremes, to catch any intermediate saturation.
+    if (K > 0) {
+      A[0] = 255;
+      B[0] = -128;
+      if (K > 1) {
+        A[1] = 255;
+        B[1] = -128;
+      }
+    }
+
+    std::vector<int32_t> C(M * ldc, -1), expected(M * ldc, -1);
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < N; ++j) {
+        int32_t sum = 0;
+        for (int p = 0; p < K; ++p) {
+          sum += static_cast<int32_t>(A[i * lda + p]) * B[j * ldb + p];
+        }
+        expected[i * ldc + j] = sum;
+      }
+    }
+
+    gemm(M, N, K, A.data(), lda, B.data(), ldb, C.data(), ldc);
+    EXPECT_THAT(C, ElementsAreArray(expected))
+        << "M = " << M << ", N = " << N << ", K = " << K;
+  }
+}
+
+}  // namespace
+
+TEST(simd_kernels, best_isa_is_available) {
+  EXPECT_NE(kernels_for<float>(best_isa()), nullptr);
+  EXPECT_NE(kernels_for<double>(best_isa()), nullptr);
+  EXPECT_EQ(&kernels<float>(), kernels_for<float>(best_isa()));
+  EXPECT_EQ(&kernels<double>(), kernels_for<double>(best_isa()));
+  EXPECT_NE(kernels_for<float>(SCALAR), nullptr);
+  EXPECT_NE(kernels_for<double>(SCALAR), nullptr);
+  EXPECT_NE(conversions_for(best_isa()), nullptr);
+  EXPECT_EQ(&conversions(), conversions_for(best_isa()));
+  EXPECT_NE(integer_kernels_for(best_isa()), nullptr);
+}
+
+TEST(simd_kernels, float_arithmetic) {
+  for (isa target : all_isas) {
+    const kernel_table<float>* k = kernels_for<float>(target);
+    if (k == nullptr) continue;
+    SCOPED_TRACE(isa_name(target));
+    check_arithmetic(*k);
+  }
+}
+
+TEST(simd_kernels, double_arithmetic) {
+  for (isa target : all_isas) {
+    const kernel_table<double>* k = kernels_for<double>(target);
+    if (k == nullptr) continue;
+    SCOPED_TRACE(isa_name(target));
+    check_arithmetic(*k);
+  }
+}
+
+TEST(simd_kernels, float_reductions) {
+  for (isa target : all_isas) {
+    const kernel_table<float>* k = kernels_for<float>(target);
+    if (k == nullptr) continue;
+    SCOPED_TRACE(isa_name(target));
+    check_reductions(*k);
+  }
+}
+
+TEST(simd_kernels, double_reductions) {
+  for (isa target : all_isas) {
+    const kernel_table<double>* k = kernels_for<double>(target);
+    if (k == nullptr) continue;
+    SCOPED_TRACE(isa_name(target));
+    check_reductions(*k);
+  }
+}
+
+TEST(simd_kernels, float_exp) {
+  for (isa target : all_isas) {
+    const kernel_table<float>* k = kernels_for<float>(target);
+    if (k == nullptr) continue;
+    SCOPED_TRACE(isa_name(target));
+    check_exp<float>(*k, -103.9f, 88.72f, 1.5);
+  }
+}
+
+TEST(simd_kernels, double_exp) {
+  for (isa target : all_isas) {
+    const kernel_table<double>* k = kernels_for<double>(target);
+    if (k == nullptr) continue;
+    SCOPED_TRACE(isa_name(target));
+    check_exp<double>(*k, -745.0, 709.78, 1.0);
+  }
+}
+
+TEST(simd_kernels, float_log) {
+  for (isa target : all_isas) {
+    const kernel_table<float>* k = kernels_for<float>(target);
+    if (k == nullptr) continue;
+    SCOPED_TRACE(isa_name(target));
+    check_log<float, uint32_t>(*k, 1.0);
+  }
+}
+
+TEST(simd_kernels, double_log) {
+  for (isa target : all_isas) {
+    const kernel_table<double>* k = kernels_for<double>(target);
+    if (k == nullptr) continue;
+    SCOPED_TRACE(isa_name(target));
+    check_log<double, uint64_t>(*k, 1.0);
+  }
+}
+
+TEST(simd_kernels, conversions) {
+  for (isa target : all_isas) {
+    const conversion_table* k = conversions_for(target);
+    if (k == nullptr) continue;
+    SCOPED_TRACE(isa_name(target));
+    check_conversions(*k);
+  }
+}
+
+TEST(simd_kernels, integer_arithmetic) {
+  for (isa target : all_isas) {
+    const integer_kernel_table* k = integer_kernels_for(target);
+    if (k == nullptr) continue;
+    SCOPED_TRACE(isa_name(target));
+    check_integer_arithmetic(*k);
+  }
+}
+
+TEST(simd_kernels, gemm_u8s8s32) {
+  for (isa target : all_isas) {
+    const integer_kernel_table* k = integer_kernels_for(target);
+    if (k == nullptr) continue;
+    SCOPED_TRACE(isa_name(target));
+    check_gemm_u8s8s32(k->gemm_u8s8s32);
+  }
+
+  if (vnni_gemm_u8s8s32() != nullptr) {
+    SCOPED_TRACE("avx512_vnni");
+    check_gemm_u8s8s32(vnni_gemm_u8s8s32());
+    EXPECT_EQ(integer_kernels().gemm_u8s8s32, vnni_gemm_u8s8s32());
+  }
+}
+
+}  // namespace simd
+}  // namespace linalg_detail
+}  // namespace insight
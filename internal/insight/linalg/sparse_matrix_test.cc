@@ -0,0 +1,229 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "insight/linalg.h"
+#include "insight/linalg/test_util.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using test::max_abs_diff;
+using test::random_matrix;
+using test::random_vector;
+
+namespace {
+
+// A dense matrix, about density of whose elements are nonzero.
+template<typename T>
+matrix<T> random_sparse_matrix(std::size_t row_count, std::size_t col_count,
+                               double density, std::mt19937* gen) {
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  matrix<T> A(row_count, col_count, T(0));
+  for (auto& a : A) {
+    if (dist(*gen) < density) a = static_cast<T>(2.0 * dist(*gen) - 1.0);
+  }
+  return A;
+}
+
+// Checks the products of a sparse matrix (and of its transpose) with
+// vectors and matrices against those of its dense equivalent.
+template<typename T, sparse_format F>
+void check_products(std::size_t m, std::size_t n, double density,
+                    double tolerance) {
+  std::mt19937 gen(1);
+  const matrix<T> D = random_sparse_matrix<T>(m, n, density, &gen);
+  const sparse_matrix<T, F> S(D);
+  const vector<T> x = random_vector<T>(n, &gen);
+  const vector<T> z = random_vector<T>(m, &gen);
+  const vector<T> b = random_vector<T>(m, &gen);
+
+  // Matrix-vector.
+  vector<T> y = matmul(S, x);
+  EXPECT_LE(max_abs_diff(y, vector<T>(matmul(D, x))), tolerance);
+
+  y = matmul(S.t(), z);
+  EXPECT_LE(max_abs_diff(y, vector<T>(matmul(D.t(), z))), tolerance);
+
+  y = T(2) * matmul(S, T(3) * x) - b;
+  EXPECT_LE(max_abs_diff(y, vector<T>(T(6) * matmul(D, x) - b)), tolerance);
+
+  y = b;
+  y -= matmul(S, x);
+  EXPECT_LE(max_abs_diff(y, vector<T>(b - matmul(D, x))), tolerance);
+
+  y = matmul(S, x) * b;
+  EXPECT_LE(max_abs_diff(y, vector<T>(matmul(D, x) * b)), tolerance);
+
+  y = matmul(S.t(), z + b) + x;
+  EXPECT_LE(max_abs_diff(y, vector<T>(matmul(D.t(), z + b) + x)),
+            tolerance);
+
+  // Matrix-matrix.
+  const matrix<T> B = random_matrix<T>(n, 3, &gen);
+  const matrix<T> Z = random_matrix<T>(m, 5, &gen);
+
+  matrix<T> C = matmul(S, B);
+  EXPECT_LE(max_abs_diff(C, matrix<T>(matmul(D, B))), tolerance);
+
+  C = matmul(S.t(), Z);
+  EXPECT_LE(max_abs_diff(C, matrix<T>(matmul(D.t(), Z))), tolerance);
+
+  C += T(2) * matmul(S.t(), Z);
+  EXPECT_LE(max_abs_diff(C, matrix<T>(T(3) * matmul(D.t(), Z))), tolerance);
+
+  const matrix<T> Bt = B.t();
+  C = matmul(S, Bt.t()) + T(1);
+  EXPECT_LE(max_abs_diff(C, matrix<T>(matmul(D, B) + T(1))), tolerance);
+}
+
+}  // namespace
+
+TEST(sparse_matrix, construction) {
+  sparse_matrix<double> empty;
+  EXPECT_EQ(empty.row_count(), 0);
+  EXPECT_EQ(empty.nonzero_count(), 0);
+
+  sparse_matrix<double, csc> Z(2, 3);
+  EXPECT_EQ(Z.nonzero_count(), 0);
+  EXPECT_THAT(Z, ElementsAre(0, 0, 0, 0, 0, 0));
+
+  // Unsorted, with a duplicate.
+  const std::vector<triplet<double> > nonzeros = {
+    {1, 2, 4.0}, {0, 1, 1.0}, {1, 0, 2.0}, {0, 1, 0.5}, {2, 2, 5.0}};
+
+  const sparse_matrix<double, csr> R(3, 3, nonzeros);
+  EXPECT_EQ(R.nonzero_count(), 4);
+  EXPECT_THAT(R, ElementsAre(0.0, 1.5, 0.0,
+                             2.0, 0.0, 4.0,
+                             0.0, 0.0, 5.0));
+  EXPECT_THAT(std::vector<double>(R.data(), R.data() + 4),
+              ElementsAre(1.5, 2.0, 4.0, 5.0));
+  EXPECT_THAT(std::vector<int>(R.indices(), R.indices() + 4),
+              ElementsAre(1, 0, 2, 2));
+  EXPECT_THAT(std::vector<std::size_t>(R.offsets(), R.offsets() + 4),
+              ElementsAre(0, 1, 3, 4));
+
+  const sparse_matrix<double, csc> C(3, 3, nonzeros);
+  EXPECT_THAT(C, ElementsAre(0.0, 1.5, 0.0,
+                             2.0, 0.0, 4.0,
+                             0.0, 0.0, 5.0));
+  EXPECT_THAT(std::vector<double>(C.data(), C.data() + 4),
+              ElementsAre(2.0, 1.5, 4.0, 5.0));
+  EXPECT_THAT(std::vector<int>(C.indices(), C.indices() + 4),
+              ElementsAre(1, 0, 1, 2));
+  EXPECT_THAT(std::vector<std::size_t>(C.offsets(), C.offsets() + 4),
+              ElementsAre(0, 1, 2, 4));
+}
+
+TEST(sparse_matrix, half_precision) {
+  const matrix<float16> A = {{0.0f, 1.5f}, {-2.0f, 0.0f}};
+  const sparse_matrix<float16> S(A);
+  EXPECT_EQ(S.nonzero_count(), 2);
+  const matrix<float16> B(S);
+  EXPECT_THAT(std::vector<float>(B.begin(), B.end()),
+              ElementsAre(0.0f, 1.5f, -2.0f, 0.0f));
+}
+
+TEST(sparse_matrix, conversions) {
+  const matrix<double> A = {{0.0, 1.0, 0.0, 2.0},
+                            {0.0, 0.0, 0.0, 0.0},
+                            {3.0, 0.0, 4.0, 0.0}};
+
+  const sparse_matrix<double, csr> R(A);
+  EXPECT_EQ(R.nonzero_count(), 4);
+  EXPECT_EQ(R(0, 3), 2.0);
+  EXPECT_EQ(R(1, 2), 0.0);
+  EXPECT_EQ(R(2, 0), 3.0);
+
+  const sparse_matrix<double, csc> C(R);
+  EXPECT_THAT(std::vector<int>(C.indices(), C.indices() + 4),
+              ElementsAre(2, 0, 2, 0));
+  EXPECT_THAT(std::vector<std::size_t>(C.offsets(), C.offsets() + 5),
+              ElementsAre(0, 1, 2, 3, 4));
+
+  const sparse_matrix<double, csr> R2(C);
+  EXPECT_THAT(std::vector<std::size_t>(R2.offsets(), R2.offsets() + 4),
+              ElementsAre(0, 2, 2, 4));
+
+  matrix<double> B = C;
+  EXPECT_THAT(B, ::testing::ElementsAreArray(A.begin(), A.end()));
+  B = R2;
+  EXPECT_THAT(B, ::testing::ElementsAreArray(A.begin(), A.end()));
+}
+
+TEST(sparse_matrix, elementwise_expressions) {
+  const matrix<double> A = {{1.0, 2.0},
+                            {3.0, 4.0}};
+  const sparse_matrix<double> S(2, 2, {{0, 1, 1.0}, {1, 1, 2.0}});
+
+  matrix<double> B = A + 2.0 * S;
+  EXPECT_THAT(B, ElementsAre(1.0, 4.0, 3.0, 8.0));
+
+  B = S.t();
+  EXPECT_THAT(B, ElementsAre(0.0, 0.0, 1.0, 2.0));
+
+  EXPECT_EQ(sum(S), 3.0);
+
+  // No BLAS for integers: the products are evaluated elementwise.
+  const sparse_matrix<int> I(2, 3, {{0, 2, 1}, {1, 0, 2}});
+  const vector<int> x = {1, 2, 3};
+  vector<int> y = matmul(I, x);
+  EXPECT_THAT(y, ElementsAre(3, 2));
+}
+
+TEST(sparse_matrix, products_csr) {
+  check_products<double, csr>(1, 1, 1.0, 1e-12);
+  check_products<double, csr>(7, 13, 0.3, 1e-12);
+  check_products<double, csr>(65, 40, 0.1, 1e-12);
+  check_products<float, csr>(65, 40, 0.1, 1e-4);
+}
+
+TEST(sparse_matrix, products_csc) {
+  check_products<double, csc>(1, 1, 1.0, 1e-12);
+  check_products<double, csc>(7, 13, 0.3, 1e-12);
+  check_products<double, csc>(65, 40, 0.1, 1e-12);
+  check_products<float, csc>(65, 40, 0.1, 1e-4);
+}
+
+// Large enough to be split among threads (see sparse_routines.cc).
+TEST(sparse_matrix, large_products) {
+  check_products<double, csr>(3000, 200, 0.1, 1e-11);
+  check_products<double, csc>(3000, 200, 0.1, 1e-11);
+}
+
+TEST(sparse_matrix, empty_rows_and_columns) {
+  const sparse_matrix<double> S(4, 3, {{1, 1, 2.0}});
+  const vector<double> x = {1.0, 1.0, 1.0};
+  const vector<double> z = {1.0, 2.0, 3.0, 4.0};
+
+  vector<double> y = matmul(S, x);
+  EXPECT_THAT(y, ElementsAre(0.0, 2.0, 0.0, 0.0));
+  y = matmul(S.t(), z);
+  EXPECT_THAT(y, ElementsAre(0.0, 4.0, 0.0));
+}
+
+TEST(sparse_matrix, scaled_products) {
+  std::mt19937 gen(1);
+  const matrix<double> D = random_sparse_matrix<double>(20, 10, 0.2, &gen);
+  const sparse_matrix<double> S(D);
+  const vector<double> w = random_vector<double>(20, &gen);
+  const vector<double> v = random_vector<double>(10, &gen);
+
+  vector<double> y = matmul(matmul(diag(w), S), v);
+  EXPECT_LE(max_abs_diff(y, vector<double>(w * matmul(D, v))), 1e-12);
+
+  y = matmul(matmul(S, diag(v)), v);
+  EXPECT_LE(max_abs_diff(y, vector<double>(matmul(D, v * v))), 1e-12);
+}
+
+}  // namespace insight
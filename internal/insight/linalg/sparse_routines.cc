@@ -0,0 +1,234 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "insight/linalg/detail/sparse_routines.h"
+
+#ifdef INSIGHT_USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace insight {
+namespace linalg_detail {
+
+namespace {
+
+// Rows of A are handed out to threads in blocks of this many rows, so that
+// rows with many nonzeros do not all end up on the same thread.
+const int kRowBlock = 256;
+
+#ifdef INSIGHT_USE_OPENMP
+// Products doing fewer multiply-adds than this run on a single thread.
+const std::size_t kParallelWork = std::size_t(1) << 15;
+
+// The number of threads among which a product doing the given number of
+// multiply-adds is split.
+inline int thread_count(const std::size_t work) {
+  return (work < kParallelWork) ? 1 : omp_get_max_threads();
+}
+#endif
+
+// y[j] <- beta * y[j], for j < n, y not being read when beta is zero.
+template<typename T>
+inline void scale(const int n, const T beta, T* y) {
+  if (beta == T(0)) {
+    std::fill(y, y + n, T(0));
+  } else if (beta != T(1)) {
+    for (int j = 0; j < n; ++j) y[j] *= beta;
+  }
+}
+
+// C[indices[k], :] += alpha * values[k] * B[i, :], for the nonzeros k of
+// the rows first <= i < last of A. The innermost loop runs over contiguous
+// rows of B and C, which the compiler vectorizes.
+template<typename T>
+void scatter_rows(const int first, const int last, const int N,
+                  const T alpha, const T* values, const int* indices,
+                  const std::size_t* offsets, const T* B, const int ldb,
+                  T* C, const int ldc) {
+  for (int i = first; i < last; ++i) {
+    const T* b = B + static_cast<std::size_t>(i) * ldb;
+    for (std::size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+      const T a = alpha * values[k];
+      T* c = C + static_cast<std::size_t>(indices[k]) * ldc;
+      for (int j = 0; j < N; ++j) c[j] += a * b[j];
+    }
+  }
+}
+
+// y <- alpha * A * x + beta * y.
+template<typename T>
+void csrmv(const int M, const T alpha, const T* values, const int* indices,
+           const std::size_t* offsets, const T* x, const T beta, T* y) {
+#ifdef INSIGHT_USE_OPENMP
+  const int threads = thread_count(offsets[M]);
+#pragma omp parallel for if (threads > 1) schedule(dynamic, kRowBlock)
+#endif
+  for (int i = 0; i < M; ++i) {
+    const T dot = sparse_doti(offsets[i + 1] - offsets[i],
+                              values + offsets[i], indices + offsets[i], x);
+    y[i] = (beta == T(0)) ? alpha * dot : alpha * dot + beta * y[i];
+  }
+}
+
+// C <- alpha * A * B + beta * C.
+template<typename T>
+void csrmm(const int M, const int N, const T alpha, const T* values,
+           const int* indices, const std::size_t* offsets, const T* B,
+           const int ldb, const T beta, T* C, const int ldc) {
+#ifdef INSIGHT_USE_OPENMP
+  const int threads = thread_count(offsets[M] * N);
+#pragma omp parallel for if (threads > 1) schedule(dynamic, kRowBlock)
+#endif
+  for (int i = 0; i < M; ++i) {
+    T* c = C + static_cast<std::size_t>(i) * ldc;
+    scale(N, beta, c);
+    for (std::size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+      const T a = alpha * values[k];
+      const T* b = B + static_cast<std::size_t>(indices[k]) * ldb;
+      for (int j = 0; j < N; ++j) c[j] += a * b[j];
+    }
+  }
+}
+
+// C <- alpha * A^T * B + beta * C, of which A^T * x is the N = 1 case.
+template<typename T>
+void csrtmm(const int M, const int N, const int K, const T alpha,
+            const T* values, const int* indices, const std::size_t* offsets,
+            const T* B, const int ldb, const T beta, T* C, const int ldc) {
+  for (int r = 0; r < K; ++r) {
+    scale(N, beta, C + static_cast<std::size_t>(r) * ldc);
+  }
+
+#ifdef INSIGHT_USE_OPENMP
+  // Every thread scatters its blocks of rows into its own copy of C, and
+  // these copies are then summed into C. Both the memory and the time this
+  // takes grow with the number of threads times the size of C, which is
+  // only worth it when C is smaller than A. The blocks are assigned
+  // statically, so that the result does not depend on the scheduling.
+  const std::size_t nonzeros = offsets[M];
+  int threads = thread_count(nonzeros * N);
+  if (static_cast<std::size_t>(K) * threads > nonzeros) threads = 1;
+  if (threads > 1) {
+    const std::size_t size = static_cast<std::size_t>(K) * N;
+    std::vector<T> partial(size * threads, T(0));
+#pragma omp parallel num_threads(threads)
+    {
+      T* p = partial.data() + size * omp_get_thread_num();
+#pragma omp for schedule(static)
+      for (int first = 0; first < M; first += kRowBlock) {
+        scatter_rows(first, std::min(M, first + kRowBlock), N, alpha,
+                     values, indices, offsets, B, ldb, p, N);
+      }
+#pragma omp for schedule(static)
+      for (int r = 0; r < K; ++r) {
+        T* c = C + static_cast<std::size_t>(r) * ldc;
+        for (int t = 0; t < threads; ++t) {
+          const T* q = partial.data() + size * t +
+                       static_cast<std::size_t>(r) * N;
+          for (int j = 0; j < N; ++j) c[j] += q[j];
+        }
+      }
+    }
+    return;
+  }
+#endif
+
+  scatter_rows(0, M, N, alpha, values, indices, offsets, B, ldb, C, ldc);
+}
+
+template<typename T>
+void csrmv(const CBLAS_TRANSPOSE TransA, const int M, const int N,
+           const T alpha, const T* values, const int* indices,
+           const std::size_t* offsets, const T* x, const T beta, T* y) {
+  if (TransA == CblasNoTrans) {
+    csrmv(M, alpha, values, indices, offsets, x, beta, y);
+  } else {
+    csrtmm(M, 1, N, alpha, values, indices, offsets, x, 1, beta, y, 1);
+  }
+}
+
+template<typename T>
+void csrmm(const CBLAS_TRANSPOSE TransA, const int M, const int N,
+           const int K, const T alpha, const T* values, const int* indices,
+           const std::size_t* offsets, const T* B, const int ldb,
+           const T beta, T* C, const int ldc) {
+  if (TransA == CblasNoTrans) {
+    csrmm(M, N, alpha, values, indices, offsets, B, ldb, beta, C, ldc);
+  } else {
+    csrtmm(M, N, K, alpha, values, indices, offsets, B, ldb, beta, C, ldc);
+  }
+}
+
+}  // namespace
+
+template<>
+void sparse_csrmv<float>(const CBLAS_TRANSPOSE TransA,
+                         const int M,
+                         const int N,
+                         const float alpha,
+                         const float* values,
+                         const int* indices,
+                         const std::size_t* offsets,
+                         const float* x,
+                         const float beta,
+                         float* y) {
+  csrmv(TransA, M, N, alpha, values, indices, offsets, x, beta, y);
+}
+
+template<>
+void sparse_csrmv<double>(const CBLAS_TRANSPOSE TransA,
+                          const int M,
+                          const int N,
+                          const double alpha,
+                          const double* values,
+                          const int* indices,
+                          const std::size_t* offsets,
+                          const double* x,
+                          const double beta,
+                          double* y) {
+  csrmv(TransA, M, N, alpha, values, indices, offsets, x, beta, y);
+}
+
+template<>
+void sparse_csrmm<float>(const CBLAS_TRANSPOSE TransA,
+                         const int M,
+                         const int N,
+                         const int K,
+                         const float alpha,
+                         const float* values,
+                         const int* indices,
+                         const std::size_t* offsets,
+                         const float* B,
+                         const int ldb,
+                         const float beta,
+                         float* C,
+                         const int ldc) {
+  csrmm(TransA, M, N, K, alpha, values, indices, offsets, B, ldb, beta, C,
+        ldc);
+}
+
+template<>
+void sparse_csrmm<double>(const CBLAS_TRANSPOSE TransA,
+                          const int M,
+                          const int N,
+                          const int K,
+                          const double alpha,
+                          const double* values,
+                          const int* indices,
+                          const std::size_t* offsets,
+                          const double* B,
+                          const int ldb,
+                          const double beta,
+                          double* C,
+                          const int ldc) {
+  csrmm(TransA, M, N, K, alpha, values, indices, offsets, B, ldb, beta, C,
+        ldc);
+}
+
+}  // namespace linalg_detail
+}  // namespace insight
@@ -0,0 +1,179 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <cstddef>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "insight/linalg.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+
+namespace {
+
+template<typename T>
+std::vector<T> nonzero_values(const sparse_vector<T>& s) {
+  return std::vector<T>(s.data(), s.data() + s.nonzero_count());
+}
+
+template<typename T>
+std::vector<int> nonzero_indices(const sparse_vector<T>& s) {
+  return std::vector<int>(s.indices(), s.indices() + s.nonzero_count());
+}
+
+}  // namespace
+
+TEST(sparse_vector, construction) {
+  sparse_vector<double> empty;
+  EXPECT_EQ(empty.size(), 0);
+  EXPECT_EQ(empty.nonzero_count(), 0);
+
+  sparse_vector<double> z(4);
+  EXPECT_EQ(z.nonzero_count(), 0);
+  EXPECT_THAT(z, ElementsAre(0.0, 0.0, 0.0, 0.0));
+
+  // Unsorted, with a duplicate.
+  const sparse_vector<double> s(6, {{4, 1.0}, {1, 2.0}, {4, 0.5}, {0, 3.0}});
+  EXPECT_EQ(s.size(), 6);
+  EXPECT_EQ(s.nonzero_count(), 3);
+  EXPECT_THAT(nonzero_indices(s), ElementsAre(0, 1, 4));
+  EXPECT_THAT(nonzero_values(s), ElementsAre(3.0, 2.0, 1.5));
+  EXPECT_THAT(s, ElementsAre(3.0, 2.0, 0.0, 0.0, 1.5, 0.0));
+  EXPECT_EQ(s[4], 1.5);
+  EXPECT_EQ(s[5], 0.0);
+
+  const vector<double> x = {0.0, 1.0, 0.0, 0.0, 2.0};
+  const sparse_vector<double> t(x);
+  EXPECT_THAT(nonzero_indices(t), ElementsAre(1, 4));
+  const sparse_vector<double> u(2.0 * x + 1.0);
+  EXPECT_EQ(u.nonzero_count(), 5);
+
+  sparse_vector<double> g(10);
+  g.push_back(2, 1.0);
+  g.push_back(7, -1.0);
+  EXPECT_THAT(nonzero_indices(g), ElementsAre(2, 7));
+  g.clear();
+  EXPECT_EQ(g.size(), 10);
+  EXPECT_EQ(g.nonzero_count(), 0);
+}
+
+TEST(sparse_vector, half_precision) {
+  const vector<bfloat16_t> x = {0.0f, 1.5f, 0.0f, -2.0f};
+  const sparse_vector<bfloat16_t> s(x);
+  EXPECT_THAT(nonzero_indices(s), ElementsAre(1, 3));
+  EXPECT_EQ(static_cast<float>(s[3]), -2.0f);
+}
+
+TEST(sparse_vector, dot) {
+  const sparse_vector<double> s(5, {{1, 2.0}, {3, -1.0}});
+  const vector<double> x = {1.0, 2.0, 3.0, 4.0, 5.0};
+  EXPECT_EQ(s.dot(x), 0.0);
+
+  const vector<double> y = {1.0, 1.0, 1.0, 1.0, 1.0};
+  EXPECT_EQ(s.dot(y), 1.0);
+  EXPECT_EQ(s.dot(x + 2.0 * y), 0.0 + 2.0);
+
+  double buffer[5] = {5.0, 4.0, 3.0, 2.0, 1.0};
+  EXPECT_EQ(s.dot(vector_map<double>(buffer, 5)), 6.0);
+
+  const sparse_vector<double> t(5, {{0, 1.0}, {3, 3.0}, {4, 1.0}});
+  EXPECT_EQ(s.dot(t), -3.0);
+  EXPECT_EQ(t.dot(s), -3.0);
+
+  const sparse_vector<float> f(3, {{2, 2.0f}});
+  const vector<float> v = {1.0f, 1.0f, 4.0f};
+  EXPECT_EQ(f.dot(v), 8.0f);
+}
+
+TEST(sparse_vector, scatter) {
+  const sparse_vector<double> s(5, {{0, 1.0}, {3, 2.0}});
+  vector<double> x = {1.0, 1.0, 1.0, 1.0, 1.0};
+
+  x += s;
+  EXPECT_THAT(x, ElementsAre(2.0, 1.0, 1.0, 3.0, 1.0));
+  x -= 0.5 * s;
+  EXPECT_THAT(x, ElementsAre(1.5, 1.0, 1.0, 2.0, 1.0));
+  x += s * 2.0;
+  EXPECT_THAT(x, ElementsAre(3.5, 1.0, 1.0, 6.0, 1.0));
+
+  x = s;
+  EXPECT_THAT(x, ElementsAre(1.0, 0.0, 0.0, 2.0, 0.0));
+  x = -3.0 * s;
+  EXPECT_THAT(x, ElementsAre(-3.0, 0.0, 0.0, -6.0, 0.0));
+
+  vector<double> y = s * 2.0;
+  EXPECT_THAT(y, ElementsAre(2.0, 0.0, 0.0, 4.0, 0.0));
+
+  // Read elementwise.
+  y = x + 2.0 * s + 1.0;
+  EXPECT_THAT(y, ElementsAre(0.0, 1.0, 1.0, -1.0, 1.0));
+
+  const sparse_vector<int> i(3, {{1, 2}});
+  vector<int> z = {1, 1, 1};
+  z += 3 * i;
+  EXPECT_THAT(z, ElementsAre(1, 7, 1));
+}
+
+TEST(sparse_vector, merge) {
+  const sparse_vector<double> s(6, {{0, 1.0}, {2, 2.0}, {5, 3.0}});
+  const sparse_vector<double> t(6, {{2, -2.0}, {3, 4.0}});
+
+  sparse_vector<double> u = s + t;
+  EXPECT_THAT(nonzero_indices(u), ElementsAre(0, 2, 3, 5));
+  EXPECT_THAT(u, ElementsAre(1.0, 0.0, 0.0, 4.0, 0.0, 3.0));
+
+  u = s - 0.5 * t;
+  EXPECT_THAT(nonzero_indices(u), ElementsAre(0, 2, 3, 5));
+  EXPECT_THAT(u, ElementsAre(1.0, 0.0, 3.0, -2.0, 0.0, 3.0));
+
+  u = 2.0 * s + t * 3.0;
+  EXPECT_THAT(u, ElementsAre(2.0, 0.0, -2.0, 12.0, 0.0, 6.0));
+
+  u = s * t;
+  EXPECT_THAT(nonzero_indices(u), ElementsAre(2));
+  EXPECT_THAT(nonzero_values(u), ElementsAre(-4.0));
+
+  u = (2.0 * s) * (t * 0.5);
+  EXPECT_THAT(nonzero_values(u), ElementsAre(-4.0));
+
+  const sparse_vector<double> none(6);
+  u = s * none;
+  EXPECT_EQ(u.nonzero_count(), 0);
+  u = none - s;
+  EXPECT_THAT(u, ElementsAre(-1.0, 0.0, -2.0, 0.0, 0.0, -3.0));
+}
+
+// Steps of stochastic gradient descent over a large (hashed) feature space,
+// checked against their dense equivalent.
+TEST(sparse_vector, sgd_steps) {
+  const std::size_t n = 1 << 20;
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<std::size_t> index(0, n - 1);
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+
+  vector<double> w(n, 0.0);
+  vector<double> dense(n, 0.0);
+  for (int step = 0; step < 10; ++step) {
+    std::vector<std::pair<std::size_t, double> > nonzeros(100);
+    for (auto& nz : nonzeros) nz = {index(gen), value(gen)};
+    const sparse_vector<double> x(n, nonzeros);
+    const vector<double> x_dense = x;
+
+    const double r = x.dot(w) - 1.0;
+    EXPECT_NEAR(r, x_dense.dot(dense) - 1.0, 1e-12);
+    w -= (0.1 * r) * x;
+    dense -= (0.1 * r) * x_dense;
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    ASSERT_NEAR(w[i], dense[i], 1e-12);
+  }
+}
+
+}  // namespace insight
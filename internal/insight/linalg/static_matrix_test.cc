@@ -0,0 +1,155 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <cmath>
+#include <functional>
+
+#include "insight/linalg.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using ::testing::DoubleEq;
+
+TEST(static_matrix, constructors) {
+  static_matrix<double, 2, 3> a;
+  EXPECT_EQ(a.row_count(), 2);
+  EXPECT_EQ(a.col_count(), 3);
+  EXPECT_EQ(a.size(), 6);
+  EXPECT_THAT(a, ElementsAre(0, 0, 0, 0, 0, 0));
+
+  static_matrix<int, 2, 2> b(3);
+  EXPECT_THAT(b, ElementsAre(3, 3, 3, 3));
+
+  static_matrix<double, 2, 3> c = {{1, 2, 3}, {4, 5, 6}};
+  EXPECT_THAT(c, ElementsAre(1, 2, 3, 4, 5, 6));
+  EXPECT_EQ(c(1, 0), 4);
+  c(1, 0) = 10;
+  EXPECT_EQ(c[3], 10);
+
+  static_assert(sizeof(static_matrix<float, 3, 4>) == 12 * sizeof(float),
+                "static_matrix should not hold more than its elements");
+}
+
+TEST(static_matrix, constructors_death) {
+  typedef static_matrix<double, 2, 2> mat2;
+  EXPECT_DEATH((mat2{{1, 2}, {3, 4}, {5, 6}}), "mismatched");
+  EXPECT_DEATH((mat2{{1, 2}, {3}}), "mismatched");
+  matrix<double> m(2, 3);
+  EXPECT_DEATH((mat2(m * 2.0)), "mismatched");
+}
+
+TEST(static_matrix, expressions) {
+  static_matrix<double, 2, 2> a = {{1, 2}, {3, 4}};
+  static_matrix<double, 2, 2> b = {{0, 1}, {1, 0}};
+
+  static_matrix<double, 2, 2> c = a * 2.0 - b;
+  EXPECT_THAT(c, ElementsAre(2, 3, 5, 8));
+
+  c = exp(b);
+  EXPECT_THAT(c, ElementsAre(DoubleEq(1.0), DoubleEq(std::exp(1.0)),
+                             DoubleEq(std::exp(1.0)), DoubleEq(1.0)));
+
+  // Transpose, in place.
+  c = a;
+  c = c.t();
+  EXPECT_THAT(c, ElementsAre(1, 3, 2, 4));
+
+  // Mixed with dynamic matrices.
+  matrix<double> m = a + c;
+  EXPECT_THAT(m, ElementsAre(2, 5, 5, 8));
+}
+
+TEST(static_matrix, matmul) {
+  static_matrix<double, 2, 3> a = {{1, 2, 3}, {4, 5, 6}};
+  static_matrix<double, 3, 2> b = {{1, 0}, {0, 1}, {1, 1}};
+  static_vector<double, 3> x = {1, 1, 1};
+
+  static_matrix<double, 2, 2> c = matmul(a, b);
+  EXPECT_THAT(c, ElementsAre(4, 5, 10, 11));
+
+  static_vector<double, 2> y = matmul(a, x);
+  EXPECT_THAT(y, ElementsAre(6, 15));
+
+  // Fused with elementwise operations.
+  y = exp(matmul(a, x) - 6.0) + 1.0;
+  EXPECT_THAT(y, ElementsAre(DoubleEq(2.0), DoubleEq(std::exp(9.0) + 1.0)));
+
+  // Nested products.
+  c = matmul(matmul(a, b), c.t());
+  EXPECT_THAT(c, ElementsAre(41, 95, 95, 221));
+
+  // Mixed with dynamic operands (through BLAS).
+  matrix<double> m = {{1, 0, 0}, {0, 1, 0}};
+  vector<double> v = matmul(m, x + 1.0);
+  EXPECT_THAT(v, ElementsAre(2, 2));
+  matrix<double> p = matmul(m, b);
+  EXPECT_THAT(p, ElementsAre(1, 0, 0, 1));
+  y = matmul(m, x);
+  EXPECT_THAT(y, ElementsAre(1, 1));
+}
+
+TEST(static_matrix, is_fixed_size) {
+  using linalg_detail::is_fixed_size;
+  using smat = static_matrix<double, 2, 2>;
+  using svec = static_vector<double, 2>;
+  using plus = std::plus<double>;
+  using sum = linalg_detail::binary_expression<svec, double, plus>;
+  using mixed = linalg_detail::binary_expression<svec, vector<double>, plus>;
+
+  EXPECT_TRUE((is_fixed_size<sum>::value));
+  EXPECT_TRUE((is_fixed_size<
+               linalg_detail::matmul_expression<smat, sum> >::value));
+
+  // A dynamic operand makes the whole tree dynamic, so that its products
+  // are materialized.
+  EXPECT_FALSE((is_fixed_size<mixed>::value));
+  EXPECT_FALSE((is_fixed_size<
+                linalg_detail::matmul_expression<smat, mixed> >::value));
+
+  // Nested products are materialized, rather than recomputing the inner
+  // product for every element of the outer one.
+  using product = linalg_detail::matmul_expression<smat, smat>;
+  EXPECT_FALSE((linalg_detail::contains_materialized<product>::value));
+  EXPECT_TRUE((linalg_detail::contains_materialized<
+               linalg_detail::matmul_expression<product, smat> >::value));
+  using product_t = linalg_detail::transpose_expression<product>;
+  EXPECT_TRUE((linalg_detail::contains_materialized<
+               linalg_detail::matmul_expression<smat, product_t> >::value));
+
+  smat a = {{1, 2}, {3, 4}};
+  svec x = {1, 1};
+  vector<double> v = {1, 2};
+  svec y = matmul(a, x + v);
+  EXPECT_THAT(y, ElementsAre(8, 18));
+}
+
+TEST(static_matrix, compound_assignment) {
+  static_matrix<int, 2, 2> a = {{1, 2}, {3, 4}};
+  a += 1;
+  EXPECT_THAT(a, ElementsAre(2, 3, 4, 5));
+  a *= 2;
+  EXPECT_THAT(a, ElementsAre(4, 6, 8, 10));
+
+  static_matrix<int, 2, 2> b = {{1, 2}, {3, 4}};
+  a -= b;
+  EXPECT_THAT(a, ElementsAre(3, 4, 5, 6));
+  a += b.t();
+  EXPECT_THAT(a, ElementsAre(4, 7, 7, 10));
+  a /= b;
+  EXPECT_THAT(a, ElementsAre(4, 3, 2, 2));
+}
+
+TEST(static_matrix, views) {
+  static_matrix<double, 2, 3> a = {{1, 2, 3}, {4, 5, 6}};
+  EXPECT_THAT(a.row_at(1), ElementsAre(4, 5, 6));
+  EXPECT_THAT(a.col_at(2), ElementsAre(3, 6));
+  EXPECT_DOUBLE_EQ(sum(a), 21.0);
+  EXPECT_DOUBLE_EQ(max(a.t()), 6.0);
+}
+
+}  // namespace insight
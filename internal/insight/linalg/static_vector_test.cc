@@ -0,0 +1,115 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <cmath>
+
+#include "insight/linalg.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using ::testing::DoubleEq;
+
+TEST(static_vector, constructors) {
+  static_vector<double, 3> a;
+  EXPECT_EQ(a.size(), 3);
+  EXPECT_EQ(a.row_count(), 3);
+  EXPECT_EQ(a.col_count(), 1);
+  EXPECT_THAT(a, ElementsAre(0, 0, 0));
+
+  static_vector<int, 4> b(7);
+  EXPECT_THAT(b, ElementsAre(7, 7, 7, 7));
+
+  static_vector<float, 2> c = {1.0f, 2.0f};
+  EXPECT_THAT(c, ElementsAre(1.0f, 2.0f));
+
+  static_vector<float, 2> d(c);
+  d[0] = 5.0f;
+  EXPECT_THAT(c, ElementsAre(1.0f, 2.0f));
+  EXPECT_THAT(d, ElementsAre(5.0f, 2.0f));
+
+  static_assert(sizeof(static_vector<double, 3>) == 3 * sizeof(double),
+                "static_vector should not hold more than its elements");
+}
+
+TEST(static_vector, constructors_death) {
+  EXPECT_DEATH((static_vector<double, 3>{1.0, 2.0}), "mismatched");
+  vector<double> v(2);
+  EXPECT_DEATH((static_vector<double, 3>(v + v)), "mismatched");
+}
+
+TEST(static_vector, expressions) {
+  static_vector<double, 3> a = {1.0, 2.0, 3.0};
+  static_vector<double, 3> b = {4.0, 5.0, 6.0};
+
+  static_vector<double, 3> c = a + b * 2.0;
+  EXPECT_THAT(c, ElementsAre(9.0, 12.0, 15.0));
+
+  c = exp(a) - 1.0;
+  EXPECT_THAT(c, ElementsAre(DoubleEq(std::exp(1.0) - 1.0),
+                             DoubleEq(std::exp(2.0) - 1.0),
+                             DoubleEq(std::exp(3.0) - 1.0)));
+
+  // Mixed with dynamic vectors.
+  vector<double> v = a - b;
+  EXPECT_THAT(v, ElementsAre(-3.0, -3.0, -3.0));
+  c = v * a;
+  EXPECT_THAT(c, ElementsAre(-3.0, -6.0, -9.0));
+
+  // Reads itself other than elementwise.
+  static_vector<double, 3> d = {1.0, 2.0, 3.0};
+  static_matrix<double, 3, 3> P = {{0, 0, 1}, {0, 1, 0}, {1, 0, 0}};
+  d = matmul(P, d);
+  EXPECT_THAT(d, ElementsAre(3.0, 2.0, 1.0));
+}
+
+TEST(static_vector, compound_assignment) {
+  static_vector<int, 4> a = {1, 2, 3, 4};
+  a += 1;
+  EXPECT_THAT(a, ElementsAre(2, 3, 4, 5));
+  a *= 2;
+  EXPECT_THAT(a, ElementsAre(4, 6, 8, 10));
+  a -= 2;
+  EXPECT_THAT(a, ElementsAre(2, 4, 6, 8));
+  a /= 2;
+  EXPECT_THAT(a, ElementsAre(1, 2, 3, 4));
+
+  static_vector<int, 4> b(2);
+  a += b;
+  EXPECT_THAT(a, ElementsAre(3, 4, 5, 6));
+  a *= b + 1;
+  EXPECT_THAT(a, ElementsAre(9, 12, 15, 18));
+  a -= b;
+  EXPECT_THAT(a, ElementsAre(7, 10, 13, 16));
+  a /= b;
+  EXPECT_THAT(a, ElementsAre(3, 5, 6, 8));
+
+  a.noalias() = b * 3;
+  EXPECT_THAT(a, ElementsAre(6, 6, 6, 6));
+}
+
+TEST(static_vector, nrm2_and_dot) {
+  static_vector<double, 2> a = {3.0, 4.0};
+  static_vector<double, 2> b = {1.0, -2.0};
+  EXPECT_DOUBLE_EQ(a.nrm2(), 5.0);
+  EXPECT_DOUBLE_EQ(a.dot(b), -5.0);
+  EXPECT_DOUBLE_EQ(sum(a + b), 6.0);
+}
+
+TEST(static_vector, transpose) {
+  static_vector<double, 3> a = {1.0, 2.0, 3.0};
+  matrix<double> m = a.t();
+  EXPECT_EQ(m.row_count(), 1);
+  EXPECT_EQ(m.col_count(), 3);
+  EXPECT_THAT(m, ElementsAre(1.0, 2.0, 3.0));
+
+  static_matrix<double, 3, 3> P = {{0, 0, 1}, {0, 1, 0}, {1, 0, 0}};
+  static_matrix<double, 1, 3> r = matmul(a.t(), P);
+  EXPECT_THAT(r, ElementsAre(3.0, 2.0, 1.0));
+}
+
+}  // namespace insight
@@ -0,0 +1,265 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "insight/linalg.h"
+#include "insight/linalg/test_util.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using test::max_abs_diff;
+using test::random_symmetric_matrix;
+using test::random_vector;
+
+namespace {
+
+const std::size_t sizes[] = {0, 1, 2, 7, 64, 65};
+
+// Checks the products of a symmetric matrix with a vector against those of
+// its dense equivalent.
+template<typename T, triangle Uplo, storage S>
+void check_matvec(double tolerance) {
+  std::mt19937 gen(1);
+  for (std::size_t n : sizes) {
+    SCOPED_TRACE(n);
+    const matrix<T> A = random_symmetric_matrix<T>(n, &gen);
+    const symmetric_matrix<T, Uplo, S> H(A);
+    const vector<T> x = random_vector<T>(n, &gen);
+    const vector<T> b = random_vector<T>(n, &gen);
+
+    vector<T> y = matmul(H, x);
+    EXPECT_LE(max_abs_diff(y, vector<T>(matmul(A, x))), tolerance);
+
+    y = T(2) * matmul(H, T(3) * x) - b;
+    EXPECT_LE(max_abs_diff(y, vector<T>(T(6) * matmul(A, x) - b)),
+              tolerance);
+
+    y = b;
+    y += matmul(H.t(), x);
+    EXPECT_LE(max_abs_diff(y, vector<T>(matmul(A, x) + b)), tolerance);
+
+    y = matmul(H, x) * b;
+    EXPECT_LE(max_abs_diff(y, vector<T>(matmul(A, x) * b)), tolerance);
+  }
+}
+
+// Checks the symmetric matrices built from products (syrk/spr for the
+// Gram matrices, elementwise otherwise) against the dense products.
+template<triangle Uplo, storage S>
+void check_products() {
+  std::mt19937 gen(2);
+  for (std::size_t n : sizes) {
+    SCOPED_TRACE(n);
+    const matrix<double> X = test::random_matrix<double>(5, n, &gen);
+    const matrix<double> Y = test::random_matrix<double>(n, 5, &gen);
+    const vector<double> u = random_vector<double>(n, &gen);
+
+    using sym = symmetric_matrix<double, Uplo, S>;
+    sym H(matmul(X.t(), X));
+    matrix<double> P = matmul(X.t(), X);
+    EXPECT_LE(max_abs_diff(matrix<double>(H), P), 1e-12);
+
+    H = matmul(Y, 2.0 * Y.t());
+    P = 2.0 * matmul(Y, Y.t());
+    EXPECT_LE(max_abs_diff(matrix<double>(H), P), 1e-12);
+
+    // Not a Gram matrix: only the stored triangle of the product is read.
+    H = matmul(Y, X);
+    P = matmul(Y, X);
+    EXPECT_LE(max_abs_diff(matrix<double>(H), matrix<double>(sym(P))), 1e-12);
+
+    H = matmul(matmul(Y, X), exp(matmul(Y, X)));
+    P = matmul(matmul(Y, X), exp(matmul(Y, X)));
+    EXPECT_LE(max_abs_diff(matrix<double>(H), matrix<double>(sym(P))), 1e-12);
+
+    H = matmul(u, u.t());
+    P = matmul(u, u.t());
+    EXPECT_LE(max_abs_diff(matrix<double>(H), P), 1e-12);
+  }
+}
+
+}  // namespace
+
+TEST(symmetric_matrix, construction) {
+  symmetric_matrix<double> empty;
+  EXPECT_EQ(empty.row_count(), 0);
+  EXPECT_EQ(empty.size(), 0);
+
+  symmetric_matrix<double, lower, packed> Z(3);
+  EXPECT_EQ(Z.stored_size(), 6);
+  EXPECT_THAT(Z, ElementsAre(0, 0, 0, 0, 0, 0, 0, 0, 0));
+
+  symmetric_matrix<float, upper, full> C(2, 1.5f);
+  EXPECT_EQ(C.stored_size(), 4);
+  EXPECT_THAT(C, ElementsAre(1.5f, 1.5f, 1.5f, 1.5f));
+}
+
+TEST(symmetric_matrix, from_matrix_expression) {
+  const matrix<double> A = {{1.0, 2.0, 3.0},
+                            {4.0, 5.0, 6.0},
+                            {7.0, 8.0, 9.0}};
+
+  // Only the stored triangle of A is read.
+  const symmetric_matrix<double, lower, full> L(A);
+  EXPECT_THAT(L, ElementsAre(1.0, 4.0, 7.0,
+                             4.0, 5.0, 8.0,
+                             7.0, 8.0, 9.0));
+
+  const symmetric_matrix<double, upper, packed> U(A);
+  EXPECT_EQ(U.stored_size(), 6);
+  EXPECT_THAT(U, ElementsAre(1.0, 2.0, 3.0,
+                             2.0, 5.0, 6.0,
+                             3.0, 6.0, 9.0));
+  // Rows of the upper triangle, one after the other.
+  EXPECT_THAT(std::vector<double>(U.data(), U.data() + U.stored_size()),
+              ElementsAre(1.0, 2.0, 3.0, 5.0, 6.0, 9.0));
+
+  const symmetric_matrix<double, lower, packed> G(matmul(A.t(), A) + 1.0);
+  const matrix<double> expected = matmul(A.t(), A) + 1.0;
+  EXPECT_THAT(G, ::testing::ElementsAreArray(expected.begin(),
+                                             expected.end()));
+}
+
+TEST(symmetric_matrix, element_access) {
+  symmetric_matrix<double, upper, packed> S(3);
+  S(2, 0) = 1.0;
+  S(1, 1) = 2.0;
+  S(0, 1) = 3.0;
+
+  const symmetric_matrix<double, upper, packed>& cS = S;
+  EXPECT_EQ(cS(0, 2), 1.0);
+  EXPECT_EQ(cS(2, 0), 1.0);
+  EXPECT_EQ(cS(1, 0), 3.0);
+  EXPECT_THAT(S, ElementsAre(0.0, 3.0, 1.0,
+                             3.0, 2.0, 0.0,
+                             1.0, 0.0, 0.0));
+}
+
+TEST(symmetric_matrix, elementwise_expressions) {
+  const matrix<double> A = {{1.0, 2.0},
+                            {2.0, 3.0}};
+  const symmetric_matrix<double, lower, packed> S(A);
+
+  matrix<double> B = 2.0 * S + A;
+  EXPECT_THAT(B, ElementsAre(3.0, 6.0, 6.0, 9.0));
+
+  B = S.t() - A;
+  EXPECT_THAT(B, ElementsAre(0.0, 0.0, 0.0, 0.0));
+
+  B = matmul(S, A);
+  EXPECT_THAT(B, ElementsAre(5.0, 8.0, 8.0, 13.0));
+
+  EXPECT_EQ(sum(S), 8.0);
+}
+
+TEST(symmetric_matrix, assign_expression) {
+  const matrix<double> A = {{1.0, 2.0, 3.0},
+                            {4.0, 5.0, 6.0},
+                            {7.0, 8.0, 9.0}};
+
+  // Only the stored triangle of A is read, the size is adjusted.
+  symmetric_matrix<double, upper, packed> U(2);
+  U = A;
+  EXPECT_EQ(U.stored_size(), 6);
+  EXPECT_THAT(U, ElementsAre(1.0, 2.0, 3.0,
+                             2.0, 5.0, 6.0,
+                             3.0, 6.0, 9.0));
+
+  symmetric_matrix<double, lower, full> H(A);
+  H = 2.0 * H;
+  EXPECT_THAT(H, ElementsAre(2.0, 8.0, 14.0,
+                             8.0, 10.0, 16.0,
+                             14.0, 16.0, 18.0));
+
+  // Reads the transpose of, and a product with, the destination.
+  H = 0.5 * (H + H.t());
+  EXPECT_THAT(H, ElementsAre(2.0, 8.0, 14.0,
+                             8.0, 10.0, 16.0,
+                             14.0, 16.0, 18.0));
+  H = matmul(H, A) - matmul(H, A);
+  EXPECT_THAT(H, ElementsAre(0.0, 0.0, 0.0,
+                             0.0, 0.0, 0.0,
+                             0.0, 0.0, 0.0));
+  EXPECT_EQ(H.row_count(), 3);
+
+  // A same size expression that does not read H reuses its storage.
+  const double* data = H.data();
+  H = A + 1.0;
+  EXPECT_EQ(H.data(), data);
+  EXPECT_THAT(H, ElementsAre(2.0, 5.0, 8.0,
+                             5.0, 6.0, 9.0,
+                             8.0, 9.0, 10.0));
+}
+
+TEST(symmetric_matrix, assign_product) {
+  check_products<lower, full>();
+  check_products<upper, full>();
+  check_products<lower, packed>();
+  check_products<upper, packed>();
+}
+
+TEST(symmetric_matrix, scalar_arithmetic) {
+  const matrix<double> A = {{1.0, 2.0},
+                            {2.0, 3.0}};
+  symmetric_matrix<double, lower, packed> S(A);
+
+  S += 1.0;
+  EXPECT_THAT(S, ElementsAre(2.0, 3.0, 3.0, 4.0));
+
+  S -= 2.0;
+  EXPECT_THAT(S, ElementsAre(0.0, 1.0, 1.0, 2.0));
+
+  S *= 3.0;
+  EXPECT_THAT(S, ElementsAre(0.0, 3.0, 3.0, 6.0));
+}
+
+TEST(symmetric_matrix, symmetric_arithmetic) {
+  const matrix<double> A = {{1.0, 2.0},
+                            {2.0, 3.0}};
+  const matrix<double> B = {{4.0, 5.0},
+                            {5.0, 6.0}};
+  symmetric_matrix<double, upper, full> S(A);
+  const symmetric_matrix<double, upper, full> C(B);
+
+  S += C;
+  EXPECT_THAT(S, ElementsAre(5.0, 7.0, 7.0, 9.0));
+
+  S -= C;
+  EXPECT_THAT(S, ElementsAre(1.0, 2.0, 2.0, 3.0));
+
+  S *= C;
+  EXPECT_THAT(S, ElementsAre(4.0, 10.0, 10.0, 18.0));
+
+  S += S;
+  EXPECT_THAT(S, ElementsAre(8.0, 20.0, 20.0, 36.0));
+}
+
+TEST(symmetric_matrix, matvec_lower_full) {
+  check_matvec<double, lower, full>(1e-12);
+  check_matvec<float, lower, full>(1e-4);
+}
+
+TEST(symmetric_matrix, matvec_upper_full) {
+  check_matvec<double, upper, full>(1e-12);
+}
+
+TEST(symmetric_matrix, matvec_lower_packed) {
+  check_matvec<double, lower, packed>(1e-12);
+  check_matvec<float, lower, packed>(1e-4);
+}
+
+TEST(symmetric_matrix, matvec_upper_packed) {
+  check_matvec<double, upper, packed>(1e-12);
+}
+
+}  // namespace insight
@@ -0,0 +1,81 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#ifndef INTERNAL_INSIGHT_LINALG_TEST_UTIL_H_
+#define INTERNAL_INSIGHT_LINALG_TEST_UTIL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+#include "insight/linalg/matrix.h"
+#include "insight/linalg/vector.h"
+
+#include "gtest/gtest.h"
+
+namespace insight {
+namespace test {
+
+// Helpers shared by the linalg tests that check a type against its dense,
+// single or double precision equivalent.
+
+// A row_count x col_count matrix with elements uniformly drawn in [lo, hi].
+template<typename T>
+matrix<T> random_matrix(std::size_t row_count, std::size_t col_count,
+                        std::mt19937* gen, double lo = -1.0, double hi = 1.0) {
+  std::uniform_real_distribution<double> dist(lo, hi);
+  matrix<T> A(row_count, col_count);
+  for (auto& a : A) a = static_cast<T>(dist(*gen));
+  return A;
+}
+
+// A vector with elements uniformly drawn in [lo, hi].
+template<typename T>
+vector<T> random_vector(std::size_t size, std::mt19937* gen, double lo = -1.0,
+                        double hi = 1.0) {
+  std::uniform_real_distribution<double> dist(lo, hi);
+  vector<T> x(size);
+  for (auto& a : x) a = static_cast<T>(dist(*gen));
+  return x;
+}
+
+// An n x n symmetric matrix with elements uniformly drawn in [-1, 1].
+template<typename T>
+matrix<T> random_symmetric_matrix(std::size_t n, std::mt19937* gen) {
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  matrix<T> A(n, n);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j <= i; ++j) {
+      A(i, j) = A(j, i) = static_cast<T>(dist(*gen));
+    }
+  }
+  return A;
+}
+
+// The largest absolute difference between the elements of two dense vectors
+// (or two dense matrices) of the same shape.
+template<typename C>
+double max_abs_diff(const C& x, const C& y) {
+  EXPECT_EQ(x.shape(), y.shape());
+  double result = 0.0;
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    result = std::max(result, std::fabs(static_cast<double>(x.data()[i]) -
+                                        static_cast<double>(y.data()[i])));
+  }
+  return result;
+}
+
+// Are the elements of the dense vector (or matrix) c stored inside c
+// itself, i.e in its small buffer?
+template<typename C>
+bool is_stored_inline(const C& c) {
+  const char* p = reinterpret_cast<const char*>(c.data());
+  const char* first = reinterpret_cast<const char*>(&c);
+  return first <= p && p < first + sizeof(c);
+}
+
+}  // namespace test
+}  // namespace insight
+#endif  // INTERNAL_INSIGHT_LINALG_TEST_UTIL_H_
@@ -195,4 +195,30 @@ TEST(transpose_expression, vector_addition) {
   EXPECT_EQ(y.shape().second, 1);
   EXPECT_THAT(y, ElementsAre(10.5, 21, 31.5));
 }
+
+TEST(transpose_expression, of_a_large_matrix) {
+  // Not a multiple of the tile size in either dimension.
+  const size_t m = 67, n = 45;
+  matrix<int> A(std::make_pair(m, n));
+  for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<int>(i);
+
+  matrix<int> B = A.t();
+  EXPECT_EQ(B.row_count(), n);
+  EXPECT_EQ(B.col_count(), m);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < m; ++j) {
+      EXPECT_EQ(B(i, j), A(j, i));
+    }
+  }
+
+  B += (A * 2).t();
+  matrix<int> C = (A + A).t() - A.t() * 2;
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < m; ++j) {
+      EXPECT_EQ(B(i, j), 3 * A(j, i));
+      EXPECT_EQ(C(i, j), 0);
+    }
+  }
+}
+
 }  // namespace insight
@@ -0,0 +1,224 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "insight/linalg.h"
+#include "insight/linalg/test_util.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using test::max_abs_diff;
+using test::random_matrix;
+using test::random_vector;
+
+namespace {
+
+// The triangle Uplo of A, the other one being zeroed.
+template<typename T>
+matrix<T> triangle_of(const matrix<T>& A, triangle Uplo) {
+  matrix<T> result(A);
+  for (std::size_t i = 0; i < A.row_count(); ++i) {
+    for (std::size_t j = 0; j < A.col_count(); ++j) {
+      if ((Uplo == lower) ? j > i : j < i) result(i, j) = T(0);
+    }
+  }
+  return result;
+}
+
+const std::size_t sizes[] = {0, 1, 2, 7, 64, 65};
+
+// Checks the products of a triangular matrix (and of its transpose) with a
+// vector against those of its dense equivalent.
+template<typename T, triangle Uplo, storage S>
+void check_matvec(double tolerance) {
+  std::mt19937 gen(1);
+  for (std::size_t n : sizes) {
+    SCOPED_TRACE(n);
+    const matrix<T> A = random_matrix<T>(n, n, &gen);
+    const matrix<T> D = triangle_of(A, Uplo);
+    const triangular_matrix<T, Uplo, S> L(A);
+    const vector<T> x = random_vector<T>(n, &gen);
+    const vector<T> b = random_vector<T>(n, &gen);
+
+    vector<T> y = matmul(L, x);
+    EXPECT_LE(max_abs_diff(y, vector<T>(matmul(D, x))), tolerance);
+
+    y = matmul(L.t(), x);
+    EXPECT_LE(max_abs_diff(y, vector<T>(matmul(D.t(), x))), tolerance);
+
+    y = T(2) * matmul(L, T(3) * x) - b;
+    EXPECT_LE(max_abs_diff(y, vector<T>(T(6) * matmul(D, x) - b)),
+              tolerance);
+
+    y = b;
+    y -= matmul(L.t(), x);
+    EXPECT_LE(max_abs_diff(y, vector<T>(b - matmul(D.t(), x))), tolerance);
+
+    y = matmul(L, x) * b;
+    EXPECT_LE(max_abs_diff(y, vector<T>(matmul(D, x) * b)), tolerance);
+  }
+}
+
+}  // namespace
+
+TEST(triangular_matrix, construction) {
+  triangular_matrix<double> empty;
+  EXPECT_EQ(empty.row_count(), 0);
+  EXPECT_EQ(empty.size(), 0);
+
+  triangular_matrix<double, lower, packed> L(3, 1.0);
+  EXPECT_EQ(L.stored_size(), 6);
+  EXPECT_THAT(L, ElementsAre(1.0, 0.0, 0.0,
+                             1.0, 1.0, 0.0,
+                             1.0, 1.0, 1.0));
+
+  triangular_matrix<float, upper, full> U(2, 2.0f);
+  EXPECT_EQ(U.stored_size(), 4);
+  EXPECT_THAT(U, ElementsAre(2.0f, 2.0f, 0.0f, 2.0f));
+}
+
+TEST(triangular_matrix, from_matrix_expression) {
+  const matrix<double> A = {{1.0, 2.0, 3.0},
+                            {4.0, 5.0, 6.0},
+                            {7.0, 8.0, 9.0}};
+
+  const triangular_matrix<double, lower, packed> L(A);
+  EXPECT_THAT(L, ElementsAre(1.0, 0.0, 0.0,
+                             4.0, 5.0, 0.0,
+                             7.0, 8.0, 9.0));
+  // Rows of the lower triangle, one after the other.
+  EXPECT_THAT(std::vector<double>(L.data(), L.data() + L.stored_size()),
+              ElementsAre(1.0, 4.0, 5.0, 7.0, 8.0, 9.0));
+
+  const triangular_matrix<double, upper, full> U(A.t());
+  EXPECT_THAT(U, ElementsAre(1.0, 4.0, 7.0,
+                             0.0, 5.0, 8.0,
+                             0.0, 0.0, 9.0));
+}
+
+TEST(triangular_matrix, element_access) {
+  triangular_matrix<double, upper, packed> U(3);
+  U(0, 2) = 1.0;
+  U(1, 1) = 2.0;
+
+  const triangular_matrix<double, upper, packed>& cU = U;
+  EXPECT_EQ(cU(0, 2), 1.0);
+  EXPECT_EQ(cU(2, 0), 0.0);
+  EXPECT_EQ(cU(1, 1), 2.0);
+}
+
+TEST(triangular_matrix, elementwise_expressions) {
+  const matrix<double> A = {{1.0, 2.0},
+                            {3.0, 4.0}};
+  const triangular_matrix<double, lower, full> L(A);
+
+  matrix<double> B = L + L.t();
+  EXPECT_THAT(B, ElementsAre(2.0, 3.0, 3.0, 8.0));
+
+  B = matmul(L, L.t());
+  EXPECT_THAT(B, ElementsAre(1.0, 3.0, 3.0, 25.0));
+
+  // The Cholesky factor, stored packed.
+  const triangular_matrix<double, lower, packed> F(cholesky<double>(B).l());
+  EXPECT_THAT(F, ElementsAre(1.0, 0.0, 3.0, 4.0));
+}
+
+TEST(triangular_matrix, assign_expression) {
+  const matrix<double> A = {{1.0, 2.0, 3.0},
+                            {4.0, 5.0, 6.0},
+                            {7.0, 8.0, 9.0}};
+
+  // Only the triangle of A is read, the size is adjusted.
+  triangular_matrix<double, lower, packed> L(2);
+  L = A;
+  EXPECT_EQ(L.stored_size(), 6);
+  EXPECT_THAT(L, ElementsAre(1.0, 0.0, 0.0,
+                             4.0, 5.0, 0.0,
+                             7.0, 8.0, 9.0));
+
+  triangular_matrix<double, upper, full> U(A);
+  U = 2.0 * U;
+  EXPECT_THAT(U, ElementsAre(2.0, 4.0, 6.0,
+                             0.0, 10.0, 12.0,
+                             0.0, 0.0, 18.0));
+
+  // Reads the transpose of the destination: its upper triangle is zero.
+  U = U + U.t();
+  EXPECT_THAT(U, ElementsAre(4.0, 4.0, 6.0,
+                             0.0, 20.0, 12.0,
+                             0.0, 0.0, 36.0));
+  // The other triangle of the full storage remains zero.
+  EXPECT_THAT(std::vector<double>(U.data(), U.data() + U.stored_size()),
+              ElementsAre(4.0, 4.0, 6.0,
+                          0.0, 20.0, 12.0,
+                          0.0, 0.0, 36.0));
+}
+
+TEST(triangular_matrix, scalar_arithmetic) {
+  const matrix<double> A = {{1.0, 2.0},
+                            {3.0, 4.0}};
+  triangular_matrix<double, lower, full> L(A);
+
+  L += 1.0;
+  EXPECT_THAT(L, ElementsAre(2.0, 0.0, 4.0, 5.0));
+  EXPECT_THAT(std::vector<double>(L.data(), L.data() + L.stored_size()),
+              ElementsAre(2.0, 0.0, 4.0, 5.0));
+
+  L -= 2.0;
+  EXPECT_THAT(L, ElementsAre(0.0, 0.0, 2.0, 3.0));
+
+  L *= 3.0;
+  EXPECT_THAT(L, ElementsAre(0.0, 0.0, 6.0, 9.0));
+}
+
+TEST(triangular_matrix, triangular_arithmetic) {
+  const matrix<double> A = {{1.0, 2.0},
+                            {3.0, 4.0}};
+  const matrix<double> B = {{5.0, 6.0},
+                            {7.0, 8.0}};
+  triangular_matrix<double, upper, packed> U(A);
+  const triangular_matrix<double, upper, packed> V(B);
+
+  U += V;
+  EXPECT_THAT(U, ElementsAre(6.0, 8.0, 0.0, 12.0));
+
+  U -= V;
+  EXPECT_THAT(U, ElementsAre(1.0, 2.0, 0.0, 4.0));
+
+  U *= V;
+  EXPECT_THAT(U, ElementsAre(5.0, 12.0, 0.0, 32.0));
+
+  U += U;
+  EXPECT_THAT(U, ElementsAre(10.0, 24.0, 0.0, 64.0));
+}
+
+TEST(triangular_matrix, matvec_lower_full) {
+  check_matvec<double, lower, full>(1e-12);
+  check_matvec<float, lower, full>(1e-4);
+}
+
+TEST(triangular_matrix, matvec_upper_full) {
+  check_matvec<double, upper, full>(1e-12);
+}
+
+TEST(triangular_matrix, matvec_lower_packed) {
+  check_matvec<double, lower, packed>(1e-12);
+  check_matvec<float, lower, packed>(1e-4);
+}
+
+TEST(triangular_matrix, matvec_upper_packed) {
+  check_matvec<double, upper, packed>(1e-12);
+  check_matvec<float, upper, packed>(1e-4);
+}
+
+}  // namespace insight
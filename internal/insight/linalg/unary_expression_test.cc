@@ -257,4 +257,28 @@ TEST(unary_expression, sqrt_of_a_float_dense_row_view_transpose) {
   EXPECT_THAT(y, ElementsAre(1, 2, 1.5));
 }
 
+TEST(unary_expression, sqrt_of_a_vector_expression_tree) {
+  vector<double> x = {1, 2, 3, 4};
+  vector<double> y = {2, 5, 10, 17};
+  vector<double> z = {2, 4, 9, 11};
+
+  vector<double> w = sqrt(2.0 * x + y) / (z - 1.0);
+
+  EXPECT_FALSE(w.empty());
+  EXPECT_EQ(w.size(), 4);
+  EXPECT_THAT(w, ElementsAre(2, 1, 0.5, 0.5));
+
+  w += sqrt(2.0 * x + y) / (z - 1.0);
+  EXPECT_THAT(w, ElementsAre(4, 2, 1, 1));
+
+  w -= sqrt(2.0 * x + y) / (z - 1.0);
+  EXPECT_THAT(w, ElementsAre(2, 1, 0.5, 0.5));
+
+  w *= sqrt(2.0 * x + y) / (z - 1.0);
+  EXPECT_THAT(w, ElementsAre(4, 1, 0.25, 0.25));
+
+  w /= sqrt(2.0 * x + y) / (z - 1.0);
+  EXPECT_THAT(w, ElementsAre(2, 1, 0.5, 0.5));
+}
+
 }  // namespace insight
@@ -0,0 +1,214 @@
+// Copyright (C) 2019
+//
+// Author: mail2ngoclinh@gmail.com (Ngoc Linh)
+
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+#include "insight/linalg.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace insight {
+
+using ::testing::ElementsAre;
+using ::testing::DoubleEq;
+
+TEST(vector_map, constructors) {
+  double x[] = {1.0, 2.0, 3.0};
+  vector_map<double> a(x, 3);
+  EXPECT_EQ(a.size(), 3);
+  EXPECT_EQ(a.row_count(), 3);
+  EXPECT_EQ(a.col_count(), 1);
+  EXPECT_EQ(a.data(), x);
+  EXPECT_THAT(a, ElementsAre(1.0, 2.0, 3.0));
+
+  a[1] = 5.0;
+  EXPECT_EQ(x[1], 5.0);
+
+  const double y[] = {4.0, 5.0};
+  vector_map<const double> b(y, 2);
+  EXPECT_THAT(b, ElementsAre(4.0, 5.0));
+
+  vector<double> c = b * 2.0;
+  EXPECT_THAT(c, ElementsAre(8.0, 10.0));
+}
+
+TEST(vector_map, assignment) {
+  double x[] = {1.0, 2.0, 3.0};
+  double y[] = {4.0, 5.0, 6.0};
+  vector_map<double> a(x, 3);
+  vector_map<double> b(y, 3);
+
+  // Copies the elements, does not rebind a.
+  a = b;
+  EXPECT_EQ(a.data(), x);
+  EXPECT_THAT(x, ElementsAre(4.0, 5.0, 6.0));
+
+  a = b - 1.0;
+  EXPECT_THAT(x, ElementsAre(3.0, 4.0, 5.0));
+
+  a = a * 2.0 + b;
+  EXPECT_THAT(x, ElementsAre(10.0, 13.0, 16.0));
+
+  vector<double> v = {1.0, 1.0, 1.0};
+  a.noalias() = v + b;
+  EXPECT_THAT(x, ElementsAre(5.0, 6.0, 7.0));
+}
+
+TEST(vector_map, arithmetic) {
+  double x[] = {1.0, 2.0, 3.0};
+  const double y[] = {1.0, 2.0, 4.0};
+  vector_map<double> a(x, 3);
+  vector_map<const double> b(y, 3);
+
+  a += 1.0;
+  EXPECT_THAT(x, ElementsAre(2.0, 3.0, 4.0));
+  a -= 1.0;
+  EXPECT_THAT(x, ElementsAre(1.0, 2.0, 3.0));
+  a *= 2.0;
+  EXPECT_THAT(x, ElementsAre(2.0, 4.0, 6.0));
+  a /= 2.0;
+  EXPECT_THAT(x, ElementsAre(1.0, 2.0, 3.0));
+
+  a += b;
+  EXPECT_THAT(x, ElementsAre(2.0, 4.0, 7.0));
+  a -= b;
+  EXPECT_THAT(x, ElementsAre(1.0, 2.0, 3.0));
+  a *= b;
+  EXPECT_THAT(x, ElementsAre(1.0, 4.0, 12.0));
+  a /= b;
+  EXPECT_THAT(x, ElementsAre(1.0, 2.0, 3.0));
+
+  int i[] = {3, 6, 9};
+  vector_map<int> c(i, 3);
+  c /= 3;
+  EXPECT_THAT(i, ElementsAre(1, 2, 3));
+
+  EXPECT_DOUBLE_EQ(a.dot(b), 17.0);
+  EXPECT_DOUBLE_EQ(b.nrm2(), std::sqrt(21.0));
+  EXPECT_DOUBLE_EQ(sum(b), 7.0);
+
+  // With any vector expression, dense or not.
+  const vector<double> v = {1.0, 0.0, 2.0};
+  EXPECT_DOUBLE_EQ(b.dot(v), 9.0);
+  EXPECT_DOUBLE_EQ(b.dot(v + 1.0), 16.0);
+  matrix<double> M = {{1.0, 0.0},
+                      {0.0, 1.0},
+                      {2.0, 3.0}};
+  EXPECT_DOUBLE_EQ(b.dot(M.col_at(1)), 14.0);
+  EXPECT_EQ(c.dot(vector<int>{1, 1, 1}), 6);
+}
+
+namespace {
+
+// Can a vector<double> be assigned (resp. added) to an M?
+template<typename M, typename = void>
+struct is_assignable_from_vector : public std::false_type {};
+
+template<typename M>
+struct is_assignable_from_vector<
+  M, decltype(void(std::declval<M&>() = std::declval<vector<double> >()))>
+    : public std::true_type {};
+
+template<typename M, typename = void>
+struct is_addable_from_vector : public std::false_type {};
+
+template<typename M>
+struct is_addable_from_vector<
+  M, decltype(void(std::declval<M&>() += std::declval<vector<double> >()))>
+    : public std::true_type {};
+
+template<typename M, typename = void>
+struct is_scalable : public std::false_type {};
+
+template<typename M>
+struct is_scalable<M, decltype(void(std::declval<M&>() *= 2.0))>
+    : public std::true_type {};
+
+}  // namespace
+
+TEST(vector_map, const_map_is_read_only) {
+  EXPECT_TRUE(is_assignable_from_vector<vector_map<double> >::value);
+  EXPECT_TRUE(is_addable_from_vector<vector_map<double> >::value);
+  EXPECT_TRUE(is_scalable<vector_map<double> >::value);
+
+  EXPECT_FALSE(is_assignable_from_vector<vector_map<const double> >::value);
+  EXPECT_FALSE(is_addable_from_vector<vector_map<const double> >::value);
+  EXPECT_FALSE(is_scalable<vector_map<const double> >::value);
+}
+
+TEST(vector_map, matmul) {
+  const double x[] = {1.0, 2.0, 3.0};
+  double g[] = {-1.0, -1.0};
+  vector_map<const double> x_map(x, 3);
+  vector_map<double> g_map(g, 2);
+
+  matrix<double> A = {{1.0, 2.0, 3.0},
+                      {4.0, 5.0, 6.0}};
+
+  g_map = matmul(A, x_map);
+  EXPECT_EQ(g_map.data(), g);
+  EXPECT_THAT(g, ElementsAre(14.0, 32.0));
+
+  g_map += 2.0 * matmul(A, x_map);
+  EXPECT_THAT(g, ElementsAre(42.0, 96.0));
+
+  g_map = matmul(A, x_map) - matmul(A, x_map);
+  EXPECT_THAT(g, ElementsAre(0.0, 0.0));
+}
+
+TEST(vector_map, aliasing) {
+  double x[] = {1.0, 2.0};
+  vector_map<double> a(x, 2);
+  matrix<double> A = {{1.0, 2.0},
+                      {3.0, 4.0}};
+
+  // Reads a while writing it.
+  a = matmul(A, a);
+  EXPECT_THAT(x, ElementsAre(5.0, 11.0));
+
+  // Two maps overlapping the same buffer.
+  double y[] = {1.0, 2.0, 3.0};
+  vector_map<double> b(y, 2);
+  vector_map<double> c(y + 1, 2);
+  b = matmul(A, c);
+  EXPECT_THAT(y, ElementsAre(8.0, 18.0, 3.0));
+}
+
+TEST(vector_map, overlapping_shifted_maps) {
+  // b is a shifted by one element: evaluating in place would read elements
+  // of a already overwritten.
+  double x[] = {1.0, 2.0, 3.0, 4.0};
+  vector_map<double> a(x, 3);
+  vector_map<double> b(x + 1, 3);
+  b = exp(a) * 0.0 + a;
+  EXPECT_THAT(x, ElementsAre(1.0, 1.0, 2.0, 3.0));
+
+  double y[] = {1.0, 2.0, 3.0, 4.0};
+  vector_map<double> c(y, 3);
+  vector_map<double> d(y + 1, 3);
+  d = 2.0 * c;
+  EXPECT_THAT(y, ElementsAre(1.0, 2.0, 4.0, 6.0));
+  d += c;
+  EXPECT_THAT(y, ElementsAre(1.0, 3.0, 6.0, 10.0));
+
+  // Coinciding maps are still evaluated in place.
+  double z[] = {1.0, 2.0, 3.0};
+  vector_map<double> e(z, 3);
+  vector_map<double> f(z, 3);
+  f = exp(e) * 0.0 + e * 2.0;
+  EXPECT_THAT(z, ElementsAre(2.0, 4.0, 6.0));
+}
+
+TEST(vector_map, death) {
+  double x[] = {1.0, 2.0, 3.0};
+  vector_map<double> a(x, 3);
+  vector<double> v(2);
+  EXPECT_DEATH(a = v, "mismatched");
+  EXPECT_DEATH(a += v, "mismatched");
+}
+
+}  // namespace insight
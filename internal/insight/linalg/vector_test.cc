@@ -2,9 +2,11 @@
 //
 // Author: mail2ngoclinh@gmail.com (Ngoc Linh)
 
+#include <utility>
 #include <vector>
 
 #include "insight/linalg/vector.h"
+#include "insight/linalg/test_util.h"
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
@@ -13,6 +15,7 @@ namespace insight {
 
 using ::testing::ElementsAre;
 using ::testing::DoubleEq;
+using test::is_stored_inline;
 
 TEST(vector, default_constructor) {
   vector<double> vec;
@@ -256,6 +259,37 @@ TEST(vector, div_vector) {
   EXPECT_THAT(a, ElementsAre(5, 13, 4));
 }
 
+TEST(vector, axpby) {
+  vector<double> x = {0.5, 1.0, 1.5, 2.0};
+  vector<double> y = {-1.0, 0.0, 2.0, 4.0};
+  vector<double> z(4);
+
+  z = 2.0 * x + 0.5 * y;
+  EXPECT_EQ(z.size(), 4);
+  EXPECT_THAT(z, ElementsAre(0.5, 2.0, 4.0, 6.0));
+
+  z = x - y * 2.0;
+  EXPECT_THAT(z, ElementsAre(2.5, 1.0, -2.5, -6.0));
+
+  y = 2.0 * x + 0.5 * y;
+  EXPECT_THAT(y, ElementsAre(0.5, 2.0, 4.0, 6.0));
+
+  x = 3.0 * x - y;
+  EXPECT_THAT(x, ElementsAre(1.0, 1.0, 0.5, 0.0));
+
+  z += x + 2.0 * y;
+  EXPECT_THAT(z, ElementsAre(4.5, 6.0, 6.0, 6.0));
+
+  z -= 0.5 * z - y;
+  EXPECT_THAT(z, ElementsAre(2.75, 5.0, 7.0, 9.0));
+
+  z += x * 2.0 - 0.5 * z;
+  EXPECT_THAT(z, ElementsAre(3.375, 4.5, 4.5, 4.5));
+
+  z -= 2.0 * z + x;
+  EXPECT_THAT(z, ElementsAre(-4.375, -5.5, -5.0, -4.5));
+}
+
 TEST(vector, nrm2) {
   vector<double> x = {3, 2, 2, 2, 2};
   EXPECT_THAT(x.nrm2(), DoubleEq(5.0));
@@ -278,4 +312,50 @@ TEST(vector, dot) {
   EXPECT_EQ(b.dot(a), 140);
 }
 
+TEST(vector, small_buffer) {
+  using small_vector = vector<double, allocator<double>, 4>;
+
+  small_vector a = {1, 2, 3};
+  EXPECT_TRUE(is_stored_inline(a));
+  EXPECT_EQ(a.capacity(), 4);
+
+  small_vector b = a * 2.0;
+  EXPECT_TRUE(is_stored_inline(b));
+  EXPECT_THAT(b, ElementsAre(2, 4, 6));
+
+  // Grows beyond the small buffer.
+  small_vector c = {1, 2, 3, 4, 5};
+  EXPECT_FALSE(is_stored_inline(c));
+  b = c + 1.0;
+  EXPECT_FALSE(is_stored_inline(b));
+  EXPECT_THAT(b, ElementsAre(2, 3, 4, 5, 6));
+
+  // Moves copy the small buffer, and steal the heap buffer.
+  small_vector d(std::move(a));
+  EXPECT_TRUE(is_stored_inline(d));
+  EXPECT_THAT(d, ElementsAre(1, 2, 3));
+  EXPECT_TRUE(a.empty());
+
+  const double* heap = c.data();
+  small_vector e(std::move(c));
+  EXPECT_EQ(e.data(), heap);
+  EXPECT_TRUE(c.empty());
+
+  a = std::move(d);
+  EXPECT_TRUE(is_stored_inline(a));
+  EXPECT_THAT(a, ElementsAre(1, 2, 3));
+
+  // Swaps, inline and heap.
+  a.swap(e);
+  EXPECT_EQ(a.data(), heap);
+  EXPECT_THAT(a, ElementsAre(1, 2, 3, 4, 5));
+  EXPECT_TRUE(is_stored_inline(e));
+  EXPECT_THAT(e, ElementsAre(1, 2, 3));
+
+  small_vector f = {7};
+  f.swap(e);
+  EXPECT_THAT(f, ElementsAre(1, 2, 3));
+  EXPECT_THAT(e, ElementsAre(7));
+}
+
 }  // namespace insight